@@ -29,6 +29,11 @@ pub struct ZenInstanceExtern {
     _dummy: i32,
 }
 
+#[repr(C)]
+pub struct ZenFunctionHandleExtern {
+    _dummy: i32,
+}
+
 #[repr(C)]
 pub struct ZenHostFuncDescExtern {
     pub name: *const cty::c_char,
@@ -117,6 +122,12 @@ extern "C" {
 
     pub fn ZenGetNumImportFunctions(module: *mut ZenModuleExtern) -> cty::uint32_t;
 
+    pub fn ZenGetFunctionHandle(
+        module: *mut ZenModuleExtern,
+        func_name: *const cty::c_char,
+    ) -> *mut ZenFunctionHandleExtern;
+    pub fn ZenGetFunctionHandleNumResults(func: *mut ZenFunctionHandleExtern) -> cty::uint32_t;
+
     // return bool int
     pub fn ZenGetImportFuncName(
         module: *mut ZenModuleExtern,
@@ -157,6 +168,18 @@ extern "C" {
         in_args: *const *const cty::c_char,
         num_in_args: cty::uint32_t,
         out_results: *mut ZenValueExtern,
+        max_num_out_results: cty::uint32_t,
+        out_num_results: *mut cty::uint32_t,
+    ) -> cty::int8_t;
+
+    // return bool
+    pub fn ZenCallFunctionHandle(
+        rt: *mut ZenRuntimeExtern,
+        inst: *mut ZenInstanceExtern,
+        func: *mut ZenFunctionHandleExtern,
+        in_args: *const ZenValueExtern,
+        num_in_args: cty::uint32_t,
+        out_results: *mut ZenValueExtern,
         out_num_results: *mut cty::uint32_t,
     ) -> cty::int8_t;
 
@@ -14,12 +14,12 @@ use std::rc::Rc;
 use super::{
     isolation::ZenIsolation,
     r#extern::{
-        ZenCallWasmFuncByName, ZenDeleteInstance, ZenGetAppMemOffset, ZenGetHostMemAddr,
+        ZenCallFunctionHandle, ZenCallWasmFuncByName, ZenDeleteInstance, ZenGetAppMemOffset, ZenGetHostMemAddr,
         ZenGetInstanceCustomData, ZenGetInstanceError, ZenGetInstanceGasLeft, ZenInstanceExit,
-        ZenInstanceExtern, ZenSetInstanceCustomData, ZenSetInstanceExceptionByHostapi,
+        ZenGetFunctionHandleNumResults, ZenInstanceExtern, ZenSetInstanceCustomData, ZenSetInstanceExceptionByHostapi,
         ZenSetInstanceGasLeft, ZenValidateAppMemAddr, ZenValidateHostMemAddr, ZenValueExtern,
     },
-    runtime::{ZenModule, ERROR_BUF_SIZE},
+    runtime::{ZenFunctionHandle, ZenModule, ERROR_BUF_SIZE},
     types::ZenValue,
     utils::{at_least, rust_str_to_c_str, ScopedMalloc},
 };
@@ -167,6 +167,65 @@ impl<T> ZenInstance<T> {
         unsafe { ZenGetAppMemOffset(self.ptr, host_addr as *const cty::c_void) }
     }
 
+    fn get_last_error(&self, default_error: &str) -> String {
+        let mut error_buf: [cty::c_char; ERROR_BUF_SIZE] = [0; ERROR_BUF_SIZE];
+        let get_error_ret_bool = unsafe {
+            ZenGetInstanceError(
+                self.ptr,
+                (&mut error_buf) as *mut cty::c_char,
+                ERROR_BUF_SIZE as u32,
+            )
+        };
+        if get_error_ret_bool == 0 {
+            return default_error.to_string();
+        }
+        unsafe { CStr::from_ptr((&error_buf) as *const cty::c_char) }
+            .to_str()
+            .unwrap()
+            .to_string()
+    }
+
+    // call a function resolved by ZenModule::get_function_handle, the args are
+    // passed as typed values instead of strings
+    pub fn call_func_handle(
+        &self,
+        func: &ZenFunctionHandle,
+        args: &[ZenValue],
+    ) -> Result<Vec<ZenValue>, String> {
+        let in_values: Vec<ZenValueExtern> = args.iter().map(|arg| arg.to_extern()).collect();
+        let num_results = unsafe { ZenGetFunctionHandleNumResults(func.ptr) } as usize;
+        let mut out_values: Vec<ZenValueExtern> = (0..at_least(num_results, 1))
+            .map(|_| ZenValueExtern {
+                value_type: 0,
+                value: 0,
+            })
+            .collect();
+        let mut out_num_values: cty::uint32_t = 0;
+
+        let ret_bool = unsafe {
+            ZenCallFunctionHandle(
+                self.rt.borrow().as_ref().unwrap().ptr,
+                self.ptr,
+                func.ptr,
+                in_values.as_ptr(),
+                in_values.len() as cty::uint32_t,
+                out_values.as_mut_ptr(),
+                out_values.len() as cty::uint32_t,
+                &mut out_num_values,
+            )
+        };
+        if ret_bool == 0 {
+            return Err(self.get_last_error("call wasm func error"));
+        }
+        out_values[..out_num_values as usize]
+            .iter()
+            .map(|value| {
+                ZenValue::from_extern(value)
+                    .ok_or_else(|| "invalid wasm func return value type".to_string())
+            })
+            .collect()
+    }
+
     pub fn call_wasm_func(
         &self,
         func_name: &str,
@@ -260,6 +260,12 @@ pub struct ZenModule {
     pub ptr: *mut ZenModuleExtern,
 }
 
+// owned by the module, keeps it alive while the handle is used
+pub struct ZenFunctionHandle {
+    pub wasm_mod: Rc<ZenModule>,
+    pub ptr: *mut ZenFunctionHandleExtern,
+}
+
 impl Drop for ZenModule {
     fn drop(&mut self) {
         if !self.ptr.is_null() {
@@ -312,6 +318,20 @@ impl ZenModule {
         ))
     }
 
+    // the handle can be called on every instance of this module
+    pub fn get_function_handle(self: &Rc<Self>, func_name: &str) -> Option<ZenFunctionHandle> {
+        let func_name_c_bytes = rust_str_to_c_str(func_name);
+        let func_name_c_str = CStr::from_bytes_until_nul(&func_name_c_bytes).unwrap();
+        let ptr = unsafe { ZenGetFunctionHandle(self.ptr, func_name_c_str.as_ptr()) };
+        if ptr.is_null() {
+            return None;
+        }
+        Some(ZenFunctionHandle {
+            wasm_mod: self.clone(),
+            ptr,
+        })
+    }
+
     pub fn get_import_funcs_count(&self) -> usize {
         unsafe { ZenGetNumImportFunctions(self.ptr) as usize }
     }
@@ -1,6 +1,6 @@
 // Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
 // SPDX-License-Identifier: Apache-2.0
-use super::utils::rust_str_to_c_str;
+use super::{r#extern::ZenValueExtern, utils::rust_str_to_c_str};
 
 #[derive(Clone)]
 pub enum ZenValueType {
@@ -32,6 +32,27 @@ impl ZenValue {
         let value_str = self.to_string();
         rust_str_to_c_str(&value_str)
     }
+
+    // floats are passed by their bits, as in the C union
+    pub fn to_extern(&self) -> ZenValueExtern {
+        let (value_type, value) = match self {
+            ZenValue::ZenI32Value(v) => (0, *v as u32 as i64),
+            ZenValue::ZenI64Value(v) => (1, *v),
+            ZenValue::ZenF32Value(v) => (2, v.to_bits() as i64),
+            ZenValue::ZenF64Value(v) => (3, v.to_bits() as i64),
+        };
+        ZenValueExtern { value_type, value }
+    }
+
+    pub fn from_extern(value: &ZenValueExtern) -> Option<ZenValue> {
+        match value.value_type {
+            0 => Some(ZenValue::ZenI32Value(value.value as i32)),
+            1 => Some(ZenValue::ZenI64Value(value.value)),
+            2 => Some(ZenValue::ZenF32Value(f32::from_bits(value.value as u32))),
+            3 => Some(ZenValue::ZenF64Value(f64::from_bits(value.value as u64))),
+            _ => None,
+        }
+    }
 }
 
 impl std::fmt::Display for ZenValue {
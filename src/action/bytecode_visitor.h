@@ -10,7 +10,6 @@
 #include "common/type.h"
 #include "runtime/module.h"
 #include "utils/wasm.h"
-#include <stack>
 #include <vector>
 
 #ifdef ZEN_ENABLE_CHECKED_ARITHMETIC
@@ -22,6 +21,8 @@ namespace zen::action {
 using common::BinaryOperator;
 using common::CompareOperator;
 using common::ErrorCode;
+using common::FCOpcode;
+using common::FDOpcode;
 using common::getErrorWithExtraMessage;
 using common::getWASMBlockTypeFromOpcode;
 using common::isWASMTypeFloat;
@@ -34,27 +35,29 @@ using runtime::TypeEntry;
 using utils::readFixedNumber;
 using utils::readSafeLEBNumber;
 using utils::skipCurrentBlock;
+using utils::skipFCImmediates;
 
 template <typename Operand> class WASMEvalStack {
 public:
-  void push(Operand Op) { StackImpl.push(Op); }
+  void push(Operand Op) { StackImpl.push_back(Op); }
 
   Operand pop() {
     ZEN_ASSERT(!StackImpl.empty());
-    Operand Top = StackImpl.top();
-    StackImpl.pop();
+    Operand Top = StackImpl.back();
+    StackImpl.pop_back();
     return Top;
   }
 
-  Operand getTop() const {
-    ZEN_ASSERT(!StackImpl.empty());
-    return StackImpl.top();
+  // \p Depth 0 is the stack top
+  Operand getTop(uint32_t Depth = 0) const {
+    ZEN_ASSERT(Depth < StackImpl.size());
+    return StackImpl[StackImpl.size() - 1 - Depth];
   }
 
   uint32_t getSize() const { return StackImpl.size(); }
 
 private:
-  std::stack<Operand> StackImpl;
+  std::vector<Operand> StackImpl;
 };
 
 // ============================================================================
@@ -116,6 +119,9 @@ private:
 
     while (Ip < IpEnd) {
       auto &CurBlock = Builder.getCurrentBlockInfo();
+#ifdef ZEN_ENABLE_JIT_PROFILER
+      Builder.handleInstructionStart(Ip - CurFunc->CodePtr);
+#endif
       uint8_t Opcode = *Ip++;
 
       switch (Opcode) {
@@ -129,20 +135,23 @@ private:
         break;
 
       case Opcode::BLOCK: {
-        WASMType BlockType = getWASMBlockTypeFromOpcode(*Ip++);
-        handleBlock(BlockType);
+        const TypeEntry *BlockType = nullptr;
+        Ip = readBlockType(Ip, BlockType);
+        handleBlock(*BlockType);
         break;
       }
 
       case Opcode::LOOP: {
-        WASMType BlockType = getWASMBlockTypeFromOpcode(*Ip++);
-        handleLoop(BlockType);
+        const TypeEntry *BlockType = nullptr;
+        Ip = readBlockType(Ip, BlockType);
+        handleLoop(*BlockType);
         break;
       }
 
       case Opcode::IF: {
-        WASMType BlockType = getWASMBlockTypeFromOpcode(*Ip++);
-        handleIf(BlockType);
+        const TypeEntry *BlockType = nullptr;
+        Ip = readBlockType(Ip, BlockType);
+        handleIf(*BlockType);
         break;
       }
 
@@ -191,12 +200,10 @@ private:
         HANDLE_CHECKED_ARITHMETIC_CALL(CurMod, U32)
 #undef HANDLE_CHECKED_ARITHMETIC_CALL_POSTHOOK
 #endif // ZEN_ENABLE_CHECKED_ARITHMETIC
-        runtime::CodeEntry *CalleeFunc = CurMod->getCodeEntry(U32);
-        uint32_t CalleeOffset = CalleeFunc ? CalleeFunc->CodeOffset : 0;
-        uint32_t CallSiteOffset = Ip - CurFunc->CodePtr + CurFunc->CodeOffset;
-        uint32_t CallOffset = std::abs(int32_t(CallSiteOffset - CalleeOffset));
-
-        handleCall(U32, CallOffset);
+        if (handleHostapiIntrinsic(CurMod->getHostapiIntrinsic(U32))) {
+          break;
+        }
+        handleCall(U32, getCallOffset(U32, Ip));
         break;
       }
 
@@ -206,19 +213,43 @@ private:
         handleCallIndirect(U32, 0);
         break;
 
+      case Opcode::RETURN_CALL:
+        Ip = readSafeLEBNumber(Ip, U32);
+        if (U32 == CurMod->getGasFuncIdx()) {
+          handleGasCall();
+          handleReturn();
+        } else if (handleHostapiIntrinsic(CurMod->getHostapiIntrinsic(U32))) {
+          handleReturn();
+        } else {
+          handleCall(U32, getCallOffset(U32, Ip), true);
+        }
+        Ip = skipCurrentBlock(Ip, IpEnd);
+        CurBlock.setReachable(false);
+        break;
+
+      case Opcode::RETURN_CALL_INDIRECT:
+        Ip = readSafeLEBNumber(Ip, U32);
+        Ip++; // Skip table index(0)
+        handleCallIndirect(U32, 0, true);
+        Ip = skipCurrentBlock(Ip, IpEnd);
+        CurBlock.setReachable(false);
+        break;
+
       case Opcode::DROP:
       case Opcode::DROP_64:
+      case Opcode::DROP_V128:
         handleDrop();
         break;
 
       case Opcode::SELECT:
       case Opcode::SELECT_64:
+      case Opcode::SELECT_V128:
         handleSelect();
         break;
 
       case Opcode::GET_LOCAL:
         Ip = readSafeLEBNumber(Ip, U32);
-        handleGetLocal(U32);
+        Ip = handleGetLocal(U32, Ip, IpEnd);
         break;
 
       case Opcode::SET_LOCAL:
@@ -242,46 +273,46 @@ private:
         break;
 
       case Opcode::I32_LOAD:
-        Ip = handleLoad<WASMType::I32, WASMType::I32, false>(Ip);
+        Ip = handleLoad<WASMType::I32, WASMType::I32, false>(Ip, IpEnd);
         break;
       case Opcode::I32_LOAD8_S:
-        Ip = handleLoad<WASMType::I32, WASMType::I8, true>(Ip);
+        Ip = handleLoad<WASMType::I32, WASMType::I8, true>(Ip, IpEnd);
         break;
       case Opcode::I32_LOAD8_U:
-        Ip = handleLoad<WASMType::I32, WASMType::I8, false>(Ip);
+        Ip = handleLoad<WASMType::I32, WASMType::I8, false>(Ip, IpEnd);
         break;
       case Opcode::I32_LOAD16_S:
-        Ip = handleLoad<WASMType::I32, WASMType::I16, true>(Ip);
+        Ip = handleLoad<WASMType::I32, WASMType::I16, true>(Ip, IpEnd);
         break;
       case Opcode::I32_LOAD16_U:
-        Ip = handleLoad<WASMType::I32, WASMType::I16, false>(Ip);
+        Ip = handleLoad<WASMType::I32, WASMType::I16, false>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD:
-        Ip = handleLoad<WASMType::I64, WASMType::I64, false>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I64, false>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD8_S:
-        Ip = handleLoad<WASMType::I64, WASMType::I8, true>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I8, true>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD8_U:
-        Ip = handleLoad<WASMType::I64, WASMType::I8, false>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I8, false>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD16_S:
-        Ip = handleLoad<WASMType::I64, WASMType::I16, true>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I16, true>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD16_U:
-        Ip = handleLoad<WASMType::I64, WASMType::I16, false>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I16, false>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD32_S:
-        Ip = handleLoad<WASMType::I64, WASMType::I32, true>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I32, true>(Ip, IpEnd);
         break;
       case Opcode::I64_LOAD32_U:
-        Ip = handleLoad<WASMType::I64, WASMType::I32, false>(Ip);
+        Ip = handleLoad<WASMType::I64, WASMType::I32, false>(Ip, IpEnd);
         break;
       case Opcode::F32_LOAD:
-        Ip = handleLoad<WASMType::F32, WASMType::F32, false>(Ip);
+        Ip = handleLoad<WASMType::F32, WASMType::F32, false>(Ip, IpEnd);
         break;
       case Opcode::F64_LOAD:
-        Ip = handleLoad<WASMType::F64, WASMType::F64, false>(Ip);
+        Ip = handleLoad<WASMType::F64, WASMType::F64, false>(Ip, IpEnd);
         break;
 
       case Opcode::I32_STORE:
@@ -324,6 +355,14 @@ private:
         handleMemoryGrow();
         break;
 
+      case Opcode::FC_PREFIX:
+        Ip = handleBulkMemory(Ip, IpEnd);
+        break;
+
+      case Opcode::FD_PREFIX:
+        Ip = handleSIMD(Ip);
+        break;
+
       case Opcode::I32_CONST:
         Ip = readSafeLEBNumber(Ip, I32);
         handleConst<WASMType::I32>(I32);
@@ -664,10 +703,10 @@ private:
         break;
 
       case Opcode::I64_EXTEND_S_I32:
-        handleIntExtend<WASMType::I64, WASMType::I32, true>();
+        Ip = handleIntExtendI32<true>(Ip, IpEnd);
         break;
       case Opcode::I64_EXTEND_U_I32:
-        handleIntExtend<WASMType::I64, WASMType::I32, false>();
+        Ip = handleIntExtendI32<false>(Ip, IpEnd);
         break;
       case Opcode::I64_TRUNC_S_F32:
         handleFloatToInt<WASMType::I64, WASMType::F32, true>();
@@ -760,39 +799,52 @@ private:
 
   void handleUnreachable() { Builder.handleUnreachable(); }
 
-  void handleBlock(WASMType BlockType) {
-    Builder.handleBlock(BlockType, Stack.getSize());
+  void handleBlock(const TypeEntry &BlockType) {
+    std::vector<Operand> Params = popBlockParams(BlockType);
+    Builder.handleBlock(BlockType, Params, Stack.getSize());
+    pushBlockParams();
   }
 
-  void handleLoop(WASMType BlockType) {
-    Builder.handleLoop(BlockType, Stack.getSize());
+  void handleLoop(const TypeEntry &BlockType) {
+    std::vector<Operand> Params = popBlockParams(BlockType);
+    Builder.handleLoop(BlockType, Params, Stack.getSize());
+    pushBlockParams();
   }
 
-  void handleIf(WASMType BlockType) {
-    Operand Cond = pop();
-    Builder.handleIf(Cond, BlockType, Stack.getSize());
+  // the builder releases the condition once the params are copied, which
+  // must not reuse its stack slot
+  void handleIf(const TypeEntry &BlockType) {
+    Operand Cond = Stack.pop();
+    std::vector<Operand> Params = popBlockParams(BlockType);
+    Builder.handleIf(Cond, BlockType, Params, Stack.getSize());
+    pushBlockParams();
   }
 
   void handleElse() {
     const CtrlBlockInfo &Info = Builder.getCurrentBlockInfo();
     ZEN_ASSERT(verifyCtrlInstValType(Info));
     ZEN_ASSERT(Info.getKind() == CtrlBlockKind::IF);
-    if (Info.getType() != WASMType::VOID && Info.reachable()) {
-      // make an assignment to copy stack top to block info result
-      Operand BlockResult = Info.getResult();
-      Builder.makeAssignment(Info.getType(), BlockResult, pop());
+    if (Info.reachable()) {
+      // make assignments to copy the stack top values to the block results
+      popBlockResults(Info);
+    }
+    // value stack may have excess elements after an unconditional branch
+    while (Stack.getSize() > Info.getStackSize()) {
+      Stack.pop();
     }
     Builder.handleElse(Info);
+    // the else block starts with the params again
+    pushBlockParams();
   }
 
   void handleEnd() {
     const CtrlBlockInfo &Info = Builder.getCurrentBlockInfo();
     ZEN_ASSERT(verifyCtrlInstValType(Info));
 
-    Operand BlockResult = Info.getResult();
-    if (Info.getType() != WASMType::VOID && Info.reachable()) {
-      // make an assignment to copy stack top to block info result
-      Builder.makeAssignment(Info.getType(), BlockResult, pop());
+    std::vector<Operand> BlockResults = Info.getResults();
+    if (Info.reachable()) {
+      // make assignments to copy the stack top values to the block results
+      popBlockResults(Info);
     }
     // value stack may have excess elements after an unconditional branch;
     // we need to pop them out before returing to the outer block
@@ -803,8 +855,7 @@ private:
     // NOTE: `info` is popped off its container after this call
     Builder.handleEnd(Info);
 
-    if (BlockResult.getType() != WASMType::VOID) {
-      // save return register to temp location
+    for (const Operand &BlockResult : BlockResults) {
       push(BlockResult);
     }
   }
@@ -813,32 +864,47 @@ private:
     const CtrlBlockInfo &Info = Builder.getBlockInfo(Level);
     bool JumpBack = (Info.getKind() == CtrlBlockKind::LOOP);
     ZEN_ASSERT(verifyCtrlInstValType(Info, JumpBack));
-    if (Info.getType() != WASMType::VOID && !JumpBack) {
-      // make an assignment to copy stack top to block info result
-      Operand BlockResult = Info.getResult();
-      Builder.makeAssignment(Info.getType(), BlockResult, getTop());
-    }
+    assignBranchValues(Info);
     Builder.handleBranch(Level, Info);
   }
 
   void handleBranchIf(uint32_t Level) {
+    if (hasLoopParams(Builder.getBlockInfo(Level))) {
+      handleBranchIfLoopParams(Level);
+      return;
+    }
     Operand Opnd = pop();
     const CtrlBlockInfo &Info = Builder.getBlockInfo(Level);
     bool JumpBack = (Info.getKind() == CtrlBlockKind::LOOP);
     ZEN_ASSERT(verifyCtrlInstValType(Info, JumpBack));
-    if (Info.getType() != WASMType::VOID && !JumpBack) {
-      // make an assignment to copy stack top to block info result
-      Operand BlockResult = Info.getResult();
-      Builder.makeAssignment(Info.getType(), BlockResult, getTop());
-    }
+    // the block results are only read at the target, so they may be
+    // assigned when the branch isn't taken too
+    assignBranchValues(Info);
     Builder.handleBranchIf(Opnd, Level, Info);
   }
 
+  // the params of the loop may still be on the stack when the branch isn't
+  // taken, so only the taken branch assigns them:
+  //   if (cond) { params = stack top values; br loop }
+  void handleBranchIfLoopParams(uint32_t Level) {
+    Operand Cond = Stack.pop();
+    const TypeEntry VoidBlockType = {};
+    Builder.handleIf(Cond, VoidBlockType, {}, Stack.getSize());
+    // the if block is the innermost one now
+    const CtrlBlockInfo &Info = Builder.getBlockInfo(Level + 1);
+    ZEN_ASSERT(verifyCtrlInstValType(Info, true));
+    assignBranchValues(Info);
+    Builder.handleBranch(Level + 1, Info);
+    CtrlBlockInfo &IfInfo = Builder.getCurrentBlockInfo();
+    IfInfo.setReachable(false);
+    Builder.handleEnd(IfInfo);
+  }
+
   const uint8_t *handleBranchTable(const uint8_t *Ip, const uint8_t *End,
                                    uint32_t Count) {
     std::vector<uint32_t> Levels;
     Levels.reserve(Count + 1); // includes last default target
-    WASMType Type = WASMType::VOID;
+    size_t NumValues = 0;
     for (uint32_t I = 0; I < Count + 1; ++I) {
       uint32_t TargetLevel;
       Ip = readSafeLEBNumber(Ip, TargetLevel);
@@ -846,33 +912,44 @@ private:
         break;
       }
       const auto &Info = Builder.getBlockInfo(TargetLevel);
-      WASMType BlockType = (Info.getKind() == CtrlBlockKind::LOOP)
-                               ? WASMType::VOID
-                               : Info.getType();
+      size_t NumLabelValues = getLabelOperands(Info).size();
       if (I == 0) {
-        Type = BlockType;
+        NumValues = NumLabelValues;
       } else {
-        ZEN_ASSERT(BlockType == Type);
+        ZEN_ASSERT(NumLabelValues == NumValues);
       }
       Levels.push_back(TargetLevel);
     }
     Operand Opnd = pop();
-    Operand StackTop = (Type == WASMType::VOID) ? Operand() : getTop();
-    Builder.handleBranchTable(Opnd, StackTop, Levels);
+    std::vector<Operand> StackTops;
+    for (size_t I = NumValues; I > 0; --I) {
+      StackTops.push_back(Stack.getTop(I - 1));
+    }
+    Builder.handleBranchTable(Opnd, StackTops, Levels);
     return Ip;
   }
 
   void handleReturn() {
     const TypeEntry &Type = Ctx->getWasmFuncType();
     ZEN_ASSERT(Stack.getSize() >= Type.NumReturns);
-    if (Type.NumReturns > 0 && Stack.getSize() > 0) {
-      Builder.handleReturn(pop());
-    } else if (Type.NumReturns == 0) {
-      Builder.handleReturn(Operand());
+    std::vector<Operand> Results(Type.NumReturns);
+    for (uint32_t I = Type.NumReturns; I > 0; --I) {
+      Results[I - 1] = pop();
     }
+    Builder.handleReturn(Results);
+  }
+
+  uint32_t getCallOffset(uint32_t FuncIdx, const uint8_t *Ip) const {
+    runtime::CodeEntry *CalleeFunc = CurMod->getCodeEntry(FuncIdx);
+    uint32_t CalleeOffset = CalleeFunc ? CalleeFunc->CodeOffset : 0;
+    uint32_t CallSiteOffset = Ip - CurFunc->CodePtr + CurFunc->CodeOffset;
+    return std::abs(int32_t(CallSiteOffset - CalleeOffset));
   }
 
-  void handleCall(uint32_t FuncIdx, uint32_t CallOffset) {
+  // a tail call also returns from the current function, builders may reuse
+  // its frame for the callee
+  void handleCall(uint32_t FuncIdx, uint32_t CallOffset,
+                  bool IsTailCall = false) {
     uint32_t NumFunctions = CurMod->getNumTotalFunctions();
     ZEN_ASSERT(FuncIdx < NumFunctions);
     TypeEntry *Type = CurMod->getFunctionType(FuncIdx);
@@ -891,14 +968,21 @@ private:
     Args.resize(Type->NumParams);
     collectCallParams(Type, Args);
 
-    Operand Result =
+    if (IsTailCall) {
+      Builder.handleReturnCall(FuncIdx, Target, IsImport, FarCall, ArgInfo,
+                               Args);
+      return;
+    }
+    std::vector<Operand> Results =
         Builder.handleCall(FuncIdx, Target, IsImport, FarCall, ArgInfo, Args);
-    if (Type->NumReturns > 0) {
+    ZEN_ASSERT(Results.size() == Type->NumReturns);
+    for (const Operand &Result : Results) {
       push(Result);
     }
   }
 
-  void handleCallIndirect(uint32_t TypeIdx, uint32_t TableIdx) {
+  void handleCallIndirect(uint32_t TypeIdx, uint32_t TableIdx,
+                          bool IsTailCall = false) {
     ZEN_ASSERT(CurMod->isValidType(TypeIdx));
     ZEN_ASSERT(TableIdx < CurMod->getNumTotalTables());
     Operand IndirectFuncIdx = pop();
@@ -909,12 +993,82 @@ private:
     Args.resize(Type->NumParams);
     collectCallParams(Type, Args);
     TypeIdx = CurMod->getDeclaredType(TypeIdx)->SmallestTypeIdx;
-    Operand Result = Builder.handleCallIndirect(TypeIdx, IndirectFuncIdx,
-                                                TableIdx, ArgInfo, Args);
+    if (IsTailCall) {
+      Builder.handleReturnCallIndirect(TypeIdx, IndirectFuncIdx, TableIdx,
+                                       ArgInfo, Args);
+      return;
+    }
+    std::vector<Operand> Results = Builder.handleCallIndirect(
+        TypeIdx, IndirectFuncIdx, TableIdx, ArgInfo, Args);
+    ZEN_ASSERT(Results.size() == Type->NumReturns);
+    for (const Operand &Result : Results) {
+      push(Result);
+    }
+  }
 
-    if (Type->NumReturns > 0) {
-      ZEN_ASSERT(Type->NumReturns == 1);
+  // env.memcpy, env.memmove and env.memset are lowered like memory.copy and
+  // memory.fill, env.memcmp and env.strlen are inlined where the builder can,
+  // the other intrinsics are called like any import. \return false if the
+  // call is left to handleCall
+  bool handleHostapiIntrinsic(runtime::HostapiIntrinsic Intrinsic) {
+    using runtime::HostapiIntrinsic;
+    // without a memory the runtime implementation traps
+    if (CurMod->getNumTotalMemories() == 0) {
+      return false;
+    }
+
+    switch (Intrinsic) {
+    case HostapiIntrinsic::memcpy:
+    case HostapiIntrinsic::memmove:
+    case HostapiIntrinsic::memset: {
+      // the destination is also the result, it stays alive across the
+      // builder
+      Operand Len = Stack.pop();
+      Operand Src = Stack.pop();
+      Operand Dst = Stack.pop();
+      Operand Result = Intrinsic == HostapiIntrinsic::memset
+                           ? Builder.handleMemsetIntrinsic(Dst, Src, Len)
+                           : Builder.handleMemcpyIntrinsic(Dst, Src, Len);
+      Builder.releaseOperand(Src);
+      Builder.releaseOperand(Len);
+      push(Result);
+      return true;
+    }
+    case HostapiIntrinsic::memcmp: {
+      if (!Builder.canInlineMemcmpIntrinsic(getTop())) {
+        return false;
+      }
+      // the addresses stay alive until both loads are done
+      Operand Len = pop();
+      Operand RHS = Stack.pop();
+      Operand LHS = Stack.pop();
+      Operand Result = Builder.handleMemcmpIntrinsic(LHS, RHS, Len);
+      Builder.releaseOperand(RHS);
+      Builder.releaseOperand(LHS);
       push(Result);
+      return true;
+    }
+    case HostapiIntrinsic::strlen: {
+      if (!Builder.canInlineStrlenIntrinsic()) {
+        return false;
+      }
+      Operand Str = pop();
+      push(Builder.handleStrlenIntrinsic(Str));
+      return true;
+    }
+    case HostapiIntrinsic::u256_add:
+    case HostapiIntrinsic::u256_sub: {
+      if (!Builder.canInlineU256Intrinsic()) {
+        return false;
+      }
+      Operand RHS = pop();
+      Operand LHS = pop();
+      Operand Dst = pop();
+      push(Builder.handleU256Intrinsic(Intrinsic, Dst, LHS, RHS));
+      return true;
+    }
+    default:
+      return false;
     }
   }
 
@@ -941,6 +1095,62 @@ private:
     push(Result);
   }
 
+  // a local only read as the address of the next load is used in place
+  const uint8_t *handleGetLocal(uint32_t LocalIdx, const uint8_t *Ip,
+                                const uint8_t *End) {
+    if (Ip >= End) {
+      handleGetLocal(LocalIdx);
+      return Ip;
+    }
+    switch (*Ip) {
+    case Opcode::I32_LOAD:
+      return handleLoad<WASMType::I32, WASMType::I32, false>(Ip + 1, End,
+                                                             LocalIdx);
+    case Opcode::I32_LOAD8_S:
+      return handleLoad<WASMType::I32, WASMType::I8, true>(Ip + 1, End,
+                                                           LocalIdx);
+    case Opcode::I32_LOAD8_U:
+      return handleLoad<WASMType::I32, WASMType::I8, false>(Ip + 1, End,
+                                                            LocalIdx);
+    case Opcode::I32_LOAD16_S:
+      return handleLoad<WASMType::I32, WASMType::I16, true>(Ip + 1, End,
+                                                            LocalIdx);
+    case Opcode::I32_LOAD16_U:
+      return handleLoad<WASMType::I32, WASMType::I16, false>(Ip + 1, End,
+                                                             LocalIdx);
+    case Opcode::I64_LOAD:
+      return handleLoad<WASMType::I64, WASMType::I64, false>(Ip + 1, End,
+                                                             LocalIdx);
+    case Opcode::I64_LOAD8_S:
+      return handleLoad<WASMType::I64, WASMType::I8, true>(Ip + 1, End,
+                                                           LocalIdx);
+    case Opcode::I64_LOAD8_U:
+      return handleLoad<WASMType::I64, WASMType::I8, false>(Ip + 1, End,
+                                                            LocalIdx);
+    case Opcode::I64_LOAD16_S:
+      return handleLoad<WASMType::I64, WASMType::I16, true>(Ip + 1, End,
+                                                            LocalIdx);
+    case Opcode::I64_LOAD16_U:
+      return handleLoad<WASMType::I64, WASMType::I16, false>(Ip + 1, End,
+                                                             LocalIdx);
+    case Opcode::I64_LOAD32_S:
+      return handleLoad<WASMType::I64, WASMType::I32, true>(Ip + 1, End,
+                                                            LocalIdx);
+    case Opcode::I64_LOAD32_U:
+      return handleLoad<WASMType::I64, WASMType::I32, false>(Ip + 1, End,
+                                                             LocalIdx);
+    case Opcode::F32_LOAD:
+      return handleLoad<WASMType::F32, WASMType::F32, false>(Ip + 1, End,
+                                                             LocalIdx);
+    case Opcode::F64_LOAD:
+      return handleLoad<WASMType::F64, WASMType::F64, false>(Ip + 1, End,
+                                                             LocalIdx);
+    default:
+      handleGetLocal(LocalIdx);
+      return Ip;
+    }
+  }
+
   void handleSetLocal(uint32_t LocalIdx) {
     Operand Val = pop();
     Builder.handleSetLocal(LocalIdx, Val);
@@ -963,19 +1173,51 @@ private:
 
   // ==================== Memory Instruction Handlers ====================
 
+  // BaseLocal is the local read by a fused local.get, or -1u to pop the base
   template <WASMType DestType, WASMType SrcType, bool Sext>
-  const uint8_t *handleLoad(const uint8_t *Ip) {
+  const uint8_t *handleLoad(const uint8_t *Ip, const uint8_t *End,
+                            uint32_t BaseLocal = -1u) {
     uint32_t Align;
     uint32_t Offset;
     Ip = readSafeLEBNumber(Ip, Align);
     Ip = readSafeLEBNumber(Ip, Offset);
-    Operand Base = pop();
-    Operand Result = Builder.template handleLoad<DestType, SrcType, Sext>(
-        Base, Offset, Align);
-    push(Result);
+
+    // an i64.extend_i32 of the loaded value widens the load itself, unless
+    // it zero-extends a sign-extending narrow load
+    if constexpr (DestType == WASMType::I32) {
+      if (Ip < End && (*Ip == Opcode::I64_EXTEND_S_I32 ||
+                       *Ip == Opcode::I64_EXTEND_U_I32)) {
+        bool ExtSext = (*Ip == Opcode::I64_EXTEND_S_I32);
+        if (ExtSext && (SrcType == WASMType::I32 || Sext)) {
+          emitLoad<WASMType::I64, SrcType, true>(Offset, Align, BaseLocal);
+          return Ip + 1;
+        }
+        if (!Sext) {
+          emitLoad<WASMType::I64, SrcType, false>(Offset, Align, BaseLocal);
+          return Ip + 1;
+        }
+      }
+    }
+
+    emitLoad<DestType, SrcType, Sext>(Offset, Align, BaseLocal);
     return Ip;
   }
 
+  template <WASMType DestType, WASMType SrcType, bool Sext>
+  void emitLoad(uint32_t Offset, uint32_t Align, uint32_t BaseLocal) {
+    Operand Result;
+    if (BaseLocal != -1u) {
+      Result = Builder.template handleFusedGetLocalLoad<DestType, SrcType,
+                                                        Sext>(BaseLocal,
+                                                              Offset, Align);
+    } else {
+      Operand Base = pop();
+      Result = Builder.template handleLoad<DestType, SrcType, Sext>(
+          Base, Offset, Align);
+    }
+    push(Result);
+  }
+
   template <WASMType SrcType, WASMType DestType>
   const uint8_t *handleStore(const uint8_t *Ip) {
     uint32_t Align;
@@ -1000,6 +1242,195 @@ private:
     push(Result);
   }
 
+  const uint8_t *handleBulkMemory(const uint8_t *Ip, const uint8_t *IpEnd) {
+    uint32_t SubOpcode;
+    uint32_t DataIdx = 0;
+    Ip = readSafeLEBNumber(Ip, SubOpcode);
+    if (SubOpcode == FCOpcode::MEMORY_INIT ||
+        SubOpcode == FCOpcode::DATA_DROP) {
+      readSafeLEBNumber(Ip, DataIdx);
+    }
+    Ip = skipFCImmediates(SubOpcode, Ip, IpEnd);
+
+    if (SubOpcode == FCOpcode::DATA_DROP) {
+      Builder.handleDataDrop(DataIdx);
+      return Ip;
+    }
+
+    // release the operands only after the builder is done, an inline lowering
+    // must not reuse their registers while it still reads them
+    Operand Len = Stack.pop();
+    Operand Src = Stack.pop();
+    Operand Dst = Stack.pop();
+    switch (SubOpcode) {
+    case FCOpcode::MEMORY_INIT:
+      Builder.handleMemoryInit(DataIdx, Dst, Src, Len);
+      break;
+    case FCOpcode::MEMORY_COPY:
+      Builder.handleMemoryCopy(Dst, Src, Len);
+      break;
+    case FCOpcode::MEMORY_FILL:
+      Builder.handleMemoryFill(Dst, Src, Len);
+      break;
+    default:
+      ZEN_UNREACHABLE();
+    }
+    Builder.releaseOperand(Dst);
+    Builder.releaseOperand(Src);
+    Builder.releaseOperand(Len);
+    return Ip;
+  }
+
+  // ==================== SIMD Instruction Handlers ====================
+
+  // the function loader has validated the sub-opcode and its operand types,
+  // modules using the ops of FunctionLoader::loadExtendedSIMDInstruction are
+  // interpreted
+  const uint8_t *handleSIMD(const uint8_t *Ip) {
+    uint32_t SubOpcode;
+    Ip = readSafeLEBNumber(Ip, SubOpcode);
+
+    switch (SubOpcode) {
+    case FDOpcode::V128_LOAD: {
+      uint32_t Align;
+      uint32_t Offset;
+      Ip = readSafeLEBNumber(Ip, Align);
+      Ip = readSafeLEBNumber(Ip, Offset);
+      Operand Base = pop();
+      push(Builder.handleSIMDLoad(Base, Offset, Align));
+      return Ip;
+    }
+    case FDOpcode::V128_STORE: {
+      uint32_t Align;
+      uint32_t Offset;
+      Ip = readSafeLEBNumber(Ip, Align);
+      Ip = readSafeLEBNumber(Ip, Offset);
+      Operand Value = pop();
+      Operand Base = pop();
+      ZEN_ASSERT(Value.getType() == WASMType::V128);
+      Builder.handleSIMDStore(Value, Base, Offset, Align);
+      return Ip;
+    }
+    case FDOpcode::V128_LOAD8X8_S:
+    case FDOpcode::V128_LOAD8X8_U:
+    case FDOpcode::V128_LOAD16X4_S:
+    case FDOpcode::V128_LOAD16X4_U:
+    case FDOpcode::V128_LOAD32X2_S:
+    case FDOpcode::V128_LOAD32X2_U:
+    case FDOpcode::V128_LOAD8_SPLAT:
+    case FDOpcode::V128_LOAD16_SPLAT:
+    case FDOpcode::V128_LOAD32_SPLAT:
+    case FDOpcode::V128_LOAD64_SPLAT:
+    case FDOpcode::V128_LOAD32_ZERO:
+    case FDOpcode::V128_LOAD64_ZERO: {
+      uint32_t Align;
+      uint32_t Offset;
+      Ip = readSafeLEBNumber(Ip, Align);
+      Ip = readSafeLEBNumber(Ip, Offset);
+      Operand Base = pop();
+      push(Builder.handleSIMDScalarLoad(SubOpcode, Base, Offset, Align));
+      return Ip;
+    }
+    case FDOpcode::V128_CONST:
+      push(Builder.handleSIMDConst(Ip));
+      return Ip + 16;
+    default:
+      break;
+    }
+
+    uint32_t NumOperands = 2;
+    WASMType ResultType = WASMType::V128;
+    uint8_t LaneIdx = 0;
+    const uint8_t *Imm = nullptr;
+    switch (SubOpcode) {
+    case FDOpcode::I8X16_SHUFFLE:
+      Imm = Ip;
+      Ip += 16;
+      break;
+    case FDOpcode::I8X16_SPLAT:
+    case FDOpcode::I16X8_SPLAT:
+    case FDOpcode::I32X4_SPLAT:
+    case FDOpcode::I64X2_SPLAT:
+    case FDOpcode::V128_NOT:
+    case FDOpcode::I8X16_ABS:
+    case FDOpcode::I8X16_NEG:
+    case FDOpcode::I16X8_ABS:
+    case FDOpcode::I16X8_NEG:
+    case FDOpcode::I32X4_ABS:
+    case FDOpcode::I32X4_NEG:
+    case FDOpcode::I64X2_NEG:
+    case FDOpcode::I16X8_EXTEND_LOW_I8X16_S:
+    case FDOpcode::I16X8_EXTEND_HIGH_I8X16_S:
+    case FDOpcode::I16X8_EXTEND_LOW_I8X16_U:
+    case FDOpcode::I16X8_EXTEND_HIGH_I8X16_U:
+    case FDOpcode::I32X4_EXTEND_LOW_I16X8_S:
+    case FDOpcode::I32X4_EXTEND_HIGH_I16X8_S:
+    case FDOpcode::I32X4_EXTEND_LOW_I16X8_U:
+    case FDOpcode::I32X4_EXTEND_HIGH_I16X8_U:
+    case FDOpcode::I64X2_EXTEND_LOW_I32X4_S:
+    case FDOpcode::I64X2_EXTEND_HIGH_I32X4_S:
+    case FDOpcode::I64X2_EXTEND_LOW_I32X4_U:
+    case FDOpcode::I64X2_EXTEND_HIGH_I32X4_U:
+    case FDOpcode::F32X4_ABS:
+    case FDOpcode::F32X4_NEG:
+    case FDOpcode::F32X4_SQRT:
+    case FDOpcode::F64X2_ABS:
+    case FDOpcode::F64X2_NEG:
+    case FDOpcode::F64X2_SQRT:
+      NumOperands = 1;
+      break;
+    case FDOpcode::V128_ANY_TRUE:
+    case FDOpcode::I8X16_ALL_TRUE:
+    case FDOpcode::I8X16_BITMASK:
+    case FDOpcode::I16X8_ALL_TRUE:
+    case FDOpcode::I16X8_BITMASK:
+    case FDOpcode::I32X4_ALL_TRUE:
+    case FDOpcode::I32X4_BITMASK:
+    case FDOpcode::I64X2_ALL_TRUE:
+    case FDOpcode::I64X2_BITMASK:
+      NumOperands = 1;
+      ResultType = WASMType::I32;
+      break;
+    case FDOpcode::I8X16_EXTRACT_LANE_S:
+    case FDOpcode::I8X16_EXTRACT_LANE_U:
+    case FDOpcode::I16X8_EXTRACT_LANE_S:
+    case FDOpcode::I16X8_EXTRACT_LANE_U:
+    case FDOpcode::I32X4_EXTRACT_LANE:
+      NumOperands = 1;
+      ResultType = WASMType::I32;
+      LaneIdx = *Ip++;
+      break;
+    case FDOpcode::I64X2_EXTRACT_LANE:
+      NumOperands = 1;
+      ResultType = WASMType::I64;
+      LaneIdx = *Ip++;
+      break;
+    case FDOpcode::I8X16_REPLACE_LANE:
+    case FDOpcode::I16X8_REPLACE_LANE:
+    case FDOpcode::I32X4_REPLACE_LANE:
+    case FDOpcode::I64X2_REPLACE_LANE:
+      LaneIdx = *Ip++;
+      break;
+    case FDOpcode::V128_BITSELECT:
+      NumOperands = 3;
+      break;
+    default:
+      break;
+    }
+
+    std::vector<Operand> Operands(NumOperands);
+    for (uint32_t I = NumOperands; I > 0; --I) {
+      Operands[I - 1] = Stack.pop();
+    }
+    Operand Result =
+        Builder.handleSIMDOp(SubOpcode, ResultType, Operands, LaneIdx, Imm);
+    for (const Operand &Opnd : Operands) {
+      Builder.releaseOperand(Opnd);
+    }
+    push(Result);
+    return Ip;
+  }
+
   // ==================== Numeric Instruction Handlers ====================
 
   template <WASMType Ty> void handleConst(typename WASMTypeAttr<Ty>::Type Val) {
@@ -1025,30 +1456,42 @@ private:
     uint32_t U32Val;
     switch (Opcode) {
     case Opcode::IF: {
+      const TypeEntry *BlockType = nullptr;
+      const uint8_t *Next = readBlockType(Ip + 1, BlockType);
+      // the params are below the compared values, which the fused branch
+      // releases before they are copied
+      if (BlockType->NumParams > 0) {
+        push(Builder.template handleCompareOp<Type, Opr>(CmpLHS, CmpRHS));
+        break;
+      }
       // bounds check
-      Ip += 2;
+      Ip = Next;
       if (Ip < End) {
-        WASMType BlockType = getWASMBlockTypeFromOpcode(*(Ip - 1));
         Builder.template handleFusedCompareIfa<Type, Opr>(
-            CmpLHS, CmpRHS, BlockType, Stack.getSize());
+            CmpLHS, CmpRHS, *BlockType, Stack.getSize());
       }
       break;
     }
 
     case Opcode::BR_IF: {
-      Ip = readSafeLEBNumber(Ip + 1, U32Val);
+      const uint8_t *Next = readSafeLEBNumber(Ip + 1, U32Val);
       // bounds check
-      if (Ip < End) {
-        const CtrlBlockInfo &Info = Builder.getBlockInfo(U32Val);
-        bool JumpBack = (Info.getKind() == CtrlBlockKind::LOOP);
-        ZEN_ASSERT(verifyCtrlInstValType(Info, JumpBack));
-        if (Info.getType() != WASMType::VOID && !JumpBack) {
-          // make an assignment to copy stack top to block info
-          Builder.makeAssignment(Info.getType(), Info.getResult(), getTop());
-        }
-        Builder.template handleFusedCompareBranchIf<Type, Opr>(CmpLHS, CmpRHS,
-                                                               U32Val, Info);
+      if (Next >= End) {
+        Ip = Next;
+        break;
       }
+      const CtrlBlockInfo &Info = Builder.getBlockInfo(U32Val);
+      // see handleBranchIfLoopParams
+      if (hasLoopParams(Info)) {
+        push(Builder.template handleCompareOp<Type, Opr>(CmpLHS, CmpRHS));
+        break;
+      }
+      Ip = Next;
+      bool JumpBack = (Info.getKind() == CtrlBlockKind::LOOP);
+      ZEN_ASSERT(verifyCtrlInstValType(Info, JumpBack));
+      assignBranchValues(Info);
+      Builder.template handleFusedCompareBranchIf<Type, Opr>(CmpLHS, CmpRHS,
+                                                             U32Val, Info);
       break;
     }
 
@@ -1162,6 +1605,17 @@ private:
     push(Result);
   }
 
+  // i64.extend_i32 directly wrapped back to i32 leaves the operand as is
+  template <bool Sext>
+  const uint8_t *handleIntExtendI32(const uint8_t *Ip, const uint8_t *End) {
+    if (Ip < End && *Ip == Opcode::I32_WRAP_I64) {
+      ZEN_ASSERT(getTop().getType() == WASMType::I32);
+      return Ip + 1;
+    }
+    handleIntExtend<WASMType::I64, WASMType::I32, Sext>();
+    return Ip;
+  }
+
   // Convert from SrcType to DestType (between integer and float-point)
   template <WASMType DestType, WASMType SrcType, bool Sext>
   void handleConvert() {
@@ -1189,17 +1643,82 @@ private:
       // value stack becomes unconstrained after an unconditional branch
       return true;
     }
-    if (Info.getType() == WASMType::VOID || JumpBack) {
-      // on an unconditional branch, value stack may have excess elements
-      ZEN_ASSERT(Info.getStackSize() <= Stack.getSize());
-    } else {
-      ZEN_ASSERT(Info.getStackSize() + 1 <= Stack.getSize());
-      // info type == stack top type
-      ZEN_ASSERT(Info.getType() == Stack.getTop().getType());
+    const std::vector<Operand> &Values =
+        JumpBack ? Info.getParams() : Info.getResults();
+    // on an unconditional branch, value stack may have excess elements
+    ZEN_ASSERT(Info.getStackSize() + Values.size() <= Stack.getSize());
+    // value types == stack top types
+    for (size_t I = 0; I < Values.size(); ++I) {
+      ZEN_ASSERT(Values[I].getType() ==
+                 Stack.getTop(Values.size() - 1 - I).getType());
     }
     return true;
   }
 
+  // a value type is read as a signature without params, a type index
+  // (multi-value) as the declared type
+  const uint8_t *readBlockType(const uint8_t *Ip, const TypeEntry *&Type) {
+    WASMType ValueType = getWASMBlockTypeFromOpcode(*Ip);
+    if (ValueType != WASMType::ERROR_TYPE) {
+      ValueBlockType.NumReturns = (ValueType == WASMType::VOID) ? 0 : 1;
+      ValueBlockType.ReturnTypesVec[0] = ValueType;
+      Type = &ValueBlockType;
+      return Ip + 1;
+    }
+    int64_t TypeIdx;
+    Ip = readSafeLEBNumber(Ip, TypeIdx);
+    Type = CurMod->getDeclaredType(static_cast<uint32_t>(TypeIdx));
+    return Ip;
+  }
+
+  // the params are passed to the builder, which pushes them back as
+  // getParams of the new block
+  std::vector<Operand> popBlockParams(const TypeEntry &BlockType) {
+    std::vector<Operand> Params(BlockType.NumParams);
+    for (uint32_t I = BlockType.NumParams; I > 0; --I) {
+      Params[I - 1] = Stack.pop();
+      ZEN_ASSERT(Params[I - 1].getType() == BlockType.getParamTypes()[I - 1]);
+    }
+    return Params;
+  }
+
+  void pushBlockParams() {
+    for (const Operand &Param : Builder.getCurrentBlockInfo().getParams()) {
+      push(Param);
+    }
+  }
+
+  // a branch to a loop passes the params, to other blocks the results
+  static const std::vector<Operand> &
+  getLabelOperands(const CtrlBlockInfo &Info) {
+    return (Info.getKind() == CtrlBlockKind::LOOP) ? Info.getParams()
+                                                   : Info.getResults();
+  }
+
+  static bool hasLoopParams(const CtrlBlockInfo &Info) {
+    return Info.getKind() == CtrlBlockKind::LOOP && !Info.getParams().empty();
+  }
+
+  void popBlockResults(const CtrlBlockInfo &Info) {
+    const std::vector<Operand> &Results = Info.getResults();
+    for (size_t I = Results.size(); I > 0; --I) {
+      const Operand &Result = Results[I - 1];
+      Builder.makeAssignment(Result.getType(), Result, pop());
+    }
+  }
+
+  // copy the stack top values to the operands of the branch target without
+  // popping them; in order, as a value on the stack may be a param of the
+  // target loop, whose index is never smaller than that of the assigned one
+  void assignBranchValues(const CtrlBlockInfo &Info) {
+    const std::vector<Operand> &Targets = getLabelOperands(Info);
+    for (size_t I = 0; I < Targets.size(); ++I) {
+      const Operand &Target = Targets[I];
+      Operand Value = Stack.getTop(Targets.size() - 1 - I);
+      Builder.makeAssignment(Target.getType(), Target, Value);
+    }
+  }
+
   void collectCallParams(TypeEntry *Type, std::vector<Operand> &Args) {
     if (Type->NumParams) {
       ZEN_ASSERT(Args.size() == Type->NumParams);
@@ -1242,6 +1761,8 @@ private:
   CompilerContext *Ctx; // context
   const runtime::Module *CurMod;
   const runtime::CodeEntry *CurFunc;
+  // the signature of a value block type, see readBlockType
+  TypeEntry ValueBlockType = {};
 };
 
 } // namespace zen::action
@@ -14,7 +14,7 @@
 namespace zen::action {
 
 void performJITCompile(runtime::Module &Mod) {
-  switch (Mod.getRuntime()->getConfig().Mode) {
+  switch (Mod.getRunMode()) {
 #ifdef ZEN_ENABLE_SINGLEPASS_JIT
   case common::RunMode::SinglepassMode: {
     singlepass::JITCompiler::compile(&Mod);
@@ -4,6 +4,7 @@
 #include "action/function_loader.h"
 #include "utils/others.h"
 #include "utils/wasm.h"
+#include <algorithm>
 
 namespace zen::action {
 
@@ -20,7 +21,7 @@ bool FunctionLoader::ControlBlockType::isBalanced() const {
   uint32_t NumParamTypes = Type->NumParams;
   uint32_t NumReturnTypes = Type->NumReturns;
   const WASMType *ParamTypes = Type->getParamTypes();
-  const WASMType *ReturnTypes = Type->ReturnTypes;
+  const WASMType *ReturnTypes = Type->getReturnTypes();
   return NumParamTypes == NumReturnTypes &&
          std::memcmp(ParamTypes, ReturnTypes,
                      NumParamTypes * sizeof(WASMType)) == 0;
@@ -48,7 +49,7 @@ FunctionLoader::ControlBlockType::getReturnTypes() const {
   const TypeEntry *Type = std::get<const TypeEntry *>(TypeVariant);
   return {
       static_cast<uint32_t>(Type->NumReturns),
-      Type->ReturnTypes,
+      Type->getReturnTypes(),
   };
 }
 
@@ -126,6 +127,29 @@ WASMType FunctionLoader::popValueType(WASMType Type) {
   return Type;
 }
 
+FunctionLoader::ControlBlockType FunctionLoader::readControlBlockType() {
+  if (Ptr >= End || getWASMBlockTypeFromOpcode(to_underlying(*Ptr)) !=
+                        WASMType::ERROR_TYPE) {
+    return readBlockType();
+  }
+  // type index in form of s33(multi-value)
+  int64_t TypeIdx = readI64();
+  if (TypeIdx < 0) {
+    throw getError(ErrorCode::InvalidType);
+  }
+  if (!Mod.isValidType(static_cast<uint32_t>(TypeIdx))) {
+    throw getError(ErrorCode::UnknownTypeIdx);
+  }
+  return Mod.getDeclaredType(static_cast<uint32_t>(TypeIdx));
+}
+
+void FunctionLoader::popBlockParamTypes(const ControlBlockType &BlockType) {
+  const auto [NumParamTypes, ParamTypes] = BlockType.getParamTypes();
+  for (int32_t I = static_cast<int32_t>(NumParamTypes) - 1; I >= 0; --I) {
+    popValueType(ParamTypes[I]);
+  }
+}
+
 void FunctionLoader::pushBlockParamTypes() {
   ZEN_ASSERT(!ControlBlocks.empty());
   ControlBlock &Block = ControlBlocks.back();
@@ -214,6 +238,30 @@ void FunctionLoader::checkBlockStack() {
   checkTopTypes(Block, NumReturnTypes, ReturnTypes, false);
 }
 
+void FunctionLoader::endTailCall(TypeEntry &CalleeType) {
+  // the callee results become the results of the current function
+  if (CalleeType.NumReturns != FuncTypeEntry.NumReturns) {
+    throw getError(ErrorCode::TypeMismatch);
+  }
+  for (uint32_t I = 0; I < CalleeType.NumReturns; ++I) {
+    WASMType Type = FuncTypeEntry.getReturnTypes()[I];
+    WASMType CalleeRetType = CalleeType.getReturnTypes()[I];
+    if (Type != CalleeRetType) {
+      throw getErrorWithExtraMessage(ErrorCode::TypeMismatch,
+                                     getTypeErrorMsg(Type, CalleeRetType));
+    }
+  }
+  auto &TypePairs = Mod.TailCalls.TypePairs;
+  const std::pair<const TypeEntry *, const TypeEntry *> TypePair(
+      &FuncTypeEntry, &CalleeType);
+  if (std::find(TypePairs.begin(), TypePairs.end(), TypePair) ==
+      TypePairs.end()) {
+    TypePairs.push_back(TypePair);
+  }
+  resetStack();
+  setStackPolymorphic(true);
+}
+
 const FunctionLoader::ControlBlock &FunctionLoader::checkBranch() {
   uint32_t Depth = readU32();
   if (ControlBlocks.size() <= Depth) {
@@ -263,6 +311,384 @@ WASMType FunctionLoader::readLocal() {
   return FuncCodeEntry.LocalTypes[LocalIdx - NumParams];
 }
 
+uint8_t FunctionLoader::readLaneIdx(uint8_t NumLanes) {
+  uint8_t LaneIdx = to_underlying(readByte());
+  if (LaneIdx >= NumLanes) {
+    throw getError(ErrorCode::InvalidLaneIndex);
+  }
+  return LaneIdx;
+}
+
+void FunctionLoader::readSIMDMemArg(uint32_t NaturalAlign) {
+  if (!hasMemory()) {
+    throw getError(ErrorCode::UnknownMemory);
+  }
+  uint32_t Align = readU32();
+  [[maybe_unused]] uint32_t Offset = readU32();
+  if (Align > NaturalAlign) {
+    throw getError(ErrorCode::AlignMustLargerThanNatural);
+  }
+  FuncCodeEntry.Stats |= Module::SF_memory;
+}
+
+void FunctionLoader::loadSIMDInstruction() {
+  uint32_t SubOpcode = readU32();
+  switch (SubOpcode) {
+  case V128_LOAD:
+    // the natural alignment of v128 is 2^4
+    readSIMDMemArg(4);
+    popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    break;
+  case V128_STORE:
+    readSIMDMemArg(4);
+    popValueType(WASMType::V128);
+    popValueType(WASMType::I32);
+    break;
+  case V128_LOAD8X8_S:
+  case V128_LOAD8X8_U:
+  case V128_LOAD16X4_S:
+  case V128_LOAD16X4_U:
+  case V128_LOAD32X2_S:
+  case V128_LOAD32X2_U:
+  case V128_LOAD64_SPLAT:
+  case V128_LOAD64_ZERO:
+    readSIMDMemArg(3);
+    popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    break;
+  case V128_LOAD8_SPLAT:
+    readSIMDMemArg(0);
+    popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    break;
+  case V128_LOAD16_SPLAT:
+    readSIMDMemArg(1);
+    popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    break;
+  case V128_LOAD32_SPLAT:
+  case V128_LOAD32_ZERO:
+    readSIMDMemArg(2);
+    popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    break;
+  case V128_CONST:
+    readBytes(16);
+    pushValueType(WASMType::V128);
+    break;
+  case I8X16_SHUFFLE:
+    for (uint32_t I = 0; I < 16; ++I) {
+      readLaneIdx(32);
+    }
+    popAndPushValueType(2, WASMType::V128, WASMType::V128);
+    break;
+  case I8X16_SPLAT:
+  case I16X8_SPLAT:
+  case I32X4_SPLAT:
+    popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    break;
+  case I64X2_SPLAT:
+    popAndPushValueType(1, WASMType::I64, WASMType::V128);
+    break;
+  case I8X16_EXTRACT_LANE_S:
+  case I8X16_EXTRACT_LANE_U:
+    readLaneIdx(16);
+    popAndPushValueType(1, WASMType::V128, WASMType::I32);
+    break;
+  case I16X8_EXTRACT_LANE_S:
+  case I16X8_EXTRACT_LANE_U:
+    readLaneIdx(8);
+    popAndPushValueType(1, WASMType::V128, WASMType::I32);
+    break;
+  case I32X4_EXTRACT_LANE:
+    readLaneIdx(4);
+    popAndPushValueType(1, WASMType::V128, WASMType::I32);
+    break;
+  case I64X2_EXTRACT_LANE:
+    readLaneIdx(2);
+    popAndPushValueType(1, WASMType::V128, WASMType::I64);
+    break;
+  case I8X16_REPLACE_LANE:
+  case I16X8_REPLACE_LANE:
+  case I32X4_REPLACE_LANE:
+    readLaneIdx(SubOpcode == I8X16_REPLACE_LANE   ? 16
+                : SubOpcode == I16X8_REPLACE_LANE ? 8
+                                                  : 4);
+    popValueType(WASMType::I32);
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case I64X2_REPLACE_LANE:
+    readLaneIdx(2);
+    popValueType(WASMType::I64);
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case V128_NOT:
+  case I8X16_ABS:
+  case I8X16_NEG:
+  case I16X8_ABS:
+  case I16X8_NEG:
+  case I32X4_ABS:
+  case I32X4_NEG:
+  case I64X2_NEG:
+  case I16X8_EXTEND_LOW_I8X16_S:
+  case I16X8_EXTEND_HIGH_I8X16_S:
+  case I16X8_EXTEND_LOW_I8X16_U:
+  case I16X8_EXTEND_HIGH_I8X16_U:
+  case I32X4_EXTEND_LOW_I16X8_S:
+  case I32X4_EXTEND_HIGH_I16X8_S:
+  case I32X4_EXTEND_LOW_I16X8_U:
+  case I32X4_EXTEND_HIGH_I16X8_U:
+  case I64X2_EXTEND_LOW_I32X4_S:
+  case I64X2_EXTEND_HIGH_I32X4_S:
+  case I64X2_EXTEND_LOW_I32X4_U:
+  case I64X2_EXTEND_HIGH_I32X4_U:
+  case F32X4_ABS:
+  case F32X4_NEG:
+  case F32X4_SQRT:
+  case F64X2_ABS:
+  case F64X2_NEG:
+  case F64X2_SQRT:
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case V128_ANY_TRUE:
+  case I8X16_ALL_TRUE:
+  case I8X16_BITMASK:
+  case I16X8_ALL_TRUE:
+  case I16X8_BITMASK:
+  case I32X4_ALL_TRUE:
+  case I32X4_BITMASK:
+  case I64X2_ALL_TRUE:
+  case I64X2_BITMASK:
+    popAndPushValueType(1, WASMType::V128, WASMType::I32);
+    break;
+  case I16X8_SHL:
+  case I16X8_SHR_S:
+  case I16X8_SHR_U:
+  case I32X4_SHL:
+  case I32X4_SHR_S:
+  case I32X4_SHR_U:
+  case I64X2_SHL:
+  case I64X2_SHR_S:
+  case I64X2_SHR_U:
+    popValueType(WASMType::I32);
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case V128_BITSELECT:
+    popAndPushValueType(3, WASMType::V128, WASMType::V128);
+    break;
+  case I8X16_SWIZZLE:
+  case I8X16_EQ:
+  case I8X16_NE:
+  case I8X16_LT_S:
+  case I8X16_GT_S:
+  case I16X8_EQ:
+  case I16X8_NE:
+  case I16X8_LT_S:
+  case I16X8_GT_S:
+  case I32X4_EQ:
+  case I32X4_NE:
+  case I32X4_LT_S:
+  case I32X4_GT_S:
+  case V128_AND:
+  case V128_ANDNOT:
+  case V128_OR:
+  case V128_XOR:
+  case I8X16_ADD:
+  case I8X16_SUB:
+  case I8X16_MIN_S:
+  case I8X16_MIN_U:
+  case I8X16_MAX_S:
+  case I8X16_MAX_U:
+  case I16X8_ADD:
+  case I16X8_SUB:
+  case I16X8_MUL:
+  case I16X8_MIN_S:
+  case I16X8_MIN_U:
+  case I16X8_MAX_S:
+  case I16X8_MAX_U:
+  case I32X4_ADD:
+  case I32X4_SUB:
+  case I32X4_MUL:
+  case I32X4_MIN_S:
+  case I32X4_MIN_U:
+  case I32X4_MAX_S:
+  case I32X4_MAX_U:
+  case I32X4_DOT_I16X8_S:
+  case I64X2_ADD:
+  case I64X2_SUB:
+  case I64X2_MUL:
+  case I64X2_EQ:
+  case I64X2_NE:
+  case I64X2_EXTMUL_LOW_I32X4_S:
+  case I64X2_EXTMUL_HIGH_I32X4_S:
+  case I64X2_EXTMUL_LOW_I32X4_U:
+  case I64X2_EXTMUL_HIGH_I32X4_U:
+  case I8X16_LT_U:
+  case I8X16_GT_U:
+  case I8X16_LE_S:
+  case I8X16_LE_U:
+  case I8X16_GE_S:
+  case I8X16_GE_U:
+  case I16X8_LT_U:
+  case I16X8_GT_U:
+  case I16X8_LE_S:
+  case I16X8_LE_U:
+  case I16X8_GE_S:
+  case I16X8_GE_U:
+  case I32X4_LT_U:
+  case I32X4_GT_U:
+  case I32X4_LE_S:
+  case I32X4_LE_U:
+  case I32X4_GE_S:
+  case I32X4_GE_U:
+  case I8X16_NARROW_I16X8_S:
+  case I8X16_NARROW_I16X8_U:
+  case I8X16_ADD_SAT_S:
+  case I8X16_ADD_SAT_U:
+  case I8X16_SUB_SAT_S:
+  case I8X16_SUB_SAT_U:
+  case I8X16_AVGR_U:
+  case I16X8_NARROW_I32X4_S:
+  case I16X8_NARROW_I32X4_U:
+  case I16X8_ADD_SAT_S:
+  case I16X8_ADD_SAT_U:
+  case I16X8_SUB_SAT_S:
+  case I16X8_SUB_SAT_U:
+  case I16X8_AVGR_U:
+  case F32X4_ADD:
+  case F32X4_SUB:
+  case F32X4_MUL:
+  case F32X4_DIV:
+  case F32X4_PMIN:
+  case F32X4_PMAX:
+  case F64X2_ADD:
+  case F64X2_SUB:
+  case F64X2_MUL:
+  case F64X2_DIV:
+  case F64X2_PMIN:
+  case F64X2_PMAX:
+    popAndPushValueType(2, WASMType::V128, WASMType::V128);
+    break;
+  default:
+    loadExtendedSIMDInstruction(SubOpcode);
+    Mod.UsesExtendedSIMD = true;
+    break;
+  }
+  Mod.UsesSIMD = true;
+}
+
+void FunctionLoader::loadExtendedSIMDInstruction(uint32_t SubOpcode) {
+  switch (SubOpcode) {
+  case V128_LOAD8_LANE:
+  case V128_LOAD16_LANE:
+  case V128_LOAD32_LANE:
+  case V128_LOAD64_LANE:
+  case V128_STORE8_LANE:
+  case V128_STORE16_LANE:
+  case V128_STORE32_LANE:
+  case V128_STORE64_LANE: {
+    // the lane size is 2^N bytes for the N-th of each group of four
+    uint32_t SizeLog2 = (SubOpcode - V128_LOAD8_LANE) % 4;
+    readSIMDMemArg(SizeLog2);
+    readLaneIdx(16 >> SizeLog2);
+    popValueType(WASMType::V128);
+    if (SubOpcode <= V128_LOAD64_LANE) {
+      popAndPushValueType(1, WASMType::I32, WASMType::V128);
+    } else {
+      popValueType(WASMType::I32);
+    }
+    break;
+  }
+  case F32X4_SPLAT:
+    popAndPushValueType(1, WASMType::F32, WASMType::V128);
+    break;
+  case F64X2_SPLAT:
+    popAndPushValueType(1, WASMType::F64, WASMType::V128);
+    break;
+  case F32X4_EXTRACT_LANE:
+    readLaneIdx(4);
+    popAndPushValueType(1, WASMType::V128, WASMType::F32);
+    break;
+  case F64X2_EXTRACT_LANE:
+    readLaneIdx(2);
+    popAndPushValueType(1, WASMType::V128, WASMType::F64);
+    break;
+  case F32X4_REPLACE_LANE:
+    readLaneIdx(4);
+    popValueType(WASMType::F32);
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case F64X2_REPLACE_LANE:
+    readLaneIdx(2);
+    popValueType(WASMType::F64);
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case I8X16_SHL:
+  case I8X16_SHR_S:
+  case I8X16_SHR_U:
+    popValueType(WASMType::I32);
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case F32X4_DEMOTE_F64X2_ZERO:
+  case F64X2_PROMOTE_LOW_F32X4:
+  case I8X16_POPCNT:
+  case F32X4_CEIL:
+  case F32X4_FLOOR:
+  case F32X4_TRUNC:
+  case F32X4_NEAREST:
+  case F64X2_CEIL:
+  case F64X2_FLOOR:
+  case F64X2_TRUNC:
+  case F64X2_NEAREST:
+  case I16X8_EXTADD_PAIRWISE_I8X16_S:
+  case I16X8_EXTADD_PAIRWISE_I8X16_U:
+  case I32X4_EXTADD_PAIRWISE_I16X8_S:
+  case I32X4_EXTADD_PAIRWISE_I16X8_U:
+  case I64X2_ABS:
+  case I32X4_TRUNC_SAT_F32X4_S:
+  case I32X4_TRUNC_SAT_F32X4_U:
+  case F32X4_CONVERT_I32X4_S:
+  case F32X4_CONVERT_I32X4_U:
+  case I32X4_TRUNC_SAT_F64X2_S_ZERO:
+  case I32X4_TRUNC_SAT_F64X2_U_ZERO:
+  case F64X2_CONVERT_LOW_I32X4_S:
+  case F64X2_CONVERT_LOW_I32X4_U:
+    popAndPushValueType(1, WASMType::V128, WASMType::V128);
+    break;
+  case I64X2_LT_S:
+  case I64X2_GT_S:
+  case I64X2_LE_S:
+  case I64X2_GE_S:
+  case F32X4_EQ:
+  case F32X4_NE:
+  case F32X4_LT:
+  case F32X4_GT:
+  case F32X4_LE:
+  case F32X4_GE:
+  case F64X2_EQ:
+  case F64X2_NE:
+  case F64X2_LT:
+  case F64X2_GT:
+  case F64X2_LE:
+  case F64X2_GE:
+  case I16X8_Q15MULR_SAT_S:
+  case I16X8_EXTMUL_LOW_I8X16_S:
+  case I16X8_EXTMUL_HIGH_I8X16_S:
+  case I16X8_EXTMUL_LOW_I8X16_U:
+  case I16X8_EXTMUL_HIGH_I8X16_U:
+  case I32X4_EXTMUL_LOW_I16X8_S:
+  case I32X4_EXTMUL_HIGH_I16X8_S:
+  case I32X4_EXTMUL_LOW_I16X8_U:
+  case I32X4_EXTMUL_HIGH_I16X8_U:
+  case F32X4_MIN:
+  case F32X4_MAX:
+  case F64X2_MIN:
+  case F64X2_MAX:
+    popAndPushValueType(2, WASMType::V128, WASMType::V128);
+    break;
+  default:
+    throw getErrorWithExtraMessage(ErrorCode::UnsupportedOpcode,
+                                   getOpcodeHexString(FD_PREFIX) + " " +
+                                       std::to_string(SubOpcode));
+  }
+}
+
 void FunctionLoader::load() {
   pushBlock(LABEL_FUNCTION, ControlBlockType(&FuncTypeEntry), Ptr);
 #ifdef ZEN_ENABLE_DWASM
@@ -287,8 +713,8 @@ void FunctionLoader::load() {
       [[fallthrough]];
     case BLOCK:
     case LOOP: {
-      WASMType Type = readBlockType();
-      ControlBlockType BlockType = Type;
+      ControlBlockType BlockType = readControlBlockType();
+      popBlockParamTypes(BlockType);
       auto BlockLabelTy = static_cast<LabelType>(LABEL_BLOCK + Opcode - BLOCK);
       pushBlock(BlockLabelTy, BlockType, Ptr);
 
@@ -325,25 +751,25 @@ void FunctionLoader::load() {
       const WASMType *ExpectedTypes = nullptr;
       for (uint32_t I = 0; I <= NumTargets; ++I) {
         const ControlBlock &TargetBlock = checkBranch();
-        const LabelType &TargetLabelType = TargetBlock.LabelType;
         const ControlBlockType &TargetBlockType = TargetBlock.BlockType;
-        if (I == 0) {
-          if (TargetLabelType != LABEL_LOOP) {
-            std::tie(ExpectedNumTypes, ExpectedTypes) =
-                TargetBlockType.getReturnTypes();
-          }
+        // branching to a loop carries its params
+        uint32_t ActualNumTypes = 0;
+        const WASMType *ActualTypes = nullptr;
+        if (TargetBlock.LabelType == LABEL_LOOP) {
+          std::tie(ActualNumTypes, ActualTypes) =
+              TargetBlockType.getParamTypes();
         } else {
-          uint32_t ActualNumTypes = 0;
-          const WASMType *ActualTypes = nullptr;
-          if (TargetLabelType != LABEL_LOOP) {
-            std::tie(ActualNumTypes, ActualTypes) =
-                TargetBlockType.getReturnTypes();
-          }
-          if ((ExpectedNumTypes != ActualNumTypes) ||
-              (ExpectedNumTypes != 0 && (std::memcmp(ExpectedTypes, ActualTypes,
-                                                     ExpectedNumTypes) != 0))) {
-            throw getError(ErrorCode::TypeMismatchBrTableTargets);
-          }
+          std::tie(ActualNumTypes, ActualTypes) =
+              TargetBlockType.getReturnTypes();
+        }
+        if (I == 0) {
+          ExpectedNumTypes = ActualNumTypes;
+          ExpectedTypes = ActualTypes;
+        } else if ((ExpectedNumTypes != ActualNumTypes) ||
+                   (ExpectedNumTypes != 0 &&
+                    (std::memcmp(ExpectedTypes, ActualTypes,
+                                 ExpectedNumTypes * sizeof(WASMType)) != 0))) {
+          throw getError(ErrorCode::TypeMismatchBrTableTargets);
         }
       }
 
@@ -456,6 +882,51 @@ void FunctionLoader::load() {
 
       break;
     }
+    case FC_PREFIX: {
+      uint32_t SubOpcode = readU32();
+      if (SubOpcode < MEMORY_INIT || SubOpcode > MEMORY_FILL) {
+        throw getErrorWithExtraMessage(ErrorCode::UnsupportedOpcode,
+                                       getOpcodeHexString(Opcode) + " " +
+                                           std::to_string(SubOpcode));
+      }
+
+      if (SubOpcode == MEMORY_INIT || SubOpcode == DATA_DROP) {
+        // the data count section must precede the code section
+        if (Mod.DataCount == -1u) {
+          throw getError(ErrorCode::DataCountSectionRequired);
+        }
+        uint32_t DataIdx = readU32();
+        if (DataIdx >= Mod.DataCount) {
+          throw getError(ErrorCode::UnknownDataSegment);
+        }
+        if (SubOpcode == DATA_DROP) {
+          break;
+        }
+      }
+
+      if (!hasMemory()) {
+        throw getError(ErrorCode::UnknownMemory);
+      }
+      uint32_t NumMemIdxs = SubOpcode == MEMORY_COPY ? 2 : 1;
+      for (uint32_t I = 0; I < NumMemIdxs; ++I) {
+        uint8_t MemIdx = to_underlying(readByte());
+        if (MemIdx != 0x00) {
+          throw getError(ErrorCode::ZeroFlagExpected);
+        }
+      }
+
+      // [dst, src or value, len] -> []
+      popValueType(WASMType::I32);
+      popValueType(WASMType::I32);
+      popValueType(WASMType::I32);
+
+      FuncCodeEntry.Stats |= Module::SF_memory;
+
+      break;
+    }
+    case FD_PREFIX:
+      loadSIMDInstruction();
+      break;
     case I32_CONST: {
       [[maybe_unused]] uint32_t I32 = readI32();
       pushValueType(WASMType::I32);
@@ -754,6 +1225,9 @@ void FunctionLoader::load() {
       if (Type == WASMType::I64 || Type == WASMType::F64) {
         Byte *OpcodePtr = const_cast<Byte *>(Ptr - 1);
         *OpcodePtr = Byte(DROP_64);
+      } else if (Type == WASMType::V128) {
+        Byte *OpcodePtr = const_cast<Byte *>(Ptr - 1);
+        *OpcodePtr = Byte(DROP_V128);
       }
       break;
     }
@@ -771,6 +1245,9 @@ void FunctionLoader::load() {
       if (Type == WASMType::I64 || Type == WASMType::F64) {
         Byte *OpcodePtr = const_cast<Byte *>(Ptr - 1);
         *OpcodePtr = Byte(SELECT_64);
+      } else if (Type == WASMType::V128) {
+        Byte *OpcodePtr = const_cast<Byte *>(Ptr - 1);
+        *OpcodePtr = Byte(SELECT_V128);
       }
       pushValueType(Type);
 
@@ -779,26 +1256,34 @@ void FunctionLoader::load() {
     case RETURN: {
       int32_t NumReturns = static_cast<int32_t>(FuncTypeEntry.NumReturns);
       for (int32_t I = NumReturns - 1; I >= 0; --I) {
-        popValueType(FuncTypeEntry.ReturnTypes[I]);
+        popValueType(FuncTypeEntry.getReturnTypes()[I]);
       }
       resetStack();
       setStackPolymorphic(true);
       break;
     }
-    case CALL: {
+    case CALL:
+    case RETURN_CALL: {
       uint32_t CalleeIdx = readU32();
       if (!Mod.isValidFunc(CalleeIdx)) {
         throw getErrorWithExtraMessage(ErrorCode::UnknownFunction,
                                        '#' + std::to_string(CalleeIdx));
       }
-      const TypeEntry *CalleeFuncType = Mod.getFunctionType(CalleeIdx);
+      TypeEntry *CalleeFuncType = Mod.getFunctionType(CalleeIdx);
       int32_t NumParams = static_cast<int32_t>(CalleeFuncType->NumParams);
       for (int32_t I = NumParams; I > 0; --I) {
         const WASMType *ParamTypes = CalleeFuncType->getParamTypes();
         popValueType(ParamTypes[I - 1]);
       }
-      for (uint32_t I = 0; I < CalleeFuncType->NumReturns; ++I) {
-        pushValueType(CalleeFuncType->ReturnTypes[I]);
+      if (Opcode == RETURN_CALL) {
+        endTailCall(*CalleeFuncType);
+        if (CalleeIdx == Mod.getNumImportFunctions() + FuncIdx) {
+          FuncCodeEntry.Stats |= Module::SF_self_tail_call;
+        }
+      } else {
+        for (uint32_t I = 0; I < CalleeFuncType->NumReturns; ++I) {
+          pushValueType(CalleeFuncType->getReturnTypes()[I]);
+        }
       }
 #ifdef ZEN_ENABLE_MULTIPASS_JIT
       if (!CalleeIdxBitset[CalleeIdx]) {
@@ -808,7 +1293,8 @@ void FunctionLoader::load() {
 #endif
       break;
     }
-    case CALL_INDIRECT: {
+    case CALL_INDIRECT:
+    case RETURN_CALL_INDIRECT: {
       uint32_t TypeIdx = readU32();
       if (!Mod.isValidType(TypeIdx)) {
         throw getError(ErrorCode::UnknownTypeIdx);
@@ -832,8 +1318,13 @@ void FunctionLoader::load() {
         popValueType(ParamTypes[I - 1]);
       }
 
-      for (uint32_t I = 0; I < CalleeFuncType->NumReturns; ++I) {
-        pushValueType(CalleeFuncType->ReturnTypes[I]);
+      if (Opcode == RETURN_CALL_INDIRECT) {
+        endTailCall(*CalleeFuncType);
+        Mod.TailCalls.HasIndirect = true;
+      } else {
+        for (uint32_t I = 0; I < CalleeFuncType->NumReturns; ++I) {
+          pushValueType(CalleeFuncType->getReturnTypes()[I]);
+        }
       }
 #ifdef ZEN_ENABLE_MULTIPASS_JIT
       const auto &LikelyCalleeIdxs = Mod.TypedFuncRefs[TypeIdx];
@@ -93,6 +93,9 @@ private:
   WASMType popValueType(WASMType Type);
 
   void pushValueType(WASMType Type) {
+    if (Type == WASMType::V128) {
+      Mod.UsesSIMD = true;
+    }
     ValueTypes.push_back(Type);
     StackSize += getWASMTypeSize(Type);
     MaxStackSize = std::max(MaxStackSize, StackSize);
@@ -106,6 +109,11 @@ private:
     pushValueType(PushedType);
   }
 
+  // \return the block type, either a value type or a type index
+  ControlBlockType readControlBlockType();
+
+  void popBlockParamTypes(const ControlBlockType &BlockType);
+
   void pushBlockParamTypes();
 
   void checkTopTypes(ControlBlock &Block, uint32_t NumTypes,
@@ -118,8 +126,20 @@ private:
 
   const ControlBlock &checkBranch();
 
+  void endTailCall(runtime::TypeEntry &CalleeType);
+
   WASMType readLocal();
 
+  uint8_t readLaneIdx(uint8_t NumLanes);
+
+  // \p NaturalAlign is log2 of the size of the accessed memory
+  void readSIMDMemArg(uint32_t NaturalAlign);
+
+  void loadSIMDInstruction();
+
+  // the simd instructions which the multipass jit doesn't lower
+  void loadExtendedSIMDInstruction(uint32_t SubOpcode);
+
   uint32_t FuncIdx;
   const runtime::TypeEntry &FuncTypeEntry;
   runtime::CodeEntry &FuncCodeEntry;
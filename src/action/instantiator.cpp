@@ -91,6 +91,9 @@ void Instantiator::instantiateFunctions(Instance &Inst) {
     std::memset(Inst.Functions, 0,
                 sizeof(FunctionInstance) * NumImportFunctions);
   }
+#ifdef ZEN_ENABLE_JIT
+  Inst.JITCode = Mod.getLocalJITCode();
+#endif
   for (uint32_t I = 0; I < Inst.NumTotalFunctions; ++I) {
     FunctionInstance &FuncInst = Inst.Functions[I];
 
@@ -106,8 +109,7 @@ void Instantiator::instantiateFunctions(Instance &Inst) {
     FuncInst.NumParamCells = Type.NumParamCells;
     FuncInst.NumReturns = Type.NumReturns;
     FuncInst.NumReturnCells = Type.NumReturnCells;
-    std::memcpy(FuncInst.ReturnTypes, Type.ReturnTypes,
-                sizeof(FuncInst.ReturnTypes));
+    FuncInst.ReturnTypes = Type.ReturnTypes;
     FuncInst.ParamTypes = Type.ParamTypes;
     FuncInst.FuncType = &Type;
 
@@ -127,7 +129,8 @@ void Instantiator::instantiateFunctions(Instance &Inst) {
       FuncInst.MaxBlockDepth = Code.MaxBlockDepth;
       FuncInst.CodePtr = Code.CodePtr;
 #ifdef ZEN_ENABLE_JIT
-      FuncInst.JITCodePtr = Code.JITCodePtr;
+      FuncInst.JITCodePtr =
+          Mod.relocateJITCodePtr(Code.JITCodePtr, Inst.JITCode);
 #endif
       FuncInst.CodeSize = Code.CodeSize;
     }
@@ -203,12 +206,21 @@ static void checkAndUpdateMemPages(uint32_t VmMaxMemPages, uint32_t CurMemPages,
 }
 
 void Instantiator::initMemoryByDataSegments(Instance &Inst) {
+  const Module *Mod = Inst.Mod;
+  // only passive segments remain available to memory.init
+  Inst.DroppedDataSegs.resize(Mod->NumDataSegments);
+  for (uint32_t I = 0; I < Mod->NumDataSegments; ++I) {
+    Inst.DroppedDataSegs[I] = !Mod->DataTable[I].Passive;
+  }
+
   if (Inst.DataSegsInited) {
     return;
   }
-  const Module *Mod = Inst.Mod;
   for (uint32_t I = 0; I < Mod->NumDataSegments; ++I) {
     const auto &DataSeg = Mod->DataTable[I];
+    if (DataSeg.Passive) {
+      continue;
+    }
     uint32_t MemIdx = DataSeg.MemIdx;
     // should checked if MemIndex is valid in loader
     MemoryInstance &MemInst = Inst.Memories[MemIdx];
@@ -7,9 +7,13 @@
 #include "entrypoint/entrypoint.h"
 #include "runtime/instance.h"
 #include "utils/logging.h"
+#include "utils/metrics.h"
 #include "utils/wasm.h"
+#include <algorithm>
 #include <bitset>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include <type_traits>
 
 namespace zen::action {
@@ -57,8 +61,12 @@ InterpFrame *InterpreterExecContext::allocFrame(FunctionInstance *FuncInst,
   Frame->PrevFrame = getCurFrame();
 
   setCurFrame(Frame);
-#ifdef ZEN_ENABLE_DWASM
   runtime::Instance *Inst = getInstance();
+  if (ZEN_UNLIKELY(Inst->getFunctionCounters()) &&
+      FuncInst->Kind == FunctionKind::ByteCode) {
+    ++Inst->getFunctionCounters(FuncInst).Calls;
+  }
+#ifdef ZEN_ENABLE_DWASM
   uint32_t CurFuncStackCost =
       (FuncInst->NumParamCells + FuncInst->NumLocalCells) << 2;
   Inst->updateStackCost(CurFuncStackCost);
@@ -85,6 +93,29 @@ void InterpreterExecContext::freeFrame(FunctionInstance *FuncInst,
 #endif // ZEN_ENABLE_DWASM
 }
 
+InterpFrame *InterpreterExecContext::replaceFrame(FunctionInstance *FuncInst,
+                                                  InterpFrame *Frame,
+                                                  FunctionInstance *Callee,
+                                                  const uint32_t *Args) {
+  uint32_t *LocalPtr = Frame->LocalPtr;
+  InterpFrame *PrevFrame = Frame->PrevFrame;
+  freeFrame(FuncInst, Frame);
+
+  // the arguments take the place of the parameters of the current function,
+  // and the locals of the callee follow them below its frame
+  uint32_t NumParamCells = Callee->NumParamCells;
+  std::memmove(LocalPtr, Args, NumParamCells << 2);
+  uint8_t *ParamEnd = reinterpret_cast<uint8_t *>(LocalPtr + NumParamCells);
+  Stack->Top = std::max(Stack->Top, ParamEnd);
+
+  // the callee returns to the caller of the current function
+  if (PrevFrame) {
+    PrevFrame->ValueStackPtr = LocalPtr + NumParamCells;
+  }
+  setCurFrame(PrevFrame);
+  return allocFrame(Callee, LocalPtr);
+}
+
 enum BinaryOperator {
   BO_ADD,
   BO_SUB,
@@ -308,6 +339,581 @@ DECL_COMPARE_IMPL(LE, <=)
 DECL_COMPARE_IMPL(GE, >=)
 #undef DECL_COMPARE_IMPL
 
+// lanes of a v128 value viewed as LaneT, used by the simd fallback
+template <typename LaneT> struct SIMDLanes {
+  static constexpr uint32_t NumLanes = sizeof(V128) / sizeof(LaneT);
+  LaneT L[NumLanes];
+
+  SIMDLanes() = default;
+  explicit SIMDLanes(const V128 &V) { std::memcpy(L, &V, sizeof(V128)); }
+  V128 toV128() const {
+    V128 V;
+    std::memcpy(&V, L, sizeof(V128));
+    return V;
+  }
+};
+
+template <typename LaneT, typename Fn>
+static V128 simdUnaryOp(const V128 &V, Fn F) {
+  SIMDLanes<LaneT> X(V), R;
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = F(X.L[I]);
+  }
+  return R.toV128();
+}
+
+template <typename LaneT, typename Fn>
+static V128 simdBinaryOp(const V128 &LHS, const V128 &RHS, Fn F) {
+  SIMDLanes<LaneT> X(LHS), Y(RHS), R;
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = F(X.L[I], Y.L[I]);
+  }
+  return R.toV128();
+}
+
+// the unsigned integer lane as wide as LaneT, which also holds the masks of
+// float lanes
+template <typename LaneT>
+using SIMDMaskT = std::conditional_t<
+    sizeof(LaneT) == 1, uint8_t,
+    std::conditional_t<sizeof(LaneT) == 2, uint16_t,
+                       std::conditional_t<sizeof(LaneT) == 4, uint32_t,
+                                          uint64_t>>>;
+
+// lanes are all ones when the predicate holds, all zeros otherwise
+template <typename LaneT, typename Fn>
+static V128 simdCompareOp(const V128 &LHS, const V128 &RHS, Fn F) {
+  using MaskT = SIMDMaskT<LaneT>;
+  SIMDLanes<LaneT> X(LHS), Y(RHS);
+  SIMDLanes<MaskT> R;
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = F(X.L[I], Y.L[I]) ? static_cast<MaskT>(-1) : MaskT(0);
+  }
+  return R.toV128();
+}
+
+// LaneT must be unsigned to keep the wrap-around well defined
+template <typename LaneT> static V128 simdShiftOp(uint32_t SubOpcode,
+                                                  const V128 &V,
+                                                  uint32_t Count) {
+  using SignedT = std::make_signed_t<LaneT>;
+  Count &= sizeof(LaneT) * 8 - 1;
+  switch (SubOpcode) {
+  case I8X16_SHL:
+  case I16X8_SHL:
+  case I32X4_SHL:
+  case I64X2_SHL:
+    return simdUnaryOp<LaneT>(V, [Count](LaneT X) -> LaneT {
+      return X << Count;
+    });
+  case I8X16_SHR_S:
+  case I16X8_SHR_S:
+  case I32X4_SHR_S:
+  case I64X2_SHR_S:
+    return simdUnaryOp<LaneT>(V, [Count](LaneT X) -> LaneT {
+      return static_cast<SignedT>(X) >> Count;
+    });
+  default:
+    return simdUnaryOp<LaneT>(V, [Count](LaneT X) -> LaneT {
+      return X >> Count;
+    });
+  }
+}
+
+template <typename LaneT> static int32_t simdAllTrue(const V128 &V) {
+  SIMDLanes<LaneT> X(V);
+  for (uint32_t I = 0; I < X.NumLanes; ++I) {
+    if (X.L[I] == 0) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+template <typename LaneT> static int32_t simdBitmask(const V128 &V) {
+  SIMDLanes<std::make_signed_t<LaneT>> X(V);
+  int32_t Mask = 0;
+  for (uint32_t I = 0; I < X.NumLanes; ++I) {
+    Mask |= int32_t(X.L[I] < 0) << I;
+  }
+  return Mask;
+}
+
+template <typename LaneT> static V128 simdAbs(const V128 &V) {
+  return simdUnaryOp<LaneT>(V, [](LaneT X) -> LaneT {
+    return static_cast<std::make_signed_t<LaneT>>(X) < 0 ? LaneT(0) - X : X;
+  });
+}
+
+template <typename LaneT> static V128 simdMinMax(uint32_t SubOpcode,
+                                                 const V128 &LHS,
+                                                 const V128 &RHS) {
+  using SignedT = std::make_signed_t<LaneT>;
+  switch (SubOpcode) {
+  case I8X16_MIN_S:
+  case I16X8_MIN_S:
+  case I32X4_MIN_S:
+    return simdBinaryOp<SignedT>(
+        LHS, RHS, [](SignedT X, SignedT Y) { return std::min(X, Y); });
+  case I8X16_MAX_S:
+  case I16X8_MAX_S:
+  case I32X4_MAX_S:
+    return simdBinaryOp<SignedT>(
+        LHS, RHS, [](SignedT X, SignedT Y) { return std::max(X, Y); });
+  case I8X16_MIN_U:
+  case I16X8_MIN_U:
+  case I32X4_MIN_U:
+    return simdBinaryOp<LaneT>(
+        LHS, RHS, [](LaneT X, LaneT Y) { return std::min(X, Y); });
+  default:
+    return simdBinaryOp<LaneT>(
+        LHS, RHS, [](LaneT X, LaneT Y) { return std::max(X, Y); });
+  }
+}
+
+static uint8_t *getSIMDAccessAddr(MemoryInstance *Memory, uint32_t Addr,
+                                  uint32_t Offset, uint32_t Size,
+                                  uint64_t LinearMemSize) {
+  if ((uint64_t)Offset + Size + Addr > LinearMemSize) {
+    throw getError(ErrorCode::OutOfBoundsMemory);
+  }
+  return Memory->MemBase + Offset + Addr;
+}
+
+// the load of 8 bytes widened to 16
+template <typename DstT, typename SrcT>
+static V128 simdLoadExtend(const uint8_t *Start) {
+  SIMDLanes<DstT> R;
+  SrcT Src[SIMDLanes<DstT>::NumLanes];
+  std::memcpy(Src, Start, sizeof(Src));
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = Src[I];
+  }
+  return R.toV128();
+}
+
+template <typename LaneT> static V128 simdLoadSplat(const uint8_t *Start) {
+  LaneT Scalar;
+  std::memcpy(&Scalar, Start, sizeof(LaneT));
+  SIMDLanes<LaneT> R;
+  std::fill(R.L, R.L + R.NumLanes, Scalar);
+  return R.toV128();
+}
+
+template <typename LaneT> static V128 simdLoadZero(const uint8_t *Start) {
+  SIMDLanes<LaneT> R;
+  std::fill(R.L, R.L + R.NumLanes, LaneT(0));
+  std::memcpy(R.L, Start, sizeof(LaneT));
+  return R.toV128();
+}
+
+// \p High selects the upper half of the source lanes
+template <typename DstT, typename SrcT>
+static V128 simdExtend(const V128 &V, bool High) {
+  SIMDLanes<SrcT> X(V);
+  SIMDLanes<DstT> R;
+  uint32_t Base = High ? R.NumLanes : 0;
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = X.L[Base + I];
+  }
+  return R.toV128();
+}
+
+template <typename DstT, typename SrcT>
+static V128 simdExtMul(const V128 &LHS, const V128 &RHS, bool High) {
+  SIMDLanes<SrcT> X(LHS), Y(RHS);
+  SIMDLanes<DstT> R;
+  uint32_t Base = High ? R.NumLanes : 0;
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = static_cast<DstT>(DstT(X.L[Base + I]) * DstT(Y.L[Base + I]));
+  }
+  return R.toV128();
+}
+
+template <typename DstT, typename SrcT>
+static V128 simdExtAddPairwise(const V128 &V) {
+  SIMDLanes<SrcT> X(V);
+  SIMDLanes<DstT> R;
+  for (uint32_t I = 0; I < R.NumLanes; ++I) {
+    R.L[I] = static_cast<DstT>(DstT(X.L[2 * I]) + DstT(X.L[2 * I + 1]));
+  }
+  return R.toV128();
+}
+
+template <typename DstT, typename SrcT> static DstT saturate(SrcT X) {
+  return static_cast<DstT>(
+      std::clamp<SrcT>(X, std::numeric_limits<DstT>::min(),
+                       std::numeric_limits<DstT>::max()));
+}
+
+// the lanes of \p LHS then \p RHS, saturated to the narrower lanes
+template <typename DstT, typename SrcT>
+static V128 simdNarrow(const V128 &LHS, const V128 &RHS) {
+  SIMDLanes<SrcT> X(LHS), Y(RHS);
+  SIMDLanes<DstT> R;
+  for (uint32_t I = 0; I < X.NumLanes; ++I) {
+    R.L[I] = saturate<DstT>(X.L[I]);
+    R.L[X.NumLanes + I] = saturate<DstT>(Y.L[I]);
+  }
+  return R.toV128();
+}
+
+// LaneT is one of the 8 and 16-bit lanes, which int holds exactly
+template <typename LaneT>
+static V128 simdSaturatingOp(const V128 &LHS, const V128 &RHS, bool IsSub) {
+  return simdBinaryOp<LaneT>(LHS, RHS, [IsSub](LaneT X, LaneT Y) {
+    return saturate<LaneT>(IsSub ? int32_t(X) - Y : int32_t(X) + Y);
+  });
+}
+
+template <typename LaneT>
+static V128 simdAvgRound(const V128 &LHS, const V128 &RHS) {
+  return simdBinaryOp<LaneT>(LHS, RHS, [](LaneT X, LaneT Y) {
+    return static_cast<LaneT>((uint32_t(X) + Y + 1) >> 1);
+  });
+}
+
+// nan converts to 0, out of range values to the nearest bound
+template <typename IntT, typename FloatT> static IntT truncateSat(FloatT X) {
+  if (std::isnan(X)) {
+    return 0;
+  }
+  if (X <= static_cast<FloatT>(std::numeric_limits<IntT>::min())) {
+    return std::numeric_limits<IntT>::min();
+  }
+  if (X >= static_cast<FloatT>(std::numeric_limits<IntT>::max())) {
+    return std::numeric_limits<IntT>::max();
+  }
+  return static_cast<IntT>(X);
+}
+
+// the lanes converted from f64x2 are the low half, the high half is zero
+template <typename IntT, typename FloatT>
+static V128 simdTruncateSat(const V128 &V) {
+  SIMDLanes<FloatT> X(V);
+  SIMDLanes<IntT> R;
+  std::fill(R.L, R.L + R.NumLanes, IntT(0));
+  for (uint32_t I = 0; I < X.NumLanes; ++I) {
+    R.L[I] = truncateSat<IntT>(X.L[I]);
+  }
+  return R.toV128();
+}
+
+// converts the low lanes which fit in the result, the others are zero
+template <typename FloatT, typename SrcT>
+static V128 simdConvert(const V128 &V) {
+  SIMDLanes<SrcT> X(V);
+  SIMDLanes<FloatT> R;
+  std::fill(R.L, R.L + R.NumLanes, FloatT(0));
+  for (uint32_t I = 0; I < std::min(X.NumLanes, R.NumLanes); ++I) {
+    R.L[I] = CanonNaN(static_cast<FloatT>(X.L[I]));
+  }
+  return R.toV128();
+}
+
+// abs and neg only touch the sign bit, nan payloads are kept
+template <typename FloatT>
+static V128 simdFloatSignOp(const V128 &V, bool IsNeg) {
+  using BitsT = SIMDMaskT<FloatT>;
+  constexpr BitsT SignBit = BitsT(1) << (sizeof(BitsT) * 8 - 1);
+  return simdUnaryOp<BitsT>(V, [IsNeg](BitsT X) -> BitsT {
+    return IsNeg ? X ^ SignBit : X & ~SignBit;
+  });
+}
+
+template <typename FloatT, BinaryOperator Op>
+static V128 simdFloatMathOp(const V128 &V) {
+  return simdUnaryOp<FloatT>(V, [](FloatT X) {
+    switch (Op) {
+    case BM_SQRT:
+      return CanonNaN(std::sqrt(X));
+    case BM_FLOOR:
+      return CanonNaN(std::floor(X));
+    case BM_CEIL:
+      return CanonNaN(std::ceil(X));
+    case BM_TRUNC:
+      return CanonNaN(std::trunc(X));
+    default:
+      return CanonNaN(std::rint(X));
+    }
+  });
+}
+
+template <typename FloatT>
+static V128 simdFloatCompareOp(uint32_t SubOpcode, const V128 &LHS,
+                               const V128 &RHS) {
+  // eq, ne, lt, gt, le and ge in the order of the opcodes
+  switch ((SubOpcode - F32X4_EQ) % (F64X2_EQ - F32X4_EQ)) {
+  case 0:
+    return simdCompareOp<FloatT>(LHS, RHS, std::equal_to<FloatT>());
+  case 1:
+    return simdCompareOp<FloatT>(LHS, RHS, std::not_equal_to<FloatT>());
+  case 2:
+    return simdCompareOp<FloatT>(LHS, RHS, std::less<FloatT>());
+  case 3:
+    return simdCompareOp<FloatT>(LHS, RHS, std::greater<FloatT>());
+  case 4:
+    return simdCompareOp<FloatT>(LHS, RHS, std::less_equal<FloatT>());
+  default:
+    return simdCompareOp<FloatT>(LHS, RHS, std::greater_equal<FloatT>());
+  }
+}
+
+// the integer comparisons beyond eq, ne, lt_s and gt_s, in the opcode order
+// lt_s lt_u gt_s gt_u le_s le_u ge_s ge_u from \p LtS
+template <typename LaneT>
+static V128 simdIntCompareOp(uint32_t SubOpcode, uint32_t LtS,
+                             const V128 &LHS, const V128 &RHS) {
+  using SignedT = std::make_signed_t<LaneT>;
+  switch (SubOpcode - LtS) {
+  case 1:
+    return simdCompareOp<LaneT>(LHS, RHS, std::less<LaneT>());
+  case 3:
+    return simdCompareOp<LaneT>(LHS, RHS, std::greater<LaneT>());
+  case 4:
+    return simdCompareOp<SignedT>(LHS, RHS, std::less_equal<SignedT>());
+  case 5:
+    return simdCompareOp<LaneT>(LHS, RHS, std::less_equal<LaneT>());
+  case 6:
+    return simdCompareOp<SignedT>(LHS, RHS, std::greater_equal<SignedT>());
+  case 7:
+    return simdCompareOp<LaneT>(LHS, RHS, std::greater_equal<LaneT>());
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+// the remaining unary simd ops
+static V128 simdExtendedUnaryOp(uint32_t SubOpcode, const V128 &V) {
+  switch (SubOpcode) {
+  case I8X16_POPCNT:
+    return simdUnaryOp<uint8_t>(V, [](uint8_t X) {
+      return static_cast<uint8_t>(std::bitset<8>(X).count());
+    });
+  case I64X2_ABS:
+    return simdAbs<uint64_t>(V);
+  case I16X8_EXTADD_PAIRWISE_I8X16_S:
+    return simdExtAddPairwise<int16_t, int8_t>(V);
+  case I16X8_EXTADD_PAIRWISE_I8X16_U:
+    return simdExtAddPairwise<uint16_t, uint8_t>(V);
+  case I32X4_EXTADD_PAIRWISE_I16X8_S:
+    return simdExtAddPairwise<int32_t, int16_t>(V);
+  case I32X4_EXTADD_PAIRWISE_I16X8_U:
+    return simdExtAddPairwise<uint32_t, uint16_t>(V);
+  case I16X8_EXTEND_LOW_I8X16_S:
+  case I16X8_EXTEND_HIGH_I8X16_S:
+    return simdExtend<int16_t, int8_t>(V,
+                                       SubOpcode == I16X8_EXTEND_HIGH_I8X16_S);
+  case I16X8_EXTEND_LOW_I8X16_U:
+  case I16X8_EXTEND_HIGH_I8X16_U:
+    return simdExtend<uint16_t, uint8_t>(
+        V, SubOpcode == I16X8_EXTEND_HIGH_I8X16_U);
+  case I32X4_EXTEND_LOW_I16X8_S:
+  case I32X4_EXTEND_HIGH_I16X8_S:
+    return simdExtend<int32_t, int16_t>(
+        V, SubOpcode == I32X4_EXTEND_HIGH_I16X8_S);
+  case I32X4_EXTEND_LOW_I16X8_U:
+  case I32X4_EXTEND_HIGH_I16X8_U:
+    return simdExtend<uint32_t, uint16_t>(
+        V, SubOpcode == I32X4_EXTEND_HIGH_I16X8_U);
+  case I64X2_EXTEND_LOW_I32X4_S:
+  case I64X2_EXTEND_HIGH_I32X4_S:
+    return simdExtend<int64_t, int32_t>(
+        V, SubOpcode == I64X2_EXTEND_HIGH_I32X4_S);
+  case I64X2_EXTEND_LOW_I32X4_U:
+  case I64X2_EXTEND_HIGH_I32X4_U:
+    return simdExtend<uint64_t, uint32_t>(
+        V, SubOpcode == I64X2_EXTEND_HIGH_I32X4_U);
+  case F32X4_ABS:
+  case F32X4_NEG:
+    return simdFloatSignOp<float>(V, SubOpcode == F32X4_NEG);
+  case F64X2_ABS:
+  case F64X2_NEG:
+    return simdFloatSignOp<double>(V, SubOpcode == F64X2_NEG);
+  case F32X4_SQRT:
+    return simdFloatMathOp<float, BM_SQRT>(V);
+  case F32X4_CEIL:
+    return simdFloatMathOp<float, BM_CEIL>(V);
+  case F32X4_FLOOR:
+    return simdFloatMathOp<float, BM_FLOOR>(V);
+  case F32X4_TRUNC:
+    return simdFloatMathOp<float, BM_TRUNC>(V);
+  case F32X4_NEAREST:
+    return simdFloatMathOp<float, BM_NEAREST>(V);
+  case F64X2_SQRT:
+    return simdFloatMathOp<double, BM_SQRT>(V);
+  case F64X2_CEIL:
+    return simdFloatMathOp<double, BM_CEIL>(V);
+  case F64X2_FLOOR:
+    return simdFloatMathOp<double, BM_FLOOR>(V);
+  case F64X2_TRUNC:
+    return simdFloatMathOp<double, BM_TRUNC>(V);
+  case F64X2_NEAREST:
+    return simdFloatMathOp<double, BM_NEAREST>(V);
+  case I32X4_TRUNC_SAT_F32X4_S:
+  case I32X4_TRUNC_SAT_F64X2_S_ZERO:
+    return SubOpcode == I32X4_TRUNC_SAT_F32X4_S
+               ? simdTruncateSat<int32_t, float>(V)
+               : simdTruncateSat<int32_t, double>(V);
+  case I32X4_TRUNC_SAT_F32X4_U:
+  case I32X4_TRUNC_SAT_F64X2_U_ZERO:
+    return SubOpcode == I32X4_TRUNC_SAT_F32X4_U
+               ? simdTruncateSat<uint32_t, float>(V)
+               : simdTruncateSat<uint32_t, double>(V);
+  case F32X4_CONVERT_I32X4_S:
+    return simdConvert<float, int32_t>(V);
+  case F32X4_CONVERT_I32X4_U:
+    return simdConvert<float, uint32_t>(V);
+  case F64X2_CONVERT_LOW_I32X4_S:
+    return simdConvert<double, int32_t>(V);
+  case F64X2_CONVERT_LOW_I32X4_U:
+    return simdConvert<double, uint32_t>(V);
+  case F32X4_DEMOTE_F64X2_ZERO:
+    return simdConvert<float, double>(V);
+  case F64X2_PROMOTE_LOW_F32X4:
+    return simdConvert<double, float>(V);
+  default:
+    // rejected by the function loader
+    ZEN_UNREACHABLE();
+  }
+}
+
+// the remaining binary simd ops
+static V128 simdExtendedBinaryOp(uint32_t SubOpcode, const V128 &LHS,
+                                 const V128 &RHS) {
+  switch (SubOpcode) {
+  case I8X16_LT_U:
+  case I8X16_GT_U:
+  case I8X16_LE_S:
+  case I8X16_LE_U:
+  case I8X16_GE_S:
+  case I8X16_GE_U:
+    return simdIntCompareOp<uint8_t>(SubOpcode, I8X16_LT_S, LHS, RHS);
+  case I16X8_LT_U:
+  case I16X8_GT_U:
+  case I16X8_LE_S:
+  case I16X8_LE_U:
+  case I16X8_GE_S:
+  case I16X8_GE_U:
+    return simdIntCompareOp<uint16_t>(SubOpcode, I16X8_LT_S, LHS, RHS);
+  case I32X4_LT_U:
+  case I32X4_GT_U:
+  case I32X4_LE_S:
+  case I32X4_LE_U:
+  case I32X4_GE_S:
+  case I32X4_GE_U:
+    return simdIntCompareOp<uint32_t>(SubOpcode, I32X4_LT_S, LHS, RHS);
+  case I64X2_LT_S:
+    return simdCompareOp<int64_t>(LHS, RHS, std::less<int64_t>());
+  case I64X2_GT_S:
+    return simdCompareOp<int64_t>(LHS, RHS, std::greater<int64_t>());
+  case I64X2_LE_S:
+    return simdCompareOp<int64_t>(LHS, RHS, std::less_equal<int64_t>());
+  case I64X2_GE_S:
+    return simdCompareOp<int64_t>(LHS, RHS, std::greater_equal<int64_t>());
+  case F32X4_EQ:
+  case F32X4_NE:
+  case F32X4_LT:
+  case F32X4_GT:
+  case F32X4_LE:
+  case F32X4_GE:
+    return simdFloatCompareOp<float>(SubOpcode, LHS, RHS);
+  case F64X2_EQ:
+  case F64X2_NE:
+  case F64X2_LT:
+  case F64X2_GT:
+  case F64X2_LE:
+  case F64X2_GE:
+    return simdFloatCompareOp<double>(SubOpcode, LHS, RHS);
+  case I8X16_NARROW_I16X8_S:
+    return simdNarrow<int8_t, int16_t>(LHS, RHS);
+  case I8X16_NARROW_I16X8_U:
+    return simdNarrow<uint8_t, int16_t>(LHS, RHS);
+  case I16X8_NARROW_I32X4_S:
+    return simdNarrow<int16_t, int32_t>(LHS, RHS);
+  case I16X8_NARROW_I32X4_U:
+    return simdNarrow<uint16_t, int32_t>(LHS, RHS);
+  case I8X16_ADD_SAT_S:
+  case I8X16_SUB_SAT_S:
+    return simdSaturatingOp<int8_t>(LHS, RHS, SubOpcode == I8X16_SUB_SAT_S);
+  case I8X16_ADD_SAT_U:
+  case I8X16_SUB_SAT_U:
+    return simdSaturatingOp<uint8_t>(LHS, RHS, SubOpcode == I8X16_SUB_SAT_U);
+  case I16X8_ADD_SAT_S:
+  case I16X8_SUB_SAT_S:
+    return simdSaturatingOp<int16_t>(LHS, RHS, SubOpcode == I16X8_SUB_SAT_S);
+  case I16X8_ADD_SAT_U:
+  case I16X8_SUB_SAT_U:
+    return simdSaturatingOp<uint16_t>(LHS, RHS,
+                                      SubOpcode == I16X8_SUB_SAT_U);
+  case I8X16_AVGR_U:
+    return simdAvgRound<uint8_t>(LHS, RHS);
+  case I16X8_AVGR_U:
+    return simdAvgRound<uint16_t>(LHS, RHS);
+  case I16X8_Q15MULR_SAT_S:
+    return simdBinaryOp<int16_t>(LHS, RHS, [](int16_t X, int16_t Y) {
+      return saturate<int16_t>((int32_t(X) * Y + 0x4000) >> 15);
+    });
+  case I16X8_EXTMUL_LOW_I8X16_S:
+  case I16X8_EXTMUL_HIGH_I8X16_S:
+    return simdExtMul<int16_t, int8_t>(
+        LHS, RHS, SubOpcode == I16X8_EXTMUL_HIGH_I8X16_S);
+  case I16X8_EXTMUL_LOW_I8X16_U:
+  case I16X8_EXTMUL_HIGH_I8X16_U:
+    return simdExtMul<uint16_t, uint8_t>(
+        LHS, RHS, SubOpcode == I16X8_EXTMUL_HIGH_I8X16_U);
+  case I32X4_EXTMUL_LOW_I16X8_S:
+  case I32X4_EXTMUL_HIGH_I16X8_S:
+    return simdExtMul<int32_t, int16_t>(
+        LHS, RHS, SubOpcode == I32X4_EXTMUL_HIGH_I16X8_S);
+  case I32X4_EXTMUL_LOW_I16X8_U:
+  case I32X4_EXTMUL_HIGH_I16X8_U:
+    return simdExtMul<uint32_t, uint16_t>(
+        LHS, RHS, SubOpcode == I32X4_EXTMUL_HIGH_I16X8_U);
+  case F32X4_ADD:
+    return simdBinaryOp<float>(LHS, RHS, BinaryOpHelper<float, BO_ADD>());
+  case F32X4_SUB:
+    return simdBinaryOp<float>(LHS, RHS, BinaryOpHelper<float, BO_SUB>());
+  case F32X4_MUL:
+    return simdBinaryOp<float>(LHS, RHS, BinaryOpHelper<float, BO_MUL>());
+  case F32X4_DIV:
+    return simdBinaryOp<float>(LHS, RHS, BinaryOpHelper<float, BO_DIV>());
+  case F32X4_MIN:
+    return simdBinaryOp<float>(LHS, RHS, BinaryOpHelper<float, BO_MIN>());
+  case F32X4_MAX:
+    return simdBinaryOp<float>(LHS, RHS, BinaryOpHelper<float, BO_MAX>());
+  case F64X2_ADD:
+    return simdBinaryOp<double>(LHS, RHS, BinaryOpHelper<double, BO_ADD>());
+  case F64X2_SUB:
+    return simdBinaryOp<double>(LHS, RHS, BinaryOpHelper<double, BO_SUB>());
+  case F64X2_MUL:
+    return simdBinaryOp<double>(LHS, RHS, BinaryOpHelper<double, BO_MUL>());
+  case F64X2_DIV:
+    return simdBinaryOp<double>(LHS, RHS, BinaryOpHelper<double, BO_DIV>());
+  case F64X2_MIN:
+    return simdBinaryOp<double>(LHS, RHS, BinaryOpHelper<double, BO_MIN>());
+  case F64X2_MAX:
+    return simdBinaryOp<double>(LHS, RHS, BinaryOpHelper<double, BO_MAX>());
+  // the pseudo min and max are the select of a comparison, without the nan
+  // and signed zero rules
+  case F32X4_PMIN:
+    return simdBinaryOp<float>(
+        LHS, RHS, [](float X, float Y) { return Y < X ? Y : X; });
+  case F32X4_PMAX:
+    return simdBinaryOp<float>(
+        LHS, RHS, [](float X, float Y) { return X < Y ? Y : X; });
+  case F64X2_PMIN:
+    return simdBinaryOp<double>(
+        LHS, RHS, [](double X, double Y) { return Y < X ? Y : X; });
+  case F64X2_PMAX:
+    return simdBinaryOp<double>(
+        LHS, RHS, [](double X, double Y) { return X < Y ? Y : X; });
+  default:
+    // rejected by the function loader
+    ZEN_UNREACHABLE();
+  }
+}
+
 class BaseInterpreterImpl {
 private:
   InterpreterExecContext &Context;
@@ -382,8 +988,10 @@ private:
       }
       case DROP:
       case DROP_64:
+      case DROP_V128:
       case SELECT:
       case SELECT_64:
+      case SELECT_V128:
         break;
       case GET_GLOBAL_64:
       case SET_GLOBAL_64: {
@@ -568,13 +1176,27 @@ private:
       case MEMORY_GROW:
         Ptr = skipLEBNumber<uint32_t>(Ptr, End);
         break;
+      case FC_PREFIX: {
+        uint32_t SubOpcode = 0;
+        Ptr = readSafeLEBNumber(Ptr, SubOpcode);
+        Ptr = skipFCImmediates(SubOpcode, Ptr, End);
+        break;
+      }
+      case FD_PREFIX: {
+        uint32_t SubOpcode = 0;
+        Ptr = readSafeLEBNumber(Ptr, SubOpcode);
+        Ptr = skipFDImmediates(SubOpcode, Ptr, End);
+        break;
+      }
       case RETURN:
         break;
-      case CALL: {
+      case CALL:
+      case RETURN_CALL: {
         Ptr = skipLEBNumber<uint32_t>(Ptr, End);
         break;
       }
-      case CALL_INDIRECT: {
+      case CALL_INDIRECT:
+      case RETURN_CALL_INDIRECT: {
         Ptr = skipLEBNumber<uint32_t>(Ptr, End);
         Ptr++;
         break;
@@ -603,6 +1225,38 @@ private:
                     uint32_t *&ValStackPtr, BlockInfo *&ControlStackPtr,
                     uint32_t *&LocalPtr, FunctionInstance *&FuncInst);
 
+  void tailCallFuncInst(FunctionInstance *FuncInstCallee,
+                        InterpreterExecContext &Context, const uint8_t *&Ip,
+                        const uint8_t *&IpEnd, InterpFrame *&Frame,
+                        uint32_t *&ValStackPtr, BlockInfo *&ControlStackPtr,
+                        uint32_t *&LocalPtr, FunctionInstance *&FuncInst);
+
+  FunctionInstance *getIndirectCallee(uint32_t TypeIdx, int32_t ElemIdx);
+
+  void useGas(FunctionInstance *FuncInst, uint64_t Delta);
+
+  // read the block type at \p Ip, either a value type or a type index
+  // (multi-value), \return the pointer after it
+  const uint8_t *readBlockCells(const uint8_t *Ip, uint32_t &NumParamCells,
+                                uint32_t &NumResultCells) {
+    WASMType Type = getWASMBlockTypeFromOpcode(*Ip);
+    if (Type != WASMType::ERROR_TYPE) {
+      NumParamCells = 0;
+      NumResultCells = getWASMTypeCellNum(Type);
+      return Ip + 1;
+    }
+    int64_t TypeIdx;
+    Ip = readSafeLEBNumber(Ip, TypeIdx);
+    const Module *Mod = Context.getInstance()->getModule();
+    const TypeEntry *BlockType = Mod->getDeclaredType(TypeIdx);
+    NumParamCells = BlockType->NumParamCells;
+    NumResultCells = BlockType->NumReturnCells;
+    return Ip;
+  }
+
+  void simdOp(MemoryInstance *Memory, const uint8_t *&Ip, InterpFrame *Frame,
+              uint32_t *&ValStackPtr, uint64_t LinearMemSize);
+
   template <bool Sign, BinaryOperator Opr, typename SignedT, typename UnsignedT,
             typename WasmReturnType>
   WasmReturnType handleCheckedArithmeticImpl(WasmReturnType LHS,
@@ -1035,7 +1689,7 @@ void BaseInterpreterImpl::callFuncInst(
     size_t ReturnCount = Callee->NumReturns;
     std::vector<TypedValue> Result(ReturnCount);
     for (size_t I = 0; I < ReturnCount; ++I) {
-      Result[I].Type = Callee->ReturnTypes[I];
+      Result[I].Type = Callee->getReturnTypes()[I];
     }
 
     Instance *Instance = Context.getInstance();
@@ -1047,9 +1701,12 @@ void BaseInterpreterImpl::callFuncInst(
     Instance->setInHostAPI(true);
 #endif // ZEN_ENABLE_DWASM
 
-    entrypoint::callNativeGeneral(
-        Instance, GenericFunctionPointer(Callee->CodePtr), Args, Result,
-        Instance->getRuntime()->getMemAllocator(), true);
+    {
+      utils::ScopedMetricTimer MetricTimer(utils::MetricLatency::HostCall);
+      entrypoint::callNativeGeneral(
+          Instance, GenericFunctionPointer(Callee->CodePtr), Args, Result,
+          Instance->getRuntime()->getMemAllocator(), true);
+    }
 
 #ifdef ZEN_ENABLE_DWASM
     Instance->setInHostAPI(false);
@@ -1105,6 +1762,624 @@ void BaseInterpreterImpl::callFuncInst(
   }
 }
 
+void BaseInterpreterImpl::tailCallFuncInst(
+    FunctionInstance *Callee, InterpreterExecContext &Context,
+    const uint8_t *&Ip, const uint8_t *&IpEnd, InterpFrame *&Frame,
+    uint32_t *&ValStackPtr, BlockInfo *&ControlStackPtr, uint32_t *&LocalPtr,
+    FunctionInstance *&FuncInst) {
+  ZEN_ASSERT(Callee != nullptr);
+  ZEN_ASSERT(Callee->Kind == FunctionKind::ByteCode);
+
+  Frame = Context.replaceFrame(FuncInst, Frame, Callee,
+                               ValStackPtr - Callee->NumParamCells);
+  if (Frame == nullptr) {
+    throw getError(ErrorCode::CallStackExhausted);
+  }
+  // update frame
+  updateFrame(Ip, IpEnd, Frame, ValStackPtr, ControlStackPtr, LocalPtr,
+              FuncInst, false);
+
+  // init local vars
+  std::memset(LocalPtr + FuncInst->NumParamCells, 0,
+              ((uint32_t)FuncInst->NumLocalCells) << 2);
+
+  Frame->blockPush(ControlStackPtr, IpEnd - 1, ValStackPtr,
+                   FuncInst->NumReturnCells, LABEL_FUNCTION);
+}
+
+FunctionInstance *BaseInterpreterImpl::getIndirectCallee(uint32_t TypeIdx,
+                                                         int32_t ElemIdx) {
+  Instance *ModInst = Context.getInstance();
+  // only table 0 is supported
+  TableInstance *Table = ModInst->getTableInst(0);
+  if (ElemIdx < 0 || (uint32_t)ElemIdx >= Table->CurSize) {
+    throw getError(ErrorCode::UndefinedElement);
+  }
+  uint32_t FuncIdx = Table->Elements[ElemIdx];
+#ifdef ZEN_ENABLE_DEBUG_INTERP
+  ZEN_LOG_DEBUG("fidx: %d", FuncIdx);
+#endif
+  if (FuncIdx == (uint32_t)-1) {
+    throw getError(ErrorCode::UninitializedElement);
+  }
+  auto *Callee = ModInst->getFunctionInst(FuncIdx);
+  ZEN_ASSERT(Callee);
+  auto *ExpectedFuncType = ModInst->getModule()->getDeclaredType(TypeIdx);
+  if (!TypeEntry::isEqual(Callee->FuncType, ExpectedFuncType)) {
+    throw getError(ErrorCode::IndirectCallTypeMismatch);
+  }
+  return Callee;
+}
+
+void BaseInterpreterImpl::useGas(FunctionInstance *FuncInst, uint64_t Delta) {
+  Instance *ModInst = Context.getInstance();
+  uint64_t GasLeft = ModInst->getGas();
+  if (GasLeft < Delta) {
+    ModInst->setGas(0);
+    throw getError(ErrorCode::GasLimitExceeded);
+  }
+  ModInst->setGas(GasLeft - Delta);
+  if (ZEN_UNLIKELY(ModInst->getFunctionCounters())) {
+    ModInst->getFunctionCounters(FuncInst).SelfGas += Delta;
+  }
+}
+
+void BaseInterpreterImpl::simdOp(MemoryInstance *Memory, const uint8_t *&Ip,
+                                 InterpFrame *Frame, uint32_t *&ValStackPtr,
+                                 uint64_t LinearMemSize) {
+  uint32_t SubOpcode = 0;
+  Ip = readSafeLEBNumber(Ip, SubOpcode);
+
+  switch (SubOpcode) {
+  case V128_LOAD:
+  case V128_STORE: {
+    uint32_t Align, Offset;
+    Ip = readSafeLEBNumber(Ip, Align);
+    Ip = readSafeLEBNumber(Ip, Offset);
+    V128 Val;
+    if (SubOpcode == V128_STORE) {
+      Val = Frame->valuePop<V128>(ValStackPtr);
+    }
+    uint32_t Addr = Frame->valuePop<uint32_t>(ValStackPtr);
+    uint8_t *Start = getSIMDAccessAddr(Memory, Addr, Offset, sizeof(V128),
+                                       LinearMemSize);
+    if (SubOpcode == V128_STORE) {
+      std::memcpy(Start, &Val, sizeof(V128));
+    } else {
+      std::memcpy(&Val, Start, sizeof(V128));
+      Frame->valuePush<V128>(ValStackPtr, Val);
+    }
+    return;
+  }
+  case V128_LOAD8X8_S:
+  case V128_LOAD8X8_U:
+  case V128_LOAD16X4_S:
+  case V128_LOAD16X4_U:
+  case V128_LOAD32X2_S:
+  case V128_LOAD32X2_U:
+  case V128_LOAD8_SPLAT:
+  case V128_LOAD16_SPLAT:
+  case V128_LOAD32_SPLAT:
+  case V128_LOAD64_SPLAT:
+  case V128_LOAD32_ZERO:
+  case V128_LOAD64_ZERO: {
+    uint32_t Align, Offset;
+    Ip = readSafeLEBNumber(Ip, Align);
+    Ip = readSafeLEBNumber(Ip, Offset);
+    uint32_t Size = 8;
+    if (SubOpcode >= V128_LOAD8_SPLAT && SubOpcode <= V128_LOAD64_SPLAT) {
+      Size = 1 << (SubOpcode - V128_LOAD8_SPLAT);
+    } else if (SubOpcode == V128_LOAD32_ZERO) {
+      Size = 4;
+    }
+    uint32_t Addr = Frame->valuePop<uint32_t>(ValStackPtr);
+    const uint8_t *Start =
+        getSIMDAccessAddr(Memory, Addr, Offset, Size, LinearMemSize);
+    V128 Val;
+    switch (SubOpcode) {
+    case V128_LOAD8X8_S:
+      Val = simdLoadExtend<int16_t, int8_t>(Start);
+      break;
+    case V128_LOAD8X8_U:
+      Val = simdLoadExtend<uint16_t, uint8_t>(Start);
+      break;
+    case V128_LOAD16X4_S:
+      Val = simdLoadExtend<int32_t, int16_t>(Start);
+      break;
+    case V128_LOAD16X4_U:
+      Val = simdLoadExtend<uint32_t, uint16_t>(Start);
+      break;
+    case V128_LOAD32X2_S:
+      Val = simdLoadExtend<int64_t, int32_t>(Start);
+      break;
+    case V128_LOAD32X2_U:
+      Val = simdLoadExtend<uint64_t, uint32_t>(Start);
+      break;
+    case V128_LOAD8_SPLAT:
+      Val = simdLoadSplat<uint8_t>(Start);
+      break;
+    case V128_LOAD16_SPLAT:
+      Val = simdLoadSplat<uint16_t>(Start);
+      break;
+    case V128_LOAD32_SPLAT:
+      Val = simdLoadSplat<uint32_t>(Start);
+      break;
+    case V128_LOAD64_SPLAT:
+      Val = simdLoadSplat<uint64_t>(Start);
+      break;
+    case V128_LOAD32_ZERO:
+      Val = simdLoadZero<uint32_t>(Start);
+      break;
+    default:
+      Val = simdLoadZero<uint64_t>(Start);
+    }
+    Frame->valuePush<V128>(ValStackPtr, Val);
+    return;
+  }
+  case V128_LOAD8_LANE:
+  case V128_LOAD16_LANE:
+  case V128_LOAD32_LANE:
+  case V128_LOAD64_LANE:
+  case V128_STORE8_LANE:
+  case V128_STORE16_LANE:
+  case V128_STORE32_LANE:
+  case V128_STORE64_LANE: {
+    uint32_t Align, Offset;
+    Ip = readSafeLEBNumber(Ip, Align);
+    Ip = readSafeLEBNumber(Ip, Offset);
+    uint8_t LaneIdx = *Ip++;
+    uint32_t Size = 1 << ((SubOpcode - V128_LOAD8_LANE) % 4);
+    V128 Val = Frame->valuePop<V128>(ValStackPtr);
+    uint32_t Addr = Frame->valuePop<uint32_t>(ValStackPtr);
+    uint8_t *Start =
+        getSIMDAccessAddr(Memory, Addr, Offset, Size, LinearMemSize);
+    // the lanes are little-endian like the linear memory
+    uint8_t *Lane = reinterpret_cast<uint8_t *>(&Val) + LaneIdx * Size;
+    if (SubOpcode <= V128_LOAD64_LANE) {
+      std::memcpy(Lane, Start, Size);
+      Frame->valuePush<V128>(ValStackPtr, Val);
+    } else {
+      std::memcpy(Start, Lane, Size);
+    }
+    return;
+  }
+  case V128_CONST: {
+    V128 Val;
+    std::memcpy(&Val, Ip, sizeof(V128));
+    Ip += sizeof(V128);
+    Frame->valuePush<V128>(ValStackPtr, Val);
+    return;
+  }
+  case I8X16_SHUFFLE: {
+    SIMDLanes<uint8_t> Y(Frame->valuePop<V128>(ValStackPtr));
+    SIMDLanes<uint8_t> X(Frame->valuePop<V128>(ValStackPtr));
+    SIMDLanes<uint8_t> R;
+    for (uint32_t I = 0; I < R.NumLanes; ++I) {
+      uint8_t LaneIdx = Ip[I];
+      R.L[I] = LaneIdx < 16 ? X.L[LaneIdx] : Y.L[LaneIdx - 16];
+    }
+    Ip += R.NumLanes;
+    Frame->valuePush<V128>(ValStackPtr, R.toV128());
+    return;
+  }
+  case I8X16_EXTRACT_LANE_S:
+  case I8X16_EXTRACT_LANE_U:
+  case I16X8_EXTRACT_LANE_S:
+  case I16X8_EXTRACT_LANE_U:
+  case I32X4_EXTRACT_LANE:
+  case I64X2_EXTRACT_LANE:
+  case F32X4_EXTRACT_LANE:
+  case F64X2_EXTRACT_LANE: {
+    uint8_t LaneIdx = *Ip++;
+    V128 V = Frame->valuePop<V128>(ValStackPtr);
+    switch (SubOpcode) {
+    case I8X16_EXTRACT_LANE_S:
+      Frame->valuePush<int32_t>(ValStackPtr, SIMDLanes<int8_t>(V).L[LaneIdx]);
+      break;
+    case I8X16_EXTRACT_LANE_U:
+      Frame->valuePush<int32_t>(ValStackPtr, SIMDLanes<uint8_t>(V).L[LaneIdx]);
+      break;
+    case I16X8_EXTRACT_LANE_S:
+      Frame->valuePush<int32_t>(ValStackPtr, SIMDLanes<int16_t>(V).L[LaneIdx]);
+      break;
+    case I16X8_EXTRACT_LANE_U:
+      Frame->valuePush<int32_t>(ValStackPtr,
+                                SIMDLanes<uint16_t>(V).L[LaneIdx]);
+      break;
+    case I32X4_EXTRACT_LANE:
+      Frame->valuePush<int32_t>(ValStackPtr, SIMDLanes<int32_t>(V).L[LaneIdx]);
+      break;
+    case F32X4_EXTRACT_LANE:
+      Frame->valuePush<float>(ValStackPtr, SIMDLanes<float>(V).L[LaneIdx]);
+      break;
+    case F64X2_EXTRACT_LANE:
+      Frame->valuePush<double>(ValStackPtr, SIMDLanes<double>(V).L[LaneIdx]);
+      break;
+    default:
+      Frame->valuePush<int64_t>(ValStackPtr, SIMDLanes<int64_t>(V).L[LaneIdx]);
+    }
+    return;
+  }
+  case I8X16_REPLACE_LANE:
+  case I16X8_REPLACE_LANE:
+  case I32X4_REPLACE_LANE:
+  case F32X4_REPLACE_LANE: {
+    uint8_t LaneIdx = *Ip++;
+    uint32_t Scalar = Frame->valuePop<uint32_t>(ValStackPtr);
+    V128 V = Frame->valuePop<V128>(ValStackPtr);
+    if (SubOpcode == I8X16_REPLACE_LANE) {
+      SIMDLanes<uint8_t> R(V);
+      R.L[LaneIdx] = Scalar;
+      V = R.toV128();
+    } else if (SubOpcode == I16X8_REPLACE_LANE) {
+      SIMDLanes<uint16_t> R(V);
+      R.L[LaneIdx] = Scalar;
+      V = R.toV128();
+    } else {
+      SIMDLanes<uint32_t> R(V);
+      R.L[LaneIdx] = Scalar;
+      V = R.toV128();
+    }
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  }
+  case I64X2_REPLACE_LANE:
+  case F64X2_REPLACE_LANE: {
+    uint8_t LaneIdx = *Ip++;
+    uint64_t Scalar = Frame->valuePop<uint64_t>(ValStackPtr);
+    SIMDLanes<uint64_t> R(Frame->valuePop<V128>(ValStackPtr));
+    R.L[LaneIdx] = Scalar;
+    Frame->valuePush<V128>(ValStackPtr, R.toV128());
+    return;
+  }
+  case I8X16_SPLAT:
+  case I16X8_SPLAT:
+  case I32X4_SPLAT:
+  case F32X4_SPLAT: {
+    uint32_t Scalar = Frame->valuePop<uint32_t>(ValStackPtr);
+    V128 V{};
+    if (SubOpcode == I8X16_SPLAT) {
+      V = simdUnaryOp<uint8_t>(V, [Scalar](uint8_t) { return Scalar; });
+    } else if (SubOpcode == I16X8_SPLAT) {
+      V = simdUnaryOp<uint16_t>(V, [Scalar](uint16_t) { return Scalar; });
+    } else {
+      V = simdUnaryOp<uint32_t>(V, [Scalar](uint32_t) { return Scalar; });
+    }
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  }
+  case I64X2_SPLAT:
+  case F64X2_SPLAT: {
+    uint64_t Scalar = Frame->valuePop<uint64_t>(ValStackPtr);
+    SIMDLanes<uint64_t> R;
+    R.L[0] = R.L[1] = Scalar;
+    Frame->valuePush<V128>(ValStackPtr, R.toV128());
+    return;
+  }
+  case I8X16_SHL:
+  case I8X16_SHR_S:
+  case I8X16_SHR_U:
+  case I16X8_SHL:
+  case I16X8_SHR_S:
+  case I16X8_SHR_U:
+  case I32X4_SHL:
+  case I32X4_SHR_S:
+  case I32X4_SHR_U:
+  case I64X2_SHL:
+  case I64X2_SHR_S:
+  case I64X2_SHR_U: {
+    uint32_t Count = Frame->valuePop<uint32_t>(ValStackPtr);
+    V128 V = Frame->valuePop<V128>(ValStackPtr);
+    if (SubOpcode <= I8X16_SHR_U) {
+      V = simdShiftOp<uint8_t>(SubOpcode, V, Count);
+    } else if (SubOpcode <= I16X8_SHR_U) {
+      V = simdShiftOp<uint16_t>(SubOpcode, V, Count);
+    } else if (SubOpcode <= I32X4_SHR_U) {
+      V = simdShiftOp<uint32_t>(SubOpcode, V, Count);
+    } else {
+      V = simdShiftOp<uint64_t>(SubOpcode, V, Count);
+    }
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  }
+  case V128_BITSELECT: {
+    V128 Mask = Frame->valuePop<V128>(ValStackPtr);
+    V128 Y = Frame->valuePop<V128>(ValStackPtr);
+    V128 X = Frame->valuePop<V128>(ValStackPtr);
+    SIMDLanes<uint64_t> M(Mask);
+    SIMDLanes<uint64_t> A(X), B(Y), R;
+    for (uint32_t I = 0; I < R.NumLanes; ++I) {
+      R.L[I] = (A.L[I] & M.L[I]) | (B.L[I] & ~M.L[I]);
+    }
+    Frame->valuePush<V128>(ValStackPtr, R.toV128());
+    return;
+  }
+  default:
+    break;
+  }
+
+  // the rest are lane-wise operations on the top one or two values
+  int32_t Scalar = 0;
+  V128 V;
+  switch (SubOpcode) {
+  case V128_ANY_TRUE: {
+    SIMDLanes<uint64_t> X(Frame->valuePop<V128>(ValStackPtr));
+    Frame->valuePush<int32_t>(ValStackPtr, (X.L[0] | X.L[1]) != 0);
+    return;
+  }
+  case I8X16_ALL_TRUE:
+    Scalar = simdAllTrue<uint8_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I16X8_ALL_TRUE:
+    Scalar = simdAllTrue<uint16_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I32X4_ALL_TRUE:
+    Scalar = simdAllTrue<uint32_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I64X2_ALL_TRUE:
+    Scalar = simdAllTrue<uint64_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I8X16_BITMASK:
+    Scalar = simdBitmask<uint8_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I16X8_BITMASK:
+    Scalar = simdBitmask<uint16_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I32X4_BITMASK:
+    Scalar = simdBitmask<uint32_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case I64X2_BITMASK:
+    Scalar = simdBitmask<uint64_t>(Frame->valuePop<V128>(ValStackPtr));
+    break;
+  case V128_NOT:
+    V = simdUnaryOp<uint64_t>(Frame->valuePop<V128>(ValStackPtr),
+                              [](uint64_t X) { return ~X; });
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I8X16_ABS:
+    V = simdAbs<uint8_t>(Frame->valuePop<V128>(ValStackPtr));
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I16X8_ABS:
+    V = simdAbs<uint16_t>(Frame->valuePop<V128>(ValStackPtr));
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I32X4_ABS:
+    V = simdAbs<uint32_t>(Frame->valuePop<V128>(ValStackPtr));
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I8X16_NEG:
+    V = simdUnaryOp<uint8_t>(Frame->valuePop<V128>(ValStackPtr),
+                             [](uint8_t X) { return uint8_t(0) - X; });
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I16X8_NEG:
+    V = simdUnaryOp<uint16_t>(Frame->valuePop<V128>(ValStackPtr),
+                              [](uint16_t X) { return uint16_t(0) - X; });
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I32X4_NEG:
+    V = simdUnaryOp<uint32_t>(Frame->valuePop<V128>(ValStackPtr),
+                              [](uint32_t X) { return 0u - X; });
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case I64X2_NEG:
+    V = simdUnaryOp<uint64_t>(Frame->valuePop<V128>(ValStackPtr),
+                              [](uint64_t X) { return UINT64_C(0) - X; });
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  case F32X4_DEMOTE_F64X2_ZERO:
+  case F64X2_PROMOTE_LOW_F32X4:
+  case I8X16_POPCNT:
+  case F32X4_CEIL:
+  case F32X4_FLOOR:
+  case F32X4_TRUNC:
+  case F32X4_NEAREST:
+  case F64X2_CEIL:
+  case F64X2_FLOOR:
+  case F64X2_TRUNC:
+  case F64X2_NEAREST:
+  case I16X8_EXTADD_PAIRWISE_I8X16_S:
+  case I16X8_EXTADD_PAIRWISE_I8X16_U:
+  case I32X4_EXTADD_PAIRWISE_I16X8_S:
+  case I32X4_EXTADD_PAIRWISE_I16X8_U:
+  case I16X8_EXTEND_LOW_I8X16_S:
+  case I16X8_EXTEND_HIGH_I8X16_S:
+  case I16X8_EXTEND_LOW_I8X16_U:
+  case I16X8_EXTEND_HIGH_I8X16_U:
+  case I32X4_EXTEND_LOW_I16X8_S:
+  case I32X4_EXTEND_HIGH_I16X8_S:
+  case I32X4_EXTEND_LOW_I16X8_U:
+  case I32X4_EXTEND_HIGH_I16X8_U:
+  case I64X2_ABS:
+  case I64X2_EXTEND_LOW_I32X4_S:
+  case I64X2_EXTEND_HIGH_I32X4_S:
+  case I64X2_EXTEND_LOW_I32X4_U:
+  case I64X2_EXTEND_HIGH_I32X4_U:
+  case F32X4_ABS:
+  case F32X4_NEG:
+  case F32X4_SQRT:
+  case F64X2_ABS:
+  case F64X2_NEG:
+  case F64X2_SQRT:
+  case I32X4_TRUNC_SAT_F32X4_S:
+  case I32X4_TRUNC_SAT_F32X4_U:
+  case F32X4_CONVERT_I32X4_S:
+  case F32X4_CONVERT_I32X4_U:
+  case I32X4_TRUNC_SAT_F64X2_S_ZERO:
+  case I32X4_TRUNC_SAT_F64X2_U_ZERO:
+  case F64X2_CONVERT_LOW_I32X4_S:
+  case F64X2_CONVERT_LOW_I32X4_U:
+    V = simdExtendedUnaryOp(SubOpcode, Frame->valuePop<V128>(ValStackPtr));
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  default: {
+    V128 RHS = Frame->valuePop<V128>(ValStackPtr);
+    V128 LHS = Frame->valuePop<V128>(ValStackPtr);
+    switch (SubOpcode) {
+    case I8X16_SWIZZLE: {
+      SIMDLanes<uint8_t> X(LHS), Idx(RHS), R;
+      for (uint32_t I = 0; I < R.NumLanes; ++I) {
+        R.L[I] = Idx.L[I] < 16 ? X.L[Idx.L[I]] : 0;
+      }
+      V = R.toV128();
+      break;
+    }
+    case V128_AND:
+      V = simdBinaryOp<uint64_t>(LHS, RHS,
+                                 [](uint64_t X, uint64_t Y) { return X & Y; });
+      break;
+    case V128_ANDNOT:
+      V = simdBinaryOp<uint64_t>(
+          LHS, RHS, [](uint64_t X, uint64_t Y) { return X & ~Y; });
+      break;
+    case V128_OR:
+      V = simdBinaryOp<uint64_t>(LHS, RHS,
+                                 [](uint64_t X, uint64_t Y) { return X | Y; });
+      break;
+    case V128_XOR:
+      V = simdBinaryOp<uint64_t>(LHS, RHS,
+                                 [](uint64_t X, uint64_t Y) { return X ^ Y; });
+      break;
+    case I8X16_EQ:
+      V = simdCompareOp<uint8_t>(LHS, RHS, std::equal_to<uint8_t>());
+      break;
+    case I8X16_NE:
+      V = simdCompareOp<uint8_t>(LHS, RHS, std::not_equal_to<uint8_t>());
+      break;
+    case I8X16_LT_S:
+      V = simdCompareOp<int8_t>(LHS, RHS, std::less<int8_t>());
+      break;
+    case I8X16_GT_S:
+      V = simdCompareOp<int8_t>(LHS, RHS, std::greater<int8_t>());
+      break;
+    case I16X8_EQ:
+      V = simdCompareOp<uint16_t>(LHS, RHS, std::equal_to<uint16_t>());
+      break;
+    case I16X8_NE:
+      V = simdCompareOp<uint16_t>(LHS, RHS, std::not_equal_to<uint16_t>());
+      break;
+    case I16X8_LT_S:
+      V = simdCompareOp<int16_t>(LHS, RHS, std::less<int16_t>());
+      break;
+    case I16X8_GT_S:
+      V = simdCompareOp<int16_t>(LHS, RHS, std::greater<int16_t>());
+      break;
+    case I32X4_EQ:
+      V = simdCompareOp<uint32_t>(LHS, RHS, std::equal_to<uint32_t>());
+      break;
+    case I32X4_NE:
+      V = simdCompareOp<uint32_t>(LHS, RHS, std::not_equal_to<uint32_t>());
+      break;
+    case I32X4_LT_S:
+      V = simdCompareOp<int32_t>(LHS, RHS, std::less<int32_t>());
+      break;
+    case I32X4_GT_S:
+      V = simdCompareOp<int32_t>(LHS, RHS, std::greater<int32_t>());
+      break;
+    case I64X2_EQ:
+      V = simdCompareOp<uint64_t>(LHS, RHS, std::equal_to<uint64_t>());
+      break;
+    case I64X2_NE:
+      V = simdCompareOp<uint64_t>(LHS, RHS, std::not_equal_to<uint64_t>());
+      break;
+    case I8X16_ADD:
+      V = simdBinaryOp<uint8_t>(LHS, RHS, std::plus<uint8_t>());
+      break;
+    case I8X16_SUB:
+      V = simdBinaryOp<uint8_t>(LHS, RHS, std::minus<uint8_t>());
+      break;
+    case I16X8_ADD:
+      V = simdBinaryOp<uint16_t>(LHS, RHS, std::plus<uint16_t>());
+      break;
+    case I16X8_SUB:
+      V = simdBinaryOp<uint16_t>(LHS, RHS, std::minus<uint16_t>());
+      break;
+    case I16X8_MUL:
+      // widen first, uint16_t operands promote to int and may overflow
+      V = simdBinaryOp<uint16_t>(LHS, RHS, [](uint32_t X, uint32_t Y) {
+        return static_cast<uint16_t>(X * Y);
+      });
+      break;
+    case I32X4_ADD:
+      V = simdBinaryOp<uint32_t>(LHS, RHS, std::plus<uint32_t>());
+      break;
+    case I32X4_SUB:
+      V = simdBinaryOp<uint32_t>(LHS, RHS, std::minus<uint32_t>());
+      break;
+    case I32X4_MUL:
+      V = simdBinaryOp<uint32_t>(LHS, RHS, std::multiplies<uint32_t>());
+      break;
+    case I64X2_ADD:
+      V = simdBinaryOp<uint64_t>(LHS, RHS, std::plus<uint64_t>());
+      break;
+    case I64X2_SUB:
+      V = simdBinaryOp<uint64_t>(LHS, RHS, std::minus<uint64_t>());
+      break;
+    case I64X2_MUL:
+      V = simdBinaryOp<uint64_t>(LHS, RHS, std::multiplies<uint64_t>());
+      break;
+    case I8X16_MIN_S:
+    case I8X16_MIN_U:
+    case I8X16_MAX_S:
+    case I8X16_MAX_U:
+      V = simdMinMax<uint8_t>(SubOpcode, LHS, RHS);
+      break;
+    case I16X8_MIN_S:
+    case I16X8_MIN_U:
+    case I16X8_MAX_S:
+    case I16X8_MAX_U:
+      V = simdMinMax<uint16_t>(SubOpcode, LHS, RHS);
+      break;
+    case I32X4_MIN_S:
+    case I32X4_MIN_U:
+    case I32X4_MAX_S:
+    case I32X4_MAX_U:
+      V = simdMinMax<uint32_t>(SubOpcode, LHS, RHS);
+      break;
+    case I32X4_DOT_I16X8_S: {
+      SIMDLanes<int16_t> X(LHS), Y(RHS);
+      SIMDLanes<uint32_t> R;
+      for (uint32_t I = 0; I < R.NumLanes; ++I) {
+        int64_t Lo = int64_t(X.L[2 * I]) * Y.L[2 * I];
+        int64_t Hi = int64_t(X.L[2 * I + 1]) * Y.L[2 * I + 1];
+        R.L[I] = static_cast<uint32_t>(Lo + Hi);
+      }
+      V = R.toV128();
+      break;
+    }
+    case I64X2_EXTMUL_LOW_I32X4_S:
+    case I64X2_EXTMUL_HIGH_I32X4_S: {
+      uint32_t Base = SubOpcode == I64X2_EXTMUL_LOW_I32X4_S ? 0 : 2;
+      SIMDLanes<int32_t> X(LHS), Y(RHS);
+      SIMDLanes<int64_t> R;
+      for (uint32_t I = 0; I < R.NumLanes; ++I) {
+        R.L[I] = int64_t(X.L[Base + I]) * Y.L[Base + I];
+      }
+      V = R.toV128();
+      break;
+    }
+    case I64X2_EXTMUL_LOW_I32X4_U:
+    case I64X2_EXTMUL_HIGH_I32X4_U: {
+      uint32_t Base = SubOpcode == I64X2_EXTMUL_LOW_I32X4_U ? 0 : 2;
+      SIMDLanes<uint32_t> X(LHS), Y(RHS);
+      SIMDLanes<uint64_t> R;
+      for (uint32_t I = 0; I < R.NumLanes; ++I) {
+        R.L[I] = uint64_t(X.L[Base + I]) * Y.L[Base + I];
+      }
+      V = R.toV128();
+      break;
+    }
+    default:
+      V = simdExtendedBinaryOp(SubOpcode, LHS, RHS);
+    }
+    Frame->valuePush<V128>(ValStackPtr, V);
+    return;
+  }
+  }
+  Frame->valuePush<int32_t>(ValStackPtr, Scalar);
+}
+
 void BaseInterpreterImpl::interpret() {
 #define DIRECT_DISPATCH 0
 #if !DIRECT_DISPATCH
@@ -1141,6 +2416,18 @@ void BaseInterpreterImpl::interpret() {
     LinearMemSize = Memory->MemSize;
   }
 
+  // only function profiling needs them
+  FunctionCounters *ProfileCounters = ModInst->getFunctionCounters();
+#define COUNT_LOOP_ITERATION()                                                 \
+  if (ZEN_UNLIKELY(ProfileCounters)) {                                         \
+    ++ModInst->getFunctionCounters(FuncInst).LoopIterations;                   \
+  }
+#define COUNT_LOOP_BACK_EDGE()                                                 \
+  if (ZEN_UNLIKELY(ProfileCounters) &&                                         \
+      (ControlStackPtr - 1)->LabelType == LABEL_LOOP) {                        \
+    ++ModInst->getFunctionCounters(FuncInst).LoopIterations;                   \
+  }
+
   WASMType LocalType;
   uint32_t LocalOffset, LocalIdx, FuncIdx, GlobalIdx, Cond, Depth;
   const uint8_t *ElseAddr = nullptr;
@@ -1170,22 +2457,32 @@ void BaseInterpreterImpl::interpret() {
         selectOp<int64_t>(Frame, ValStackPtr);
         BREAK;
       }
+      CASE(SELECT_V128) : {
+        selectOp<V128>(Frame, ValStackPtr);
+        BREAK;
+      }
       CASE(BLOCK) : {
-        uint32_t CellNum = getWASMTypeCellNumFromOpcode(*Ip++);
+        uint32_t NumParamCells, CellNum;
+        Ip = readBlockCells(Ip, NumParamCells, CellNum);
 
         findBlockAddr(Ip, IpEnd, ElseAddr, EndAddr);
-        Frame->blockPush(ControlStackPtr, EndAddr, ValStackPtr, CellNum,
-                         LABEL_BLOCK);
+        Frame->blockPush(ControlStackPtr, EndAddr, ValStackPtr - NumParamCells,
+                         CellNum, LABEL_BLOCK);
         BREAK;
       }
       CASE(LOOP) : {
-        uint32_t CellNum = getWASMTypeCellNumFromOpcode(*Ip++);
-        Frame->blockPush(ControlStackPtr, Ip, ValStackPtr, CellNum, LABEL_LOOP);
+        uint32_t NumParamCells, CellNum;
+        Ip = readBlockCells(Ip, NumParamCells, CellNum);
+        // branches to a loop carry its params
+        Frame->blockPush(ControlStackPtr, Ip, ValStackPtr - NumParamCells,
+                         NumParamCells, LABEL_LOOP);
+        COUNT_LOOP_ITERATION();
         BREAK;
       }
       CASE(BR) : {
         Ip = readSafeLEBNumber(Ip, Depth);
         Frame->blockPop(ControlStackPtr, ValStackPtr, Ip, Depth);
+        COUNT_LOOP_BACK_EDGE();
         BREAK;
       }
       CASE(BR_IF) : {
@@ -1193,6 +2490,7 @@ void BaseInterpreterImpl::interpret() {
         Cond = Frame->valuePop<int32_t>(ValStackPtr);
         if (Cond) {
           Frame->blockPop(ControlStackPtr, ValStackPtr, Ip, Depth);
+          COUNT_LOOP_BACK_EDGE();
         }
         BREAK;
       }
@@ -1206,6 +2504,7 @@ void BaseInterpreterImpl::interpret() {
         }
         Ip = readSafeLEBNumber(Ip, Depth);
         Frame->blockPop(ControlStackPtr, ValStackPtr, Ip, Depth);
+        COUNT_LOOP_BACK_EDGE();
         BREAK;
       }
       CASE(DROP) : {
@@ -1216,20 +2515,25 @@ void BaseInterpreterImpl::interpret() {
         Frame->valuePop<int64_t>(ValStackPtr);
         BREAK;
       }
+      CASE(DROP_V128) : {
+        Frame->valuePop<V128>(ValStackPtr);
+        BREAK;
+      }
       CASE(IF) : {
-        uint32_t CellNum = getWASMTypeCellNumFromOpcode(*Ip++);
+        uint32_t NumParamCells, CellNum;
+        Ip = readBlockCells(Ip, NumParamCells, CellNum);
 
         Cond = Frame->valuePop<int32_t>(ValStackPtr);
         findBlockAddr(Ip, IpEnd, ElseAddr, EndAddr);
         if (Cond) {
-          Frame->blockPush(ControlStackPtr, EndAddr, ValStackPtr, CellNum,
-                           LABEL_IF);
+          Frame->blockPush(ControlStackPtr, EndAddr,
+                           ValStackPtr - NumParamCells, CellNum, LABEL_IF);
         } else {
           if (ElseAddr == nullptr) {
             Ip = EndAddr + 1;
           } else {
-            Frame->blockPush(ControlStackPtr, EndAddr, ValStackPtr, CellNum,
-                             LABEL_IF);
+            Frame->blockPush(ControlStackPtr, EndAddr,
+                             ValStackPtr - NumParamCells, CellNum, LABEL_IF);
             Ip = ElseAddr + 1;
           }
         }
@@ -1269,6 +2573,11 @@ void BaseInterpreterImpl::interpret() {
               ValStackPtr,
               Frame->valueGet<int64_t>(ValStackPtr, LocalPtr + LocalOffset));
           break;
+        case WASMType::V128:
+          Frame->valuePush<V128>(
+              ValStackPtr,
+              Frame->valueGet<V128>(ValStackPtr, LocalPtr + LocalOffset));
+          break;
         default:
           ZEN_ASSERT_TODO();
           break;
@@ -1291,6 +2600,10 @@ void BaseInterpreterImpl::interpret() {
           Frame->valueSet<int64_t>(ValStackPtr, LocalPtr + LocalOffset,
                                    Frame->valuePop<int64_t>(ValStackPtr));
           break;
+        case WASMType::V128:
+          Frame->valueSet<V128>(ValStackPtr, LocalPtr + LocalOffset,
+                                Frame->valuePop<V128>(ValStackPtr));
+          break;
         default:
           ZEN_ASSERT_TODO();
         }
@@ -1312,6 +2625,10 @@ void BaseInterpreterImpl::interpret() {
           Frame->valueSet<int64_t>(ValStackPtr, LocalPtr + LocalOffset,
                                    Frame->valuePeek<int64_t>(ValStackPtr));
           break;
+        case WASMType::V128:
+          Frame->valueSet<V128>(ValStackPtr, LocalPtr + LocalOffset,
+                                Frame->valuePeek<V128>(ValStackPtr));
+          break;
         default:
           ZEN_ASSERT_TODO();
         }
@@ -1395,6 +2712,45 @@ void BaseInterpreterImpl::interpret() {
         Frame->valuePush(ValStackPtr, Memory->CurPages);
         BREAK;
       }
+      CASE(FC_PREFIX) : {
+        uint32_t SubOpcode = 0;
+        Ip = readSafeLEBNumber(Ip, SubOpcode);
+        uint32_t DataIdx = 0;
+        if (SubOpcode == MEMORY_INIT || SubOpcode == DATA_DROP) {
+          readSafeLEBNumber(Ip, DataIdx);
+        }
+        Ip = skipFCImmediates(SubOpcode, Ip, IpEnd);
+        if (SubOpcode == DATA_DROP) {
+          ModInst->dropDataSegment(DataIdx);
+          BREAK;
+        }
+        uint32_t Len = Frame->valuePop<uint32_t>(ValStackPtr);
+        uint32_t Src = Frame->valuePop<uint32_t>(ValStackPtr);
+        uint32_t Dst = Frame->valuePop<uint32_t>(ValStackPtr);
+        ErrorCode Err = ErrorCode::NoError;
+        switch (SubOpcode) {
+        case MEMORY_INIT:
+          Err = ModInst->initMemory(DataIdx, Dst, Src, Len);
+          break;
+        case MEMORY_COPY:
+          Err = ModInst->copyMemory(Dst, Src, Len);
+          break;
+        case MEMORY_FILL:
+          // Src is the fill value
+          Err = ModInst->fillMemory(Dst, Src, Len);
+          break;
+        default:
+          ZEN_UNREACHABLE();
+        }
+        if (Err != ErrorCode::NoError) {
+          throw getError(Err);
+        }
+        BREAK;
+      }
+      CASE(FD_PREFIX) : {
+        simdOp(Memory, Ip, Frame, ValStackPtr, LinearMemSize);
+        BREAK;
+      }
       CASE(F32_STORE) : CASE(I32_STORE) : {
         storeOp<uint32_t, uint32_t>(*Memory, Ip, IpEnd, Frame, ValStackPtr,
                                     LinearMemSize);
@@ -1992,35 +3348,13 @@ void BaseInterpreterImpl::interpret() {
         binaryOp<uint64_t, BO_ROTR>(Frame, ValStackPtr);
         BREAK;
       }
-      CASE(RETURN) : {
-        Context.freeFrame(FuncInst, Frame);
-        InterpFrame *PrevFrame = Frame->PrevFrame;
-        ValStackPtr -= (FuncInst->NumReturnCells);
-        std::memcpy(LocalPtr, ValStackPtr, FuncInst->NumReturnCells << 2);
-        if (PrevFrame == nullptr || !PrevFrame->Ip) {
-          return;
-        }
-        Frame = PrevFrame;
-        Context.setCurFrame(Frame);
-        // update frame
-        updateFrame(Ip, IpEnd, Frame, ValStackPtr, ControlStackPtr, LocalPtr,
-                    FuncInst, true);
-        BREAK;
-      }
       CASE(CALL) : {
         Ip = readSafeLEBNumber(Ip, FuncIdx);
 #ifdef ZEN_ENABLE_DEBUG_INTERP
         ZEN_LOG_DEBUG("fidx: %d", FuncIdx);
 #endif
         if (FuncIdx == Mod->getGasFuncIdx()) {
-          uint64_t Delta = Frame->valuePop<uint64_t>(ValStackPtr);
-          uint64_t GasLeft = ModInst->getGas();
-          if (GasLeft < Delta) {
-            ModInst->setGas(0);
-            throw getError(ErrorCode::GasLimitExceeded);
-          }
-          ModInst->setGas(GasLeft - Delta);
-
+          useGas(FuncInst, Frame->valuePop<uint64_t>(ValStackPtr));
           BREAK;
         }
 #ifdef ZEN_ENABLE_CHECKED_ARITHMETIC
@@ -2038,34 +3372,71 @@ void BaseInterpreterImpl::interpret() {
         BREAK;
       }
       CASE(CALL_INDIRECT) : {
-
-        uint32_t TypeIdx = 0, TableIdx = 0;
+        uint32_t TypeIdx = 0;
         Ip = readSafeLEBNumber(Ip, TypeIdx);
         // Skip the fixed byte for `table 0`
         ++Ip;
-        auto *ExpectedFuncType = Mod->getDeclaredType(TypeIdx);
-
         int32_t IndirectFuncIdx = Frame->valuePop<int32_t>(ValStackPtr);
-        TableInstance *Table = ModInst->getTableInst(TableIdx);
-        if (IndirectFuncIdx < 0 ||
-            (uint32_t)IndirectFuncIdx >= Table->CurSize) {
-          throw getError(ErrorCode::UndefinedElement);
+        auto *FuncInstCallee = getIndirectCallee(TypeIdx, IndirectFuncIdx);
+        callFuncInst(FuncInstCallee, Context, Ip, IpEnd, Frame, ValStackPtr,
+                     ControlStackPtr, LocalPtr, FuncInst);
+        BREAK;
+      }
+      CASE(RETURN_CALL) :
+      CASE(RETURN_CALL_INDIRECT) : {
+        FunctionInstance *FuncInstCallee = nullptr;
+        if (Opcode == RETURN_CALL) {
+          Ip = readSafeLEBNumber(Ip, FuncIdx);
+          if (FuncIdx == Mod->getGasFuncIdx()) {
+            useGas(FuncInst, Frame->valuePop<uint64_t>(ValStackPtr));
+          } else {
+            FuncInstCallee = ModInst->getFunctionInst(FuncIdx);
+#ifdef ZEN_ENABLE_CHECKED_ARITHMETIC
+            Frame->ValueStackPtr = ValStackPtr;
+#define HANDLE_CHECKED_ARITHMETIC_CALL_POSTHOOK                                \
+  ValStackPtr = Frame->ValueStackPtr;                                          \
+  FuncInstCallee = nullptr;
+
+            // the hook breaks out of this loop, then the result is returned
+            do {
+              HANDLE_CHECKED_ARITHMETIC_CALL(Mod, FuncIdx)
+            } while (false);
+#undef HANDLE_CHECKED_ARITHMETIC_CALL_POSTHOOK
+#endif // ZEN_ENABLE_CHECKED_ARITHMETIC
+          }
+        } else {
+          uint32_t TypeIdx = 0;
+          Ip = readSafeLEBNumber(Ip, TypeIdx);
+          // Skip the fixed byte for `table 0`
+          ++Ip;
+          int32_t IndirectFuncIdx = Frame->valuePop<int32_t>(ValStackPtr);
+          FuncInstCallee = getIndirectCallee(TypeIdx, IndirectFuncIdx);
         }
-        FuncIdx = Table->Elements[IndirectFuncIdx];
-#ifdef ZEN_ENABLE_DEBUG_INTERP
-        ZEN_LOG_DEBUG("fidx: %d", FuncIdx);
-#endif
-        if (FuncIdx == (uint32_t)-1) {
-          throw getError(ErrorCode::UninitializedElement);
+        if (FuncInstCallee && FuncInstCallee->Kind == FunctionKind::ByteCode) {
+          tailCallFuncInst(FuncInstCallee, Context, Ip, IpEnd, Frame,
+                           ValStackPtr, ControlStackPtr, LocalPtr, FuncInst);
+          BREAK;
         }
-        auto *FuncInstCallee = ModInst->getFunctionInst(FuncIdx);
-        ZEN_ASSERT(FuncInstCallee);
-        auto *ActualFuncType = FuncInstCallee->FuncType;
-        if (!TypeEntry::isEqual(ActualFuncType, ExpectedFuncType)) {
-          throw getError(ErrorCode::IndirectCallTypeMismatch);
+        // host functions are called in place, then the results are returned
+        if (FuncInstCallee) {
+          callFuncInst(FuncInstCallee, Context, Ip, IpEnd, Frame, ValStackPtr,
+                       ControlStackPtr, LocalPtr, FuncInst);
         }
-        callFuncInst(FuncInstCallee, Context, Ip, IpEnd, Frame, ValStackPtr,
-                     ControlStackPtr, LocalPtr, FuncInst);
+        [[fallthrough]];
+      }
+      CASE(RETURN) : {
+        Context.freeFrame(FuncInst, Frame);
+        InterpFrame *PrevFrame = Frame->PrevFrame;
+        ValStackPtr -= (FuncInst->NumReturnCells);
+        std::memmove(LocalPtr, ValStackPtr, FuncInst->NumReturnCells << 2);
+        if (PrevFrame == nullptr || !PrevFrame->Ip) {
+          return;
+        }
+        Frame = PrevFrame;
+        Context.setCurFrame(Frame);
+        // update frame
+        updateFrame(Ip, IpEnd, Frame, ValStackPtr, ControlStackPtr, LocalPtr,
+                    FuncInst, true);
         BREAK;
       }
       CASE(END) : {
@@ -2078,7 +3449,7 @@ void BaseInterpreterImpl::interpret() {
           ValStackPtr -= (FuncInst->NumReturnCells);
           // copy return value to value stack of prev_frame, frame may
           // be overwrited
-          std::memcpy(LocalPtr, ValStackPtr, FuncInst->NumReturnCells << 2);
+          std::memmove(LocalPtr, ValStackPtr, FuncInst->NumReturnCells << 2);
           Frame = PrevFrame;
           Context.setCurFrame(Frame);
 
@@ -2099,6 +3470,8 @@ void BaseInterpreterImpl::interpret() {
     }
     // TODO: write back ValueStackPtr, Ip, CtrlStackPtr to Frame
   }
+#undef COUNT_LOOP_ITERATION
+#undef COUNT_LOOP_BACK_EDGE
 }
 
 void BaseInterpreter::interpret() {
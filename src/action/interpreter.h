@@ -113,12 +113,10 @@ struct InterpFrame {
     ValStackPtr = CurBlock->ValueStackPtr;
     Ip = CurBlock->TargetAddr;
 
-    if (CurBlock->LabelType != common::LABEL_LOOP) {
-      uint32_t CellNum = (ControlStackPtr - 1)->CellNum;
-
-      std::memcpy(ValStackPtr, ValStackPtrOld - CellNum, CellNum << 2);
-      ValStackPtr += CellNum;
-    }
+    // carries the results of a block, or the params of a loop
+    uint32_t CellNum = CurBlock->CellNum;
+    std::memmove(ValStackPtr, ValStackPtrOld - CellNum, CellNum << 2);
+    ValStackPtr += CellNum;
   }
 };
 
@@ -177,6 +175,11 @@ public:
   InterpFrame *allocFrame(runtime::FunctionInstance *FuncInst,
                           uint32_t *LocalPtr);
   void freeFrame(runtime::FunctionInstance *FuncInst, InterpFrame *Frame);
+  // reuse the stack space of Frame for a tail call to Callee
+  InterpFrame *replaceFrame(runtime::FunctionInstance *FuncInst,
+                            InterpFrame *Frame,
+                            runtime::FunctionInstance *Callee,
+                            const uint32_t *Args);
 
   InterpFrame *getCurFrame() { return CurFrame; }
   void setCurFrame(InterpFrame *Frame) { CurFrame = Frame; }
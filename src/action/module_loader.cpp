@@ -3,6 +3,7 @@
 
 #include "action/module_loader.h"
 #include "action/function_loader.h"
+#include "runtime/instance.h"
 #include "runtime/symbol_wrapper.h"
 #include "utils/unicode.h"
 #include "utils/wasm.h"
@@ -51,6 +52,8 @@ void ModuleLoader::load() {
 
   loadModuleHeader();
 
+  Mod.reserveMetadata(estimateMetadataSize());
+
   loadModuleBody();
 
 #ifdef ZEN_ENABLE_SPEC_TEST
@@ -176,12 +179,50 @@ ModuleLoader::readConstExpr(WASMType Type) {
   return {Opcode, ConstExpr};
 }
 
+// \return the intrinsic listed for \p ModuleName.\p FieldName in
+// common/hostapi_intrinsics.def, None if there is none or \p Type differs
+static HostapiIntrinsic resolveHostapiIntrinsic(WASMSymbol ModuleName,
+                                                WASMSymbol FieldName,
+                                                const TypeEntry &Type) {
+  if (ModuleName != WASM_SYMBOL_env || Type.NumReturns != 1 ||
+      Type.getReturnTypes()[0] != WASMType::I32) {
+    return HostapiIntrinsic::None;
+  }
+  const WASMType *ParamTypes = Type.getParamTypes();
+  for (uint32_t I = 0; I < Type.NumParams; ++I) {
+    if (ParamTypes[I] != WASMType::I32) {
+      return HostapiIntrinsic::None;
+    }
+  }
+  switch (FieldName) {
+#define DEFINE_HOSTAPI_INTRINSIC(Field, NumArgs, Gas)                          \
+  case WASM_SYMBOL_##Field:                                                    \
+    return Type.NumParams == NumArgs ? HostapiIntrinsic::Field                 \
+                                     : HostapiIntrinsic::None;
+#include "common/hostapi_intrinsics.def"
+#undef DEFINE_HOSTAPI_INTRINSIC
+  default:
+    return HostapiIntrinsic::None;
+  }
+}
+
 const void *
 ModuleLoader::resolveImportFunction(WASMSymbol ModuleName, WASMSymbol FieldName,
-                                    const TypeEntry &ExpectedFuncType) {
+                                    const TypeEntry &ExpectedFuncType,
+                                    HostapiIntrinsic &Intrinsic) {
   Runtime *RT = Mod.getRuntime();
   ZEN_ASSERT(RT);
 
+  Intrinsic = HostapiIntrinsic::None;
+  if (RT->getConfig().EnableHostapiIntrinsics) {
+    Intrinsic = resolveHostapiIntrinsic(ModuleName, FieldName,
+                                        ExpectedFuncType);
+    // the runtime implementation replaces whatever the host module provides
+    if (Intrinsic != HostapiIntrinsic::None) {
+      return Instance::getHostapiIntrinsicFunc(Intrinsic);
+    }
+  }
+
   auto ThrowError = [=](ErrorCode ErrCode, const std::string &DetailMsg) {
     const char *ModuleNameStr = RT->dumpSymbolString(ModuleName);
     const char *FieldNameStr = RT->dumpSymbolString(FieldName);
@@ -241,6 +282,11 @@ ModuleLoader::resolveImportFunction(WASMSymbol ModuleName, WASMSymbol FieldName,
     DetailErrMsg += ')';
     ThrowError(ErrorCode::IncompatibleImportType, DetailErrMsg);
   }
+  // native calls have a single return register
+  if (ExpectedNumReturns > 1) {
+    ThrowError(ErrorCode::IncompatibleImportType,
+               "host functions return at most one value");
+  }
   if (ExpectedNumParams != ActualNumParams) {
     std::string DetailErrMsg = "param count mismatch (expected ";
     DetailErrMsg += std::to_string(ExpectedNumParams);
@@ -251,7 +297,7 @@ ModuleLoader::resolveImportFunction(WASMSymbol ModuleName, WASMSymbol FieldName,
   }
 
   for (uint32_t I = 0; I < ExpectedNumReturns; ++I) {
-    WASMType ExpectedType = ExpectedFuncType.ReturnTypes[I];
+    WASMType ExpectedType = ExpectedFuncType.getReturnTypes()[I];
     WASMType ActualType = ActualFuncType[I + ActualNumParams];
     if (ExpectedType != ActualType) {
       std::string DetailErrMsg = "return type mismatch (expected ";
@@ -294,6 +340,68 @@ void ModuleLoader::loadModuleHeader() {
   }
 }
 
+size_t ModuleLoader::estimateMetadataSize() {
+  // Only the section headers and item counts are read, malformed modules are
+  // rejected later by loadModuleBody
+  const Byte *SavedPtr = Ptr;
+  size_t Size = 0;
+  try {
+    while (Ptr < End) {
+      const auto [SecType, SecSize] = loadSectionHeader();
+      if (SecSize > size_t(End - Ptr)) {
+        break;
+      }
+      const Byte *SecEnd = Ptr + SecSize;
+      size_t EntrySize = 0;
+      switch (SecType) {
+      case SectionType::SEC_TYPE:
+        EntrySize = sizeof(TypeEntry);
+        break;
+      case SectionType::SEC_IMPORT:
+        EntrySize = sizeof(ImportFunctionEntry);
+        break;
+      case SectionType::SEC_FUNC:
+        EntrySize = sizeof(FuncEntry);
+        break;
+      case SectionType::SEC_TABLE:
+        EntrySize = sizeof(TableEntry);
+        break;
+      case SectionType::SEC_MEMORY:
+        EntrySize = sizeof(MemoryEntry);
+        break;
+      case SectionType::SEC_GLOBAL:
+        EntrySize = sizeof(GlobalEntry);
+        break;
+      case SectionType::SEC_EXPORT:
+        EntrySize = sizeof(ExportEntry);
+        break;
+      case SectionType::SEC_ELEM:
+        EntrySize = sizeof(ElemEntry);
+        break;
+      case SectionType::SEC_CODE:
+        // local types and offsets are usually much smaller than the entry
+        EntrySize = sizeof(CodeEntry) + 32;
+        break;
+      case SectionType::SEC_DATA:
+        EntrySize = sizeof(DataEntry);
+        break;
+      default:
+        break;
+      }
+      if (EntrySize > 0 && SecSize > 0) {
+        // each item takes at least one byte, so the count is bounded by the
+        // section size even if it is forged
+        size_t NumItems = std::min<size_t>(readU32(), SecSize);
+        Size += ZEN_ALIGN(NumItems * EntrySize, AllocOnlyMemPool::DefaultAlign);
+      }
+      Ptr = SecEnd;
+    }
+  } catch (const Error &) {
+  }
+  Ptr = SavedPtr;
+  return Size;
+}
+
 void ModuleLoader::loadModuleBody() {
   SectionOrder LastSecOrder = SectionOrder::SEC_ORDER_CUSTOM;
   while (Ptr < End) {
@@ -434,10 +542,16 @@ void ModuleLoader::loadTypeSection() {
     }
 
     uint32_t NumReturns = readU32();
-    WASMType *ReturnTypes = Entry->ReturnTypes;
     if (NumReturns > PresetMaxNumReturns) {
       throw getError(ErrorCode::TooManyReturns);
     }
+
+    WASMType *ReturnTypes = nullptr;
+    if (NumReturns > (__WORDSIZE / 8)) {
+      ReturnTypes = Entry->ReturnTypes = Mod.initReturnTypes(NumReturns);
+    } else {
+      ReturnTypes = Entry->ReturnTypesVec;
+    }
     uint32_t NumReturnCells = 0;
     for (uint32_t J = 0; J < NumReturns; ++J) {
       WASMType Type = readValType();
@@ -453,8 +567,8 @@ void ModuleLoader::loadTypeSection() {
 
     Entry->NumParams = static_cast<uint16_t>(NumParams);
     Entry->NumParamCells = static_cast<uint16_t>(NumParamCells);
-    Entry->NumReturns = static_cast<uint8_t>(NumReturns);
-    Entry->NumReturnCells = static_cast<uint8_t>(NumReturnCells);
+    Entry->NumReturns = static_cast<uint16_t>(NumReturns);
+    Entry->NumReturnCells = static_cast<uint16_t>(NumReturnCells);
     Entry->SmallestTypeIdx = I;
 
     for (uint32_t J = 0; J < I; ++J) {
@@ -506,17 +620,20 @@ void ModuleLoader::loadImportSection() {
         }
 
         const void *FuncPtr = nullptr;
+        HostapiIntrinsic Intrinsic = HostapiIntrinsic::None;
 #ifdef ZEN_ENABLE_CHECKED_ARITHMETIC
         if (!resolveCheckedArithmeticFunction(
                 &Mod, ModuleName, FieldName,
                 static_cast<uint32_t>(ImportFunctionTable.size()))) {
 #endif // ZEN_ENABLE_CHECKED_ARITHMETIC
-          FuncPtr = resolveImportFunction(ModuleName, FieldName, *Type);
+          FuncPtr =
+              resolveImportFunction(ModuleName, FieldName, *Type, Intrinsic);
 #ifdef ZEN_ENABLE_CHECKED_ARITHMETIC
         }
 #endif // ZEN_ENABLE_CHECKED_ARITHMETIC
         ImportFunctionTable.emplace_back(ModuleName, FieldName,
-                                         Type->SmallestTypeIdx, FuncPtr);
+                                         Type->SmallestTypeIdx, FuncPtr,
+                                         Intrinsic);
         break;
       }
 #ifdef ZEN_ENABLE_SPEC_TEST
@@ -991,12 +1108,24 @@ void ModuleLoader::loadDataSection() {
   uint32_t TotalDataSize = 0;
   DataEntry *Entry = Mod.initDataTable(NumDataSegments);
   for (uint32_t I = 0; I < NumDataSegments; ++I) {
-    uint32_t MemIdx = readU32();
-    if (!Mod.isValidMem(MemIdx)) {
-      throw getError(ErrorCode::UnknownMemory);
+    // 0: active in memory 0, 1: passive, 2: active with explicit memory index
+    uint32_t Kind = readU32();
+    if (Kind > 2) {
+      throw getError(ErrorCode::InvalidDataSegmentKind);
     }
 
-    const auto [ExprKind, Expr] = readConstExpr(WASMType::I32);
+    uint32_t MemIdx = 0;
+    uint8_t ExprKind = 0;
+    InitExpr Expr{};
+    if (Kind != 1) {
+      if (Kind == 2) {
+        MemIdx = readU32();
+      }
+      if (!Mod.isValidMem(MemIdx)) {
+        throw getError(ErrorCode::UnknownMemory);
+      }
+      std::tie(ExprKind, Expr) = readConstExpr(WASMType::I32);
+    }
 
     uint32_t DataSegmentSize = readU32();
     if (DataSegmentSize > PresetMaxDataSegmentSize ||
@@ -1013,6 +1142,7 @@ void ModuleLoader::loadDataSection() {
     Entry->Size = DataSegmentSize;
     Entry->Offset = DataPtrOffset;
     Entry->InitExprKind = ExprKind;
+    Entry->Passive = Kind == 1;
     Entry->InitExprVal = Expr;
 
     ++Entry;
@@ -53,8 +53,10 @@ private:
 
   std::pair<uint8_t, runtime::InitExpr> readConstExpr(WASMType Type);
 
+  // \p Intrinsic is set when the import is bound to a hostapi intrinsic
   const void *resolveImportFunction(WASMSymbol ModuleName, WASMSymbol FieldName,
-                                    const runtime::TypeEntry &ExpectedFuncType);
+                                    const runtime::TypeEntry &ExpectedFuncType,
+                                    runtime::HostapiIntrinsic &Intrinsic);
 
   std::pair<SectionType, uint32_t> loadSectionHeader() {
     SectionType SecType = static_cast<SectionType>(readByte());
@@ -63,6 +65,7 @@ private:
   }
 
   void loadModuleHeader();
+  size_t estimateMetadataSize();
   void loadModuleBody();
   void loadCustomSection();
   void loadTypeSection();
@@ -0,0 +1,936 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "benchmarks/ra_stress.h"
+#include "utils/logging.h"
+#include "utils/statistics.h"
+#include "zetaengine.h"
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+#ifdef ZEN_ENABLE_BUILTIN_WASI
+#include "host/wasi/wasi.h"
+#endif
+
+#ifdef ZEN_ENABLE_BUILTIN_ENV
+#include "host/env/env.h"
+#endif
+
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+#include "host/crypto/crypto.h"
+#endif
+
+using namespace zen::common;
+using namespace zen::runtime;
+using namespace zen::utils;
+
+namespace {
+
+/// A module of the corpus. Its export `run(i32) -> i64` takes the problem
+/// size and returns a checksum of the work, compared with Expected.
+struct Workload {
+  const char *Name;
+  uint32_t Input;
+  int64_t Expected;
+  // the module, or empty to load `<corpus dir>/<Name>.wasm`
+  std::vector<uint8_t> Bytecode;
+};
+
+const Workload Workloads[] = {
+    {"fib", 30, 832040},
+    {"tak", 30, 260},
+    {"sha256", 1024, -1205215847411253106},
+    {"keccak", 1000, 1508408938264955452},
+    {"erc20", 200000, 518796997784},
+    {"bigint", 20000, -4793822547473409883},
+    // the same multiply-add by the u256 hostapi intrinsics
+    {"bigint_u256", 20000, -4793822547473409883},
+    {"sort", 100000, 7170301431202930520},
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+    // the hashes of the builtin crypto module, against the wasm ones above
+    {"sha256_native", 1024, -1205215847411253106},
+    {"keccak_native", 1000, -383664505426010098},
+#endif
+};
+
+enum class RegAllocPolicy {
+  Default,    // greedy within the complexity budget
+  FastOnly,   // --disable-multipass-greedyra
+  GreedyOnly, // no complexity budget
+  Adaptive,   // --enable-multipass-adaptive-ra
+};
+
+struct EngineMode {
+  const char *Name;
+  RunMode Mode;
+  bool Lazy;
+  RegAllocPolicy RA = RegAllocPolicy::Default;
+};
+
+const EngineMode EngineModes[] = {
+    {"interpreter", RunMode::InterpMode, false},
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+    {"singlepass", RunMode::SinglepassMode, false},
+#endif
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+    {"multipass", RunMode::MultipassMode, false},
+    {"multipass_lazy", RunMode::MultipassMode, true},
+#endif
+};
+
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+// modes of the register allocation stress modules, which have a single
+// function each, so that their pass times are sequential
+const EngineMode RAStressModes[] = {
+    {"multipass", RunMode::MultipassMode, false},
+    {"multipass_fastra", RunMode::MultipassMode, false,
+     RegAllocPolicy::FastOnly},
+    {"multipass_greedy", RunMode::MultipassMode, false,
+     RegAllocPolicy::GreedyOnly},
+    {"multipass_adaptive", RunMode::MultipassMode, false,
+     RegAllocPolicy::Adaptive},
+};
+#endif // ZEN_ENABLE_MULTIPASS_JIT
+
+enum BenchmarkPhase : uint32_t {
+  LoadPhase,
+  CompilePhase,
+  InstantiatePhase,
+  ExecutePhase,
+  NumBenchmarkPhases
+};
+
+constexpr const char *PhaseNames[] = {
+    "load",
+    "compile",
+    "instantiate",
+    "execute",
+};
+
+struct PhaseTimes {
+  static constexpr uint32_t NumPasses = FunctionCompileRecord::NumPasses;
+
+  float TimeCosts[NumBenchmarkPhases] = {0}; // in milliseconds
+  // multipass compilation of all functions, see FunctionCompileRecord
+  bool HasPassRecords = false;
+  float PassTimeCosts[NumPasses] = {0};
+  size_t PassMemoryUsages[NumPasses] = {0};
+
+  float getTotal() const {
+    float Total = 0;
+    for (float TimeCost : TimeCosts) {
+      Total += TimeCost;
+    }
+    return Total;
+  }
+};
+
+struct BenchmarkResult {
+  const Workload *Work;
+  const EngineMode *Engine;
+  std::vector<PhaseTimes> Samples; // one per repetition
+  std::string Error;               // empty if every repetition passed
+};
+
+/// Create a runtime for \p Engine with the builtin host modules loaded
+std::unique_ptr<Runtime> createBenchmarkRuntime(const EngineMode &Engine,
+                                                bool EnableStatistics,
+                                                std::string &Error) {
+  RuntimeConfig Config;
+  Config.Mode = Engine.Mode;
+  Config.EnableStatistics = EnableStatistics;
+  // only bigint_u256 imports env, for its u256 intrinsics
+  Config.EnableHostapiIntrinsics = true;
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  Config.EnableMultipassLazy = Engine.Lazy;
+  if (Engine.RA != RegAllocPolicy::Default) {
+    Config.DisableMultipassGreedyRA = Engine.RA == RegAllocPolicy::FastOnly;
+    Config.EnableMultipassAdaptiveRA = Engine.RA == RegAllocPolicy::Adaptive;
+    if (Engine.RA == RegAllocPolicy::GreedyOnly) {
+      Config.MultipassGreedyRABudget = 0;
+    }
+  }
+#endif
+  std::unique_ptr<Runtime> RT = Runtime::newRuntime(Config);
+  if (!RT) {
+    Error = "failed to create runtime";
+    return nullptr;
+  }
+
+#ifdef ZEN_ENABLE_BUILTIN_WASI
+  if (!LOAD_HOST_MODULE(RT, zen::host, wasi_snapshot_preview1)) {
+    Error = "failed to load WASI module";
+    return nullptr;
+  }
+#endif
+
+#ifdef ZEN_ENABLE_BUILTIN_ENV
+  if (!LOAD_HOST_MODULE(RT, zen::host, env)) {
+    Error = "failed to load env module";
+    return nullptr;
+  }
+#endif
+
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+  if (!LOAD_HOST_MODULE(RT, zen::host, crypto)) {
+    Error = "failed to load crypto module";
+    return nullptr;
+  }
+#endif
+  return RT;
+}
+
+/// Run \p Work once in a fresh runtime, the phases are split by the runtime
+/// statistics so that they match the report of `dtvm --enable-statistics`
+bool runOnce(const Workload &Work, const EngineMode &Engine,
+             const std::string &Path, PhaseTimes &Times, int64_t &Result,
+             std::string &Error) {
+  std::unique_ptr<Runtime> RT = createBenchmarkRuntime(Engine, true, Error);
+  if (!RT) {
+    return false;
+  }
+
+  MayBe<Module *> ModRet =
+      Work.Bytecode.empty()
+          ? RT->loadModule(Path, "run")
+          : RT->loadModule(Work.Name, Work.Bytecode.data(),
+                           Work.Bytecode.size(), "run");
+  if (!ModRet) {
+    Error = "failed to load module: " +
+            ModRet.getError().getFormattedMessage(false);
+    return false;
+  }
+
+  IsolationUniquePtr Iso = RT->createUnmanagedIsolation();
+  if (!Iso) {
+    Error = "failed to create isolation";
+    return false;
+  }
+  MayBe<Instance *> InstRet = Iso->createInstance(**ModRet, UINT64_MAX);
+  if (!InstRet) {
+    Error = "failed to create instance: " +
+            InstRet.getError().getFormattedMessage(false);
+    return false;
+  }
+  Instance *Inst = *InstRet;
+
+  std::vector<TypedValue> Results;
+  if (!RT->callWasmFunction(*Inst, "run", {std::to_string(Work.Input)},
+                            Results)) {
+    Error = "failed to call run: " +
+            Inst->getError().getFormattedMessage(false);
+    return false;
+  }
+  if (Results.size() != 1 || Results[0].Type != WASMType::I64) {
+    Error = "unexpected result type";
+    return false;
+  }
+  Result = Results[0].Value.I64;
+
+  const Statistics &Stats = RT->getStatistics();
+  // lazy compilation on the first call of a function is part of execution
+  float LazyCompileTime =
+      Stats.getTotalTimeCost(StatisticPhase::JITLazyFgCompilation);
+  Times.TimeCosts[LoadPhase] = Stats.getTotalTimeCost(StatisticPhase::Load);
+  Times.TimeCosts[CompilePhase] =
+      Stats.getTotalTimeCost(StatisticPhase::JITCompilation) +
+      Stats.getTotalTimeCost(StatisticPhase::JITLazyPrecompilation) +
+      LazyCompileTime;
+  Times.TimeCosts[InstantiatePhase] =
+      Stats.getTotalTimeCost(StatisticPhase::Instantiation);
+  Times.TimeCosts[ExecutePhase] =
+      Stats.getTotalTimeCost(StatisticPhase::Execution) - LazyCompileTime;
+
+  for (const FunctionCompileRecord &Record :
+       Stats.getSlowestFunctionCompilations(UINT32_MAX)) {
+    Times.HasPassRecords = true;
+    for (uint32_t I = 0; I < PhaseTimes::NumPasses; ++I) {
+      Times.PassTimeCosts[I] += Record.TimeCosts[I];
+      Times.PassMemoryUsages[I] =
+          std::max(Times.PassMemoryUsages[I], Record.MemoryUsages[I]);
+    }
+  }
+  return true;
+}
+
+/// Run \p Work in \p Engine for \p NumRepetitions times
+BenchmarkResult runBenchmark(const Workload &Work, const EngineMode &Engine,
+                             const std::string &Path,
+                             uint32_t NumRepetitions) {
+  BenchmarkResult Result{&Work, &Engine, {}, {}};
+  for (uint32_t I = 0; I < NumRepetitions; ++I) {
+    PhaseTimes Times;
+    int64_t Value = 0;
+    if (!runOnce(Work, Engine, Path, Times, Value, Result.Error)) {
+      break;
+    }
+    if (Value != Work.Expected) {
+      Result.Error = "unexpected result";
+      break;
+    }
+    Result.Samples.push_back(Times);
+  }
+  return Result;
+}
+
+/// \return the median and the minimum of \p Values
+std::pair<float, float> summarize(std::vector<float> Values) {
+  ZEN_ASSERT(!Values.empty());
+  std::sort(Values.begin(), Values.end());
+  size_t Mid = Values.size() / 2;
+  float Median = Values.size() % 2 == 1
+                     ? Values[Mid]
+                     : (Values[Mid - 1] + Values[Mid]) / 2;
+  return {Median, Values.front()};
+}
+
+std::vector<float> getPhaseSamples(const BenchmarkResult &Result,
+                                   uint32_t Phase) {
+  std::vector<float> Values;
+  for (const PhaseTimes &Times : Result.Samples) {
+    Values.push_back(Phase == NumBenchmarkPhases ? Times.getTotal()
+                                                 : Times.TimeCosts[Phase]);
+  }
+  return Values;
+}
+
+/// \return the median time and the largest memory usage of compile pass \p I
+std::pair<float, size_t> summarizePass(const BenchmarkResult &Result,
+                                       uint32_t I) {
+  std::vector<float> Values;
+  size_t MemoryUsage = 0;
+  for (const PhaseTimes &Times : Result.Samples) {
+    Values.push_back(Times.PassTimeCosts[I]);
+    MemoryUsage = std::max(MemoryUsage, Times.PassMemoryUsages[I]);
+  }
+  return {summarize(Values).first, MemoryUsage};
+}
+
+bool hasPassRecords(const BenchmarkResult &Result) {
+  return !Result.Samples.empty() && Result.Samples[0].HasPassRecords;
+}
+
+std::string escapeJSON(const std::string &Str) {
+  std::string Out;
+  for (char C : Str) {
+    if (C == '"' || C == '\\') {
+      Out += '\\';
+      Out += C;
+    } else if (static_cast<unsigned char>(C) < 0x20) {
+      char Buf[8];
+      std::snprintf(Buf, sizeof(Buf), "\\u%04x", C);
+      Out += Buf;
+    } else {
+      Out += C;
+    }
+  }
+  return Out;
+}
+
+std::string dumpJSON(const std::vector<BenchmarkResult> &Results,
+                     uint32_t NumRepetitions) {
+  std::string Out = "{\n  \"engine\": \"dtvm\",\n  \"repetitions\": " +
+                    std::to_string(NumRepetitions) + ",\n  \"results\": [";
+  char Buf[128];
+  for (size_t I = 0; I < Results.size(); ++I) {
+    const BenchmarkResult &Result = Results[I];
+    Out += I == 0 ? "\n" : ",\n";
+    std::snprintf(Buf, sizeof(Buf),
+                  "    {\"benchmark\": \"%s\", \"mode\": \"%s\", "
+                  "\"input\": %u, ",
+                  Result.Work->Name, Result.Engine->Name, Result.Work->Input);
+    Out += Buf;
+    if (!Result.Error.empty()) {
+      Out += "\"status\": \"error\", \"error\": \"" +
+             escapeJSON(Result.Error) + "\"}";
+      continue;
+    }
+    Out += "\"status\": \"ok\"";
+    for (uint32_t Phase = 0; Phase <= NumBenchmarkPhases; ++Phase) {
+      const char *Name =
+          Phase == NumBenchmarkPhases ? "total" : PhaseNames[Phase];
+      auto [Median, Min] = summarize(getPhaseSamples(Result, Phase));
+      std::snprintf(Buf, sizeof(Buf),
+                    ",\n     \"%s_ms\": {\"median\": %.4f, \"min\": %.4f}",
+                    Name, Median, Min);
+      Out += Buf;
+    }
+    if (hasPassRecords(Result)) {
+      Out += ",\n     \"passes\": {";
+      for (uint32_t I = 0; I < PhaseTimes::NumPasses; ++I) {
+        auto [Median, MemoryUsage] = summarizePass(Result, I);
+        std::snprintf(Buf, sizeof(Buf),
+                      "%s\"%s\": {\"median_ms\": %.4f, \"memory_bytes\": %zu}",
+                      I == 0 ? "" : ", ",
+                      getCompilePassName(static_cast<CompilePass>(I)), Median,
+                      MemoryUsage);
+        Out += Buf;
+      }
+      Out += "}";
+    }
+    Out += "}";
+  }
+  Out += "\n  ]\n}\n";
+  return Out;
+}
+
+void printTable(const std::vector<BenchmarkResult> &Results) {
+  printf("%-16s %-16s %12s %12s %12s %12s\n", "benchmark", "mode", "load_ms",
+         "compile_ms", "inst_ms", "execute_ms");
+  for (const BenchmarkResult &Result : Results) {
+    printf("%-16s %-16s", Result.Work->Name, Result.Engine->Name);
+    if (!Result.Error.empty()) {
+      printf(" %s\n", Result.Error.c_str());
+      continue;
+    }
+    for (uint32_t Phase = 0; Phase < NumBenchmarkPhases; ++Phase) {
+      printf(" %12.3f", summarize(getPhaseSamples(Result, Phase)).first);
+    }
+    printf("\n");
+  }
+}
+
+/// Print the median time and the memory usage of the passes of multipass
+/// compilation
+void printPassTable(const std::vector<BenchmarkResult> &Results) {
+  printf("\n%-16s %-16s %-20s %12s %12s\n", "benchmark", "mode", "pass",
+         "time_ms", "memory_kb");
+  for (const BenchmarkResult &Result : Results) {
+    if (!hasPassRecords(Result)) {
+      continue;
+    }
+    for (uint32_t I = 0; I < PhaseTimes::NumPasses; ++I) {
+      auto [Median, MemoryUsage] = summarizePass(Result, I);
+      printf("%-16s %-16s %-20s %12.3f %12zu\n", Result.Work->Name,
+             Result.Engine->Name,
+             getCompilePassName(static_cast<CompilePass>(I)), Median,
+             MemoryUsage / 1024);
+    }
+  }
+}
+
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+/// Build the register allocation stress modules scaled by \p Scale, their
+/// expected results come from the interpreter
+bool buildRAStressWorkloads(double Scale, std::vector<Workload> &Works,
+                            std::string &Error) {
+  using namespace zen::benchmarks;
+  const EngineMode Interpreter = {"interpreter", RunMode::InterpMode, false};
+  for (uint32_t I = 0;
+       I < to_underlying(StressShape::NumStressShapes); ++I) {
+    StressShape Shape = static_cast<StressShape>(I);
+    uint32_t Size = std::max<uint32_t>(
+        1, static_cast<uint32_t>(getDefaultStressSize(Shape) * Scale));
+    Workload Work{getStressShapeName(Shape), getStressInput(Shape, Size), 0,
+                  buildStressModule(Shape, Size)};
+    PhaseTimes Times;
+    if (!runOnce(Work, Interpreter, "", Times, Work.Expected, Error)) {
+      Error = std::string(Work.Name) + ": " + Error;
+      return false;
+    }
+    Works.push_back(std::move(Work));
+  }
+  return true;
+}
+#endif // ZEN_ENABLE_MULTIPASS_JIT
+
+// ==================== Scaling Benchmarks ====================
+
+/// Work done concurrently on one runtime, a fixed amount of it is split over
+/// a growing number of threads
+enum class ScalingScenario : uint32_t {
+  SymbolPool,    // intern and release symbols
+  ModuleLoading, // load and unload copies of a corpus module
+  ExecutorCalls, // independent calls of a corpus module on an Executor
+  NumScalingScenarios
+};
+
+constexpr const char *ScalingScenarioNames[] = {
+    "symbol_pool",
+    "module_loading",
+    "executor_calls",
+};
+
+constexpr uint32_t NumScalingSymbols = 1 << 20;
+// half of the names are interned before the run, so that both the shared
+// lookups and the exclusive inserts of the pool are measured
+constexpr uint32_t NumScalingSymbolNames = 4096;
+constexpr uint32_t NumScalingModuleLoads = 1024;
+// each call runs the whole workload on a new instance
+constexpr uint32_t NumScalingExecutorCalls = 64;
+
+struct ScalingResult {
+  ScalingScenario Scenario;
+  const Workload *Work;     // nullptr if the scenario runs no module
+  const EngineMode *Engine; // nullptr if the scenario runs no module
+  uint32_t NumThreads;
+  uint32_t NumOps;
+  std::vector<float> Samples; // wall time in milliseconds, one per repetition
+  std::string Error;          // empty if every repetition passed
+};
+
+/// \return the thread counts of the scaling benchmarks, the powers of two
+/// below \p MaxThreads and \p MaxThreads itself
+std::vector<uint32_t> getScalingThreadCounts(uint32_t MaxThreads) {
+  std::vector<uint32_t> Counts;
+  for (uint32_t Count = 1; Count < MaxThreads; Count *= 2) {
+    Counts.push_back(Count);
+  }
+  Counts.push_back(MaxThreads);
+  return Counts;
+}
+
+/// Run \p Op(I) for I in [0, NumOps) on \p NumThreads threads started at
+/// once, each thread takes every NumThreads-th operation
+/// \return the wall time in milliseconds, or a negative value if an
+/// operation failed
+template <typename OpT>
+float runOnThreads(uint32_t NumThreads, uint32_t NumOps, OpT Op) {
+  std::atomic<uint32_t> NumReady = 0;
+  std::atomic<bool> Started = false;
+  std::atomic<bool> Failed = false;
+  std::vector<std::thread> Threads;
+  for (uint32_t T = 0; T < NumThreads; ++T) {
+    Threads.emplace_back([&, T] {
+      ++NumReady;
+      while (!Started.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      for (uint32_t I = T; I < NumOps && !Failed; I += NumThreads) {
+        if (!Op(I)) {
+          Failed = true;
+        }
+      }
+    });
+  }
+  while (NumReady < NumThreads) {
+    std::this_thread::yield();
+  }
+  auto StartTime = std::chrono::steady_clock::now();
+  Started.store(true, std::memory_order_release);
+  for (std::thread &Thread : Threads) {
+    Thread.join();
+  }
+  std::chrono::duration<float, std::milli> Duration =
+      std::chrono::steady_clock::now() - StartTime;
+  return Failed ? -1.0f : Duration.count();
+}
+
+bool runSymbolPoolScaling(uint32_t NumThreads, float &TimeCost,
+                          std::string &Error) {
+  const EngineMode Interpreter = {"interpreter", RunMode::InterpMode, false};
+  std::unique_ptr<Runtime> RT = createBenchmarkRuntime(Interpreter, false,
+                                                       Error);
+  if (!RT) {
+    return false;
+  }
+  std::vector<std::string> Names;
+  std::vector<zen::WASMSymbol> HeldSymbols;
+  for (uint32_t I = 0; I < NumScalingSymbolNames; ++I) {
+    Names.push_back("symbol_" + std::to_string(I));
+    if (I % 2 == 0) {
+      HeldSymbols.push_back(RT->newSymbol(Names[I].data(), Names[I].size()));
+    }
+  }
+  TimeCost = runOnThreads(NumThreads, NumScalingSymbols, [&](uint32_t I) {
+    // scatter the names so that the threads don't run in lockstep
+    const std::string &Name =
+        Names[(I * 2654435761u) % NumScalingSymbolNames];
+    zen::WASMSymbol Symbol = RT->newSymbol(Name.data(), Name.size());
+    if (Symbol == WASM_SYMBOL_NULL) {
+      return false;
+    }
+    RT->freeSymbol(Symbol);
+    return true;
+  });
+  for (zen::WASMSymbol Symbol : HeldSymbols) {
+    RT->freeSymbol(Symbol);
+  }
+  if (TimeCost < 0) {
+    Error = "failed to intern symbol";
+    return false;
+  }
+  return true;
+}
+
+bool runModuleLoadingScaling(const Workload &Work, const EngineMode &Engine,
+                             const std::vector<uint8_t> &Bytecode,
+                             uint32_t NumThreads, float &TimeCost,
+                             std::string &Error) {
+  std::unique_ptr<Runtime> RT = createBenchmarkRuntime(Engine, false, Error);
+  if (!RT) {
+    return false;
+  }
+  TimeCost = runOnThreads(NumThreads, NumScalingModuleLoads, [&](uint32_t I) {
+    std::string Name = std::string(Work.Name) + "_" + std::to_string(I);
+    MayBe<Module *> ModRet =
+        RT->loadModule(Name, Bytecode.data(), Bytecode.size());
+    return ModRet && RT->unloadModule(*ModRet);
+  });
+  if (TimeCost < 0) {
+    Error = "failed to load module";
+    return false;
+  }
+  return true;
+}
+
+bool runExecutorScaling(const Workload &Work, const EngineMode &Engine,
+                        const std::vector<uint8_t> &Bytecode,
+                        uint32_t NumThreads, float &TimeCost,
+                        std::string &Error) {
+  std::unique_ptr<Runtime> RT = createBenchmarkRuntime(Engine, false, Error);
+  if (!RT) {
+    return false;
+  }
+  MayBe<Module *> ModRet =
+      RT->loadModule(Work.Name, Bytecode.data(), Bytecode.size(), "run");
+  if (!ModRet) {
+    Error = "failed to load module: " +
+            ModRet.getError().getFormattedMessage(false);
+    return false;
+  }
+  const FunctionHandle *Func = (*ModRet)->getFunctionHandle("run");
+  if (!Func) {
+    Error = "failed to find function 'run'";
+    return false;
+  }
+  Executor Exec(*RT, NumThreads);
+  UntypedValue Input;
+  Input.I32 = Work.Input;
+  std::vector<std::future<ExecutorCallResult>> Futures;
+  Futures.reserve(NumScalingExecutorCalls);
+  // the module is compiled before, only the calls are timed
+  auto StartTime = std::chrono::steady_clock::now();
+  for (uint32_t I = 0; I < NumScalingExecutorCalls; ++I) {
+    Futures.push_back(Exec.submitCall(**ModRet, *Func, {Input}, UINT64_MAX));
+  }
+  bool Passed = true;
+  for (std::future<ExecutorCallResult> &Future : Futures) {
+    ExecutorCallResult Result = Future.get();
+    Passed &= Result.ErrCode == ErrorCode::NoError &&
+              Result.Results.size() == 1 &&
+              Result.Results[0].I64 == Work.Expected;
+  }
+  std::chrono::duration<float, std::milli> Duration =
+      std::chrono::steady_clock::now() - StartTime;
+  if (!Passed) {
+    Error = "unexpected result of executor call";
+    return false;
+  }
+  TimeCost = Duration.count();
+  return true;
+}
+
+bool readModuleFile(const std::string &Path, std::vector<uint8_t> &Bytecode) {
+  std::ifstream File(Path, std::ios::binary);
+  if (!File) {
+    return false;
+  }
+  Bytecode.assign(std::istreambuf_iterator<char>(File),
+                  std::istreambuf_iterator<char>());
+  return true;
+}
+
+/// Run every scaling scenario of \p Works in \p Engines for each thread count
+std::vector<ScalingResult>
+runScalingBenchmarks(const std::vector<const Workload *> &Works,
+                     const std::vector<const EngineMode *> &Engines,
+                     const std::string &CorpusDir, uint32_t MaxThreads,
+                     uint32_t NumRepetitions) {
+  std::vector<ScalingResult> Results;
+  auto Measure = [&](ScalingResult Result, auto Run) {
+    for (uint32_t I = 0; I < NumRepetitions; ++I) {
+      float TimeCost = 0;
+      if (!Run(TimeCost, Result.Error)) {
+        break;
+      }
+      Result.Samples.push_back(TimeCost);
+    }
+    Results.push_back(std::move(Result));
+  };
+
+  for (uint32_t NumThreads : getScalingThreadCounts(MaxThreads)) {
+    Measure({ScalingScenario::SymbolPool, nullptr, nullptr, NumThreads,
+             NumScalingSymbols, {}, {}},
+            [&](float &TimeCost, std::string &Error) {
+              return runSymbolPoolScaling(NumThreads, TimeCost, Error);
+            });
+  }
+
+  for (const Workload *Work : Works) {
+    std::vector<uint8_t> Bytecode = Work->Bytecode;
+    std::string Path = CorpusDir + "/" + Work->Name + ".wasm";
+    bool Loaded = !Bytecode.empty() || readModuleFile(Path, Bytecode);
+    for (const EngineMode *Engine : Engines) {
+      for (uint32_t NumThreads : getScalingThreadCounts(MaxThreads)) {
+        ScalingResult LoadResult{ScalingScenario::ModuleLoading,
+                                 Work,
+                                 Engine,
+                                 NumThreads,
+                                 NumScalingModuleLoads,
+                                 {},
+                                 {}};
+        ScalingResult CallResult{ScalingScenario::ExecutorCalls,
+                                 Work,
+                                 Engine,
+                                 NumThreads,
+                                 NumScalingExecutorCalls,
+                                 {},
+                                 {}};
+        if (!Loaded) {
+          LoadResult.Error = "failed to read " + Path;
+          CallResult.Error = LoadResult.Error;
+          Results.push_back(std::move(LoadResult));
+          Results.push_back(std::move(CallResult));
+          continue;
+        }
+        Measure(std::move(LoadResult),
+                [&](float &TimeCost, std::string &Error) {
+                  return runModuleLoadingScaling(*Work, *Engine, Bytecode,
+                                                 NumThreads, TimeCost, Error);
+                });
+        Measure(std::move(CallResult),
+                [&](float &TimeCost, std::string &Error) {
+                  return runExecutorScaling(*Work, *Engine, Bytecode,
+                                            NumThreads, TimeCost, Error);
+                });
+      }
+    }
+  }
+  return Results;
+}
+
+/// \return the median time of the single-thread run of the same scenario,
+/// workload and mode as \p Result, or 0 if it failed
+float getScalingBaseline(const std::vector<ScalingResult> &Results,
+                         const ScalingResult &Result) {
+  for (const ScalingResult &Other : Results) {
+    if (Other.NumThreads == 1 && Other.Scenario == Result.Scenario &&
+        Other.Work == Result.Work && Other.Engine == Result.Engine &&
+        !Other.Samples.empty()) {
+      return summarize(Other.Samples).first;
+    }
+  }
+  return 0;
+}
+
+void printScalingTable(const std::vector<ScalingResult> &Results) {
+  printf("%-16s %-16s %-16s %8s %12s %12s %8s\n", "scenario", "benchmark",
+         "mode", "threads", "time_ms", "ops_per_s", "speedup");
+  for (const ScalingResult &Result : Results) {
+    printf("%-16s %-16s %-16s %8u",
+           ScalingScenarioNames[to_underlying(Result.Scenario)],
+           Result.Work ? Result.Work->Name : "-",
+           Result.Engine ? Result.Engine->Name : "-", Result.NumThreads);
+    if (!Result.Error.empty()) {
+      printf(" %s\n", Result.Error.c_str());
+      continue;
+    }
+    float Median = summarize(Result.Samples).first;
+    float Baseline = getScalingBaseline(Results, Result);
+    printf(" %12.3f %12.0f %8.2f\n", Median, Result.NumOps * 1000.0f / Median,
+           Baseline / Median);
+  }
+}
+
+std::string dumpScalingJSON(const std::vector<ScalingResult> &Results,
+                            uint32_t NumRepetitions) {
+  std::string Out = "{\n  \"engine\": \"dtvm\",\n  \"repetitions\": " +
+                    std::to_string(NumRepetitions) + ",\n  \"scaling\": [";
+  char Buf[256];
+  for (size_t I = 0; I < Results.size(); ++I) {
+    const ScalingResult &Result = Results[I];
+    Out += I == 0 ? "\n" : ",\n";
+    std::snprintf(Buf, sizeof(Buf),
+                  "    {\"scenario\": \"%s\", \"benchmark\": \"%s\", "
+                  "\"mode\": \"%s\", \"threads\": %u, \"ops\": %u, ",
+                  ScalingScenarioNames[to_underlying(Result.Scenario)],
+                  Result.Work ? Result.Work->Name : "",
+                  Result.Engine ? Result.Engine->Name : "", Result.NumThreads,
+                  Result.NumOps);
+    Out += Buf;
+    if (!Result.Error.empty()) {
+      Out += "\"status\": \"error\", \"error\": \"" +
+             escapeJSON(Result.Error) + "\"}";
+      continue;
+    }
+    auto [Median, Min] = summarize(Result.Samples);
+    float Baseline = getScalingBaseline(Results, Result);
+    std::snprintf(Buf, sizeof(Buf),
+                  "\"status\": \"ok\", \"time_ms\": {\"median\": %.4f, "
+                  "\"min\": %.4f}, \"speedup\": %.4f}",
+                  Median, Min, Baseline / Median);
+    Out += Buf;
+  }
+  Out += "\n  ]\n}\n";
+  return Out;
+}
+
+bool writeOutputFile(const std::string &Filename, const std::string &JSON) {
+  FILE *OutputFile = fopen(Filename.c_str(), "w");
+  if (!OutputFile) {
+    printf("failed to open '%s'\n", Filename.c_str());
+    return false;
+  }
+  fwrite(JSON.data(), 1, JSON.size(), OutputFile);
+  fclose(OutputFile);
+  return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::string CorpusDir = ZEN_BENCHMARK_CORPUS_DIR;
+  std::vector<std::string> BenchmarkNames;
+  std::vector<std::string> ModeNames;
+  uint32_t NumRepetitions = 5;
+  std::string OutputFilename;
+  bool RAStress = false;
+  double RAStressScale = 1.0;
+  bool Scaling = false;
+  uint32_t ScalingThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::string> AllBenchmarkNames;
+  for (const Workload &Work : Workloads) {
+    AllBenchmarkNames.push_back(Work.Name);
+  }
+  std::vector<std::string> AllModeNames;
+  for (const EngineMode &Engine : EngineModes) {
+    AllModeNames.push_back(Engine.Name);
+  }
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  for (uint32_t I = 0;
+       I < to_underlying(zen::benchmarks::StressShape::NumStressShapes); ++I) {
+    AllBenchmarkNames.push_back(zen::benchmarks::getStressShapeName(
+        static_cast<zen::benchmarks::StressShape>(I)));
+  }
+  for (const EngineMode &Engine : RAStressModes) {
+    if (std::find(AllModeNames.begin(), AllModeNames.end(), Engine.Name) ==
+        AllModeNames.end()) {
+      AllModeNames.push_back(Engine.Name);
+    }
+  }
+#endif // ZEN_ENABLE_MULTIPASS_JIT
+
+  CLI::App CLIParser("ZetaEngine Benchmarks\n", "dtvmBenchmarks");
+  CLIParser.add_option("--corpus-dir", CorpusDir,
+                       "Directory of the compiled benchmark modules");
+  CLIParser
+      .add_option("-b,--benchmark", BenchmarkNames,
+                  "Benchmarks to run, all by default")
+      ->check(CLI::IsMember(AllBenchmarkNames));
+  CLIParser
+      .add_option("-m,--mode", ModeNames, "Running modes, all by default")
+      ->check(CLI::IsMember(AllModeNames));
+  CLIParser
+      .add_option("-r,--repetitions", NumRepetitions,
+                  "Number of runs of every benchmark in every mode")
+      ->check(CLI::PositiveNumber);
+  CLIParser.add_option("-o,--output", OutputFilename,
+                       "Write the results to this file in json format");
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  CLIParser.add_flag("--ra-stress", RAStress,
+                     "Run the register allocation stress modules instead of "
+                     "the corpus");
+  CLIParser
+      .add_option("--ra-stress-scale", RAStressScale,
+                  "Scale the sizes of the register allocation stress modules")
+      ->check(CLI::PositiveNumber);
+#endif // ZEN_ENABLE_MULTIPASS_JIT
+  CLIParser.add_flag("--scaling", Scaling,
+                     "Measure concurrent symbol interning and module loading "
+                     "on one runtime for a growing number of threads");
+  CLIParser
+      .add_option("--scaling-threads", ScalingThreads,
+                  "The largest number of threads of the scaling benchmarks")
+      ->check(CLI::PositiveNumber);
+  CLI11_PARSE(CLIParser, argc, argv);
+
+  zen::setGlobalLogger(
+      createConsoleLogger("dtvm_benchmarks_logger", LoggerLevel::Error));
+
+  std::vector<Workload> Works;
+  std::vector<EngineMode> Engines;
+  if (RAStress) {
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+    std::string Error;
+    if (!buildRAStressWorkloads(RAStressScale, Works, Error)) {
+      printf("failed to build stress modules: %s\n", Error.c_str());
+      return EXIT_FAILURE;
+    }
+    Engines.assign(std::begin(RAStressModes), std::end(RAStressModes));
+#endif // ZEN_ENABLE_MULTIPASS_JIT
+  } else {
+    Works.assign(std::begin(Workloads), std::end(Workloads));
+    Engines.assign(std::begin(EngineModes), std::end(EngineModes));
+  }
+
+  auto IsSelected = [](const std::vector<std::string> &Names,
+                       const char *Name) {
+    return Names.empty() ||
+           std::find(Names.begin(), Names.end(), Name) != Names.end();
+  };
+
+  if (Scaling) {
+    std::vector<const Workload *> SelectedWorks;
+    for (const Workload &Work : Works) {
+      if (IsSelected(BenchmarkNames, Work.Name)) {
+        SelectedWorks.push_back(&Work);
+      }
+    }
+    std::vector<const EngineMode *> SelectedEngines;
+    for (const EngineMode &Engine : Engines) {
+      if (IsSelected(ModeNames, Engine.Name)) {
+        SelectedEngines.push_back(&Engine);
+      }
+    }
+    std::vector<ScalingResult> ScalingResults =
+        runScalingBenchmarks(SelectedWorks, SelectedEngines, CorpusDir,
+                             ScalingThreads, NumRepetitions);
+    printScalingTable(ScalingResults);
+    if (!OutputFilename.empty() &&
+        !writeOutputFile(OutputFilename,
+                         dumpScalingJSON(ScalingResults, NumRepetitions))) {
+      return EXIT_FAILURE;
+    }
+    bool ScalingFailed = std::any_of(
+        ScalingResults.begin(), ScalingResults.end(),
+        [](const ScalingResult &Result) { return !Result.Error.empty(); });
+    return ScalingFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+  }
+
+  std::vector<BenchmarkResult> Results;
+  bool Failed = false;
+  for (const Workload &Work : Works) {
+    if (!IsSelected(BenchmarkNames, Work.Name)) {
+      continue;
+    }
+    std::string Path = CorpusDir + "/" + Work.Name + ".wasm";
+    for (const EngineMode &Engine : Engines) {
+      if (!IsSelected(ModeNames, Engine.Name)) {
+        continue;
+      }
+      Results.push_back(runBenchmark(Work, Engine, Path, NumRepetitions));
+      Failed |= !Results.back().Error.empty();
+    }
+  }
+
+  printTable(Results);
+  if (RAStress) {
+    printPassTable(Results);
+  }
+
+  if (!OutputFilename.empty() &&
+      !writeOutputFile(OutputFilename, dumpJSON(Results, NumRepetitions))) {
+    return EXIT_FAILURE;
+  }
+
+  return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
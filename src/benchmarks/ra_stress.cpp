@@ -0,0 +1,366 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "benchmarks/ra_stress.h"
+#include "common/defines.h"
+#include "common/enums.h"
+
+namespace zen::benchmarks {
+
+using namespace zen::common;
+
+namespace {
+
+constexpr uint8_t TypeI32 = 0x7f;
+constexpr uint8_t TypeI64 = 0x7e;
+constexpr uint8_t BlockTypeVoid = 0x40;
+constexpr uint8_t FuncTypeForm = 0x60;
+
+// the i32 parameter of `run`
+constexpr uint32_t ParamIdx = 0;
+
+class WasmWriter {
+public:
+  const std::vector<uint8_t> &getBytes() const { return Bytes; }
+
+  void writeByte(uint8_t Byte) { Bytes.push_back(Byte); }
+
+  void writeBytes(const std::vector<uint8_t> &Other) {
+    Bytes.insert(Bytes.end(), Other.begin(), Other.end());
+  }
+
+  void writeU32(uint32_t Value) {
+    do {
+      uint8_t Byte = Value & 0x7f;
+      Value >>= 7;
+      writeByte(Value != 0 ? (Byte | 0x80) : Byte);
+    } while (Value != 0);
+  }
+
+  void writeS64(int64_t Value) {
+    bool More = true;
+    while (More) {
+      uint8_t Byte = Value & 0x7f;
+      Value >>= 7; // arithmetic shift
+      More = !((Value == 0 && (Byte & 0x40) == 0) ||
+               (Value == -1 && (Byte & 0x40) != 0));
+      writeByte(More ? (Byte | 0x80) : Byte);
+    }
+  }
+
+  void writeOp(Opcode Op) { writeByte(static_cast<uint8_t>(Op)); }
+
+  void writeOp(Opcode Op, uint32_t Imm) {
+    writeOp(Op);
+    writeU32(Imm);
+  }
+
+  void writeI32Const(int32_t Value) {
+    writeOp(I32_CONST);
+    writeS64(Value);
+  }
+
+  void writeI64Const(int64_t Value) {
+    writeOp(I64_CONST);
+    writeS64(Value);
+  }
+
+  void writeSection(SectionType Type, const WasmWriter &Content) {
+    writeByte(Type);
+    writeU32(Content.Bytes.size());
+    writeBytes(Content.Bytes);
+  }
+
+private:
+  std::vector<uint8_t> Bytes;
+};
+
+/// Function body under construction, local 0 is the i32 parameter
+class BodyBuilder : public WasmWriter {
+public:
+  /// \return the index of the first of \p Count new i64 locals
+  uint32_t addI64Locals(uint32_t Count) {
+    uint32_t FirstIdx = NumLocals;
+    NumLocals += Count;
+    NumI64Locals += Count;
+    return FirstIdx;
+  }
+
+  // x = extend_u(param) + Addend
+  void writeSetFromParam(uint32_t LocalIdx, int64_t Addend) {
+    writeOp(GET_LOCAL, ParamIdx);
+    writeOp(I64_EXTEND_U_I32);
+    writeI64Const(Addend);
+    writeOp(I64_ADD);
+    writeOp(SET_LOCAL, LocalIdx);
+  }
+
+  void finish(WasmWriter &Out) const {
+    WasmWriter Body;
+    if (NumI64Locals > 0) {
+      Body.writeU32(1);
+      Body.writeU32(NumI64Locals);
+      Body.writeByte(TypeI64);
+    } else {
+      Body.writeU32(0);
+    }
+    Body.writeBytes(getBytes());
+    Body.writeOp(END);
+    Out.writeU32(Body.getBytes().size());
+    Out.writeBytes(Body.getBytes());
+  }
+
+private:
+  uint32_t NumLocals = 1;
+  uint32_t NumI64Locals = 0;
+};
+
+// Size values are computed from the parameter, and all of them stay live
+// until they are summed at the end
+void buildWideLiveRanges(BodyBuilder &B, uint32_t Size) {
+  uint32_t X = B.addI64Locals(1);
+  uint32_t FirstValue = B.addI64Locals(Size);
+  B.writeSetFromParam(X, 0);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(GET_LOCAL, X);
+    B.writeI64Const(2 * I + 1);
+    B.writeOp(I64_MUL);
+    B.writeI64Const(I);
+    B.writeOp(I64_ADD);
+    B.writeOp(SET_LOCAL, FirstValue + I);
+  }
+  for (uint32_t I = 0; I < 64; ++I) {
+    B.writeOp(GET_LOCAL, X);
+    B.writeI64Const(5);
+    B.writeOp(I64_ROTL);
+    B.writeI64Const(0x9e3779b97f4a7c15 ^ I);
+    B.writeOp(I64_XOR);
+    B.writeOp(SET_LOCAL, X);
+  }
+  B.writeOp(GET_LOCAL, X);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(GET_LOCAL, FirstValue + I);
+    B.writeOp(I64_ADD);
+  }
+}
+
+// Size nested ifs, the I-th of which is taken when the parameter is greater
+// than I
+void buildDeepNesting(BodyBuilder &B, uint32_t Size) {
+  uint32_t Acc = B.addI64Locals(1);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(GET_LOCAL, Acc);
+    B.writeI64Const(31);
+    B.writeOp(I64_MUL);
+    B.writeI64Const(I + 1);
+    B.writeOp(I64_ADD);
+    B.writeOp(SET_LOCAL, Acc);
+    B.writeOp(GET_LOCAL, ParamIdx);
+    B.writeI32Const(I);
+    B.writeOp(I32_GT_U);
+    B.writeOp(IF);
+    B.writeByte(BlockTypeVoid);
+  }
+  B.writeOp(GET_LOCAL, Acc);
+  B.writeI64Const(1);
+  B.writeOp(I64_ADD);
+  B.writeOp(SET_LOCAL, Acc);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(END);
+  }
+  B.writeOp(GET_LOCAL, Acc);
+}
+
+// Size nested blocks, a br_table on the parameter jumps to the end of one of
+// them, and the code after every block end updates the accumulator
+void buildHugeBrTable(BodyBuilder &B, uint32_t Size) {
+  uint32_t Acc = B.addI64Locals(1);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(BLOCK);
+    B.writeByte(BlockTypeVoid);
+  }
+  B.writeOp(GET_LOCAL, ParamIdx);
+  B.writeI32Const(Size);
+  B.writeOp(I32_REM_U);
+  B.writeOp(BR_TABLE, Size);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeU32(I);
+  }
+  B.writeU32(Size - 1);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(END);
+    B.writeOp(GET_LOCAL, Acc);
+    B.writeI64Const(7);
+    B.writeOp(I64_MUL);
+    B.writeI64Const(I + 1);
+    B.writeOp(I64_ADD);
+    B.writeOp(SET_LOCAL, Acc);
+  }
+  B.writeOp(GET_LOCAL, Acc);
+}
+
+// Size locals, each of which is updated from another one in every iteration
+// of a loop running the parameter times
+void buildManyLocals(BodyBuilder &B, uint32_t Size) {
+  uint32_t FirstLocal = B.addI64Locals(Size);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeSetFromParam(FirstLocal + I, I);
+  }
+  B.writeOp(BLOCK);
+  B.writeByte(BlockTypeVoid);
+  B.writeOp(GET_LOCAL, ParamIdx);
+  B.writeOp(I32_EQZ);
+  B.writeOp(BR_IF, 0);
+  B.writeOp(LOOP);
+  B.writeByte(BlockTypeVoid);
+  for (uint32_t I = 0; I < Size; ++I) {
+    B.writeOp(GET_LOCAL, FirstLocal + I);
+    B.writeOp(GET_LOCAL, FirstLocal + (uint64_t(I) * 7 + 1) % Size);
+    B.writeOp(I64_ADD);
+    B.writeI64Const(1);
+    B.writeOp(I64_ROTL);
+    B.writeOp(SET_LOCAL, FirstLocal + I);
+  }
+  B.writeOp(GET_LOCAL, ParamIdx);
+  B.writeI32Const(1);
+  B.writeOp(I32_SUB);
+  B.writeOp(TEE_LOCAL, ParamIdx);
+  B.writeOp(BR_IF, 0);
+  B.writeOp(END);
+  B.writeOp(END);
+  B.writeOp(GET_LOCAL, FirstLocal);
+  for (uint32_t I = 1; I < Size; ++I) {
+    B.writeOp(GET_LOCAL, FirstLocal + I);
+    B.writeOp(I64_XOR);
+  }
+}
+
+// Size straight-line operations on a few locals
+void buildGiantBlock(BodyBuilder &B, uint32_t Size) {
+  constexpr uint32_t NumChains = 16;
+  constexpr Opcode Ops[] = {I64_ADD, I64_XOR, I64_MUL, I64_ROTL};
+  uint32_t FirstLocal = B.addI64Locals(NumChains);
+  for (uint32_t I = 0; I < NumChains; ++I) {
+    B.writeSetFromParam(FirstLocal + I, 0x9e3779b97f4a7c15 * (I + 1));
+  }
+  for (uint32_t I = 0; I < Size; ++I) {
+    // 5 * I + 3 and I never have the same parity
+    uint32_t Dst = FirstLocal + I % NumChains;
+    uint32_t Src = FirstLocal + (5 * I + 3) % NumChains;
+    B.writeOp(GET_LOCAL, Dst);
+    B.writeOp(GET_LOCAL, Src);
+    B.writeOp(Ops[(I / NumChains) % (sizeof(Ops) / sizeof(Ops[0]))]);
+    B.writeOp(SET_LOCAL, Dst);
+  }
+  B.writeOp(GET_LOCAL, FirstLocal);
+  for (uint32_t I = 1; I < NumChains; ++I) {
+    B.writeOp(GET_LOCAL, FirstLocal + I);
+    B.writeOp(I64_XOR);
+  }
+}
+
+} // namespace
+
+const char *getStressShapeName(StressShape Shape) {
+  switch (Shape) {
+  case StressShape::WideLiveRanges:
+    return "wide_live_ranges";
+  case StressShape::DeepNesting:
+    return "deep_nesting";
+  case StressShape::HugeBrTable:
+    return "huge_br_table";
+  case StressShape::ManyLocals:
+    return "many_locals";
+  case StressShape::GiantBlock:
+    return "giant_block";
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+uint32_t getDefaultStressSize(StressShape Shape) {
+  switch (Shape) {
+  case StressShape::WideLiveRanges:
+    return 2000;
+  case StressShape::DeepNesting:
+    return 1000;
+  case StressShape::HugeBrTable:
+    return 1000;
+  case StressShape::ManyLocals:
+    return 4000;
+  case StressShape::GiantBlock:
+    return 20000;
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+uint32_t getStressInput(StressShape Shape, uint32_t Size) {
+  switch (Shape) {
+  case StressShape::DeepNesting:
+    return Size / 2;
+  case StressShape::HugeBrTable:
+    return Size / 3;
+  case StressShape::ManyLocals:
+    return 4;
+  default:
+    return 42;
+  }
+}
+
+std::vector<uint8_t> buildStressModule(StressShape Shape, uint32_t Size) {
+  ZEN_ASSERT(Size > 0);
+  BodyBuilder Body;
+  switch (Shape) {
+  case StressShape::WideLiveRanges:
+    buildWideLiveRanges(Body, Size);
+    break;
+  case StressShape::DeepNesting:
+    buildDeepNesting(Body, Size);
+    break;
+  case StressShape::HugeBrTable:
+    buildHugeBrTable(Body, Size);
+    break;
+  case StressShape::ManyLocals:
+    buildManyLocals(Body, Size);
+    break;
+  case StressShape::GiantBlock:
+    buildGiantBlock(Body, Size);
+    break;
+  default:
+    ZEN_UNREACHABLE();
+  }
+
+  WasmWriter TypeSec;
+  TypeSec.writeU32(1);
+  TypeSec.writeByte(FuncTypeForm);
+  TypeSec.writeU32(1);
+  TypeSec.writeByte(TypeI32);
+  TypeSec.writeU32(1);
+  TypeSec.writeByte(TypeI64);
+
+  WasmWriter FuncSec;
+  FuncSec.writeU32(1);
+  FuncSec.writeU32(0);
+
+  WasmWriter ExportSec;
+  ExportSec.writeU32(1);
+  ExportSec.writeU32(3);
+  ExportSec.writeBytes({'r', 'u', 'n'});
+  ExportSec.writeByte(EXPORT_FUNC);
+  ExportSec.writeU32(0);
+
+  WasmWriter CodeSec;
+  CodeSec.writeU32(1);
+  Body.finish(CodeSec);
+
+  WasmWriter Mod;
+  Mod.writeBytes({0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00});
+  Mod.writeSection(SEC_TYPE, TypeSec);
+  Mod.writeSection(SEC_FUNC, FuncSec);
+  Mod.writeSection(SEC_EXPORT, ExportSec);
+  Mod.writeSection(SEC_CODE, CodeSec);
+  return Mod.getBytes();
+}
+
+} // namespace zen::benchmarks
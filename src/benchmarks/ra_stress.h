@@ -0,0 +1,38 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_BENCHMARKS_RA_STRESS_H
+#define ZEN_BENCHMARKS_RA_STRESS_H
+
+#include <cstdint>
+#include <vector>
+
+namespace zen::benchmarks {
+
+/// Shapes of functions known to be expensive for register allocation
+enum class StressShape : uint32_t {
+  WideLiveRanges, // many values live across a long region
+  DeepNesting,    // deeply nested ifs
+  HugeBrTable,    // a br_table to many nested blocks
+  ManyLocals,     // thousands of locals updated in a loop
+  GiantBlock,     // one huge basic block
+  NumStressShapes
+};
+
+const char *getStressShapeName(StressShape Shape);
+
+/// \return the default size of \p Shape, large enough for register
+/// allocation to dominate the compilation
+uint32_t getDefaultStressSize(StressShape Shape);
+
+/// \return the argument of `run` that makes the module exercise most of its
+/// code for \p Size
+uint32_t getStressInput(StressShape Shape, uint32_t Size);
+
+/// Build a module exporting `run(i32) -> i64`, whose only function has the
+/// \p Shape and grows linearly with \p Size
+std::vector<uint8_t> buildStressModule(StressShape Shape, uint32_t Size);
+
+} // namespace zen::benchmarks
+
+#endif // ZEN_BENCHMARKS_RA_STRESS_H
@@ -3,10 +3,12 @@
 
 #include "runtime/codeholder.h"
 #include "utils/logging.h"
+#include "utils/metrics.h"
 #include "utils/others.h"
 #include "utils/statistics.h"
 #include "zetaengine.h"
 #include <CLI/CLI.hpp>
+#include <cinttypes>
 #include <unistd.h>
 
 #ifdef ZEN_ENABLE_BUILTIN_WASI
@@ -17,6 +19,10 @@
 #include "host/env/env.h"
 #endif
 
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+#include "host/crypto/crypto.h"
+#endif
+
 #ifdef ZEN_ENABLE_PROFILER
 #include <gperftools/profiler.h>
 #endif
@@ -37,6 +43,8 @@ int exitMain(int ExitCode, Runtime *RT = nullptr) {
   return ExitCode;
 }
 
+enum class MetricsFormat { None, Prometheus, JSON };
+
 int main(int argc, char *argv[]) {
 #ifdef ZEN_ENABLE_PROFILER
   ProfilerStart("dtvm.prof");
@@ -61,8 +69,13 @@ int main(int argc, char *argv[]) {
   LoggerLevel LogLevel = LoggerLevel::Info;
   uint32_t NumExtraCompilations = 0;
   uint32_t NumExtraExecutions = 0;
+  uint32_t NumExecutorThreads = 0;
   RuntimeConfig Config;
   bool EnableBenchmark = false;
+  MetricsFormat PrintMetrics = MetricsFormat::None;
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  std::string SamplingProfileFilename;
+#endif
 
   const std::unordered_map<std::string, RunMode> ModeMap = {
       {"interpreter", RunMode::InterpMode},
@@ -75,6 +88,10 @@ int main(int argc, char *argv[]) {
       {"error", LoggerLevel::Error}, {"fatal", LoggerLevel::Fatal},
       {"off", LoggerLevel::Off},
   };
+  const std::unordered_map<std::string, MetricsFormat> MetricsFormatMap = {
+      {"prometheus", MetricsFormat::Prometheus},
+      {"json", MetricsFormat::JSON},
+  };
 
   try {
     CLIParser->add_option("WASM_FILE", WasmFilename, "WASM filename")
@@ -92,8 +109,21 @@ int main(int argc, char *argv[]) {
                           "The number of extra compilations");
     CLIParser->add_option("--num-extra-executions", NumExtraExecutions,
                           "The number of extra executions");
+    CLIParser->add_option("--num-executor-threads", NumExecutorThreads,
+                          "Run the extra executions in parallel on this "
+                          "number of threads and report the throughput");
     CLIParser->add_flag("--enable-statistics", Config.EnableStatistics,
                         "Enable statistics");
+    CLIParser
+        ->add_option("--print-metrics", PrintMetrics,
+                     "Print the runtime metrics before exit, in prometheus "
+                     "or json format")
+        ->transform(
+            CLI::CheckedTransformer(MetricsFormatMap, CLI::ignore_case));
+    CLIParser->add_flag("--profile-report", Config.EnableFunctionProfiling,
+                        "Count the calls, loop iterations and gas of every "
+                        "wasm function and print them by self cost before "
+                        "exit");
     CLIParser->add_flag("--disable-wasm-memory-map",
                         Config.DisableWasmMemoryMap, "Disable wasm memory map");
     CLIParser->add_flag("--benchmark", EnableBenchmark, "Enable benchmark");
@@ -105,10 +135,43 @@ int main(int argc, char *argv[]) {
         "--enable-gdb-tracing-hook", Config.EnableGdbTracingHook,
         "Enable gdb cpu instruction tracing hook(then can trace cpu "
         "instructions when executing wasm in gdb)");
+    CLIParser->add_flag("--enable-hostapi-intrinsics",
+                        Config.EnableHostapiIntrinsics,
+                        "Implement env.memcpy, memmove, memset, memcmp and "
+                        "strlen in the runtime and inline them in the JITs");
+    CLIParser->add_flag("--enable-numa", Config.EnableNUMA,
+                        "Bind linear memories and compile threads to the "
+                        "current NUMA node");
+    CLIParser->add_flag("--enable-thread-caching-allocator",
+                        Config.EnableThreadCachingAllocator,
+                        "Use a thread-caching arena for runtime allocations");
+    CLIParser->add_option("--max-indirect-call-cache-targets",
+                          Config.MaxIndirectCallCacheTargets,
+                          "Call the targets of call_indirect directly when "
+                          "a site may reach at most this many functions(set "
+                          "0 to disable)");
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+    CLIParser->add_flag("--enable-numa-code-replication",
+                        Config.EnableNUMACodeReplication,
+                        "Replicate singlepass JIT code on every NUMA node");
+    CLIParser->add_flag("--enable-singlepass-local-caching",
+                        Config.EnableSinglepassLocalCaching,
+                        "Keep the hottest locals of every function in "
+                        "registers in singlepass JIT");
+#endif // ZEN_ENABLE_SINGLEPASS_JIT
 #ifdef ZEN_ENABLE_MULTIPASS_JIT
     CLIParser->add_flag("--disable-multipass-greedyra",
                         Config.DisableMultipassGreedyRA,
                         "Disable greedy register allocation of multipass JIT");
+    CLIParser->add_option("--multipass-greedyra-budget",
+                          Config.MultipassGreedyRABudget,
+                          "Use fast register allocation for functions whose "
+                          "virtual registers times basic blocks exceed this "
+                          "budget(set 0 for no limit)");
+    CLIParser->add_flag("--enable-multipass-adaptive-ra",
+                        Config.EnableMultipassAdaptiveRA,
+                        "Choose the register allocator of every function from "
+                        "its size, loops and profile");
     auto *DMMOption = CLIParser->add_flag(
         "--disable-multipass-multithread", Config.DisableMultipassMultithread,
         "Disable multithread compilation of multipass JIT");
@@ -122,6 +185,12 @@ int main(int argc, char *argv[]) {
     CLIParser->add_option("--entry-hint", EntryHint, "Entry function hint");
 #endif // ZEN_ENABLE_MULTIPASS_JIT
 
+#ifdef ZEN_ENABLE_JIT_PROFILER
+    CLIParser->add_option("--sampling-profile", SamplingProfileFilename,
+                          "Sample the JIT code during the executions and "
+                          "write the collapsed stacks to this file");
+#endif
+
     CLI11_PARSE(*CLIParser, argc, argv);
   } catch (const std::exception &e) {
     printf("failed to parse command line arguments: %s\n", e.what());
@@ -166,6 +235,16 @@ int main(int argc, char *argv[]) {
   }
 #endif
 
+  /// ================ Load crypto module ================
+
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+  HostModule *CryptoMod = LOAD_HOST_MODULE(RT, zen::host, crypto);
+  if (!CryptoMod) {
+    ZEN_LOG_ERROR("failed to load crypto module");
+    return exitMain(EXIT_FAILURE, RT.get());
+  }
+#endif
+
   /// ================ Load user's module ================
 
   const auto &ActualEntryHint = !EntryHint.empty() ? EntryHint : FuncName;
@@ -201,6 +280,13 @@ int main(int argc, char *argv[]) {
 
   /// ================ Call function ================
 
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  if (!SamplingProfileFilename.empty() && !SamplingProfiler::start()) {
+    ZEN_LOG_ERROR("failed to start sampling profiler");
+    return exitMain(EXIT_FAILURE, RT.get());
+  }
+#endif
+
   std::vector<TypedValue> Results;
   if (!FuncName.empty()) {
     /// Call the specified function
@@ -244,6 +330,35 @@ int main(int argc, char *argv[]) {
       ZEN_ASSERT(TestModRet);
       RT->unloadModule(*TestModRet);
     }
+    if (NumExecutorThreads > 0) {
+      // each execution gets its own instance, the workers scale with the
+      // number of threads as long as the calls are independent
+      Executor Exec(*RT, NumExecutorThreads);
+      auto Start = SteadyClock::now();
+      for (uint32_t I = 0; I < NumExtraExecutions; ++I) {
+        Exec.submit([&](Isolation &WorkerIso) {
+          MayBe<Instance *> TestInstRet =
+              WorkerIso.createInstance(*Mod, GasLimit);
+          ZEN_ASSERT(TestInstRet);
+          Instance *TestInst = *TestInstRet;
+          std::vector<TypedValue> TestResults;
+          if (!FuncName.empty()) {
+            RT->callWasmFunction(*TestInst, FuncName, Args, TestResults);
+          } else {
+            RT->callWasmMain(*TestInst, TestResults);
+          }
+          WorkerIso.deleteInstance(TestInst);
+        });
+      }
+      Exec.wait();
+      double Elapsed =
+          chrono::duration<double, std::milli>(SteadyClock::now() - Start)
+              .count();
+      ZEN_LOG_INFO("executed %u calls on %u threads in %.3f ms (%.1f calls/s)",
+                   NumExtraExecutions, NumExecutorThreads, Elapsed,
+                   NumExtraExecutions * 1000.0 / Elapsed);
+      NumExtraExecutions = 0;
+    }
     for (uint32_t I = 0; I < NumExtraExecutions; ++I) {
       Results.clear();
       IsolationUniquePtr TestIso = RT->createUnmanagedIsolation();
@@ -266,7 +381,32 @@ int main(int argc, char *argv[]) {
 
 #endif
 
-  if (EnableBenchmark) {
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  if (!SamplingProfileFilename.empty()) {
+    SamplingProfiler::stop();
+    FILE *ProfileFile = fopen(SamplingProfileFilename.c_str(), "w");
+    if (!ProfileFile) {
+      ZEN_LOG_ERROR("failed to open '%s'", SamplingProfileFilename.c_str());
+      return exitMain(EXIT_FAILURE, RT.get());
+    }
+    std::string Stacks = SamplingProfiler::getCollapsedStacks();
+    fwrite(Stacks.data(), 1, Stacks.size(), ProfileFile);
+    fclose(ProfileFile);
+    ZEN_LOG_INFO("wrote %" PRIu64 " samples to '%s'",
+                 SamplingProfiler::getNumSamples(),
+                 SamplingProfileFilename.c_str());
+  }
+#endif
+
+  if (PrintMetrics != MetricsFormat::None) {
+    Metrics::Snapshot Snap = Metrics::getSnapshot();
+    std::string Out = PrintMetrics == MetricsFormat::JSON ? Snap.toJSON()
+                                                          : Snap.toPrometheus();
+    printf("%s\n", Out.c_str());
+  }
+
+  // the profile is only complete once the instances are deleted
+  if (EnableBenchmark && !Config.EnableFunctionProfiling) {
     _exit(ExitCode);
   }
 
@@ -277,6 +417,10 @@ int main(int argc, char *argv[]) {
     return exitMain(EXIT_FAILURE, RT.get());
   }
 
+  if (Config.EnableFunctionProfiling) {
+    printf("%s", dumpFunctionProfile(*Mod).c_str());
+  }
+
   /// ================ Delete isolation ================
 
   if (!RT->deleteManagedIsolation(Iso)) {
@@ -300,6 +444,15 @@ int main(int argc, char *argv[]) {
     return exitMain(EXIT_FAILURE, RT.get());
   }
 
+  /// ================ Unload crypto module ================
+
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+  if (!RT->unloadHostModule(CryptoMod)) {
+    ZEN_LOG_ERROR("failed to unload crypto module");
+    return exitMain(EXIT_FAILURE, RT.get());
+  }
+#endif
+
   /// ================ Unload env module ================
 
 #ifdef ZEN_ENABLE_BUILTIN_ENV
@@ -8,7 +8,9 @@ namespace zen::common {
 #define WASM_SYMBOLS_MAX ((1u << 30) - 1)
 
 struct ConstStringEntry {
-  int32_t RefCount;
+  // only decreased to zero with the pool locked exclusively, so entries
+  // visible to shared lock holders are always alive
+  std::atomic<int32_t> RefCount;
   uint32_t Len;
   uint32_t Hash;
   uint32_t HashNext;
@@ -21,7 +23,10 @@ static const char WASMInitSymbols[] = {
 #undef DEF_CONST_STRING
 };
 
-int32_t ConstStringPool::getNumSymbols() { return EntriesCount; }
+int32_t ConstStringPool::getNumSymbols() {
+  SharedLock<SharedMutex> Lock(Mtx);
+  return EntriesCount;
+}
 
 bool ConstStringPool::isReserved(WASMSymbol Sym) {
   if (Sym < WASM_SYMBOLS_END)
@@ -138,9 +143,9 @@ bool ConstStringPool::resizeEntriesArray() {
   Start = EntriesSize;
   if (Start == 0) {
 
-    P = reinterpret_cast<ConstStringEntry *>(
-        MPool.allocate(sizeof(ConstStringEntry)));
-    ZEN_ASSERT(P);
+    void *EntryBuf = MPool.allocate(sizeof(ConstStringEntry));
+    ZEN_ASSERT(EntryBuf);
+    P = new (EntryBuf) ConstStringEntry();
 
     P->RefCount = 1;
     NewArray[0] = P;
@@ -178,11 +183,11 @@ static uint32_t getStringHash(const uint8_t *Str, size_t Len) {
   return Hash;
 }
 
-WASMSymbol ConstStringPool::probeSymbol(const char *Str, size_t Len) const {
-  uint32_t H, H1, I;
+WASMSymbol ConstStringPool::lookupSymbol(const char *Str, size_t Len,
+                                         uint32_t H) const {
+  uint32_t H1, I;
   ConstStringEntry *P;
 
-  H = getStringHash((const uint8_t *)Str, Len);
   H1 = H & (HashTableSize - 1);
   I = StrHashTable[H1];
   while (I != 0) {
@@ -195,12 +200,21 @@ WASMSymbol ConstStringPool::probeSymbol(const char *Str, size_t Len) const {
   return WASM_SYMBOL_NULL;
 }
 
-WASMSymbol ConstStringPool::findAndHoldSymbol(const char *Str, size_t Len) {
-  WASMSymbol Ret = probeSymbol(Str, Len);
+WASMSymbol ConstStringPool::probeSymbol(const char *Str, size_t Len) const {
+  uint32_t H = getStringHash((const uint8_t *)Str, Len);
+  SharedLock<SharedMutex> Lock(Mtx);
+  if (!StrHashTable || !EntriesArray)
+    return WASM_SYMBOL_NULL;
+  return lookupSymbol(Str, Len, H);
+}
+
+WASMSymbol ConstStringPool::findAndHoldSymbol(const char *Str, size_t Len,
+                                              uint32_t Hash) {
+  WASMSymbol Ret = lookupSymbol(Str, Len, Hash);
   if (Ret != WASM_SYMBOL_NULL) {
     ConstStringEntry *P = EntriesArray[Ret];
     if (!isReserved(Ret))
-      P->RefCount++;
+      P->RefCount.fetch_add(1, std::memory_order_relaxed);
   }
   return Ret;
 }
@@ -251,27 +265,33 @@ WASMSymbol ConstStringPool::newSymbolInit(const char *Str, size_t Len) {
 
 WASMSymbol ConstStringPool::newSymbol(const char *Str, size_t Len) {
   uint32_t Hash, Hash1, I;
-  ConstStringEntry *P = nullptr, *Entry = nullptr;
-  int32_t Resize = HashTableSize * 2;
-
-  if (!StrHashTable || !EntriesArray)
-    return WASM_SYMBOL_NULL;
+  ConstStringEntry *Entry = nullptr;
 
   Hash = getStringHash((const uint8_t *)Str, Len);
-  Hash1 = Hash & (HashTableSize - 1);
-  I = StrHashTable[Hash1];
-  while (I != 0) {
-    P = EntriesArray[I];
-    if (P->Hash == Hash && P->Len == Len &&
-        std::memcmp(P->Str8, Str, Len) == 0) {
-      if (!isReserved(I))
-        P->RefCount++;
 
+  // symbols shared by modules(e.g. import module names) usually exist, so
+  // look them up without blocking other readers first
+  {
+    SharedLock<SharedMutex> Lock(Mtx);
+    if (!StrHashTable || !EntriesArray)
+      return WASM_SYMBOL_NULL;
+    I = findAndHoldSymbol(Str, Len, Hash);
+    if (I != WASM_SYMBOL_NULL)
       return I;
-    }
-    I = P->HashNext;
   }
 
+  UniqueLock<SharedMutex> Lock(Mtx);
+  if (!StrHashTable || !EntriesArray)
+    return WASM_SYMBOL_NULL;
+
+  // inserted by another thread after the shared lock was released
+  I = findAndHoldSymbol(Str, Len, Hash);
+  if (I != WASM_SYMBOL_NULL)
+    return I;
+
+  int32_t Resize = HashTableSize * 2;
+  Hash1 = Hash & (HashTableSize - 1);
+
   if (FreeIndex == 0) {
     if (!resizeEntriesArray()) {
       return WASM_SYMBOL_NULL;
@@ -321,8 +341,7 @@ void ConstStringPool::freeSymbolInternal(WASMSymbol Sym) {
   if ((reinterpret_cast<uintptr_t>(FreeEntry) & 1))
     return;
 
-  FreeEntry->RefCount--;
-  if (FreeEntry->RefCount > 0)
+  if (FreeEntry->RefCount.fetch_sub(1, std::memory_order_acq_rel) > 1)
     return;
 
   Hash = FreeEntry->Hash & (HashTableSize - 1);
@@ -364,8 +383,27 @@ void ConstStringPool::freeSymbolInternal(WASMSymbol Sym) {
 }
 
 void ConstStringPool::freeSymbol(WASMSymbol Sym) {
-  if (!isReserved(Sym))
-    freeSymbolInternal(Sym);
+  if (isReserved(Sym))
+    return;
+
+  // drop the reference without the exclusive lock unless it's the last one
+  {
+    SharedLock<SharedMutex> Lock(Mtx);
+    if (!EntriesArray || !StrHashTable)
+      return;
+    ConstStringEntry *Entry = EntriesArray[Sym];
+    if ((reinterpret_cast<uintptr_t>(Entry) & 1))
+      return;
+    int32_t RefCount = Entry->RefCount.load(std::memory_order_relaxed);
+    while (RefCount > 1) {
+      if (Entry->RefCount.compare_exchange_weak(RefCount, RefCount - 1,
+                                                std::memory_order_acq_rel))
+        return;
+    }
+  }
+
+  UniqueLock<SharedMutex> Lock(Mtx);
+  freeSymbolInternal(Sym);
 }
 
 bool ConstStringPool::resizeHashTbl(int32_t NewSize) {
@@ -398,6 +436,7 @@ bool ConstStringPool::resizeHashTbl(int32_t NewSize) {
   return true;
 }
 const char *ConstStringPool::dumpSymbolString(WASMSymbol Sym) {
+  SharedLock<SharedMutex> Lock(Mtx);
   if (!StrHashTable)
     return nullptr;
 
@@ -19,6 +19,10 @@ enum WasmConstStringIdent {
 
 struct ConstStringEntry;
 
+/// Interning table of symbols, shared by all modules of a runtime. Lookups and
+/// reference count updates of existing symbols only take the lock shared, so
+/// modules can be loaded from multiple threads concurrently. initPool and
+/// destroyPool must not race with other methods.
 class ConstStringPool {
   using MemPool = SysMemPool;
 
@@ -59,7 +63,9 @@ private:
   WASMSymbol newSymbolInit(const char *Str, size_t Len);
   WASMSymbol newSymbol(ConstStringEntry *Entry);
 
-  WASMSymbol findAndHoldSymbol(const char *Str, size_t Len);
+  // caller must hold the lock
+  WASMSymbol lookupSymbol(const char *Str, size_t Len, uint32_t Hash) const;
+  WASMSymbol findAndHoldSymbol(const char *Str, size_t Len, uint32_t Hash);
 
   void freeSymbolInternal(WASMSymbol Sym);
   bool resizeHashTbl(int32_t NewSize);
@@ -77,6 +83,9 @@ private:
   int32_t FreeIndex; /* 0 = none */
   int32_t RecycleIndex = 0;
 
+  // exclusive for inserting/removing symbols and resizing the tables
+  mutable SharedMutex Mtx;
+
   MemPool MPool;
 };
 
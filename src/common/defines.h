@@ -116,15 +116,24 @@ constexpr size_t PresetMaxSectionSize = 512 * 1024 * 1024; // 512MB
 constexpr size_t PresetMaxNameLength = UINT16_MAX;
 constexpr size_t PresetMaxNumParams = UINT16_MAX;     // uint16_t
 constexpr size_t PresetMaxNumParamCells = UINT16_MAX; // uint16_t
-// At most one return value in MVP
-constexpr size_t PresetMaxNumReturns = 1;                 // uint8_t: 2 bits
-constexpr size_t PresetMaxNumReturnCells = (1u << 6) - 1; // uint8_t: 6 bits
+constexpr size_t PresetMaxNumReturns = UINT16_MAX;     // uint16_t
+constexpr size_t PresetMaxNumReturnCells = UINT16_MAX; // uint16_t
 
 constexpr size_t PresetMaxMemoryPages = 1u << 16;                // 65536 pages
 constexpr size_t PresetMaxFunctionSize = 16 * 1024 * 1024;       // 16MB
 constexpr size_t PresetMaxTotalFunctionSize = 512 * 1024 * 1024; // 512MB
 constexpr size_t PresetMaxDataSegmentSize = 128 * 1024 * 1024;   // 128MB
 
+// gas charged by memory.init/copy/fill per started 32-byte word, on top of the
+// gas charged by the instrumented code for the instruction itself
+constexpr uint64_t BulkMemoryGasWordSize = 32;
+constexpr uint64_t BulkMemoryGasPerWord = 3;
+
+inline uint64_t getBulkMemoryGas(uint32_t Len) {
+  return (Len + BulkMemoryGasWordSize - 1) / BulkMemoryGasWordSize *
+         BulkMemoryGasPerWord;
+}
+
 } // namespace common
 
 } // namespace zen
@@ -46,6 +46,18 @@ enum Opcode {
 #undef DEFINE_WASM_OPCODE
 }; // Opcode
 
+enum FCOpcode : uint32_t {
+#define DEFINE_WASM_FC_OPCODE(NAME, OPCODE, TEXT) NAME = OPCODE,
+#include "common/wasm_defs/opcode.def"
+#undef DEFINE_WASM_FC_OPCODE
+}; // FCOpcode
+
+enum FDOpcode : uint32_t {
+#define DEFINE_WASM_FD_OPCODE(NAME, OPCODE, TEXT) NAME = OPCODE,
+#include "common/wasm_defs/opcode.def"
+#undef DEFINE_WASM_FD_OPCODE
+}; // FDOpcode
+
 enum LabelType {
   LABEL_BLOCK,
   LABEL_LOOP,
@@ -0,0 +1,387 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "common/mem_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+namespace zen::common {
+
+namespace {
+
+// every block is preceded by this header so that deallocate(Ptr) can find
+// the size class without a page map
+struct BlockHeader {
+  uint32_t SizeClass;
+  // distance from the start of the system allocation, only for large blocks
+  uint32_t Offset;
+  // usable size, only for large blocks
+  size_t Size;
+};
+static_assert(sizeof(BlockHeader) == ThreadCachingMemPool::BlockAlign,
+              "block header must keep the block aligned");
+
+constexpr uint32_t LargeSizeClass = UINT32_MAX;
+constexpr size_t HeaderSize = sizeof(BlockHeader);
+constexpr uint32_t NumTinyClasses = 16;
+constexpr size_t MaxTinySize = NumTinyClasses * 16;
+
+uint32_t getSizeClass(size_t Size) {
+  ZEN_ASSERT(Size > 0 && Size <= ThreadCachingMemPool::MaxSmallSize);
+  if (Size <= MaxTinySize) {
+    return static_cast<uint32_t>((Size + 15) / 16 - 1);
+  }
+  uint32_t SizeClass = NumTinyClasses;
+  for (size_t ClassSize = MaxTinySize * 2; ClassSize < Size; ClassSize *= 2) {
+    ++SizeClass;
+  }
+  return SizeClass;
+}
+
+size_t getClassSize(uint32_t SizeClass) {
+  if (SizeClass < NumTinyClasses) {
+    return (SizeClass + 1) * 16;
+  }
+  return MaxTinySize << (SizeClass - NumTinyClasses + 1);
+}
+
+// number of blocks moved between a thread cache and the central list at once
+size_t getBatchSize(uint32_t SizeClass) {
+  size_t NumBlocks = 4096 / getClassSize(SizeClass);
+  return std::clamp<size_t>(NumBlocks, 2, 32);
+}
+
+BlockHeader *getHeader(const void *Ptr) {
+  return reinterpret_cast<BlockHeader *>(
+      reinterpret_cast<uintptr_t>(Ptr) - HeaderSize);
+}
+
+// pools alive in the process, thread exit must not touch destroyed pools
+Mutex LivePoolsMtx;
+std::unordered_set<uint64_t> &getLivePools() {
+  static std::unordered_set<uint64_t> LivePools;
+  return LivePools;
+}
+
+std::atomic<uint64_t> NextPoolId{1};
+
+} // namespace
+
+struct ThreadCachingMemPool::ThreadCache {
+  FreeBlock *Heads[NumSizeClasses] = {};
+  size_t NumBlocks[NumSizeClasses] = {};
+#ifndef NDEBUG
+  // may become negative when blocks are freed by other threads
+  std::atomic<int64_t> NumAllocs{0};
+#endif
+};
+
+// the thread caches of the calling thread, returned to their pools at thread
+// exit so that the cached blocks can be reused by other threads
+struct ThreadCachingMemPool::ThreadCacheRegistry {
+  struct Entry {
+    uint64_t PoolId;
+    ThreadCachingMemPool *Pool;
+    ThreadCache *Cache;
+  };
+
+  // fast path for the most recently used pool
+  uint64_t LastPoolId = 0;
+  ThreadCache *LastCache = nullptr;
+  std::vector<Entry> Entries;
+
+  ~ThreadCacheRegistry() {
+    LockGuard<Mutex> Lock(LivePoolsMtx);
+    for (const Entry &E : Entries) {
+      if (getLivePools().count(E.PoolId)) {
+        E.Pool->releaseThreadCache(E.Cache);
+      }
+    }
+  }
+};
+
+thread_local ThreadCachingMemPool::ThreadCacheRegistry
+    ThreadCachingMemPool::Registry;
+
+ThreadCachingMemPool::MemPool() : PoolId(NextPoolId++) {
+  LockGuard<Mutex> Lock(LivePoolsMtx);
+  getLivePools().insert(PoolId);
+}
+
+ThreadCachingMemPool::~MemPool() {
+  {
+    // waits for exiting threads which are still returning their caches
+    LockGuard<Mutex> Lock(LivePoolsMtx);
+    getLivePools().erase(PoolId);
+  }
+  if (Registry.LastPoolId == PoolId) {
+    Registry.LastPoolId = 0;
+    Registry.LastCache = nullptr;
+  }
+#ifndef NDEBUG
+  ZEN_ASSERT(getNumAllocs() == 0);
+#endif
+  for (ThreadCache *Cache : ThreadCaches) {
+    delete Cache;
+  }
+  for (void *Chunk : Chunks) {
+    std::free(Chunk);
+  }
+}
+
+ThreadCachingMemPool::ThreadCache *ThreadCachingMemPool::getThreadCache() {
+  if (Registry.LastPoolId == PoolId) {
+    return Registry.LastCache;
+  }
+  ThreadCache *Cache = nullptr;
+  auto &Entries = Registry.Entries;
+  {
+    LockGuard<Mutex> Lock(LivePoolsMtx);
+    const auto &LivePools = getLivePools();
+    // drop the caches of destroyed pools, their ids are never reused
+    Entries.erase(std::remove_if(Entries.begin(), Entries.end(),
+                                 [&LivePools](const auto &E) {
+                                   return !LivePools.count(E.PoolId);
+                                 }),
+                  Entries.end());
+  }
+  for (const auto &E : Entries) {
+    if (E.PoolId == PoolId) {
+      Cache = E.Cache;
+      break;
+    }
+  }
+  if (!Cache) {
+    Cache = acquireThreadCache();
+    Entries.push_back({PoolId, this, Cache});
+  }
+  Registry.LastPoolId = PoolId;
+  Registry.LastCache = Cache;
+  return Cache;
+}
+
+ThreadCachingMemPool::ThreadCache *ThreadCachingMemPool::acquireThreadCache() {
+  LockGuard<Mutex> Lock(PoolMtx);
+  if (!IdleThreadCaches.empty()) {
+    ThreadCache *Cache = IdleThreadCaches.back();
+    IdleThreadCaches.pop_back();
+    return Cache;
+  }
+  auto *Cache = new ThreadCache;
+  ThreadCaches.push_back(Cache);
+  return Cache;
+}
+
+void ThreadCachingMemPool::releaseThreadCache(ThreadCache *Cache) {
+  for (uint32_t SizeClass = 0; SizeClass < NumSizeClasses; ++SizeClass) {
+    flush(Cache, SizeClass, Cache->NumBlocks[SizeClass]);
+  }
+  LockGuard<Mutex> Lock(PoolMtx);
+  IdleThreadCaches.push_back(Cache);
+}
+
+void ThreadCachingMemPool::refill(ThreadCache *Cache, uint32_t SizeClass) {
+  ZEN_ASSERT(!Cache->Heads[SizeClass]);
+  size_t BatchSize = getBatchSize(SizeClass);
+  CentralFreeList &Central = CentralLists[SizeClass];
+  {
+    LockGuard<Mutex> Lock(Central.Mtx);
+    if (Central.Head) {
+      FreeBlock *Head = Central.Head;
+      FreeBlock *Tail = Head;
+      size_t NumBlocks = 1;
+      while (NumBlocks < BatchSize && Tail->Next) {
+        Tail = Tail->Next;
+        ++NumBlocks;
+      }
+      Central.Head = Tail->Next;
+      Central.NumBlocks -= NumBlocks;
+      Tail->Next = nullptr;
+      Cache->Heads[SizeClass] = Head;
+      Cache->NumBlocks[SizeClass] = NumBlocks;
+      return;
+    }
+  }
+
+  // carve a new chunk, the blocks beyond one batch go to the central list
+  size_t SlotSize = HeaderSize + getClassSize(SizeClass);
+  size_t NumSlots = std::max<size_t>(ChunkSize / SlotSize, BatchSize);
+  auto *Chunk = static_cast<uint8_t *>(std::malloc(SlotSize * NumSlots));
+  if (!Chunk) {
+    ZEN_ABORT();
+  }
+  {
+    LockGuard<Mutex> Lock(PoolMtx);
+    Chunks.push_back(Chunk);
+  }
+  FreeBlock *Head = nullptr;
+  FreeBlock *Tail = nullptr;
+  for (size_t I = NumSlots; I > 0; --I) {
+    uint8_t *Slot = Chunk + (I - 1) * SlotSize;
+    auto *Header = reinterpret_cast<BlockHeader *>(Slot);
+    Header->SizeClass = SizeClass;
+    Header->Offset = 0;
+    Header->Size = 0;
+    auto *Block = reinterpret_cast<FreeBlock *>(Slot + HeaderSize);
+    Block->Next = Head;
+    Head = Block;
+    if (!Tail) {
+      Tail = Block;
+    }
+  }
+  Cache->Heads[SizeClass] = Head;
+  Cache->NumBlocks[SizeClass] = NumSlots;
+  if (NumSlots > BatchSize) {
+    FreeBlock *Last = Head;
+    for (size_t I = 1; I < BatchSize; ++I) {
+      Last = Last->Next;
+    }
+    LockGuard<Mutex> Lock(Central.Mtx);
+    Tail->Next = Central.Head;
+    Central.Head = Last->Next;
+    Central.NumBlocks += NumSlots - BatchSize;
+    Last->Next = nullptr;
+    Cache->NumBlocks[SizeClass] = BatchSize;
+  }
+}
+
+void ThreadCachingMemPool::flush(ThreadCache *Cache, uint32_t SizeClass,
+                                 size_t NumBlocks) {
+  if (NumBlocks == 0) {
+    return;
+  }
+  ZEN_ASSERT(NumBlocks <= Cache->NumBlocks[SizeClass]);
+  FreeBlock *Head = Cache->Heads[SizeClass];
+  FreeBlock *Tail = Head;
+  for (size_t I = 1; I < NumBlocks; ++I) {
+    Tail = Tail->Next;
+  }
+  Cache->Heads[SizeClass] = Tail->Next;
+  Cache->NumBlocks[SizeClass] -= NumBlocks;
+
+  CentralFreeList &Central = CentralLists[SizeClass];
+  LockGuard<Mutex> Lock(Central.Mtx);
+  Tail->Next = Central.Head;
+  Central.Head = Head;
+  Central.NumBlocks += NumBlocks;
+}
+
+void *ThreadCachingMemPool::allocateLarge(size_t Size, size_t Align) {
+  Align = std::max(Align, BlockAlign);
+  size_t Padding = Align - BlockAlign;
+  auto *Raw = static_cast<uint8_t *>(std::malloc(HeaderSize + Padding + Size));
+  if (!Raw) {
+    ZEN_ABORT();
+    return nullptr;
+  }
+  uint8_t *Ptr = reinterpret_cast<uint8_t *>(
+      ZEN_ALIGN(reinterpret_cast<uintptr_t>(Raw + HeaderSize), Align));
+  BlockHeader *Header = getHeader(Ptr);
+  Header->SizeClass = LargeSizeClass;
+  Header->Offset = static_cast<uint32_t>(Ptr - Raw);
+  Header->Size = Size;
+  return Ptr;
+}
+
+void *ThreadCachingMemPool::allocate(size_t Size, size_t Align,
+                                     const char *) {
+  if (!Size) {
+    return nullptr;
+  }
+  ThreadCache *Cache = getThreadCache();
+#ifndef NDEBUG
+  Cache->NumAllocs.fetch_add(1, std::memory_order_relaxed);
+#endif
+  if (Size > MaxSmallSize || Align > BlockAlign) {
+    return allocateLarge(Size, Align);
+  }
+  uint32_t SizeClass = getSizeClass(Size);
+  if (!Cache->Heads[SizeClass]) {
+    refill(Cache, SizeClass);
+  }
+  FreeBlock *Block = Cache->Heads[SizeClass];
+  Cache->Heads[SizeClass] = Block->Next;
+  --Cache->NumBlocks[SizeClass];
+  return Block;
+}
+
+void ThreadCachingMemPool::deallocate(void *Ptr) {
+  if (!Ptr) {
+    return;
+  }
+  ThreadCache *Cache = getThreadCache();
+#ifndef NDEBUG
+  Cache->NumAllocs.fetch_sub(1, std::memory_order_relaxed);
+#endif
+  BlockHeader *Header = getHeader(Ptr);
+  uint32_t SizeClass = Header->SizeClass;
+  if (SizeClass == LargeSizeClass) {
+    std::free(static_cast<uint8_t *>(Ptr) - Header->Offset);
+    return;
+  }
+  ZEN_ASSERT(SizeClass < NumSizeClasses);
+  auto *Block = static_cast<FreeBlock *>(Ptr);
+  Block->Next = Cache->Heads[SizeClass];
+  Cache->Heads[SizeClass] = Block;
+  // keep at most two batches per thread, the rest can be used by others
+  size_t BatchSize = getBatchSize(SizeClass);
+  if (++Cache->NumBlocks[SizeClass] > 2 * BatchSize) {
+    flush(Cache, SizeClass, BatchSize);
+  }
+}
+
+void *ThreadCachingMemPool::reallocate(void *OldPtr, size_t, size_t NewSize) {
+  if (!OldPtr) {
+    return allocate(NewSize);
+  }
+  if (!NewSize) {
+    deallocate(OldPtr);
+    return nullptr;
+  }
+  BlockHeader *Header = getHeader(OldPtr);
+  size_t OldUsableSize = getUsableSize(OldPtr);
+  if (Header->SizeClass == LargeSizeClass) {
+    if (Header->Offset == HeaderSize && NewSize > MaxSmallSize) {
+      auto *Raw = static_cast<uint8_t *>(
+          std::realloc(reinterpret_cast<uint8_t *>(Header),
+                       HeaderSize + NewSize));
+      if (!Raw) {
+        ZEN_ABORT();
+        return nullptr;
+      }
+      reinterpret_cast<BlockHeader *>(Raw)->Size = NewSize;
+      return Raw + HeaderSize;
+    }
+  } else if (NewSize <= OldUsableSize &&
+             getSizeClass(NewSize) == Header->SizeClass) {
+    return OldPtr;
+  }
+  void *NewPtr = allocate(NewSize);
+  std::memcpy(NewPtr, OldPtr, std::min(OldUsableSize, NewSize));
+  deallocate(OldPtr);
+  return NewPtr;
+}
+
+size_t ThreadCachingMemPool::getUsableSize(const void *Ptr) {
+  const BlockHeader *Header = getHeader(Ptr);
+  if (Header->SizeClass == LargeSizeClass) {
+    return Header->Size;
+  }
+  return getClassSize(Header->SizeClass);
+}
+
+#ifndef NDEBUG
+size_t ThreadCachingMemPool::getNumAllocs() const {
+  int64_t NumAllocs = 0;
+  LockGuard<Mutex> Lock(PoolMtx);
+  for (const ThreadCache *Cache : ThreadCaches) {
+    NumAllocs += Cache->NumAllocs.load(std::memory_order_relaxed);
+  }
+  return static_cast<size_t>(NumAllocs);
+}
+#endif
+
+} // namespace zen::common
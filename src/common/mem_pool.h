@@ -7,6 +7,7 @@
 #include "common/defines.h"
 #include "common/errors.h"
 #include "platform/map.h"
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -32,6 +33,7 @@ enum MemPoolKind {
   ALLOC_ONLY_POOL,        // allocate only pool
   STAGED_ALLOC_ONLY_POOL, // allocate only pool with push/pop
   CODE_POOL,              // for code cache, thread safe
+  THREAD_CACHING_POOL,    // size-class arena with per-thread caches
 };
 
 template <MemPoolKind kind> class MemPool {
@@ -206,6 +208,102 @@ private:
 
 using SysMemPool = MemPool<SYS_POOL>;
 
+/// Size-class arena which caches freed blocks per thread, so that concurrent
+/// module loading and instantiation neither contend on the system allocator
+/// nor fragment the heap. Small blocks are carved from chunks owned by the
+/// pool, only large or over-aligned blocks go to the system allocator. Blocks
+/// may be freed by any thread, all memory is released with the pool.
+template <> class MemPool<THREAD_CACHING_POOL> {
+public:
+  MemPool();
+  ~MemPool();
+
+  NONCOPYABLE(MemPool);
+
+  void *allocate(size_t Size, size_t Align = 0,
+                 [[maybe_unused]] const char *TypeName = nullptr);
+
+  void *allocateZeros(size_t Size, size_t Align = 0,
+                      const char *TypeName = nullptr) {
+    void *Ptr = allocate(Size, Align, TypeName);
+    if (Ptr) {
+      std::memset(Ptr, 0, Size);
+    }
+    return Ptr;
+  }
+
+  void deallocate(void *Ptr);
+
+  void deallocate(void *Ptr, [[maybe_unused]] size_t Size) {
+    ZEN_ASSERT(!Ptr || Size <= getUsableSize(Ptr));
+    deallocate(Ptr);
+  }
+
+  void *reallocate(void *OldPtr, size_t OldSize, size_t NewSize);
+
+  void push() {}
+  void pop() {}
+
+  /// \return the number of bytes usable in the block \p Ptr
+  static size_t getUsableSize(const void *Ptr);
+
+#ifndef NDEBUG
+  size_t getNumAllocs() const;
+#endif
+
+  template <typename T, typename... Arguments>
+  T *newObject(Arguments &&...Args) {
+    void *Ptr = allocate(sizeof(T), alignof(T));
+    Ptr = new (Ptr) T(std::forward<Arguments>(Args)...);
+    return static_cast<T *>(Ptr);
+  }
+
+  template <typename T> void deleteObject(T *Ptr) {
+    Ptr->~T();
+    deallocate(Ptr);
+  }
+
+  // 16-byte steps up to 256 bytes, then powers of two up to 32KB
+  static constexpr size_t NumSizeClasses = 23;
+  static constexpr size_t MaxSmallSize = 32 * 1024;
+  static constexpr size_t ChunkSize = 64 * 1024;
+  static constexpr size_t BlockAlign = 16;
+
+private:
+  struct FreeBlock {
+    FreeBlock *Next;
+  };
+
+  struct CentralFreeList {
+    Mutex Mtx;
+    FreeBlock *Head = nullptr;
+    size_t NumBlocks = 0;
+  };
+
+  struct ThreadCache;
+  struct ThreadCacheRegistry;
+
+  ThreadCache *getThreadCache();
+  ThreadCache *acquireThreadCache();
+  void releaseThreadCache(ThreadCache *Cache);
+  void refill(ThreadCache *Cache, uint32_t SizeClass);
+  void flush(ThreadCache *Cache, uint32_t SizeClass, size_t NumBlocks);
+  void *allocateLarge(size_t Size, size_t Align);
+
+  static thread_local ThreadCacheRegistry Registry;
+
+  const uint64_t PoolId;
+  CentralFreeList CentralLists[NumSizeClasses];
+  // chunks and thread caches are only released with the pool, caches of
+  // exited threads are handed to new threads
+  mutable Mutex PoolMtx;
+  std::vector<void *> Chunks;
+  std::vector<ThreadCache *> ThreadCaches;
+  std::vector<ThreadCache *> IdleThreadCaches;
+};
+
+using ThreadCachingMemPool = MemPool<THREAD_CACHING_POOL>;
+
 #ifndef ZEN_ENABLE_SGX
 template <> class MemPool<CODE_POOL> {
 public:
@@ -294,25 +392,95 @@ private:
 
 using CodeMemPool = MemPool<CODE_POOL>;
 
+/// Bump allocator for data which lives as long as the pool. deallocate is a
+/// no-op, all blocks are released together when the pool is destroyed.
+/// \warning not thread-safe
 template <> class MemPool<ALLOC_ONLY_POOL> {
 private:
   struct Block {
     Block *Prev;
-    Block *Next;
     uint8_t *Avail;
     uint8_t *Ceil;
   };
 
-#if 0 // unused yet
-    Block *BLK;
-    uint32_t BlockSize;
-    uint32_t Level;
-#endif
-
 public:
-  MemPool(uint32_t BlockSize) {}
+  explicit MemPool(size_t BlockSize = DefaultBlockSize)
+      : NextBlockSize(BlockSize) {}
+
+  ~MemPool() {
+    while (Current) {
+      Block *Prev = Current->Prev;
+      std::free(Current);
+      Current = Prev;
+    }
+  }
+
+  NONCOPYABLE(MemPool);
+
+  /// Make sure the next \p Size bytes are allocated from one block, so that
+  /// data allocated together is also laid out together
+  void reserve(size_t Size) {
+    if (!Current || size_t(Current->Ceil - Current->Avail) < Size) {
+      newBlock(Size);
+    }
+  }
+
+  void *allocate(size_t Size, [[maybe_unused]] size_t Align = DefaultAlign) {
+    if (!Size) {
+      return nullptr;
+    }
+    // every allocation keeps the default alignment
+    ZEN_ASSERT(Align <= DefaultAlign);
+    size_t AlignedSize = ZEN_ALIGN(Size, DefaultAlign);
+    reserve(AlignedSize);
+    uint8_t *Ptr = Current->Avail;
+    Current->Avail += AlignedSize;
+    AllocSize += AlignedSize;
+    return Ptr;
+  }
+
+  void *allocateZeros(size_t Size, size_t Align = DefaultAlign) {
+    void *Ptr = allocate(Size, Align);
+    if (Ptr) {
+      std::memset(Ptr, 0, Size);
+    }
+    return Ptr;
+  }
+
+  void deallocate(void *, size_t = 0) {}
+
+  size_t getAllocSize() const { return AllocSize; }
+  size_t getReservedSize() const { return ReservedSize; }
+
+  static constexpr size_t DefaultBlockSize = 4096;
+  static constexpr size_t MaxBlockSize = 1024 * 1024;
+  static constexpr size_t DefaultAlign = 16;
+
+private:
+  void newBlock(size_t MinSize) {
+    size_t HeaderSize = ZEN_ALIGN(sizeof(Block), DefaultAlign);
+    size_t Size =
+        std::max(NextBlockSize, HeaderSize + ZEN_ALIGN(MinSize, DefaultAlign));
+    auto *Blk = static_cast<Block *>(std::malloc(Size));
+    if (!Blk) {
+      ZEN_ABORT();
+    }
+    Blk->Prev = Current;
+    Blk->Avail = reinterpret_cast<uint8_t *>(Blk) + HeaderSize;
+    Blk->Ceil = reinterpret_cast<uint8_t *>(Blk) + Size;
+    Current = Blk;
+    ReservedSize += Size;
+    NextBlockSize = std::min(NextBlockSize * 2, MaxBlockSize);
+  }
+
+  Block *Current = nullptr;
+  size_t NextBlockSize;
+  size_t AllocSize = 0;
+  size_t ReservedSize = 0;
 };
 
+using AllocOnlyMemPool = MemPool<ALLOC_ONLY_POOL>;
+
 template <typename MemPoolType> class Destroyer {
 public:
   Destroyer(MemPoolType &MPool) : MPool(MPool) {}
@@ -5,6 +5,7 @@
 #define ZEN_COMMON_THREAD_POOL_H
 
 #include "common/defines.h"
+#include "platform/numa.h"
 #include <condition_variable>
 #include <functional>
 #include <memory>
@@ -26,6 +27,7 @@ public:
     Contexts = std::make_unique<ThreadContext *[]>(ThreadCount);
     TailTasks =
         std::make_unique<std::function<void(ThreadContext *)>[]>(ThreadCount);
+    createNumaNodeHints();
     createThreads();
   }
 
@@ -45,6 +47,19 @@ public:
     }
   }
 
+  // Affinity hint, the worker moves to the cpus of NumaNode before running its
+  // next task
+  void setThreadNumaNode(ConcurrencyT ThreadId, uint32_t NumaNode) {
+    ZEN_ASSERT(ThreadId < ThreadCount);
+    NumaNodeHints[ThreadId] = static_cast<int32_t>(NumaNode);
+  }
+
+  void setAllThreadsNumaNode(uint32_t NumaNode) {
+    for (ConcurrencyT I = 0; I < ThreadCount; ++I) {
+      setThreadNumaNode(I, NumaNode);
+    }
+  }
+
   size_t getTasksQueued() const {
     const std::scoped_lock TasksLock(TasksMutex);
     return Tasks.size();
@@ -76,6 +91,7 @@ public:
     ThreadCount = determineThreadCount(TC);
     Threads = std::make_unique<std::thread[]>(ThreadCount);
     NoNewTask = false;
+    createNumaNodeHints();
     createThreads();
   }
 
@@ -98,6 +114,7 @@ private:
     Running = true;
     for (ConcurrencyT I = 0; I < ThreadCount; ++I) {
       Threads[I] = std::thread([I, this] {
+        int32_t CurNumaNode = -1;
         while (Running) {
           std::function<void(ThreadContext *)> Task;
           std::unique_lock<std::mutex> TasksLock(TasksMutex);
@@ -115,6 +132,11 @@ private:
             Task = std::move(Tasks.front());
             Tasks.pop();
             TasksLock.unlock();
+            int32_t NumaNodeHint = NumaNodeHints[I];
+            if (NumaNodeHint >= 0 && NumaNodeHint != CurNumaNode) {
+              platform::setCurrentThreadNumaNode(NumaNodeHint);
+              CurNumaNode = NumaNodeHint;
+            }
             Task(Ctx);
             TasksLock.lock();
             --TasksTotal;
@@ -137,6 +159,13 @@ private:
     }
   }
 
+  void createNumaNodeHints() {
+    NumaNodeHints = std::make_unique<std::atomic<int32_t>[]>(ThreadCount);
+    for (ConcurrencyT I = 0; I < ThreadCount; ++I) {
+      NumaNodeHints[I] = -1;
+    }
+  }
+
   void destroyThreads() {
     if (!Running) {
       return;
@@ -185,6 +214,8 @@ private:
   std::unique_ptr<std::thread[]> Threads = nullptr;
   std::unique_ptr<ThreadContext *[]> Contexts = nullptr;
   std::unique_ptr<std::function<void(ThreadContext *)>[]> TailTasks = nullptr;
+  // -1 means no affinity hint
+  std::unique_ptr<std::atomic<int32_t>[]> NumaNodeHints = nullptr;
 };
 
 } // namespace zen::common
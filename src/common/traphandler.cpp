@@ -24,7 +24,7 @@ void CallThreadState::setJITTraces() {
   }
   uint32_t IgnoredDepth = getTrapState().NumIgnoredFrames;
   ZEN_ASSERT(Inst);
-  void *JITCode = Inst->getModule()->getJITCode();
+  void *JITCode = const_cast<void *>(Inst->getJITCode());
   void *JITCodeEnd =
       static_cast<uint8_t *>(JITCode) + Inst->getModule()->getJITCodeSize();
   Traces = utils::createBacktraceUntil(FrameAddr, PC, StartAddr, IgnoredDepth,
@@ -0,0 +1,79 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#ifndef ZEN_COMPILER_ADAPTIVE_RA_H
+#define ZEN_COMPILER_ADAPTIVE_RA_H
+
+#include "common/defines.h"
+#include "runtime/function_profile.h"
+#include "runtime/module.h"
+
+// The register allocator selection of
+// RuntimeConfig::EnableMultipassAdaptiveRA. It only depends on the function
+// profile and the shape of the function, so it is kept apart from the CgIR
+// passes which compute the shape.
+
+namespace COMPILER {
+
+enum class FunctionHotness : uint8_t {
+  Unknown, // no execution profile
+  Cold,    // ran fewer times than the hot threshold, or never
+  Hot,
+};
+
+// A function without loops and with more instructions than this runs each of
+// them once per call, too few for greedy allocation to pay off unless it is
+// known hot
+static constexpr uint32_t AdaptiveRAStraightLineInstrs = 4096;
+// the greedy budget of hot functions and of functions with loops is scaled
+// by this, their allocation quality matters more than compile time
+static constexpr uint64_t AdaptiveRABudgetScale = 4;
+// calls plus loop iterations making a profiled function hot
+static constexpr uint64_t AdaptiveRAHotThreshold = 10000;
+
+inline FunctionHotness
+getFunctionHotness(const zen::runtime::FunctionCounters &Counters) {
+  return Counters.Calls + Counters.LoopIterations >= AdaptiveRAHotThreshold
+             ? FunctionHotness::Hot
+             : FunctionHotness::Cold;
+}
+
+/// \param FuncIdx internal function index
+inline FunctionHotness getFunctionHotness(const zen::runtime::Module &Mod,
+                                          uint32_t FuncIdx) {
+  zen::runtime::FunctionCounters Counters;
+  if (!Mod.isFunctionProfilingEnabled() ||
+      !Mod.getFunctionCounters(FuncIdx, Counters)) {
+    return FunctionHotness::Unknown;
+  }
+  return getFunctionHotness(Counters);
+}
+
+/// \param GreedyRABudget see RuntimeConfig::MultipassGreedyRABudget, 0 means
+/// unlimited
+/// \param HasLoops, NumInstrs the shape of the function in CgIR, only used
+/// when \p Hotness is unknown
+/// \return the greedy budget of the function, or 0 for fast allocation
+inline uint64_t getAdaptiveGreedyRABudget(uint64_t GreedyRABudget,
+                                          FunctionHotness Hotness,
+                                          bool HasLoops, size_t NumInstrs) {
+  uint64_t Budget = GreedyRABudget == 0 ? UINT64_MAX : GreedyRABudget;
+  uint64_t ScaledBudget = Budget > UINT64_MAX / AdaptiveRABudgetScale
+                              ? UINT64_MAX
+                              : Budget * AdaptiveRABudgetScale;
+  switch (Hotness) {
+  case FunctionHotness::Cold:
+    return 0;
+  case FunctionHotness::Hot:
+    return ScaledBudget;
+  default:
+    break;
+  }
+  if (HasLoops) {
+    return ScaledBudget;
+  }
+  return NumInstrs > AdaptiveRAStraightLineInstrs ? 0 : Budget;
+}
+
+} // namespace COMPILER
+
+#endif // ZEN_COMPILER_ADAPTIVE_RA_H
@@ -144,16 +144,15 @@ protected:
   }
 
   void lowerReturnStmt(const ReturnInstruction &Inst) {
-    const MInstruction *Operand = nullptr;
-    MVT VT = getMVT(*Inst.getType());
-    CgRegister OperandReg;
-
-    if (Inst.getNumOperands() != 0) {
-      Operand = Inst.getOperand<0>();
-      OperandReg = lowerExpr(*Operand);
+    SmallVector<MVT, 2> VTs;
+    SmallVector<CgRegister, 2> OperandRegs;
+    for (uint32_t I = 0; I < Inst.getNumOperands(); ++I) {
+      const MInstruction *Operand = Inst.getOperand(I);
+      VTs.push_back(getMVT(*Operand->getType()));
+      OperandRegs.push_back(lowerExpr(*Operand));
     }
 
-    SELF.lowerReturnStmt(VT, OperandReg);
+    SELF.lowerReturnStmt(VTs, OperandRegs);
   }
 
   CgRegister lowerExpr(const MInstruction &Inst) {
@@ -179,6 +178,9 @@ protected:
       ResultReg = SELF.lowerWasmOverflowI128BinaryExpr(
           llvm::cast<WasmOverflowI128BinaryInstruction>(Inst));
       break;
+    case MInstruction::SIMD:
+      ResultReg = SELF.lowerWasmSIMDExpr(llvm::cast<WasmSIMDInstruction>(Inst));
+      break;
     case MInstruction::CMP:
       ResultReg = SELF.lowerCmpExpr(llvm::cast<CmpInstruction>(Inst));
       break;
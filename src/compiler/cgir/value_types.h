@@ -22,6 +22,9 @@ static inline llvm::MVT getMVT(const MType &type) {
     return llvm::MVT::f32;
   case MType::F64:
     return llvm::MVT::f64;
+  case MType::V128:
+    // lane shapes are decided per operation, values live in VR128
+    return llvm::MVT::v2i64;
   case MType::VOID:
     return llvm::MVT::isVoid;
   case MType::POINTER_TYPE:
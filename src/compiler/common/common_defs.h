@@ -136,6 +136,9 @@ public:
 #endif
   }
 
+  // bytes requested so far, deallocations aside
+  size_t getBytesAllocated() const { return AllocImpl.getBytesAllocated(); }
+
   template <typename T, typename... Arguments>
   T *newObject(Arguments &&...Args) {
     void *Ptr = allocate(sizeof(T), alignof(T));
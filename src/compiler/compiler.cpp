@@ -4,6 +4,8 @@
 #include "compiler/compiler.h"
 #include "common/thread_pool.h"
 #include "compiler/cgir/cg_function.h"
+#include "compiler/cgir/pass/cg_dominators.h"
+#include "compiler/cgir/pass/cg_loop_info.h"
 #include "compiler/cgir/pass/dead_cg_instruction_elim.h"
 #include "compiler/cgir/pass/expand_post_ra_pseudos.h"
 #include "compiler/cgir/pass/fast_ra.h"
@@ -24,7 +26,11 @@
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/SmallVectorMemoryBuffer.h"
+#include "utils/metrics.h"
+#include "utils/statistics.h"
+#include <cinttypes>
 #include <deque>
+#include <optional>
 
 #ifdef ZEN_ENABLE_MULTIPASS_JIT_LOGGING
 #include "utils/asm_dump.h"
@@ -53,9 +59,80 @@ static inline bool isFuncNeedGreedyRA(uint32_t FuncIdx) {
 }
 #endif // ZEN_ENABLE_DEBUG_GREEDY_RA
 
+namespace COMPILER {
+
+// Charges the time and the compilation memory spent since the previous call
+// of finishPass() to a pass of the function being compiled
+class CompilePassRecorder : public NonCopyable {
+public:
+  CompilePassRecorder(utils::Statistics &Stats, const CompileMemPool &MemPool,
+                      uint32_t FuncIdx)
+      : Stats(Stats), MemPool(MemPool), LastTime(common::SteadyClock::now()),
+        LastMemoryUsage(MemPool.getBytesAllocated()) {
+    Record.FuncIdx = FuncIdx;
+  }
+
+  void finishPass(utils::CompilePass Pass) {
+    auto Now = common::SteadyClock::now();
+    size_t MemoryUsage = MemPool.getBytesAllocated();
+    uint32_t PassIdx = common::to_underlying(Pass);
+    Record.TimeCosts[PassIdx] +=
+        common::chrono::duration<float, std::milli>(Now - LastTime).count();
+    Record.MemoryUsages[PassIdx] += MemoryUsage - LastMemoryUsage;
+    LastTime = Now;
+    LastMemoryUsage = MemoryUsage;
+  }
+
+  void finish() { Stats.recordFunctionCompilation(Record); }
+
+private:
+  utils::Statistics &Stats;
+  const CompileMemPool &MemPool;
+  common::SteadyClock::time_point LastTime;
+  size_t LastMemoryUsage;
+  utils::FunctionCompileRecord Record;
+};
+
+} // namespace COMPILER
+
+// Every virtual register may be live in every block, so their product bounds
+// the live interval segments the greedy register allocator works on
+static uint64_t estimateGreedyRAComplexity(const CgFunction &MF) {
+  return uint64_t(MF.getRegInfo().getNumVirtRegs()) * MF.size();
+}
+
+/// Adaptive register allocator selection for \p MF. Fills \p DomTree and
+/// \p Loops when the loops are needed, so that greedy allocation can reuse
+/// them.
+/// \return the greedy budget of \p MF, or 0 for fast allocation
+static uint64_t selectAdaptiveGreedyRABudget(
+    CgFunction &MF, std::optional<CgDominatorTree> &DomTree,
+    std::optional<CgLoopInfo> &Loops) {
+  const CompileContext &Ctx = MF.getContext();
+  bool HasLoops = false;
+  size_t NumInstrs = 0;
+  // the shape only matters for functions without profile
+  if (Ctx.CurFuncHotness == FunctionHotness::Unknown) {
+    DomTree.emplace(MF);
+    Loops.emplace(MF);
+    HasLoops = !Loops->empty();
+    for (const CgBasicBlock *MBB : MF) {
+      NumInstrs += std::distance(MBB->begin(), MBB->end());
+    }
+  }
+  return getAdaptiveGreedyRABudget(Ctx.GreedyRABudget, Ctx.CurFuncHotness,
+                                   HasLoops, NumInstrs);
+}
+
 void JITCompilerBase::compileMIRToCgIR(MModule &MMod, MFunction &MFunc,
-                                       CgFunction &CgFunc,
-                                       bool DisableGreedyRA) {
+                                       CgFunction &CgFunc, bool DisableGreedyRA,
+                                       CompilePassRecorder *Recorder) {
+  auto FinishPass = [Recorder](utils::CompilePass Pass) {
+    if (Recorder) {
+      Recorder->finishPass(Pass);
+    }
+  };
+
 #ifdef ZEN_ENABLE_MULTIPASS_JIT_LOGGING
   llvm::DebugFlag = true;
   llvm::dbgs() << "\n########## MIR Dump ##########\n\n";
@@ -66,18 +143,44 @@ void JITCompilerBase::compileMIRToCgIR(MModule &MMod, MFunction &MFunc,
   if (!Verifier.verify()) {
     throw getError(ErrorCode::MIRVerifyingFailed);
   }
+  FinishPass(utils::CompilePass::MIRVerify);
 
   DeadMBasicBlockElim MBBDCE;
   MBBDCE.runOnMFunction(MFunc);
+  FinishPass(utils::CompilePass::DeadBlockElim);
 
   CgFunction &MF = CgFunc;
 
   // TODO: refactor to pass
   X86CgLowering CgLowering(MF);
   X86CgPeephole CgPeephole(MF);
+  FinishPass(utils::CompilePass::CgLowering);
 
   uint32_t MFuncIdx = MFunc.getFuncIdx();
 
+  // the adaptive selection may compute them before greedy allocation
+  std::optional<CgDominatorTree> DomTree;
+  std::optional<CgLoopInfo> Loops;
+  uint64_t GreedyRABudget = MF.getContext().GreedyRABudget;
+  if (!DisableGreedyRA && MF.getContext().AdaptiveRA) {
+    GreedyRABudget = selectAdaptiveGreedyRABudget(MF, DomTree, Loops);
+    if (GreedyRABudget == 0) {
+      ZEN_LOG_DEBUG("adaptive ra selects fast ra for function %d", MFuncIdx);
+      utils::Metrics::addCounter(utils::MetricCounter::AdaptiveFastRA);
+      DisableGreedyRA = true;
+    }
+  }
+  if (!DisableGreedyRA && GreedyRABudget > 0) {
+    uint64_t Complexity = estimateGreedyRAComplexity(MF);
+    if (Complexity > GreedyRABudget) {
+      ZEN_LOG_DEBUG("function %d exceeds the greedy ra budget (%" PRIu64
+                    " > %" PRIu64 ")",
+                    MFuncIdx, Complexity, GreedyRABudget);
+      utils::Metrics::addCounter(utils::MetricCounter::GreedyRAFallbacks);
+      DisableGreedyRA = true;
+    }
+  }
+
   if (DisableGreedyRA) {
     ZEN_LOG_DEBUG("using fast ra for function %d", MFuncIdx);
     FastRA RA(MF);
@@ -90,14 +193,18 @@ void JITCompilerBase::compileMIRToCgIR(MModule &MMod, MFunction &MFunc,
 #endif // ZEN_ENABLE_DEBUG_GREEDY_RA
       ZEN_LOG_DEBUG("using greedy ra for function %d", MFuncIdx);
       CgDeadCgInstructionElim DCE(MF);
-      CgDominatorTree DomTree(MF);
-      CgLoopInfo Loops(MF);
+      if (!Loops) {
+        DomTree.emplace(MF);
+        Loops.emplace(MF);
+      }
       CgSlotIndexes Indexes(MF);
       CgLiveIntervals LIS(MF);
       CgLiveStacks LSS(MF);
       CgBlockFrequencyInfo MBFI(MF);
+      FinishPass(utils::CompilePass::LiveIntervals);
       // CgRegisterCoalescer must before CgVirtRegMap
       CgRegisterCoalescer Coalescer(MF);
+      FinishPass(utils::CompilePass::RegisterCoalescing);
       CgVirtRegMap VRM(MF);
       CgLiveRegMatrix Matrix(MF);
       // RABasic ra(MF);
@@ -113,6 +220,8 @@ void JITCompilerBase::compileMIRToCgIR(MModule &MMod, MFunction &MFunc,
     }
 #endif // ZEN_ENABLE_DEBUG_GREEDY_RA
   }
+  // the analyses are released with the allocator, charge them to it
+  FinishPass(utils::CompilePass::RegAlloc);
 
 #ifdef ZEN_ENABLE_MULTIPASS_JIT_LOGGING
   llvm::dbgs() << "\n########## CgIR Dump After Register Allocation "
@@ -139,6 +248,7 @@ void JITCompilerBase::compileMIRToCgIR(MModule &MMod, MFunction &MFunc,
   if (MF.EvictAdvisor) {
     MF.EvictAdvisor.reset();
   }
+  FinishPass(utils::CompilePass::PrologEpilog);
 }
 
 void JITCompilerBase::emitObjectBuffer(CompileContext *Ctx) {
@@ -325,6 +435,48 @@ void JITCompilerBase::emitObjectBuffer(CompileContext *Ctx) {
   std::memcpy(Ctx->CodePtr, CodeOrErr->data(), Ctx->CodeSize);
 }
 
+// the stack bytes of the arguments of Type after the instance, with the
+// register assignment of X86CgLowering::lowerCall
+static uint32_t getArgStackSize(const runtime::TypeEntry &Type) {
+  constexpr uint32_t NumGPRArgs = 6;
+  constexpr uint32_t NumXMMArgs = 8;
+  uint32_t NumGPRs = 1;
+  uint32_t NumXMMs = 0;
+  uint32_t NumStackSlots = 0;
+  const common::WASMType *ParamTypes = Type.getParamTypes();
+  for (uint32_t I = 0; I < Type.NumParams; ++I) {
+    switch (ParamTypes[I]) {
+    case common::WASMType::F32:
+    case common::WASMType::F64:
+      NumStackSlots += NumXMMs++ >= NumXMMArgs;
+      break;
+    case common::WASMType::V128:
+      NumStackSlots += NumXMMs++ >= NumXMMArgs ? 2 : 0;
+      break;
+    default:
+      NumStackSlots += NumGPRs++ >= NumGPRArgs;
+      break;
+    }
+  }
+  return NumStackSlots * 8;
+}
+
+bool WasmJITCompiler::canCompileTailCalls(const runtime::Module &Mod) {
+  const runtime::Module::TailCallInfo &TailCalls = Mod.getTailCalls();
+  // a host function in a table would return past the exception check
+  if (TailCalls.HasIndirect && Mod.hasImportElems()) {
+    return false;
+  }
+  // the stack arguments of a callee are stored over the ones of its caller,
+  // whose caller only reserved those
+  for (const auto &[CallerType, CalleeType] : TailCalls.TypePairs) {
+    if (getArgStackSize(*CalleeType) > getArgStackSize(*CallerType)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void WasmJITCompiler::compileWasmToMC(WasmFrontendContext &Ctx, MModule &Mod,
                                       uint32_t FuncIdx, bool DisableGreedyRA) {
   if (Ctx.Inited) {
@@ -343,6 +495,15 @@ void WasmJITCompiler::compileWasmToMC(WasmFrontendContext &Ctx, MModule &Mod,
   CodeEntry *FuncCode = WasmMod->getCodeEntry(RealFuncIdx);
   ZEN_ASSERT(FuncCode);
   Ctx.setCurFunc(FuncIdx, FuncType, FuncCode);
+  if (Ctx.AdaptiveRA) {
+    Ctx.CurFuncHotness = getFunctionHotness(*WasmMod, FuncIdx);
+  }
+
+  std::optional<CompilePassRecorder> Recorder;
+  if (Stats.isEnabled()) {
+    Recorder.emplace(Stats, Ctx.MemPool, FuncIdx);
+  }
+
   MFunction MFunc(Ctx, FuncIdx);
   CgFunction CgFunc(Ctx, MFunc);
   MFunc.setFunctionType(Mod.getFuncType(FuncIdx));
@@ -350,12 +511,22 @@ void WasmJITCompiler::compileWasmToMC(WasmFrontendContext &Ctx, MModule &Mod,
   MIRBuilder.compile(&Ctx); // pass the ctx argument only for compatibility
   runtime::Runtime *RT = WasmMod->getRuntime();
   const runtime::RuntimeConfig &Config = RT->getConfig();
-  compileMIRToCgIR(Mod, MFunc, CgFunc, DisableGreedyRA);
+  if (Recorder) {
+    Recorder->finishPass(utils::CompilePass::MIRBuild);
+  }
+  compileMIRToCgIR(Mod, MFunc, CgFunc, DisableGreedyRA,
+                   Recorder ? &*Recorder : nullptr);
   Ctx.getMCLowering().runOnCgFunction(CgFunc);
+  if (Recorder) {
+    Recorder->finishPass(utils::CompilePass::MCEmission);
+    Recorder->finish();
+  }
 }
 
 void EagerJITCompiler::compile() {
   auto Timer = Stats.startRecord(zen::utils::StatisticPhase::JITCompilation);
+  zen::utils::ScopedMetricTimer MetricTimer(
+      zen::utils::MetricLatency::MultipassCompilation);
 
   WasmFrontendContext MainContext(*WasmMod);
   auto &MainMemPool = MainContext.ThreadMemPool;
@@ -363,6 +534,8 @@ void EagerJITCompiler::compile() {
   MModule Mod(MainContext);
   buildAllMIRFuncTypes(MainContext, Mod, *WasmMod);
   MainContext.CodeMPool = &WasmMod->getJITCodeMemPool();
+  MainContext.GreedyRABudget = Config.MultipassGreedyRABudget;
+  MainContext.AdaptiveRA = Config.EnableMultipassAdaptiveRA;
 
   const uint32_t NumImportFunctions = WasmMod->getNumImportFunctions();
   ZEN_ASSERT(NumInternalFunctions > 0);
@@ -409,6 +582,10 @@ void EagerJITCompiler::compile() {
   } else {
     common::ThreadPool<WasmFrontendContext> ThreadPool(
         std::min(Config.NumMultipassThreads, NumInternalFunctions));
+    if (Config.EnableNUMA) {
+      // keep compilation and the emitted code on the node loading the module
+      ThreadPool.setAllThreadsNumaNode(platform::getCurrentNumaNode());
+    }
     uint32_t NumThreads = ThreadPool.getThreadCount();
     ZEN_LOG_DEBUG("using %u threads for multipass JIT compilation", NumThreads);
 
@@ -505,13 +682,16 @@ LazyJITCompiler::LazyJITCompiler(Module *WasmMod)
   MainContext = new WasmFrontendContext(*WasmMod);
   MainContext->Lazy = true;
   MainContext->CodeMPool = &WasmMod->getJITCodeMemPool();
+  MainContext->GreedyRABudget = Config.MultipassGreedyRABudget;
+  MainContext->AdaptiveRA = Config.EnableMultipassAdaptiveRA;
   Mod = MainContext->ThreadMemPool.newObject<MModule>(*MainContext);
 
-  const runtime::RuntimeConfig &Config = WasmMod->getRuntime()->getConfig();
-
   if (!Config.DisableMultipassMultithread) {
     ThreadPool = std::make_unique<common::ThreadPool<WasmFrontendContext>>(
         std::min(Config.NumMultipassThreads, NumInternalFunctions));
+    if (Config.EnableNUMA) {
+      ThreadPool->setAllThreadsNumaNode(platform::getCurrentNumaNode());
+    }
     uint32_t NumThreads = ThreadPool->getThreadCount();
     ZEN_LOG_DEBUG("using %u threads for multipass JIT background compilation",
                   NumThreads);
@@ -610,6 +790,8 @@ void LazyJITCompiler::dispatchEntryCompileTasks(WasmFrontendContext &Ctx) {
 void LazyJITCompiler::precompile() {
   auto Timer =
       Stats.startRecord(zen::utils::StatisticPhase::JITLazyPrecompilation);
+  zen::utils::ScopedMetricTimer MetricTimer(
+      zen::utils::MetricLatency::MultipassCompilation);
   buildAllMIRFuncTypes(*MainContext, *Mod, *WasmMod);
   StubBuilder.allocateStubSpace(NumInternalFunctions);
   StubBuilder.compileStubResolver();
@@ -636,6 +818,8 @@ void LazyJITCompiler::precompile() {
 uint8_t *LazyJITCompiler::compileFunction(WasmFrontendContext &Ctx,
                                           uint32_t FuncIdx,
                                           bool DisableGreedyRA) {
+  utils::ScopedMetricTimer MetricTimer(
+      utils::MetricLatency::MultipassLazyCompilation);
   compileWasmToMC(Ctx, *Mod, FuncIdx, DisableGreedyRA);
   emitObjectBuffer(&Ctx);
   uint8_t *JITCode = const_cast<uint8_t *>(Ctx.CodeMPool->getMemStart());
@@ -10,6 +10,7 @@
 namespace COMPILER {
 
 class CompileContext;
+class CompilePassRecorder;
 class WasmFrontendContext;
 class MModule;
 class MFunction;
@@ -20,11 +21,16 @@ protected:
   virtual ~JITCompilerBase() = default;
 
   static void compileMIRToCgIR(MModule &Mod, MFunction &MFunc,
-                               CgFunction &CgFunc, bool DisableGreedyRA);
+                               CgFunction &CgFunc, bool DisableGreedyRA,
+                               CompilePassRecorder *Recorder = nullptr);
   static void emitObjectBuffer(CompileContext *Ctx);
 };
 
 class WasmJITCompiler : public JITCompilerBase {
+public:
+  // whether every tail call of Mod can reuse the frame of its caller
+  static bool canCompileTailCalls(const runtime::Module &Mod);
+
 protected:
   WasmJITCompiler(runtime::Module *WasmMod)
       : WasmMod(WasmMod),
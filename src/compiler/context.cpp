@@ -149,6 +149,8 @@ CompileContext::~CompileContext() {
 
 CompileContext::CompileContext(const CompileContext &OtherCtx) {
   Lazy = OtherCtx.Lazy;
+  GreedyRABudget = OtherCtx.GreedyRABudget;
+  AdaptiveRA = OtherCtx.AdaptiveRA;
   CodeMPool = OtherCtx.CodeMPool;
 }
 
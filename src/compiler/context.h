@@ -3,6 +3,7 @@
 #ifndef ZEN_COMPILER_CONTEXT_H
 #define ZEN_COMPILER_CONTEXT_H
 
+#include "compiler/adaptive_ra.h"
 #include "compiler/common/common_defs.h"
 #include "compiler/mir/constants.h"
 #include "compiler/mir/type.h"
@@ -90,10 +91,17 @@ public:
   static inline MType I64Type = MType::I64;
   static inline MType F32Type = MType::F32;
   static inline MType F64Type = MType::F64;
+  static inline MType V128Type = MType::V128;
   static inline MType VoidType = MType::VOID;
 
   bool Inited = false;
   bool Lazy = false;
+  // see RuntimeConfig::MultipassGreedyRABudget
+  uint64_t GreedyRABudget = 0;
+  // see RuntimeConfig::EnableMultipassAdaptiveRA
+  bool AdaptiveRA = false;
+  // profile of the function being compiled, used by the adaptive RA
+  FunctionHotness CurFuncHotness = FunctionHotness::Unknown;
 
   /// ================ MemPool Related ================
 
@@ -82,6 +82,8 @@ private:
       return &(_ctx.F32Type);
     case Token::TK_PT_f64:
       return &(_ctx.F64Type);
+    case Token::TK_PT_v128:
+      return &(_ctx.V128Type);
     case Token::TK_PT_void: {
       if (!match(Token::STAR)) {
         throw getError(ErrorCode::NoMatchedSyntax);
@@ -345,7 +347,8 @@ private:
   }
 
   // syntax: call %<func-index> (<arg0>, ..., <argn>)
-  MInstruction *consumeCallExprOrStmt(bool is_statement) {
+  MInstruction *consumeCallExprOrStmt(bool is_statement,
+                                      bool is_tail = false) {
     uint32_t callee_idx = consumeFuncIndex();
 
     std::vector<MInstruction *> args;
@@ -361,7 +364,7 @@ private:
     }
 
     auto inst = createInstruction<CallInstruction>(is_statement, nullptr,
-                                                   callee_idx, args);
+                                                   callee_idx, args, is_tail);
     if (callee_idx < _current_module->getNumFunctions()) {
       MType *type = _current_module->getFunction(callee_idx)
                         ->getFunctionType()
@@ -377,7 +380,8 @@ private:
   }
 
   // syntax: icall <return-type> (<func-addr>, <arg0>, ..., <argn>)
-  MInstruction *consumeICallExprOrStmt(bool is_statement) {
+  MInstruction *consumeICallExprOrStmt(bool is_statement,
+                                       bool is_tail = false) {
     MType *type = consumePrimType();
 
     consume(Token::LPAR);
@@ -396,7 +400,7 @@ private:
     }
 
     return createInstruction<ICallInstruction>(is_statement, type, callee_addr,
-                                               args);
+                                               args, is_tail);
   }
 
   MInstruction *consumeLoadExpression() {
@@ -507,6 +511,10 @@ private:
       return consumeCallExprOrStmt(true);
     case Token::TK_OP_icall:
       return consumeICallExprOrStmt(true);
+    case Token::TK_OP_tail_call:
+      return consumeCallExprOrStmt(true, true);
+    case Token::TK_OP_tail_icall:
+      return consumeICallExprOrStmt(true, true);
     case Token::TK_OP_return:
       return consumeReturnStatement();
     case Token::TK_OP_store:
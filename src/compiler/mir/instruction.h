@@ -28,6 +28,7 @@ public:
     DREAD,
     LOAD,
     OVERFLOW_I128_BINARY,
+    SIMD,
 
     //===---------- Statement Instructions ----------===//
     DASSIGN,
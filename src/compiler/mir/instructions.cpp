@@ -27,6 +27,8 @@ bool MInstruction::isTerminator() const {
   case SWITCH:
   case RETURN:
     return true;
+  case CALL:
+    return llvm::cast<CallInstructionBase>(this)->isTailCall();
   case BR_IF: {
     const BrIfInstruction *BrIfInstr = llvm::cast<BrIfInstruction>(this);
     return BrIfInstr->hasFalseBlock();
@@ -60,6 +62,22 @@ void MInstruction::print(llvm::raw_ostream &OS) const {
        << getOperand<1>() << ", " << getOperand<2>() << ", " << getOperand<3>()
        << ')';
     break;
+  case SIMD: {
+    auto *SIMDInst = llvm::cast<WasmSIMDInstruction>(this);
+    OS << getOpcodeString(_opcode) << '.' << SIMDInst->getSubOpcode();
+    if (SIMDInst->getLaneIdx() != 0) {
+      OS << " lane " << uint32_t(SIMDInst->getLaneIdx());
+    }
+    OS << " (";
+    for (OperandNum I = 0; I < getNumOperands(); ++I) {
+      OS << getOperand(I);
+      if (I != getNumOperands() - 1) {
+        OS << ", ";
+      }
+    }
+    OS << ')';
+    break;
+  }
   case DASSIGN: {
     auto *assign = llvm::cast<DassignInstruction>(this);
     OS << '$' << assign->getVarIdx() << " = " << getOperand<0>() << "\n";
@@ -117,11 +135,11 @@ void MInstruction::print(llvm::raw_ostream &OS) const {
   }
   case CALL: {
     if (auto *icall = llvm::dyn_cast<ICallInstruction>(this)) {
-      OS << "icall " << icall->getType()
+      OS << getOpcodeString(_opcode) << ' ' << icall->getType()
          << " (target = " << icall->getCalleeAddr() << ", ";
     } else {
       auto *dcall = llvm::cast<CallInstruction>(this);
-      OS << "call %" << dcall->getCalleeIdx() << " (";
+      OS << getOpcodeString(_opcode) << " %" << dcall->getCalleeIdx() << " (";
     }
     for (OperandNum i = 0; i < getNumOperands(); ++i) {
       OS << getOperand(i);
@@ -130,16 +148,21 @@ void MInstruction::print(llvm::raw_ostream &OS) const {
       }
     }
     OS << ')';
-    if (getType()->isVoid()) {
+    auto *call = llvm::cast<CallInstructionBase>(this);
+    // the variables of the other register results of a multi-value call
+    llvm::ArrayRef<VariableIdx> extra_vars = call->getExtraResultVars();
+    for (size_t i = 0; i < extra_vars.size(); ++i) {
+      OS << (i == 0 ? " => $" : ", $") << extra_vars[i];
+    }
+    if (getType()->isVoid() || call->isTailCall()) {
       OS << '\n';
     }
     break;
   }
   case RETURN: {
-    auto *ret = llvm::cast<ReturnInstruction>(this);
     OS << "return";
-    if (ret->getNumOperands() != 0) {
-      OS << " " << getOperand<0>();
+    for (OperandNum i = 0; i < getNumOperands(); ++i) {
+      OS << (i == 0 ? " " : ", ") << getOperand(i);
     }
     OS << "\n";
     break;
@@ -10,6 +10,7 @@
 #include "compiler/mir/instruction.h"
 #include "compiler/mir/opcode.h"
 #include "llvm/ADT/ArrayRef.h"
+#include <cstring>
 
 namespace COMPILER {
 
@@ -280,24 +281,43 @@ class CallInstructionBase : public DynamicOperandInstruction {
 public:
   template <typename T, typename Callee>
   static T *create(CompileMemPool &MemPool, MType *type, Callee callee,
-                   llvm::ArrayRef<MInstruction *> args) {
-    return DynamicOperandInstruction::create<T>(MemPool, args.size(), type,
-                                                callee, args);
+                   llvm::ArrayRef<MInstruction *> args, bool is_tail = false) {
+    return DynamicOperandInstruction::createWithMemPool<T>(
+        MemPool, args.size(), type, callee, args, is_tail);
   }
 
   static bool classof(const MInstruction *inst) {
     return inst->getKind() == CALL;
   }
 
+  // a tail call ends its block, the callee returns to the caller of the
+  // function in place of it
+  bool isTailCall() const {
+    return getOpcode() == OP_tail_call || getOpcode() == OP_tail_icall;
+  }
+
+  // the variables assigned the results of a multi-value call which follow
+  // the value of the call in the return registers, see JITReturnAllocator
+  llvm::ArrayRef<VariableIdx> getExtraResultVars() const {
+    return ExtraResultVars;
+  }
+
+  void addExtraResultVar(VariableIdx VarIdx) {
+    ExtraResultVars.push_back(VarIdx);
+  }
+
 protected:
-  CallInstructionBase(MType *type, Opcode opcode,
+  CallInstructionBase(CompileMemPool &MemPool, MType *type, Opcode opcode,
                       llvm::ArrayRef<MInstruction *> args)
       : DynamicOperandInstruction(MInstruction::CALL, opcode, args.size(),
-                                  type) {
+                                  type),
+        ExtraResultVars(MemPool) {
     for (OperandNum i = 0; i < args.size(); i++) {
       setOperand(i, args[i]);
     }
   }
+
+  CompileVector<VariableIdx> ExtraResultVars;
 };
 
 // Direct Call Instruction
@@ -310,16 +330,18 @@ public:
   }
 
   static bool classof(const MInstruction *inst) {
-    return inst->getOpcode() == OP_call;
+    return inst->getOpcode() == OP_call || inst->getOpcode() == OP_tail_call;
   }
 
   uint32_t getCalleeIdx() const { return _callee_idx; }
 
 private:
   friend class DynamicOperandInstruction;
-  CallInstruction(MType *type, uint32_t callee_idx,
-                  llvm::ArrayRef<MInstruction *> args)
-      : CallInstructionBase(type, OP_call, args), _callee_idx(callee_idx) {}
+  CallInstruction(CompileMemPool &MemPool, MType *type, uint32_t callee_idx,
+                  llvm::ArrayRef<MInstruction *> args, bool is_tail = false)
+      : CallInstructionBase(MemPool, type, is_tail ? OP_tail_call : OP_call,
+                            args),
+        _callee_idx(callee_idx) {}
 
   uint32_t _callee_idx = 0;
 };
@@ -334,16 +356,19 @@ public:
   }
 
   static bool classof(const MInstruction *inst) {
-    return inst->getOpcode() == OP_icall;
+    return inst->getOpcode() == OP_icall || inst->getOpcode() == OP_tail_icall;
   }
 
   MInstruction *getCalleeAddr() const { return _callee_addr; }
 
 private:
   friend class DynamicOperandInstruction;
-  ICallInstruction(MType *type, MInstruction *callee_addr,
-                   llvm::ArrayRef<MInstruction *> args)
-      : CallInstructionBase(type, OP_icall, args), _callee_addr(callee_addr) {}
+  ICallInstruction(CompileMemPool &MemPool, MType *type,
+                   MInstruction *callee_addr,
+                   llvm::ArrayRef<MInstruction *> args, bool is_tail = false)
+      : CallInstructionBase(MemPool, type,
+                            is_tail ? OP_tail_icall : OP_icall, args),
+        _callee_addr(callee_addr) {}
   MInstruction *_callee_addr;
 };
 
@@ -449,17 +474,23 @@ protected:
   CompileVector<MBasicBlock *> Blocks;
 };
 
+// the type is the one of the first operand, a multi-value return has an
+// operand for each result in the return registers, see JITReturnAllocator
 class ReturnInstruction : public DynamicOperandInstruction {
 public:
   static ReturnInstruction *create(CompileMemPool &MemPool, MType *type,
                                    MInstruction *opnd) {
-    uint32_t opnd_num = 0;
-    if (!type->isVoid()) {
-      ZEN_ASSERT(opnd != nullptr);
-      opnd_num = 1;
+    if (type->isVoid()) {
+      return create(MemPool, type, llvm::ArrayRef<MInstruction *>());
     }
+    ZEN_ASSERT(opnd != nullptr);
+    return create(MemPool, type, llvm::ArrayRef<MInstruction *>(opnd));
+  }
+  static ReturnInstruction *create(CompileMemPool &MemPool, MType *type,
+                                   llvm::ArrayRef<MInstruction *> opnds) {
+    ZEN_ASSERT(type->isVoid() == opnds.empty());
     return DynamicOperandInstruction::create<ReturnInstruction>(
-        MemPool, opnd_num, type, opnd, opnd_num);
+        MemPool, opnds.size(), type, opnds);
   }
   static bool classof(const MInstruction *inst) {
     return inst->getOpcode() == OP_return;
@@ -467,11 +498,11 @@ public:
 
 private:
   friend class DynamicOperandInstruction;
-  ReturnInstruction(MType *type, MInstruction *operand, uint32_t opnd_num)
-      : DynamicOperandInstruction(MInstruction::RETURN, OP_return, opnd_num,
-                                  type) {
-    if (opnd_num != 0) {
-      setOperand<0>(operand);
+  ReturnInstruction(MType *type, llvm::ArrayRef<MInstruction *> operands)
+      : DynamicOperandInstruction(MInstruction::RETURN, OP_return,
+                                  operands.size(), type) {
+    for (OperandNum i = 0; i < operands.size(); i++) {
+      setOperand(i, operands[i]);
     }
   }
 };
@@ -624,6 +655,48 @@ private:
   }
 };
 
+// a fixed-width simd operation selected by a wasm FDOpcode, the lane index
+// and the 16-byte immediate (v128.const bytes or shuffle mask) are only
+// meaningful for the sub-opcodes that carry them
+class WasmSIMDInstruction : public DynamicOperandInstruction {
+public:
+  static WasmSIMDInstruction *
+  create(CompileMemPool &MemPool, MType *Type, uint32_t SubOpcode,
+         llvm::ArrayRef<MInstruction *> Operands, uint8_t LaneIdx = 0,
+         const uint8_t *Imm = nullptr) {
+    return DynamicOperandInstruction::create<WasmSIMDInstruction>(
+        MemPool, Operands.size(), Type, SubOpcode, Operands, LaneIdx, Imm);
+  }
+
+  static bool classof(const MInstruction *Instr) {
+    return Instr->getKind() == SIMD;
+  }
+
+  uint32_t getSubOpcode() const { return SubOpcode; }
+  uint8_t getLaneIdx() const { return LaneIdx; }
+  const uint8_t *getImm() const { return Imm; }
+
+private:
+  friend class DynamicOperandInstruction;
+  WasmSIMDInstruction(MType *Type, uint32_t SubOpcode,
+                      llvm::ArrayRef<MInstruction *> Operands, uint8_t LaneIdx,
+                      const uint8_t *Imm)
+      : DynamicOperandInstruction(MInstruction::SIMD, OP_wasm_simd,
+                                  Operands.size(), Type),
+        SubOpcode(SubOpcode), LaneIdx(LaneIdx) {
+    for (size_t I = 0; I < Operands.size(); ++I) {
+      setOperand(I, Operands[I]);
+    }
+    if (Imm) {
+      std::memcpy(this->Imm, Imm, sizeof(this->Imm));
+    }
+  }
+
+  uint32_t SubOpcode;
+  uint8_t LaneIdx;
+  uint8_t Imm[16] = {};
+};
+
 } // namespace COMPILER
 
 #endif // COMPILER_IR_INSTRUCTIONS_H
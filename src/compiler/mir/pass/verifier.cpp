@@ -103,6 +103,18 @@ void MVerifier::visitWasmOverflowI128BinaryInstruction(
   MVisitor::visitWasmOverflowI128BinaryInstruction(Instr);
 }
 
+void MVerifier::visitWasmSIMDInstruction(WasmSIMDInstruction &Instr) {
+  CHECK(Instr.getNumOperands() <= 3,
+        "The wasm_simd instruction takes at most 3 operands");
+  bool HasVector = Instr.getType()->isVector();
+  for (uint32_t I = 0; I < Instr.getNumOperands(); ++I) {
+    HasVector |= Instr.getOperand(I)->getType()->isVector();
+  }
+  CHECK(HasVector,
+        "The wasm_simd instruction must have a v128 operand or result");
+  MVisitor::visitWasmSIMDInstruction(Instr);
+}
+
 void MVerifier::visitCmpInstruction(CmpInstruction &I) {
   MType *Type = I.getType();
   CHECK(Type->isI8() || Type->isI32(),
@@ -268,6 +280,12 @@ void MVerifier::visitCallInstructionBase(CallInstructionBase &I) {
           "The call/icall instruction must be the right operand of the "
           "dassign instruction if it isn't a statement");
   }
+  if (I.isTailCall()) {
+    MType *ReturnType = CurFunc->getFunctionType()->getReturnType();
+    CHECK(I.isStatement() && I.getType()->getKind() == ReturnType->getKind(),
+          "The tail call instruction must be a statement of the return type "
+          "of the function");
+  }
 
   MVisitor::visitCallInstructionBase(I);
 }
@@ -63,6 +63,7 @@ public:
       WasmVisitStackGuardInstruction &I) override;
   void visitWasmOverflowI128BinaryInstruction(
       WasmOverflowI128BinaryInstruction &I) override;
+  void visitWasmSIMDInstruction(WasmSIMDInstruction &I) override;
 
 private:
   void visitIntExtInstruction(MType *OperandType, MType *ResultType);
@@ -42,6 +42,9 @@ public:
       visitWasmOverflowI128BinaryInstruction(
           static_cast<WasmOverflowI128BinaryInstruction &>(I));
       break;
+    case MInstruction::SIMD:
+      visitWasmSIMDInstruction(static_cast<WasmSIMDInstruction &>(I));
+      break;
     case MInstruction::CMP:
       visitCmpInstruction(static_cast<CmpInstruction &>(I));
       break;
@@ -70,7 +73,7 @@ public:
       visitSwitchInstruction(static_cast<SwitchInstruction &>(I));
       break;
     case MInstruction::CALL:
-      if (I.getOpcode() == OP_call) {
+      if (llvm::isa<CallInstruction>(I)) {
         visitCallInstruction(static_cast<CallInstruction &>(I));
       } else {
         visitICallInstruction(static_cast<ICallInstruction &>(I));
@@ -165,6 +168,9 @@ public:
   visitWasmOverflowI128BinaryInstruction(WasmOverflowI128BinaryInstruction &I) {
     VISIT_OPERANDS
   }
+  virtual void visitWasmSIMDInstruction(WasmSIMDInstruction &I) {
+    VISIT_OPERANDS
+  }
 
 protected:
   MModule &Module;
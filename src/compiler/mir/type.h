@@ -55,6 +55,7 @@ public:
   bool isI64() const { return _kind == I64; }
   bool isF32() const { return _kind == F32; }
   bool isF64() const { return _kind == F64; }
+  bool isV128() const { return _kind == V128; }
   bool is32Bits() const { return _kind == I32 || _kind == F32; }
   bool is64Bits() const { return _kind == I64 || _kind == F64; }
 
@@ -72,6 +73,7 @@ public:
 
   bool isInteger() const { return isInteger(_kind); }
   bool isFloat() const { return _kind == F32 || _kind == F64; }
+  bool isVector() const { return _kind == V128; }
   bool isPointer() const { return _kind == POINTER_TYPE; }
   bool isSigned() const {
     ZEN_ASSERT(isInteger());
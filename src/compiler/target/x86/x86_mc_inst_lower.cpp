@@ -226,6 +226,22 @@ void X86MCInstLower::lower(CgInstruction *MI, llvm::MCInst &OutMI) {
     ZEN_ASSERT(OutMI.getNumOperands() == 1 && "Unexpected number of operands!");
     break;
 
+  // TCRETURNdi64, TCRETURNri64 - The tail calls follow the epilogue, they
+  // jump to the callee, the stack adjustment operand is always 0.
+  case X86::TCRETURNdi64:
+  case X86::TCRETURNri64: {
+    ZEN_ASSERT(OutMI.getNumOperands() == 2 &&
+               OutMI.getOperand(1).getImm() == 0 &&
+               "Unexpected tail call operands!");
+    unsigned NewOpc =
+        OutMI.getOpcode() == X86::TCRETURNdi64 ? X86::JMP_4 : X86::JMP64r;
+    MCOperand Callee = OutMI.getOperand(0);
+    OutMI = MCInst();
+    OutMI.setOpcode(NewOpc);
+    OutMI.addOperand(Callee);
+    break;
+  }
+
   case X86::ADC8ri:
   case X86::ADC16ri:
   case X86::ADC32ri:
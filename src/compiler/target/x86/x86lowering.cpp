@@ -1022,6 +1022,8 @@ static inline unsigned getMovMemToRegOpcode(MType::Kind SrcTypeKind,
     return X86::MOVSSrm;
   case MType::F64:
     return X86::MOVSDrm;
+  case MType::V128:
+    return X86::MOVUPSrm;
   default:
     ZEN_ASSERT_TODO();
   }
@@ -1046,6 +1048,8 @@ static inline unsigned getMovRegToMemOpcode(MType::Kind TypeKind) {
     return X86::MOVSSmr;
   case MType::F64:
     return X86::MOVSDmr;
+  case MType::V128:
+    return X86::MOVUPSmr;
   default:
     ZEN_ASSERT_TODO();
   }
@@ -1306,37 +1310,54 @@ static const uint32_t CSR_64_RegMask[] = {
     0x00000000, 0x00000000, 0x0f000000, 0x0f0f0f0f,
 };
 
+// v128 values are passed in xmm registers like floats, and take two stack
+// slots when spilled
+static bool isXMMArgType(const MType &Type) {
+  return Type.isFloat() || Type.isVector();
+}
+
+static uint32_t getNumArgStackSlots(const MType &Type) {
+  return Type.isVector() ? 2 : 1;
+}
+
 static unsigned getCallFrameSize(const CallInstructionBase &Inst) {
-  int32_t NumIntOperands = 0;
-  int32_t NumFloatOperands = 0;
+  uint32_t NumIntOperands = 0;
+  uint32_t NumXMMOperands = 0;
+  uint32_t NumStackSlots = 0;
   const uint32_t NumOperands = Inst.getNumOperands();
   for (uint32_t i = 0; i < NumOperands; ++i) {
-    MVT ArgVT = getMVT(*Inst.getOperand(i)->getType());
-    if (ArgVT.isInteger()) {
-      NumIntOperands++;
+    const MType &Type = *Inst.getOperand(i)->getType();
+    if (isXMMArgType(Type)) {
+      if (NumXMMOperands++ >= getArraySize(XMMArgRegs)) {
+        NumStackSlots += getNumArgStackSlots(Type);
+      }
     } else {
-      ZEN_ASSERT(ArgVT.isFloatingPoint());
-      NumFloatOperands++;
+      ZEN_ASSERT(getMVT(Type).isInteger());
+      if (NumIntOperands++ >= getArraySize(GPR64ArgRegs)) {
+        NumStackSlots++;
+      }
     }
   }
-  return (std::max(NumIntOperands - 6, 0)) * 8 +
-         (std::max(NumFloatOperands - 8, 0)) * 8;
+  return NumStackSlots * 8;
 }
 
-static MCPhysReg getReturnRegister(MVT VT) {
-  MCPhysReg Reg;
+// the return register by index among the return registers of its kind, see
+// JITReturnAllocator
+static MCPhysReg getReturnRegister(MVT VT, uint32_t Index = 0) {
+  ZEN_ASSERT(Index < 2);
   switch (VT.SimpleTy) {
   case MVT::i8:
-    return X86::AL;
+    return Index ? X86::DL : X86::AL;
   case MVT::i16:
-    return X86::AX;
+    return Index ? X86::DX : X86::AX;
   case MVT::i32:
-    return X86::EAX;
+    return Index ? X86::EDX : X86::EAX;
   case MVT::i64:
-    return X86::RAX;
+    return Index ? X86::RDX : X86::RAX;
   case MVT::f32:
   case MVT::f64:
-    return X86::XMM0;
+  case MVT::v2i64:
+    return Index ? X86::XMM1 : X86::XMM0;
   case MVT::isVoid:
     return X86::NoRegister;
   default:
@@ -1348,16 +1369,27 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
   SmallVector<CgOperand, 8> CallOperands;
 
   bool IsIndirectCall = llvm::isa<ICallInstruction>(Inst);
+  // a tail call is the epilogue followed by a jump to the callee, which
+  // returns to the caller of the current function
+  bool IsTailCall = Inst.isTailCall();
 
   if (IsIndirectCall) {
     const auto &ICallInst = llvm::cast<ICallInstruction>(Inst);
     CgRegister CalleeAddrReg = lowerExpr(*ICallInst.getCalleeAddr());
+    if (IsTailCall) {
+      // the epilogue restores the callee-saved registers
+      CalleeAddrReg = fastEmitCopy(&X86::GR64_TCRegClass, CalleeAddrReg);
+    }
     CallOperands.push_back(CgOperand::createRegOperand(CalleeAddrReg, false));
   } else {
     const auto &DCallInst = llvm::cast<CallInstruction>(Inst);
     CallOperands.push_back(
         CgOperand::createFuncOperand(DCallInst.getCalleeIdx()));
   }
+  if (IsTailCall) {
+    // no stack adjustment before the jump
+    CallOperands.push_back(CgOperand::createImmOperand(0));
+  }
 
   // Add a register mask operand representing the call-preserved registers.
   CallOperands.push_back(CgOperand::createRegMask(CSR_64_RegMask));
@@ -1375,14 +1407,19 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
 
   unsigned StackAdjustNumBytes = getCallFrameSize(Inst);
 
-  // Issue CALLSEQ_START
-  unsigned AdjStackDown = TII.getCallFrameSetupOpcode();
-  SmallVector<CgOperand, 3> StackDownOperands{
-      CgOperand::createImmOperand(StackAdjustNumBytes),
-      CgOperand::createImmOperand(0),
-      CgOperand::createImmOperand(0),
-  };
-  MF->createCgInstruction(*CurBB, TII.get(AdjStackDown), StackDownOperands);
+  if (IsTailCall) {
+    // the stack arguments overwrite the ones of the current function
+    MF->getFrameInfo().setHasTailCall();
+  } else {
+    // Issue CALLSEQ_START
+    unsigned AdjStackDown = TII.getCallFrameSetupOpcode();
+    SmallVector<CgOperand, 3> StackDownOperands{
+        CgOperand::createImmOperand(StackAdjustNumBytes),
+        CgOperand::createImmOperand(0),
+        CgOperand::createImmOperand(0),
+    };
+    MF->createCgInstruction(*CurBB, TII.get(AdjStackDown), StackDownOperands);
+  }
 
   uint32_t GPRIdx = 0;
   uint32_t FPRIdx = 0;
@@ -1402,7 +1439,7 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
     } else if ((Type->isI64() || Type->isPointer()) &&
                GPRIdx < getArraySize(GPR64ArgRegs)) {
       ArgReg = GPR64ArgRegs[GPRIdx++];
-    } else if (Type->isFloat() && FPRIdx < getArraySize(XMMArgRegs)) {
+    } else if (isXMMArgType(*Type) && FPRIdx < getArraySize(XMMArgRegs)) {
       ArgReg = XMMArgRegs[FPRIdx++];
     } else {
       NeedSpill = true;
@@ -1412,6 +1449,21 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
       MF->createCgInstruction(*CurBB, TII.get(TargetOpcode::COPY), ArgVirtReg,
                               ArgReg);
       CallOperands.push_back(CgOperand::createRegOperand(ArgReg, false, true));
+    } else if (IsTailCall) {
+      // the current function has at least as many stack arguments, see
+      // WasmJITCompiler::canCompileTailCalls
+      int FI = MF->getFrameInfo().CreateFixedObject(Type->getNumBytes(),
+                                                    SpillIdx * 8, false);
+      SmallVector<CgOperand, 6> SpillOperands{
+          CgOperand::createFI(FI),
+          CgOperand::createImmOperand(1),
+          CgOperand::createRegOperand(X86::NoRegister, false),
+          CgOperand::createImmOperand(0),
+          CgOperand::createRegOperand(X86::NoRegister, false),
+          CgOperand::createRegOperand(ArgVirtReg, false)};
+      unsigned Opcode = getMovRegToMemOpcode(Type->getKind());
+      MF->createCgInstruction(*CurBB, TII.get(Opcode), SpillOperands);
+      SpillIdx += getNumArgStackSlots(*Type);
     } else {
       SmallVector<CgOperand, 6> SpillOperands{
           CgOperand::createRegOperand(X86::RSP, false),
@@ -1422,10 +1474,16 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
           CgOperand::createRegOperand(ArgVirtReg, false)};
       unsigned Opcode = getMovRegToMemOpcode(Type->getKind());
       MF->createCgInstruction(*CurBB, TII.get(Opcode), SpillOperands);
-      SpillIdx++;
+      SpillIdx += getNumArgStackSlots(*Type);
     }
   }
 
+  if (IsTailCall) {
+    unsigned TCOpc = IsIndirectCall ? X86::TCRETURNri64 : X86::TCRETURNdi64;
+    MF->createCgInstruction(*CurBB, TII.get(TCOpc), CallOperands);
+    return X86::NoRegister;
+  }
+
   MType *Type = Inst.getType();
   MVT VT = getMVT(*Type);
   CgRegister ReturnReg = getReturnRegister(VT);
@@ -1434,6 +1492,18 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
     CallOperands.push_back(CgOperand::createRegOperand(ReturnReg, true, true));
   }
 
+  // the other results in the return registers of a multi-value call
+  uint32_t NumIntRets = !Type->isVoid() && !isXMMArgType(*Type);
+  uint32_t NumXMMRets = !Type->isVoid() && isXMMArgType(*Type);
+  SmallVector<std::pair<MCPhysReg, VariableIdx>, 2> ExtraResults;
+  for (VariableIdx VarIdx : Inst.getExtraResultVars()) {
+    MType *VarType = _mir_func.getVariableType(VarIdx);
+    uint32_t &NumRets = isXMMArgType(*VarType) ? NumXMMRets : NumIntRets;
+    MCPhysReg ExtraReg = getReturnRegister(getMVT(*VarType), NumRets++);
+    CallOperands.push_back(CgOperand::createRegOperand(ExtraReg, true, true));
+    ExtraResults.emplace_back(ExtraReg, VarIdx);
+  }
+
   unsigned CALLOpc = IsIndirectCall ? X86::CALL64r : X86::CALL64pcrel32;
   MF->createCgInstruction(*CurBB, TII.get(CALLOpc), CallOperands);
 
@@ -1445,6 +1515,13 @@ CgRegister X86CgLowering::lowerCall(const CallInstructionBase &Inst) {
   };
   MF->createCgInstruction(*CurBB, TII.get(AdjStackUp), StackUpOperands);
 
+  for (const auto &[ExtraReg, VarIdx] : ExtraResults) {
+    MVT VarVT = getMVT(*_mir_func.getVariableType(VarIdx));
+    CgRegister VarReg = getOrCreateVarReg(VarIdx, TLI.getRegClassFor(VarVT));
+    MF->createCgInstruction(*CurBB, TII.get(TargetOpcode::COPY), ExtraReg,
+                            VarReg);
+  }
+
   if (!Type->isVoid()) {
     const TargetRegisterClass *RC = TLI.getRegClassFor(VT);
     return fastEmitCopy(RC, ReturnReg);
@@ -1477,7 +1554,7 @@ void X86CgLowering::lowerFormalArguments() {
     } else if ((Type->isI64() || Type->isPointer()) &&
                GPRIdx < getArraySize(GPR64ArgRegs)) {
       ParamReg = GPR64ArgRegs[GPRIdx++];
-    } else if (Type->isFloat() && FPRIdx < getArraySize(XMMArgRegs)) {
+    } else if (isXMMArgType(*Type) && FPRIdx < getArraySize(XMMArgRegs)) {
       ParamReg = XMMArgRegs[FPRIdx++];
     } else {
       NeedReload = true;
@@ -1500,22 +1577,28 @@ void X86CgLowering::lowerFormalArguments() {
           CgOperand::createRegOperand(X86::NoRegister, false),
       };
       MF->createCgInstruction(*CurBB, TII.get(Opcode), ReloadOperands);
-      ReloadIdx++;
+      ReloadIdx += getNumArgStackSlots(*Type);
       // unsigned StackSize = CCInfo.getNextStackOffset();
       // FuncInfo->setArgumentStackSize(StackSize);
     }
   }
 }
 
-void X86CgLowering::lowerReturnStmt(llvm::MVT VT, CgRegister OperandReg) {
+void X86CgLowering::lowerReturnStmt(ArrayRef<MVT> VTs,
+                                    ArrayRef<CgRegister> OperandRegs) {
   unsigned RETOpc = X86::RET64;
 
-  SmallVector<CgOperand, 1> ReturnOperands;
-
-  if (OperandReg.isValid()) {
-    MCPhysReg ResultReg = getReturnRegister(VT);
-    MF->createCgInstruction(*CurBB, TII.get(TargetOpcode::COPY), OperandReg,
-                            ResultReg);
+  SmallVector<CgOperand, 2> ReturnOperands;
+
+  // a multi-value return fills the return registers of each kind in order
+  uint32_t NumIntRets = 0;
+  uint32_t NumXMMRets = 0;
+  for (size_t I = 0; I < OperandRegs.size(); ++I) {
+    bool IsXMM = VTs[I].isFloatingPoint() || VTs[I].isVector();
+    MCPhysReg ResultReg =
+        getReturnRegister(VTs[I], IsXMM ? NumXMMRets++ : NumIntRets++);
+    MF->createCgInstruction(*CurBB, TII.get(TargetOpcode::COPY),
+                            OperandRegs[I], ResultReg);
     // The operand of ret instruction is implicit
     ReturnOperands.push_back(
         CgOperand::createRegOperand(ResultReg, false, true));
@@ -67,6 +67,7 @@ public:
   CgRegister lowerSelectExpr(const SelectInstruction &Inst);
   CgRegister lowerWasmOverflowI128BinaryExpr(
       const WasmOverflowI128BinaryInstruction &Inst);
+  CgRegister lowerWasmSIMDExpr(const WasmSIMDInstruction &Inst);
 
   // ==================== Memory Instructions ====================
 
@@ -80,7 +81,8 @@ public:
   void lowerSwitchStmt(const SwitchInstruction &Inst);
   CgRegister lowerCall(const CallInstructionBase &Inst);
   void lowerFormalArguments();
-  void lowerReturnStmt(llvm::MVT VT, CgRegister OperandReg);
+  void lowerReturnStmt(llvm::ArrayRef<llvm::MVT> VTs,
+                       llvm::ArrayRef<CgRegister> OperandRegs);
 
   // ==================== Wasm Check Statements ====================
 
@@ -111,6 +113,22 @@ private:
   CgRegister X86MaterializeInt(uint64_t Imm, MVT VT);
   CgRegister X86MaterializeFP(const MConstantFloat &FloatConstant, MVT VT);
   CgRegister fastMaterializeFloatZero(MVT VT);
+  CgRegister X86MaterializeV128(uint64_t Lo, uint64_t Hi);
+  CgRegister X86MaterializeV128(const uint8_t *Bytes);
+
+  // ==================== SIMD Utilities ====================
+
+  CgRegister lowerSIMDNot(CgRegister Operand);
+  CgRegister lowerSIMDSplat(uint32_t SubOpcode, CgRegister Scalar);
+  CgRegister lowerSIMDShift(uint32_t SubOpcode, CgRegister Vec,
+                            CgRegister Count);
+  CgRegister lowerSIMDI64Mul(CgRegister LHS, CgRegister RHS);
+  CgRegister lowerSIMDBitmask(uint32_t SubOpcode, CgRegister Vec);
+  CgRegister lowerSIMDCompare(uint32_t SubOpcode, CgRegister LHS,
+                              CgRegister RHS);
+  CgRegister lowerSIMDExtend(uint32_t SubOpcode, CgRegister Vec);
+  // ptest the vector against itself and materialize the condition as i32
+  CgRegister lowerSIMDTest(CgRegister Vec, unsigned CC);
 
   // Emit an unconditional branch to TargetBB
   void fastEmitBranch(CgBasicBlock *TargetBB);
@@ -0,0 +1,623 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+#include "compiler/target/x86/x86lowering.h"
+#include "common/enums.h"
+#include <cstring>
+
+using namespace COMPILER;
+using namespace llvm;
+using common::FDOpcode;
+
+// Only sse4.1 instructions are selected here, the subtarget doesn't enable avx
+
+static unsigned getSIMDBinaryOpcode(uint32_t SubOpcode) {
+  switch (SubOpcode) {
+  case FDOpcode::V128_AND:
+    return X86::PANDrr;
+  case FDOpcode::V128_OR:
+    return X86::PORrr;
+  case FDOpcode::V128_XOR:
+    return X86::PXORrr;
+  case FDOpcode::I8X16_EQ:
+    return X86::PCMPEQBrr;
+  case FDOpcode::I16X8_EQ:
+    return X86::PCMPEQWrr;
+  case FDOpcode::I32X4_EQ:
+    return X86::PCMPEQDrr;
+  case FDOpcode::I64X2_EQ:
+    return X86::PCMPEQQrr;
+  case FDOpcode::I8X16_GT_S:
+    return X86::PCMPGTBrr;
+  case FDOpcode::I16X8_GT_S:
+    return X86::PCMPGTWrr;
+  case FDOpcode::I32X4_GT_S:
+    return X86::PCMPGTDrr;
+  case FDOpcode::I8X16_ADD:
+    return X86::PADDBrr;
+  case FDOpcode::I8X16_SUB:
+    return X86::PSUBBrr;
+  case FDOpcode::I8X16_MIN_S:
+    return X86::PMINSBrr;
+  case FDOpcode::I8X16_MIN_U:
+    return X86::PMINUBrr;
+  case FDOpcode::I8X16_MAX_S:
+    return X86::PMAXSBrr;
+  case FDOpcode::I8X16_MAX_U:
+    return X86::PMAXUBrr;
+  case FDOpcode::I16X8_ADD:
+    return X86::PADDWrr;
+  case FDOpcode::I16X8_SUB:
+    return X86::PSUBWrr;
+  case FDOpcode::I16X8_MUL:
+    return X86::PMULLWrr;
+  case FDOpcode::I16X8_MIN_S:
+    return X86::PMINSWrr;
+  case FDOpcode::I16X8_MIN_U:
+    return X86::PMINUWrr;
+  case FDOpcode::I16X8_MAX_S:
+    return X86::PMAXSWrr;
+  case FDOpcode::I16X8_MAX_U:
+    return X86::PMAXUWrr;
+  case FDOpcode::I32X4_ADD:
+    return X86::PADDDrr;
+  case FDOpcode::I32X4_SUB:
+    return X86::PSUBDrr;
+  case FDOpcode::I32X4_MUL:
+    return X86::PMULLDrr;
+  case FDOpcode::I32X4_MIN_S:
+    return X86::PMINSDrr;
+  case FDOpcode::I32X4_MIN_U:
+    return X86::PMINUDrr;
+  case FDOpcode::I32X4_MAX_S:
+    return X86::PMAXSDrr;
+  case FDOpcode::I32X4_MAX_U:
+    return X86::PMAXUDrr;
+  case FDOpcode::I32X4_DOT_I16X8_S:
+    return X86::PMADDWDrr;
+  case FDOpcode::I64X2_ADD:
+    return X86::PADDQrr;
+  case FDOpcode::I64X2_SUB:
+    return X86::PSUBQrr;
+  case FDOpcode::I8X16_ADD_SAT_S:
+    return X86::PADDSBrr;
+  case FDOpcode::I8X16_ADD_SAT_U:
+    return X86::PADDUSBrr;
+  case FDOpcode::I8X16_SUB_SAT_S:
+    return X86::PSUBSBrr;
+  case FDOpcode::I8X16_SUB_SAT_U:
+    return X86::PSUBUSBrr;
+  case FDOpcode::I16X8_ADD_SAT_S:
+    return X86::PADDSWrr;
+  case FDOpcode::I16X8_ADD_SAT_U:
+    return X86::PADDUSWrr;
+  case FDOpcode::I16X8_SUB_SAT_S:
+    return X86::PSUBSWrr;
+  case FDOpcode::I16X8_SUB_SAT_U:
+    return X86::PSUBUSWrr;
+  case FDOpcode::I8X16_AVGR_U:
+    return X86::PAVGBrr;
+  case FDOpcode::I16X8_AVGR_U:
+    return X86::PAVGWrr;
+  // the lanes of the first operand go to the low half, like in wasm
+  case FDOpcode::I8X16_NARROW_I16X8_S:
+    return X86::PACKSSWBrr;
+  case FDOpcode::I8X16_NARROW_I16X8_U:
+    return X86::PACKUSWBrr;
+  case FDOpcode::I16X8_NARROW_I32X4_S:
+    return X86::PACKSSDWrr;
+  case FDOpcode::I16X8_NARROW_I32X4_U:
+    return X86::PACKUSDWrr;
+  // the nan results may differ in sign and payload from the interpreter,
+  // which wasm allows
+  case FDOpcode::F32X4_ADD:
+    return X86::ADDPSrr;
+  case FDOpcode::F32X4_SUB:
+    return X86::SUBPSrr;
+  case FDOpcode::F32X4_MUL:
+    return X86::MULPSrr;
+  case FDOpcode::F32X4_DIV:
+    return X86::DIVPSrr;
+  case FDOpcode::F64X2_ADD:
+    return X86::ADDPDrr;
+  case FDOpcode::F64X2_SUB:
+    return X86::SUBPDrr;
+  case FDOpcode::F64X2_MUL:
+    return X86::MULPDrr;
+  case FDOpcode::F64X2_DIV:
+    return X86::DIVPDrr;
+  default:
+    return 0;
+  }
+}
+
+// the opcode comparing each lane with the same-width lane of another vector
+static unsigned getSIMDLaneEqOpcode(uint32_t SubOpcode) {
+  switch (SubOpcode) {
+  case FDOpcode::I8X16_NE:
+  case FDOpcode::I8X16_ALL_TRUE:
+    return X86::PCMPEQBrr;
+  case FDOpcode::I16X8_NE:
+  case FDOpcode::I16X8_ALL_TRUE:
+    return X86::PCMPEQWrr;
+  case FDOpcode::I32X4_NE:
+  case FDOpcode::I32X4_ALL_TRUE:
+    return X86::PCMPEQDrr;
+  case FDOpcode::I64X2_NE:
+  case FDOpcode::I64X2_ALL_TRUE:
+    return X86::PCMPEQQrr;
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+CgRegister X86CgLowering::X86MaterializeV128(uint64_t Lo, uint64_t Hi) {
+  CgRegister LoReg = X86MaterializeInt(Lo, MVT::i64);
+  CgRegister VecReg =
+      fastEmitInst_r(X86::MOV64toPQIrr, &X86::VR128RegClass, LoReg);
+  if (Hi == 0) {
+    return VecReg;
+  }
+  CgRegister HiReg = X86MaterializeInt(Hi, MVT::i64);
+  return fastEmitInst_rri(X86::PINSRQrr, &X86::VR128RegClass, VecReg, HiReg,
+                          1);
+}
+
+CgRegister X86CgLowering::X86MaterializeV128(const uint8_t *Bytes) {
+  uint64_t Lo, Hi;
+  std::memcpy(&Lo, Bytes, sizeof(Lo));
+  std::memcpy(&Hi, Bytes + sizeof(Lo), sizeof(Hi));
+  return X86MaterializeV128(Lo, Hi);
+}
+
+CgRegister X86CgLowering::lowerSIMDNot(CgRegister Operand) {
+  CgRegister Ones = X86MaterializeV128(UINT64_MAX, UINT64_MAX);
+  return fastEmitInst_rr(X86::PXORrr, &X86::VR128RegClass, Operand, Ones);
+}
+
+CgRegister X86CgLowering::lowerSIMDSplat(uint32_t SubOpcode,
+                                         CgRegister Scalar) {
+  const TargetRegisterClass *RC = &X86::VR128RegClass;
+  if (SubOpcode == FDOpcode::I64X2_SPLAT) {
+    CgRegister VecReg = fastEmitInst_r(X86::MOV64toPQIrr, RC, Scalar);
+    return fastEmitInst_ri(X86::PSHUFDri, RC, VecReg, 0x44);
+  }
+  CgRegister VecReg = fastEmitInst_r(X86::MOVDI2PDIrr, RC, Scalar);
+  switch (SubOpcode) {
+  case FDOpcode::I8X16_SPLAT:
+    // an all-zero mask broadcasts byte 0
+    return fastEmitInst_rr(X86::PSHUFBrr, RC, VecReg,
+                           X86MaterializeV128(0, 0));
+  case FDOpcode::I16X8_SPLAT:
+    VecReg = fastEmitInst_ri(X86::PSHUFLWri, RC, VecReg, 0);
+    return fastEmitInst_ri(X86::PSHUFDri, RC, VecReg, 0);
+  case FDOpcode::I32X4_SPLAT:
+    return fastEmitInst_ri(X86::PSHUFDri, RC, VecReg, 0);
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+CgRegister X86CgLowering::lowerSIMDShift(uint32_t SubOpcode, CgRegister Vec,
+                                         CgRegister Count) {
+  const TargetRegisterClass *RC = &X86::VR128RegClass;
+  unsigned LaneBits;
+  unsigned Opc;
+  switch (SubOpcode) {
+  case FDOpcode::I16X8_SHL:
+    LaneBits = 16;
+    Opc = X86::PSLLWrr;
+    break;
+  case FDOpcode::I16X8_SHR_S:
+    LaneBits = 16;
+    Opc = X86::PSRAWrr;
+    break;
+  case FDOpcode::I16X8_SHR_U:
+    LaneBits = 16;
+    Opc = X86::PSRLWrr;
+    break;
+  case FDOpcode::I32X4_SHL:
+    LaneBits = 32;
+    Opc = X86::PSLLDrr;
+    break;
+  case FDOpcode::I32X4_SHR_S:
+    LaneBits = 32;
+    Opc = X86::PSRADrr;
+    break;
+  case FDOpcode::I32X4_SHR_U:
+    LaneBits = 32;
+    Opc = X86::PSRLDrr;
+    break;
+  case FDOpcode::I64X2_SHL:
+    LaneBits = 64;
+    Opc = X86::PSLLQrr;
+    break;
+  case FDOpcode::I64X2_SHR_S:
+  case FDOpcode::I64X2_SHR_U:
+    LaneBits = 64;
+    Opc = X86::PSRLQrr;
+    break;
+  default:
+    ZEN_UNREACHABLE();
+  }
+
+  // wasm takes the count modulo the lane width, sse saturates instead
+  CgRegister MaskedCount =
+      fastEmitInst_ri(X86::AND32ri8, &X86::GR32RegClass, Count, LaneBits - 1);
+  CgRegister CountVec = fastEmitInst_r(X86::MOVDI2PDIrr, RC, MaskedCount);
+  CgRegister Result = fastEmitInst_rr(Opc, RC, Vec, CountVec);
+  if (SubOpcode != FDOpcode::I64X2_SHR_S) {
+    return Result;
+  }
+
+  // there is no psraq before avx-512, sign-extend the logical shift with
+  // ((x >>> c) ^ m) - m where m = 0x8000000000000000 >>> c
+  CgRegister SignBit = X86MaterializeV128(UINT64_C(1) << 63, UINT64_C(1) << 63);
+  CgRegister Mask = fastEmitInst_rr(X86::PSRLQrr, RC, SignBit, CountVec);
+  Result = fastEmitInst_rr(X86::PXORrr, RC, Result, Mask);
+  return fastEmitInst_rr(X86::PSUBQrr, RC, Result, Mask);
+}
+
+CgRegister X86CgLowering::lowerSIMDI64Mul(CgRegister LHS, CgRegister RHS) {
+  // lo(a) * lo(b) + ((hi(a) * lo(b) + lo(a) * hi(b)) << 32)
+  const TargetRegisterClass *RC = &X86::VR128RegClass;
+  CgRegister LoLo = fastEmitInst_rr(X86::PMULUDQrr, RC, LHS, RHS);
+  CgRegister LHSHi = fastEmitInst_ri(X86::PSRLQri, RC, LHS, 32);
+  CgRegister HiLo = fastEmitInst_rr(X86::PMULUDQrr, RC, LHSHi, RHS);
+  CgRegister RHSHi = fastEmitInst_ri(X86::PSRLQri, RC, RHS, 32);
+  CgRegister LoHi = fastEmitInst_rr(X86::PMULUDQrr, RC, LHS, RHSHi);
+  CgRegister Cross = fastEmitInst_rr(X86::PADDQrr, RC, HiLo, LoHi);
+  Cross = fastEmitInst_ri(X86::PSLLQri, RC, Cross, 32);
+  return fastEmitInst_rr(X86::PADDQrr, RC, LoLo, Cross);
+}
+
+CgRegister X86CgLowering::lowerSIMDBitmask(uint32_t SubOpcode,
+                                           CgRegister Vec) {
+  const TargetRegisterClass *GR32RC = &X86::GR32RegClass;
+  switch (SubOpcode) {
+  case FDOpcode::I8X16_BITMASK:
+    return fastEmitInst_r(X86::PMOVMSKBrr, GR32RC, Vec);
+  case FDOpcode::I16X8_BITMASK: {
+    // the signed saturation keeps the sign of each lane
+    CgRegister Packed =
+        fastEmitInst_rr(X86::PACKSSWBrr, &X86::VR128RegClass, Vec, Vec);
+    CgRegister Mask = fastEmitInst_r(X86::PMOVMSKBrr, GR32RC, Packed);
+    CgRegister Mask8 =
+        fastEmitInst_extractsubreg(MVT::i8, Mask, X86::sub_8bit);
+    return fastEmitInst_r(X86::MOVZX32rr8, GR32RC, Mask8);
+  }
+  case FDOpcode::I32X4_BITMASK:
+    return fastEmitInst_r(X86::MOVMSKPSrr, GR32RC, Vec);
+  case FDOpcode::I64X2_BITMASK:
+    return fastEmitInst_r(X86::MOVMSKPDrr, GR32RC, Vec);
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+// sse has no unsigned or non-strict integer compares, a <= b is
+// min(a, b) == a and a >= b is max(a, b) == a, the strict unsigned compares
+// are the negations of those
+CgRegister X86CgLowering::lowerSIMDCompare(uint32_t SubOpcode, CgRegister LHS,
+                                           CgRegister RHS) {
+  // the min and max of each lane width, signed then unsigned
+  static constexpr unsigned MinOpcodes[3][2] = {
+      {X86::PMINSBrr, X86::PMINUBrr},
+      {X86::PMINSWrr, X86::PMINUWrr},
+      {X86::PMINSDrr, X86::PMINUDrr},
+  };
+  static constexpr unsigned MaxOpcodes[3][2] = {
+      {X86::PMAXSBrr, X86::PMAXUBrr},
+      {X86::PMAXSWrr, X86::PMAXUWrr},
+      {X86::PMAXSDrr, X86::PMAXUDrr},
+  };
+  static constexpr unsigned EqOpcodes[3] = {X86::PCMPEQBrr, X86::PCMPEQWrr,
+                                            X86::PCMPEQDrr};
+  // the compares of each width follow its eq as eq, ne, lt_s, lt_u, gt_s,
+  // gt_u, le_s, le_u, ge_s, ge_u
+  uint32_t WidthIdx;
+  uint32_t CmpIdx;
+  if (SubOpcode >= FDOpcode::I32X4_EQ) {
+    WidthIdx = 2;
+    CmpIdx = SubOpcode - FDOpcode::I32X4_EQ;
+  } else if (SubOpcode >= FDOpcode::I16X8_EQ) {
+    WidthIdx = 1;
+    CmpIdx = SubOpcode - FDOpcode::I16X8_EQ;
+  } else {
+    WidthIdx = 0;
+    CmpIdx = SubOpcode - FDOpcode::I8X16_EQ;
+  }
+  ZEN_ASSERT(CmpIdx == 3 || (CmpIdx >= 5 && CmpIdx <= 9));
+  bool IsUnsigned = CmpIdx % 2 == 1;
+  // lt_u is !(ge_u) and gt_u is !(le_u)
+  bool IsNegated = CmpIdx < 6;
+  bool IsLessEq = CmpIdx == 5 || CmpIdx == 6 || CmpIdx == 7;
+  const TargetRegisterClass *RC = &X86::VR128RegClass;
+  unsigned Opc = IsLessEq ? MinOpcodes[WidthIdx][IsUnsigned]
+                          : MaxOpcodes[WidthIdx][IsUnsigned];
+  CgRegister Bound = fastEmitInst_rr(Opc, RC, LHS, RHS);
+  CgRegister Result = fastEmitInst_rr(EqOpcodes[WidthIdx], RC, Bound, LHS);
+  return IsNegated ? lowerSIMDNot(Result) : Result;
+}
+
+CgRegister X86CgLowering::lowerSIMDExtend(uint32_t SubOpcode,
+                                          CgRegister Vec) {
+  const TargetRegisterClass *RC = &X86::VR128RegClass;
+  unsigned Opc;
+  bool IsHigh;
+  switch (SubOpcode) {
+  case FDOpcode::I16X8_EXTEND_LOW_I8X16_S:
+  case FDOpcode::I16X8_EXTEND_HIGH_I8X16_S:
+    Opc = X86::PMOVSXBWrr;
+    IsHigh = SubOpcode == FDOpcode::I16X8_EXTEND_HIGH_I8X16_S;
+    break;
+  case FDOpcode::I16X8_EXTEND_LOW_I8X16_U:
+  case FDOpcode::I16X8_EXTEND_HIGH_I8X16_U:
+    Opc = X86::PMOVZXBWrr;
+    IsHigh = SubOpcode == FDOpcode::I16X8_EXTEND_HIGH_I8X16_U;
+    break;
+  case FDOpcode::I32X4_EXTEND_LOW_I16X8_S:
+  case FDOpcode::I32X4_EXTEND_HIGH_I16X8_S:
+    Opc = X86::PMOVSXWDrr;
+    IsHigh = SubOpcode == FDOpcode::I32X4_EXTEND_HIGH_I16X8_S;
+    break;
+  case FDOpcode::I32X4_EXTEND_LOW_I16X8_U:
+  case FDOpcode::I32X4_EXTEND_HIGH_I16X8_U:
+    Opc = X86::PMOVZXWDrr;
+    IsHigh = SubOpcode == FDOpcode::I32X4_EXTEND_HIGH_I16X8_U;
+    break;
+  case FDOpcode::I64X2_EXTEND_LOW_I32X4_S:
+  case FDOpcode::I64X2_EXTEND_HIGH_I32X4_S:
+    Opc = X86::PMOVSXDQrr;
+    IsHigh = SubOpcode == FDOpcode::I64X2_EXTEND_HIGH_I32X4_S;
+    break;
+  case FDOpcode::I64X2_EXTEND_LOW_I32X4_U:
+  case FDOpcode::I64X2_EXTEND_HIGH_I32X4_U:
+    Opc = X86::PMOVZXDQrr;
+    IsHigh = SubOpcode == FDOpcode::I64X2_EXTEND_HIGH_I32X4_U;
+    break;
+  default:
+    ZEN_UNREACHABLE();
+  }
+  // pmovsx and pmovzx widen the low 8 bytes, move the high ones down first
+  if (IsHigh) {
+    Vec = fastEmitInst_ri(X86::PSHUFDri, RC, Vec, 0xee);
+  }
+  return fastEmitInst_r(Opc, RC, Vec);
+}
+
+CgRegister X86CgLowering::lowerSIMDTest(CgRegister Vec, unsigned CC) {
+  fastEmitNoDefInst_rr(X86::PTESTrr, Vec, Vec);
+  CgRegister FlagReg = fastEmitInst_i(X86::SETCCr, &X86::GR8RegClass, CC);
+  return fastEmitInst_r(X86::MOVZX32rr8, &X86::GR32RegClass, FlagReg);
+}
+
+CgRegister X86CgLowering::lowerWasmSIMDExpr(const WasmSIMDInstruction &Inst) {
+  const TargetRegisterClass *RC = &X86::VR128RegClass;
+  uint32_t SubOpcode = Inst.getSubOpcode();
+  uint8_t LaneIdx = Inst.getLaneIdx();
+
+  CgRegister Ops[3];
+  for (uint32_t I = 0; I < Inst.getNumOperands(); ++I) {
+    Ops[I] = lowerExpr(*Inst.getOperand(I));
+  }
+
+  if (unsigned Opc = getSIMDBinaryOpcode(SubOpcode)) {
+    return fastEmitInst_rr(Opc, RC, Ops[0], Ops[1]);
+  }
+
+  switch (SubOpcode) {
+  case FDOpcode::V128_CONST:
+    return X86MaterializeV128(Inst.getImm());
+  case FDOpcode::I8X16_SHUFFLE: {
+    // pshufb zeroes the lanes whose mask byte has the top bit set, pick the
+    // lanes of each source separately and merge them
+    const uint8_t *LaneIdxs = Inst.getImm();
+    uint8_t LHSMask[16], RHSMask[16];
+    for (uint32_t I = 0; I < 16; ++I) {
+      LHSMask[I] = LaneIdxs[I] < 16 ? LaneIdxs[I] : 0x80;
+      RHSMask[I] = LaneIdxs[I] < 16 ? 0x80 : LaneIdxs[I] - 16;
+    }
+    CgRegister LHS = fastEmitInst_rr(X86::PSHUFBrr, RC, Ops[0],
+                                     X86MaterializeV128(LHSMask));
+    CgRegister RHS = fastEmitInst_rr(X86::PSHUFBrr, RC, Ops[1],
+                                     X86MaterializeV128(RHSMask));
+    return fastEmitInst_rr(X86::PORrr, RC, LHS, RHS);
+  }
+  case FDOpcode::I8X16_SWIZZLE: {
+    // saturating 0x70 into the indices sets the top bit of those >= 16
+    uint64_t Bias = UINT64_C(0x7070707070707070);
+    CgRegister Idxs = fastEmitInst_rr(X86::PADDUSBrr, RC, Ops[1],
+                                      X86MaterializeV128(Bias, Bias));
+    return fastEmitInst_rr(X86::PSHUFBrr, RC, Ops[0], Idxs);
+  }
+  case FDOpcode::I8X16_SPLAT:
+  case FDOpcode::I16X8_SPLAT:
+  case FDOpcode::I32X4_SPLAT:
+  case FDOpcode::I64X2_SPLAT:
+    return lowerSIMDSplat(SubOpcode, Ops[0]);
+  case FDOpcode::I8X16_EXTRACT_LANE_S: {
+    CgRegister Lane =
+        fastEmitInst_ri(X86::PEXTRBrr, &X86::GR32RegClass, Ops[0], LaneIdx);
+    CgRegister Lane8 = fastEmitInst_extractsubreg(MVT::i8, Lane, X86::sub_8bit);
+    return fastEmitInst_r(X86::MOVSX32rr8, &X86::GR32RegClass, Lane8);
+  }
+  case FDOpcode::I8X16_EXTRACT_LANE_U:
+    return fastEmitInst_ri(X86::PEXTRBrr, &X86::GR32RegClass, Ops[0], LaneIdx);
+  case FDOpcode::I16X8_EXTRACT_LANE_S: {
+    CgRegister Lane =
+        fastEmitInst_ri(X86::PEXTRWrr, &X86::GR32RegClass, Ops[0], LaneIdx);
+    CgRegister Lane16 =
+        fastEmitInst_extractsubreg(MVT::i16, Lane, X86::sub_16bit);
+    return fastEmitInst_r(X86::MOVSX32rr16, &X86::GR32RegClass, Lane16);
+  }
+  case FDOpcode::I16X8_EXTRACT_LANE_U:
+    return fastEmitInst_ri(X86::PEXTRWrr, &X86::GR32RegClass, Ops[0], LaneIdx);
+  case FDOpcode::I32X4_EXTRACT_LANE:
+    return fastEmitInst_ri(X86::PEXTRDrr, &X86::GR32RegClass, Ops[0], LaneIdx);
+  case FDOpcode::I64X2_EXTRACT_LANE:
+    return fastEmitInst_ri(X86::PEXTRQrr, &X86::GR64RegClass, Ops[0], LaneIdx);
+  case FDOpcode::I8X16_REPLACE_LANE:
+    return fastEmitInst_rri(X86::PINSRBrr, RC, Ops[0], Ops[1], LaneIdx);
+  case FDOpcode::I16X8_REPLACE_LANE:
+    return fastEmitInst_rri(X86::PINSRWrr, RC, Ops[0], Ops[1], LaneIdx);
+  case FDOpcode::I32X4_REPLACE_LANE:
+    return fastEmitInst_rri(X86::PINSRDrr, RC, Ops[0], Ops[1], LaneIdx);
+  case FDOpcode::I64X2_REPLACE_LANE:
+    return fastEmitInst_rri(X86::PINSRQrr, RC, Ops[0], Ops[1], LaneIdx);
+  case FDOpcode::I8X16_LT_S:
+    return fastEmitInst_rr(X86::PCMPGTBrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::I16X8_LT_S:
+    return fastEmitInst_rr(X86::PCMPGTWrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::I32X4_LT_S:
+    return fastEmitInst_rr(X86::PCMPGTDrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::I8X16_NE:
+  case FDOpcode::I16X8_NE:
+  case FDOpcode::I32X4_NE:
+  case FDOpcode::I64X2_NE: {
+    unsigned Opc = getSIMDLaneEqOpcode(SubOpcode);
+    return lowerSIMDNot(fastEmitInst_rr(Opc, RC, Ops[0], Ops[1]));
+  }
+  case FDOpcode::V128_NOT:
+    return lowerSIMDNot(Ops[0]);
+  case FDOpcode::V128_ANDNOT:
+    // pandn inverts its first source
+    return fastEmitInst_rr(X86::PANDNrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::V128_BITSELECT: {
+    CgRegister Taken = fastEmitInst_rr(X86::PANDrr, RC, Ops[0], Ops[2]);
+    CgRegister Kept = fastEmitInst_rr(X86::PANDNrr, RC, Ops[2], Ops[1]);
+    return fastEmitInst_rr(X86::PORrr, RC, Taken, Kept);
+  }
+  case FDOpcode::V128_ANY_TRUE:
+    return lowerSIMDTest(Ops[0], X86::COND_NE);
+  case FDOpcode::I8X16_ALL_TRUE:
+  case FDOpcode::I16X8_ALL_TRUE:
+  case FDOpcode::I32X4_ALL_TRUE:
+  case FDOpcode::I64X2_ALL_TRUE: {
+    // all lanes are non-zero iff no lane compares equal to zero
+    unsigned Opc = getSIMDLaneEqOpcode(SubOpcode);
+    CgRegister ZeroLanes =
+        fastEmitInst_rr(Opc, RC, Ops[0], X86MaterializeV128(0, 0));
+    return lowerSIMDTest(ZeroLanes, X86::COND_E);
+  }
+  case FDOpcode::I8X16_BITMASK:
+  case FDOpcode::I16X8_BITMASK:
+  case FDOpcode::I32X4_BITMASK:
+  case FDOpcode::I64X2_BITMASK:
+    return lowerSIMDBitmask(SubOpcode, Ops[0]);
+  case FDOpcode::I8X16_ABS:
+    return fastEmitInst_r(X86::PABSBrr, RC, Ops[0]);
+  case FDOpcode::I16X8_ABS:
+    return fastEmitInst_r(X86::PABSWrr, RC, Ops[0]);
+  case FDOpcode::I32X4_ABS:
+    return fastEmitInst_r(X86::PABSDrr, RC, Ops[0]);
+  case FDOpcode::I8X16_NEG:
+    return fastEmitInst_rr(X86::PSUBBrr, RC, X86MaterializeV128(0, 0), Ops[0]);
+  case FDOpcode::I16X8_NEG:
+    return fastEmitInst_rr(X86::PSUBWrr, RC, X86MaterializeV128(0, 0), Ops[0]);
+  case FDOpcode::I32X4_NEG:
+    return fastEmitInst_rr(X86::PSUBDrr, RC, X86MaterializeV128(0, 0), Ops[0]);
+  case FDOpcode::I64X2_NEG:
+    return fastEmitInst_rr(X86::PSUBQrr, RC, X86MaterializeV128(0, 0), Ops[0]);
+  case FDOpcode::I16X8_SHL:
+  case FDOpcode::I16X8_SHR_S:
+  case FDOpcode::I16X8_SHR_U:
+  case FDOpcode::I32X4_SHL:
+  case FDOpcode::I32X4_SHR_S:
+  case FDOpcode::I32X4_SHR_U:
+  case FDOpcode::I64X2_SHL:
+  case FDOpcode::I64X2_SHR_S:
+  case FDOpcode::I64X2_SHR_U:
+    return lowerSIMDShift(SubOpcode, Ops[0], Ops[1]);
+  case FDOpcode::I64X2_MUL:
+    return lowerSIMDI64Mul(Ops[0], Ops[1]);
+  case FDOpcode::I8X16_LT_U:
+  case FDOpcode::I8X16_GT_U:
+  case FDOpcode::I8X16_LE_S:
+  case FDOpcode::I8X16_LE_U:
+  case FDOpcode::I8X16_GE_S:
+  case FDOpcode::I8X16_GE_U:
+  case FDOpcode::I16X8_LT_U:
+  case FDOpcode::I16X8_GT_U:
+  case FDOpcode::I16X8_LE_S:
+  case FDOpcode::I16X8_LE_U:
+  case FDOpcode::I16X8_GE_S:
+  case FDOpcode::I16X8_GE_U:
+  case FDOpcode::I32X4_LT_U:
+  case FDOpcode::I32X4_GT_U:
+  case FDOpcode::I32X4_LE_S:
+  case FDOpcode::I32X4_LE_U:
+  case FDOpcode::I32X4_GE_S:
+  case FDOpcode::I32X4_GE_U:
+    return lowerSIMDCompare(SubOpcode, Ops[0], Ops[1]);
+  case FDOpcode::I16X8_EXTEND_LOW_I8X16_S:
+  case FDOpcode::I16X8_EXTEND_HIGH_I8X16_S:
+  case FDOpcode::I16X8_EXTEND_LOW_I8X16_U:
+  case FDOpcode::I16X8_EXTEND_HIGH_I8X16_U:
+  case FDOpcode::I32X4_EXTEND_LOW_I16X8_S:
+  case FDOpcode::I32X4_EXTEND_HIGH_I16X8_S:
+  case FDOpcode::I32X4_EXTEND_LOW_I16X8_U:
+  case FDOpcode::I32X4_EXTEND_HIGH_I16X8_U:
+  case FDOpcode::I64X2_EXTEND_LOW_I32X4_S:
+  case FDOpcode::I64X2_EXTEND_HIGH_I32X4_S:
+  case FDOpcode::I64X2_EXTEND_LOW_I32X4_U:
+  case FDOpcode::I64X2_EXTEND_HIGH_I32X4_U:
+    return lowerSIMDExtend(SubOpcode, Ops[0]);
+  // the frontend loads the scalar of v128.load32_zero and load64_zero
+  case FDOpcode::V128_LOAD32_ZERO:
+    return fastEmitInst_r(X86::MOVDI2PDIrr, RC, Ops[0]);
+  case FDOpcode::V128_LOAD64_ZERO:
+    return fastEmitInst_r(X86::MOV64toPQIrr, RC, Ops[0]);
+  case FDOpcode::F32X4_ABS: {
+    uint64_t Mask = UINT64_C(0x7fffffff7fffffff);
+    return fastEmitInst_rr(X86::PANDrr, RC, Ops[0],
+                           X86MaterializeV128(Mask, Mask));
+  }
+  case FDOpcode::F64X2_ABS: {
+    uint64_t Mask = UINT64_C(0x7fffffffffffffff);
+    return fastEmitInst_rr(X86::PANDrr, RC, Ops[0],
+                           X86MaterializeV128(Mask, Mask));
+  }
+  case FDOpcode::F32X4_NEG: {
+    uint64_t SignBits = UINT64_C(0x8000000080000000);
+    return fastEmitInst_rr(X86::PXORrr, RC, Ops[0],
+                           X86MaterializeV128(SignBits, SignBits));
+  }
+  case FDOpcode::F64X2_NEG: {
+    uint64_t SignBit = UINT64_C(1) << 63;
+    return fastEmitInst_rr(X86::PXORrr, RC, Ops[0],
+                           X86MaterializeV128(SignBit, SignBit));
+  }
+  case FDOpcode::F32X4_SQRT:
+    return fastEmitInst_r(X86::SQRTPSr, RC, Ops[0]);
+  case FDOpcode::F64X2_SQRT:
+    return fastEmitInst_r(X86::SQRTPDr, RC, Ops[0]);
+  // pmin(a, b) is b < a ? b : a, which minps computes with b as the
+  // destination, pmax(a, b) is a < b ? b : a, the same for maxps
+  case FDOpcode::F32X4_PMIN:
+    return fastEmitInst_rr(X86::MINPSrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::F32X4_PMAX:
+    return fastEmitInst_rr(X86::MAXPSrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::F64X2_PMIN:
+    return fastEmitInst_rr(X86::MINPDrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::F64X2_PMAX:
+    return fastEmitInst_rr(X86::MAXPDrr, RC, Ops[1], Ops[0]);
+  case FDOpcode::I64X2_EXTMUL_LOW_I32X4_S:
+  case FDOpcode::I64X2_EXTMUL_HIGH_I32X4_S:
+  case FDOpcode::I64X2_EXTMUL_LOW_I32X4_U:
+  case FDOpcode::I64X2_EXTMUL_HIGH_I32X4_U: {
+    // move the source lanes into the even dwords that pmul(u)dq reads
+    bool IsLow = SubOpcode == FDOpcode::I64X2_EXTMUL_LOW_I32X4_S ||
+                 SubOpcode == FDOpcode::I64X2_EXTMUL_LOW_I32X4_U;
+    bool IsSigned = SubOpcode == FDOpcode::I64X2_EXTMUL_LOW_I32X4_S ||
+                    SubOpcode == FDOpcode::I64X2_EXTMUL_HIGH_I32X4_S;
+    uint64_t Shuffle = IsLow ? 0x50 : 0xfa;
+    CgRegister LHS = fastEmitInst_ri(X86::PSHUFDri, RC, Ops[0], Shuffle);
+    CgRegister RHS = fastEmitInst_ri(X86::PSHUFDri, RC, Ops[1], Shuffle);
+    unsigned Opc = IsSigned ? X86::PMULDQrr : X86::PMULUDQrr;
+    return fastEmitInst_rr(Opc, RC, LHS, RHS);
+  }
+  default:
+    // rejected by the function loader
+    ZEN_UNREACHABLE();
+  }
+}
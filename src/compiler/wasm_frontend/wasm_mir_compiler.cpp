@@ -11,11 +11,13 @@ namespace COMPILER {
 
 WasmFrontendContext::WasmFrontendContext(runtime::Module &WasmMod)
     : UseSoftMemCheck(WasmMod.checkUseSoftLinearMemoryCheck()),
+      UseFixedMemBase(WasmMod.checkUseFixedLinearMemoryBase()),
       WasmMod(WasmMod) {}
 
 WasmFrontendContext::WasmFrontendContext(const WasmFrontendContext &OtherCtx)
     : CompileContext(OtherCtx),
       UseSoftMemCheck(OtherCtx.WasmMod.checkUseSoftLinearMemoryCheck()),
+      UseFixedMemBase(OtherCtx.WasmMod.checkUseFixedLinearMemoryBase()),
       WasmMod(OtherCtx.WasmMod) {}
 
 MType *WasmFrontendContext::getMIRTypeFromWASMType(WASMType Type) {
@@ -32,6 +34,8 @@ MType *WasmFrontendContext::getMIRTypeFromWASMType(WASMType Type) {
     return &F32Type;
   case WASMType::F64:
     return &F64Type;
+  case WASMType::V128:
+    return &V128Type;
   case WASMType::VOID:
     return &VoidType;
   default:
@@ -54,6 +58,8 @@ WASMType WasmFrontendContext::getWASMTypeFromMIRType(MType *Type) {
     return WASMType::F32;
   case MType::Kind::F64:
     return WASMType::F64;
+  case MType::Kind::V128:
+    return WASMType::V128;
   case MType::Kind::VOID:
     return WASMType::VOID;
   default:
@@ -77,7 +83,8 @@ void buildAllMIRFuncTypes(WasmFrontendContext &Context, MModule &MMod,
       MParamTypes[J + 1] = Context.getMIRTypeFromWASMType(ParamTypes[J]);
     }
     MType *MRetType = Context.getMIRTypeFromWASMType(
-        FuncType->NumReturns > 0 ? FuncType->ReturnTypes[0] : WASMType::VOID);
+        FuncType->NumReturns > 0 ? FuncType->getReturnTypes()[0]
+                                 : WASMType::VOID);
     MMod.addFuncType(MFunctionType::create(Context, *MRetType, MParamTypes));
   }
 }
@@ -95,40 +102,62 @@ void FunctionMirBuilder::initFunction(
     [[maybe_unused]] CompilerContext *Context) {
   const runtime::TypeEntry &Type = Ctx.getWasmFuncType();
   const runtime::CodeEntry &Code = Ctx.getWasmFuncCode();
-  WASMType RetType = Type.getReturnType();
 
   // Create and enter the entry basic block
   setInsertBlock(createBasicBlock());
 
   for (uint32_t I = 0; I < Code.NumLocals; ++I) {
     WASMType Type = (WASMType)Code.LocalTypes[I];
-    MType *MTy = Ctx.getMIRTypeFromWASMType(Type);
+    Variable *Var = CurFunc->createVariable(Ctx.getMIRTypeFromWASMType(Type));
+    setLocalToZero(Var->getVarIdx(), Type);
+  }
 
-    Variable *Var = CurFunc->createVariable(MTy);
+  MBasicBlock *ReturnBB = createBasicBlock();
+  enterBlock(CtrlBlockKind::FUNC_ENTRY, Type, {}, 0, ReturnBB);
 
-    MConstant *Constant = nullptr;
-    if (Type == WASMType::I32 || Type == WASMType::I64) {
-      Constant = MConstantInt::get(Ctx, *MTy, 0);
-    } else if (Type == WASMType::F32) {
-      Constant = MConstantFloat::get(Ctx, *MTy, float(0));
-    } else if (Type == WASMType::F64) {
-      Constant = MConstantFloat::get(Ctx, *MTy, double(0));
-    } else {
-      throw getErrorWithPhase(ErrorCode::UnexpectedType,
-                              ErrorPhase::Compilation,
-                              ErrorSubphase::MIREmission);
-    }
+  loadWASMInstanceAttr();
 
-    MInstruction *ConstInst =
-        createInstruction<ConstantInstruction>(false, MTy, *Constant);
-    createInstruction<DassignInstruction>(true, &Ctx.VoidType, ConstInst,
-                                          Var->getVarIdx());
+  // self tail calls jump here after resetting the parameters and locals
+  if (Code.Stats & Module::SF_self_tail_call) {
+    FuncBodyBB = createBasicBlock();
+    createInstruction<BrInstruction>(true, Ctx, FuncBodyBB);
+    addSuccessor(FuncBodyBB);
+    setInsertBlock(FuncBodyBB);
   }
 
-  MBasicBlock *ReturnBB = createBasicBlock();
-  enterBlock(CtrlBlockKind::FUNC_ENTRY, RetType, 0, ReturnBB);
+  if (Ctx.getWasmMod().isFunctionProfilingEnabled()) {
+    addFunctionCounter(offsetof(runtime::FunctionCounters, Calls),
+                       createIntConstInstruction(&Ctx.I64Type, 1));
+  }
+}
 
-  loadWASMInstanceAttr();
+void FunctionMirBuilder::setLocalToZero(VariableIdx VarIdx, WASMType Type) {
+  MType *MTy = Ctx.getMIRTypeFromWASMType(Type);
+  if (Type == WASMType::V128) {
+    MInstruction *ZeroInst = createInstruction<WasmSIMDInstruction>(
+        false, MTy, common::FDOpcode::V128_CONST,
+        llvm::ArrayRef<MInstruction *>());
+    createInstruction<DassignInstruction>(true, &Ctx.VoidType, ZeroInst,
+                                          VarIdx);
+    return;
+  }
+
+  MConstant *Constant = nullptr;
+  if (Type == WASMType::I32 || Type == WASMType::I64) {
+    Constant = MConstantInt::get(Ctx, *MTy, 0);
+  } else if (Type == WASMType::F32) {
+    Constant = MConstantFloat::get(Ctx, *MTy, float(0));
+  } else if (Type == WASMType::F64) {
+    Constant = MConstantFloat::get(Ctx, *MTy, double(0));
+  } else {
+    throw getErrorWithPhase(ErrorCode::UnexpectedType, ErrorPhase::Compilation,
+                            ErrorSubphase::MIREmission);
+  }
+
+  MInstruction *ConstInst =
+      createInstruction<ConstantInstruction>(false, MTy, *Constant);
+  createInstruction<DassignInstruction>(true, &Ctx.VoidType, ConstInst,
+                                        VarIdx);
 }
 
 void FunctionMirBuilder::loadWASMInstanceAttr() {
@@ -255,28 +284,30 @@ void FunctionMirBuilder::finalizeFunctionBase() {
   };
 
   auto ReturnZero = [&]() {
-    Operand Ret;
-    WASMType WType =
-        static_cast<WASMType>(Ctx.getWasmFuncType().ReturnTypes[0]);
-    switch (WType) {
-    case WASMType::I32:
-      Ret = handleConst<WASMType::I32>(0);
-      break;
-    case WASMType::I64:
-      Ret = handleConst<WASMType::I64>(0);
-      break;
-    case WASMType::F32:
-      Ret = handleConst<WASMType::F32>(0);
-      break;
-    case WASMType::F64:
-      Ret = handleConst<WASMType::F64>(0);
-      break;
-    case WASMType::VOID:
-      break;
-    default:
-      ZEN_ABORT();
+    const runtime::TypeEntry &FuncType = Ctx.getWasmFuncType();
+    std::vector<Operand> Rets;
+    for (uint32_t I = 0; I < FuncType.NumReturns; ++I) {
+      switch (FuncType.getReturnTypes()[I]) {
+      case WASMType::I32:
+        Rets.push_back(handleConst<WASMType::I32>(0));
+        break;
+      case WASMType::I64:
+        Rets.push_back(handleConst<WASMType::I64>(0));
+        break;
+      case WASMType::F32:
+        Rets.push_back(handleConst<WASMType::F32>(0));
+        break;
+      case WASMType::F64:
+        Rets.push_back(handleConst<WASMType::F64>(0));
+        break;
+      case WASMType::V128:
+        Rets.push_back(handleSIMDConst(nullptr));
+        break;
+      default:
+        ZEN_ABORT();
+      }
     }
-    handleReturn(Ret);
+    handleReturn(Rets);
   };
 
 #if defined(ZEN_ENABLE_CPU_EXCEPTION) && !defined(ZEN_ENABLE_DWASM)
@@ -350,6 +381,21 @@ void FunctionMirBuilder::makeAssignment(WASMType Type, const Operand &LHS,
                                         Var->getVarIdx());
 }
 
+bool FunctionMirBuilder::getConstIntOperand(const Operand &Opnd,
+                                            uint64_t &Value) {
+  MInstruction *Instr = Opnd.getInstr();
+  if (!Instr || Instr->getKind() != MInstruction::Kind::CONSTANT) {
+    return false;
+  }
+  const MConstant &Constant =
+      static_cast<ConstantInstruction *>(Instr)->getConstant();
+  if (!Constant.getType().isInteger()) {
+    return false;
+  }
+  Value = llvm::cast<MConstantInt>(Constant).getValue().getZExtValue();
+  return true;
+}
+
 MInstruction *FunctionMirBuilder::extractOperand(const Operand &Opnd) {
   if (Opnd.isEmpty()) {
     return nullptr;
@@ -376,23 +422,38 @@ void FunctionMirBuilder::handleUnreachable() {
   addUniqueSuccessor(UnreachableBB);
 }
 
-void FunctionMirBuilder::handleBlock(WASMType Type, uint32_t StackSize) {
+// the params of a block stay as they are, only the results are assigned
+void FunctionMirBuilder::handleBlock(const TypeEntry &Type,
+                                     const std::vector<Operand> &Params,
+                                     uint32_t StackSize) {
   MBasicBlock *EndBlock = createBasicBlock();
-  enterBlock(CtrlBlockKind::BLOCK, Type, StackSize, EndBlock);
+  enterBlock(CtrlBlockKind::BLOCK, Type, Params, StackSize, EndBlock);
 }
 
-void FunctionMirBuilder::handleLoop(WASMType Type, uint32_t StackSize) {
+void FunctionMirBuilder::handleLoop(const TypeEntry &Type,
+                                    const std::vector<Operand> &Params,
+                                    uint32_t StackSize) {
+  std::vector<Operand> ParamVars = copyBlockParams(Params);
   MBasicBlock *LoopBlock = createBasicBlock();
   MBasicBlock *EndBlock = createBasicBlock();
   createInstruction<BrInstruction>(true, Ctx, LoopBlock);
   addSuccessor(LoopBlock);
 
-  enterBlock(CtrlBlockKind::LOOP, Type, StackSize, LoopBlock, EndBlock);
+  enterBlock(CtrlBlockKind::LOOP, Type, std::move(ParamVars), StackSize,
+             LoopBlock, EndBlock);
   setInsertBlock(LoopBlock);
+
+  // the back edges branch to the loop block too
+  if (Ctx.getWasmMod().isFunctionProfilingEnabled()) {
+    addFunctionCounter(offsetof(runtime::FunctionCounters, LoopIterations),
+                       createIntConstInstruction(&Ctx.I64Type, 1));
+  }
 }
 
-void FunctionMirBuilder::handleIf(Operand CondOp, WASMType Type,
+void FunctionMirBuilder::handleIf(Operand CondOp, const TypeEntry &Type,
+                                  const std::vector<Operand> &Params,
                                   uint32_t StackSize) {
+  std::vector<Operand> ParamVars = copyBlockParams(Params);
   MInstruction *Condition = extractOperand(CondOp);
   MBasicBlock *ThenBlock = createBasicBlock();
   MBasicBlock *EndBlock = createBasicBlock();
@@ -401,7 +462,8 @@ void FunctionMirBuilder::handleIf(Operand CondOp, WASMType Type,
   addSuccessor(ThenBlock);
   addSuccessor(EndBlock);
 
-  enterBlock(CtrlBlockKind::IF, Type, StackSize, EndBlock, nullptr, BranchInst);
+  enterBlock(CtrlBlockKind::IF, Type, std::move(ParamVars), StackSize,
+             EndBlock, nullptr, BranchInst);
   setInsertBlock(ThenBlock);
 }
 
@@ -457,7 +519,8 @@ void FunctionMirBuilder::handleBranchIf(Operand CondOp, uint32_t Level,
 }
 
 void FunctionMirBuilder::handleBranchTable(
-    Operand Index, Operand StackTop, const std::vector<uint32_t> &Levels) {
+    Operand Index, const std::vector<Operand> &StackTops,
+    const std::vector<uint32_t> &Levels) {
   // Remove duplicate levels and create target basic blocks for them
   CompileUnorderedSet<uint32_t> LevelsSet(Levels.begin(), Levels.end(),
                                           Levels.size(), Ctx.MemPool);
@@ -468,17 +531,8 @@ void FunctionMirBuilder::handleBranchTable(
     BlockMap.emplace(Level, createBasicBlock());
   }
 
-  // Save stack top value into the variable
-  MInstruction *StackTopVarInstr = nullptr;
-  if (!StackTop.isEmpty()) {
-    MType *StackTopType = Ctx.getMIRTypeFromWASMType(StackTop.getType());
-    Variable *StackTopVar = CurFunc->createVariable(StackTopType);
-    MInstruction *RawStackTop = extractOperand(StackTop);
-    createInstruction<DassignInstruction>(true, &(Ctx.VoidType), RawStackTop,
-                                          StackTopVar->getVarIdx());
-    StackTopVarInstr = createInstruction<DreadInstruction>(
-        false, StackTopType, StackTopVar->getVarIdx());
-  }
+  // Save stack top values into the variables, each target reads them
+  std::vector<Operand> StackTopVars = copyBlockParams(StackTops);
 
   uint32_t TableSize = Levels.size() - 1;
   MBasicBlock *DefaultBlock = BlockMap[Levels[TableSize]];
@@ -509,16 +563,19 @@ void FunctionMirBuilder::handleBranchTable(
   for (const uint32_t Level : NewLevels) {
     setInsertBlock(BlockMap[Level]);
     const auto &Info = getBlockInfo(Level);
-    if (Info.getType() != WASMType::VOID &&
-        Info.getKind() != CtrlBlockKind::LOOP) {
-      makeAssignment(Info.getType(), Info.getResult(),
-                     Operand(StackTopVarInstr, StackTop.getType()));
+    // a branch to a loop passes the params, to other blocks the results
+    const std::vector<Operand> &Targets =
+        Info.getKind() == CtrlBlockKind::LOOP ? Info.getParams()
+                                              : Info.getResults();
+    ZEN_ASSERT(Targets.size() == StackTopVars.size());
+    for (size_t I = 0; I < Targets.size(); ++I) {
+      makeAssignment(Targets[I].getType(), Targets[I], StackTopVars[I]);
     }
     handleBranch(Level, Info);
   }
 }
 
-void FunctionMirBuilder::handleReturn(Operand Opnd) {
+void FunctionMirBuilder::updateStackCostOnReturn() {
 #ifdef ZEN_ENABLE_DWASM
   const auto &Layout = Ctx.getWasmMod().getLayout();
   MInstruction *StackCost =
@@ -529,13 +586,35 @@ void FunctionMirBuilder::handleReturn(Operand Opnd) {
       false, OP_sub, &Ctx.I32Type, StackCost, CurFuncStackCost);
   setInstanceElement(&Ctx.I32Type, NewStackCost, Layout.StackCostOffset);
 #endif
+}
 
-  MInstruction *Ret = extractOperand(Opnd);
-  MType *Type = Ret ? Ret->getType() : &Ctx.VoidType;
-  createInstruction<ReturnInstruction>(true, Type, Ret);
+// the results of a multi-value signature not returned in registers are
+// stored to the results buffer, see JITReturnAllocator
+void FunctionMirBuilder::handleReturn(const std::vector<Operand> &Results) {
+  updateStackCostOnReturn();
+
+  const auto &Layout = Ctx.getWasmMod().getLayout();
+  const runtime::TypeEntry &Type = Ctx.getWasmFuncType();
+  ZEN_ASSERT(Results.size() == Type.NumReturns);
+  std::vector<runtime::JITReturnLocation> Locations =
+      runtime::JITReturnAllocator::allocate(Type.getReturnTypes(),
+                                            Type.NumReturns);
+  CompileVector<MInstruction *> Rets(Ctx.MemPool);
+  for (size_t I = 0; I < Results.size(); ++I) {
+    MInstruction *Ret = extractOperand(Results[I]);
+    if (Locations[I].InReg) {
+      Rets.push_back(Ret);
+    } else {
+      setInstanceElement(Ret->getType(), Ret,
+                         Layout.ResultsBufferBaseOffset + Locations[I].Index);
+    }
+  }
+  MType *RetType = Rets.empty() ? &Ctx.VoidType : Rets[0]->getType();
+  createInstruction<ReturnInstruction>(
+      true, RetType, llvm::ArrayRef<MInstruction *>(Rets.data(), Rets.size()));
 }
 
-FunctionMirBuilder::Operand FunctionMirBuilder::handleCall(
+std::vector<FunctionMirBuilder::Operand> FunctionMirBuilder::handleCall(
     uint32_t FuncIdx, uintptr_t Target, bool IsImport, bool FarCall,
     const ArgumentInfo &ArgInfo, const std::vector<Operand> &Args) {
 
@@ -550,9 +629,103 @@ FunctionMirBuilder::Operand FunctionMirBuilder::handleCall(
   }
 }
 
-FunctionMirBuilder::Operand FunctionMirBuilder::handleCallIndirect(
-    uint32_t TypeIdx, Operand IndirectFuncIdxOp, uint32_t TblIdx,
+void FunctionMirBuilder::handleReturnCall(uint32_t FuncIdx, uintptr_t Target,
+                                          bool IsImport, bool FarCall,
+                                          const ArgumentInfo &ArgInfo,
+                                          const std::vector<Operand> &Args) {
+  // a host function returns to the current function, which checks the
+  // exception, so its frame is only kept for the duration of the call
+  if (IsImport) {
+    handleReturn(handleCall(FuncIdx, Target, IsImport, FarCall, ArgInfo, Args));
+    return;
+  }
+
+  FuncIdx -= Ctx.getWasmMod().getNumImportFunctions();
+  if (FuncIdx != Ctx.getCurFuncIdx()) {
+    handleTailCallBase<CallInstruction>(FuncIdx, ArgInfo, Args);
+    return;
+  }
+  ZEN_ASSERT(FuncBodyBB);
+
+  /**
+   *  $arg_i = ...
+   *  $param_i = $arg_i
+   *  $local_i = 0
+   *  br @func_body
+   */
+
+  // all the arguments are evaluated before any parameter is overwritten
+  std::vector<VariableIdx> ArgVarIdxs;
+  for (const Operand &Arg : Args) {
+    Variable *ArgVar =
+        CurFunc->createVariable(Ctx.getMIRTypeFromWASMType(Arg.getType()));
+    createInstruction<DassignInstruction>(
+        true, &Ctx.VoidType, extractOperand(Arg), ArgVar->getVarIdx());
+    ArgVarIdxs.push_back(ArgVar->getVarIdx());
+  }
+  for (uint32_t I = 0; I < ArgVarIdxs.size(); ++I) {
+    MType *MTy = CurFunc->getVariableType(ArgVarIdxs[I]);
+    MInstruction *ArgVal =
+        createInstruction<DreadInstruction>(false, MTy, ArgVarIdxs[I]);
+    // skip instance
+    createInstruction<DassignInstruction>(true, &Ctx.VoidType, ArgVal, I + 1);
+  }
+
+  const runtime::CodeEntry &Code = Ctx.getWasmFuncCode();
+  uint32_t FirstLocalIdx = Ctx.getWasmFuncType().NumParams + 1;
+  for (uint32_t I = 0; I < Code.NumLocals; ++I) {
+    setLocalToZero(FirstLocalIdx + I, (WASMType)Code.LocalTypes[I]);
+  }
+
+  createInstruction<BrInstruction>(true, Ctx, FuncBodyBB);
+  addSuccessor(FuncBodyBB);
+}
+
+void FunctionMirBuilder::handleReturnCallIndirect(
+    uint32_t TypeIdx, Operand IndirectFuncIdx, uint32_t TblIdx,
+    const ArgumentInfo &ArgInfo, const std::vector<Operand> &Args) {
+  handleCallIndirectBase(TypeIdx, IndirectFuncIdx, TblIdx, ArgInfo, Args,
+                         true);
+}
+
+std::vector<FunctionMirBuilder::Operand>
+FunctionMirBuilder::handleCallIndirect(
+    uint32_t TypeIdx, Operand IndirectFuncIdx, uint32_t TblIdx,
     const ArgumentInfo &ArgInfo, const std::vector<Operand> &Args) {
+  return handleCallIndirectBase(TypeIdx, IndirectFuncIdx, TblIdx, ArgInfo,
+                                Args, false);
+}
+
+// a tail call ends the current block, so no result is returned then
+std::vector<FunctionMirBuilder::Operand>
+FunctionMirBuilder::handleCallIndirectBase(
+    uint32_t TypeIdx, Operand IndirectFuncIdxOp, uint32_t TblIdx,
+    const ArgumentInfo &ArgInfo, const std::vector<Operand> &Args,
+    bool IsTailCall) {
+  const runtime::Module &Mod = Ctx.getWasmMod();
+
+  // devirtualize when the table element is known at compile time and has the
+  // expected type, otherwise the checks below raise the exception
+  uint64_t ConstIdx = 0;
+  if (getConstIntOperand(IndirectFuncIdxOp, ConstIdx)) {
+    uint32_t FuncIdx =
+        Mod.getStaticTableElem(TblIdx, static_cast<uint32_t>(ConstIdx));
+    if (FuncIdx != -1u && Mod.getFunctionTypeIdx(FuncIdx) == TypeIdx) {
+      bool IsImport = FuncIdx < Mod.getNumImportFunctions();
+      uintptr_t Target =
+          IsImport ? uintptr_t(Mod.getImportFunction(FuncIdx).FuncPtr) : 0;
+      if (!IsTailCall) {
+        return handleCall(FuncIdx, Target, IsImport, false, ArgInfo, Args);
+      }
+      if (IsImport) {
+        handleReturn(handleCall(FuncIdx, Target, true, false, ArgInfo, Args));
+      } else {
+        handleTailCallBase<CallInstruction>(
+            FuncIdx - Mod.getNumImportFunctions(), ArgInfo, Args);
+      }
+      return {};
+    }
+  }
 
   MInstruction *IndirectFuncIdx = extractOperand(IndirectFuncIdxOp);
   MInstruction *ResuableIndirectFuncIdx =
@@ -588,6 +761,71 @@ FunctionMirBuilder::Operand FunctionMirBuilder::handleCallIndirect(
       Ctx.getWasmMod().getLayout().TableElemBaseOffset);
   MInstruction *ReusableFuncIdx = makeReusableValue(FuncIdx, &Ctx.I32Type);
 
+  /**
+   *  when all the functions of type_idx in the table are known:
+   *
+   *  br_if cmp ieq ($func_idx, target_0), @call_target_0, @next_0
+   *  @call_target_0:
+   *    $result = call target_0 (...)
+   *    br @end
+   *  @next_0:
+   *  ...
+   */
+
+  const auto *Targets = Mod.getIndirectCallTargets(TblIdx, TypeIdx);
+  std::vector<Operand> ResultVars;
+  MBasicBlock *EndBB = nullptr;
+  std::vector<Operand> CallArgs(Args);
+  auto FinishCall = [&](const std::vector<Operand> &Results) {
+    ZEN_ASSERT(Results.size() == ResultVars.size());
+    for (size_t I = 0; I < Results.size(); ++I) {
+      makeAssignment(Results[I].getType(), ResultVars[I], Results[I]);
+    }
+    createInstruction<BrInstruction>(true, Ctx, EndBB);
+    addSuccessor(EndBB);
+  };
+
+  if (Targets) {
+    // the tail calls of the targets end their blocks
+    if (!IsTailCall) {
+      const WASMType *ReturnTypes = ArgInfo.getReturnTypes();
+      for (uint32_t I = 0; I < ArgInfo.getNumReturns(); ++I) {
+        ResultVars.push_back(createTempStackOperand(ReturnTypes[I]));
+      }
+      EndBB = createBasicBlock();
+    }
+    // every path passes the same arguments
+    for (Operand &Arg : CallArgs) {
+      if (!Arg.getVar()) {
+        Variable *Var =
+            CurFunc->createVariable(Ctx.getMIRTypeFromWASMType(Arg.getType()));
+        createInstruction<DassignInstruction>(
+            true, &Ctx.VoidType, extractOperand(Arg), Var->getVarIdx());
+        Arg = Operand(Var, Arg.getType());
+      }
+    }
+
+    for (uint32_t Target : *Targets) {
+      MInstruction *IsTarget = createInstruction<CmpInstruction>(
+          false, CmpInstruction::ICMP_EQ, &Ctx.I8Type, ReusableFuncIdx,
+          createIntConstInstruction(&Ctx.I32Type, Target));
+      MBasicBlock *CallBB = createBasicBlock();
+      MBasicBlock *NextBB = createBasicBlock();
+      createInstruction<BrIfInstruction>(true, Ctx, IsTarget, CallBB, NextBB);
+      addSuccessor(CallBB);
+      addSuccessor(NextBB);
+
+      setInsertBlock(CallBB);
+      if (IsTailCall) {
+        handleTailCallBase<CallInstruction>(
+            Target - Mod.getNumImportFunctions(), ArgInfo, CallArgs);
+      } else {
+        FinishCall(handleCall(Target, 0, false, false, ArgInfo, CallArgs));
+      }
+      setInsertBlock(NextBB);
+    }
+  }
+
   /**
    *  br_if cmp ieq ($func_idx, -1), @uninitialized_element
    */
@@ -638,7 +876,19 @@ FunctionMirBuilder::Operand FunctionMirBuilder::handleCallIndirect(
   MInstruction *FuncAddr =
       getInstanceElement(&Ctx.I64Type, sizeof(uintptr_t), ReusableFuncIdx,
                          Ctx.getWasmMod().getLayout().FuncPtrsBaseOffset);
-  return handleCallBase<ICallInstruction>(FuncAddr, ArgInfo, Args, true);
+  if (IsTailCall) {
+    handleTailCallBase<ICallInstruction>(FuncAddr, ArgInfo, CallArgs);
+    return {};
+  }
+  std::vector<Operand> Results =
+      handleCallBase<ICallInstruction>(FuncAddr, ArgInfo, CallArgs, true);
+  if (!Targets) {
+    return Results;
+  }
+
+  FinishCall(Results);
+  setInsertBlock(EndBB);
+  return ResultVars;
 }
 
 void FunctionMirBuilder::checkCallException(bool IsImportOrIndirect) {
@@ -755,6 +1005,420 @@ FunctionMirBuilder::Operand FunctionMirBuilder::handleMemoryGrow(Operand Opnd) {
   return Operand(PrevNumPages, WASMType::I32);
 }
 
+void FunctionMirBuilder::handleMemoryInit(uint32_t DataIdx, Operand Dst,
+                                          Operand Src, Operand Len) {
+  callBulkMemoryHelper(uintptr_t(Instance::initMemoryOnJIT),
+                       {createIntConstInstruction(&Ctx.I32Type, DataIdx),
+                        extractOperand(Dst), extractOperand(Src),
+                        extractOperand(Len)});
+}
+
+void FunctionMirBuilder::handleDataDrop(uint32_t DataIdx) {
+  callBulkMemoryHelper(uintptr_t(Instance::dropDataSegmentOnJIT),
+                       {createIntConstInstruction(&Ctx.I32Type, DataIdx)});
+}
+
+// small constant sizes become a single load and store, the rest call the
+// runtime
+void FunctionMirBuilder::handleMemoryCopy(Operand Dst, Operand Src,
+                                          Operand Len) {
+  uint64_t Size = 0;
+  if (getConstIntOperand(Len, Size)) {
+    switch (Size) {
+    case 1:
+      return inlineMemoryCopy<WASMType::I32, WASMType::I8>(Dst, Src);
+    case 2:
+      return inlineMemoryCopy<WASMType::I32, WASMType::I16>(Dst, Src);
+    case 4:
+      return inlineMemoryCopy<WASMType::I32, WASMType::I32>(Dst, Src);
+    case 8:
+      return inlineMemoryCopy<WASMType::I64, WASMType::I64>(Dst, Src);
+    default:
+      break;
+    }
+  }
+  callBulkMemoryHelper(uintptr_t(Instance::copyMemoryOnJIT),
+                       {extractOperand(Dst), extractOperand(Src),
+                        extractOperand(Len)});
+}
+
+void FunctionMirBuilder::handleMemoryFill(Operand Dst, Operand Val,
+                                          Operand Len) {
+  uint64_t Size = 0;
+  uint64_t Byte = 0;
+  if (getConstIntOperand(Len, Size) && getConstIntOperand(Val, Byte)) {
+    uint64_t Pattern = uint8_t(Byte) * 0x0101010101010101ULL;
+    switch (Size) {
+    case 1:
+      return inlineMemoryFill<WASMType::I32, WASMType::I8>(Dst, Pattern);
+    case 2:
+      return inlineMemoryFill<WASMType::I32, WASMType::I16>(Dst, Pattern);
+    case 4:
+      return inlineMemoryFill<WASMType::I32, WASMType::I32>(Dst, Pattern);
+    case 8:
+      return inlineMemoryFill<WASMType::I64, WASMType::I64>(Dst, Pattern);
+    default:
+      break;
+    }
+  }
+  callBulkMemoryHelper(uintptr_t(Instance::fillMemoryOnJIT),
+                       {extractOperand(Dst), extractOperand(Val),
+                        extractOperand(Len)});
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleMemcpyIntrinsic(Operand Dst, Operand Src,
+                                          Operand Len) {
+  Operand Result = makeReusableOperand(Dst);
+  handleMemoryCopy(Dst, Src, Len);
+  return Result;
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleMemsetIntrinsic(Operand Dst, Operand Val,
+                                          Operand Len) {
+  Operand Result = makeReusableOperand(Dst);
+  handleMemoryFill(Dst, Val, Len);
+  return Result;
+}
+
+bool FunctionMirBuilder::canInlineMemcmpIntrinsic(Operand Len) const {
+  uint64_t Size = 0;
+  return getConstIntOperand(Len, Size) &&
+         (Size == 1 || Size == 2 || Size == 4 || Size == 8);
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleMemcmpIntrinsic(Operand LHS, Operand RHS,
+                                          Operand Len) {
+  uint64_t Size = 0;
+  getConstIntOperand(Len, Size);
+  switch (Size) {
+  case 1:
+    return inlineMemoryCompare<WASMType::I32, WASMType::I8>(LHS, RHS);
+  case 2:
+    return inlineMemoryCompare<WASMType::I32, WASMType::I16>(LHS, RHS);
+  case 4:
+    return inlineMemoryCompare<WASMType::I32, WASMType::I32>(LHS, RHS);
+  case 8:
+    return inlineMemoryCompare<WASMType::I64, WASMType::I64>(LHS, RHS);
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+// a byte loop, the loads trap at the end of the memory like the runtime
+// routine does for an unterminated string. the gas of the length and the
+// terminator is charged after the loop
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleStrlenIntrinsic(Operand Str) {
+  MType *I32Type = &Ctx.I32Type;
+  Operand Start = makeReusableOperand(Str);
+  Variable *PtrVar = CurFunc->createVariable(I32Type);
+  VariableIdx PtrVarIdx = PtrVar->getVarIdx();
+  createInstruction<DassignInstruction>(true, &Ctx.VoidType,
+                                        extractOperand(Str), PtrVarIdx);
+
+  MBasicBlock *LoopBB = createBasicBlock();
+  MBasicBlock *EndBB = createBasicBlock();
+  createInstruction<BrInstruction>(true, Ctx, LoopBB);
+  addSuccessor(LoopBB);
+  setInsertBlock(LoopBB);
+
+  // the loaded byte is kept in a variable before the pointer is advanced
+  Operand Byte = handleLoad<WASMType::I32, WASMType::I8, false>(
+      Operand(PtrVar, WASMType::I32), 0, 0);
+  MInstruction *Ptr =
+      createInstruction<DreadInstruction>(false, I32Type, PtrVarIdx);
+  MInstruction *NextPtr = createInstruction<BinaryInstruction>(
+      false, OP_add, I32Type, Ptr, createIntConstInstruction(I32Type, 1));
+  createInstruction<DassignInstruction>(true, &Ctx.VoidType, NextPtr,
+                                        PtrVarIdx);
+  MInstruction *IsEnd = createInstruction<CmpInstruction>(
+      false, CmpInstruction::ICMP_EQ, &Ctx.I8Type, extractOperand(Byte),
+      createIntConstInstruction(I32Type, 0));
+  createInstruction<BrIfInstruction>(true, Ctx, IsEnd, EndBB, LoopBB);
+  addSuccessor(EndBB);
+  addSuccessor(LoopBB);
+  setInsertBlock(EndBB);
+
+  // the pointer is past the terminator
+  MInstruction *EndPtr =
+      createInstruction<DreadInstruction>(false, I32Type, PtrVarIdx);
+  Variable *SizeVar = CurFunc->createVariable(I32Type);
+  VariableIdx SizeVarIdx = SizeVar->getVarIdx();
+  createInstruction<DassignInstruction>(
+      true, &Ctx.VoidType,
+      createInstruction<BinaryInstruction>(false, OP_sub, I32Type, EndPtr,
+                                           extractOperand(Start)),
+      SizeVarIdx);
+  if (Ctx.getWasmMod().getGasFuncIdx() != -1u) {
+    // common::getBulkMemoryGas of the size
+    MType *I64Type = &Ctx.I64Type;
+    MInstruction *Size = createInstruction<ConversionInstruction>(
+        false, OP_uext, I64Type,
+        createInstruction<DreadInstruction>(false, I32Type, SizeVarIdx));
+    MInstruction *Words = createInstruction<BinaryInstruction>(
+        false, OP_add, I64Type, Size,
+        createIntConstInstruction(I64Type,
+                                  common::BulkMemoryGasWordSize - 1));
+    Words = createInstruction<BinaryInstruction>(
+        false, OP_udiv, I64Type, Words,
+        createIntConstInstruction(I64Type, common::BulkMemoryGasWordSize));
+    MInstruction *Cost = createInstruction<BinaryInstruction>(
+        false, OP_mul, I64Type, Words,
+        createIntConstInstruction(I64Type, common::BulkMemoryGasPerWord));
+    handleGasCall(Operand(Cost, WASMType::I64));
+  }
+  MInstruction *Len = createInstruction<BinaryInstruction>(
+      false, OP_sub, I32Type,
+      createInstruction<DreadInstruction>(false, I32Type, SizeVarIdx),
+      createIntConstInstruction(I32Type, 1));
+  return Operand(Len, WASMType::I32);
+}
+
+// the gas is charged and the operands are loaded before anything is stored,
+// as the operands may overlap the destination
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleU256Intrinsic(runtime::HostapiIntrinsic Intrinsic,
+                                        Operand Dst, Operand LHS,
+                                        Operand RHS) {
+  using runtime::HostapiIntrinsic;
+  ZEN_ASSERT(Intrinsic == HostapiIntrinsic::u256_add ||
+             Intrinsic == HostapiIntrinsic::u256_sub);
+  if (Ctx.getWasmMod().getGasFuncIdx() != -1u) {
+    MInstruction *Cost = createIntConstInstruction(
+        &Ctx.I64Type, runtime::getHostapiIntrinsicGas(Intrinsic));
+    handleGasCall(Operand(Cost, WASMType::I64));
+  }
+  U256Limbs LHSLimbs = loadU256(LHS);
+  U256Limbs RHSLimbs = loadU256(RHS);
+  U256Limbs ResLimbs;
+  MInstruction *Flag =
+      inlineU256AddSub(Intrinsic == HostapiIntrinsic::u256_sub, ResLimbs,
+                       LHSLimbs, RHSLimbs);
+  // the flag is kept in a variable rather than as a tree on the stack
+  MInstruction *Result = makeReusableValue(
+      createInstruction<ConversionInstruction>(false, OP_trunc, &Ctx.I32Type,
+                                               Flag),
+      &Ctx.I32Type);
+  storeU256(Dst, ResLimbs);
+  return Operand(Result, WASMType::I32);
+}
+
+FunctionMirBuilder::U256Limbs FunctionMirBuilder::loadU256(Operand Base) {
+  MType *I64Type = &Ctx.I64Type;
+  U256Limbs Limbs;
+  for (uint32_t I = 0; I < Limbs.size(); ++I) {
+    Operand Addr = I + 1 < Limbs.size() ? makeReusableOperand(Base) : Base;
+    const auto [MemoryBase, MemoryIndex, MemoryOffset] =
+        getMemoryLocation(extractOperand(Addr), I * 8, I64Type);
+    Limbs[I] = createI64Var(createInstruction<LoadInstruction>(
+        false, I64Type, I64Type, MemoryBase, 1, MemoryIndex, MemoryOffset,
+        false));
+  }
+  return Limbs;
+}
+
+void FunctionMirBuilder::storeU256(Operand Base, const U256Limbs &Limbs) {
+  for (uint32_t I = Limbs.size(); I-- > 0;) {
+    Operand Addr = I > 0 ? makeReusableOperand(Base) : Base;
+    handleStore<WASMType::I64>(Operand(readI64Var(Limbs[I]), WASMType::I64),
+                               Addr, I * 8, 0);
+  }
+}
+
+VariableIdx FunctionMirBuilder::createI64Var(MInstruction *Value) {
+  VariableIdx VarIdx = CurFunc->createVariable(&Ctx.I64Type)->getVarIdx();
+  createInstruction<DassignInstruction>(true, &Ctx.VoidType, Value, VarIdx);
+  return VarIdx;
+}
+
+MInstruction *
+FunctionMirBuilder::createI64Compare(CmpInstruction::Predicate Predicate,
+                                     MInstruction *LHS, MInstruction *RHS) {
+  MInstruction *Cmp = createInstruction<CmpInstruction>(
+      false, Predicate, &Ctx.I32Type, LHS, RHS);
+  return createInstruction<ConversionInstruction>(false, OP_uext,
+                                                  &Ctx.I64Type, Cmp);
+}
+
+// the carry of each limb is (Sum < LHS) | (Sum + CarryIn < Sum), and the
+// borrow is (LHS < RHS) | (Diff < BorrowIn)
+MInstruction *FunctionMirBuilder::inlineU256AddSub(bool IsSub, U256Limbs &Res,
+                                                   const U256Limbs &LHS,
+                                                   const U256Limbs &RHS) {
+  Opcode Opc = IsSub ? OP_sub : OP_add;
+  VariableIdx Carry = VariableIdx(-1);
+  for (uint32_t I = 0; I < Res.size(); ++I) {
+    VariableIdx Partial = createI64Var(
+        createI64BinaryOp(Opc, readI64Var(LHS[I]), readI64Var(RHS[I])));
+    MInstruction *CarryOut =
+        IsSub ? createI64Compare(CmpInstruction::ICMP_ULT, readI64Var(LHS[I]),
+                                 readI64Var(RHS[I]))
+              : createI64Compare(CmpInstruction::ICMP_ULT,
+                                 readI64Var(Partial), readI64Var(LHS[I]));
+    if (Carry == VariableIdx(-1)) {
+      Res[I] = Partial;
+    } else {
+      Res[I] = createI64Var(
+          createI64BinaryOp(Opc, readI64Var(Partial), readI64Var(Carry)));
+      MInstruction *CarryOut2 =
+          IsSub ? createI64Compare(CmpInstruction::ICMP_ULT,
+                                   readI64Var(Partial), readI64Var(Carry))
+                : createI64Compare(CmpInstruction::ICMP_ULT,
+                                   readI64Var(Res[I]), readI64Var(Partial));
+      CarryOut = createI64BinaryOp(OP_or, CarryOut, CarryOut2);
+    }
+    Carry = createI64Var(CarryOut);
+  }
+  return readI64Var(Carry);
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::makeReusableOperand(Operand &Opnd) {
+  if (Opnd.getVar()) {
+    return Opnd;
+  }
+  // a constant is duplicated, so the address can still be folded
+  uint64_t Value = 0;
+  MType *Type = Ctx.getMIRTypeFromWASMType(Opnd.getType());
+  if (getConstIntOperand(Opnd, Value)) {
+    return Operand(createIntConstInstruction(Type, Value), Opnd.getType());
+  }
+  Variable *Var = CurFunc->createVariable(Type);
+  createInstruction<DassignInstruction>(true, &Ctx.VoidType,
+                                        extractOperand(Opnd), Var->getVarIdx());
+  Opnd = Operand(Var, Opnd.getType());
+  return Opnd;
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleSIMDLoad(Operand Base, uint32_t Offset,
+                                   [[maybe_unused]] uint32_t Align) {
+  MInstruction *BaseInst = extractOperand(Base);
+  const auto [MemoryBase, MemoryIndex, MemoryOffset] =
+      getMemoryLocation(BaseInst, Offset, &Ctx.V128Type);
+  MInstruction *Value = createInstruction<LoadInstruction>(
+      false, &Ctx.V128Type, &Ctx.V128Type, MemoryBase, 1, MemoryIndex,
+      MemoryOffset, false);
+  return Operand(protectUnsafeValue(Value, &Ctx.V128Type), WASMType::V128);
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleSIMDScalarLoad(uint32_t SubOpcode, Operand Base,
+                                         uint32_t Offset, uint32_t Align) {
+  using common::FDOpcode;
+  auto Widen = [&](uint32_t WidenOpcode, Operand Scalar) {
+    return handleSIMDOp(WidenOpcode, WASMType::V128, {Scalar}, 0, nullptr);
+  };
+  switch (SubOpcode) {
+  case FDOpcode::V128_LOAD8_SPLAT:
+    return Widen(FDOpcode::I8X16_SPLAT,
+                 handleLoad<WASMType::I32, WASMType::I8, false>(Base, Offset,
+                                                                Align));
+  case FDOpcode::V128_LOAD16_SPLAT:
+    return Widen(FDOpcode::I16X8_SPLAT,
+                 handleLoad<WASMType::I32, WASMType::I16, false>(Base, Offset,
+                                                                 Align));
+  case FDOpcode::V128_LOAD32_SPLAT:
+    return Widen(FDOpcode::I32X4_SPLAT,
+                 handleLoad<WASMType::I32, WASMType::I32, false>(Base, Offset,
+                                                                 Align));
+  case FDOpcode::V128_LOAD64_SPLAT:
+    return Widen(FDOpcode::I64X2_SPLAT,
+                 handleLoad<WASMType::I64, WASMType::I64, false>(Base, Offset,
+                                                                 Align));
+  case FDOpcode::V128_LOAD32_ZERO:
+    // the zero loads are their own widening ops, from a scalar operand
+    return Widen(FDOpcode::V128_LOAD32_ZERO,
+                 handleLoad<WASMType::I32, WASMType::I32, false>(Base, Offset,
+                                                                 Align));
+  default:
+    break;
+  }
+
+  Operand Low = Widen(FDOpcode::V128_LOAD64_ZERO,
+                      handleLoad<WASMType::I64, WASMType::I64, false>(
+                          Base, Offset, Align));
+  switch (SubOpcode) {
+  case FDOpcode::V128_LOAD64_ZERO:
+    return Low;
+  case FDOpcode::V128_LOAD8X8_S:
+    return Widen(FDOpcode::I16X8_EXTEND_LOW_I8X16_S, Low);
+  case FDOpcode::V128_LOAD8X8_U:
+    return Widen(FDOpcode::I16X8_EXTEND_LOW_I8X16_U, Low);
+  case FDOpcode::V128_LOAD16X4_S:
+    return Widen(FDOpcode::I32X4_EXTEND_LOW_I16X8_S, Low);
+  case FDOpcode::V128_LOAD16X4_U:
+    return Widen(FDOpcode::I32X4_EXTEND_LOW_I16X8_U, Low);
+  case FDOpcode::V128_LOAD32X2_S:
+    return Widen(FDOpcode::I64X2_EXTEND_LOW_I32X4_S, Low);
+  case FDOpcode::V128_LOAD32X2_U:
+    return Widen(FDOpcode::I64X2_EXTEND_LOW_I32X4_U, Low);
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+void FunctionMirBuilder::handleSIMDStore(Operand Value, Operand Base,
+                                         uint32_t Offset,
+                                         [[maybe_unused]] uint32_t Align) {
+  MInstruction *ValueInst = extractOperand(Value);
+  MInstruction *BaseInst = extractOperand(Base);
+  const auto [MemoryBase, MemoryIndex, MemoryOffset] =
+      getMemoryLocation(BaseInst, Offset, &Ctx.V128Type);
+  createInstruction<StoreInstruction>(true, &Ctx.VoidType, ValueInst,
+                                      MemoryBase, 1, MemoryIndex,
+                                      MemoryOffset);
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleSIMDConst(const uint8_t *Bytes) {
+  MInstruction *Ret = createInstruction<WasmSIMDInstruction>(
+      false, &Ctx.V128Type, common::FDOpcode::V128_CONST,
+      llvm::ArrayRef<MInstruction *>(), 0, Bytes);
+  return Operand(Ret, WASMType::V128);
+}
+
+FunctionMirBuilder::Operand
+FunctionMirBuilder::handleSIMDOp(uint32_t SubOpcode, WASMType ResultType,
+                                 const std::vector<Operand> &Operands,
+                                 uint8_t LaneIdx, const uint8_t *Imm) {
+  MInstruction *OperandInsts[3];
+  ZEN_ASSERT(Operands.size() <= 3);
+  for (size_t I = 0; I < Operands.size(); ++I) {
+    OperandInsts[I] = extractOperand(Operands[I]);
+  }
+  MType *MTy = Ctx.getMIRTypeFromWASMType(ResultType);
+  MInstruction *Ret = createInstruction<WasmSIMDInstruction>(
+      false, MTy, SubOpcode,
+      llvm::ArrayRef<MInstruction *>(OperandInsts, Operands.size()), LaneIdx,
+      Imm);
+  return Operand(Ret, ResultType);
+}
+
+void FunctionMirBuilder::callBulkMemoryHelper(
+    uintptr_t Helper, std::initializer_list<MInstruction *> Args) {
+  CompileVector<MInstruction *> HelperArgs{{InstanceAddr}, Ctx.MemPool};
+  HelperArgs.insert(HelperArgs.end(), Args.begin(), Args.end());
+
+  MInstruction *HelperAddr =
+      createIntConstInstruction(&Ctx.I64Type, uint64_t(Helper));
+  createInstruction<ICallInstruction>(true, &Ctx.VoidType, HelperAddr,
+                                      HelperArgs);
+  checkCallException(true);
+}
+
+void FunctionMirBuilder::chargeBulkMemoryGas(uint32_t Len) {
+  if (Ctx.getWasmMod().getGasFuncIdx() == -1u) {
+    return;
+  }
+  MInstruction *Cost = createIntConstInstruction(
+      &Ctx.I64Type, common::getBulkMemoryGas(Len));
+  handleGasCall(Operand(Cost, WASMType::I64));
+}
+
 std::tuple<MInstruction *, MInstruction *, int32_t>
 FunctionMirBuilder::getMemoryLocation(MInstruction *Base, uint32_t Offset,
                                       MType *Type) {
@@ -836,9 +1500,12 @@ MInstruction *FunctionMirBuilder::getMemorySize() {
 
 void FunctionMirBuilder::updateMemoryBaseAndSize() {
   if (MemoryBaseIdx != VariableIdx(-1)) {
-    MInstruction *MemoryBase = getMemoryBase();
-    createInstruction<DassignInstruction>(true, &Ctx.VoidType, MemoryBase,
-                                          MemoryBaseIdx);
+    // memory base never changes when the memory is grown in place
+    if (!Ctx.UseFixedMemBase) {
+      MInstruction *MemoryBase = getMemoryBase();
+      createInstruction<DassignInstruction>(true, &Ctx.VoidType, MemoryBase,
+                                            MemoryBaseIdx);
+    }
     // MemorySizeIdx can only be valid if MemoryBaseIdx is valid
     if (MemorySizeIdx != VariableIdx(-1)) {
       MInstruction *MemorySize = getMemorySize();
@@ -869,6 +1536,23 @@ void FunctionMirBuilder::handleGasCall(Operand Delta) {
   MInstruction *NewGasLeft = createInstruction<BinaryInstruction>(
       false, OP_sub, &Ctx.I64Type, GasLeft, DeltaValue);
   setInstanceElement(&Ctx.I64Type, NewGasLeft, Layout.GasOffset);
+
+  if (Ctx.getWasmMod().isFunctionProfilingEnabled()) {
+    addFunctionCounter(offsetof(runtime::FunctionCounters, SelfGas),
+                       extractOperand(Delta));
+  }
+}
+
+void FunctionMirBuilder::addFunctionCounter(size_t FieldOffset,
+                                            MInstruction *Delta) {
+  const auto &Layout = Ctx.getWasmMod().getLayout();
+  uint64_t Offset = Layout.FunctionCountersBaseOffset +
+                    Ctx.getCurFuncIdx() * sizeof(runtime::FunctionCounters) +
+                    FieldOffset;
+  MInstruction *Counter = getInstanceElement(&Ctx.I64Type, Offset);
+  MInstruction *NewCounter = createInstruction<BinaryInstruction>(
+      false, OP_add, &Ctx.I64Type, Counter, Delta);
+  setInstanceElement(&Ctx.I64Type, NewCounter, Offset);
 }
 
 // ==================== MIR Opcode Methods ====================
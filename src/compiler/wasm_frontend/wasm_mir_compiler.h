@@ -10,6 +10,7 @@
 #include "compiler/mir/instructions.h"
 #include "compiler/mir/opcode.h"
 #include "compiler/mir/pointer.h"
+#include <array>
 
 namespace COMPILER {
 
@@ -52,6 +53,9 @@ public:
 
   const bool UseSoftMemCheck;
 
+  // memory base can be loaded only once in function entry
+  const bool UseFixedMemBase;
+
 private:
   runtime::Module &WasmMod;
   uint32_t CurFuncIdx = -1; // exclude imported functions
@@ -99,17 +103,19 @@ public:
   // Record each nested block
   class BlockInfo {
   public:
-    BlockInfo(CtrlBlockKind Kind, Operand Result, uint32_t StackSize,
+    BlockInfo(CtrlBlockKind Kind, std::vector<Operand> Params,
+              std::vector<Operand> Results, uint32_t StackSize,
               MBasicBlock *JumpBlock, MBasicBlock *NextBlock,
               BrIfInstruction *BranchInst)
-        : Kind(Kind), Result(Result), StackSize(StackSize),
-          JumpBlock(JumpBlock), NextBlock(NextBlock), BranchInstr(BranchInst) {}
+        : Kind(Kind), Params(std::move(Params)), Results(std::move(Results)),
+          StackSize(StackSize), JumpBlock(JumpBlock), NextBlock(NextBlock),
+          BranchInstr(BranchInst) {}
 
     CtrlBlockKind getKind() const { return Kind; }
 
-    Operand getResult() const { return Result; }
+    const std::vector<Operand> &getParams() const { return Params; }
 
-    WASMType getType() const { return Result.getType(); }
+    const std::vector<Operand> &getResults() const { return Results; }
 
     uint32_t getStackSize() const { return StackSize; }
 
@@ -128,7 +134,8 @@ public:
 
   private:
     CtrlBlockKind Kind;
-    Operand Result;
+    std::vector<Operand> Params;
+    std::vector<Operand> Results;
     uint32_t StackSize;
     MBasicBlock *JumpBlock = nullptr;
     MBasicBlock *NextBlock = nullptr;
@@ -140,7 +147,8 @@ public:
   public:
     ArgumentInfo(const TypeEntry *Type) {
       ZEN_ASSERT(Type);
-      RetType = Type->getReturnType();
+      NumReturns = Type->NumReturns;
+      ReturnTypes = Type->getReturnTypes();
       uint32_t NumParams = Type->NumParams;
       // Reserve 1 slot for instance
       ArgTypes.resize(NumParams + 1);
@@ -149,11 +157,20 @@ public:
                   NumParams * sizeof(WASMType));
     }
 
-    WASMType getReturnType() const { return RetType; }
+    // the type of the call instruction, the other results are returned as
+    // in JITReturnAllocator
+    WASMType getReturnType() const {
+      return NumReturns > 0 ? ReturnTypes[0] : WASMType::VOID;
+    }
+
+    uint32_t getNumReturns() const { return NumReturns; }
+
+    const WASMType *getReturnTypes() const { return ReturnTypes; }
 
   private:
     std::vector<WASMType> ArgTypes;
-    WASMType RetType;
+    uint32_t NumReturns;
+    const WASMType *ReturnTypes;
   };
 
   bool compile(CompilerContext *Context);
@@ -170,6 +187,11 @@ public:
   /* Do nothing, only used to match WASMByteVisitor */
   void releaseOperand(Operand Opnd) {}
 
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  /* Do nothing, only used to match WASMByteVisitor */
+  void handleInstructionStart(uint32_t BytecodeOffset) {}
+#endif
+
   const BlockInfo &getBlockInfo(uint32_t Level);
 
   BlockInfo &getCurrentBlockInfo();
@@ -178,11 +200,14 @@ public:
 
   void handleUnreachable();
 
-  void handleBlock(WASMType Type, uint32_t Estack);
+  void handleBlock(const TypeEntry &Type, const std::vector<Operand> &Params,
+                   uint32_t Estack);
 
-  void handleLoop(WASMType Type, uint32_t Estack);
+  void handleLoop(const TypeEntry &Type, const std::vector<Operand> &Params,
+                  uint32_t Estack);
 
-  void handleIf(Operand CondOp, WASMType Type, uint32_t Estack);
+  void handleIf(Operand CondOp, const TypeEntry &Type,
+                const std::vector<Operand> &Params, uint32_t Estack);
 
   void handleElse(const BlockInfo &Info);
 
@@ -192,17 +217,30 @@ public:
 
   void handleBranchIf(Operand CondOp, uint32_t Level, const BlockInfo &Info);
 
-  void handleBranchTable(Operand Index, Operand StackTop,
+  void handleBranchTable(Operand Index, const std::vector<Operand> &StackTops,
                          const std::vector<uint32_t> &Levels);
 
-  void handleReturn(Operand Opnd);
-
-  Operand handleCall(uint32_t FuncIdx, uintptr_t TarGet, bool IsImport,
-                     bool FarCall, const ArgumentInfo &ArgInfo,
-                     const std::vector<Operand> &Args);
-  Operand handleCallIndirect(uint32_t TypeIdx, Operand IndirectFuncIdx,
-                             uint32_t TblIdx, const ArgumentInfo &ArgInfo,
-                             const std::vector<Operand> &Args);
+  void handleReturn(const std::vector<Operand> &Results);
+
+  std::vector<Operand> handleCall(uint32_t FuncIdx, uintptr_t TarGet,
+                                  bool IsImport, bool FarCall,
+                                  const ArgumentInfo &ArgInfo,
+                                  const std::vector<Operand> &Args);
+  std::vector<Operand> handleCallIndirect(uint32_t TypeIdx,
+                                          Operand IndirectFuncIdx,
+                                          uint32_t TblIdx,
+                                          const ArgumentInfo &ArgInfo,
+                                          const std::vector<Operand> &Args);
+
+  // a return call to the function itself restarts its body, other wasm
+  // callees are jumped to by a tail call, host functions are called and
+  // their result is returned
+  void handleReturnCall(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
+                        bool FarCall, const ArgumentInfo &ArgInfo,
+                        const std::vector<Operand> &Args);
+  void handleReturnCallIndirect(uint32_t TypeIdx, Operand IndirectFuncIdx,
+                                uint32_t TblIdx, const ArgumentInfo &ArgInfo,
+                                const std::vector<Operand> &Args);
 
   // ==================== Parametric Instruction Handlers ====================
 
@@ -235,6 +273,13 @@ public:
     return Operand(SafeValue, DestType);
   }
 
+  template <WASMType DestType, WASMType SrcType, bool Sext>
+  Operand handleFusedGetLocalLoad(uint32_t LocalIdx, uint32_t Offset,
+                                  uint32_t Align) {
+    return handleLoad<DestType, SrcType, Sext>(handleGetLocal(LocalIdx), Offset,
+                                               Align);
+  }
+
   // Store to memory in DestType
   template <WASMType DestType>
   void handleStore(Operand Value, Operand Base, uint32_t Offset,
@@ -259,6 +304,58 @@ public:
 
   Operand handleMemoryGrow(Operand Opnd);
 
+  void handleMemoryInit(uint32_t DataIdx, Operand Dst, Operand Src,
+                        Operand Len);
+
+  void handleDataDrop(uint32_t DataIdx);
+
+  void handleMemoryCopy(Operand Dst, Operand Src, Operand Len);
+
+  void handleMemoryFill(Operand Dst, Operand Val, Operand Len);
+
+  // hostapi intrinsics, a memory.copy or memory.fill returning \p Dst
+  Operand handleMemcpyIntrinsic(Operand Dst, Operand Src, Operand Len);
+
+  Operand handleMemsetIntrinsic(Operand Dst, Operand Val, Operand Len);
+
+  // env.memcmp of a constant size up to 8 bytes is compared inline
+  bool canInlineMemcmpIntrinsic(Operand Len) const;
+
+  Operand handleMemcmpIntrinsic(Operand LHS, Operand RHS, Operand Len);
+
+  bool canInlineStrlenIntrinsic() const { return true; }
+
+  Operand handleStrlenIntrinsic(Operand Str);
+
+  // env.u256_add and sub are expanded on the i64 limbs. the others, mul
+  // included, call the runtime routine, whose 64x64->128 limb products are
+  // single mul or mulx instructions, where mir could only build them from
+  // four 32-bit products
+  bool canInlineU256Intrinsic() const { return true; }
+
+  Operand handleU256Intrinsic(runtime::HostapiIntrinsic Intrinsic, Operand Dst,
+                              Operand LHS, Operand RHS);
+
+  // ==================== SIMD Instruction Handlers ====================
+
+  // v128.load and v128.store, the lane loads and stores are interpreted
+  Operand handleSIMDLoad(Operand Base, uint32_t Offset, uint32_t Align);
+
+  // the splat, zero and extending loads, which load a scalar and widen it
+  // to v128 by the matching simd op
+  Operand handleSIMDScalarLoad(uint32_t SubOpcode, Operand Base,
+                               uint32_t Offset, uint32_t Align);
+
+  void handleSIMDStore(Operand Value, Operand Base, uint32_t Offset,
+                       uint32_t Align);
+
+  // \p Bytes may be null for the zero vector
+  Operand handleSIMDConst(const uint8_t *Bytes);
+
+  Operand handleSIMDOp(uint32_t SubOpcode, WASMType ResultType,
+                       const std::vector<Operand> &Operands, uint8_t LaneIdx,
+                       const uint8_t *Imm);
+
   // ==================== Numeric Instruction Handlers ====================
 
   template <WASMType Ty>
@@ -284,11 +381,12 @@ public:
   }
 
   template <WASMType Type, CompareOperator Opeator>
-  void handleFusedCompareIfa(Operand LHSOp, Operand RHSOp, WASMType VType,
-                             uint32_t StackSize) {
+  void handleFusedCompareIfa(Operand LHSOp, Operand RHSOp,
+                             const TypeEntry &BlockType, uint32_t StackSize) {
+    ZEN_ASSERT(BlockType.NumParams == 0);
     MInstruction *Condition =
         handleCompareImpl<Type, Opeator>(LHSOp, RHSOp, &Ctx.I8Type);
-    handleIf(Operand(Condition, WASMType::I8), VType, StackSize);
+    handleIf(Operand(Condition, WASMType::I8), BlockType, {}, StackSize);
   }
 
   template <WASMType Type, CompareOperator Opeator>
@@ -584,6 +682,103 @@ private:
 
   MInstruction *extractOperand(const Operand &Opnd);
 
+  // \return whether \p Opnd is an integer constant, and its value if so
+  static bool getConstIntOperand(const Operand &Opnd, uint64_t &Value);
+
+  // ==================== Bulk Memory Methods ====================
+
+  // call a runtime helper taking the instance and \p Args, the helper charges
+  // gas and sets the instance exception itself
+  void callBulkMemoryHelper(uintptr_t Helper,
+                            std::initializer_list<MInstruction *> Args);
+
+  // charge the size based gas of an inline bulk memory operation
+  void chargeBulkMemoryGas(uint32_t Len);
+
+  // \return a copy of \p Opnd which can be used along with it, \p Opnd is
+  // moved to a variable if needed. the destination of a hostapi intrinsic is
+  // both the address and the result
+  Operand makeReusableOperand(Operand &Opnd);
+
+  // ==================== U256 Intrinsic Methods ====================
+
+  // the 4 little-endian i64 limbs of a u256 value, each in a variable as the
+  // limbs are read several times
+  using U256Limbs = std::array<VariableIdx, 4>;
+
+  U256Limbs loadU256(Operand Base);
+
+  // the highest limb is stored first, so an out of bounds \p Base traps
+  // before anything is written, like the runtime routine
+  void storeU256(Operand Base, const U256Limbs &Limbs);
+
+  // \return the variable holding \p Value
+  VariableIdx createI64Var(MInstruction *Value);
+
+  MInstruction *readI64Var(VariableIdx VarIdx) {
+    return createInstruction<DreadInstruction>(false, &Ctx.I64Type, VarIdx);
+  }
+
+  MInstruction *createI64BinaryOp(Opcode Opc, MInstruction *LHS,
+                                  MInstruction *RHS) {
+    return createInstruction<BinaryInstruction>(false, Opc, &Ctx.I64Type, LHS,
+                                                RHS);
+  }
+
+  // \return 1 or 0 in i64 as \p Predicate holds for \p LHS and \p RHS
+  MInstruction *createI64Compare(CmpInstruction::Predicate Predicate,
+                                 MInstruction *LHS, MInstruction *RHS);
+
+  // \return the carry or borrow out
+  MInstruction *inlineU256AddSub(bool IsSub, U256Limbs &Res,
+                                 const U256Limbs &LHS, const U256Limbs &RHS);
+
+  // the load traps before anything is stored, like the runtime routine
+  template <WASMType ValType, WASMType MemType>
+  void inlineMemoryCopy(Operand Dst, Operand Src) {
+    chargeBulkMemoryGas(WASMTypeAttr<MemType>::Size);
+    Operand Val = handleLoad<ValType, MemType, false>(Src, 0, 0);
+    handleStore<MemType>(Val, Dst, 0, 0);
+  }
+
+  template <WASMType ValType, WASMType MemType>
+  void inlineMemoryFill(Operand Dst, uint64_t Pattern) {
+    chargeBulkMemoryGas(WASMTypeAttr<MemType>::Size);
+    Operand Val =
+        handleConst<ValType>(typename WASMTypeAttr<ValType>::Type(Pattern));
+    handleStore<MemType>(Val, Dst, 0, 0);
+  }
+
+  // the lowest set bit of X ^ Y is in the first unequal byte, which is the
+  // lowest one as wasm is little endian. when X == Y the shift by the width
+  // is a shift by 0 and both bytes are equal
+  template <WASMType ValType, WASMType MemType>
+  Operand inlineMemoryCompare(Operand LHS, Operand RHS) {
+    using ValueType = typename WASMTypeAttr<ValType>::Type;
+    chargeBulkMemoryGas(WASMTypeAttr<MemType>::Size);
+    Operand X = handleLoad<ValType, MemType, false>(LHS, 0, 0);
+    Operand Y = handleLoad<ValType, MemType, false>(RHS, 0, 0);
+    Operand XCopy = makeReusableOperand(X);
+    Operand YCopy = makeReusableOperand(Y);
+    Operand Diff = handleBinaryOp<ValType, BinaryOperator::BO_XOR>(X, Y);
+    Operand Tz = handleBitCountOp<ValType, UnaryOperator::UO_CTZ>(Diff);
+    Operand Shift = handleBinaryOp<ValType, BinaryOperator::BO_AND>(
+        Tz, handleConst<ValType>(ValueType(~7)));
+    Operand ShiftCopy = makeReusableOperand(Shift);
+    Operand XByte = handleBinaryOp<ValType, BinaryOperator::BO_AND>(
+        handleShift<ValType, BinaryOperator::BO_SHR_U>(XCopy, Shift),
+        handleConst<ValType>(ValueType(0xff)));
+    Operand YByte = handleBinaryOp<ValType, BinaryOperator::BO_AND>(
+        handleShift<ValType, BinaryOperator::BO_SHR_U>(YCopy, ShiftCopy),
+        handleConst<ValType>(ValueType(0xff)));
+    Operand Result =
+        handleBinaryOp<ValType, BinaryOperator::BO_SUB>(XByte, YByte);
+    if constexpr (ValType == WASMType::I64) {
+      return handleIntTrunc(Result);
+    }
+    return Result;
+  }
+
   Operand createTempStackOperand(WASMType Type) {
     MType *Mtype = Ctx.getMIRTypeFromWASMType(Type);
     Variable *TempVar = CurFunc->createVariable(Mtype);
@@ -595,6 +790,8 @@ private:
 
   void loadWASMInstanceAttr();
 
+  void setLocalToZero(VariableIdx VarIdx, WASMType Type);
+
   LoadInstruction *getInstanceElement(MType *ValueType, uint32_t Scale,
                                       MInstruction *Index, uint64_t Offset) {
     MPointerType *ValuePtrType = MPointerType::create(Ctx, *ValueType);
@@ -617,21 +814,41 @@ private:
                                                InstancePtr, Offset);
   }
 
+  // add to a uint64 counter of function profiling
+  void addFunctionCounter(size_t FieldOffset, MInstruction *Delta);
+
   // ==================== Handler Util Methods ====================
 
-  void enterBlock(CtrlBlockKind Kind, WASMType Type, uint32_t StackSize,
+  void enterBlock(CtrlBlockKind Kind, const TypeEntry &Type,
+                  std::vector<Operand> Params, uint32_t StackSize,
                   MBasicBlock *JumpBlock, MBasicBlock *NextBlock = nullptr,
                   BrIfInstruction *BranchInst = nullptr) {
-    auto BlockResult =
-        (Type == WASMType::VOID) ? Operand() : createTempStackOperand(Type);
-    ControlStack.emplace_back(Kind, BlockResult, StackSize, JumpBlock,
-                              NextBlock, BranchInst);
+    std::vector<Operand> Results;
+    const WASMType *ResultTypes = Type.getReturnTypes();
+    for (uint32_t I = 0; I < Type.NumReturns; ++I) {
+      Results.push_back(createTempStackOperand(ResultTypes[I]));
+    }
+    ControlStack.emplace_back(Kind, std::move(Params), std::move(Results),
+                              StackSize, JumpBlock, NextBlock, BranchInst);
+  }
+
+  // copy the block params to variables, which the branches to a loop
+  // assign and both arms of an if read
+  std::vector<Operand> copyBlockParams(const std::vector<Operand> &Params) {
+    std::vector<Operand> Vars;
+    for (const Operand &Param : Params) {
+      Operand Var = createTempStackOperand(Param.getType());
+      makeAssignment(Param.getType(), Var, Param);
+      Vars.push_back(Var);
+    }
+    return Vars;
   }
 
   template <typename CallInst, typename Callee>
-  Operand handleCallBase(Callee FuncInstr, const ArgumentInfo &ArgInfo,
-                         const std::vector<Operand> &Args,
-                         bool IsImportOrIndirect) {
+  std::vector<Operand> handleCallBase(Callee FuncInstr,
+                                      const ArgumentInfo &ArgInfo,
+                                      const std::vector<Operand> &Args,
+                                      bool IsImportOrIndirect) {
     // ensure the first argument is the instance pointer
     CompileVector<MInstruction *> MIRArgs(Args.size() + 1, Ctx.MemPool);
     MIRArgs[0] =
@@ -646,30 +863,79 @@ private:
     /// the CallInstruction is the operand of the DassignInstruction.
     /// 2. call %0 ($0, $1) when function %0 returns void, in which
     /// the CallInstruction is a statement.
+    /// A multi-value call also assigns the other results in the return
+    /// registers to its extra result variables.
     bool IsStmt = Wtype == WASMType::VOID;
-    MInstruction *CallResult =
+    auto *CallResult =
         createInstruction<CallInst>(IsStmt, Mtype, FuncInstr, MIRArgs);
 
-    Variable *ReturnVar = nullptr;
+    uint32_t NumReturns = ArgInfo.getNumReturns();
+    const WASMType *ReturnTypes = ArgInfo.getReturnTypes();
+    std::vector<runtime::JITReturnLocation> Locations =
+        runtime::JITReturnAllocator::allocate(ReturnTypes, NumReturns);
+    std::vector<Variable *> ReturnVars(NumReturns);
+    for (uint32_t I = 1; I < NumReturns; ++I) {
+      if (Locations[I].InReg) {
+        ReturnVars[I] = CurFunc->createVariable(
+            Ctx.getMIRTypeFromWASMType(ReturnTypes[I]));
+        CallResult->addExtraResultVar(ReturnVars[I]->getVarIdx());
+      }
+    }
     if (!IsStmt) {
-      ReturnVar = CurFunc->createVariable(Mtype);
+      ReturnVars[0] = CurFunc->createVariable(Mtype);
       createInstruction<DassignInstruction>(true, &(Ctx.VoidType), CallResult,
-                                            ReturnVar->getVarIdx());
+                                            ReturnVars[0]->getVarIdx());
+    }
+    // the results buffer is read before any later call overwrites it
+    const auto &Layout = Ctx.getWasmMod().getLayout();
+    for (uint32_t I = 1; I < NumReturns; ++I) {
+      if (!Locations[I].InReg) {
+        MType *ResultType = Ctx.getMIRTypeFromWASMType(ReturnTypes[I]);
+        ReturnVars[I] = CurFunc->createVariable(ResultType);
+        MInstruction *Result = getInstanceElement(
+            ResultType, Layout.ResultsBufferBaseOffset + Locations[I].Index);
+        createInstruction<DassignInstruction>(true, &(Ctx.VoidType), Result,
+                                              ReturnVars[I]->getVarIdx());
+      }
     }
 
     checkCallException(IsImportOrIndirect);
     updateMemoryBaseAndSize();
 
-    if (IsStmt) {
-      return Operand();
+    std::vector<Operand> Results;
+    for (uint32_t I = 0; I < NumReturns; ++I) {
+      MType *ResultType = Ctx.getMIRTypeFromWASMType(ReturnTypes[I]);
+      MInstruction *ReturnVal = createInstruction<DreadInstruction>(
+          false, ResultType, ReturnVars[I]->getVarIdx());
+      Results.push_back(Operand(ReturnVal, ReturnTypes[I]));
     }
+    return Results;
+  }
 
-    ZEN_ASSERT(ReturnVar != nullptr);
-    MInstruction *ReturnVal = createInstruction<DreadInstruction>(
-        false, Mtype, ReturnVar->getVarIdx());
-    return Operand(ReturnVal, Wtype);
+  // the callee of a tail call returns to the caller of the current function,
+  // so no exception check or memory update follows it; it returns all the
+  // results of a multi-value signature itself
+  template <typename CallInst, typename Callee>
+  void handleTailCallBase(Callee FuncInstr, const ArgumentInfo &ArgInfo,
+                          const std::vector<Operand> &Args) {
+    CompileVector<MInstruction *> MIRArgs(Args.size() + 1, Ctx.MemPool);
+    MIRArgs[0] =
+        createInstruction<DreadInstruction>(false, createVoidPtrType(), 0);
+    for (size_t I = 0, E = Args.size(); I < E; ++I) {
+      MIRArgs[I + 1] = extractOperand(Args[I]);
+    }
+    updateStackCostOnReturn();
+    MType *Mtype = Ctx.getMIRTypeFromWASMType(ArgInfo.getReturnType());
+    createInstruction<CallInst>(true, Mtype, FuncInstr, MIRArgs, true);
   }
 
+  std::vector<Operand>
+  handleCallIndirectBase(uint32_t TypeIdx, Operand IndirectFuncIdx,
+                         uint32_t TblIdx, const ArgumentInfo &ArgInfo,
+                         const std::vector<Operand> &Args, bool IsTailCall);
+
+  void updateStackCostOnReturn();
+
   void checkCallException(bool IsImportOrIndirect);
 
   // Assign feature values(from local.get/global.get/load/memory.size) to a
@@ -817,6 +1083,8 @@ private:
   MBasicBlock *CurBB = nullptr;
 
   MInstruction *InstanceAddr = nullptr;
+  // start of the function body, after the entry checks
+  MBasicBlock *FuncBodyBB = nullptr;
   // exit wasm func when has exception
   MBasicBlock *ExceptionReturnBB = nullptr;
   bool UseExceptionReturnAfterCall = false;
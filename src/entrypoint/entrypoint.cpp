@@ -8,6 +8,7 @@
 #include "common/errors.h"
 #include "common/type.h"
 #include "runtime/instance.h"
+#include <memory>
 
 namespace zen::entrypoint {
 
@@ -17,6 +18,39 @@ using namespace runtime;
 constexpr const uint32_t MaxIntRegs = 6;
 constexpr const uint32_t MaxFloatRegs = 8;
 
+// rax/rdx and the low 64 bits of xmm0/xmm1, x0/x1 and d0/d1 on aarch64
+constexpr const uint32_t NumReturnRegs =
+    JITReturnAllocator::NumIntRegs + JITReturnAllocator::NumFloatRegs;
+
+namespace {
+
+// reads the results of a multi-value call from the return registers stored by
+// callNative and from the results buffer of \p Inst, see JITReturnAllocator
+void readMultiValueResults(const Instance *Inst, const WASMType *Types,
+                           uint32_t NumTypes, const uint64_t *ReturnRegs,
+                           UntypedValue *Results) {
+  const auto &Layout = Inst->getModule()->getLayout();
+  const uint8_t *Buffer =
+      reinterpret_cast<const uint8_t *>(Inst) + Layout.ResultsBufferBaseOffset;
+  JITReturnAllocator Allocator;
+  for (uint32_t I = 0; I < NumTypes; ++I) {
+    WASMType Type = Types[I];
+    if (Type == WASMType::V128) {
+      ZEN_ASSERT_TODO();
+    }
+    JITReturnLocation Loc = Allocator.next(Type);
+    const void *Src = Buffer + Loc.Index;
+    if (Loc.InReg) {
+      bool IsInt = getWASMTypeKind(Type) == WASMTypeKind::INTEGER;
+      Src = ReturnRegs + (IsInt ? 0 : JITReturnAllocator::NumIntRegs) +
+            Loc.Index;
+    }
+    std::memcpy(&Results[I], Src, getWASMTypeSize(Type));
+  }
+}
+
+} // namespace
+
 void callNativeGeneral(Instance *Instance, GenericFunctionPointer FuncPtr,
                        const std::vector<TypedValue> &Args,
                        std::vector<TypedValue> &Results, SysMemPool *MPool,
@@ -98,25 +132,42 @@ void callNativeGeneral(Instance *Instance, GenericFunctionPointer FuncPtr,
   }
 
   if (Results.empty()) {
-    callNative_Void(FuncPtr, ArgvNative, NumStackArgs, SkipInstanceProcessing);
+    callNative_Void(FuncPtr, ArgvNative, NumStackArgs, SkipInstanceProcessing,
+                    nullptr);
+  } else if (Results.size() > 1) {
+    // only jitted functions return multiple values
+    ZEN_ASSERT(Instance && !SkipInstanceProcessing);
+    uint64_t ReturnRegs[NumReturnRegs];
+    callNative_Void(FuncPtr, ArgvNative, NumStackArgs, SkipInstanceProcessing,
+                    ReturnRegs);
+    std::vector<WASMType> Types;
+    std::vector<UntypedValue> Values(Results.size());
+    for (const TypedValue &Result : Results) {
+      Types.push_back(Result.Type);
+    }
+    readMultiValueResults(Instance, Types.data(), Types.size(), ReturnRegs,
+                          Values.data());
+    for (size_t I = 0; I < Results.size(); ++I) {
+      Results[I].Value = Values[I];
+    }
   } else {
     UntypedValue &Value = Results[0].Value;
     switch (Results[0].Type) {
     case WASMType::I32:
       Value.I32 = callNative_Int32(FuncPtr, ArgvNative, NumStackArgs,
-                                   SkipInstanceProcessing);
+                                   SkipInstanceProcessing, nullptr);
       break;
     case WASMType::I64:
       Value.I64 = callNative_Int64(FuncPtr, ArgvNative, NumStackArgs,
-                                   SkipInstanceProcessing);
+                                   SkipInstanceProcessing, nullptr);
       break;
     case WASMType::F32:
       Value.F32 = callNativeFloat32(FuncPtr, ArgvNative, NumStackArgs,
-                                    SkipInstanceProcessing);
+                                    SkipInstanceProcessing, nullptr);
       break;
     case WASMType::F64:
       Value.F64 = callNativeFloat64(FuncPtr, ArgvNative, NumStackArgs,
-                                    SkipInstanceProcessing);
+                                    SkipInstanceProcessing, nullptr);
       break;
     default:
       ZEN_ASSERT_TODO();
@@ -132,4 +183,137 @@ void callNativeGeneral(Instance *Instance, GenericFunctionPointer FuncPtr,
   }
 }
 
+namespace {
+
+constexpr uint32_t FpArgvBase = 0;
+constexpr uint32_t IntArgvBase = MaxFloatRegs * sizeof(V128) / sizeof(uint64_t);
+constexpr uint32_t StackArgvBase = IntArgvBase + MaxIntRegs;
+
+void invokeVoid(GenericFunctionPointer FuncPtr, uint64_t *Argv,
+                uint64_t NumStackArgs, UntypedValue *) {
+  callNative_Void(FuncPtr, Argv, NumStackArgs, false, nullptr);
+}
+
+void invokeI32(GenericFunctionPointer FuncPtr, uint64_t *Argv,
+               uint64_t NumStackArgs, UntypedValue *Result) {
+  Result->I32 = callNative_Int32(FuncPtr, Argv, NumStackArgs, false, nullptr);
+}
+
+void invokeI64(GenericFunctionPointer FuncPtr, uint64_t *Argv,
+               uint64_t NumStackArgs, UntypedValue *Result) {
+  Result->I64 = callNative_Int64(FuncPtr, Argv, NumStackArgs, false, nullptr);
+}
+
+void invokeF32(GenericFunctionPointer FuncPtr, uint64_t *Argv,
+               uint64_t NumStackArgs, UntypedValue *Result) {
+  Result->F32 = callNativeFloat32(FuncPtr, Argv, NumStackArgs, false, nullptr);
+}
+
+void invokeF64(GenericFunctionPointer FuncPtr, uint64_t *Argv,
+               uint64_t NumStackArgs, UntypedValue *Result) {
+  Result->F64 = callNativeFloat64(FuncPtr, Argv, NumStackArgs, false, nullptr);
+}
+
+} // namespace
+
+NativeCallSignature::NativeCallSignature(const WASMType *ParamTypes,
+                                         uint32_t NumParams,
+                                         const WASMType *ReturnTypes,
+                                         uint32_t NumReturns) {
+  // the same placement as callNativeGeneral, the instance takes the first
+  // integer register
+  uint32_t NumIntArgs = 1;
+  uint32_t NumFpArgs = 0;
+  ArgSlots.reserve(NumParams);
+  for (uint32_t I = 0; I < NumParams; ++I) {
+    WASMType Type = ParamTypes[I];
+    uint32_t Size = getWASMTypeSize(Type);
+    if (Size != 4 && Size != 8) {
+      ArgSlots.clear();
+      NumStackArgs = 0;
+      return;
+    }
+    bool IsFloat = Type == WASMType::F32 || Type == WASMType::F64;
+    uint32_t Index;
+    if (IsFloat && NumFpArgs < MaxFloatRegs) {
+      Index = FpArgvBase + NumFpArgs++ * (sizeof(V128) / sizeof(uint64_t));
+    } else if (!IsFloat && NumIntArgs < MaxIntRegs) {
+      Index = IntArgvBase + NumIntArgs++;
+    } else {
+      Index = StackArgvBase + NumStackArgs++;
+    }
+    ArgSlots.push_back({Index, Size});
+  }
+  ArgvSize = StackArgvBase + NumStackArgs;
+
+  if (NumReturns > 1) {
+    for (uint32_t I = 0; I < NumReturns; ++I) {
+      if (ReturnTypes[I] == WASMType::V128) {
+        return;
+      }
+    }
+    // callNative returns nothing itself, see call
+    MultiReturnTypes.assign(ReturnTypes, ReturnTypes + NumReturns);
+    Invoker = invokeVoid;
+    return;
+  }
+
+  WASMType ReturnType = NumReturns ? ReturnTypes[0] : WASMType::VOID;
+  switch (ReturnType) {
+  case WASMType::VOID:
+    Invoker = invokeVoid;
+    break;
+  case WASMType::I32:
+    Invoker = invokeI32;
+    break;
+  case WASMType::I64:
+    Invoker = invokeI64;
+    break;
+  case WASMType::F32:
+    Invoker = invokeF32;
+    break;
+  case WASMType::F64:
+    Invoker = invokeF64;
+    break;
+  default:
+    // unsupported, Invoker stays null
+    break;
+  }
+}
+
+void NativeCallSignature::call(Instance *Instance,
+                               GenericFunctionPointer FuncPtr,
+                               const UntypedValue *Args,
+                               UntypedValue *Results) const {
+  ZEN_ASSERT(Instance);
+  ZEN_ASSERT(isSupported());
+  uint64_t ArgvBuf[MaxInlineArgvSize];
+  std::unique_ptr<uint64_t[]> ArgvHeap;
+  uint64_t *Argv = ArgvBuf;
+  if (ArgvSize > MaxInlineArgvSize) {
+    ArgvHeap.reset(new uint64_t[ArgvSize]);
+    Argv = ArgvHeap.get();
+  }
+  // unused registers are loaded by callNative as well
+  std::memset(Argv, 0, sizeof(uint64_t) * StackArgvBase);
+  Argv[IntArgvBase] = reinterpret_cast<uintptr_t>(Instance);
+  for (size_t I = 0; I < ArgSlots.size(); ++I) {
+    const ArgSlot &Slot = ArgSlots[I];
+    Argv[Slot.Index] = 0;
+    std::memcpy(Argv + Slot.Index, Args + I, Slot.Size);
+  }
+
+  Runtime *RT = Instance->getRuntime();
+  RT->startCPUTracing();
+  if (MultiReturnTypes.empty()) {
+    Invoker(FuncPtr, Argv, NumStackArgs, Results);
+  } else {
+    uint64_t ReturnRegs[NumReturnRegs];
+    callNative_Void(FuncPtr, Argv, NumStackArgs, false, ReturnRegs);
+    readMultiValueResults(Instance, MultiReturnTypes.data(),
+                          MultiReturnTypes.size(), ReturnRegs, Results);
+  }
+  RT->endCPUTracing();
+}
+
 } // namespace zen::entrypoint
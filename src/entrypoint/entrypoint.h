@@ -9,23 +9,27 @@
 
 #include "common/defines.h"
 #include "common/mem_pool.h"
+#include "common/type.h"
 #include <vector>
 
 extern "C" {
 typedef void (*GenericFunctionPointer)();
+/// \param ReturnRegs if not null, receives the integer and floating-point
+/// return registers of a multi-value call, see JITReturnAllocator
 void callNative(GenericFunctionPointer F, uint64_t *Args, uint64_t NumStackArgs,
-                bool SkipInstanceProcessing);
+                bool SkipInstanceProcessing, uint64_t *ReturnRegs);
 void callNative_end();
 
 typedef double (*Float64FuncPtr)(GenericFunctionPointer, uint64_t *, uint64_t,
-                                 bool);
+                                 bool, uint64_t *);
 typedef float (*Float32FuncPtr)(GenericFunctionPointer, uint64_t *, uint64_t,
-                                bool);
+                                bool, uint64_t *);
 typedef int64_t (*Int64FuncPtr)(GenericFunctionPointer, uint64_t *, uint64_t,
-                                bool);
+                                bool, uint64_t *);
 typedef int32_t (*Int32FuncPtr)(GenericFunctionPointer, uint64_t *, uint64_t,
-                                bool);
-typedef void (*VoidFuncPtr)(GenericFunctionPointer, uint64_t *, uint64_t, bool);
+                                bool, uint64_t *);
+typedef void (*VoidFuncPtr)(GenericFunctionPointer, uint64_t *, uint64_t, bool,
+                            uint64_t *);
 }
 
 static volatile Float64FuncPtr callNativeFloat64 =
@@ -43,6 +47,7 @@ namespace zen {
 
 namespace common {
 struct TypedValue;
+union UntypedValue;
 } // namespace common
 
 namespace runtime {
@@ -58,6 +63,50 @@ void callNativeGeneral(runtime::Instance *Instance,
                        common::SysMemPool *MPool,
                        bool SkipInstProcessing = false);
 
+/// Entry trampoline specialized for one function signature. The placement of
+/// every argument in the argv of callNative and the result reader are
+/// computed once, so calls only copy the raw argument values.
+/// Only scalar params and results are supported, other signatures(v128) are
+/// recorded as unsupported instead of being rejected when the signature is
+/// built, see isSupported.
+class NativeCallSignature {
+public:
+  NativeCallSignature(const common::WASMType *ParamTypes, uint32_t NumParams,
+                      const common::WASMType *ReturnTypes,
+                      uint32_t NumReturns);
+
+  /// callers must check this before call
+  bool isSupported() const { return Invoker != nullptr; }
+
+  /// \param Args one value per param, read according to the param type
+  /// \param Results one value per result of the signature
+  /// \note only allocates if the arguments exceed MaxInlineArgvSize slots
+  void call(runtime::Instance *Instance, GenericFunctionPointer FuncPtr,
+            const common::UntypedValue *Args,
+            common::UntypedValue *Results) const;
+
+  static constexpr uint32_t MaxInlineArgvSize = 64;
+
+private:
+  struct ArgSlot {
+    // index of uint64_t in argv
+    uint32_t Index;
+    // 4 or 8 bytes
+    uint32_t Size;
+  };
+
+  typedef void (*InvokerFn)(GenericFunctionPointer FuncPtr, uint64_t *Argv,
+                            uint64_t NumStackArgs,
+                            common::UntypedValue *Result);
+
+  std::vector<ArgSlot> ArgSlots;
+  uint32_t NumStackArgs = 0;
+  uint32_t ArgvSize = 0;
+  InvokerFn Invoker = nullptr;
+  // only set for multi-value signatures, which are invoked without Invoker
+  std::vector<common::WASMType> MultiReturnTypes;
+};
+
 } // namespace entrypoint
 } // namespace zen
 
@@ -0,0 +1,140 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "runtime/instance.h"
+// Note: must place crypto.h after instance.h to get correct
+// EXPORT_MODULE_NAME
+#include "host/crypto/crypto.h"
+#include "host/crypto/digests.h"
+#include "host/crypto/secp256k1.h"
+
+namespace zen::host {
+
+using namespace crypto;
+
+// gas schedules of the matching ethereum precompiles, the hashes pay a base
+// cost plus a cost per 32-byte word of input
+constexpr uint64_t Keccak256Gas = 30;
+constexpr uint64_t Keccak256WordGas = 6;
+constexpr uint64_t SHA256Gas = 60;
+constexpr uint64_t SHA256WordGas = 12;
+constexpr uint64_t RIPEMD160Gas = 600;
+constexpr uint64_t RIPEMD160WordGas = 120;
+constexpr uint64_t Secp256k1RecoverGas = 3000;
+
+static void *vnmi_init_ctx(VNMIEnv *vmenv, const char *dir_list[],
+                           uint32_t dir_count, const char *envs[],
+                           uint32_t env_count, char *env_buf,
+                           uint32_t env_buf_size, char *argv[], uint32_t argc,
+                           char *argv_buf, uint32_t argv_buf_size) {
+  return nullptr;
+}
+
+static void vnmi_destroy_ctx(VNMIEnv *vmenv, void *ctx) {}
+
+static bool chargeCryptoGas(Instance *Inst, uint64_t Gas, uint64_t WordGas,
+                            uint32_t Len) {
+  uint64_t NumWords = (uint64_t(Len) + 31) / 32;
+  if (!Inst->chargeGas(Gas + NumWords * WordGas)) {
+    Inst->setExceptionByHostapi(
+        common::getError(common::ErrorCode::GasLimitExceeded));
+    return false;
+  }
+  return true;
+}
+
+/// \return the buffer in linear memory after its only bounds check, the
+/// functions read and write it in place, or nullptr with the trap set
+static uint8_t *getCryptoBuffer(Instance *Inst, uint32_t Offset,
+                                uint32_t Size) {
+  if (!Inst->hasMemory()) {
+    Inst->setExceptionByHostapi(
+        common::getError(common::ErrorCode::OutOfBoundsMemory));
+    return nullptr;
+  }
+  if (!Inst->validatedAppAddr(Offset, Size)) {
+    return nullptr;
+  }
+  return static_cast<uint8_t *>(Inst->getNativeMemoryAddr(Offset));
+}
+
+/// Hash [Src, Src + Len) of linear memory with \p HashFn into the
+/// DigestSize bytes at \p Dst, which may overlap the input
+template <size_t DigestSize, typename HashFnT>
+static void hashLinearMemory(Instance *Inst, uint32_t Src, uint32_t Len,
+                             uint32_t Dst, HashFnT HashFn) {
+  const uint8_t *Data = getCryptoBuffer(Inst, Src, Len);
+  if (!Data) {
+    return;
+  }
+  uint8_t *Out = getCryptoBuffer(Inst, Dst, DigestSize);
+  if (!Out) {
+    return;
+  }
+  uint8_t Digest[DigestSize];
+  HashFn(Data, Len, Digest);
+  std::memcpy(Out, Digest, DigestSize);
+}
+
+static void keccak256(Instance *Inst, uint32_t Src, uint32_t Len,
+                      uint32_t Dst) {
+  if (chargeCryptoGas(Inst, Keccak256Gas, Keccak256WordGas, Len)) {
+    hashLinearMemory<Keccak256DigestSize>(Inst, Src, Len, Dst, hashKeccak256);
+  }
+}
+
+static void sha256(Instance *Inst, uint32_t Src, uint32_t Len, uint32_t Dst) {
+  if (chargeCryptoGas(Inst, SHA256Gas, SHA256WordGas, Len)) {
+    hashLinearMemory<SHA256DigestSize>(Inst, Src, Len, Dst, hashSHA256);
+  }
+}
+
+static void ripemd160(Instance *Inst, uint32_t Src, uint32_t Len,
+                      uint32_t Dst) {
+  if (chargeCryptoGas(Inst, RIPEMD160Gas, RIPEMD160WordGas, Len)) {
+    hashLinearMemory<RIPEMD160DigestSize>(Inst, Src, Len, Dst,
+                                          hashRIPEMD160);
+  }
+}
+
+/// Recover the 64-byte public key of the signature r || s at \p Sig over the
+/// 32-byte hash at \p Hash into \p Dst. \return 1 on success, 0 if the
+/// signature is invalid
+static int32_t secp256k1_recover(Instance *Inst, uint32_t Hash, uint32_t Sig,
+                                 uint32_t RecId, uint32_t Dst) {
+  if (!chargeCryptoGas(Inst, Secp256k1RecoverGas, 0, 0)) {
+    return 0;
+  }
+  const uint8_t *HashData = getCryptoBuffer(Inst, Hash, Secp256k1HashSize);
+  if (!HashData) {
+    return 0;
+  }
+  const uint8_t *SigData = getCryptoBuffer(Inst, Sig, Secp256k1SignatureSize);
+  if (!SigData) {
+    return 0;
+  }
+  uint8_t *Out = getCryptoBuffer(Inst, Dst, Secp256k1PubKeySize);
+  if (!Out) {
+    return 0;
+  }
+  uint8_t PubKey[Secp256k1PubKeySize];
+  if (!recoverSecp256k1PubKey(HashData, SigData, RecId, PubKey)) {
+    return 0;
+  }
+  std::memcpy(Out, PubKey, Secp256k1PubKeySize);
+  return 1;
+}
+
+#define FUNCTION_LISTS                                                         \
+  NATIVE_FUNC_ENTRY(keccak256)                                                 \
+  NATIVE_FUNC_ENTRY(sha256)                                                    \
+  NATIVE_FUNC_ENTRY(ripemd160)                                                 \
+  NATIVE_FUNC_ENTRY(secp256k1_recover)
+
+/*
+  the following code are auto generated,
+  don't modify it unless you know it exactly.
+*/
+#include "wni/boilerplate.cpp"
+
+} // namespace zen::host
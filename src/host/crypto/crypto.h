@@ -0,0 +1,18 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_HOST_CRYPTO_CRYPTO_H
+#define ZEN_HOST_CRYPTO_CRYPTO_H
+
+#include "wni/helper.h"
+
+namespace zen::host {
+
+#undef EXPORT_MODULE_NAME
+#define EXPORT_MODULE_NAME crypto
+
+AUTO_GENERATED_FUNCS_DECL
+
+} // namespace zen::host
+
+#endif // ZEN_HOST_CRYPTO_CRYPTO_H
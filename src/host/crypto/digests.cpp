@@ -0,0 +1,418 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "host/crypto/digests.h"
+
+#include <cstring>
+
+#ifdef ZEN_BUILD_TARGET_X86_64
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace zen::host::crypto {
+
+namespace {
+
+inline uint32_t rotl32(uint32_t X, uint32_t N) {
+  return (X << N) | (X >> ((32 - N) & 31));
+}
+
+inline uint32_t rotr32(uint32_t X, uint32_t N) {
+  return (X >> N) | (X << ((32 - N) & 31));
+}
+
+inline uint64_t rotl64(uint64_t X, uint32_t N) {
+  return (X << N) | (X >> ((64 - N) & 63));
+}
+
+// the supported targets are little endian
+inline uint32_t loadLE32(const uint8_t *Ptr) {
+  uint32_t Val;
+  std::memcpy(&Val, Ptr, sizeof(Val));
+  return Val;
+}
+
+inline uint64_t loadLE64(const uint8_t *Ptr) {
+  uint64_t Val;
+  std::memcpy(&Val, Ptr, sizeof(Val));
+  return Val;
+}
+
+inline uint32_t loadBE32(const uint8_t *Ptr) {
+  return __builtin_bswap32(loadLE32(Ptr));
+}
+
+inline void storeBE32(uint8_t *Ptr, uint32_t Val) {
+  Val = __builtin_bswap32(Val);
+  std::memcpy(Ptr, &Val, sizeof(Val));
+}
+
+/// Feed the whole 64-byte blocks of \p Data to \p Compress, then the padded
+/// tail of md4-style hashes, which ends with the bit length in big or little
+/// endian
+template <typename CompressFn>
+void hashMDBlocks(uint32_t *State, const uint8_t *Data, size_t Len,
+                  bool BigEndianLen, CompressFn Compress) {
+  size_t NumBlocks = Len / 64;
+  Compress(State, Data, NumBlocks);
+
+  size_t Rem = Len % 64;
+  uint8_t Tail[128] = {};
+  std::memcpy(Tail, Data + NumBlocks * 64, Rem);
+  Tail[Rem] = 0x80;
+  size_t TailLen = Rem < 56 ? 64 : 128;
+  uint64_t Bits = uint64_t(Len) << 3;
+  for (uint32_t I = 0; I < 8; ++I) {
+    size_t Pos = BigEndianLen ? TailLen - 1 - I : TailLen - 8 + I;
+    Tail[Pos] = uint8_t(Bits >> (I * 8));
+  }
+  Compress(State, Tail, TailLen / 64);
+}
+
+// ==================== Keccak-256 ====================
+
+constexpr size_t KeccakRate = 136;
+
+constexpr uint64_t KeccakRoundConsts[24] = {
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
+    0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
+    0x8000000080008081, 0x8000000000008009, 0x000000000000008a,
+    0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+    0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
+    0x8000000000008080, 0x0000000080000001, 0x8000000080008008,
+};
+
+// rho offsets and pi destinations along the lane cycle starting at lane 1
+constexpr uint8_t KeccakRhoOffsets[24] = {
+    1,  3,  6,  10, 15, 21, 28, 36, 45, 55, 2,  14,
+    27, 41, 56, 8,  25, 43, 62, 18, 39, 61, 20, 44,
+};
+constexpr uint8_t KeccakPiLanes[24] = {
+    10, 7,  11, 17, 18, 3, 5,  16, 8,  21, 24, 4,
+    15, 23, 19, 13, 12, 2, 20, 14, 22, 9,  6,  1,
+};
+
+void permuteKeccak(uint64_t *A) {
+  for (uint32_t Round = 0; Round < 24; ++Round) {
+    // theta
+    uint64_t C[5];
+    for (uint32_t X = 0; X < 5; ++X) {
+      C[X] = A[X] ^ A[X + 5] ^ A[X + 10] ^ A[X + 15] ^ A[X + 20];
+    }
+    for (uint32_t X = 0; X < 5; ++X) {
+      uint64_t D = C[(X + 4) % 5] ^ rotl64(C[(X + 1) % 5], 1);
+      for (uint32_t Y = 0; Y < 25; Y += 5) {
+        A[Y + X] ^= D;
+      }
+    }
+
+    // rho and pi
+    uint64_t Cur = A[1];
+    for (uint32_t I = 0; I < 24; ++I) {
+      uint32_t Lane = KeccakPiLanes[I];
+      uint64_t Next = A[Lane];
+      A[Lane] = rotl64(Cur, KeccakRhoOffsets[I]);
+      Cur = Next;
+    }
+
+    // chi
+    for (uint32_t Y = 0; Y < 25; Y += 5) {
+      for (uint32_t X = 0; X < 5; ++X) {
+        C[X] = A[Y + X];
+      }
+      for (uint32_t X = 0; X < 5; ++X) {
+        A[Y + X] = C[X] ^ (~C[(X + 1) % 5] & C[(X + 2) % 5]);
+      }
+    }
+
+    // iota
+    A[0] ^= KeccakRoundConsts[Round];
+  }
+}
+
+void absorbKeccakBlock(uint64_t *A, const uint8_t *Block) {
+  for (uint32_t I = 0; I < KeccakRate / 8; ++I) {
+    A[I] ^= loadLE64(Block + I * 8);
+  }
+  permuteKeccak(A);
+}
+
+// ==================== SHA-256 ====================
+
+alignas(16) constexpr uint32_t SHA256RoundConsts[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+constexpr uint32_t SHA256InitState[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+void compressSHA256(uint32_t *State, const uint8_t *Data, size_t NumBlocks) {
+  for (; NumBlocks > 0; --NumBlocks, Data += 64) {
+    uint32_t W[64];
+    for (uint32_t I = 0; I < 16; ++I) {
+      W[I] = loadBE32(Data + I * 4);
+    }
+    for (uint32_t I = 16; I < 64; ++I) {
+      uint32_t S0 =
+          rotr32(W[I - 15], 7) ^ rotr32(W[I - 15], 18) ^ (W[I - 15] >> 3);
+      uint32_t S1 =
+          rotr32(W[I - 2], 17) ^ rotr32(W[I - 2], 19) ^ (W[I - 2] >> 10);
+      W[I] = W[I - 16] + S0 + W[I - 7] + S1;
+    }
+
+    uint32_t A = State[0], B = State[1], C = State[2], D = State[3];
+    uint32_t E = State[4], F = State[5], G = State[6], H = State[7];
+    for (uint32_t I = 0; I < 64; ++I) {
+      uint32_t S1 = rotr32(E, 6) ^ rotr32(E, 11) ^ rotr32(E, 25);
+      uint32_t Ch = (E & F) ^ (~E & G);
+      uint32_t T1 = H + S1 + Ch + SHA256RoundConsts[I] + W[I];
+      uint32_t S0 = rotr32(A, 2) ^ rotr32(A, 13) ^ rotr32(A, 22);
+      uint32_t Maj = (A & B) ^ (A & C) ^ (B & C);
+      H = G;
+      G = F;
+      F = E;
+      E = D + T1;
+      D = C;
+      C = B;
+      B = A;
+      A = T1 + S0 + Maj;
+    }
+    State[0] += A;
+    State[1] += B;
+    State[2] += C;
+    State[3] += D;
+    State[4] += E;
+    State[5] += F;
+    State[6] += G;
+    State[7] += H;
+  }
+}
+
+#ifdef ZEN_BUILD_TARGET_X86_64
+bool hasSHAExtensions() {
+  unsigned Eax, Ebx, Ecx, Edx;
+  if (!__get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx) || !(Ecx & bit_SSE4_1)) {
+    return false;
+  }
+  if (!__get_cpuid_count(7, 0, &Eax, &Ebx, &Ecx, &Edx)) {
+    return false;
+  }
+  return Ebx & bit_SHA;
+}
+
+// the sha extensions keep the state as ABEF and CDGH, and run two rounds
+// per sha256rnds2, four message words per 128-bit lane
+__attribute__((target("sha,sse4.1"))) void
+compressSHA256NI(uint32_t *State, const uint8_t *Data, size_t NumBlocks) {
+  const __m128i ByteSwapMask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i Tmp = _mm_loadu_si128((const __m128i *)&State[0]);
+  __m128i CDGH = _mm_loadu_si128((const __m128i *)&State[4]);
+  Tmp = _mm_shuffle_epi32(Tmp, 0xB1);   // CDAB
+  CDGH = _mm_shuffle_epi32(CDGH, 0x1B); // EFGH
+  __m128i ABEF = _mm_alignr_epi8(Tmp, CDGH, 8);
+  CDGH = _mm_blend_epi16(CDGH, Tmp, 0xF0);
+
+  for (; NumBlocks > 0; --NumBlocks, Data += 64) {
+    __m128i SavedABEF = ABEF;
+    __m128i SavedCDGH = CDGH;
+    __m128i Msgs[4];
+    for (uint32_t I = 0; I < 4; ++I) {
+      Msgs[I] = _mm_shuffle_epi8(
+          _mm_loadu_si128((const __m128i *)(Data + I * 16)), ByteSwapMask);
+    }
+    for (uint32_t I = 0; I < 16; ++I) {
+      __m128i Msg = _mm_add_epi32(
+          Msgs[I % 4],
+          _mm_load_si128((const __m128i *)&SHA256RoundConsts[I * 4]));
+      CDGH = _mm_sha256rnds2_epu32(CDGH, ABEF, Msg);
+      Msg = _mm_shuffle_epi32(Msg, 0x0E);
+      ABEF = _mm_sha256rnds2_epu32(ABEF, CDGH, Msg);
+      if (I < 12) {
+        // W[t..t+3] from W[t-16..t-13], W[t-15..t-12], W[t-7..t-4] and
+        // W[t-4..t-1], replacing W[t-16..t-13] in its slot
+        __m128i Next = _mm_sha256msg1_epu32(Msgs[I % 4], Msgs[(I + 1) % 4]);
+        Next = _mm_add_epi32(
+            Next, _mm_alignr_epi8(Msgs[(I + 3) % 4], Msgs[(I + 2) % 4], 4));
+        Msgs[I % 4] = _mm_sha256msg2_epu32(Next, Msgs[(I + 3) % 4]);
+      }
+    }
+    ABEF = _mm_add_epi32(ABEF, SavedABEF);
+    CDGH = _mm_add_epi32(CDGH, SavedCDGH);
+  }
+
+  Tmp = _mm_shuffle_epi32(ABEF, 0x1B);     // FEBA
+  CDGH = _mm_shuffle_epi32(CDGH, 0xB1);    // DCHG
+  ABEF = _mm_blend_epi16(Tmp, CDGH, 0xF0); // DCBA
+  CDGH = _mm_alignr_epi8(CDGH, Tmp, 8);    // HGFE
+  _mm_storeu_si128((__m128i *)&State[0], ABEF);
+  _mm_storeu_si128((__m128i *)&State[4], CDGH);
+}
+#endif // ZEN_BUILD_TARGET_X86_64
+
+// ==================== RIPEMD-160 ====================
+
+constexpr uint8_t RIPEMDLeftWords[80] = {
+    0, 1, 2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+    7, 4, 13, 1,  10, 6,  15, 3,  12, 0, 9,  5,  2,  14, 11, 8,
+    3, 10, 14, 4, 9,  15, 8,  1,  2,  7, 0,  6,  13, 11, 5,  12,
+    1, 9, 11, 10, 0,  8,  12, 4,  13, 3, 7,  15, 14, 5,  6,  2,
+    4, 0, 5,  9,  7,  12, 2,  10, 14, 1, 3,  8,  11, 6,  15, 13,
+};
+constexpr uint8_t RIPEMDRightWords[80] = {
+    5,  14, 7,  0,  9, 2,  11, 4,  13, 6,  15, 8,  1,  10, 3,  12,
+    6,  11, 3,  7,  0, 13, 5,  10, 14, 15, 8,  12, 4,  9,  1,  2,
+    15, 5,  1,  3,  7, 14, 6,  9,  11, 8,  12, 2,  10, 0,  4,  13,
+    8,  6,  4,  1,  3, 11, 15, 0,  5,  12, 2,  13, 9,  7,  10, 14,
+    12, 15, 10, 4,  1, 5,  8,  7,  6,  2,  13, 14, 0,  3,  9,  11,
+};
+constexpr uint8_t RIPEMDLeftShifts[80] = {
+    11, 14, 15, 12, 5,  8,  7,  9,  11, 13, 14, 15, 6,  7,  9,  8,
+    7,  6,  8,  13, 11, 9,  7,  15, 7,  12, 15, 9,  11, 7,  13, 12,
+    11, 13, 6,  7,  14, 9,  13, 15, 14, 8,  13, 6,  5,  12, 7,  5,
+    11, 12, 14, 15, 14, 15, 9,  8,  9,  14, 5,  6,  8,  6,  5,  12,
+    9,  15, 5,  11, 6,  8,  13, 12, 5,  12, 13, 14, 11, 8,  5,  6,
+};
+constexpr uint8_t RIPEMDRightShifts[80] = {
+    8,  9,  9,  11, 13, 15, 15, 5,  7,  7,  8,  11, 14, 14, 12, 6,
+    9,  13, 15, 7,  12, 8,  9,  11, 7,  7,  12, 7,  6,  15, 13, 11,
+    9,  7,  15, 11, 8,  6,  6,  14, 12, 13, 5,  14, 13, 13, 7,  5,
+    15, 5,  8,  11, 14, 14, 6,  14, 6,  9,  12, 9,  12, 5,  15, 8,
+    8,  5,  12, 9,  12, 5,  14, 6,  8,  13, 6,  5,  15, 13, 11, 11,
+};
+constexpr uint32_t RIPEMDLeftConsts[5] = {
+    0x00000000, 0x5a827999, 0x6ed9eba1, 0x8f1bbcdc, 0xa953fd4e,
+};
+constexpr uint32_t RIPEMDRightConsts[5] = {
+    0x50a28be6, 0x5c4dd124, 0x6d703ef3, 0x7a6d76e9, 0x00000000,
+};
+
+constexpr uint32_t RIPEMDInitState[5] = {
+    0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0,
+};
+
+// the boolean function of the 16-step \p Round
+inline uint32_t ripemdFunc(uint32_t Round, uint32_t X, uint32_t Y,
+                           uint32_t Z) {
+  switch (Round) {
+  case 0:
+    return X ^ Y ^ Z;
+  case 1:
+    return (X & Y) | (~X & Z);
+  case 2:
+    return (X | ~Y) ^ Z;
+  case 3:
+    return (X & Z) | (Y & ~Z);
+  default:
+    return X ^ (Y | ~Z);
+  }
+}
+
+void compressRIPEMD160(uint32_t *State, const uint8_t *Data,
+                       size_t NumBlocks) {
+  for (; NumBlocks > 0; --NumBlocks, Data += 64) {
+    uint32_t W[16];
+    for (uint32_t I = 0; I < 16; ++I) {
+      W[I] = loadLE32(Data + I * 4);
+    }
+
+    uint32_t AL = State[0], BL = State[1], CL = State[2], DL = State[3],
+             EL = State[4];
+    uint32_t AR = AL, BR = BL, CR = CL, DR = DL, ER = EL;
+    for (uint32_t I = 0; I < 80; ++I) {
+      uint32_t Round = I / 16;
+      uint32_t T = rotl32(AL + ripemdFunc(Round, BL, CL, DL) +
+                              W[RIPEMDLeftWords[I]] + RIPEMDLeftConsts[Round],
+                          RIPEMDLeftShifts[I]) +
+                   EL;
+      AL = EL;
+      EL = DL;
+      DL = rotl32(CL, 10);
+      CL = BL;
+      BL = T;
+
+      // the parallel line runs the functions in reverse order
+      T = rotl32(AR + ripemdFunc(4 - Round, BR, CR, DR) +
+                     W[RIPEMDRightWords[I]] + RIPEMDRightConsts[Round],
+                 RIPEMDRightShifts[I]) +
+          ER;
+      AR = ER;
+      ER = DR;
+      DR = rotl32(CR, 10);
+      CR = BR;
+      BR = T;
+    }
+
+    uint32_t T = State[1] + CL + DR;
+    State[1] = State[2] + DL + ER;
+    State[2] = State[3] + EL + AR;
+    State[3] = State[4] + AL + BR;
+    State[4] = State[0] + BL + CR;
+    State[0] = T;
+  }
+}
+
+} // namespace
+
+void hashKeccak256(const uint8_t *Data, size_t Len, uint8_t *Digest) {
+  uint64_t A[25] = {};
+  for (; Len >= KeccakRate; Len -= KeccakRate, Data += KeccakRate) {
+    absorbKeccakBlock(A, Data);
+  }
+  uint8_t Tail[KeccakRate] = {};
+  std::memcpy(Tail, Data, Len);
+  Tail[Len] ^= 0x01;
+  Tail[KeccakRate - 1] ^= 0x80;
+  absorbKeccakBlock(A, Tail);
+  std::memcpy(Digest, A, Keccak256DigestSize);
+}
+
+template <typename CompressFn>
+static void hashSHA256With(const uint8_t *Data, size_t Len, uint8_t *Digest,
+                           CompressFn Compress) {
+  uint32_t State[8];
+  std::memcpy(State, SHA256InitState, sizeof(State));
+  hashMDBlocks(State, Data, Len, true, Compress);
+  for (uint32_t I = 0; I < 8; ++I) {
+    storeBE32(Digest + I * 4, State[I]);
+  }
+}
+
+void hashSHA256(const uint8_t *Data, size_t Len, uint8_t *Digest) {
+#ifdef ZEN_BUILD_TARGET_X86_64
+  static const bool UseSHAExtensions = hasSHAExtensions();
+  if (UseSHAExtensions) {
+    hashSHA256With(Data, Len, Digest, compressSHA256NI);
+    return;
+  }
+#endif
+  hashSHA256With(Data, Len, Digest, compressSHA256);
+}
+
+void hashSHA256Portable(const uint8_t *Data, size_t Len, uint8_t *Digest) {
+  hashSHA256With(Data, Len, Digest, compressSHA256);
+}
+
+void hashRIPEMD160(const uint8_t *Data, size_t Len, uint8_t *Digest) {
+  uint32_t State[5];
+  std::memcpy(State, RIPEMDInitState, sizeof(State));
+  hashMDBlocks(State, Data, Len, false, compressRIPEMD160);
+  std::memcpy(Digest, State, RIPEMD160DigestSize);
+}
+
+} // namespace zen::host::crypto
@@ -0,0 +1,28 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_HOST_CRYPTO_DIGESTS_H
+#define ZEN_HOST_CRYPTO_DIGESTS_H
+
+#include "common/defines.h"
+
+namespace zen::host::crypto {
+
+constexpr size_t Keccak256DigestSize = 32;
+constexpr size_t SHA256DigestSize = 32;
+constexpr size_t RIPEMD160DigestSize = 20;
+
+// the original keccak padding of ethereum, not the sha3 one
+void hashKeccak256(const uint8_t *Data, size_t Len, uint8_t *Digest);
+
+// uses the sha extensions when the cpu has them
+void hashSHA256(const uint8_t *Data, size_t Len, uint8_t *Digest);
+
+// what hashSHA256 falls back to without the sha extensions
+void hashSHA256Portable(const uint8_t *Data, size_t Len, uint8_t *Digest);
+
+void hashRIPEMD160(const uint8_t *Data, size_t Len, uint8_t *Digest);
+
+} // namespace zen::host::crypto
+
+#endif // ZEN_HOST_CRYPTO_DIGESTS_H
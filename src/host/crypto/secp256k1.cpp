@@ -0,0 +1,281 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "host/crypto/secp256k1.h"
+#include "utils/u256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zen::host::crypto {
+
+namespace {
+
+using utils::U256;
+
+/// A prime just below 2^256, so that 2^256 = C (mod M) folds the high half
+/// of the products
+struct Modulus {
+  U256 M;
+  U256 C;
+};
+
+constexpr Modulus FieldP = {
+    {{0xfffffffefffffc2f, 0xffffffffffffffff, 0xffffffffffffffff,
+      0xffffffffffffffff}},
+    {{0x00000001000003d1, 0, 0, 0}},
+};
+
+constexpr Modulus GroupN = {
+    {{0xbfd25e8cd0364141, 0xbaaedce6af48a03b, 0xfffffffffffffffe,
+      0xffffffffffffffff}},
+    {{0x402da1732fc9bebf, 0x4551231950b75fc4, 0x0000000000000001, 0}},
+};
+
+constexpr U256 GeneratorX = {{0x59f2815b16f81798, 0x029bfcdb2dce28d9,
+                              0x55a06295ce870b07, 0x79be667ef9dcbbac}};
+constexpr U256 GeneratorY = {{0x9c47d08ffb10d4b8, 0xfd17b448a6855419,
+                              0x5da4fbfc0e1108a8, 0x483ada7726a3c465}};
+
+constexpr U256 ZeroU256 = {{0, 0, 0, 0}};
+constexpr U256 OneU256 = {{1, 0, 0, 0}};
+
+U256 loadBE256(const uint8_t *Ptr) {
+  U256 Val;
+  for (uint32_t I = 0; I < 4; ++I) {
+    uint64_t Limb;
+    std::memcpy(&Limb, Ptr + I * 8, sizeof(Limb));
+    Val.Limbs[3 - I] = __builtin_bswap64(Limb);
+  }
+  return Val;
+}
+
+void storeBE256(uint8_t *Ptr, const U256 &Val) {
+  for (uint32_t I = 0; I < 4; ++I) {
+    uint64_t Limb = __builtin_bswap64(Val.Limbs[3 - I]);
+    std::memcpy(Ptr + I * 8, &Limb, sizeof(Limb));
+  }
+}
+
+bool isEqual(const U256 &LHS, const U256 &RHS) {
+  return utils::compareU256(LHS, RHS) == 0;
+}
+
+// ==================== Modular Arithmetic ====================
+
+// Hi * 2^256 + Lo mod M, each fold shrinks Hi by the 256 - 130 bits of C
+U256 reduceWide(U256 Lo, U256 Hi, const Modulus &Mod) {
+  while (!utils::isZeroU256(Hi)) {
+    U256 FoldLo, FoldHi;
+    utils::mulU256Wide(FoldLo, FoldHi, Hi, Mod.C);
+    bool Carry = utils::addU256(Lo, Lo, FoldLo);
+    utils::addU256(Hi, FoldHi, {{Carry, 0, 0, 0}});
+  }
+  while (utils::compareU256(Lo, Mod.M) >= 0) {
+    utils::subU256(Lo, Lo, Mod.M);
+  }
+  return Lo;
+}
+
+U256 addMod(const U256 &LHS, const U256 &RHS, const Modulus &Mod) {
+  U256 Res;
+  bool Carry = utils::addU256(Res, LHS, RHS);
+  if (Carry || utils::compareU256(Res, Mod.M) >= 0) {
+    utils::subU256(Res, Res, Mod.M);
+  }
+  return Res;
+}
+
+U256 subMod(const U256 &LHS, const U256 &RHS, const Modulus &Mod) {
+  U256 Res;
+  if (utils::subU256(Res, LHS, RHS)) {
+    utils::addU256(Res, Res, Mod.M);
+  }
+  return Res;
+}
+
+U256 mulMod(const U256 &LHS, const U256 &RHS, const Modulus &Mod) {
+  U256 Lo, Hi;
+  utils::mulU256Wide(Lo, Hi, LHS, RHS);
+  return reduceWide(Lo, Hi, Mod);
+}
+
+U256 powMod(const U256 &Base, const U256 &Exp, const Modulus &Mod) {
+  U256 Res = OneU256;
+  for (int32_t Bit = utils::getU256BitWidth(Exp) - 1; Bit >= 0; --Bit) {
+    Res = mulMod(Res, Res, Mod);
+    if (utils::isU256Bit(Exp, Bit)) {
+      Res = mulMod(Res, Base, Mod);
+    }
+  }
+  return Res;
+}
+
+// by fermat's little theorem, both moduli are prime
+U256 invertMod(const U256 &Val, const Modulus &Mod) {
+  U256 Exp;
+  utils::subU256(Exp, Mod.M, {{2, 0, 0, 0}});
+  return powMod(Val, Exp, Mod);
+}
+
+// ==================== Curve Arithmetic ====================
+
+/// A point of y^2 = x^3 + 7 in jacobian coordinates, x = X / Z^2 and
+/// y = Y / Z^3, the point at infinity has Z = 0
+struct JacobianPoint {
+  U256 X;
+  U256 Y;
+  U256 Z;
+
+  bool isInfinity() const { return utils::isZeroU256(Z); }
+};
+
+constexpr JacobianPoint InfinityPoint = {ZeroU256, OneU256, ZeroU256};
+
+U256 mulField(const U256 &LHS, const U256 &RHS) {
+  return mulMod(LHS, RHS, FieldP);
+}
+
+U256 addField(const U256 &LHS, const U256 &RHS) {
+  return addMod(LHS, RHS, FieldP);
+}
+
+U256 subField(const U256 &LHS, const U256 &RHS) {
+  return subMod(LHS, RHS, FieldP);
+}
+
+// dbl-2009-l of the explicit-formulas database, for a = 0
+JacobianPoint doublePoint(const JacobianPoint &P) {
+  if (P.isInfinity() || utils::isZeroU256(P.Y)) {
+    return InfinityPoint;
+  }
+  U256 A = mulField(P.X, P.X);
+  U256 B = mulField(P.Y, P.Y);
+  U256 C = mulField(B, B);
+  U256 XB = addField(P.X, B);
+  U256 D = subField(subField(mulField(XB, XB), A), C);
+  D = addField(D, D);
+  U256 E = addField(addField(A, A), A);
+  U256 F = mulField(E, E);
+
+  JacobianPoint Res;
+  Res.X = subField(F, addField(D, D));
+  U256 C8 = addField(C, C);
+  C8 = addField(C8, C8);
+  C8 = addField(C8, C8);
+  Res.Y = subField(mulField(E, subField(D, Res.X)), C8);
+  U256 YZ = mulField(P.Y, P.Z);
+  Res.Z = addField(YZ, YZ);
+  return Res;
+}
+
+// add-2007-bl of the explicit-formulas database
+JacobianPoint addPoints(const JacobianPoint &P, const JacobianPoint &Q) {
+  if (P.isInfinity()) {
+    return Q;
+  }
+  if (Q.isInfinity()) {
+    return P;
+  }
+  U256 Z1Z1 = mulField(P.Z, P.Z);
+  U256 Z2Z2 = mulField(Q.Z, Q.Z);
+  U256 U1 = mulField(P.X, Z2Z2);
+  U256 U2 = mulField(Q.X, Z1Z1);
+  U256 S1 = mulField(mulField(P.Y, Q.Z), Z2Z2);
+  U256 S2 = mulField(mulField(Q.Y, P.Z), Z1Z1);
+  U256 H = subField(U2, U1);
+  U256 R = subField(S2, S1);
+  if (utils::isZeroU256(H)) {
+    return utils::isZeroU256(R) ? doublePoint(P) : InfinityPoint;
+  }
+  U256 HH = mulField(H, H);
+  U256 HHH = mulField(H, HH);
+  U256 V = mulField(U1, HH);
+
+  JacobianPoint Res;
+  Res.X = subField(subField(mulField(R, R), HHH), addField(V, V));
+  Res.Y = subField(mulField(R, subField(V, Res.X)), mulField(S1, HHH));
+  Res.Z = mulField(mulField(P.Z, Q.Z), H);
+  return Res;
+}
+
+// K1 * P + K2 * Q by shamir's trick, one doubling chain for both scalars
+JacobianPoint mulAddPoints(const U256 &K1, const JacobianPoint &P,
+                           const U256 &K2, const JacobianPoint &Q) {
+  JacobianPoint PQ = addPoints(P, Q);
+  JacobianPoint Res = InfinityPoint;
+  int32_t NumBits =
+      std::max(utils::getU256BitWidth(K1), utils::getU256BitWidth(K2));
+  for (int32_t Bit = NumBits - 1; Bit >= 0; --Bit) {
+    Res = doublePoint(Res);
+    bool Bit1 = utils::isU256Bit(K1, Bit);
+    bool Bit2 = utils::isU256Bit(K2, Bit);
+    if (Bit1 && Bit2) {
+      Res = addPoints(Res, PQ);
+    } else if (Bit1) {
+      Res = addPoints(Res, P);
+    } else if (Bit2) {
+      Res = addPoints(Res, Q);
+    }
+  }
+  return Res;
+}
+
+} // namespace
+
+bool recoverSecp256k1PubKey(const uint8_t *Hash, const uint8_t *Signature,
+                            uint32_t RecId, uint8_t *PubKey) {
+  if (RecId > 3) {
+    return false;
+  }
+  U256 R = loadBE256(Signature);
+  U256 S = loadBE256(Signature + 32);
+  if (utils::isZeroU256(R) || utils::compareU256(R, GroupN.M) >= 0 ||
+      utils::isZeroU256(S) || utils::compareU256(S, GroupN.M) >= 0) {
+    return false;
+  }
+
+  // the x of the ephemeral point is r, or r + n when bit 1 of RecId is set
+  U256 X = R;
+  if (RecId & 2) {
+    if (utils::addU256(X, R, GroupN.M) ||
+        utils::compareU256(X, FieldP.M) >= 0) {
+      return false;
+    }
+  }
+  U256 YY = addField(mulField(mulField(X, X), X), {{7, 0, 0, 0}});
+  // p = 3 (mod 4), so the square root is YY^((p + 1) / 4)
+  U256 SqrtExp;
+  utils::addU256(SqrtExp, FieldP.M, OneU256);
+  utils::shrU256(SqrtExp, SqrtExp, 2);
+  U256 Y = powMod(YY, SqrtExp, FieldP);
+  if (!isEqual(mulField(Y, Y), YY)) {
+    return false;
+  }
+  if ((Y.Limbs[0] & 1) != (RecId & 1)) {
+    Y = subField(ZeroU256, Y);
+  }
+
+  // Q = r^-1 * (s * R - e * G)
+  U256 E = loadBE256(Hash);
+  if (utils::compareU256(E, GroupN.M) >= 0) {
+    utils::subU256(E, E, GroupN.M);
+  }
+  U256 RInv = invertMod(R, GroupN);
+  U256 GFactor = subMod(ZeroU256, mulMod(E, RInv, GroupN), GroupN);
+  U256 RFactor = mulMod(S, RInv, GroupN);
+  JacobianPoint G = {GeneratorX, GeneratorY, OneU256};
+  JacobianPoint RPoint = {X, Y, OneU256};
+  JacobianPoint Q = mulAddPoints(GFactor, G, RFactor, RPoint);
+  if (Q.isInfinity()) {
+    return false;
+  }
+
+  U256 ZInv = invertMod(Q.Z, FieldP);
+  U256 ZInv2 = mulField(ZInv, ZInv);
+  storeBE256(PubKey, mulField(Q.X, ZInv2));
+  storeBE256(PubKey + 32, mulField(Q.Y, mulField(ZInv2, ZInv)));
+  return true;
+}
+
+} // namespace zen::host::crypto
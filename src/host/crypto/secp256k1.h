@@ -0,0 +1,25 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_HOST_CRYPTO_SECP256K1_H
+#define ZEN_HOST_CRYPTO_SECP256K1_H
+
+#include "common/defines.h"
+
+namespace zen::host::crypto {
+
+constexpr size_t Secp256k1HashSize = 32;
+constexpr size_t Secp256k1SignatureSize = 64;
+constexpr size_t Secp256k1PubKeySize = 64;
+
+/// Recover the public key of an ecdsa signature over secp256k1, like the
+/// ecrecover precompile of ethereum. The hash is 32 bytes, the signature is
+/// r and s in big endian, \p RecId is v - 27 for ethereum signatures. The
+/// public key is written as x and y in big endian without the 0x04 prefix.
+/// \return false if the signature is invalid, then \p PubKey isn't written
+bool recoverSecp256k1PubKey(const uint8_t *Hash, const uint8_t *Signature,
+                            uint32_t RecId, uint8_t *PubKey);
+
+} // namespace zen::host::crypto
+
+#endif // ZEN_HOST_CRYPTO_SECP256K1_H
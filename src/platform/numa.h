@@ -0,0 +1,48 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_PLATFORM_NUMA_H
+#define ZEN_PLATFORM_NUMA_H
+
+#include "common/defines.h"
+#include <vector>
+
+namespace zen::platform {
+
+/// NUMA node layout of the host, indexed by node id. On hosts without NUMA
+/// information (or when running in SGX) there is exactly one node which
+/// contains every cpu.
+struct NumaTopology {
+  std::vector<std::vector<uint32_t>> NodeCPUs;
+  // Fake topologies are only used to exercise NUMA code paths on single-node
+  // machines, they never bind memory or threads to real nodes
+  bool IsFake = false;
+
+  uint32_t getNumNodes() const {
+    return static_cast<uint32_t>(NodeCPUs.size());
+  }
+
+  uint32_t getNodeOfCPU(uint32_t CPU) const;
+};
+
+const NumaTopology &getNumaTopology();
+
+/// Replace the detected topology by \p NumNodes fake nodes which split the
+/// available cpus evenly. The environment variable `ZEN_FAKE_NUMA_NODES` has
+/// the same effect at startup. Passing 0 restores the detected topology.
+/// \warning not thread-safe, only call it before any runtime is created
+void setFakeNumaTopology(uint32_t NumNodes);
+
+/// \return the node the calling thread is running on
+uint32_t getCurrentNumaNode();
+
+/// Prefer allocating the pages in [Addr, Addr + Len) on \p Node
+/// \return false if the kernel refused the policy, the memory is still usable
+bool bindMemoryToNumaNode(void *Addr, size_t Len, uint32_t Node);
+
+/// Restrict the calling thread to the cpus of \p Node
+bool setCurrentThreadNumaNode(uint32_t Node);
+
+} // namespace zen::platform
+
+#endif // ZEN_PLATFORM_NUMA_H
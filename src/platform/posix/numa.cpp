@@ -0,0 +1,228 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "platform/numa.h"
+#include "utils/logging.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <memory>
+#include <thread>
+
+#ifdef ZEN_BUILD_PLATFORM_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace zen::platform {
+
+namespace {
+
+// the node a thread has been assigned to under a fake topology, since fake
+// nodes can't be derived from the cpu the thread runs on
+thread_local int32_t FakeCurrentNode = -1;
+
+uint32_t getNumCPUs() {
+  uint32_t NumCPUs = std::thread::hardware_concurrency();
+  return NumCPUs > 0 ? NumCPUs : 1;
+}
+
+NumaTopology createSingleNodeTopology() {
+  NumaTopology Topology;
+  Topology.NodeCPUs.resize(1);
+  for (uint32_t I = 0; I < getNumCPUs(); ++I) {
+    Topology.NodeCPUs[0].push_back(I);
+  }
+  return Topology;
+}
+
+NumaTopology createFakeTopology(uint32_t NumNodes) {
+  ZEN_ASSERT(NumNodes > 0);
+  NumaTopology Topology;
+  Topology.IsFake = true;
+  Topology.NodeCPUs.resize(NumNodes);
+  uint32_t NumCPUs = getNumCPUs();
+  for (uint32_t I = 0; I < NumCPUs; ++I) {
+    Topology.NodeCPUs[uint64_t(I) * NumNodes / NumCPUs].push_back(I);
+  }
+  return Topology;
+}
+
+#ifdef ZEN_BUILD_PLATFORM_LINUX
+// parse cpu lists like "0-3,8-11"
+bool parseCPUList(const char *Filename, std::vector<uint32_t> &CPUs) {
+  FILE *File = ::fopen(Filename, "r");
+  if (!File) {
+    return false;
+  }
+  unsigned First = 0;
+  while (::fscanf(File, "%u", &First) == 1) {
+    unsigned Last = First;
+    int Sep = ::fgetc(File);
+    if (Sep == '-') {
+      if (::fscanf(File, "%u", &Last) != 1) {
+        break;
+      }
+      Sep = ::fgetc(File);
+    }
+    for (unsigned CPU = First; CPU <= Last; ++CPU) {
+      CPUs.push_back(CPU);
+    }
+    if (Sep != ',') {
+      break;
+    }
+  }
+  ::fclose(File);
+  return true;
+}
+
+NumaTopology detectTopology() {
+  constexpr const char *NodeDir = "/sys/devices/system/node";
+  DIR *Dir = ::opendir(NodeDir);
+  if (!Dir) {
+    return createSingleNodeTopology();
+  }
+  NumaTopology Topology;
+  while (struct dirent *Entry = ::readdir(Dir)) {
+    unsigned NodeId = 0;
+    if (std::sscanf(Entry->d_name, "node%u", &NodeId) != 1) {
+      continue;
+    }
+    if (NodeId >= Topology.NodeCPUs.size()) {
+      Topology.NodeCPUs.resize(NodeId + 1);
+    }
+    char Filename[256];
+    std::snprintf(Filename, sizeof(Filename), "%s/%s/cpulist", NodeDir,
+                  Entry->d_name);
+    parseCPUList(Filename, Topology.NodeCPUs[NodeId]);
+  }
+  ::closedir(Dir);
+  if (Topology.NodeCPUs.empty()) {
+    return createSingleNodeTopology();
+  }
+  return Topology;
+}
+#else
+NumaTopology detectTopology() { return createSingleNodeTopology(); }
+#endif // ZEN_BUILD_PLATFORM_LINUX
+
+NumaTopology &getDetectedTopology() {
+  static NumaTopology Topology = [] {
+    const char *FakeNodes = std::getenv("ZEN_FAKE_NUMA_NODES");
+    if (FakeNodes && std::atoi(FakeNodes) > 0) {
+      return createFakeTopology(std::atoi(FakeNodes));
+    }
+    return detectTopology();
+  }();
+  return Topology;
+}
+
+std::unique_ptr<NumaTopology> &getFakeTopology() {
+  static std::unique_ptr<NumaTopology> Topology;
+  return Topology;
+}
+
+} // namespace
+
+uint32_t NumaTopology::getNodeOfCPU(uint32_t CPU) const {
+  for (uint32_t Node = 0; Node < NodeCPUs.size(); ++Node) {
+    for (uint32_t NodeCPU : NodeCPUs[Node]) {
+      if (NodeCPU == CPU) {
+        return Node;
+      }
+    }
+  }
+  return 0;
+}
+
+const NumaTopology &getNumaTopology() {
+  const auto &Fake = getFakeTopology();
+  return Fake ? *Fake : getDetectedTopology();
+}
+
+void setFakeNumaTopology(uint32_t NumNodes) {
+  if (NumNodes == 0) {
+    getFakeTopology().reset();
+  } else {
+    getFakeTopology() =
+        std::make_unique<NumaTopology>(createFakeTopology(NumNodes));
+  }
+}
+
+uint32_t getCurrentNumaNode() {
+  const NumaTopology &Topology = getNumaTopology();
+  if (Topology.getNumNodes() <= 1) {
+    return 0;
+  }
+  if (Topology.IsFake && FakeCurrentNode >= 0 &&
+      uint32_t(FakeCurrentNode) < Topology.getNumNodes()) {
+    return FakeCurrentNode;
+  }
+#ifdef ZEN_BUILD_PLATFORM_LINUX
+  int CPU = ::sched_getcpu();
+  if (CPU >= 0) {
+    return Topology.getNodeOfCPU(CPU);
+  }
+#endif
+  return 0;
+}
+
+bool bindMemoryToNumaNode(void *Addr, size_t Len, uint32_t Node) {
+  const NumaTopology &Topology = getNumaTopology();
+  ZEN_ASSERT(Node < Topology.getNumNodes());
+  if (Topology.IsFake || Topology.getNumNodes() <= 1) {
+    return true;
+  }
+#ifdef ZEN_BUILD_PLATFORM_LINUX
+  // raw syscall to avoid depending on libnuma
+  constexpr int MPOL_PREFERRED_MODE = 1;
+  constexpr size_t BitsPerWord = sizeof(unsigned long) * 8;
+  std::vector<unsigned long> NodeMask(Node / BitsPerWord + 1, 0);
+  NodeMask[Node / BitsPerWord] |= 1UL << (Node % BitsPerWord);
+  long Ret = ::syscall(SYS_mbind, Addr, Len, MPOL_PREFERRED_MODE,
+                       NodeMask.data(), NodeMask.size() * BitsPerWord + 1, 0);
+  if (Ret != 0) {
+    ZEN_LOG_WARN("failed to mbind(%p, %zu) to node %u due to '%s'", Addr, Len,
+                 Node, std::strerror(errno));
+    return false;
+  }
+  return true;
+#else
+  return false;
+#endif // ZEN_BUILD_PLATFORM_LINUX
+}
+
+bool setCurrentThreadNumaNode(uint32_t Node) {
+  const NumaTopology &Topology = getNumaTopology();
+  if (Node >= Topology.getNumNodes()) {
+    return false;
+  }
+  if (Topology.IsFake) {
+    FakeCurrentNode = Node;
+    return true;
+  }
+  if (Topology.getNumNodes() <= 1) {
+    return true;
+  }
+#ifdef ZEN_BUILD_PLATFORM_LINUX
+  const auto &CPUs = Topology.NodeCPUs[Node];
+  if (CPUs.empty()) {
+    return false;
+  }
+  cpu_set_t CPUSet;
+  CPU_ZERO(&CPUSet);
+  for (uint32_t CPU : CPUs) {
+    CPU_SET(CPU, &CPUSet);
+  }
+  return ::pthread_setaffinity_np(::pthread_self(), sizeof(CPUSet),
+                                  &CPUSet) == 0;
+#else
+  return false;
+#endif // ZEN_BUILD_PLATFORM_LINUX
+}
+
+} // namespace zen::platform
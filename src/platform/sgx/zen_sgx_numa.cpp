@@ -0,0 +1,29 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "platform/numa.h"
+
+// enclaves can't query or change the placement of their pages and threads, so
+// the topology is always a single node
+namespace zen::platform {
+
+uint32_t NumaTopology::getNodeOfCPU(uint32_t) const { return 0; }
+
+const NumaTopology &getNumaTopology() {
+  static NumaTopology Topology = [] {
+    NumaTopology SingleNode;
+    SingleNode.NodeCPUs.resize(1);
+    return SingleNode;
+  }();
+  return Topology;
+}
+
+void setFakeNumaTopology(uint32_t) {}
+
+uint32_t getCurrentNumaNode() { return 0; }
+
+bool bindMemoryToNumaNode(void *, size_t, uint32_t) { return true; }
+
+bool setCurrentThreadNumaNode(uint32_t Node) { return Node == 0; }
+
+} // namespace zen::platform
@@ -22,11 +22,44 @@ struct RuntimeConfig {
 #endif
   // Open statistics(compilation time/execution time)
   bool EnableStatistics = false;
+  // Count calls, loop iterations and gas of every wasm function, see
+  // Module::getFunctionProfile
+  bool EnableFunctionProfiling = false;
   // Enable cpu instruction tracer hook
   bool EnableGdbTracingHook = false;
+  // Bind the imports listed in common/hostapi_intrinsics.def to the runtime's
+  // own implementations, which the JITs lower inline where they can
+  bool EnableHostapiIntrinsics = false;
+  // Bind linear memories and compile threads to the NUMA node of the thread
+  // which creates them
+  bool EnableNUMA = false;
+  // Serve runtime allocations from a size-class arena with per-thread caches
+  // instead of the system allocator, for multi-threaded module loading
+  bool EnableThreadCachingAllocator = false;
+  // The JITs check call_indirect sites that may reach at most this many
+  // internal functions, known from element segments with constant offsets,
+  // inline and call the matching one directly, 0 to disable
+  uint32_t MaxIndirectCallCacheTargets = 4;
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  // Keep a copy of the singlepass JIT code on every NUMA node, instances run
+  // the copy local to the node they are created on
+  bool EnableNUMACodeReplication = false;
+  // Keep the most used locals of every function in registers, weighting uses
+  // by loop depth (x86-64 only)
+  bool EnableSinglepassLocalCaching = false;
+#endif // ZEN_ENABLE_SINGLEPASS_JIT
 #ifdef ZEN_ENABLE_MULTIPASS_JIT
   // Disable greedy register allocation of multipass JIT
   bool DisableMultipassGreedyRA = false;
+  // Functions whose virtual registers times basic blocks exceed this budget
+  // are allocated by the fast register allocator instead of the greedy one,
+  // 0 for no limit
+  uint64_t MultipassGreedyRABudget = 1ULL << 26;
+  // Choose the register allocator of every function from its size, loop
+  // depth and execution profile, see EnableFunctionProfiling. Hot and loopy
+  // functions get a larger greedy budget, cold and huge straight-line ones
+  // get the fast allocator
+  bool EnableMultipassAdaptiveRA = false;
   // Disable multithread of multipass JIT
   bool DisableMultipassMultithread = false;
   // Number of threads for multipass JIT if DisableMultipassMultithread is false
@@ -44,6 +77,12 @@ struct RuntimeConfig {
       DisableMultipassMultithread = true;
     }
 #endif // ZEN_ENABLE_MULTIPASS_JIT
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+    if (EnableNUMACodeReplication && !EnableNUMA) {
+      ZEN_LOG_WARN("NUMA enabled due to NUMA code replication");
+      EnableNUMA = true;
+    }
+#endif // ZEN_ENABLE_SINGLEPASS_JIT
 
     switch (Mode) {
 #ifndef ZEN_ENABLE_SINGLEPASS_JIT
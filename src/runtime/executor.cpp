@@ -0,0 +1,119 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "runtime/executor.h"
+#include "runtime/function_handle.h"
+#include "runtime/instance.h"
+#include "runtime/isolation.h"
+#include <algorithm>
+
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+#include "utils/virtual_stack.h"
+#endif
+
+namespace zen::runtime {
+
+using namespace common;
+
+// enough for wasm calling wasm through hostapis a few times
+constexpr size_t MaxVirtualStacksPerWorker = 8;
+
+Executor::Executor(Runtime &RT, uint32_t NumThreads)
+    : RT(RT), Workers(determineNumThreads(NumThreads)),
+      Pool(determineNumThreads(NumThreads)) {
+  ZEN_ASSERT(Workers.size() == Pool.getThreadCount());
+  for (uint32_t I = 0; I < Workers.size(); ++I) {
+    Worker &W = Workers[I];
+    W.Iso = RT.createManagedIsolation();
+    ZEN_ASSERT(W.Iso);
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+    W.StackPool = utils::createVirtualStackPool(MaxVirtualStacksPerWorker);
+#endif
+    Pool.setThreadContext(I, &W);
+  }
+}
+
+Executor::~Executor() {
+  Pool.waitForTasks();
+  Pool.interrupt();
+  for (Worker &W : Workers) {
+    RT.deleteManagedIsolation(W.Iso);
+  }
+}
+
+uint32_t Executor::determineNumThreads(uint32_t NumThreads) {
+  if (NumThreads > 0) {
+    return NumThreads;
+  }
+  return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void Executor::submit(std::function<void(Isolation &Iso)> Job) {
+  Pool.pushTask([Job = std::move(Job)](Worker *W) {
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+    utils::setThreadVirtualStackPool(W->StackPool.get());
+#endif
+    Job(*W->Iso);
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+    utils::setThreadVirtualStackPool(nullptr);
+#endif
+  });
+}
+
+std::future<ExecutorCallResult>
+Executor::submitCall(Module &Mod, const FunctionHandle &Func,
+                     std::vector<UntypedValue> Args, uint64_t GasLimit) {
+  auto Promise = std::make_shared<std::promise<ExecutorCallResult>>();
+  std::future<ExecutorCallResult> Future = Promise->get_future();
+  if (Func.getModule() != &Mod) {
+    ExecutorCallResult Result;
+    Result.ErrCode = ErrorCode::ForeignFunctionHandle;
+    Promise->set_value(std::move(Result));
+    return Future;
+  }
+  submit([this, &Mod, &Func, Args = std::move(Args), GasLimit,
+          Promise](Isolation &Iso) {
+    MayBe<Instance *> InstRet = Iso.createInstance(Mod, GasLimit);
+    if (!InstRet) {
+      ExecutorCallResult Result;
+      Result.ErrCode = InstRet.getError().getCode();
+      Promise->set_value(std::move(Result));
+      return;
+    }
+    ExecutorCallResult Result = runCall(**InstRet, Func, Args);
+    Iso.deleteInstance(*InstRet);
+    Promise->set_value(std::move(Result));
+  });
+  return Future;
+}
+
+std::future<ExecutorCallResult>
+Executor::submitCall(Instance &Inst, const FunctionHandle &Func,
+                     std::vector<UntypedValue> Args) {
+  auto Promise = std::make_shared<std::promise<ExecutorCallResult>>();
+  std::future<ExecutorCallResult> Future = Promise->get_future();
+  submit([this, &Inst, &Func, Args = std::move(Args), Promise](Isolation &) {
+    Promise->set_value(runCall(Inst, Func, Args));
+  });
+  return Future;
+}
+
+ExecutorCallResult Executor::runCall(Instance &Inst, const FunctionHandle &Func,
+                                     const std::vector<UntypedValue> &Args) {
+  ExecutorCallResult Result;
+  if (Args.size() != Func.getNumParams()) {
+    Result.ErrCode = ErrorCode::UnexpectedNumArgs;
+    Result.GasLeft = Inst.getGas();
+    return Result;
+  }
+  Result.Results.resize(Func.getNumReturns());
+  if (!RT.callWasmFunction(Inst, Func, Args.data(), Result.Results.data())) {
+    Result.ErrCode = Inst.getError().getCode();
+    Result.Results.clear();
+    Inst.clearError();
+  }
+  Result.GasLeft = Inst.getGas();
+  return Result;
+}
+
+} // namespace zen::runtime
@@ -0,0 +1,86 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_RUNTIME_EXECUTOR_H
+#define ZEN_RUNTIME_EXECUTOR_H
+
+#include "common/thread_pool.h"
+#include "runtime/runtime.h"
+#include <functional>
+#include <future>
+
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+namespace zen::utils {
+class StackMemPool;
+} // namespace zen::utils
+#endif
+
+namespace zen::runtime {
+
+/// Outcome of a call run by an Executor
+struct ExecutorCallResult {
+  common::ErrorCode ErrCode = common::ErrorCode::NoError;
+  // gas left in the instance when the call returned
+  uint64_t GasLeft = 0;
+  std::vector<common::UntypedValue> Results;
+};
+
+/// Runs independent wasm calls on a pool of worker threads.
+///
+/// Each worker owns an isolation for the instances it creates and, with
+/// virtual stacks, a private pool of stacks. Jobs therefore only share the
+/// thread-safe parts of the runtime: modules, function handles, the symbol
+/// pool and the allocators. The trap handler state is per thread already.
+class Executor {
+public:
+  /// \param NumThreads 0 means one worker per cpu
+  explicit Executor(Runtime &RT, uint32_t NumThreads = 0);
+
+  ~Executor();
+
+  NONCOPYABLE(Executor);
+
+  uint32_t getNumThreads() const { return Pool.getThreadCount(); }
+
+  /// Run \p Job on any worker, \p Iso is the isolation of that worker and
+  /// must only be used by the job
+  void submit(std::function<void(Isolation &Iso)> Job);
+
+  /// Call \p Func on a new instance of \p Mod, which lives in the isolation
+  /// of the worker during the call
+  /// \param Func must be resolved from \p Mod
+  std::future<ExecutorCallResult>
+  submitCall(Module &Mod, const FunctionHandle &Func,
+             std::vector<common::UntypedValue> Args, uint64_t GasLimit = 0);
+
+  /// Call \p Func on \p Inst. The instance isn't thread-safe, it must not be
+  /// used until the returned future is ready.
+  std::future<ExecutorCallResult>
+  submitCall(Instance &Inst, const FunctionHandle &Func,
+             std::vector<common::UntypedValue> Args);
+
+  /// Wait until all the submitted jobs are done
+  void wait() { Pool.waitForTasks(); }
+
+private:
+  struct Worker {
+    Isolation *Iso = nullptr;
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+    std::unique_ptr<utils::StackMemPool> StackPool;
+#endif
+  };
+
+  static uint32_t determineNumThreads(uint32_t NumThreads);
+
+  ExecutorCallResult runCall(Instance &Inst, const FunctionHandle &Func,
+                             const std::vector<common::UntypedValue> &Args);
+
+  Runtime &RT;
+  // must outlive the threads of Pool
+  std::vector<Worker> Workers;
+  common::ThreadPool<Worker> Pool;
+};
+
+} // namespace zen::runtime
+
+#endif // ZEN_RUNTIME_EXECUTOR_H
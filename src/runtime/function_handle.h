@@ -0,0 +1,71 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_RUNTIME_FUNCTION_HANDLE_H
+#define ZEN_RUNTIME_FUNCTION_HANDLE_H
+
+#include "runtime/module.h"
+
+#ifdef ZEN_ENABLE_JIT
+#include "entrypoint/entrypoint.h"
+#endif
+
+namespace zen::runtime {
+
+/// A function of a module resolved once and shared by all instances of the
+/// module. Calls through a handle skip the export lookup, the argument checks
+/// and the marshalling of TypedValue vectors, see
+/// Runtime::callWasmFunction(Instance &, const FunctionHandle &, ...).
+/// Handles are owned by their module, see Module::getFunctionHandle.
+class FunctionHandle {
+public:
+  FunctionHandle(const Module &M, uint32_t FuncIdx)
+      : Mod(&M), FuncIdx(FuncIdx), Type(M.getFunctionType(FuncIdx))
+#ifdef ZEN_ENABLE_JIT
+        ,
+        NativeSignature(Type->getParamTypes(), Type->NumParams,
+                        Type->getReturnTypes(), Type->NumReturns)
+#endif
+  {
+  }
+
+  NONCOPYABLE(FunctionHandle);
+
+  const Module *getModule() const { return Mod; }
+
+  uint32_t getFuncIdx() const { return FuncIdx; }
+
+  const TypeEntry &getType() const { return *Type; }
+
+  uint32_t getNumParams() const { return Type->NumParams; }
+
+  uint32_t getNumReturns() const { return Type->NumReturns; }
+
+  WASMType getParamType(uint32_t Idx) const {
+    ZEN_ASSERT(Idx < Type->NumParams);
+    return Type->getParamTypes()[Idx];
+  }
+
+  WASMType getReturnType(uint32_t Idx) const {
+    ZEN_ASSERT(Idx < Type->NumReturns);
+    return Type->getReturnTypes()[Idx];
+  }
+
+#ifdef ZEN_ENABLE_JIT
+  const entrypoint::NativeCallSignature &getNativeSignature() const {
+    return NativeSignature;
+  }
+#endif
+
+private:
+  const Module *Mod;
+  uint32_t FuncIdx;
+  const TypeEntry *Type;
+#ifdef ZEN_ENABLE_JIT
+  entrypoint::NativeCallSignature NativeSignature;
+#endif
+};
+
+} // namespace zen::runtime
+
+#endif // ZEN_RUNTIME_FUNCTION_HANDLE_H
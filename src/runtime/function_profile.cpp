@@ -0,0 +1,60 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "runtime/function_profile.h"
+
+#include "runtime/module.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace zen::runtime {
+
+std::vector<FunctionProfileEntry> getHotFunctions(const Module &Mod) {
+  std::vector<FunctionCounters> Profile = Mod.getFunctionProfile();
+  std::vector<FunctionProfileEntry> Entries;
+  for (uint32_t I = 0; I < Profile.size(); ++I) {
+    const FunctionCounters &C = Profile[I];
+    if (C.Calls == 0 && C.LoopIterations == 0 && C.SelfGas == 0) {
+      continue;
+    }
+    Entries.push_back({I + Mod.getNumImportFunctions(), C});
+  }
+  std::stable_sort(Entries.begin(), Entries.end(),
+                   [](const FunctionProfileEntry &A,
+                      const FunctionProfileEntry &B) {
+                     const FunctionCounters &L = A.Counters;
+                     const FunctionCounters &R = B.Counters;
+                     if (L.SelfGas != R.SelfGas) {
+                       return L.SelfGas > R.SelfGas;
+                     }
+                     if (L.LoopIterations != R.LoopIterations) {
+                       return L.LoopIterations > R.LoopIterations;
+                     }
+                     return L.Calls > R.Calls;
+                   });
+  return Entries;
+}
+
+std::string dumpFunctionProfile(const Module &Mod, uint32_t MaxRows) {
+  std::vector<FunctionProfileEntry> Entries = getHotFunctions(Mod);
+  if (MaxRows > 0 && Entries.size() > MaxRows) {
+    Entries.resize(MaxRows);
+  }
+
+  char Line[256];
+  std::snprintf(Line, sizeof(Line), "%-40s %16s %16s %16s\n", "function",
+                "self_gas", "loop_iterations", "calls");
+  std::string Out = Line;
+  for (const FunctionProfileEntry &Entry : Entries) {
+    std::string Name = Mod.getWasmFuncDebugName(Entry.FuncIdx);
+    const FunctionCounters &C = Entry.Counters;
+    std::snprintf(Line, sizeof(Line),
+                  "%-40s %16" PRIu64 " %16" PRIu64 " %16" PRIu64 "\n",
+                  Name.c_str(), C.SelfGas, C.LoopIterations, C.Calls);
+    Out += Line;
+  }
+  return Out;
+}
+
+} // namespace zen::runtime
@@ -0,0 +1,50 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_RUNTIME_FUNCTION_PROFILE_H
+#define ZEN_RUNTIME_FUNCTION_PROFILE_H
+
+#include "common/defines.h"
+#include <string>
+#include <vector>
+
+namespace zen::runtime {
+
+class Module;
+
+/// Execution counters of one wasm function, enabled by
+/// RuntimeConfig::EnableFunctionProfiling. Every instance owns an array of
+/// them indexed by internal function index, updated by the interpreter and by
+/// the code the JIT compilers emit, and adds it to the profile of its module
+/// when deleted.
+struct FunctionCounters {
+  uint64_t Calls;
+  // loop entries and back edges taken
+  uint64_t LoopIterations;
+  // gas charged by the body of the function, excluding its callees
+  uint64_t SelfGas;
+
+  FunctionCounters &operator+=(const FunctionCounters &Other) {
+    Calls += Other.Calls;
+    LoopIterations += Other.LoopIterations;
+    SelfGas += Other.SelfGas;
+    return *this;
+  }
+};
+
+struct FunctionProfileEntry {
+  uint32_t FuncIdx; // including imported functions
+  FunctionCounters Counters;
+};
+
+/// \return the functions of \p Mod which ran, hottest first: ordered by self
+/// gas, then by loop iterations, then by calls
+std::vector<FunctionProfileEntry> getHotFunctions(const Module &Mod);
+
+/// Render getHotFunctions() as a text table, at most \p MaxRows rows unless
+/// zero
+std::string dumpFunctionProfile(const Module &Mod, uint32_t MaxRows = 0);
+
+} // namespace zen::runtime
+
+#endif // ZEN_RUNTIME_FUNCTION_PROFILE_H
@@ -10,6 +10,7 @@
 #include "entrypoint/entrypoint.h"
 #include "runtime/config.h"
 #include <algorithm>
+#include <cstring>
 
 namespace zen::runtime {
 
@@ -83,8 +84,30 @@ void Module::InstanceLayout::compute() {
   TracesSize = ZEN_ALIGN(MAX_TRACE_LENGTH * sizeof(uint32_t), Alignment);
   TotalSize += TracesSize;
 #endif // ZEN_ENABLE_DUMP_CALL_STACK
+
+  uint32_t MaxResultsBufferSize = 0;
+  for (uint32_t I = 0; I < Mod.NumTypes; ++I) {
+    const TypeEntry &Type = Mod.TypeTable[I];
+    JITReturnAllocator Allocator;
+    for (uint32_t J = 0; J < Type.NumReturns; ++J) {
+      Allocator.next(Type.getReturnTypes()[J]);
+    }
+    MaxResultsBufferSize =
+        std::max(MaxResultsBufferSize, Allocator.getBufferSize());
+  }
+  ResultsBufferSize = ZEN_ALIGN(MaxResultsBufferSize, Alignment);
 #endif // ZEN_ENABLE_JIT
 
+  ResultsBufferBaseOffset = TotalSize;
+  TotalSize += ResultsBufferSize;
+
+  if (Mod.getRuntime()->getConfig().EnableFunctionProfiling) {
+    FunctionCountersSize = ZEN_ALIGN(
+        sizeof(FunctionCounters) * Mod.NumInternalFunctions, Alignment);
+  }
+  FunctionCountersBaseOffset = TotalSize;
+  TotalSize += FunctionCountersSize;
+
   ExceptionOffset = offsetof(Instance, Err.ErrCode);
   GasOffset = offsetof(Instance, Gas);
 
@@ -133,6 +156,12 @@ InstanceUniquePtr Instance::newInstance(Isolation &Iso, const Module &Mod,
 
 #endif // ZEN_ENABLE_JIT
 
+  if (Layout.FunctionCountersSize > 0) {
+    Inst->FuncCounters = reinterpret_cast<FunctionCounters *>(
+        (uintptr_t)Buf + Layout.FunctionCountersBaseOffset);
+    std::memset(Inst->FuncCounters, 0, Layout.FunctionCountersSize);
+  }
+
   Inst->setGas(GasLimit);
 
   action::Instantiator Instantiator;
@@ -142,6 +171,10 @@ InstanceUniquePtr Instance::newInstance(Isolation &Iso, const Module &Mod,
 }
 
 Instance::~Instance() {
+  if (FuncCounters) {
+    Mod->mergeFunctionProfile(FuncCounters);
+  }
+
   auto *MemAllocator = getWasmMemoryAllocator();
   for (uint32_t I = 0; I < NumTotalMemories; ++I) {
     if (Memories[I].MemBase) {
@@ -186,17 +219,8 @@ void Instance::protectMemory() {
     if (!Mem->MemBase) {
       continue;
     }
-
-#ifdef ZEN_ENABLE_CPU_EXCEPTION
-    auto *TLS = common::traphandler::CallThreadState::current();
-    // when not instance call instance, then the bucket is mprotect none
-    // before.
-    bool UnprotectBucket = TLS != nullptr && TLS->parent() != nullptr;
-#else
-    bool UnprotectBucket = true;
-#endif // ZEN_ENABLE_CPU_EXCEPTION
     getWasmMemoryAllocator()->mprotectReadWriteWasmMemoryData(
-        Mem->getWasmMemoryData(), UnprotectBucket);
+        Mem->getWasmMemoryData());
   }
 }
 
@@ -281,6 +305,306 @@ bool Instance::validatedNativeAddr(uint8_t *NativeAddr, uint32_t Size) {
   return Valid;
 }
 
+// ==================== Bulk Memory Methods ====================
+
+bool Instance::chargeGas(uint64_t Cost) {
+  if (Mod->getGasFuncIdx() == -1u) {
+    return true;
+  }
+  if (Gas < Cost) {
+    Gas = 0;
+    return false;
+  }
+  Gas -= Cost;
+  return true;
+}
+
+ErrorCode Instance::initMemory(uint32_t DataIdx, uint32_t Dst, uint32_t Src,
+                               uint32_t Len) {
+  ZEN_ASSERT(DataIdx < DroppedDataSegs.size());
+  if (!chargeBulkMemoryGas(Len)) {
+    return ErrorCode::GasLimitExceeded;
+  }
+  const DataEntry *Seg = Mod->getDataEntry(DataIdx);
+  uint64_t SegSize = DroppedDataSegs[DataIdx] ? 0 : Seg->Size;
+  const MemoryInstance &MemInst = getDefaultMemoryInst();
+  if (uint64_t(Src) + Len > SegSize || uint64_t(Dst) + Len > MemInst.MemSize) {
+    return ErrorCode::OutOfBoundsMemory;
+  }
+  if (Len) {
+    std::memcpy(MemInst.MemBase + Dst,
+                Mod->getWASMBytecode() + Seg->Offset + Src, Len);
+  }
+  return ErrorCode::NoError;
+}
+
+ErrorCode Instance::copyMemory(uint32_t Dst, uint32_t Src, uint32_t Len) {
+  if (!chargeBulkMemoryGas(Len)) {
+    return ErrorCode::GasLimitExceeded;
+  }
+  const MemoryInstance &MemInst = getDefaultMemoryInst();
+  if (uint64_t(Src) + Len > MemInst.MemSize ||
+      uint64_t(Dst) + Len > MemInst.MemSize) {
+    return ErrorCode::OutOfBoundsMemory;
+  }
+  // libc picks the widest vector or rep movsb sequence for the length
+  if (Len) {
+    std::memmove(MemInst.MemBase + Dst, MemInst.MemBase + Src, Len);
+  }
+  return ErrorCode::NoError;
+}
+
+ErrorCode Instance::fillMemory(uint32_t Dst, uint32_t Val, uint32_t Len) {
+  if (!chargeBulkMemoryGas(Len)) {
+    return ErrorCode::GasLimitExceeded;
+  }
+  const MemoryInstance &MemInst = getDefaultMemoryInst();
+  if (uint64_t(Dst) + Len > MemInst.MemSize) {
+    return ErrorCode::OutOfBoundsMemory;
+  }
+  if (Len) {
+    std::memset(MemInst.MemBase + Dst, uint8_t(Val), Len);
+  }
+  return ErrorCode::NoError;
+}
+
+// ==================== Hostapi Intrinsic Methods ====================
+
+const void *Instance::getHostapiIntrinsicFunc(HostapiIntrinsic Intrinsic) {
+  switch (Intrinsic) {
+  case HostapiIntrinsic::memcpy:
+  case HostapiIntrinsic::memmove:
+    return reinterpret_cast<const void *>(memcpyIntrinsic);
+  case HostapiIntrinsic::memset:
+    return reinterpret_cast<const void *>(memsetIntrinsic);
+  case HostapiIntrinsic::memcmp:
+    return reinterpret_cast<const void *>(memcmpIntrinsic);
+  case HostapiIntrinsic::strlen:
+    return reinterpret_cast<const void *>(strlenIntrinsic);
+  case HostapiIntrinsic::u256_add:
+    return reinterpret_cast<const void *>(u256AddIntrinsic);
+  case HostapiIntrinsic::u256_sub:
+    return reinterpret_cast<const void *>(u256SubIntrinsic);
+  case HostapiIntrinsic::u256_mul:
+    return reinterpret_cast<const void *>(u256MulIntrinsic);
+  case HostapiIntrinsic::u256_div:
+    return reinterpret_cast<const void *>(u256DivIntrinsic);
+  case HostapiIntrinsic::u256_mod:
+    return reinterpret_cast<const void *>(u256ModIntrinsic);
+  case HostapiIntrinsic::u256_exp:
+    return reinterpret_cast<const void *>(u256ExpIntrinsic);
+  case HostapiIntrinsic::u256_shl:
+    return reinterpret_cast<const void *>(u256ShlIntrinsic);
+  case HostapiIntrinsic::u256_shr:
+    return reinterpret_cast<const void *>(u256ShrIntrinsic);
+  case HostapiIntrinsic::u256_cmp:
+    return reinterpret_cast<const void *>(u256CmpIntrinsic);
+  default:
+    ZEN_UNREACHABLE();
+    return nullptr;
+  }
+}
+
+int32_t Instance::memcpyIntrinsic(Instance *Inst, int32_t Dst, int32_t Src,
+                                  int32_t Len) {
+  ErrorCode Err = Inst->hasMemory() ? Inst->copyMemory(Dst, Src, Len)
+                                    : ErrorCode::OutOfBoundsMemory;
+  if (Err != ErrorCode::NoError) {
+    Inst->setExceptionByHostapi(common::getError(Err));
+  }
+  return Dst;
+}
+
+int32_t Instance::memsetIntrinsic(Instance *Inst, int32_t Dst, int32_t Val,
+                                  int32_t Len) {
+  ErrorCode Err = Inst->hasMemory() ? Inst->fillMemory(Dst, Val, Len)
+                                    : ErrorCode::OutOfBoundsMemory;
+  if (Err != ErrorCode::NoError) {
+    Inst->setExceptionByHostapi(common::getError(Err));
+  }
+  return Dst;
+}
+
+int32_t Instance::memcmpIntrinsic(Instance *Inst, int32_t LHS, int32_t RHS,
+                                  int32_t Len) {
+  if (!Inst->chargeBulkMemoryGas(Len)) {
+    Inst->setExceptionByHostapi(common::getError(ErrorCode::GasLimitExceeded));
+    return 0;
+  }
+  uint64_t MemSize =
+      Inst->hasMemory() ? Inst->getDefaultMemoryInst().MemSize : 0;
+  if (uint64_t(uint32_t(LHS)) + uint32_t(Len) > MemSize ||
+      uint64_t(uint32_t(RHS)) + uint32_t(Len) > MemSize) {
+    Inst->setExceptionByHostapi(common::getError(ErrorCode::OutOfBoundsMemory));
+    return 0;
+  }
+  const uint8_t *MemBase = Inst->getDefaultMemoryInst().MemBase;
+  const uint8_t *LHSPtr = MemBase + uint32_t(LHS);
+  const uint8_t *LHSEnd = LHSPtr + uint32_t(Len);
+  const auto [LHSDiff, RHSDiff] =
+      std::mismatch(LHSPtr, LHSEnd, MemBase + uint32_t(RHS));
+  // the difference of the first unequal bytes, as wasm libcs return
+  return LHSDiff == LHSEnd ? 0 : int32_t(*LHSDiff) - int32_t(*RHSDiff);
+}
+
+int32_t Instance::strlenIntrinsic(Instance *Inst, int32_t Str) {
+  uint64_t MemSize =
+      Inst->hasMemory() ? Inst->getDefaultMemoryInst().MemSize : 0;
+  if (uint32_t(Str) >= MemSize) {
+    Inst->setExceptionByHostapi(common::getError(ErrorCode::OutOfBoundsMemory));
+    return 0;
+  }
+  const uint8_t *StrPtr = Inst->getDefaultMemoryInst().MemBase + uint32_t(Str);
+  const void *End = std::memchr(StrPtr, 0, MemSize - uint32_t(Str));
+  // an unterminated string runs past the end of the memory
+  if (!End) {
+    Inst->setExceptionByHostapi(common::getError(ErrorCode::OutOfBoundsMemory));
+    return 0;
+  }
+  uint32_t Len = static_cast<const uint8_t *>(End) - StrPtr;
+  if (!Inst->chargeBulkMemoryGas(Len + 1)) {
+    Inst->setExceptionByHostapi(common::getError(ErrorCode::GasLimitExceeded));
+    return 0;
+  }
+  return Len;
+}
+
+// the dynamic gas of u256_exp per byte of the exponent, as the evm EXP
+static constexpr uint64_t U256ExpByteGas = 50;
+
+bool Instance::checkU256Intrinsic(HostapiIntrinsic Intrinsic,
+                                  std::initializer_list<int32_t> Offsets) {
+  if (!chargeGas(getHostapiIntrinsicGas(Intrinsic))) {
+    setExceptionByHostapi(common::getError(ErrorCode::GasLimitExceeded));
+    return false;
+  }
+  uint64_t MemSize = hasMemory() ? getDefaultMemoryInst().MemSize : 0;
+  for (int32_t Offset : Offsets) {
+    if (uint64_t(uint32_t(Offset)) + sizeof(utils::U256) > MemSize) {
+      setExceptionByHostapi(common::getError(ErrorCode::OutOfBoundsMemory));
+      return false;
+    }
+  }
+  return true;
+}
+
+utils::U256 Instance::loadU256(int32_t Offset) const {
+  utils::U256 Val;
+  std::memcpy(&Val, getDefaultMemoryInst().MemBase + uint32_t(Offset),
+              sizeof(Val));
+  return Val;
+}
+
+void Instance::storeU256(int32_t Offset, const utils::U256 &Val) {
+  std::memcpy(getDefaultMemoryInst().MemBase + uint32_t(Offset), &Val,
+              sizeof(Val));
+}
+
+int32_t Instance::u256AddIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                   int32_t RHS) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_add, {Dst, LHS, RHS})) {
+    return 0;
+  }
+  utils::U256 Res;
+  bool Carry = utils::addU256(Res, Inst->loadU256(LHS), Inst->loadU256(RHS));
+  Inst->storeU256(Dst, Res);
+  return Carry;
+}
+
+int32_t Instance::u256SubIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                   int32_t RHS) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_sub, {Dst, LHS, RHS})) {
+    return 0;
+  }
+  utils::U256 Res;
+  bool Borrow = utils::subU256(Res, Inst->loadU256(LHS), Inst->loadU256(RHS));
+  Inst->storeU256(Dst, Res);
+  return Borrow;
+}
+
+int32_t Instance::u256MulIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                   int32_t RHS) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_mul, {Dst, LHS, RHS})) {
+    return 0;
+  }
+  utils::U256 Res;
+  bool Overflow =
+      utils::mulU256(Res, Inst->loadU256(LHS), Inst->loadU256(RHS));
+  Inst->storeU256(Dst, Res);
+  return Overflow;
+}
+
+int32_t Instance::u256DivIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                   int32_t RHS) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_div, {Dst, LHS, RHS})) {
+    return 0;
+  }
+  utils::U256 Divisor = Inst->loadU256(RHS);
+  utils::U256 Quot, Rem;
+  utils::divModU256(Quot, Rem, Inst->loadU256(LHS), Divisor);
+  Inst->storeU256(Dst, Quot);
+  return utils::getU256BitWidth(Divisor) == 0;
+}
+
+int32_t Instance::u256ModIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                   int32_t RHS) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_mod, {Dst, LHS, RHS})) {
+    return 0;
+  }
+  utils::U256 Divisor = Inst->loadU256(RHS);
+  utils::U256 Quot, Rem;
+  utils::divModU256(Quot, Rem, Inst->loadU256(LHS), Divisor);
+  Inst->storeU256(Dst, Rem);
+  return utils::getU256BitWidth(Divisor) == 0;
+}
+
+int32_t Instance::u256ExpIntrinsic(Instance *Inst, int32_t Dst, int32_t Base,
+                                   int32_t Exp) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_exp,
+                                {Dst, Base, Exp})) {
+    return 0;
+  }
+  utils::U256 Exponent = Inst->loadU256(Exp);
+  uint32_t ExpBytes = (utils::getU256BitWidth(Exponent) + 7) / 8;
+  if (!Inst->chargeGas(U256ExpByteGas * ExpBytes)) {
+    Inst->setExceptionByHostapi(common::getError(ErrorCode::GasLimitExceeded));
+    return 0;
+  }
+  utils::U256 Res;
+  utils::expU256(Res, Inst->loadU256(Base), Exponent);
+  Inst->storeU256(Dst, Res);
+  return 0;
+}
+
+int32_t Instance::u256ShlIntrinsic(Instance *Inst, int32_t Dst, int32_t Val,
+                                   int32_t Shift) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_shl, {Dst, Val})) {
+    return 0;
+  }
+  utils::U256 Res;
+  utils::shlU256(Res, Inst->loadU256(Val), uint32_t(Shift));
+  Inst->storeU256(Dst, Res);
+  return 0;
+}
+
+int32_t Instance::u256ShrIntrinsic(Instance *Inst, int32_t Dst, int32_t Val,
+                                   int32_t Shift) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_shr, {Dst, Val})) {
+    return 0;
+  }
+  utils::U256 Res;
+  utils::shrU256(Res, Inst->loadU256(Val), uint32_t(Shift));
+  Inst->storeU256(Dst, Res);
+  return 0;
+}
+
+int32_t Instance::u256CmpIntrinsic(Instance *Inst, int32_t LHS, int32_t RHS) {
+  if (!Inst->checkU256Intrinsic(HostapiIntrinsic::u256_cmp, {LHS, RHS})) {
+    return 0;
+  }
+  return utils::compareU256(Inst->loadU256(LHS), Inst->loadU256(RHS));
+}
+
 // ==================== Error/Exception Methods ====================
 
 void Instance::setExecutionError(const Error &NewErr, uint32_t IgnoredDepth,
@@ -294,7 +618,7 @@ void Instance::setExecutionError(const Error &NewErr, uint32_t IgnoredDepth,
   }
 
 #ifdef ZEN_ENABLE_DUMP_CALL_STACK
-  auto Mode = getRuntime()->getConfig().Mode;
+  auto Mode = Mod->getRunMode();
   using common::RunMode;
   if (Mode == RunMode::SinglepassMode || Mode == RunMode::MultipassMode) {
     if (NumTraces == 0 &&
@@ -323,6 +647,34 @@ int32_t Instance::growInstanceMemoryOnJIT(Instance *Inst,
   return -1;
 }
 
+void Instance::initMemoryOnJIT(Instance *Inst, uint32_t DataIdx, uint32_t Dst,
+                               uint32_t Src, uint32_t Len) {
+  ErrorCode Err = Inst->initMemory(DataIdx, Dst, Src, Len);
+  if (Err != ErrorCode::NoError) {
+    setInstanceExceptionOnJIT(Inst, Err);
+  }
+}
+
+void Instance::copyMemoryOnJIT(Instance *Inst, uint32_t Dst, uint32_t Src,
+                               uint32_t Len) {
+  ErrorCode Err = Inst->copyMemory(Dst, Src, Len);
+  if (Err != ErrorCode::NoError) {
+    setInstanceExceptionOnJIT(Inst, Err);
+  }
+}
+
+void Instance::fillMemoryOnJIT(Instance *Inst, uint32_t Dst, uint32_t Val,
+                               uint32_t Len) {
+  ErrorCode Err = Inst->fillMemory(Dst, Val, Len);
+  if (Err != ErrorCode::NoError) {
+    setInstanceExceptionOnJIT(Inst, Err);
+  }
+}
+
+void Instance::dropDataSegmentOnJIT(Instance *Inst, uint32_t DataIdx) {
+  Inst->dropDataSegment(DataIdx);
+}
+
 void Instance::setInstanceExceptionOnJIT(Instance *Inst,
                                          common::ErrorCode ErrCode) {
   Inst->setExecutionError(common::getError(ErrCode), 1,
@@ -353,8 +705,9 @@ void Instance::createCallStackOnJIT(uint32_t IgnoredDepth,
   void *FrameAddr = __builtin_frame_address(0);
   std::vector<void *> TraceAddrs;
 
-  void *JITCode = Mod->JITCode;
-  void *JITCodeEnd = static_cast<uint8_t *>(JITCode) + Mod->JITCodeSize;
+  const void *JITCode = this->JITCode;
+  const void *JITCodeEnd =
+      static_cast<const uint8_t *>(JITCode) + Mod->JITCodeSize;
 
   if (TS.Traces) {
     TraceAddrs = *TS.Traces;
@@ -380,9 +733,10 @@ void Instance::createCallStackOnJIT(uint32_t IgnoredDepth,
 int32_t Instance::getFuncIndexByAddrOnJIT(void *Addr) {
   using common::RunMode;
   // find from internal functions
-  RunMode Mode = getRuntime()->getConfig().Mode;
-  void *JITCode = Mod->JITCode;
-  void *JITCodeEnd = static_cast<uint8_t *>(JITCode) + Mod->JITCodeSize;
+  RunMode Mode = Mod->getRunMode();
+  const void *JITCode = this->JITCode;
+  const void *JITCodeEnd =
+      static_cast<const uint8_t *>(JITCode) + Mod->JITCodeSize;
   if (Mode == RunMode::SinglepassMode) {
     if (Addr >= JITCode && Addr < JITCodeEnd) {
       uintptr_t *BoundStart = JITFuncPtrs + Mod->NumImportFunctions;
@@ -8,6 +8,8 @@
 #include "common/traphandler.h"
 #include "runtime/module.h"
 #include "utils/backtrace.h"
+#include "utils/u256.h"
+#include <vector>
 #ifdef ZEN_ENABLE_VIRTUAL_STACK
 #include "utils/virtual_stack.h"
 #include <queue>
@@ -54,14 +56,17 @@ struct FunctionInstance final {
   uint32_t CodeSize;
 
   FunctionKind Kind : 2;
-  uint8_t NumReturns : 2;
-  uint8_t NumReturnCells : 4;
-  WASMType ReturnTypes[2];
+  uint16_t NumReturns;
+  uint16_t NumReturnCells;
 
   union {
     WASMType *ParamTypes;
     WASMType ParamTypesVec[__WORDSIZE / 8];
   };
+  union {
+    WASMType *ReturnTypes;
+    WASMType ReturnTypesVec[__WORDSIZE / 8];
+  };
   TypeEntry *FuncType;
   WASMType *LocalTypes;
   uint32_t *LocalOffsets;
@@ -74,6 +79,10 @@ struct FunctionInstance final {
     return NumParams > (__WORDSIZE / 8) ? ParamTypes : ParamTypesVec;
   }
 
+  WASMType *getReturnTypes() {
+    return NumReturns > (__WORDSIZE / 8) ? ReturnTypes : ReturnTypesVec;
+  }
+
   WASMType getLocalType(uint32_t LocalIdx) {
     ZEN_ASSERT(LocalIdx < (NumParams + NumLocals));
     if (LocalIdx < NumParams) {
@@ -173,6 +182,27 @@ public:
   bool __attribute__((noinline))
   validatedNativeAddr(uint8_t *NativeAddr, uint32_t Size);
 
+  // bulk memory operations on the default memory, charging gas by size when
+  // the module is metered. return the trap code, or NoError on success
+
+  ErrorCode initMemory(uint32_t DataIdx, uint32_t Dst, uint32_t Src,
+                       uint32_t Len);
+
+  ErrorCode copyMemory(uint32_t Dst, uint32_t Src, uint32_t Len);
+
+  ErrorCode fillMemory(uint32_t Dst, uint32_t Val, uint32_t Len);
+
+  void dropDataSegment(uint32_t DataIdx) {
+    ZEN_ASSERT(DataIdx < DroppedDataSegs.size());
+    DroppedDataSegs[DataIdx] = true;
+  }
+
+  // ==================== Hostapi Intrinsic Methods ====================
+
+  // \return the implementation of \p Intrinsic, called like the hostapi it
+  // replaces with the instance as the first argument
+  static const void *getHostapiIntrinsicFunc(HostapiIntrinsic Intrinsic);
+
   // ==================== Global Accessing Methods ====================
 
   uint8_t *getGlobalAddr(uint32_t GlobalIdx) {
@@ -226,6 +256,20 @@ public:
 
   void setJITStackSize(uint64_t NewStackSize) { JITStackSize = NewStackSize; }
 
+  // the copy of module JIT code used by this instance, see NUMA code
+  // replication in RuntimeConfig
+  const void *getJITCode() const { return JITCode; }
+
+  // bulk memory helpers called by JIT code, which checks the instance
+  // exception after the call
+  static void initMemoryOnJIT(Instance *Inst, uint32_t DataIdx, uint32_t Dst,
+                              uint32_t Src, uint32_t Len);
+  static void copyMemoryOnJIT(Instance *Inst, uint32_t Dst, uint32_t Src,
+                              uint32_t Len);
+  static void fillMemoryOnJIT(Instance *Inst, uint32_t Dst, uint32_t Val,
+                              uint32_t Len);
+  static void dropDataSegmentOnJIT(Instance *Inst, uint32_t DataIdx);
+
   static void __attribute__((noinline))
   setInstanceExceptionOnJIT(Instance *Inst, ErrorCode ErrCode);
   static void __attribute__((noinline))
@@ -260,12 +304,26 @@ public:
   uint64_t getGas() const { return Gas; }
   void setGas(uint64_t NewGas) { Gas = NewGas; }
 
+  // \return false and clear the gas left when it can't pay \p Cost
+  bool chargeGas(uint64_t Cost);
+
+  /// \return the counters indexed by internal function index, nullptr
+  /// unless function profiling is enabled
+  FunctionCounters *getFunctionCounters() const { return FuncCounters; }
+
+  FunctionCounters &getFunctionCounters(const FunctionInstance *FuncInst) {
+    ZEN_ASSERT(FuncCounters);
+    uint32_t FuncIdx = FuncInst - Functions;
+    ZEN_ASSERT(FuncIdx >= Mod->getNumImportFunctions());
+    return FuncCounters[FuncIdx - Mod->getNumImportFunctions()];
+  }
+
   void *getCustomData() { return CustomData; }
   void setCustomData(void *NewCustomData) { CustomData = NewCustomData; }
 
-  // wasm instance enabled by default
-  // but after call some child instance, the parent maybe not active
-  // need enable it again
+  // wasm instance enabled by default, and every linear memory owns its own
+  // reservation, so calling child instances never disables the parent's
+  // memory. kept for compatibility, it only re-applies the read/write access
   void protectMemoryAgain();
 
 #ifdef ZEN_ENABLE_VIRTUAL_STACK
@@ -305,6 +363,47 @@ private:
 
   void protectMemory();
 
+  // \return false and clear the gas left when it can't pay for \p Len bytes
+  bool chargeBulkMemoryGas(uint32_t Len) {
+    return chargeGas(common::getBulkMemoryGas(Len));
+  }
+
+  // memcpy and memmove share the overlapping copy of memory.copy, every
+  // intrinsic traps and charges gas like the bulk memory operations
+  static int32_t memcpyIntrinsic(Instance *Inst, int32_t Dst, int32_t Src,
+                                 int32_t Len);
+  static int32_t memsetIntrinsic(Instance *Inst, int32_t Dst, int32_t Val,
+                                 int32_t Len);
+  static int32_t memcmpIntrinsic(Instance *Inst, int32_t LHS, int32_t RHS,
+                                 int32_t Len);
+  static int32_t strlenIntrinsic(Instance *Inst, int32_t Str);
+
+  // charge the gas of \p Intrinsic and check that the u256 values at
+  // \p Offsets are in the memory, \return false after setting the exception
+  // when either fails
+  bool checkU256Intrinsic(HostapiIntrinsic Intrinsic,
+                          std::initializer_list<int32_t> Offsets);
+  utils::U256 loadU256(int32_t Offset) const;
+  void storeU256(int32_t Offset, const utils::U256 &Val);
+
+  static int32_t u256AddIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                  int32_t RHS);
+  static int32_t u256SubIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                  int32_t RHS);
+  static int32_t u256MulIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                  int32_t RHS);
+  static int32_t u256DivIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                  int32_t RHS);
+  static int32_t u256ModIntrinsic(Instance *Inst, int32_t Dst, int32_t LHS,
+                                  int32_t RHS);
+  static int32_t u256ExpIntrinsic(Instance *Inst, int32_t Dst, int32_t Base,
+                                  int32_t Exp);
+  static int32_t u256ShlIntrinsic(Instance *Inst, int32_t Dst, int32_t Val,
+                                  int32_t Shift);
+  static int32_t u256ShrIntrinsic(Instance *Inst, int32_t Dst, int32_t Val,
+                                  int32_t Shift);
+  static int32_t u256CmpIntrinsic(Instance *Inst, int32_t LHS, int32_t RHS);
+
   Isolation *Iso = nullptr;
   const Module *Mod = nullptr;
 
@@ -330,6 +429,8 @@ private:
 
   uint64_t Gas = 0;
 
+  FunctionCounters *FuncCounters = nullptr;
+
   // exit code set by Instance.exit(ExitCode)
   int32_t InstanceExitCode = 0;
 
@@ -358,6 +459,13 @@ private:
 
   bool DataSegsInited = false;
 
+  // indexed by data segment, active segments are dropped once instantiated
+  std::vector<bool> DroppedDataSegs;
+
+#ifdef ZEN_ENABLE_JIT
+  const void *JITCode = nullptr;
+#endif
+
 #ifdef ZEN_ENABLE_VIRTUAL_STACK
   // one instance maybe called by hostapi( instanceA -> hostapi -> instanceA )
   std::queue<utils::VirtualStackInfo *> VirtualStacks;
@@ -4,6 +4,7 @@
 #include "runtime/isolation.h"
 
 #include "runtime/instance.h"
+#include "utils/metrics.h"
 
 extern struct WNINativeInterface_ *wni_functions();
 namespace zen::runtime {
@@ -29,9 +30,11 @@ Isolation::createInstance(Module &Mod, uint64_t GasLimit) noexcept {
   auto &Stats = getRuntime()->getStatistics();
   auto Timer = Stats.startRecord(utils::StatisticPhase::Instantiation);
   try {
+    utils::ScopedMetricTimer MetricTimer(utils::MetricLatency::Instantiation);
     Inst = Instance::newInstance(*this, Mod, GasLimit);
   } catch (const Error &Err) {
     Stats.clearAllTimers();
+    utils::Metrics::addCounter(utils::MetricCounter::InstantiationErrors);
     return Err;
   }
   Stats.stopRecord(Timer);
@@ -3,6 +3,7 @@
 
 #include "runtime/memory.h"
 #include "common/enums.h"
+#include "platform/numa.h"
 #include "runtime/module.h"
 #include "utils/logging.h"
 #include "utils/others.h"
@@ -26,16 +27,14 @@ static bool verifyCanUseMmapBucketByModuleDataSegments(Module *Mod) {
   if (InitMemorySize > MmapMemoryFileMaxSize) {
     return false;
   }
-  if (WasmMemoryAllocatorMmapSize > 0 &&
-      InitMemorySize >
-          WasmMemoryAllocatorMmapSize / WasmMemoryAllocatorBucketDuplicates) {
-    return false;
-  }
   if (Mod->getNumTotalMemories() != 1 || Mem.InitSize == 0) {
     return false;
   }
   for (size_t I = 0; I < Mod->getNumDataSegments(); I++) {
     auto *Seg = Mod->getDataEntry(I);
+    if (Seg->Passive) {
+      continue;
+    }
     if (Seg->MemIdx != 0) {
       return false;
     }
@@ -67,6 +66,7 @@ WasmMemoryAllocator::WasmMemoryAllocator(
 #ifdef ZEN_ENABLE_CPU_EXCEPTION
     UseMmap = true;
 #endif // ZEN_ENABLE_CPU_EXCEPTION
+    BindNumaNode = UseMmap && Options->BindNumaNode;
     bool UseMmapBucket = UseMmap;
     // if wasm module data segments has init-expr which not use i32/i64,
     // then not use mmap
@@ -79,19 +79,18 @@ WasmMemoryAllocator::WasmMemoryAllocator(
       auto Timer = Stats.startRecord(utils::StatisticPhase::MemoryBucketMap);
       int MmapFileFd;
       char Path[80] = {0};
-      static uint64_t PathIdBegin = 0;
-      if (PathIdBegin == 0) {
-        PathIdBegin = static_cast<uint64_t>((intptr_t)Mod);
-      } else {
-        PathIdBegin++;
-      }
+      // modules may be loaded concurrently, every allocator needs its own file
+      static std::atomic<uint64_t> PathIdCounter = 0;
+      static const uint64_t PathIdBegin =
+          static_cast<uint64_t>((intptr_t)Mod);
+      uint64_t PathId = PathIdBegin + PathIdCounter++;
 #ifdef ZEN_BUILD_PLATFORM_DARWIN
       ::sprintf((char *)Path,
                 "/Volumes/RAMDisk/zetaengine_init_memory_%ld_%d.memory",
-                PathIdBegin, Options->MemoryIndex);
+                PathId, Options->MemoryIndex);
 #else
       ::sprintf(Path, "/dev/shm/zetaengine_init_memory_%ld_%d.memory",
-                PathIdBegin, Options->MemoryIndex);
+                PathId, Options->MemoryIndex);
 #endif // ZEN_BUILD_PLATFORM_DARWIN
       MmapFileFd = ::open(Path, O_RDWR | O_CREAT, 644);
       if (MmapFileFd < 0) {
@@ -103,10 +102,6 @@ WasmMemoryAllocator::WasmMemoryAllocator(
       }
       MmapMemoryFilepath = ::strdup(Path);
       DefaultMemoryType = WM_MEMORY_DATA_TYPE_BUCKET_MMAP;
-      MmapMemoryBucketGrowMaxSize = MmapMemoryFileMaxSize;
-      MmapAddresses = new std::unordered_set<uint8_t *>();
-      MemoryAddrToMmapAddr = new std::unordered_map<uint8_t *, uint8_t *>();
-      MmapBucketsFreedCount = new std::unordered_map<uint8_t *, size_t *>();
       // create default linear memory and write to new memory file, open the
       // memory file
       if (Mod->getNumTotalMemories() == 1 &&
@@ -117,22 +112,21 @@ WasmMemoryAllocator::WasmMemoryAllocator(
         if (MaxMemorySize < InitMemorySize) {
           MaxMemorySize = InitMemorySize;
         }
-        size_t SingleInitFileSize = InitMemorySize;
-        if (MaxMemorySize < SingleInitFileSize) {
-          SingleInitFileSize = MaxMemorySize;
+        size_t InitFileSize = InitMemorySize;
+        if (MaxMemorySize < InitFileSize) {
+          InitFileSize = MaxMemorySize;
         }
-        ZEN_ASSERT(SingleInitFileSize <= MmapMemoryBucketGrowMaxSize);
-
-        size_t BucketFileSize =
-            MmapMemoryBucketGrowMaxSize * WasmMemoryAllocatorBucketDuplicates;
+        ZEN_ASSERT(InitFileSize <= MmapMemoryFileMaxSize);
 
-        if (0 != ::ftruncate(MmapFileFd, BucketFileSize)) {
+        // only one copy of the init image is needed, every instance maps it
+        // privately(copy-on-write) into its own reservation
+        if (0 != ::ftruncate(MmapFileFd, InitFileSize)) {
           ZEN_ABORT();
         }
 
         for (size_t I = 0; I < Mod->getNumDataSegments(); I++) {
           auto *Seg = Mod->getDataEntry(I);
-          if (Seg->MemIdx != 0) {
+          if (Seg->Passive || Seg->MemIdx != 0) {
             continue;
           }
           int64_t BaseOffset = 0;
@@ -145,42 +139,26 @@ WasmMemoryAllocator::WasmMemoryAllocator(
           }
           ZEN_ASSERT(BaseOffset + (int64_t)Seg->Size <=
                      (int64_t)InitMemorySize);
-          for (size_t I = 0; I < WasmMemoryAllocatorBucketDuplicates; I++) {
-            // copy segments to all copies in memory bucket file
-            ::lseek(MmapFileFd, I * MmapMemoryBucketGrowMaxSize + BaseOffset,
-                    SEEK_SET);
-            if (Seg->Size != os_write(MmapFileFd,
-                                      Mod->getWASMBytecode() + Seg->Offset,
-                                      Seg->Size)) {
-              ZEN_ABORT();
-            }
+          ::lseek(MmapFileFd, BaseOffset, SEEK_SET);
+          if (Seg->Size != os_write(MmapFileFd,
+                                    Mod->getWASMBytecode() + Seg->Offset,
+                                    Seg->Size)) {
+            ZEN_ABORT();
           }
         }
-        MmapMemoryInitFileSize = BucketFileSize;
+        MmapMemoryInitFileSize = InitFileSize;
         MmapMemoryInitFd = MmapFileFd;
-        MmapBucketItemSize = SingleInitFileSize;
-        MmapBucketSize = BucketFileSize;
       }
       Stats.stopRecord(Timer);
     } else {
       // when cpu-trap enabled, jit will not generate soft-memory check
       // so at least use single mmap mode to mprotect the memory
       DefaultMemoryType = WasmMemoryDataType::WM_MEMORY_DATA_TYPE_SINGLE_MMAP;
-      MmapMemoryBucketGrowMaxSize = WasmMemoryAllocatorMmapSize;
     }
   }
 }
 WasmMemoryAllocator::~WasmMemoryAllocator() {
   if (UseMmap) {
-    if (MmapAddresses) {
-      for (const auto &P : *MmapAddresses) {
-        auto MmapSize = (size_t)MmapMemoryInitFileSize;
-        if (0 != ::munmap(P, MmapSize)) {
-          ZEN_ABORT();
-        }
-      }
-      delete MmapAddresses;
-    }
     if (MmapMemoryInitFd > 0) {
       ::close(MmapMemoryInitFd);
       // delete the memory file forcely
@@ -193,13 +171,6 @@ WasmMemoryAllocator::~WasmMemoryAllocator() {
     if (MmapMemoryFilepath) {
       ::free(MmapMemoryFilepath);
     }
-    delete MemoryAddrToMmapAddr;
-    if (MmapBucketsFreedCount) {
-      for (const auto &P : *MmapBucketsFreedCount) {
-        ::free(P.second);
-      }
-      delete MmapBucketsFreedCount;
-    }
   }
 }
 bool WasmMemoryAllocator::checkWasmMemoryCanUseMmap() {
@@ -212,115 +183,57 @@ bool WasmMemoryAllocator::checkWasmMemoryCanUseMmap() {
   }
   return CanUseMmap;
 }
-WasmMemoryBucketSlice WasmMemoryAllocator::getOrCreateMmapSpace(
-    const uint8_t
-        *BucketAllocSand, // sand to alloc bucket. eg. Module*Instance*
-    size_t InitLinearMemorySize) {
-  if (UseMmap) {
-    common::LockGuard<common::Mutex> _(BucketLock);
 
-    if (!BucketInstanceForAllocate) {
-      // private mmap from memory file fd
-      // mprotect 8GB to use cpu-trap to check memory load/store
-      size_t MmapSize = WasmMemoryAllocatorMmapSize;
-      ZEN_ASSERT(sizeof(size_t) > 4);
+uint8_t *WasmMemoryAllocator::reserveWasmMemorySpace() {
+  // mprotect 8GB to use cpu-trap to check memory load/store
+  size_t MmapSize = WasmMemoryAllocatorMmapSize;
+  ZEN_ASSERT(sizeof(size_t) > 4);
 
-      auto BucketMemAddr =
-          (uint8_t *)::mmap(nullptr, MmapSize, PROT_NONE,
-                            MAP_FILE | MAP_PRIVATE, MmapMemoryInitFd, 0);
-      if (!BucketMemAddr || (BucketMemAddr == (uint8_t *)-1)) {
-        ZEN_ABORT();
-      }
-      MmapAddresses->insert(BucketMemAddr);
-      auto *BucketFreeCount = (size_t *)::malloc(sizeof(size_t));
-      if (!BucketFreeCount) {
-        ZEN_ABORT();
-      }
-      *BucketFreeCount = 0;
-      MmapBucketsFreedCount->emplace(BucketMemAddr, BucketFreeCount);
-      uint8_t *MemoryData = BucketMemAddr;
-      MemoryAddrToMmapAddr->emplace(MemoryData, BucketMemAddr);
-
-      ActiveBuckets.insert(std::make_pair(
-          BucketMemAddr,
-          std::make_shared<MmapBucketInstance>(
-              BucketMemAddr,
-              MmapMemoryBucketGrowMaxSize * WasmMemoryAllocatorBucketDuplicates,
-              MmapMemoryBucketGrowMaxSize, MmapSize)));
-      auto *NewBucketInstance = ActiveBuckets[BucketMemAddr].get();
-      BucketInstanceForAllocate = NewBucketInstance;
-
-      NewBucketInstance->ItemsUsedSizes[0] = InitLinearMemorySize;
-      NewBucketInstance->NextOffset += NewBucketInstance->BucketItemSize;
-
-      MemoryAddrToMmapAddr->insert(
-          std::make_pair(BucketMemAddr, BucketMemAddr));
+  auto *MemoryData = (uint8_t *)::mmap(
+      nullptr, MmapSize, PROT_NONE,
+      MAP_ANONYMOUS | MAP_PRIVATE | MAP_NORESERVE, -1, 0);
+  if (!MemoryData || (MemoryData == (uint8_t *)-1)) {
+    ZEN_ABORT();
+  }
+  bindToCurrentNumaNode(MemoryData, MmapSize);
+  return MemoryData;
+}
 
-      return WasmMemoryBucketSlice{
-          .Address = MemoryData,
-          .BucketBegin = BucketMemAddr,
-          .BucketSize = NewBucketInstance->Size,
-      };
-    }
-    // use the last bucket instance to allocate.
-    // when the last bucket instance used out, then set
-    // BucketInstanceForAllocate to nullptr
-    auto Result = WasmMemoryBucketSlice{
-        .Address = BucketInstanceForAllocate->MmapAddr +
-                   BucketInstanceForAllocate->NextOffset,
-        .BucketBegin = BucketInstanceForAllocate->MmapAddr,
-        .BucketSize = BucketInstanceForAllocate->Size,
-    };
-    BucketInstanceForAllocate->NextOffset +=
-        BucketInstanceForAllocate->BucketItemSize;
-    if (BucketInstanceForAllocate->NextOffset >=
-        BucketInstanceForAllocate->Size) {
-      BucketInstanceForAllocate = nullptr;
-    }
-    MemoryAddrToMmapAddr->insert(
-        std::make_pair(Result.Address, Result.BucketBegin));
+void WasmMemoryAllocator::mapInitMemoryImage(uint8_t *MemoryData) {
+  ZEN_ASSERT(MmapMemoryInitFd > 0);
+  // private mmap from memory file fd, pages of the file are shared by all
+  // instances until they are written
+  auto *ImageAddr = (uint8_t *)::mmap(MemoryData, MmapMemoryInitFileSize,
+                                      PROT_NONE, MAP_PRIVATE | MAP_FIXED,
+                                      MmapMemoryInitFd, 0);
+  if (ImageAddr != MemoryData) {
+    ZEN_ABORT();
+  }
+  // the fixed mapping replaced the policy set on the reservation
+  bindToCurrentNumaNode(MemoryData, MmapMemoryInitFileSize);
+}
 
-    return Result;
-  } else {
-    ZEN_ASSERT(false);
-    return WasmMemoryBucketSlice{
-        .Address = nullptr,
-    };
+void WasmMemoryAllocator::bindToCurrentNumaNode(uint8_t *MemoryData,
+                                                size_t Size) {
+  if (!BindNumaNode) {
+    return;
   }
+  // only a placement hint, fall back to the default policy on failure
+  platform::bindMemoryToNumaNode(MemoryData, Size,
+                                 platform::getCurrentNumaNode());
 }
 
 void WasmMemoryAllocator::mprotectReadWriteWasmMemoryData(
-    const WasmMemoryData &Data, bool UnprotectBucket) {
+    const WasmMemoryData &Data) {
   if (Data.Type != WasmMemoryDataType::WM_MEMORY_DATA_TYPE_BUCKET_MMAP &&
       Data.Type != WasmMemoryDataType::WM_MEMORY_DATA_TYPE_SINGLE_MMAP) {
     return;
   }
-  if (!Data.MemoryData) {
+  if (!Data.MemoryData || !Data.MemorySize) {
     return;
   }
-  if (UseMmap) {
-    if (UnprotectBucket &&
-        Data.Type == WasmMemoryDataType::WM_MEMORY_DATA_TYPE_BUCKET_MMAP) {
-
-      auto BucketIt = MemoryAddrToMmapAddr->find(Data.MemoryData);
-      ZEN_ASSERT(BucketIt != MemoryAddrToMmapAddr->end());
-      auto *Bucket = BucketIt->second;
-      auto *BucketInstance = ActiveBuckets[Bucket].get();
-      for (size_t I = 0; I < BucketInstance->ItemsUsedSizes.size(); I++) {
-        auto ItemSize = BucketInstance->ItemsUsedSizes[I];
-        if (ItemSize <= 0) {
-          continue;
-        }
-        auto ItemBeginAddr =
-            BucketInstance->MmapAddr + I * BucketInstance->BucketItemSize;
-        if (0 != ::mprotect(ItemBeginAddr, ItemSize, PROT_NONE)) {
-          ZEN_ABORT();
-        }
-      }
-    }
-  }
   if (0 !=
-      ::mprotect(Data.MemoryData, Data.MemorySize, PROT_WRITE | PROT_WRITE)) {
+      ::mprotect(Data.MemoryData, Data.MemorySize, PROT_READ | PROT_WRITE)) {
     ZEN_ABORT();
   }
 }
@@ -330,23 +243,13 @@ WasmMemoryData WasmMemoryAllocator::allocateNonBucketMemory(size_t MemorySize) {
   if (UseMmap) {
     // when wasm memory overflow check by cpu,
     // then all linear memories should allocated by mmap
-    size_t MmapSize = WasmMemoryAllocatorMmapSize;
-    ZEN_ASSERT(sizeof(size_t) > 4);
-
-    auto *MemoryData =
-        (uint8_t *)::mmap(nullptr, MmapSize, PROT_NONE,
-                          MAP_ANONYMOUS | MAP_FILE | MAP_PRIVATE, -1, 0);
-    if (!MemoryData || (MemoryData == (uint8_t *)-1)) {
-      ZEN_ABORT();
-    }
-
     WasmMemoryData Result = {
         .Type = WM_MEMORY_DATA_TYPE_SINGLE_MMAP,
-        .MemoryData = MemoryData,
+        .MemoryData = reserveWasmMemorySpace(),
         .MemorySize = MemorySize,
         .NeedMprotect = true,
     };
-    mprotectReadWriteWasmMemoryData(Result, false);
+    mprotectReadWriteWasmMemoryData(Result);
     return Result;
   } else {
     auto *MemoryData = (uint8_t *)CurRuntime->allocateZeros(MemorySize);
@@ -364,32 +267,20 @@ WasmMemoryData WasmMemoryAllocator::allocateNonBucketMemory(size_t MemorySize) {
 WasmMemoryData WasmMemoryAllocator::reallocateNonBucketMemoryAndFillZerosToNew(
     const WasmMemoryData &OldMemoryData, size_t NewMemorySize) {
   if (UseMmap) {
-    // when wasm memory overflow check by cpu,
-    // then all linear memories should allocated by mmap
-    size_t MmapSize = WasmMemoryAllocatorMmapSize;
-    ZEN_ASSERT(sizeof(size_t) > 4);
-    auto *NewMemoryData =
-        (uint8_t *)::mmap(nullptr, MmapSize, PROT_NONE,
-                          MAP_ANONYMOUS | MAP_FILE | MAP_PRIVATE, -1, 0);
-    if (!NewMemoryData || (NewMemoryData == (uint8_t *)-1)) {
-      ZEN_ABORT();
-    }
-
-    WasmMemoryData Result = {
-        .Type = WM_MEMORY_DATA_TYPE_SINGLE_MMAP,
-        .MemoryData = NewMemoryData,
-        .MemorySize = NewMemorySize,
-        .NeedMprotect = true,
-    };
-    WasmMemoryAllocator::mprotectReadWriteWasmMemoryData(Result, false);
-
+    // the reservation already covers the max linear memory size, so only the
+    // new pages need to be made accessible
     if (OldMemoryData.MemoryData) {
       ZEN_ASSERT(NewMemorySize >= OldMemoryData.MemorySize);
-      std::memcpy(NewMemoryData, OldMemoryData.MemoryData,
-                  OldMemoryData.MemorySize);
-      internalFreeWasmMemory(OldMemoryData);
+      WasmMemoryData Result = {
+          .Type = OldMemoryData.Type,
+          .MemoryData = OldMemoryData.MemoryData,
+          .MemorySize = NewMemorySize,
+          .NeedMprotect = true,
+      };
+      mprotectReadWriteWasmMemoryData(Result);
+      return Result;
     }
-    return Result;
+    return allocateNonBucketMemory(NewMemorySize);
   }
   uint8_t *NewMemoryAddr = nullptr;
   if (!OldMemoryData.MemoryData) {
@@ -422,7 +313,9 @@ WasmMemoryData WasmMemoryAllocator::allocInitWasmMemory(
     uint8_t *BucketAllocSand, size_t MemorySize, bool ThisInstanceUseMmap,
     /* out */ bool *FilledInitData,
     /* out */ char *ErrorBuf, uint32_t ErrorBufSize) {
-  if (MemorySize == 0) {
+  // when mmap enabled, the reservation is made even for empty memory, so that
+  // the memory base is fixed since instantiation
+  if (MemorySize == 0 && !UseMmap) {
     return WasmMemoryData{
         .Type = WasmMemoryDataType::WM_MEMORY_DATA_TYPE_NO_DATA,
         .MemoryData = nullptr,
@@ -430,82 +323,38 @@ WasmMemoryData WasmMemoryAllocator::allocInitWasmMemory(
         .NeedMprotect = false,
     };
   }
-  bool InstanceUseMmap = ThisInstanceUseMmap && checkWasmMemoryCanUseMmap();
-  WasmMemoryData Result;
+  bool InstanceUseMmap = ThisInstanceUseMmap && checkWasmMemoryCanUseMmap() &&
+                         MemorySize >= MmapMemoryInitFileSize;
 
   if (InstanceUseMmap) {
-    const auto &MmapSlice = getOrCreateMmapSpace(BucketAllocSand, MemorySize);
-    ZEN_ASSERT(MmapSlice.Address);
+    uint8_t *MemoryData = reserveWasmMemorySpace();
+    mapInitMemoryImage(MemoryData);
     if (FilledInitData)
       *FilledInitData = true;
-    Result.Type = WM_MEMORY_DATA_TYPE_BUCKET_MMAP;
-    Result.MemoryData = MmapSlice.Address;
-    Result.MemorySize = MemorySize;
-    Result.NeedMprotect = true;
-    // unmprotect other region of the whole bucket
-    // not mmap_slice.bucket_size to avoid soft-check of memory visit
-    ZEN_ASSERT(sizeof(size_t) > 4);
-
-    auto *BucketInstance = ActiveBuckets[MmapSlice.BucketBegin].get();
-    for (size_t I = 0; I < BucketInstance->ItemsUsedSizes.size(); I++) {
-      auto ItemUsedSize = BucketInstance->ItemsUsedSizes[I];
-      if (ItemUsedSize <= 0) {
-        continue;
-      }
-      auto ItemBeginAddr =
-          BucketInstance->MmapAddr + I * BucketInstance->BucketItemSize;
-      if (0 != ::mprotect(ItemBeginAddr, ItemUsedSize, PROT_NONE)) {
-        ZEN_ABORT();
-      }
-    }
-
-    // mprotect the bucket slice
-    mprotectReadWriteWasmMemoryData(Result, false);
+    WasmMemoryData Result = {
+        .Type = WM_MEMORY_DATA_TYPE_BUCKET_MMAP,
+        .MemoryData = MemoryData,
+        .MemorySize = MemorySize,
+        .NeedMprotect = true,
+    };
+    mprotectReadWriteWasmMemoryData(Result);
     return Result;
   }
-  Result = allocateNonBucketMemory(MemorySize);
+  WasmMemoryData Result = allocateNonBucketMemory(MemorySize);
   if (FilledInitData)
     *FilledInitData = false;
   return Result;
 }
 
 void WasmMemoryAllocator::internalFreeWasmMemory(const WasmMemoryData &Data) {
-  if (Data.Type == WM_MEMORY_DATA_TYPE_SINGLE_MMAP) {
-    if (0 != ::munmap(Data.MemoryData, Data.MemorySize)) {
+  if (Data.Type == WM_MEMORY_DATA_TYPE_SINGLE_MMAP ||
+      Data.Type == WM_MEMORY_DATA_TYPE_BUCKET_MMAP) {
+    // release the whole reservation(including the mapped init image)
+    if (0 != ::munmap(Data.MemoryData, WasmMemoryAllocatorMmapSize)) {
       ZEN_ABORT();
     }
   } else if (Data.Type == WM_MEMORY_DATA_TYPE_MALLOC) {
     CurRuntime->deallocate(Data.MemoryData);
-  } else if (Data.Type == WM_MEMORY_DATA_TYPE_BUCKET_MMAP) {
-    auto MmapBucketIt = MemoryAddrToMmapAddr->find(Data.MemoryData);
-    ZEN_ASSERT(MmapBucketIt != MemoryAddrToMmapAddr->end());
-    auto *MmapBucket = MmapBucketIt->second;
-    auto BucketFreedCountPtrIt = MmapBucketsFreedCount->find(MmapBucket);
-    if (BucketFreedCountPtrIt != MmapBucketsFreedCount->end()) {
-      // when bucket_freed_count_ptr means the bucket freed before
-      auto *BucketFreedCountPtr = BucketFreedCountPtrIt->second;
-      *BucketFreedCountPtr += 1;
-      if (*BucketFreedCountPtr >= WasmMemoryAllocatorBucketDuplicates) {
-        // all freed, need munmap
-        size_t UnmapSize = MmapBucketSize;
-
-        // mprotect 8GB to use cpu-trap to check memory load/store
-        UnmapSize = WasmMemoryAllocatorMmapSize;
-        ZEN_ASSERT(sizeof(size_t) > 4);
-
-        if (0 != ::munmap(MmapBucket, UnmapSize)) {
-          ZEN_ABORT();
-        }
-        MmapAddresses->erase(MmapBucket);
-
-        ::free(BucketFreedCountPtr);
-
-        MmapBucketsFreedCount->erase(MmapBucket);
-
-        ActiveBuckets.erase(MmapBucket);
-      }
-    }
-    MemoryAddrToMmapAddr->erase(Data.MemoryData);
   } else {
     CurRuntime->deallocate(Data.MemoryData);
   }
@@ -514,54 +363,10 @@ void WasmMemoryAllocator::internalFreeWasmMemory(const WasmMemoryData &Data) {
 WasmMemoryData
 WasmMemoryAllocator::enlargeWasmMemory(const WasmMemoryData &OldMemoryData,
                                        size_t NewMemorySize) {
-  bool NeedFreeOldMmap = false;
-  if (UseMmap) {
-    // when use bucket with mmap linear-memory,
-    // memory.grow must re-alloc memory to grow
-    bool OldUseMmap = (OldMemoryData.Type == WM_MEMORY_DATA_TYPE_BUCKET_MMAP ||
-                       OldMemoryData.Type == WM_MEMORY_DATA_TYPE_SINGLE_MMAP);
-    bool InstanceUseMmap =
-        OldUseMmap && (NewMemorySize <= MmapMemoryBucketGrowMaxSize);
-    if (OldUseMmap && InstanceUseMmap) {
-      // the mmap item space has enough space to grow
-      const auto &NewMemoryData = WasmMemoryData{
-          .Type = OldMemoryData.Type,
-          .MemoryData = OldMemoryData.MemoryData,
-          .MemorySize = NewMemorySize,
-          .NeedMprotect = false,
-      };
-      if (OldMemoryData.Type == WM_MEMORY_DATA_TYPE_BUCKET_MMAP) {
-        auto *BucketMemAddr = (*MemoryAddrToMmapAddr)[OldMemoryData.MemoryData];
-        auto *BucketInstance = ActiveBuckets[BucketMemAddr].get();
-        auto IndexInBucket = (OldMemoryData.MemoryData - BucketMemAddr) /
-                             BucketInstance->BucketItemSize;
-        BucketInstance->ItemsUsedSizes[IndexInBucket] = NewMemorySize;
-      }
-
-      mprotectReadWriteWasmMemoryData(NewMemoryData, false);
-      return NewMemoryData;
-    }
-
-    if (OldUseMmap && !InstanceUseMmap) {
-      NeedFreeOldMmap = true;
-    }
-  }
-  auto *OldMemoryAddr = OldMemoryData.MemoryData;
-  auto OldMemorySize = OldMemoryData.MemorySize;
-  WasmMemoryData NewMemoryData;
-  if (NeedFreeOldMmap) {
-    NewMemoryData = allocateNonBucketMemory(NewMemorySize);
-    ZEN_ASSERT(NewMemoryData.MemoryData != nullptr);
-    if (OldMemoryAddr) {
-      std::memcpy(NewMemoryData.MemoryData, OldMemoryData.MemoryData,
-                  OldMemorySize);
-      internalFreeWasmMemory(OldMemoryData);
-    }
-  } else {
-    NewMemoryData = reallocateNonBucketMemoryAndFillZerosToNew(OldMemoryData,
-                                                               NewMemorySize);
-  }
-  return NewMemoryData;
+  // when use mmap, the old memory always lives in a full-size reservation, so
+  // memory.grow never moves the memory or copies data
+  return reallocateNonBucketMemoryAndFillZerosToNew(OldMemoryData,
+                                                    NewMemorySize);
 }
 void WasmMemoryAllocator::freeWasmMemory(const WasmMemoryData &WasmMemoryData) {
   internalFreeWasmMemory(WasmMemoryData);
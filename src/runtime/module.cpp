@@ -7,16 +7,24 @@
 #include "action/module_loader.h"
 #include "common/enums.h"
 #include "common/errors.h"
+#include "platform/numa.h"
 #include "runtime/codeholder.h"
+#include "runtime/function_handle.h"
 #include "runtime/symbol_wrapper.h"
+#include "utils/logging.h"
+#include "utils/metrics.h"
 #include "utils/statistics.h"
 #include "utils/wasm.h"
 #include <algorithm>
 #include <memory>
 #include <string>
+#include <unordered_set>
 #ifdef ZEN_ENABLE_MULTIPASS_JIT
 #include "compiler/compiler.h"
 #endif
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+#include "singlepass/singlepass.h"
+#endif
 
 extern struct VNMInterface_ *vnmi_functions();
 
@@ -112,7 +120,7 @@ bool TypeEntry::isEqual(TypeEntry *Type1, TypeEntry *Type2) {
   }
   if (std::memcmp(Type1->getParamTypes(), Type2->getParamTypes(),
                   sizeof(WASMType) * Type1->NumParams) ||
-      std::memcmp(Type1->ReturnTypes, Type2->ReturnTypes,
+      std::memcmp(Type1->getReturnTypes(), Type2->getReturnTypes(),
                   sizeof(WASMType) * Type1->NumReturns)) {
     return false;
   }
@@ -137,6 +145,7 @@ Module::Module(Runtime *RT) : BaseModule(RT, ModuleType::WASM), Layout(*this) {
 #ifdef ZEN_ENABLE_CPU_EXCEPTION
   MemAllocOptions.UseMmap = !RT->getConfig().DisableWasmMemoryMap;
 #endif // ZEN_ENABLE_CPU_EXCEPTION
+  MemAllocOptions.BindNumaNode = RT->getConfig().EnableNUMA;
   MemAllocOptions.MemoryIndex = 0;
   ThreadLocalMemAllocatorMap =
       new utils::ThreadSafeMap<int64_t, WasmMemoryAllocator *>();
@@ -156,17 +165,9 @@ Module::~Module() {
   }
 #endif
 
-  destroyTypeTable();
-  destroyImportTables();
-  destroyFunctionTable();
-  deallocate(InternalFunctionTable);
-  deallocate(InternalTableTable);
-  deallocate(InternalMemoryTable);
-  deallocate(InternalGlobalTable);
-  destroyExportTable();
-  destroyElemTable();
-  deallocate(DataTable);
-  destroyCodeTable();
+  releaseImportSymbols();
+  releaseFunctionSymbols();
+  releaseExportSymbols();
 }
 
 void Module::releaseMemoryAllocatorCache() {
@@ -196,16 +197,28 @@ ModuleUniquePtr Module::newModule(Runtime &RT, CodeHolderUniquePtr CodeHolder,
   auto &Stats = RT.getStatistics();
   auto Timer = Stats.startRecord(utils::StatisticPhase::Load);
 
-  Loader.load();
+  {
+    utils::ScopedMetricTimer MetricTimer(utils::MetricLatency::Load);
+    Loader.load();
+  }
 
   Stats.stopRecord(Timer);
 
   Mod->Layout.compute();
 
   Mod->CodeHolder = std::move(CodeHolder);
+  Mod->Mode = Mod->selectRunMode();
 
   if (Mod->NumInternalFunctions > 0) {
+#ifdef ZEN_ENABLE_JIT
+    if (Mod->Mode != common::RunMode::InterpMode) {
+      Mod->buildStaticTables();
+    }
+#endif
     action::performJITCompile(*Mod);
+#ifdef ZEN_ENABLE_JIT_PROFILER
+    Mod->buildJITFuncAddrTable();
+#endif
   }
 
   Mod->getMemoryAllocator();
@@ -213,7 +226,204 @@ ModuleUniquePtr Module::newModule(Runtime &RT, CodeHolderUniquePtr CodeHolder,
   return Mod;
 }
 
+common::RunMode Module::selectRunMode() const {
+  common::RunMode ConfigMode = getRuntime()->getConfig().Mode;
+  // the singlepass jit has no vector registers, the multipass jit lowers the
+  // simd ops of FunctionLoader::loadSIMDInstruction
+  if ((ConfigMode == common::RunMode::SinglepassMode && UsesSIMD) ||
+      (ConfigMode == common::RunMode::MultipassMode && UsesExtendedSIMD)) {
+    ZEN_LOG_WARN("module uses simd ops the jit doesn't support, it runs in "
+                 "interp mode");
+    return common::RunMode::InterpMode;
+  }
+  // a tail call must not grow the stack, the jits jump to the callee unless
+  // it needs more stack arguments or may be a host function
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  if (ConfigMode == common::RunMode::MultipassMode &&
+      !COMPILER::WasmJITCompiler::canCompileTailCalls(*this)) {
+    ZEN_LOG_WARN("module has tail calls the multipass jit can't compile as "
+                 "jumps, it runs in interp mode");
+    return common::RunMode::InterpMode;
+  }
+#endif
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  if (ConfigMode == common::RunMode::SinglepassMode &&
+      !singlepass::JITCompiler::canCompileTailCalls(*this)) {
+    ZEN_LOG_WARN("module has tail calls the singlepass jit can't compile as "
+                 "jumps, it runs in interp mode");
+    return common::RunMode::InterpMode;
+  }
+#endif
+  return ConfigMode;
+}
+
+bool Module::hasImportElems() const {
+  for (uint32_t I = 0; I < NumElementSegments; ++I) {
+    const ElemEntry &Element = ElementTable[I];
+    for (uint32_t J = 0; J < Element.NumFuncIdxs; ++J) {
+      if (Element.FuncIdxs[J] < NumImportFunctions) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 // ==================== JIT Methods ====================
+#ifdef ZEN_ENABLE_JIT
+void *Module::getLocalJITCode() const {
+  if (NodeJITCodes.empty()) {
+    return JITCode;
+  }
+  uint32_t Node = platform::getCurrentNumaNode();
+  if (Node < NodeJITCodes.size() && NodeJITCodes[Node]) {
+    return NodeJITCodes[Node];
+  }
+  return JITCode;
+}
+
+uint32_t Module::getStaticTableElem(uint32_t TableIdx,
+                                    uint32_t ElemIdx) const {
+  if (TableIdx >= StaticTables.size() || !StaticTables[TableIdx]) {
+    return -1u;
+  }
+  const auto &Elems = StaticTables[TableIdx]->Elems;
+  return ElemIdx < Elems.size() ? Elems[ElemIdx] : -1u;
+}
+
+const std::vector<uint32_t> *
+Module::getIndirectCallTargets(uint32_t TableIdx, uint32_t TypeIdx) const {
+  if (TableIdx >= StaticTables.size() || !StaticTables[TableIdx]) {
+    return nullptr;
+  }
+  const auto &CachedTargets = StaticTables[TableIdx]->CachedTargets;
+  auto It = CachedTargets.find(TypeIdx);
+  return It != CachedTargets.end() ? &It->second : nullptr;
+}
+
+void Module::buildStaticTables() {
+  uint32_t MaxTargets = getRuntime()->getConfig().MaxIndirectCallCacheTargets;
+  StaticTables.clear();
+  if (MaxTargets == 0) {
+    return;
+  }
+
+  uint32_t NumTables = getNumTotalTables();
+  StaticTables.resize(NumTables);
+  for (uint32_t I = 0; I < NumTables; ++I) {
+    uint32_t InitSize = I < NumImportTables
+                            ? ImportTableTable[I].InitSize
+                            : InternalTableTable[I - NumImportTables].InitSize;
+    StaticTables[I] = std::make_unique<StaticTable>();
+    StaticTables[I]->Elems.resize(InitSize, -1u);
+  }
+
+  // same as Instantiator::instantiateTables, but give up on the tables whose
+  // segments are placed by imported globals or don't fit
+  for (uint32_t I = 0; I < NumElementSegments; ++I) {
+    const ElemEntry &Element = ElementTable[I];
+    auto &Table = StaticTables[Element.TableIdx];
+    if (!Table) {
+      continue;
+    }
+    uint64_t Offset = static_cast<uint32_t>(Element.InitExprVal.I32);
+    if (Element.InitExprKind == GET_GLOBAL ||
+        Offset + Element.NumFuncIdxs > Table->Elems.size()) {
+      Table.reset();
+      continue;
+    }
+    std::copy(Element.FuncIdxs, Element.FuncIdxs + Element.NumFuncIdxs,
+              Table->Elems.begin() + Offset);
+  }
+
+  for (auto &Table : StaticTables) {
+    if (!Table) {
+      continue;
+    }
+    std::unordered_map<uint32_t, std::vector<uint32_t>> TargetsByType;
+    for (uint32_t FuncIdx : Table->Elems) {
+      if (FuncIdx == -1u || FuncIdx < NumImportFunctions) {
+        continue;
+      }
+      auto &Targets = TargetsByType[getFunctionTypeIdx(FuncIdx)];
+      if (Targets.size() <= MaxTargets &&
+          std::find(Targets.begin(), Targets.end(), FuncIdx) == Targets.end()) {
+        Targets.push_back(FuncIdx);
+      }
+    }
+    for (auto &[TypeIdx, Targets] : TargetsByType) {
+      if (Targets.size() <= MaxTargets) {
+        Table->CachedTargets.emplace(TypeIdx, std::move(Targets));
+      }
+    }
+  }
+}
+
+#ifdef ZEN_ENABLE_JIT_PROFILER
+uint32_t Module::getBytecodeOffset(uint32_t InternalFuncIdx,
+                                   uint32_t CodeOffset) const {
+  if (InternalFuncIdx >= JITOffsetMaps.size() ||
+      JITOffsetMaps[InternalFuncIdx].empty()) {
+    return -1u;
+  }
+  const JITOffsetMap &Map = JITOffsetMaps[InternalFuncIdx];
+  auto It = std::upper_bound(
+      Map.begin(), Map.end(), CodeOffset,
+      [](uint32_t Offset, const auto &Entry) { return Offset < Entry.first; });
+  if (It == Map.begin()) {
+    return 0;
+  }
+  return std::prev(It)->second;
+}
+
+void Module::buildJITFuncAddrTable() {
+  JITFuncAddrs.clear();
+  if (!JITCode) {
+    return;
+  }
+  for (uint32_t I = 0; I < NumInternalFunctions; ++I) {
+    const uint8_t *CodePtr = CodeTable[I].JITCodePtr;
+    if (CodePtr) {
+      JITFuncAddrs.emplace_back(CodePtr, I + NumImportFunctions);
+    }
+  }
+  std::sort(JITFuncAddrs.begin(), JITFuncAddrs.end());
+}
+
+uint32_t Module::getFuncIdxByJITCodePtr(const uint8_t *Ptr,
+                                        uint32_t &CodeOffset) const {
+  const auto *Code = static_cast<const uint8_t *>(JITCode);
+  if (!Code) {
+    return -1u;
+  }
+  // translate a pointer into a NUMA replica to the primary copy
+  if (Ptr < Code || Ptr >= Code + JITCodeSize) {
+    const uint8_t *Primary = nullptr;
+    for (void *Copy : NodeJITCodes) {
+      const auto *CopyStart = static_cast<const uint8_t *>(Copy);
+      if (CopyStart && Ptr >= CopyStart && Ptr < CopyStart + JITCodeSize) {
+        Primary = Code + (Ptr - CopyStart);
+        break;
+      }
+    }
+    if (!Primary) {
+      return -1u;
+    }
+    Ptr = Primary;
+  }
+  auto It = std::upper_bound(
+      JITFuncAddrs.begin(), JITFuncAddrs.end(), Ptr,
+      [](const uint8_t *Ptr, const auto &Entry) { return Ptr < Entry.first; });
+  if (It == JITFuncAddrs.begin()) {
+    return -1u;
+  }
+  --It;
+  CodeOffset = static_cast<uint32_t>(Ptr - It->first);
+  return It->second;
+}
+#endif // ZEN_ENABLE_JIT_PROFILER
+#endif // ZEN_ENABLE_JIT
+
 #ifdef ZEN_ENABLE_MULTIPASS_JIT
 COMPILER::LazyJITCompiler *Module::newLazyJITCompiler() {
   LazyJITCompiler = std::make_unique<COMPILER::LazyJITCompiler>(this);
@@ -273,6 +483,27 @@ bool Module::getExportFunc(const std::string &Name,
   return getExportFunc(NameSym, FuncIdx);
 }
 
+const FunctionHandle *
+Module::getFunctionHandle(const std::string &Name) const {
+  uint32_t FuncIdx;
+  if (!getExportFunc(Name, FuncIdx)) {
+    return nullptr;
+  }
+  return getFunctionHandle(FuncIdx);
+}
+
+const FunctionHandle *Module::getFunctionHandle(uint32_t FuncIdx) const {
+  if (FuncIdx >= NumImportFunctions + NumInternalFunctions) {
+    return nullptr;
+  }
+  common::LockGuard<common::Mutex> Lock(FunctionHandlesMtx);
+  auto &Handle = FunctionHandles[FuncIdx];
+  if (!Handle) {
+    Handle = std::make_unique<FunctionHandle>(*this, FuncIdx);
+  }
+  return Handle.get();
+}
+
 // ==================== Platform Feature Methods ====================
 
 WasmMemoryAllocator *Module::getMemoryAllocator() {
@@ -284,73 +515,67 @@ WasmMemoryAllocator *Module::getMemoryAllocator() {
   return ThreadLocalMemAllocatorMap->get(ThreadId);
 }
 
-// ==================== Destroy Table Methods ====================
+void Module::mergeFunctionProfile(const FunctionCounters *Counters) const {
+  ZEN_ASSERT(isFunctionProfilingEnabled());
+  common::LockGuard<common::Mutex> Lock(FunctionProfileMtx);
+  if (FunctionProfile.empty()) {
+    FunctionProfile.resize(NumInternalFunctions);
+  }
+  for (uint32_t I = 0; I < NumInternalFunctions; ++I) {
+    FunctionProfile[I] += Counters[I];
+  }
+}
 
-void Module::destroyTypeTable() {
-  for (uint32_t I = 0; I < NumTypes; ++I) {
-    if (TypeTable[I].NumParams > (__WORDSIZE / 8) && TypeTable[I].ParamTypes) {
-      deallocate(TypeTable[I].ParamTypes);
-    }
+std::vector<FunctionCounters> Module::getFunctionProfile() const {
+  common::LockGuard<common::Mutex> Lock(FunctionProfileMtx);
+  if (FunctionProfile.empty()) {
+    return std::vector<FunctionCounters>(NumInternalFunctions);
+  }
+  return FunctionProfile;
+}
+
+bool Module::getFunctionCounters(uint32_t FuncIdx,
+                                 FunctionCounters &Counters) const {
+  ZEN_ASSERT(FuncIdx < NumInternalFunctions);
+  common::LockGuard<common::Mutex> Lock(FunctionProfileMtx);
+  if (FunctionProfile.empty()) {
+    return false;
   }
-  deallocate(TypeTable);
+  Counters = FunctionProfile[FuncIdx];
+  return true;
 }
 
-void Module::destroyFunctionTable() {
+// ==================== Release Symbol Methods ====================
+
+void Module::releaseFunctionSymbols() {
   for (uint32_t I = 0; I < NumInternalFunctions; ++I) {
     freeSymbol(InternalFunctionTable[I].Name);
   }
 }
 
-void Module::destroyImportTables() {
+void Module::releaseImportSymbols() {
   for (uint32_t I = 0; I < NumImportFunctions; ++I) {
     freeSymbol(ImportFunctionTable[I].ModuleName);
     freeSymbol(ImportFunctionTable[I].FieldName);
   }
-  deallocate(ImportFunctionTable);
-
   for (uint32_t I = 0; I < NumImportTables; ++I) {
     freeSymbol(ImportTableTable[I].ModuleName);
     freeSymbol(ImportTableTable[I].FieldName);
   }
-  deallocate(ImportTableTable);
-
   for (uint32_t I = 0; I < NumImportMemories; ++I) {
     freeSymbol(ImportMemoryTable[I].ModuleName);
     freeSymbol(ImportMemoryTable[I].FieldName);
   }
-  deallocate(ImportMemoryTable);
-
   for (uint32_t I = 0; I < NumImportGlobals; ++I) {
     freeSymbol(ImportGlobalTable[I].ModuleName);
     freeSymbol(ImportGlobalTable[I].FieldName);
   }
-  deallocate(ImportGlobalTable);
 }
 
-void Module::destroyExportTable() {
+void Module::releaseExportSymbols() {
   for (uint32_t I = 0; I < NumExports; ++I) {
     freeSymbol(ExportTable[I].Name);
   }
-  deallocate(ExportTable);
-}
-
-void Module::destroyElemTable() {
-  for (uint32_t I = 0; I < NumElementSegments; ++I) {
-    deallocate(ElementTable[I].FuncIdxs);
-  }
-  deallocate(ElementTable);
-}
-
-void Module::destroyCodeTable() {
-  for (uint32_t I = 0; I < NumCodeSegments; ++I) {
-    if (CodeTable[I].LocalTypes) {
-      deallocate(CodeTable[I].LocalTypes);
-    }
-    if (CodeTable[I].LocalOffsets) {
-      deallocate(CodeTable[I].LocalOffsets);
-    }
-  }
-  deallocate(CodeTable);
 }
 
 } // namespace zen::runtime
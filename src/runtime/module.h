@@ -5,7 +5,9 @@
 #define ZEN_RUNTIME_MODULE_H
 
 #include "common/const_string_pool.h"
+#include "common/enums.h"
 #include "common/errors.h"
+#include "runtime/function_profile.h"
 #include "runtime/memory.h"
 #include "runtime/object.h"
 #include "utils/safe_map.h"
@@ -29,6 +31,8 @@ namespace runtime {
 
 using common::WASMType;
 
+class FunctionHandle;
+
 enum class ModuleType {
   WASM,
   JIT,
@@ -124,13 +128,16 @@ private:
 struct TypeEntry final {
   uint16_t NumParams;
   uint16_t NumParamCells;
-  uint8_t NumReturns : 2;
-  uint8_t NumReturnCells : 6;
-  WASMType ReturnTypes[2];
+  uint16_t NumReturns;
+  uint16_t NumReturnCells;
   union {
     WASMType *ParamTypes;
     WASMType ParamTypesVec[__WORDSIZE / 8];
   };
+  union {
+    WASMType *ReturnTypes;
+    WASMType ReturnTypesVec[__WORDSIZE / 8];
+  };
   uint32_t SmallestTypeIdx;
 
   const WASMType *getParamTypes() const {
@@ -140,27 +147,107 @@ struct TypeEntry final {
     return ParamTypesVec;
   }
 
+  const WASMType *getReturnTypes() const {
+    if (NumReturns > (__WORDSIZE / 8)) {
+      return ReturnTypes;
+    }
+    return ReturnTypesVec;
+  }
+
+  // only for single-result signatures, see getReturnTypes() for multi-value
   WASMType getReturnType() const {
     ZEN_ASSERT(NumReturns <= 1);
-    return NumReturns > 0 ? ReturnTypes[0] : WASMType::VOID;
+    return NumReturns > 0 ? ReturnTypesVec[0] : WASMType::VOID;
   }
 
   static bool isEqual(TypeEntry *Type1, TypeEntry *Type2);
 };
 
+// where the jits return a result of a multi-value signature, see
+// JITReturnAllocator
+struct JITReturnLocation {
+  bool InReg;
+  // the index among the return registers of its kind when InReg, else the
+  // offset in the results buffer of the instance
+  uint32_t Index;
+};
+
+// the jits return the integer results in the first two integer return
+// registers (rax/rdx, x0/x1) and the floating-point and vector ones in the
+// first two vector return registers (xmm0/xmm1, v0/v1), in result order; the
+// callee stores the rest to the results buffer of the instance, which the
+// caller reads right after the call, so a single result is always returned
+// in a register as in the native calling convention
+class JITReturnAllocator {
+public:
+  static constexpr uint32_t NumIntRegs = 2;
+  static constexpr uint32_t NumFloatRegs = 2;
+
+  JITReturnLocation next(common::WASMType Type) {
+    if (common::getWASMTypeKind(Type) == common::WASMTypeKind::INTEGER) {
+      if (NumInts < NumIntRegs) {
+        return {true, NumInts++};
+      }
+    } else if (NumFloats < NumFloatRegs) {
+      return {true, NumFloats++};
+    }
+    uint32_t Offset = BufferSize;
+    BufferSize += Type == common::WASMType::V128 ? 16 : 8;
+    return {false, Offset};
+  }
+
+  uint32_t getBufferSize() const { return BufferSize; }
+
+  static std::vector<JITReturnLocation>
+  allocate(const common::WASMType *Types, uint32_t NumTypes) {
+    JITReturnAllocator Allocator;
+    std::vector<JITReturnLocation> Locations;
+    Locations.reserve(NumTypes);
+    for (uint32_t I = 0; I < NumTypes; ++I) {
+      Locations.push_back(Allocator.next(Types[I]));
+    }
+    return Locations;
+  }
+
+private:
+  uint32_t NumInts = 0;
+  uint32_t NumFloats = 0;
+  uint32_t BufferSize = 0;
+};
+
 struct ImportEntryBase {
   WASMSymbol ModuleName;
   WASMSymbol FieldName;
 };
 
+enum class HostapiIntrinsic : uint8_t {
+  None,
+#define DEFINE_HOSTAPI_INTRINSIC(FieldName, NumParams, Gas) FieldName,
+#include "common/hostapi_intrinsics.def"
+#undef DEFINE_HOSTAPI_INTRINSIC
+};
+
+// the gas charged per call of \p Intrinsic, see common/hostapi_intrinsics.def
+constexpr uint64_t getHostapiIntrinsicGas(HostapiIntrinsic Intrinsic) {
+  constexpr uint64_t Gas[] = {
+      0, // None
+#define DEFINE_HOSTAPI_INTRINSIC(FieldName, NumParams, Gas) Gas,
+#include "common/hostapi_intrinsics.def"
+#undef DEFINE_HOSTAPI_INTRINSIC
+  };
+  return Gas[static_cast<uint8_t>(Intrinsic)];
+}
+
 struct ImportFunctionEntry final : ImportEntryBase {
   uint32_t TypeIdx;
   const void *FuncPtr;
+  HostapiIntrinsic Intrinsic;
   /// \note constructor is required to initialize under C++14
   ImportFunctionEntry(WASMSymbol ModuleName, WASMSymbol FieldName,
-                      uint32_t TypeIdx, const void *FuncPtr)
+                      uint32_t TypeIdx, const void *FuncPtr,
+                      HostapiIntrinsic Intrinsic = HostapiIntrinsic::None)
       : ImportEntryBase{ModuleName, FieldName}, TypeIdx(TypeIdx),
-        FuncPtr(FuncPtr) {}
+        FuncPtr(FuncPtr), Intrinsic(Intrinsic) {}
 };
 
 struct ImportTableEntry final : ImportEntryBase {
@@ -265,6 +352,8 @@ struct DataEntry {
   uint32_t Size;
   uint32_t Offset;
   uint8_t InitExprKind;
+  // passive segments are only copied into memory by memory.init
+  bool Passive;
   InitExpr InitExprVal;
 };
 
@@ -312,12 +401,21 @@ class Module final : public BaseModule<Module> {
 #endif // ZEN_ENABLE_DUMP_CALL_STACK
 #endif // ZEN_ENABLE_JIT
 
+    // the results of jitted multi-value calls not returned in registers, see
+    // JITReturnAllocator, empty without jit
+    size_t ResultsBufferBaseOffset = 0;
+    size_t ResultsBufferSize = 0;
+
     size_t ExceptionOffset = 0;
 
 #ifdef ZEN_ENABLE_DWASM
     size_t StackCostOffset = 0;
 #endif
 
+    // only allocated when function profiling is enabled
+    size_t FunctionCountersBaseOffset = 0;
+    size_t FunctionCountersSize = 0;
+
     uint64_t GasOffset = 0;
     size_t TotalSize = 0;
 
@@ -336,9 +434,19 @@ class Module final : public BaseModule<Module> {
 public:
   enum StatsFlags : uint32_t {
     SF_none = 0,
-    SF_global = 1 << 0, // Access global variables
-    SF_memory = 1 << 1, // Access linear memory
-    SF_table = 1 << 2,  // Access table
+    SF_global = 1 << 0,         // Access global variables
+    SF_memory = 1 << 1,         // Access linear memory
+    SF_table = 1 << 2,          // Access table
+    SF_self_tail_call = 1 << 3, // return_call to the function itself
+  };
+
+  // the tail calls of the module, the jits can't compile all of them as
+  // jumps, see selectRunMode
+  struct TailCallInfo {
+    bool HasIndirect = false; // some return_call_indirect
+    // distinct types of the callers and the callees, the stack arguments of
+    // a callee replace the ones of its caller
+    std::vector<std::pair<const TypeEntry *, const TypeEntry *>> TypePairs;
   };
 
   static ModuleUniquePtr newModule(Runtime &RT, CodeHolderUniquePtr CodeHolder,
@@ -380,6 +488,21 @@ public:
 
   uint32_t getNumDataSegments() const { return NumDataSegments; }
 
+  bool usesSIMD() const { return UsesSIMD; }
+
+  bool usesExtendedSIMD() const { return UsesExtendedSIMD; }
+
+  bool usesTailCall() const { return !TailCalls.TypePairs.empty(); }
+
+  const TailCallInfo &getTailCalls() const { return TailCalls; }
+
+  // whether some element segment refers to an imported function
+  bool hasImportElems() const;
+
+  // RuntimeConfig::Mode, or InterpMode if the module uses a feature the jit
+  // of that mode can't compile
+  common::RunMode getRunMode() const { return Mode; }
+
   // ==================== Validating Methods ====================
 
   bool isValidType(uint32_t TypeIdx) const { return TypeIdx < NumTypes; }
@@ -416,6 +539,15 @@ public:
     return ImportFunctionTable[FuncIdx];
   }
 
+  // \return the intrinsic bound to function \p FuncIdx, None for internal
+  // functions and ordinary imports
+  HostapiIntrinsic getHostapiIntrinsic(uint32_t FuncIdx) const {
+    if (FuncIdx >= NumImportFunctions) {
+      return HostapiIntrinsic::None;
+    }
+    return ImportFunctionTable[FuncIdx].Intrinsic;
+  }
+
   const FuncEntry &getInternalFunction(uint32_t InternalFuncIdx) const {
     ZEN_ASSERT(InternalFuncIdx < NumInternalFunctions);
     return InternalFunctionTable[InternalFuncIdx];
@@ -452,6 +584,13 @@ public:
 
   bool getExportFunc(const std::string &Name, uint32_t &FuncIdx) const noexcept;
 
+  /// Resolve the exported function \p Name once, the handle lives as long as
+  /// the module. Thread-safe.
+  /// \return nullptr if there is no such exported function
+  const FunctionHandle *getFunctionHandle(const std::string &Name) const;
+
+  const FunctionHandle *getFunctionHandle(uint32_t FuncIdx) const;
+
   uint32_t getStartFuncIdx() const { return StartFuncIdx; };
 
   CodeEntry *getCodeEntry(uint32_t FuncIdx) const;
@@ -471,6 +610,24 @@ public:
 
   WasmMemoryAllocator *getMemoryAllocator();
 
+  bool isFunctionProfilingEnabled() const {
+    return Layout.FunctionCountersSize > 0;
+  }
+
+  /// Add the counters of an instance being deleted to the profile of the
+  /// module. Thread-safe.
+  void mergeFunctionProfile(const FunctionCounters *Counters) const;
+
+  /// \return the counters of every internal function, summed over the
+  /// instances deleted so far. Thread-safe.
+  std::vector<FunctionCounters> getFunctionProfile() const;
+
+  /// Get the counters of the internal function \p FuncIdx summed over the
+  /// instances deleted so far. Thread-safe.
+  /// \return false if no instance has been deleted yet
+  bool getFunctionCounters(uint32_t FuncIdx,
+                           FunctionCounters &Counters) const;
+
   bool checkUseSoftLinearMemoryCheck() const {
 #ifdef ZEN_ENABLE_CPU_EXCEPTION
     return false;
@@ -479,6 +636,14 @@ public:
 #endif
   }
 
+  // When linear memories are mmaped, each one owns a full-size reservation
+  // and memory.grow never moves it, so JIT code needn't reload the memory
+  // base after memory.grow or calls. Imported memories are excluded because
+  // they are not allocated by this module.
+  bool checkUseFixedLinearMemoryBase() const {
+    return MemAllocOptions.UseMmap && NumImportMemories == 0;
+  }
+
   // ==================== JIT Methods ====================
 
 #ifdef ZEN_ENABLE_JIT
@@ -493,6 +658,87 @@ public:
     JITCodeSize = Size;
   }
 
+  // NUMA replicas of the JIT code, each one has the same layout as the primary
+  // copy at getJITCode() and only differs in its base address
+  common::CodeMemPool &getNodeJITCodeMemPool(uint32_t Node) {
+    if (NodeJITCodeMemPools.size() <= Node) {
+      NodeJITCodeMemPools.resize(Node + 1);
+    }
+    auto &Pool = NodeJITCodeMemPools[Node];
+    if (!Pool) {
+      Pool = std::make_unique<common::CodeMemPool>();
+    }
+    return *Pool;
+  }
+
+  void setNodeJITCode(uint32_t Node, void *Code) {
+    if (NodeJITCodes.size() <= Node) {
+      NodeJITCodes.resize(Node + 1, nullptr);
+    }
+    NodeJITCodes[Node] = Code;
+  }
+
+  // \return the copy of the JIT code local to the calling thread, or the
+  // primary copy if the node has no replica
+  void *getLocalJITCode() const;
+
+  // translate a pointer into the primary JIT code to the same position of
+  // another copy
+  const uint8_t *relocateJITCodePtr(const uint8_t *Ptr,
+                                    const void *CodeCopy) const {
+    if (!Ptr || CodeCopy == JITCode) {
+      return Ptr;
+    }
+    return static_cast<const uint8_t *>(CodeCopy) +
+           (Ptr - static_cast<const uint8_t *>(JITCode));
+  }
+
+  // tables are never changed after instantiation, so the JITs can resolve
+  // call_indirect at compile time when the element segments of a table have
+  // constant offsets, see buildStaticTables
+
+  // \return the function at \p ElemIdx of table \p TableIdx in every
+  // instance, -1u if it's uninitialized or unknown at compile time
+  uint32_t getStaticTableElem(uint32_t TableIdx, uint32_t ElemIdx) const;
+
+  // \return the internal functions of type \p TypeIdx in table \p TableIdx,
+  // nullptr if they are unknown at compile time or more than
+  // RuntimeConfig::MaxIndirectCallCacheTargets
+  const std::vector<uint32_t> *getIndirectCallTargets(uint32_t TableIdx,
+                                                      uint32_t TypeIdx) const;
+
+  // must be called after loading and before the compilation
+  void buildStaticTables();
+
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  // (native code offset, bytecode offset) of each wasm instruction emitting
+  // code, sorted by native code offset. Only recorded by singlepass.
+  typedef std::vector<std::pair<uint32_t, uint32_t>> JITOffsetMap;
+
+  JITOffsetMap &getJITOffsetMap(uint32_t InternalFuncIdx) {
+    if (JITOffsetMaps.size() <= InternalFuncIdx) {
+      JITOffsetMaps.resize(NumInternalFunctions);
+    }
+    return JITOffsetMaps[InternalFuncIdx];
+  }
+
+  // \return the bytecode offset in the function body of the instruction
+  // containing \p CodeOffset, 0 for the prolog, -1u if unknown
+  uint32_t getBytecodeOffset(uint32_t InternalFuncIdx,
+                             uint32_t CodeOffset) const;
+
+  // sort the entries of the internal functions, must be called after the
+  // compilation and before getFuncIdxByJITCodePtr
+  void buildJITFuncAddrTable();
+
+  // async-signal-safe
+  // \return the global index of the function containing \p Ptr, which may
+  // point into any copy of the JIT code, or -1u. \p CodeOffset is set to the
+  // offset of \p Ptr in the function.
+  uint32_t getFuncIdxByJITCodePtr(const uint8_t *Ptr,
+                                  uint32_t &CodeOffset) const;
+#endif // ZEN_ENABLE_JIT_PROFILER
+
 #ifdef ZEN_ENABLE_DUMP_CALL_STACK
   auto &getSortedJITFuncPtrs() { return SortedJITFuncPtrs; }
 
@@ -516,8 +762,7 @@ public:
 
   // ==================== Utilities ====================
 
-#ifdef ZEN_ENABLE_LINUX_PERF
-  std::string getWasmFuncDebugName(uint32_t FuncIdx) {
+  std::string getWasmFuncDebugName(uint32_t FuncIdx) const {
     ZEN_ASSERT(FuncIdx >= NumImportFunctions);
     const FuncEntry &Func = getInternalFunction(FuncIdx - NumImportFunctions);
     if (Func.Name != common::WASM_SYMBOL_NULL) {
@@ -528,7 +773,6 @@ public:
     }
     return "jitfunc_" + std::to_string(FuncIdx);
   }
-#endif
 
 #ifdef ZEN_ENABLE_CHECKED_ARITHMETIC
 #define DEFINE_ARITH_FIELD(field) uint32_t field##_func = -1u;
@@ -543,6 +787,9 @@ private:
 
   virtual ~Module();
 
+  // the mode of a loaded module, see getRunMode
+  common::RunMode selectRunMode() const;
+
   // ==================== Init Table Methods ====================
 
   template <typename EntryType>
@@ -552,7 +799,9 @@ private:
     if (Size > UINT32_MAX) {
       throw common::getError(common::ErrorCode::TooManyItems);
     }
-    EntryType *Entry = Size ? (EntryType *)allocateZeros(Size) : nullptr;
+    EntryType *Entry =
+        Size ? (EntryType *)MetadataPool.allocateZeros(Size, alignof(EntryType))
+             : nullptr;
     NumItems = InitNumItems;
     ItemTable = Entry;
     return Entry;
@@ -579,15 +828,19 @@ private:
   }
 
   WASMType *initParamTypes(uint32_t N) {
-    return N > 0 ? (WASMType *)allocate(sizeof(WASMType) * N) : nullptr;
+    return (WASMType *)MetadataPool.allocate(sizeof(WASMType) * N);
+  }
+
+  WASMType *initReturnTypes(uint32_t N) {
+    return (WASMType *)MetadataPool.allocate(sizeof(WASMType) * N);
   }
 
   WASMType *initLocalTypes(uint32_t N) {
-    return N > 0 ? (WASMType *)allocate(sizeof(WASMType) * N) : nullptr;
+    return (WASMType *)MetadataPool.allocate(sizeof(WASMType) * N);
   }
 
   uint32_t *initLocalOffsets(uint64_t TotalLocalSize) {
-    return TotalLocalSize > 0 ? (uint32_t *)allocate(TotalLocalSize) : nullptr;
+    return (uint32_t *)MetadataPool.allocate(TotalLocalSize);
   }
 
   FuncEntry *initFuncTable(uint32_t N) {
@@ -626,19 +879,25 @@ private:
     return initItemTable(Entry->FuncIdxs, Entry->NumFuncIdxs, N);
   }
 
-  // ==================== Destroy Table Methods ====================
+  // Reserve the metadata pool for all tables in advance so that they are
+  // laid out contiguously
+  void reserveMetadata(size_t Size) { MetadataPool.reserve(Size); }
+
+  // ==================== Release Symbol Methods ====================
 
-  void destroyTypeTable();
-  void destroyImportTables();
-  void destroyExportTable();
-  void destroyFunctionTable();
-  void destroyElemTable();
-  void destroyCodeTable();
+  // tables themselves are released with MetadataPool, only the symbols
+  // they hold need to be freed
+  void releaseImportSymbols();
+  void releaseExportSymbols();
+  void releaseFunctionSymbols();
 
   // ==================== Metadata Members ====================
 
   CodeHolderUniquePtr CodeHolder;
 
+  // owns every entry table and the arrays they point to
+  common::AllocOnlyMemPool MetadataPool;
+
   // ==================== Number Members ====================
 
   uint32_t NumTypes = 0;
@@ -656,6 +915,10 @@ private:
   uint32_t NumCodeSegments = 0;
   uint32_t NumDataSegments = 0;
   uint32_t DataCount = -1u; // -1 means not exist data count section
+  bool UsesSIMD = false;         // some function handles v128 values
+  bool UsesExtendedSIMD = false; // a simd op the multipass jit doesn't lower
+  TailCallInfo TailCalls;
+  common::RunMode Mode = common::RunMode::InterpMode;
 
   // ==================== Entry Table Members ====================
 
@@ -689,12 +952,38 @@ private:
   typedef utils::ThreadSafeMap<int64_t, WasmMemoryAllocator *> ThreadSafeMap;
   ThreadSafeMap *ThreadLocalMemAllocatorMap = nullptr;
 
+  // func_idx => handle, created on first request
+  mutable std::unordered_map<uint32_t, std::unique_ptr<FunctionHandle>>
+      FunctionHandles;
+  mutable common::Mutex FunctionHandlesMtx;
+
+  // indexed by internal function index, empty until an instance is deleted
+  mutable std::vector<FunctionCounters> FunctionProfile;
+  mutable common::Mutex FunctionProfileMtx;
+
   // ==================== JIT Members ====================
 
 #ifdef ZEN_ENABLE_JIT
   common::CodeMemPool JITCodeMemPool;
   void *JITCode = nullptr;
   size_t JITCodeSize = 0;
+  // indexed by NUMA node, only filled when NUMA code replication is enabled
+  std::vector<std::unique_ptr<common::CodeMemPool>> NodeJITCodeMemPools;
+  std::vector<void *> NodeJITCodes;
+  struct StaticTable {
+    std::vector<uint32_t> Elems;
+    // type index => distinct internal functions in Elems, see
+    // getIndirectCallTargets
+    std::unordered_map<uint32_t, std::vector<uint32_t>> CachedTargets;
+  };
+  // indexed by table index, null if the table is unknown at compile time
+  std::vector<std::unique_ptr<StaticTable>> StaticTables;
+
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  std::vector<JITOffsetMap> JITOffsetMaps;
+  // (jited_code_ptr, func_index) ordered by jited_code asc
+  std::vector<std::pair<const uint8_t *, uint32_t>> JITFuncAddrs;
+#endif // ZEN_ENABLE_JIT_PROFILER
 
 #ifdef ZEN_ENABLE_DUMP_CALL_STACK
   // Only used in mutlipass mode, save all functions jited_codes
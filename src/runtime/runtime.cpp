@@ -13,12 +13,17 @@
 #include "common/type.h"
 #include "entrypoint/entrypoint.h"
 #include "runtime/codeholder.h"
+#include "runtime/function_handle.h"
 #include "runtime/instance.h"
 #include "runtime/isolation.h"
 #include "runtime/module.h"
 #include "runtime/symbol_wrapper.h"
 #include "utils/logging.h"
+#include "utils/metrics.h"
 #include "utils/statistics.h"
+#ifdef ZEN_ENABLE_JIT_PROFILER
+#include "runtime/sampling_profiler.h"
+#endif
 #ifdef ZEN_ENABLE_VIRTUAL_STACK
 #include "utils/virtual_stack.h"
 #endif
@@ -63,11 +68,10 @@ HostModule *Runtime::loadHostModule(BuiltinModuleDesc &ModDesc) noexcept {
   }
 
   WASMSymbol Name = newSymbol(ModName, std::strlen(ModName));
-  if (auto It = HostModulePool.find(Name); It != HostModulePool.end()) {
-    return It->second.get();
-  }
-
-  if (HostModule *RawMod = resolveHostModule(Name); RawMod) {
+  common::UniqueLock<common::SharedMutex> Lock(HostModulePoolMtx);
+  if (HostModule *RawMod = findHostModule(Name); RawMod) {
+    // the existing module already holds the name
+    freeSymbol(Name);
     return RawMod;
   }
 
@@ -75,6 +79,7 @@ HostModule *Runtime::loadHostModule(BuiltinModuleDesc &ModDesc) noexcept {
   try {
     Mod = HostModule::newModule(*this, &ModDesc);
   } catch (const Error &Err) {
+    freeSymbol(Name);
     const auto &ErrMsg = Err.getFormattedMessage();
     ZEN_LOG_ERROR(ErrMsg.c_str());
     return nullptr;
@@ -83,8 +88,7 @@ HostModule *Runtime::loadHostModule(BuiltinModuleDesc &ModDesc) noexcept {
   HostModule *RawMod = Mod.get();
   RawMod->setName(Name);
 
-  auto EmplaceRet =
-      HostModulePool.emplace(Name, std::forward<HostModuleUniquePtr>(Mod));
+  auto EmplaceRet = HostModulePool.emplace(Name, std::move(Mod));
   if (EmplaceRet.second) {
     return EmplaceRet.first->second.get();
   }
@@ -128,10 +132,25 @@ bool Runtime::unloadHostModule(HostModule *HostMod) noexcept {
   ZEN_ASSERT(HostMod);
   const char *ModName = HostMod->getModuleDesc()->_name;
   WASMSymbol Name = probeSymbol(ModName, std::strlen(ModName));
-  return HostModulePool.erase(Name) != 0;
+  HostModuleUniquePtr Removed;
+  {
+    common::UniqueLock<common::SharedMutex> Lock(HostModulePoolMtx);
+    auto It = HostModulePool.find(Name);
+    if (It == HostModulePool.end()) {
+      return false;
+    }
+    Removed = std::move(It->second);
+    HostModulePool.erase(It);
+  }
+  return true;
 }
 
 HostModule *Runtime::resolveHostModule(WASMSymbol Name) const {
+  common::SharedLock<common::SharedMutex> Lock(HostModulePoolMtx);
+  return findHostModule(Name);
+}
+
+HostModule *Runtime::findHostModule(WASMSymbol Name) const {
   if (Name == WASM_SYMBOL_wasi_unstable) {
     Name = WASM_SYMBOL_wasi_snapshot_preview1;
   }
@@ -150,8 +169,10 @@ MayBe<Module *> Runtime::loadModule(const std::string &Filename,
   }
 
   WASMSymbol Name = newSymbol(Filename.c_str(), Filename.size());
-  if (auto It = ModulePool.find(Name); It != ModulePool.end()) {
-    return It->second.get();
+  if (Module *Mod = findModule(Name)) {
+    // the existing module already holds the name
+    freeSymbol(Name);
+    return Mod;
   }
 
   try {
@@ -159,6 +180,7 @@ MayBe<Module *> Runtime::loadModule(const std::string &Filename,
     return loadModule(Name, std::move(Code), EntryHint);
   } catch (const Error &Err) {
     Stats.clearAllTimers();
+    utils::Metrics::addCounter(utils::MetricCounter::LoadErrors);
     freeSymbol(Name);
     return Err;
   }
@@ -172,8 +194,10 @@ MayBe<Module *> Runtime::loadModule(const std::string &ModName,
   }
 
   WASMSymbol Name = newSymbol(ModName.c_str(), ModName.size());
-  if (auto It = ModulePool.find(Name); It != ModulePool.end()) {
-    return It->second.get();
+  if (Module *Mod = findModule(Name)) {
+    // the existing module already holds the name
+    freeSymbol(Name);
+    return Mod;
   }
 
   try {
@@ -181,6 +205,7 @@ MayBe<Module *> Runtime::loadModule(const std::string &ModName,
     return loadModule(Name, std::move(Code), EntryHint);
   } catch (const Error &Err) {
     Stats.clearAllTimers();
+    utils::Metrics::addCounter(utils::MetricCounter::LoadErrors);
     freeSymbol(Name);
     return Err;
   }
@@ -197,22 +222,36 @@ Module *Runtime::loadModule(WASMSymbol Name, CodeHolderUniquePtr CodeHolder,
   // All errors in Module::newModule are thrown as exceptions, so the return
   // value must be valid when the following line is executed
   ZEN_ASSERT(Mod);
-  auto *ModulePtr = Mod.get();
-  ModulePtr->setName(Name);
+  Mod->setName(Name);
 
-  // Ignore the return value, because the name is unique(checked in above)
-  auto EmplaceRet =
-      ModulePool.emplace(Name, std::forward<ModuleUniquePtr>(Mod));
-  if (EmplaceRet.second) {
-    return EmplaceRet.first->second.get();
-  }
+  common::LockGuard<common::Mutex> Lock(ModulePoolMtx);
+  // Another thread may have loaded a module with the same name since the
+  // check in the caller, then the module created here is dropped(outside the
+  // lock) and the registered one is returned
+  auto EmplaceRet = ModulePool.try_emplace(Name, std::move(Mod));
+  return EmplaceRet.first->second.get();
+}
 
-  return ModulePtr;
+Module *Runtime::findModule(WASMSymbol Name) {
+  common::LockGuard<common::Mutex> Lock(ModulePoolMtx);
+  auto It = ModulePool.find(Name);
+  return It != ModulePool.end() ? It->second.get() : nullptr;
 }
 
 bool Runtime::unloadModule(const Module *Mod) noexcept {
   WASMSymbol Name = Mod->getName();
-  return ModulePool.erase(Name) != 0;
+  ModuleUniquePtr Removed;
+  {
+    common::LockGuard<common::Mutex> Lock(ModulePoolMtx);
+    auto It = ModulePool.find(Name);
+    if (It == ModulePool.end()) {
+      return false;
+    }
+    // destroy the module outside the lock
+    Removed = std::move(It->second);
+    ModulePool.erase(It);
+  }
+  return true;
 }
 
 Isolation *Runtime::createManagedIsolation() noexcept {
@@ -256,7 +295,7 @@ static bool checkMainFuncType(TypeEntry *Type) {
       !(ParamTypes[0] == WASMType::I32 && ParamTypes[1] == WASMType::I32)) {
     return false;
   }
-  if (Type->NumReturns && Type->ReturnTypes[0] != WASMType::I32) {
+  if (Type->NumReturns && Type->getReturnTypes()[0] != WASMType::I32) {
     return false;
   }
   return true;
@@ -371,6 +410,18 @@ static void callWasmFuncFromVirtualStack(VirtualStackInfo *StackInfo) {
   static uint8_t CheckDwasmStackResult = checkDwasmStackEnough();
   ZEN_ASSERT(CheckDwasmStackResult == 7);
   Instance *Inst = StackInfo->SavedInst;
+  if (StackInfo->SavedStatuses) {
+    Inst->getRuntime()->callWasmFunctionBatchOnPhysStack(
+        *Inst, *StackInfo->SavedHandle, StackInfo->SavedNumCalls,
+        StackInfo->SavedRawArgs, StackInfo->SavedRawResults,
+        StackInfo->SavedStatuses);
+    return;
+  }
+  if (const FunctionHandle *Func = StackInfo->SavedHandle) {
+    Inst->getRuntime()->callWasmFunctionOnPhysStack(
+        *Inst, *Func, StackInfo->SavedRawArgs, StackInfo->SavedRawResults);
+    return;
+  }
   uint32_t FuncIdx = StackInfo->SavedFuncIdx;
   const std::vector<TypedValue> *Args = StackInfo->SavedArgs;
   std::vector<TypedValue> *Results = StackInfo->SavedResults;
@@ -382,7 +433,7 @@ static void callWasmFuncFromVirtualStack(VirtualStackInfo *StackInfo) {
 void Runtime::callWasmFunctionOnPhysStack(
     Instance &Inst, uint32_t FuncIdx, const std::vector<TypedValue> &Args,
     std::vector<common::TypedValue> &Results) noexcept {
-  if (getConfig().Mode == RunMode::InterpMode) {
+  if (Inst.getModule()->getRunMode() == RunMode::InterpMode) {
     callWasmFunctionInInterpMode(Inst, FuncIdx, Args, Results);
   } else {
 #ifdef ZEN_ENABLE_JIT
@@ -393,6 +444,62 @@ void Runtime::callWasmFunctionOnPhysStack(
   }
 }
 
+void Runtime::callWasmFunctionOnPhysStack(Instance &Inst,
+                                          const FunctionHandle &Func,
+                                          const UntypedValue *Args,
+                                          UntypedValue *Results) noexcept {
+#ifdef ZEN_ENABLE_JIT
+  if (Inst.getModule()->getRunMode() != RunMode::InterpMode) {
+    callWasmFunctionInJITMode(Inst, Func, Args, Results);
+    return;
+  }
+#endif
+  // the interpreter allocates its stack per call anyway
+  uint32_t NumParams = Func.getNumParams();
+  std::vector<TypedValue> ArgVec(NumParams);
+  for (uint32_t I = 0; I < NumParams; ++I) {
+    ArgVec[I] = TypedValue(Args[I], Func.getParamType(I));
+  }
+  std::vector<TypedValue> ResultVec(Func.getNumReturns());
+  for (uint32_t I = 0; I < ResultVec.size(); ++I) {
+    ResultVec[I].Type = Func.getReturnType(I);
+  }
+  callWasmFunctionInInterpMode(Inst, Func.getFuncIdx(), ArgVec, ResultVec);
+  for (uint32_t I = 0; I < ResultVec.size(); ++I) {
+    Results[I] = ResultVec[I].Value;
+  }
+}
+
+void Runtime::callWasmFunctionBatchOnPhysStack(
+    Instance &Inst, const FunctionHandle &Func, uint32_t NumCalls,
+    const UntypedValue *Args, UntypedValue *Results,
+    BatchCallStatus *Statuses) noexcept {
+#ifdef ZEN_ENABLE_JIT
+  if (Inst.getModule()->getRunMode() != RunMode::InterpMode) {
+    callWasmFunctionBatchInJITMode(Inst, Func, NumCalls, Args, Results,
+                                   Statuses);
+    return;
+  }
+#endif
+  uint32_t NumParams = Func.getNumParams();
+  uint32_t NumReturns = Func.getNumReturns();
+  for (uint32_t I = 0; I < NumCalls; ++I) {
+    callWasmFunctionOnPhysStack(Inst, Func, Args + size_t(I) * NumParams,
+                                Results + size_t(I) * NumReturns);
+    finishBatchCall(Inst, Statuses[I], I + 1 == NumCalls);
+  }
+}
+
+static void recordExecutionMetrics(uint64_t GasBefore, uint64_t GasAfter,
+                                   ErrorCode ErrCode) {
+  if (GasAfter < GasBefore) {
+    Metrics::addCounter(MetricCounter::GasUsed, GasBefore - GasAfter);
+  }
+  if (ErrCode != ErrorCode::NoError && ErrCode != ErrorCode::InstanceExit) {
+    Metrics::addCounter(MetricCounter::Traps);
+  }
+}
+
 bool Runtime::callWasmFunction(Instance &Inst, uint32_t FuncIdx,
                                const std::vector<TypedValue> &Args,
                                std::vector<TypedValue> &Results) {
@@ -435,12 +542,12 @@ bool Runtime::callWasmFunction(Instance &Inst, uint32_t FuncIdx,
   uint32_t NumReturns = Func->NumReturns;
   Results.resize(NumReturns);
   for (uint32_t I = 0; I < NumReturns; ++I) {
-    Results[I].Type = Func->ReturnTypes[I];
+    Results[I].Type = Func->getReturnTypes()[I];
   }
 
   auto Timer = Stats.startRecord(utils::StatisticPhase::Execution);
-
-  Inst.protectMemory();
+  ScopedMetricTimer MetricTimer(MetricLatency::Execution);
+  uint64_t GasBefore = Inst.getGas();
 
 #ifdef ZEN_ENABLE_VIRTUAL_STACK
   VirtualStackInfo StackInfo(&Inst, FuncIdx, &Args, &Results);
@@ -450,7 +557,121 @@ bool Runtime::callWasmFunction(Instance &Inst, uint32_t FuncIdx,
 #endif // !ZEN_ENABLE_VIRTUAL_STACK
 
   Stats.stopRecord(Timer);
+  recordExecutionMetrics(GasBefore, Inst.getGas(), Inst.getError().getCode());
+
+  return checkCallResult(Inst);
+}
+
+bool Runtime::callWasmFunction(Instance &Inst, const FunctionHandle &Func,
+                               const UntypedValue *Args,
+                               UntypedValue *Results) {
+#ifdef ZEN_ENABLE_DWASM
+  if (Inst.inHostAPI()) {
+    ZEN_LOG_ERROR("hostapi can't call wasm function in DWASM spec\n");
+    Inst.setExecutionError(
+        common::getError(ErrorCode::DWasmInvalidHostApiCallWasm), 1);
+    return false;
+  }
+#endif
+  // the code of another module would run against the layout of this instance
+  if (Func.getModule() != Inst.getModule()) {
+    Inst.setError(common::getError(ErrorCode::ForeignFunctionHandle));
+    return false;
+  }
+
+  auto Timer = Stats.startRecord(utils::StatisticPhase::Execution);
+  ScopedMetricTimer MetricTimer(MetricLatency::Execution);
+  uint64_t GasBefore = Inst.getGas();
+
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+  VirtualStackInfo StackInfo(&Inst, Func.getFuncIdx(), nullptr, nullptr);
+  StackInfo.SavedHandle = &Func;
+  StackInfo.SavedRawArgs = Args;
+  StackInfo.SavedRawResults = Results;
+  StackInfo.runInVirtualStack(&callWasmFuncFromVirtualStack);
+#else
+  callWasmFunctionOnPhysStack(Inst, Func, Args, Results);
+#endif // !ZEN_ENABLE_VIRTUAL_STACK
+
+  Stats.stopRecord(Timer);
+  recordExecutionMetrics(GasBefore, Inst.getGas(), Inst.getError().getCode());
+
+  return checkCallResult(Inst);
+}
+
+uint32_t Runtime::callWasmFunctionBatch(Instance &Inst,
+                                       const FunctionHandle &Func,
+                                       uint32_t NumCalls,
+                                       const UntypedValue *Args,
+                                       UntypedValue *Results,
+                                       BatchCallStatus *Statuses) {
+  if (NumCalls == 0) {
+    return 0;
+  }
+#ifdef ZEN_ENABLE_DWASM
+  if (Inst.inHostAPI()) {
+    ZEN_LOG_ERROR("hostapi can't call wasm function in DWASM spec\n");
+    Inst.setExecutionError(
+        common::getError(ErrorCode::DWasmInvalidHostApiCallWasm), 1);
+    for (uint32_t I = 0; I < NumCalls; ++I) {
+      Statuses[I].ErrCode = ErrorCode::DWasmInvalidHostApiCallWasm;
+      Statuses[I].GasLeft = Inst.getGas();
+    }
+    return 0;
+  }
+#endif
+  if (Func.getModule() != Inst.getModule()) {
+    Inst.setError(common::getError(ErrorCode::ForeignFunctionHandle));
+    for (uint32_t I = 0; I < NumCalls; ++I) {
+      Statuses[I].ErrCode = ErrorCode::ForeignFunctionHandle;
+      Statuses[I].GasLeft = Inst.getGas();
+    }
+    return 0;
+  }
+
+  auto Timer = Stats.startRecord(utils::StatisticPhase::Execution);
+  ScopedMetricTimer MetricTimer(MetricLatency::Execution);
+  uint64_t GasBefore = Inst.getGas();
+
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+  VirtualStackInfo StackInfo(&Inst, Func.getFuncIdx(), nullptr, nullptr);
+  StackInfo.SavedHandle = &Func;
+  StackInfo.SavedRawArgs = Args;
+  StackInfo.SavedRawResults = Results;
+  StackInfo.SavedNumCalls = NumCalls;
+  StackInfo.SavedStatuses = Statuses;
+  StackInfo.runInVirtualStack(&callWasmFuncFromVirtualStack);
+#else
+  callWasmFunctionBatchOnPhysStack(Inst, Func, NumCalls, Args, Results,
+                                   Statuses);
+#endif // !ZEN_ENABLE_VIRTUAL_STACK
+
+  Stats.stopRecord(Timer);
+
+  checkCallResult(Inst);
+
+  uint32_t NumSucceeded = 0;
+  for (uint32_t I = 0; I < NumCalls; ++I) {
+    ErrorCode ErrCode = Statuses[I].ErrCode;
+    recordExecutionMetrics(GasBefore, Statuses[I].GasLeft, ErrCode);
+    GasBefore = Statuses[I].GasLeft;
+    if (ErrCode == ErrorCode::NoError || ErrCode == ErrorCode::InstanceExit) {
+      ++NumSucceeded;
+    }
+  }
+  return NumSucceeded;
+}
+
+void Runtime::finishBatchCall(Instance &Inst, BatchCallStatus &Status,
+                              bool IsLast) {
+  Status.ErrCode = Inst.getError().getCode();
+  Status.GasLeft = Inst.getGas();
+  if (!IsLast) {
+    Inst.clearError();
+  }
+}
 
+bool Runtime::checkCallResult(Instance &Inst) {
   const Error &Err = Inst.getError();
   ErrorCode ErrCode = Err.getCode();
   if (ErrCode != ErrorCode::NoError) {
@@ -458,8 +679,8 @@ bool Runtime::callWasmFunction(Instance &Inst, uint32_t FuncIdx,
       Inst.clearError();
     } else {
 #ifdef ZEN_ENABLE_DUMP_CALL_STACK
-      if (Config.Mode == RunMode::SinglepassMode ||
-          Config.Mode == RunMode::MultipassMode) {
+      RunMode Mode = Inst.getModule()->getRunMode();
+      if (Mode == RunMode::SinglepassMode || Mode == RunMode::MultipassMode) {
         Inst.dumpCallStackOnJIT();
       }
 #endif
@@ -548,14 +769,20 @@ void Runtime::callWasmFunctionInInterpMode(Instance &Inst, uint32_t FuncIdx,
 }
 
 #ifdef ZEN_ENABLE_JIT
-void Runtime::callWasmFunctionInJITMode(Instance &Inst, uint32_t FuncIdx,
-                                        const std::vector<TypedValue> &Args,
-                                        std::vector<TypedValue> &Results) {
-  FunctionInstance *Func = Inst.getFunctionInst(FuncIdx);
+template <typename CallFn>
+void Runtime::callJITFunction(Instance &Inst, CallFn &&Call) {
+  callJITFunctions(
+      Inst, 1, [&](uint32_t) { Call(); }, [](uint32_t) {});
+}
+
+template <typename CallFn, typename DoneFn>
+void Runtime::callJITFunctions(Instance &Inst, uint32_t NumCalls,
+                               CallFn &&Call, DoneFn &&Done) {
   Inst.setJITStackSize(PresetReservedStackSize);
-  bool IsImport = FuncIdx < Inst.getModule()->getNumImportFunctions();
-  auto FuncPtr =
-      GenericFunctionPointer(IsImport ? Func->CodePtr : Func->JITCodePtr);
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  SamplingProfiler::CallScope ProfilerScope(Inst.getModule(),
+                                            __builtin_frame_address(0));
+#endif
 
 #ifdef ZEN_ENABLE_CPU_EXCEPTION
   jmp_buf JmpBuf;
@@ -564,95 +791,170 @@ void Runtime::callWasmFunctionInJITMode(Instance &Inst, uint32_t FuncIdx,
 
   // longjmp with asan(in gcc-9) not works well, it affects the asan stack
   // malloc. so use wrapper func to recover the stack
-  auto CallWasmFnWrapper = [&]() {
+  auto CallWasmFnWrapper = [&](uint32_t I) {
     int JmpSignum = ::setjmp(JmpBuf);
     if (JmpSignum == 0) {
       TLS.restartHandler();
-
+      Call(I);
+    } else { // When cpu-exception
+      handleJITTrap(Inst, TLS, JmpSignum);
+    }
+  };
+  for (uint32_t I = 0; I < NumCalls; ++I) {
+    CallWasmFnWrapper(I);
+    Done(I);
+  }
+#else
+  for (uint32_t I = 0; I < NumCalls; ++I) {
+    Call(I);
+    Done(I);
+  }
 #endif // ZEN_ENABLE_CPU_EXCEPTION
-
-      entrypoint::callNativeGeneral(&Inst, FuncPtr, Args, Results,
-                                    this->getMemAllocator());
+}
 
 #ifdef ZEN_ENABLE_CPU_EXCEPTION
-    } else { // When cpu-exception
-      // NoError means not need capture trap state
-      ErrorCode CapturedTapErrCode = ErrorCode::NoError;
-      switch (JmpSignum) {
-      case SIGFPE: {
-        // divide by zero signal
-        CapturedTapErrCode = ErrorCode::IntegerDivByZero;
-        break;
-      }
-      case SIGSEGV:
-      case SIGBUS: {
-        // out of bounds signal
-        CapturedTapErrCode = ErrorCode::OutOfBoundsMemory;
+void Runtime::handleJITTrap(Instance &Inst,
+                            common::traphandler::CallThreadState &TLS,
+                            int JmpSignum) {
+  // NoError means not need capture trap state
+  ErrorCode CapturedTapErrCode = ErrorCode::NoError;
+  switch (JmpSignum) {
+  case SIGFPE: {
+    // divide by zero signal
+    CapturedTapErrCode = ErrorCode::IntegerDivByZero;
+    break;
+  }
+  case SIGSEGV:
+  case SIGBUS: {
+    // out of bounds signal
+    CapturedTapErrCode = ErrorCode::OutOfBoundsMemory;
 #ifdef ZEN_ENABLE_STACK_CHECK_CPU
-        // when the accessed address in virtual stack, raise CallStackExhausted
-        auto *FaultingAddress =
-            static_cast<uint8_t *>(TLS.getTrapState().FaultingAddress);
+    // when the accessed address in virtual stack, raise CallStackExhausted
+    auto *FaultingAddress =
+        static_cast<uint8_t *>(TLS.getTrapState().FaultingAddress);
 #ifdef ZEN_ENABLE_VIRTUAL_STACK
-        auto *VirtualStack = Inst.currentVirtualStack();
-        if (FaultingAddress != nullptr && VirtualStack) {
-          if (FaultingAddress >= VirtualStack->AllInfo &&
-              FaultingAddress < VirtualStack->StackMemoryTop) {
-            CapturedTapErrCode = ErrorCode::CallStackExhausted;
-          }
-        }
+    auto *VirtualStack = Inst.currentVirtualStack();
+    if (FaultingAddress != nullptr && VirtualStack) {
+      if (FaultingAddress >= VirtualStack->AllInfo &&
+          FaultingAddress < VirtualStack->StackMemoryTop) {
+        CapturedTapErrCode = ErrorCode::CallStackExhausted;
+      }
+    }
 #else
 
 #ifdef ZEN_BUILD_PLATFORM_DARWIN
-        // on darwin get stack info
-        void *StackAddr = pthread_get_stackaddr_np(pthread_self());
-        size_t StackSize = pthread_get_stacksize_np(pthread_self());
+    // on darwin get stack info
+    void *StackAddr = pthread_get_stackaddr_np(pthread_self());
+    size_t StackSize = pthread_get_stacksize_np(pthread_self());
 #else
-        // on linux get stack info
-        pthread_attr_t Attrs;
-        pthread_getattr_np(pthread_self(), &Attrs);
+    // on linux get stack info
+    pthread_attr_t Attrs;
+    pthread_getattr_np(pthread_self(), &Attrs);
 
-        void *StackAddr;
-        size_t StackSize;
-        pthread_attr_getstack(&Attrs, &StackAddr, &StackSize);
+    void *StackAddr;
+    size_t StackSize;
+    pthread_attr_getstack(&Attrs, &StackAddr, &StackSize);
 #endif
 
-        size_t GuardSize =
-            common::StackGuardSize; // stack overflow guard, when overflow not
-                                    // in dwasm, not greater then StackGuardSize
-                                    // bytes
-        if ((uintptr_t)FaultingAddress >= (uintptr_t)StackAddr - GuardSize &&
-            (uintptr_t)FaultingAddress < ((uintptr_t)StackAddr + StackSize)) {
-          CapturedTapErrCode = ErrorCode::CallStackExhausted;
-        }
+    size_t GuardSize =
+        common::StackGuardSize; // stack overflow guard, when overflow not
+                                // in dwasm, not greater then StackGuardSize
+                                // bytes
+    if ((uintptr_t)FaultingAddress >= (uintptr_t)StackAddr - GuardSize &&
+        (uintptr_t)FaultingAddress < ((uintptr_t)StackAddr + StackSize)) {
+      CapturedTapErrCode = ErrorCode::CallStackExhausted;
+    }
 #ifndef ZEN_BUILD_PLATFORM_DARWIN
-        pthread_attr_destroy(&Attrs);
+    pthread_attr_destroy(&Attrs);
 #endif // ZEN_BUILD_PLATFORM_DARWIN
 
 #endif // ZEN_ENABLE_VIRTUAL_STACK
 
 #endif // ZEN_ENABLE_STACK_CHECK_CPU
-        break;
-      }
-      default: {
-        // SIGILL not process here. the traces set by Instance::setException
-        break;
-      }
-      }
-      if (Inst.getError().getCode() == ErrorCode::GasLimitExceeded) {
-        Inst.setGas(0);
-      } else if (Config.Mode == RunMode::SinglepassMode) {
-        // restore gas left from register when trap in singlepass JIT mode
-        Inst.setGas(TLS.getGasRegisterValue());
-      }
-      if (CapturedTapErrCode != ErrorCode::NoError) {
-        const auto &TrapState = TLS.getTrapState();
-        Inst.setExecutionError(common::getError(CapturedTapErrCode),
-                               TrapState.NumIgnoredFrames, TrapState);
-      }
-    }
-  };
-  CallWasmFnWrapper();
+    break;
+  }
+  default: {
+    // SIGILL not process here. the traces set by Instance::setException
+    break;
+  }
+  }
+  if (Inst.getError().getCode() == ErrorCode::GasLimitExceeded) {
+    Inst.setGas(0);
+  } else if (Inst.getModule()->getRunMode() == RunMode::SinglepassMode) {
+    // restore gas left from register when trap in singlepass JIT mode
+    Inst.setGas(TLS.getGasRegisterValue());
+  }
+  if (CapturedTapErrCode != ErrorCode::NoError) {
+    const auto &TrapState = TLS.getTrapState();
+    Inst.setExecutionError(common::getError(CapturedTapErrCode),
+                           TrapState.NumIgnoredFrames, TrapState);
+  }
+}
 #endif // ZEN_ENABLE_CPU_EXCEPTION
+
+void Runtime::callWasmFunctionInJITMode(Instance &Inst, uint32_t FuncIdx,
+                                        const std::vector<TypedValue> &Args,
+                                        std::vector<TypedValue> &Results) {
+  FunctionInstance *Func = Inst.getFunctionInst(FuncIdx);
+  bool IsImport = FuncIdx < Inst.getModule()->getNumImportFunctions();
+  auto FuncPtr =
+      GenericFunctionPointer(IsImport ? Func->CodePtr : Func->JITCodePtr);
+  callJITFunction(Inst, [&] {
+    entrypoint::callNativeGeneral(&Inst, FuncPtr, Args, Results,
+                                  this->getMemAllocator());
+  });
+}
+
+void Runtime::callWasmFunctionInJITMode(Instance &Inst,
+                                        const FunctionHandle &Func,
+                                        const UntypedValue *Args,
+                                        UntypedValue *Results) {
+  uint32_t FuncIdx = Func.getFuncIdx();
+  FunctionInstance *FuncInst = Inst.getFunctionInst(FuncIdx);
+  bool IsImport = FuncIdx < Inst.getModule()->getNumImportFunctions();
+  auto FuncPtr = GenericFunctionPointer(IsImport ? FuncInst->CodePtr
+                                                 : FuncInst->JITCodePtr);
+  const entrypoint::NativeCallSignature &Signature = Func.getNativeSignature();
+  if (!Signature.isSupported()) {
+    Inst.setError(getErrorWithExtraMessage(ErrorCode::UnexpectedFuncType,
+                                           "of jit function handle"));
+    return;
+  }
+  callJITFunction(Inst,
+                  [&] { Signature.call(&Inst, FuncPtr, Args, Results); });
+}
+
+void Runtime::callWasmFunctionBatchInJITMode(Instance &Inst,
+                                             const FunctionHandle &Func,
+                                             uint32_t NumCalls,
+                                             const UntypedValue *Args,
+                                             UntypedValue *Results,
+                                             BatchCallStatus *Statuses) {
+  uint32_t FuncIdx = Func.getFuncIdx();
+  FunctionInstance *FuncInst = Inst.getFunctionInst(FuncIdx);
+  bool IsImport = FuncIdx < Inst.getModule()->getNumImportFunctions();
+  auto FuncPtr = GenericFunctionPointer(IsImport ? FuncInst->CodePtr
+                                                 : FuncInst->JITCodePtr);
+  const entrypoint::NativeCallSignature &Signature = Func.getNativeSignature();
+  if (!Signature.isSupported()) {
+    for (uint32_t I = 0; I < NumCalls; ++I) {
+      Inst.setError(getErrorWithExtraMessage(ErrorCode::UnexpectedFuncType,
+                                             "of jit function handle"));
+      finishBatchCall(Inst, Statuses[I], I + 1 == NumCalls);
+    }
+    return;
+  }
+  uint32_t NumParams = Func.getNumParams();
+  uint32_t NumReturns = Func.getNumReturns();
+  callJITFunctions(
+      Inst, NumCalls,
+      [&](uint32_t I) {
+        Signature.call(&Inst, FuncPtr, Args + size_t(I) * NumParams,
+                       Results + size_t(I) * NumReturns);
+      },
+      [&](uint32_t I) {
+        finishBatchCall(Inst, Statuses[I], I + 1 == NumCalls);
+      });
 }
 #endif // ZEN_ENABLE_JIT
 
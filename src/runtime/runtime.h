@@ -19,8 +19,15 @@
 #include <utility>
 #include <vector>
 
+#ifdef ZEN_ENABLE_CPU_EXCEPTION
+namespace zen::common::traphandler {
+class CallThreadState;
+} // namespace zen::common::traphandler
+#endif
+
 namespace zen::runtime {
 
+class FunctionHandle;
 class HostModule;
 class Module;
 class Instance;
@@ -37,6 +44,14 @@ typedef struct VNMIEnvInternal_ {
 #define MERGE_HOST_MODULE(RT, OriginMod, Namespace, ModName)                   \
   RT->mergeHostModule(OriginMod, Namespace::m_##ModName##_desc)
 
+/// Outcome of one call of Runtime::callWasmFunctionBatch
+struct BatchCallStatus {
+  // InstanceExit means the call exited the instance, which isn't a failure
+  common::ErrorCode ErrCode = common::ErrorCode::NoError;
+  // gas left in the instance when the call returned
+  uint64_t GasLeft = 0;
+};
+
 // Only some of the methods of the Runtime class are thread-safe
 
 class Runtime final {
@@ -75,7 +90,6 @@ public:
 
   // ==================== Runtime Base Methods ====================
 
-  /// \warning not thread-safe
   WASMSymbol newSymbol(const char *Str, size_t Len) {
     return SymbolPool.newSymbol(Str, Len);
   }
@@ -84,7 +98,6 @@ public:
     return SymbolPool.probeSymbol(Str, Len);
   }
 
-  /// \warning not thread-safe
   void freeSymbol(WASMSymbol Symbol) { return SymbolPool.freeSymbol(Symbol); }
 
   const char *dumpSymbolString(WASMSymbol Symbol) {
@@ -92,50 +105,63 @@ public:
   }
 
   void *allocate(size_t Size, size_t Align = 0) {
+    if (ThreadCachingMPool) {
+      return ThreadCachingMPool->allocate(Size, Align);
+    }
     return MPool.allocate(Size, Align);
   }
 
   void *allocateZeros(size_t Size, size_t Align = 0) {
+    if (ThreadCachingMPool) {
+      return ThreadCachingMPool->allocateZeros(Size, Align);
+    }
     return MPool.allocateZeros(Size, Align);
   }
 
   void *reallocate(void *Ptr, size_t OldSize, size_t NewSize) {
+    if (ThreadCachingMPool) {
+      return ThreadCachingMPool->reallocate(Ptr, OldSize, NewSize);
+    }
     return MPool.reallocate(Ptr, OldSize, NewSize);
   }
 
-  void deallocate(void *Ptr) { MPool.deallocate(Ptr); }
+  void deallocate(void *Ptr) {
+    if (ThreadCachingMPool) {
+      ThreadCachingMPool->deallocate(Ptr);
+      return;
+    }
+    MPool.deallocate(Ptr);
+  }
 
   MemPool *getMemAllocator() { return &MPool; }
 
-  /// \warning not thread-safe using the returned result
   ConstStringPool *getSymbolPool() { return &SymbolPool; }
 
   // ==================== Runtime Tool Methods ====================
 
-  /// \warning not thread-safe
   HostModule *loadHostModule(BuiltinModuleDesc &HostModDesc) noexcept;
 
   /// \warning not thread-safe
   bool mergeHostModule(HostModule *HostMod,
                        BuiltinModuleDesc &OtherHostModDesc) noexcept;
 
-  /// \warning not thread-safe
   /// \return true if the module existed otherwise false
   bool unloadHostModule(HostModule *HostMod) noexcept;
 
   HostModule *resolveHostModule(WASMSymbol HostModName) const;
 
-  /// \warning not thread-safe
+  /// Modules are parsed and compiled without holding any runtime lock, so
+  /// different modules can be loaded from multiple threads concurrently. When
+  /// two threads load the same name, both get the module registered first.
   common::MayBe<Module *>
   loadModule(const std::string &Filename,
              const std::string &EntryHint = "") noexcept;
 
-  /// \warning not thread-safe
   common::MayBe<Module *>
   loadModule(const std::string &ModName, const void *Data, size_t DataSize,
              const std::string &EntryHint = "") noexcept;
 
-  /// \warning not thread-safe
+  /// \warning the module must not be used by other threads
   bool unloadModule(const Module *Mod) noexcept;
 
   Isolation *createManagedIsolation() noexcept;
@@ -157,6 +183,28 @@ public:
                         const std::vector<TypedValue> &Args,
                         std::vector<TypedValue> &Results);
 
+  /// Fast path for functions called repeatedly. The types of the values are
+  /// those of the handle's signature and aren't checked again.
+  /// \param Func must be resolved from the module of \p Inst
+  /// \param Args one value per param of \p Func
+  /// \param Results receives one value per result of \p Func
+  bool callWasmFunction(Instance &Inst, const FunctionHandle &Func,
+                        const common::UntypedValue *Args,
+                        common::UntypedValue *Results);
+
+  /// Call \p Func \p NumCalls times in a row on the same instance. The stack
+  /// and the trap handler are set up once for the whole batch. Call I reads
+  /// Args[I * NumParams, (I + 1) * NumParams) and writes its results from
+  /// Results[I * NumReturns]. A failing call doesn't stop the batch: its error
+  /// is recorded in Statuses[I] and cleared before the next call, only the
+  /// error of the last call is kept in the instance.
+  /// \return the number of calls which succeeded
+  uint32_t callWasmFunctionBatch(Instance &Inst, const FunctionHandle &Func,
+                                 uint32_t NumCalls,
+                                 const common::UntypedValue *Args,
+                                 common::UntypedValue *Results,
+                                 BatchCallStatus *Statuses);
+
 #ifdef ZEN_ENABLE_BUILTIN_WASI
   /// \warning not thread-safe
   void setWASIArgs(const std::string &wasm_name,
@@ -288,10 +336,25 @@ public:
       Instance &Inst, uint32_t FuncIdx, const std::vector<TypedValue> &Args,
       std::vector<common::TypedValue> &Results) noexcept;
 
+  void callWasmFunctionOnPhysStack(Instance &Inst, const FunctionHandle &Func,
+                                   const common::UntypedValue *Args,
+                                   common::UntypedValue *Results) noexcept;
+
+  void callWasmFunctionBatchOnPhysStack(Instance &Inst,
+                                        const FunctionHandle &Func,
+                                        uint32_t NumCalls,
+                                        const common::UntypedValue *Args,
+                                        common::UntypedValue *Results,
+                                        BatchCallStatus *Statuses) noexcept;
+
   /* **************** [End] Runtime Tool Methods  **************** */
 private:
   Runtime(const RuntimeConfig &Configuration)
-      : Config(Configuration), Stats(Config.EnableStatistics) {}
+      : Config(Configuration), Stats(Config.EnableStatistics) {
+    if (Config.EnableThreadCachingAllocator) {
+      ThreadCachingMPool = std::make_unique<common::ThreadCachingMemPool>();
+    }
+  }
 
   bool initRuntime() { return SymbolPool.initPool(); }
 
@@ -300,6 +363,11 @@ private:
   Module *loadModule(WASMSymbol ModName, CodeHolderUniquePtr CodeHolder,
                      const std::string &EntryHint = "");
 
+  Module *findModule(WASMSymbol ModName);
+
+  // caller must hold HostModulePoolMtx
+  HostModule *findHostModule(WASMSymbol HostModName) const;
+
   void callWasmFunctionInInterpMode(Instance &Inst, uint32_t FuncIdx,
                                     const std::vector<TypedValue> &Args,
                                     std::vector<common::TypedValue> &Results);
@@ -308,18 +376,60 @@ private:
   void callWasmFunctionInJITMode(Instance &Inst, uint32_t FuncIdx,
                                  const std::vector<TypedValue> &Args,
                                  std::vector<common::TypedValue> &Results);
+
+  void callWasmFunctionInJITMode(Instance &Inst, const FunctionHandle &Func,
+                                 const common::UntypedValue *Args,
+                                 common::UntypedValue *Results);
+
+  void callWasmFunctionBatchInJITMode(Instance &Inst,
+                                      const FunctionHandle &Func,
+                                      uint32_t NumCalls,
+                                      const common::UntypedValue *Args,
+                                      common::UntypedValue *Results,
+                                      BatchCallStatus *Statuses);
+
+  // run \p Call which enters JIT code, and turn cpu exceptions into errors
+  // of the instance
+  template <typename CallFn>
+  void callJITFunction(Instance &Inst, CallFn &&Call);
+
+  // run Call(I) then Done(I) for each I < \p NumCalls, sharing the trap
+  // handler between the calls
+  template <typename CallFn, typename DoneFn>
+  void callJITFunctions(Instance &Inst, uint32_t NumCalls, CallFn &&Call,
+                        DoneFn &&Done);
+
+#ifdef ZEN_ENABLE_CPU_EXCEPTION
+  void handleJITTrap(Instance &Inst,
+                     common::traphandler::CallThreadState &TLS,
+                     int JmpSignum);
 #endif
+#endif
+
+  // \return false if the call left an error in the instance
+  bool checkCallResult(Instance &Inst);
+
+  // record the outcome of a call of a batch in \p Status, the error is
+  // cleared unless \p IsLast
+  static void finishBatchCall(Instance &Inst, BatchCallStatus &Status,
+                              bool IsLast);
 
   common::Mutex Mtx;
 
   MemPool MPool;
+  // replaces MPool for runtime objects when EnableThreadCachingAllocator is
+  // set, native calls keep allocating from MPool
+  std::unique_ptr<common::ThreadCachingMemPool> ThreadCachingMPool;
 
   ConstStringPool SymbolPool;
 
   // supplementary module, libc, wasi, and other user defined native modules
   std::unordered_map<WASMSymbol, HostModuleUniquePtr> HostModulePool;
+  // host modules are resolved by every module being loaded
+  mutable common::SharedMutex HostModulePoolMtx;
   // multiple module mode
   std::unordered_map<WASMSymbol, ModuleUniquePtr> ModulePool;
+  common::Mutex ModulePoolMtx;
 
   std::unordered_map<Isolation *, IsolationUniquePtr> Isolations;
 
@@ -0,0 +1,320 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "runtime/sampling_profiler.h"
+
+#include "runtime/module.h"
+#include "runtime/runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sys/time.h>
+#include <thread>
+
+namespace zen::runtime {
+
+namespace {
+
+constexpr uint32_t NativeFuncIdx = -1u;
+
+struct SampleFrame {
+  uint32_t FuncIdx;
+  uint32_t Offset; // -1u if unknown
+};
+
+struct Sample {
+  // set by the handler once the other fields are written
+  std::atomic<bool> Ready{false};
+  bool Truncated = false;
+  uint32_t NumFrames = 0;
+  const Module *Mod = nullptr;
+  // innermost frame first
+  SampleFrame Frames[SamplingProfiler::MaxFrames];
+};
+
+struct SignalRegs {
+  uintptr_t PC;
+  uintptr_t FrameAddr;
+  uintptr_t StackAddr;
+};
+
+common::Mutex ControlMtx;
+bool HandlerInstalled = false;
+struct sigaction PrevAction;
+std::unique_ptr<Sample[]> SampleStorage;
+
+std::atomic<bool> Running{false};
+std::atomic<Sample *> Samples{nullptr};
+std::atomic<uint64_t> SampleCapacity{0};
+std::atomic<uint64_t> NextSample{0};
+std::atomic<uint64_t> NumDroppedSamples{0};
+// handlers which may still access the buffer they loaded from Samples,
+// start() waits for them before freeing it
+std::atomic<uint32_t> NumActiveHandlers{0};
+
+// initial-exec, so that the handler never allocates the tls block
+__attribute__((tls_model("initial-exec"))) thread_local const
+    SamplingProfiler::CallScope *CurrentScope = nullptr;
+
+void getSignalRegs(const ucontext_t *UCtx, SignalRegs &Regs) {
+#ifdef ZEN_BUILD_TARGET_X86_64
+#ifdef ZEN_BUILD_PLATFORM_DARWIN
+  Regs.PC = (uintptr_t)((UCtx->uc_mcontext)->__ss.__rip);
+  Regs.FrameAddr = (uintptr_t)((UCtx->uc_mcontext)->__ss.__rbp);
+  Regs.StackAddr = (uintptr_t)((UCtx->uc_mcontext)->__ss.__rsp);
+#else
+  Regs.PC = (uintptr_t)((UCtx->uc_mcontext).gregs[REG_RIP]);
+  Regs.FrameAddr = (uintptr_t)((UCtx->uc_mcontext).gregs[REG_RBP]);
+  Regs.StackAddr = (uintptr_t)((UCtx->uc_mcontext).gregs[REG_RSP]);
+#endif
+#else
+#ifdef ZEN_BUILD_PLATFORM_DARWIN
+  Regs.PC = (uintptr_t)((UCtx->uc_mcontext)->__ss.__pc);
+  Regs.FrameAddr = (uintptr_t)((UCtx->uc_mcontext)->__ss.__fp);
+  Regs.StackAddr = (uintptr_t)((UCtx->uc_mcontext)->__ss.__sp);
+#else
+  Regs.PC = (uintptr_t)((UCtx->uc_mcontext).pc);
+  Regs.FrameAddr = (uintptr_t)((UCtx->uc_mcontext).regs[29]);
+  Regs.StackAddr = (uintptr_t)((UCtx->uc_mcontext).sp);
+#endif // ZEN_BUILD_PLATFORM_DARWIN
+#endif
+}
+
+void addFrame(Sample &S, const Module &Mod, uintptr_t PC) {
+  uint32_t CodeOffset = 0;
+  uint32_t FuncIdx = Mod.getFuncIdxByJITCodePtr(
+      reinterpret_cast<const uint8_t *>(PC), CodeOffset);
+  if (FuncIdx == NativeFuncIdx) {
+    // consecutive native frames are merged
+    if (S.NumFrames > 0 &&
+        S.Frames[S.NumFrames - 1].FuncIdx == NativeFuncIdx) {
+      return;
+    }
+    S.Frames[S.NumFrames++] = {NativeFuncIdx, -1u};
+    return;
+  }
+  uint32_t InternalFuncIdx = FuncIdx - Mod.getNumImportFunctions();
+  uint32_t Offset = Mod.getBytecodeOffset(InternalFuncIdx, CodeOffset);
+  S.Frames[S.NumFrames++] = {FuncIdx, Offset};
+}
+
+// must be async-signal-safe, no lock and no allocation
+bool recordSample(const SamplingProfiler::CallScope &Scope, void *Ctx) {
+  Sample *Buffer = Samples.load(std::memory_order_acquire);
+  if (!Buffer) {
+    return false;
+  }
+  uint64_t Idx = NextSample.fetch_add(1, std::memory_order_relaxed);
+  if (Idx >= SampleCapacity.load(std::memory_order_relaxed)) {
+    NumDroppedSamples.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  SignalRegs Regs;
+  getSignalRegs(static_cast<const ucontext_t *>(Ctx), Regs);
+  const Module &Mod = *Scope.getModule();
+  Sample &S = Buffer[Idx];
+  S.Mod = &Mod;
+  S.NumFrames = 0;
+  S.Truncated = false;
+  addFrame(S, Mod, Regs.PC);
+
+  // only follow frame addresses between the interrupted stack pointer and the
+  // frame of the runtime which called into wasm, so that a frame pointer
+  // clobbered by native code can't make us read outside the stack
+  uintptr_t Lower = Regs.StackAddr;
+  uintptr_t Upper = Scope.getStartFrameAddr();
+  uintptr_t FrameAddr = Regs.FrameAddr;
+  while (FrameAddr >= Lower && FrameAddr + 2 * sizeof(uintptr_t) <= Upper &&
+         FrameAddr % sizeof(uintptr_t) == 0) {
+    if (S.NumFrames == SamplingProfiler::MaxFrames) {
+      S.Truncated = true;
+      break;
+    }
+    const auto *Frame = reinterpret_cast<const uintptr_t *>(FrameAddr);
+    // the return address follows the call, look up the call itself
+    addFrame(S, Mod, Frame[1] - 1);
+    Lower = FrameAddr + 2 * sizeof(uintptr_t);
+    FrameAddr = Frame[0];
+  }
+
+  S.Ready.store(true, std::memory_order_release);
+  return true;
+}
+
+void handleSignal(int SigNum, siginfo_t *SigInfo, void *Ctx) {
+  const SamplingProfiler::CallScope *Scope = CurrentScope;
+  if (Scope && Running.load(std::memory_order_relaxed)) {
+    // seq_cst, so that start() either sees this handler as active or the
+    // handler sees the buffer being replaced
+    NumActiveHandlers.fetch_add(1);
+    bool Recorded = recordSample(*Scope, Ctx);
+    NumActiveHandlers.fetch_sub(1, std::memory_order_release);
+    if (Recorded) {
+      return;
+    }
+  }
+  // not ours, let the previous handler see it
+  if ((PrevAction.sa_flags & SA_SIGINFO) != 0) {
+    PrevAction.sa_sigaction(SigNum, SigInfo, Ctx);
+  } else if (PrevAction.sa_handler != SIG_DFL &&
+             PrevAction.sa_handler != SIG_IGN) {
+    PrevAction.sa_handler(SigNum);
+  }
+}
+
+void setTimer(uint32_t Frequency) {
+  struct itimerval Timer;
+  std::memset(&Timer, 0, sizeof(Timer));
+  if (Frequency > 0) {
+    uint32_t IntervalUs = std::max(1000000u / Frequency, 1u);
+    Timer.it_interval.tv_sec = IntervalUs / 1000000;
+    Timer.it_interval.tv_usec = IntervalUs % 1000000;
+    Timer.it_value = Timer.it_interval;
+  }
+  setitimer(ITIMER_PROF, &Timer, nullptr);
+}
+
+std::string getFrameName(const Module &Mod, const SampleFrame &Frame,
+                         bool WithOffsets) {
+  if (Frame.FuncIdx == NativeFuncIdx) {
+    return "[native]";
+  }
+  std::string Name = Mod.getWasmFuncDebugName(Frame.FuncIdx);
+  if (WithOffsets && Frame.Offset != -1u) {
+    char OffsetStr[16];
+    snprintf(OffsetStr, sizeof(OffsetStr), "+0x%x", Frame.Offset);
+    Name += OffsetStr;
+  }
+  return Name;
+}
+
+} // namespace
+
+bool SamplingProfiler::start(uint32_t Frequency, uint32_t MaxSamples) {
+  ZEN_ASSERT(Frequency > 0 && MaxSamples > 0);
+  common::LockGuard<common::Mutex> Lock(ControlMtx);
+  if (Running.load(std::memory_order_relaxed)) {
+    return false;
+  }
+
+  // the handler stays installed once started, a SIGPROF still pending after
+  // stop() must not kill the process
+  if (!HandlerInstalled) {
+    struct sigaction Action;
+    std::memset(&Action, 0, sizeof(Action));
+#ifdef ZEN_ENABLE_VIRTUAL_STACK
+    Action.sa_flags = SA_SIGINFO | SA_RESTART | SA_ONSTACK;
+#else
+    Action.sa_flags = SA_SIGINFO | SA_RESTART;
+#endif // ZEN_ENABLE_VIRTUAL_STACK
+    Action.sa_sigaction = handleSignal;
+    sigemptyset(&Action.sa_mask);
+    if (sigaction(SIGPROF, &Action, &PrevAction) != 0) {
+      return false;
+    }
+    HandlerInstalled = true;
+  }
+
+  // a SIGPROF of the previous run can still be handled on another thread,
+  // unpublish the old buffer and wait for its users before freeing it
+  Samples.store(nullptr);
+  while (NumActiveHandlers.load() != 0) {
+    std::this_thread::yield();
+  }
+  SampleStorage.reset(new Sample[MaxSamples]);
+  SampleCapacity.store(MaxSamples, std::memory_order_relaxed);
+  NextSample.store(0, std::memory_order_relaxed);
+  NumDroppedSamples.store(0, std::memory_order_relaxed);
+  Samples.store(SampleStorage.get(), std::memory_order_release);
+  Running.store(true, std::memory_order_relaxed);
+
+  setTimer(Frequency);
+  return true;
+}
+
+void SamplingProfiler::stop() {
+  common::LockGuard<common::Mutex> Lock(ControlMtx);
+  if (!Running.load(std::memory_order_relaxed)) {
+    return;
+  }
+  setTimer(0);
+  Running.store(false, std::memory_order_relaxed);
+}
+
+bool SamplingProfiler::isRunning() {
+  return Running.load(std::memory_order_relaxed);
+}
+
+uint64_t SamplingProfiler::getNumSamples() {
+  return std::min(NextSample.load(std::memory_order_relaxed),
+                  SampleCapacity.load(std::memory_order_relaxed));
+}
+
+uint64_t SamplingProfiler::getNumDroppedSamples() {
+  return NumDroppedSamples.load(std::memory_order_relaxed);
+}
+
+std::string SamplingProfiler::getCollapsedStacks(bool WithOffsets) {
+  common::LockGuard<common::Mutex> Lock(ControlMtx);
+  Sample *Buffer = Samples.load(std::memory_order_acquire);
+  if (!Buffer) {
+    return "";
+  }
+
+  std::map<std::string, uint64_t> Stacks;
+  uint64_t NumSamples = getNumSamples();
+  for (uint64_t I = 0; I < NumSamples; ++I) {
+    const Sample &S = Buffer[I];
+    if (!S.Ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    const Module &Mod = *S.Mod;
+    // drop the runtime frames outside of the outermost wasm frame
+    uint32_t NumFrames = S.NumFrames;
+    while (NumFrames > 1 && S.Frames[NumFrames - 1].FuncIdx == NativeFuncIdx) {
+      --NumFrames;
+    }
+    const char *ModName = nullptr;
+    if (Mod.getName() != common::WASM_SYMBOL_NULL) {
+      ModName = Mod.getRuntime()->dumpSymbolString(Mod.getName());
+    }
+    std::string Stack = ModName ? ModName : "wasm";
+    if (S.Truncated) {
+      Stack += ";[truncated]";
+    }
+    for (uint32_t J = NumFrames; J-- > 0;) {
+      Stack += ';';
+      Stack += getFrameName(Mod, S.Frames[J], WithOffsets);
+    }
+    ++Stacks[Stack];
+  }
+
+  std::string Out;
+  for (const auto &[Stack, Count] : Stacks) {
+    Out += Stack;
+    Out += ' ';
+    Out += std::to_string(Count);
+    Out += '\n';
+  }
+  return Out;
+}
+
+SamplingProfiler::CallScope::CallScope(const Module *Mod, void *StartFrameAddr)
+    : Mod(Mod), StartFrameAddr(reinterpret_cast<uintptr_t>(StartFrameAddr)),
+      Parent(CurrentScope) {
+  // the handler may interrupt this thread at any point, publish the scope
+  // only once it is complete
+  std::atomic_signal_fence(std::memory_order_release);
+  CurrentScope = this;
+}
+
+SamplingProfiler::CallScope::~CallScope() {
+  CurrentScope = Parent;
+  std::atomic_signal_fence(std::memory_order_release);
+}
+
+} // namespace zen::runtime
@@ -0,0 +1,79 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_RUNTIME_SAMPLING_PROFILER_H
+#define ZEN_RUNTIME_SAMPLING_PROFILER_H
+
+#include "common/defines.h"
+#include <string>
+
+namespace zen::runtime {
+
+class Module;
+
+/// In-process sampling profiler for JIT code, usable where perf is not.
+///
+/// A SIGPROF timer interrupts the process at a fixed rate of cpu time. When
+/// the interrupted thread runs wasm code, the handler walks the frame pointer
+/// chain of the JIT frames and records the wasm function index and bytecode
+/// offset of every frame into a preallocated buffer, without taking a lock
+/// or allocating. Samples taken outside of wasm calls are ignored.
+///
+/// Bytecode offsets are only known for singlepass code, multipass frames are
+/// attributed to functions only. Functions compiled lazily by multipass after
+/// the module is loaded are reported as native frames.
+class SamplingProfiler final {
+public:
+  static constexpr uint32_t DefaultFrequency = 997;
+  static constexpr uint32_t DefaultMaxSamples = 16384;
+  // deeper frames are dropped, keeping the innermost ones
+  static constexpr uint32_t MaxFrames = 32;
+
+  /// Start sampling at \p Frequency samples per second of cpu time, until
+  /// stop() or until \p MaxSamples samples were taken. The previous samples
+  /// are discarded.
+  /// \return false if already started or the timer can't be set
+  static bool start(uint32_t Frequency = DefaultFrequency,
+                    uint32_t MaxSamples = DefaultMaxSamples);
+
+  static void stop();
+
+  static bool isRunning();
+
+  /// Aggregate the samples in the collapsed stack format of flamegraph.pl,
+  /// one "module;caller;callee count" line per distinct stack. Frames are
+  /// named "func+0x<offset>" with \p WithOffsets, the offset is relative to
+  /// the instructions of the function body.
+  /// \warning must be called after stop() and while the sampled modules are
+  /// still loaded
+  static std::string getCollapsedStacks(bool WithOffsets = true);
+
+  static uint64_t getNumSamples();
+
+  /// \return the number of samples lost because the buffer was full
+  static uint64_t getNumDroppedSamples();
+
+  /// Mark the current thread as running wasm code of \p Mod until destroyed,
+  /// JIT frames are searched below \p StartFrameAddr
+  class CallScope {
+  public:
+    CallScope(const Module *Mod, void *StartFrameAddr);
+
+    ~CallScope();
+
+    NONCOPYABLE(CallScope);
+
+    const Module *getModule() const { return Mod; }
+
+    uintptr_t getStartFrameAddr() const { return StartFrameAddr; }
+
+  private:
+    const Module *Mod;
+    uintptr_t StartFrameAddr;
+    const CallScope *Parent;
+  };
+};
+
+} // namespace zen::runtime
+
+#endif // ZEN_RUNTIME_SAMPLING_PROFILER_H
@@ -48,13 +48,16 @@ public:
   }
 
 public:
-  // return register for integer
-  constexpr static uint32_t NumIntRetRegs = 1;
+  // return registers for integer, the second one only for multi-value
+  constexpr static uint32_t NumIntRetRegs = 2;
   static constexpr A64::GP IntRetReg = A64::X0;
+  static constexpr A64::GP IntRetReg2 = A64::X1;
 
-  // return register for floating-point/vector
-  constexpr static uint32_t NumFloatRetRegs = 1;
+  // return registers for floating-point/vector, the second one only for
+  // multi-value
+  constexpr static uint32_t NumFloatRetRegs = 2;
   static constexpr A64::FP FloatRetReg = A64::V0;
+  static constexpr A64::FP FloatRetReg2 = A64::V1;
 
   // return register count
   template <A64::Type Ty> static constexpr uint32_t getNumRetRegs() {
@@ -70,6 +73,17 @@ public:
                : (typename A64TypeAttr<Ty>::RegNum)FloatRetReg;
   }
 
+  // return register number by index among the return registers of its kind
+  template <A64::Type Ty>
+  static typename A64TypeAttr<Ty>::RegNum getRetRegNum(uint32_t Index) {
+    ZEN_ASSERT(Index < getNumRetRegs<Ty>());
+    if (A64TypeAttr<Ty>::Kind == A64::GPR) {
+      return (typename A64TypeAttr<Ty>::RegNum)(Index ? IntRetReg2 : IntRetReg);
+    }
+    return (typename A64TypeAttr<Ty>::RegNum)(Index ? FloatRetReg2
+                                                   : FloatRetReg);
+  }
+
   // return register object reference represented by asmjit
   template <A64::Type Ty>
   static constexpr typename A64TypeAttr<Ty>::Type &getRetReg() {
@@ -43,7 +43,7 @@ public:
 class A64ArgumentInfo
     : public ArgumentInfo<A64ArgumentInfo, A64ArgumentInfoAttrs> {
 public:
-  A64ArgumentInfo(TypeEntry *Type) : ArgumentInfo(Type) {}
+  A64ArgumentInfo(const TypeEntry *Type) : ArgumentInfo(Type) {}
 
   static constexpr A64::Type getDataTypeFromWASMType(WASMType Type) {
     return getA64TypeFromWASMType(Type);
@@ -215,14 +215,27 @@ private:
   } // EmitProlog
 
   // epilog
-  void emitEpilog(Operand Op) {
+  void emitEpilog(const std::vector<Operand> &Results) {
     saveGasVal();
 
 #ifdef ZEN_ENABLE_DWASM
-    // update stack cost
+    emitUpdateStackCost(Layout.getScopedTempReg<A64::I32, ScopedTempReg0>());
+#endif
+
+    // the results are left on the exception exit
+    if (!Results.empty()) {
+      moveReturnValues(Results);
+    }
+
+    emitLeaveFrame();
+    _ ret(ABI.getLinkAddressReg());
+  } // EmitEpilog
+
+#ifdef ZEN_ENABLE_DWASM
+  // subtract the stack cost of the current function, through StackCostReg
+  void emitUpdateStackCost(const asmjit::a64::GpW &StackCostReg) {
     auto StackCostAddr = asmjit::a64::ptr(
         ABI.getModuleInstReg(), Ctx->Mod->getLayout().StackCostOffset);
-    auto StackCostReg = Layout.getScopedTempReg<A64::I32, ScopedTempReg0>();
     _ ldr(StackCostReg, StackCostAddr);
     uint32_t StackCost = Ctx->Func->JITStackCost;
     if (!isArithImmValid(StackCost)) {
@@ -234,32 +247,12 @@ private:
       _ sub(StackCostReg, StackCostReg, Ctx->Func->JITStackCost);
     }
     _ str(StackCostReg, StackCostAddr);
+  }
 #endif
 
-    if (Layout.getNumReturns() > 0) {
-      ZEN_ASSERT(Layout.getNumReturns() == 1);
-      ZEN_ASSERT(Layout.getReturnType(0) == Op.getType());
-      switch (Op.getType()) {
-      case WASMType::I32:
-        mov<A64::I32>(ABI.getRetRegNum<A64::I32>(), Op);
-        break;
-      case WASMType::I64:
-        mov<A64::I64>(ABI.getRetRegNum<A64::I64>(), Op);
-        break;
-      case WASMType::F32:
-        mov<A64::F32>(ABI.getRetRegNum<A64::F32>(), Op);
-        break;
-      case WASMType::F64:
-        mov<A64::F64>(ABI.getRetRegNum<A64::F64>(), Op);
-        break;
-      case WASMType::V128:
-        ZEN_ASSERT_TODO();
-        break;
-      default:
-        ZEN_ABORT();
-      }
-    }
-
+  // pop the frame of the current function, the return address is left in the
+  // link register
+  void emitLeaveFrame() {
     // restore preserved registers
     for (uint32_t I = 0; I < Layout.getIntPresSavedCount(); ++I) {
       const A64::GP Reg = ABI.getPresRegNum<A64::I64>(I);
@@ -271,8 +264,28 @@ private:
     // restore stack
     _ ldp(ABI.getFrameBaseReg(), ABI.getLinkAddressReg(),
           asmjit::a64::ptr_post(ABI.getStackPointerReg(), 16));
-    _ ret(ABI.getLinkAddressReg());
-  } // EmitEpilog
+  }
+
+  // jump to the function in x24 in place of the current one, which returns
+  // to the caller of the current function. x24 is restored with the other
+  // preserved registers, the target and the stack arguments move through x16
+  // and x17, which pass no argument
+  void emitTailJump(uint32_t ArgStackSize) {
+    auto Target = asmjit::a64::x16;
+    auto Temp = asmjit::a64::x17;
+    for (uint32_t Offset = 0; Offset < ArgStackSize;
+         Offset += ABI.GpRegWidth) {
+      _ ldr(Temp, asmjit::a64::ptr(ABI.getStackPointerReg(), Offset));
+      _ str(Temp, asmjit::a64::ptr(ABI.getFrameBaseReg(),
+                                   ABI.FormalStackOffset + Offset));
+    }
+#ifdef ZEN_ENABLE_DWASM
+    emitUpdateStackCost(asmjit::a64::w17);
+#endif
+    _ mov(Target, ABI.getCallTargetReg());
+    emitLeaveFrame();
+    _ br(Target);
+  }
 
   template <uint32_t AddrRegIndex, uint32_t SizeRegIndex, uint32_t CmpRegIndex>
   void emitGetTableAddress(uint32_t TblIdx, Operand EntryIdx) {
@@ -796,6 +809,15 @@ public:
     }
   }
 
+  // the offset is added into the base register, so the local is copied first
+  template <WASMType DestType, WASMType SrcType, bool Sext>
+  Operand handleFusedGetLocalLoadImpl(uint32_t LocalIdx, uint32_t Offset,
+                                      uint32_t Align) {
+    Operand Base = handleGetLocal(LocalIdx);
+    releaseOperand(Base);
+    return handleLoadImpl<DestType, SrcType, Sext>(Base, Offset, Align);
+  }
+
   // load from memory in SrcType and return in DestType
   template <WASMType DestType, WASMType SrcType, bool Sext>
   Operand handleLoadImpl(Operand Base, uint32_t Offset, uint32_t Align) {
@@ -1034,9 +1056,10 @@ public:
   }
 
   // call
-  Operand handleCallImpl(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
-                         bool FarCall, const ArgumentInfo &ArgInfo,
-                         const std::vector<Operand> &Args) {
+  std::vector<Operand> handleCallImpl(uint32_t FuncIdx, uintptr_t Target,
+                                      bool IsImport, bool FarCall,
+                                      const ArgumentInfo &ArgInfo,
+                                      const std::vector<Operand> &Args) {
     return emitCall(
         ArgInfo, Args,
         [this, IsImport] {
@@ -1082,80 +1105,16 @@ public:
         });
   }
 
-  Operand handleCallIndirectImpl(uint32_t TypeIdx, Operand Callee,
-                                 uint32_t TblIdx, const ArgumentInfo &ArgInfo,
-                                 const std::vector<Operand> &Args) {
-    uint32_t NumHostAPIs = Ctx->Mod->getNumImportFunctions();
+  std::vector<Operand>
+  handleCallIndirectImpl(uint32_t TypeIdx, Operand Callee, uint32_t TblIdx,
+                         const ArgumentInfo &ArgInfo,
+                         const std::vector<Operand> &Args) {
     return emitCall(
         ArgInfo, Args,
-        // prepare call, check and load Callee address into %r11
-        [this, NumHostAPIs, TypeIdx, Callee, TblIdx]() {
+        // prepare call, check and load Callee address into x24
+        [this, TypeIdx, Callee, TblIdx]() {
           saveGasVal();
-
-          auto FuncIdxReg = Layout.getScopedTemp<A64::I32, ScopedTempReg0>();
-          emitTableGet(TblIdx, Callee, FuncIdxReg);
-          auto FuncIdx = A64Reg::getRegRef<A64::I32>(FuncIdxReg);
-          auto InstReg = ABI.getModuleInstReg();
-          uint32_t CheckFuncType = createLabel();
-          bool Exchanged;
-          cmp<A64::I32, ScopedTempReg2, ScopedTempReg2>(
-              Operand(WASMType::I32, FuncIdxReg, Operand::FLAG_NONE),
-              Operand(WASMType::I32, -1), Exchanged);
-          jmpcc<CompareOperator::CO_NE, true>(CheckFuncType);
-          emitRuntimeError(ErrorCode::UninitializedElement);
-
-          bindLabel(CheckFuncType);
-          auto TypeIdxs = Layout.getScopedTempReg<A64::I64, ScopedTempReg2>();
-          asmjit::a64::Mem TypeIdxsAddr(InstReg, FunctionTypesOffset);
-          _ ldr(TypeIdxs, TypeIdxsAddr);
-
-          asmjit::a64::Mem TypeIdxAddr(TypeIdxs, FuncIdx, asmjit::a64::lsl(2));
-          auto ActualTypeIdx =
-              Layout.getScopedTempReg<A64::I32, ScopedTempReg2>();
-          _ ldr(ActualTypeIdx, TypeIdxAddr);
-
-          uint32_t CheckSucc = createLabel();
-          _ cmp(ActualTypeIdx, TypeIdx);
-          jmpcc<CompareOperator::CO_EQ, true>(CheckSucc);
-          emitRuntimeError(ErrorCode::IndirectCallTypeMismatch);
-          bindLabel(CheckSucc);
-
-#ifdef ZEN_ENABLE_DWASM
-          // check FuncIdx < import_funcs_count (is_import)
-          // if is_import, update WasmInstance::is_host_api
-          auto UpdateFlagLabel = createLabel();
-          auto EndUpdateFlagLabel = createLabel();
-          // The immediate value in the cmp instruction is 12-bit
-          if (ZEN_LIKELY(isArithImmValid(NumHostAPIs))) {
-            _ cmp(FuncIdx, NumHostAPIs);
-          } else {
-            auto NumHostAPIsReg =
-                Layout.getScopedTempReg<A64::I32, ScopedTempReg1>();
-            _ mov(NumHostAPIsReg, NumHostAPIs);
-            _ cmp(FuncIdx, NumHostAPIsReg);
-          }
-
-          branchLTU(UpdateFlagLabel);
-          branch(EndUpdateFlagLabel);
-
-          bindLabel(UpdateFlagLabel);
-          auto InHostAPIFlagAddr =
-              asmjit::a64::ptr(ABI.getModuleInstReg(), InHostApiOffset);
-          movImm<A64::I8, ScopedTempReg0>(InHostAPIFlagAddr, 1);
-          branch(EndUpdateFlagLabel);
-
-          bindLabel(EndUpdateFlagLabel);
-#endif
-
-          auto FuncPtrs = Layout.getScopedTempReg<A64::I64, ScopedTempReg2>();
-          asmjit::a64::Mem FuncPtrsAddr(InstReg, FunctionPointersOffset);
-          _ ldr(FuncPtrs, FuncPtrsAddr);
-
-          auto FuncPtr = ABI.getCallTargetReg();
-          constexpr uint32_t Shift = sizeof(void *) == 4 ? 2 : 3;
-          asmjit::a64::Mem FuncPtrAddr(FuncPtrs, FuncIdx,
-                                       asmjit::a64::lsl(Shift));
-          _ ldr(FuncPtr, FuncPtrAddr);
+          emitIndirectCallTarget(TypeIdx, Callee, TblIdx);
         },
         // generate call
         [&]() { _ blr(ABI.getCallTargetReg()); },
@@ -1173,6 +1132,74 @@ public:
         });
   }
 
+  // check the function at index Callee of table TblIdx has type TypeIdx and
+  // load its address into x24
+  void emitIndirectCallTarget(uint32_t TypeIdx, Operand Callee,
+                              uint32_t TblIdx) {
+    auto FuncIdxReg = Layout.getScopedTemp<A64::I32, ScopedTempReg0>();
+    emitTableGet(TblIdx, Callee, FuncIdxReg);
+    auto FuncIdx = A64Reg::getRegRef<A64::I32>(FuncIdxReg);
+    auto InstReg = ABI.getModuleInstReg();
+    uint32_t CheckFuncType = createLabel();
+    bool Exchanged;
+    cmp<A64::I32, ScopedTempReg2, ScopedTempReg2>(
+        Operand(WASMType::I32, FuncIdxReg, Operand::FLAG_NONE),
+        Operand(WASMType::I32, -1), Exchanged);
+    jmpcc<CompareOperator::CO_NE, true>(CheckFuncType);
+    emitRuntimeError(ErrorCode::UninitializedElement);
+
+    bindLabel(CheckFuncType);
+    auto TypeIdxs = Layout.getScopedTempReg<A64::I64, ScopedTempReg2>();
+    asmjit::a64::Mem TypeIdxsAddr(InstReg, FunctionTypesOffset);
+    _ ldr(TypeIdxs, TypeIdxsAddr);
+
+    asmjit::a64::Mem TypeIdxAddr(TypeIdxs, FuncIdx, asmjit::a64::lsl(2));
+    auto ActualTypeIdx = Layout.getScopedTempReg<A64::I32, ScopedTempReg2>();
+    _ ldr(ActualTypeIdx, TypeIdxAddr);
+
+    uint32_t CheckSucc = createLabel();
+    _ cmp(ActualTypeIdx, TypeIdx);
+    jmpcc<CompareOperator::CO_EQ, true>(CheckSucc);
+    emitRuntimeError(ErrorCode::IndirectCallTypeMismatch);
+    bindLabel(CheckSucc);
+
+#ifdef ZEN_ENABLE_DWASM
+    // check FuncIdx < import_funcs_count (is_import)
+    // if is_import, update WasmInstance::is_host_api
+    uint32_t NumHostAPIs = Ctx->Mod->getNumImportFunctions();
+    auto UpdateFlagLabel = createLabel();
+    auto EndUpdateFlagLabel = createLabel();
+    // The immediate value in the cmp instruction is 12-bit
+    if (ZEN_LIKELY(isArithImmValid(NumHostAPIs))) {
+      _ cmp(FuncIdx, NumHostAPIs);
+    } else {
+      auto NumHostAPIsReg = Layout.getScopedTempReg<A64::I32, ScopedTempReg1>();
+      _ mov(NumHostAPIsReg, NumHostAPIs);
+      _ cmp(FuncIdx, NumHostAPIsReg);
+    }
+
+    branchLTU(UpdateFlagLabel);
+    branch(EndUpdateFlagLabel);
+
+    bindLabel(UpdateFlagLabel);
+    auto InHostAPIFlagAddr =
+        asmjit::a64::ptr(ABI.getModuleInstReg(), InHostApiOffset);
+    movImm<A64::I8, ScopedTempReg0>(InHostAPIFlagAddr, 1);
+    branch(EndUpdateFlagLabel);
+
+    bindLabel(EndUpdateFlagLabel);
+#endif
+
+    auto FuncPtrs = Layout.getScopedTempReg<A64::I64, ScopedTempReg2>();
+    asmjit::a64::Mem FuncPtrsAddr(InstReg, FunctionPointersOffset);
+    _ ldr(FuncPtrs, FuncPtrsAddr);
+
+    auto FuncPtr = ABI.getCallTargetReg();
+    constexpr uint32_t Shift = sizeof(void *) == 4 ? 2 : 3;
+    asmjit::a64::Mem FuncPtrAddr(FuncPtrs, FuncIdx, asmjit::a64::lsl(Shift));
+    _ ldr(FuncPtr, FuncPtrAddr);
+  }
+
   // branch to label if ZF is 0
   void je(uint32_t LabelIdx) {
     asmjit::Label L(LabelIdx);
@@ -1186,7 +1213,61 @@ public:
   }
 
   // return
-  void handleReturnImpl(Operand Op) { emitEpilog(Op); }
+  void handleReturnImpl(const std::vector<Operand> &Results) {
+    emitEpilog(Results);
+  }
+
+  // return call, the arguments are placed like a call, then the frame is popped
+  // and the callee is jumped to. Host functions need the exception check
+  // after the call, they are called and their result is returned
+  void handleReturnCallImpl(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
+                            bool FarCall, const ArgumentInfo &ArgInfo,
+                            const std::vector<Operand> &Args) {
+    if (IsImport) {
+      handleReturnImpl(
+          handleCallImpl(FuncIdx, Target, IsImport, FarCall, ArgInfo, Args));
+      return;
+    }
+    std::vector<Operand> Rets = emitCall(
+        ArgInfo, Args, [this] { saveGasVal(); },
+        [this, FuncIdx, &ArgInfo]() {
+          auto FuncPtr = ABI.getCallTargetReg();
+          asmjit::a64::Mem FuncPtrsAddr(ABI.getModuleInstReg(),
+                                        FunctionPointersOffset);
+          _ ldr(FuncPtr, FuncPtrsAddr);
+          auto FuncIdxReg = asmjit::a64::x17;
+          _ mov(FuncIdxReg, FuncIdx);
+          constexpr uint32_t Shift = sizeof(void *) == 4 ? 2 : 3;
+          asmjit::a64::Mem FuncPtrAddr(FuncPtr, FuncIdxReg,
+                                       asmjit::a64::lsl(Shift));
+          _ ldr(FuncPtr, FuncPtrAddr);
+          emitTailJump(ArgInfo.getArgStackSize());
+        },
+        []() {});
+    // in reverse, as a temp stack operand releases the ones above it
+    for (auto It = Rets.rbegin(); It != Rets.rend(); ++It) {
+      releaseOperand(*It);
+    }
+  }
+
+  // return call indirect, the tables of the module hold no host functions
+  void handleReturnCallIndirectImpl(uint32_t TypeIdx, Operand Callee,
+                                    uint32_t TblIdx,
+                                    const ArgumentInfo &ArgInfo,
+                                    const std::vector<Operand> &Args) {
+    std::vector<Operand> Rets = emitCall(
+        ArgInfo, Args,
+        [this, TypeIdx, Callee, TblIdx]() {
+          saveGasVal();
+          emitIndirectCallTarget(TypeIdx, Callee, TblIdx);
+        },
+        [this, &ArgInfo]() { emitTailJump(ArgInfo.getArgStackSize()); },
+        []() {});
+    // in reverse, as a temp stack operand releases the ones above it
+    for (auto It = Rets.rbegin(); It != Rets.rend(); ++It) {
+      releaseOperand(*It);
+    }
+  }
 
   // unreachable
   void handleUnreachableImpl() { emitRuntimeError(ErrorCode::Unreachable); }
@@ -1205,10 +1286,12 @@ public:
         .NumParamCells = 1,
         .NumReturns = 1,
         .NumReturnCells = 1,
-        .ReturnTypes = {WASMType::I32},
         {
             .ParamTypesVec = {WASMType::I32},
         },
+        {
+            .ReturnTypesVec = {WASMType::I32},
+        },
         .SmallestTypeIdx = uint32_t(-1),
     };
     ArgumentInfo ArgInfo(&SigBuf);
@@ -1219,6 +1302,18 @@ public:
       auto InstReg = ABI.getModuleInstReg();
       auto MemReg = ABI.getMemoryBaseReg();
 
+      // memory base never changes when the memory is grown in place, so
+      // only the memory size need to be reloaded
+      if (Ctx->UseFixedMemBase) {
+        // x0 holds the result of the call
+        auto TmpReg = Layout.getScopedTemp<A64::I64, ScopedTempReg1>();
+        auto MemsReg = A64Reg::getRegRef<A64::I64>(TmpReg);
+        _ ldr(MemsReg, asmjit::a64::ptr(InstReg, MemoriesOffset));
+        _ ldr(ABI.getMemorySizeReg(),
+              asmjit::a64::ptr(MemsReg, MemorySizeOffset));
+        return;
+      }
+
       auto MemsPtr = asmjit::a64::ptr(InstReg, MemoriesOffset);
       _ ldr(MemReg, MemsPtr);
 
@@ -1228,8 +1323,54 @@ public:
       auto MemBasePtr = asmjit::a64::ptr(MemReg, MemoryBaseOffset);
       _ ldr(MemReg, MemBasePtr);
     };
-    return emitCall(
-        ArgInfo, Args, [] {}, GenCall, [] {});
+    std::vector<Operand> Rets = emitCall(ArgInfo, Args, [] {}, GenCall, [] {});
+    return Rets.front();
+  }
+
+  // bulk memory, always calls the runtime helpers, which charge gas and check
+  // bounds themselves
+  void handleMemoryInitImpl(uint32_t DataIdx, Operand Dst, Operand Src,
+                            Operand Len) {
+    static TypeEntry SigBuf = {
+        .NumParams = 4,
+        .NumParamCells = 4,
+        .NumReturns = 0,
+        .NumReturnCells = 0,
+        {
+            .ParamTypesVec = {WASMType::I32, WASMType::I32, WASMType::I32,
+                              WASMType::I32},
+        },
+        .SmallestTypeIdx = uint32_t(-1),
+    };
+    Operand Idx(WASMType::I32, int32_t(DataIdx));
+    emitBulkMemoryCall(&SigBuf, {Idx, Dst, Src, Len},
+                       uintptr_t(Instance::initMemoryOnJIT));
+  }
+
+  void handleDataDropImpl(uint32_t DataIdx) {
+    static TypeEntry SigBuf = {
+        .NumParams = 1,
+        .NumParamCells = 1,
+        .NumReturns = 0,
+        .NumReturnCells = 0,
+        {
+            .ParamTypesVec = {WASMType::I32},
+        },
+        .SmallestTypeIdx = uint32_t(-1),
+    };
+    Operand Idx(WASMType::I32, int32_t(DataIdx));
+    emitBulkMemoryCall(&SigBuf, {Idx},
+                       uintptr_t(Instance::dropDataSegmentOnJIT));
+  }
+
+  void handleMemoryCopyImpl(Operand Dst, Operand Src, Operand Len) {
+    emitBulkMemoryCall(getBulkMemorySig(), {Dst, Src, Len},
+                       uintptr_t(Instance::copyMemoryOnJIT));
+  }
+
+  void handleMemoryFillImpl(Operand Dst, Operand Val, Operand Len) {
+    emitBulkMemoryCall(getBulkMemorySig(), {Dst, Val, Len},
+                       uintptr_t(Instance::fillMemoryOnJIT));
   }
 
   // memory size
@@ -1274,6 +1415,23 @@ public:
     }
   }
 
+  // add to a uint64 counter of function profiling, keeps all registers
+  void addFunctionCounter(uint32_t Offset, Operand Delta) {
+    // the offset may be out of the range of ldr/str immediates
+    auto AddrReg = A64Reg::getRegRef<A64::I64>(ABI.getScratchRegNum());
+    _ mov(AddrReg, Offset);
+    _ add(AddrReg, ABI.getModuleInstReg(), AddrReg);
+    auto CounterReg = Layout.getScopedTempReg<A64::I64, ScopedTempReg0>();
+    _ ldr(CounterReg, asmjit::a64::ptr(AddrReg));
+    if (Delta.isImm() && isArithImmValid(Delta.getImm())) {
+      _ add(CounterReg, CounterReg, Delta.getImm());
+    } else {
+      auto DeltaRegNum = toReg<A64::I64, ScopedTempReg1>(Delta);
+      _ add(CounterReg, CounterReg, A64Reg::getRegRef<A64::I64>(DeltaRegNum));
+    }
+    _ str(CounterReg, asmjit::a64::ptr(AddrReg));
+  }
+
   void loadGasVal() {
     auto GasPtr = asmjit::a64::ptr(ABI.getModuleInstReg(), GasLeftOffset);
     _ ldr(ABI.getGasReg(), GasPtr);
@@ -1564,6 +1722,33 @@ private:
   // helper functions, move to op_assembler_a64.h?
   //
 
+  // signature of memory.copy and memory.fill helpers: (i32, i32, i32) -> void
+  static TypeEntry *getBulkMemorySig() {
+    static TypeEntry SigBuf = {
+        .NumParams = 3,
+        .NumParamCells = 3,
+        .NumReturns = 0,
+        .NumReturnCells = 0,
+        {
+            .ParamTypesVec = {WASMType::I32, WASMType::I32, WASMType::I32},
+        },
+        .SmallestTypeIdx = uint32_t(-1),
+    };
+    return &SigBuf;
+  }
+
+  void emitBulkMemoryCall(TypeEntry *Sig, const std::vector<Operand> &Args,
+                          uintptr_t Target) {
+    ArgumentInfo ArgInfo(Sig);
+    emitCall(
+        ArgInfo, Args, [this] { saveGasVal(); },
+        [this, Target] { callAbsolute(Target); },
+        [this] {
+          loadGasVal();
+          checkCallException(true);
+        });
+  }
+
   void callAbsolute(uintptr_t Addr) {
     auto Target = ABI.getCallTargetReg();
     _ mov(Target, Addr);
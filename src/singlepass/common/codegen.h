@@ -44,11 +44,11 @@ public:
     uint32_t getOffset() const { return Offset; }
   };
 
-  ArgumentInfo(TypeEntry *Type) {
+  ArgumentInfo(const TypeEntry *Type) {
     ZEN_ASSERT(Type);
-    ZEN_ASSERT(Type->NumReturns <= 1);
     uint32_t ArgNum = Type->NumParams;
-    RetType = Type->getReturnType();
+    NumReturns = Type->NumReturns;
+    ReturnTypes = Type->getReturnTypes();
     uint32_t GpNum = 0;
     uint32_t FpNum = 0;
     uint32_t StkSize = OnePassABI::ActualStackOffset;
@@ -60,6 +60,7 @@ public:
     if (ArgNum == 0) {
       NumGpRegs = GpNum;
       NumFpRegs = 0;
+      ArgStackSize = StkSize;
       StackSize = StkSize;
       return;
     }
@@ -88,12 +89,17 @@ public:
     }
     NumGpRegs = GpNum;
     NumFpRegs = FpNum;
+    ArgStackSize = StkSize;
     StkSize = ZEN_ALIGN(StkSize, ArchABI::FpRegWidth);
     StackSize = StkSize;
   }
 
-  WASMType getReturnType() const { return RetType; }
+  uint32_t getNumReturns() const { return NumReturns; }
+  const WASMType *getReturnTypes() const { return ReturnTypes; }
   uint32_t getStackSize() const { return StackSize; }
+  // the bytes of the stack arguments without the padding of getStackSize,
+  // a caller may only reserve these
+  uint32_t getArgStackSize() const { return ArgStackSize; }
 
   typedef typename std::vector<Argument>::const_reverse_iterator
       ConstReverseIterator;
@@ -135,7 +141,9 @@ private:
   uint8_t NumGpRegs;
   uint8_t NumFpRegs;
   uint16_t StackSize;
-  WASMType RetType : 8;
+  uint16_t ArgStackSize;
+  uint32_t NumReturns;
+  const WASMType *ReturnTypes;
 };
 
 constexpr uint32_t InvalidLabelId = asmjit::Globals::kInvalidId;
@@ -213,17 +221,21 @@ public:
   // Record each nested block
   class BlockInfo {
   public:
-    BlockInfo(CtrlBlockKind Kind, Operand Result, uint32_t Label,
+    BlockInfo(CtrlBlockKind Kind, std::vector<Operand> Params,
+              std::vector<Operand> Results, uint32_t Label,
               uint32_t StackSize)
-        : Kind(Kind), Result(Result), Label(Label), StackSize(StackSize) {}
+        : Kind(Kind), Params(std::move(Params)), Results(std::move(Results)),
+          Label(Label), StackSize(StackSize) {}
 
     // Get block kind
     CtrlBlockKind getKind() const { return Kind; }
 
-    Operand getResult() const { return Result; }
+    // Get the operands of the params, pushed at the start of the block (and
+    // of the else block) and assigned by the branches to a loop
+    const std::vector<Operand> &getParams() const { return Params; }
 
-    // Get block WASM type
-    WASMType getType() const { return Result.getType(); }
+    // Get the operands of the results, assigned by the branches to the block
+    const std::vector<Operand> &getResults() const { return Results; }
 
     // Get label associated with the block
     uint32_t getLabel() const { return Label; }
@@ -247,7 +259,8 @@ public:
 
   private:
     CtrlBlockKind Kind;
-    Operand Result;
+    std::vector<Operand> Params;
+    std::vector<Operand> Results;
     uint32_t Label;
     uint32_t StackSize;
 
@@ -280,15 +293,16 @@ public:
     // Save parameters in reg to stack
     saveParamReg(Type->NumParams);
 
+    if (Ctx->Mod->isFunctionProfilingEnabled()) {
+      self().addFunctionCounter(
+          getFunctionCounterOffset(offsetof(FunctionCounters, Calls)),
+          Operand(WASMType::I64, 1));
+    }
+
     ZEN_ASSERT(Stack.size() == 0);
 
-    WASMType RetType = Type->getReturnType();
-    // Use stack operand instead of register operand, as return values of
-    // function/block have relatively long lifetime and may hold registers
-    // for too long.
-    auto Res =
-        (RetType == WASMType::VOID) ? Operand() : getTempStackOperand(RetType);
-    Stack.emplace_back(CtrlBlockKind::FUNC_ENTRY, Res, createLabel(), 0);
+    Stack.emplace_back(CtrlBlockKind::FUNC_ENTRY, std::vector<Operand>(),
+                       getBlockResults(*Type), createLabel(), 0);
   }
 
   // finalize after handle the function
@@ -329,11 +343,8 @@ public:
       mov<I64>(ABI.template getParamRegNum<I64, 0>(), ABI.getModuleInst());
       self().callAbsolute(uintptr_t(Instance::throwInstanceExceptionOnJIT));
 #else
-      if (Layout.getNumReturns() > 0) {
-        self().emitEpilog(getReturnRegOperand(Layout.getReturnType(0)));
-      } else {
-        self().emitEpilog(Operand());
-      }
+      // the results are ignored on an exception
+      self().emitEpilog(std::vector<Operand>());
 #endif // ZEN_ENABLE_CPU_EXCEPTION
     }
 
@@ -387,30 +398,93 @@ public:
     return Stack.back();
   }
 
+  // Use stack operand instead of register operand, as return values of
+  // function/block have relatively long lifetime and may hold registers
+  // for too long.
+  std::vector<Operand> getBlockResults(const TypeEntry &Type) {
+    std::vector<Operand> Results;
+    Results.reserve(Type.NumReturns);
+    const WASMType *ReturnTypes = Type.getReturnTypes();
+    for (uint32_t I = 0; I < Type.NumReturns; ++I) {
+      Results.push_back(getTempStackOperand(ReturnTypes[I]));
+    }
+    return Results;
+  }
+
+  // copy the params of a block to stack slots above its results, since
+  // releasing a temp stack operand releases all above it. The slots are
+  // pushed without the temp flag and released with the results. When
+  // \p KeepUnreleased, the params which aren't on the temp stack are kept
+  std::vector<Operand> copyBlockParams(const std::vector<Operand> &Params,
+                                       bool KeepUnreleased) {
+    std::vector<Operand> Slots;
+    Slots.reserve(Params.size());
+    for (const Operand &Param : Params) {
+      if (KeepUnreleased && !Param.isTempMem()) {
+        Slots.push_back(Param);
+        continue;
+      }
+      WASMType Type = Param.getType();
+      Operand Slot = getTempStackOperand(Type);
+      makeAssignment<ScopedTempReg0>(Type, Slot, Param);
+      Slots.emplace_back(Type, Slot.getBase(), Slot.getOffset(),
+                         Operand::FLAG_NONE);
+      // a param on the temp stack is below the results and stays allocated
+      if (Param.isTempReg()) {
+        releaseOperand(Param);
+      }
+    }
+    return Slots;
+  }
+
   // ==================== Control Instruction Handlers ====================
 
   void handleUnreachable() { self().handleUnreachableImpl(); }
 
-  void handleBlock(WASMType Type, uint32_t Estack) {
+  void handleBlock(const TypeEntry &Type, const std::vector<Operand> &Params,
+                   uint32_t Estack) {
     uint32_t Label = createLabel();
-    auto Res = (Type == WASMType::VOID) ? Operand() : getTempStackOperand(Type);
-    Stack.push_back(BlockInfo(CtrlBlockKind::BLOCK, Res, Label, Estack));
+    auto Results = getBlockResults(Type);
+    // the params are only read in the block
+    Stack.push_back(BlockInfo(CtrlBlockKind::BLOCK,
+                              copyBlockParams(Params, true), std::move(Results),
+                              Label, Estack));
   }
 
-  void handleLoop(WASMType Type, uint32_t Estack) {
+  void handleLoop(const TypeEntry &Type, const std::vector<Operand> &Params,
+                  uint32_t Estack) {
     uint32_t Label = createLabel();
-    auto Res = (Type == WASMType::VOID) ? Operand() : getTempStackOperand(Type);
-    Stack.push_back(BlockInfo(CtrlBlockKind::LOOP, Res, Label, Estack));
+    auto Results = getBlockResults(Type);
+    Stack.push_back(BlockInfo(CtrlBlockKind::LOOP,
+                              copyBlockParams(Params, false),
+                              std::move(Results), Label, Estack));
     bindLabel(Label);
+    // the back edges branch to the label too
+    if (Ctx->Mod->isFunctionProfilingEnabled()) {
+      self().addFunctionCounter(
+          getFunctionCounterOffset(offsetof(FunctionCounters, LoopIterations)),
+          Operand(WASMType::I64, 1));
+    }
   }
 
-  void handleIf(Operand Op, WASMType Type, uint32_t Estack) {
+  // the condition is released here, with params only after they are copied
+  // as their slots may reuse its space
+  void handleIf(Operand Op, const TypeEntry &Type,
+                const std::vector<Operand> &Params, uint32_t Estack) {
     uint32_t Label = createLabel();
     uint32_t ElseLabel = createLabel();
     ZEN_ASSERT(ElseLabel == Label + 1);
-    auto Res = (Type == WASMType::VOID) ? Operand() : getTempStackOperand(Type);
-    Stack.push_back(BlockInfo(CtrlBlockKind::IF, Res, Label, Estack));
+    if (Params.empty()) {
+      releaseOperand(Op);
+    }
+    auto Results = getBlockResults(Type);
+    // the else block reads the params again
+    Stack.push_back(BlockInfo(CtrlBlockKind::IF, copyBlockParams(Params, false),
+                              std::move(Results), Label, Estack));
     self().branchFalse(Op, ElseLabel);
+    if (!Params.empty() && Op.isTempReg()) {
+      releaseOperand(Op);
+    }
   }
 
   // else block in if-block
@@ -461,7 +535,7 @@ public:
     self().branchTrue(Op, Info.getLabel());
   }
 
-  void handleBranchTable(Operand Index, Operand StackTop,
+  void handleBranchTable(Operand Index, const std::vector<Operand> &StackTops,
                          const std::vector<uint32_t> &Levels) {
     std::vector<uint32_t> Labels;
     Labels.reserve(Levels.size());
@@ -474,30 +548,50 @@ public:
     for (size_t I = 0; I < Levels.size(); ++I) {
       bindLabel(Labels[I]);
       const auto &Info = Stack.at(Stack.size() - Levels[I] - 1);
-      if (Info.getType() != WASMType::VOID &&
-          Info.getKind() != CtrlBlockKind::LOOP) {
-        makeAssignment<ScopedTempReg0>(Info.getType(), Info.getResult(),
-                                       StackTop);
+      const auto &Targets = (Info.getKind() == CtrlBlockKind::LOOP)
+                                ? Info.getParams()
+                                : Info.getResults();
+      ZEN_ASSERT(Targets.size() == StackTops.size());
+      for (size_t J = 0; J < Targets.size(); ++J) {
+        makeAssignment<ScopedTempReg0>(Targets[J].getType(), Targets[J],
+                                       StackTops[J]);
       }
       self().branch(Info.getLabel());
     }
   }
 
-  void handleReturn(Operand Opnd) { self().handleReturnImpl(Opnd); }
+  void handleReturn(const std::vector<Operand> &Results) {
+    self().handleReturnImpl(Results);
+  }
 
-  Operand handleCall(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
-                     bool FarCall, const ArgumentInfo &ArgInfo,
-                     const std::vector<Operand> &Arg) {
+  std::vector<Operand> handleCall(uint32_t FuncIdx, uintptr_t Target,
+                                  bool IsImport, bool FarCall,
+                                  const ArgumentInfo &ArgInfo,
+                                  const std::vector<Operand> &Arg) {
     return self().handleCallImpl(FuncIdx, Target, IsImport, FarCall, ArgInfo,
                                  Arg);
   }
 
-  Operand handleCallIndirect(uint32_t TypeIdx, Operand Callee, uint32_t TblIdx,
-                             const ArgumentInfo &ArgInfo,
-                             const std::vector<Operand> &Arg) {
+  std::vector<Operand> handleCallIndirect(uint32_t TypeIdx, Operand Callee,
+                                          uint32_t TblIdx,
+                                          const ArgumentInfo &ArgInfo,
+                                          const std::vector<Operand> &Arg) {
     return self().handleCallIndirectImpl(TypeIdx, Callee, TblIdx, ArgInfo, Arg);
   }
 
+  void handleReturnCall(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
+                        bool FarCall, const ArgumentInfo &ArgInfo,
+                        const std::vector<Operand> &Arg) {
+    self().handleReturnCallImpl(FuncIdx, Target, IsImport, FarCall, ArgInfo,
+                                Arg);
+  }
+
+  void handleReturnCallIndirect(uint32_t TypeIdx, Operand Callee,
+                                uint32_t TblIdx, const ArgumentInfo &ArgInfo,
+                                const std::vector<Operand> &Arg) {
+    self().handleReturnCallIndirectImpl(TypeIdx, Callee, TblIdx, ArgInfo, Arg);
+  }
+
   // ==================== Parametric Instruction Handlers ====================
 
   Operand handleSelect(Operand Cond, Operand LHS, Operand RHS) {
@@ -541,6 +635,15 @@ public:
                                                                    Align);
   }
 
+  // Load from memory at the address held by a local
+  template <WASMType DestType, WASMType SrcType, bool Sext>
+  Operand handleFusedGetLocalLoad(uint32_t LocalIdx, uint32_t Offset,
+                                  uint32_t Align) {
+    return self().template handleFusedGetLocalLoadImpl<DestType, SrcType,
+                                                       Sext>(LocalIdx, Offset,
+                                                             Align);
+  }
+
   // Store to memory in DestType
   template <WASMType DestType>
   void handleStore(Operand Value, Operand Base, uint32_t Offset,
@@ -554,6 +657,123 @@ public:
     return self().handleMemoryGrowImpl(Op);
   }
 
+  void handleMemoryInit(uint32_t DataIdx, Operand Dst, Operand Src,
+                        Operand Len) {
+    self().handleMemoryInitImpl(DataIdx, Dst, Src, Len);
+  }
+
+  void handleDataDrop(uint32_t DataIdx) { self().handleDataDropImpl(DataIdx); }
+
+  // small constant sizes become a single load and store, the rest call the
+  // runtime
+  void handleMemoryCopy(Operand Dst, Operand Src, Operand Len) {
+    if (Len.isImm()) {
+      switch (uint32_t(Len.getImm())) {
+      case 1:
+        return inlineMemoryCopy<WASMType::I32, WASMType::I8>(Dst, Src);
+      case 2:
+        return inlineMemoryCopy<WASMType::I32, WASMType::I16>(Dst, Src);
+      case 4:
+        return inlineMemoryCopy<WASMType::I32, WASMType::I32>(Dst, Src);
+      case 8:
+        return inlineMemoryCopy<WASMType::I64, WASMType::I64>(Dst, Src);
+      default:
+        break;
+      }
+    }
+    self().handleMemoryCopyImpl(Dst, Src, Len);
+  }
+
+  void handleMemoryFill(Operand Dst, Operand Val, Operand Len) {
+    if (Len.isImm() && Val.isImm()) {
+      uint64_t Pattern = uint8_t(Val.getImm()) * 0x0101010101010101ULL;
+      switch (uint32_t(Len.getImm())) {
+      case 1:
+        return inlineMemoryFill<WASMType::I32, WASMType::I8>(Dst, Pattern);
+      case 2:
+        return inlineMemoryFill<WASMType::I32, WASMType::I16>(Dst, Pattern);
+      case 4:
+        return inlineMemoryFill<WASMType::I32, WASMType::I32>(Dst, Pattern);
+      case 8:
+        return inlineMemoryFill<WASMType::I64, WASMType::I64>(Dst, Pattern);
+      default:
+        break;
+      }
+    }
+    self().handleMemoryFillImpl(Dst, Val, Len);
+  }
+
+  // hostapi intrinsics returning \p Dst, which the caller keeps allocated
+  // until the result is released
+
+  Operand handleMemcpyIntrinsic(Operand Dst, Operand Src, Operand Len) {
+    handleMemoryCopy(Dst, Src, Len);
+    return Dst;
+  }
+
+  Operand handleMemsetIntrinsic(Operand Dst, Operand Val, Operand Len) {
+    handleMemoryFill(Dst, Val, Len);
+    return Dst;
+  }
+
+  // env.memcmp of a constant size up to 8 bytes is compared inline
+  bool canInlineMemcmpIntrinsic(Operand Len) const {
+    if (!Len.isImm()) {
+      return false;
+    }
+    uint32_t Size = uint32_t(Len.getImm());
+    return Size == 1 || Size == 2 || Size == 4 || Size == 8;
+  }
+
+  Operand handleMemcmpIntrinsic(Operand LHS, Operand RHS, Operand Len) {
+    ZEN_ASSERT(canInlineMemcmpIntrinsic(Len));
+    switch (uint32_t(Len.getImm())) {
+    case 1:
+      return inlineMemoryCompare<WASMType::I32, WASMType::I8>(LHS, RHS);
+    case 2:
+      return inlineMemoryCompare<WASMType::I32, WASMType::I16>(LHS, RHS);
+    case 4:
+      return inlineMemoryCompare<WASMType::I32, WASMType::I32>(LHS, RHS);
+    default:
+      return inlineMemoryCompare<WASMType::I64, WASMType::I64>(LHS, RHS);
+    }
+  }
+
+  // env.strlen needs a loop outside of the wasm control flow, it is left to
+  // the runtime
+  bool canInlineStrlenIntrinsic() const { return false; }
+
+  Operand handleStrlenIntrinsic(Operand Str) { ZEN_UNREACHABLE(); }
+
+  // the u256 intrinsics call the runtime
+  bool canInlineU256Intrinsic() const { return false; }
+
+  Operand handleU256Intrinsic(runtime::HostapiIntrinsic Intrinsic, Operand Dst,
+                              Operand LHS, Operand RHS) {
+    ZEN_UNREACHABLE();
+  }
+
+  // ==================== SIMD Instruction Handlers ====================
+
+  // simd modules are rejected up front by JITCompiler::compile
+
+  Operand handleSIMDLoad(Operand Base, uint32_t Offset, uint32_t Align) {
+    ZEN_UNREACHABLE();
+  }
+
+  void handleSIMDStore(Operand Value, Operand Base, uint32_t Offset,
+                       uint32_t Align) {
+    ZEN_UNREACHABLE();
+  }
+
+  Operand handleSIMDConst(const uint8_t *Bytes) { ZEN_UNREACHABLE(); }
+
+  Operand handleSIMDOp(uint32_t SubOpcode, WASMType ResultType,
+                       const std::vector<Operand> &Operands, uint8_t LaneIdx,
+                       const uint8_t *Imm) {
+    ZEN_UNREACHABLE();
+  }
+
   // ==================== Numeric Instruction Handlers ====================
 
   template <WASMType Ty>
@@ -568,13 +788,15 @@ public:
   }
 
   template <WASMType CondType, CompareOperator Opr>
-  void handleFusedCompareIfa(Operand LHS, Operand RHS, WASMType Type,
+  void handleFusedCompareIfa(Operand LHS, Operand RHS, const TypeEntry &Type,
                              uint32_t Estack) {
+    // the if blocks with params aren't fused
+    ZEN_ASSERT(Type.NumParams == 0);
     uint32_t Label = createLabel();
     uint32_t ElseLabel = createLabel();
     ZEN_ASSERT(ElseLabel == Label + 1);
-    auto Res = (Type == WASMType::VOID) ? Operand() : getTempStackOperand(Type);
-    Stack.push_back(BlockInfo(CtrlBlockKind::IF, Res, Label, Estack));
+    Stack.push_back(BlockInfo(CtrlBlockKind::IF, std::vector<Operand>(),
+                              getBlockResults(Type), Label, Estack));
     self().template handleFusedCompareBranchImpl<CondType, Opr, false>(
         LHS, RHS, ElseLabel);
   }
@@ -676,6 +898,10 @@ public:
   void handleGasCall(Operand Delta) {
     self().subGasVal(Delta);
     self().branchLTU(getExceptLabel(ErrorCode::GasLimitExceeded).id());
+    if (Ctx->Mod->isFunctionProfilingEnabled()) {
+      self().addFunctionCounter(
+          getFunctionCounterOffset(offsetof(FunctionCounters, SelfGas)), Delta);
+    }
   }
 
   template <bool Sign, WASMType Type, BinaryOperator Opr>
@@ -690,6 +916,83 @@ public:
   }
 
 protected:
+  // the runtime charges the size based gas of out-of-line bulk memory
+  // operations itself
+  void chargeBulkMemoryGas(uint32_t Len) {
+    if (Ctx->Mod->getGasFuncIdx() != -1u) {
+      handleGasCall(
+          Operand(WASMType::I64, int32_t(common::getBulkMemoryGas(Len))));
+    }
+  }
+
+  // the load traps before anything is stored, like the runtime routine
+  template <WASMType ValType, WASMType MemType>
+  void inlineMemoryCopy(Operand Dst, Operand Src) {
+    constexpr uint32_t Size = getWASMTypeSize<MemType>();
+    chargeBulkMemoryGas(Size);
+    Operand Val = handleLoad<ValType, MemType, false>(Src, 0, 0);
+    handleStore<MemType>(Val, Dst, 0, 0);
+    releaseOperand(Val);
+  }
+
+  template <WASMType ValType, WASMType MemType>
+  void inlineMemoryFill(Operand Dst, uint64_t Pattern) {
+    constexpr uint32_t Size = getWASMTypeSize<MemType>();
+    chargeBulkMemoryGas(Size);
+    Operand Val =
+        handleConst<ValType>(typename WASMTypeAttr<ValType>::Type(Pattern));
+    handleStore<MemType>(Val, Dst, 0, 0);
+    releaseOperand(Val);
+  }
+
+  // the lowest set bit of X ^ Y is in the first unequal byte, which is the
+  // lowest one as wasm is little endian. when X == Y the shift by the width
+  // is a shift by 0 and both bytes are equal
+  template <WASMType ValType, WASMType MemType>
+  Operand inlineMemoryCompare(Operand LHS, Operand RHS) {
+    constexpr uint32_t Size = getWASMTypeSize<MemType>();
+    using ValueType = typename WASMTypeAttr<ValType>::Type;
+    chargeBulkMemoryGas(Size);
+    Operand X = handleLoad<ValType, MemType, false>(LHS, 0, 0);
+    Operand Y = handleLoad<ValType, MemType, false>(RHS, 0, 0);
+    Operand Diff = handleBinaryOp<ValType, BinaryOperator::BO_XOR>(X, Y);
+    releaseOperand(Diff);
+    Operand Tz = handleBitCountOp<ValType, UnaryOperator::UO_CTZ>(Diff);
+    releaseOperand(Tz);
+    Operand Shift = handleBinaryOp<ValType, BinaryOperator::BO_AND>(
+        Tz, handleConst<ValType>(ValueType(~7)));
+    Operand XByte = extractMemoryCompareByte<ValType>(X, Shift);
+    Operand YByte = extractMemoryCompareByte<ValType>(Y, Shift);
+    releaseOperand(Shift);
+    releaseOperand(XByte);
+    releaseOperand(YByte);
+    Operand Result =
+        handleBinaryOp<ValType, BinaryOperator::BO_SUB>(XByte, YByte);
+    if constexpr (ValType == WASMType::I64) {
+      releaseOperand(Result);
+      return handleIntTrunc(Result);
+    }
+    return Result;
+  }
+
+  // \p Val is released
+  template <WASMType ValType>
+  Operand extractMemoryCompareByte(Operand Val, Operand Shift) {
+    using ValueType = typename WASMTypeAttr<ValType>::Type;
+    releaseOperand(Val);
+    Operand Shifted =
+        handleShift<ValType, BinaryOperator::BO_SHR_U>(Val, Shift);
+    releaseOperand(Shifted);
+    return handleBinaryOp<ValType, BinaryOperator::BO_AND>(
+        Shifted, handleConst<ValType>(ValueType(0xff)));
+  }
+
+  // offset from the instance of a counter of the current function
+  uint32_t getFunctionCounterOffset(size_t FieldOffset) const {
+    return Ctx->Mod->getLayout().FunctionCountersBaseOffset +
+           Ctx->InternalFuncIdx * sizeof(FunctionCounters) + FieldOffset;
+  }
+
   // ==================== Move Methods ====================
 
   template <DataType Type, uint32_t TempRegIndex>
@@ -814,20 +1117,68 @@ protected:
     return getTempStackOperand(Type, getWASMTypeSize(Type));
   }
 
-  // Get return register operand
-  Operand getReturnRegOperand(WASMType Type) {
+  // Get return register operand, \p Index among the return registers of its
+  // kind, see JITReturnAllocator
+  Operand getReturnRegOperand(WASMType Type, uint32_t Index = 0) {
     RegNum Reg;
     if (Type == WASMType::I32 || Type == WASMType::I64) {
-      Reg = ABI.template getRetRegNum<I64>();
+      Reg = ABI.template getRetRegNum<I64>(Index);
     } else if (Type == WASMType::F32 || Type == WASMType::F64 ||
                Type == WASMType::V128) {
-      Reg = ABI.template getRetRegNum<F64>();
+      Reg = ABI.template getRetRegNum<F64>(Index);
     } else {
       ZEN_ABORT();
     }
     return Operand(Type, Reg, Operand::FLAG_NONE);
   }
 
+  // Get the operand of a result in the results buffer of the instance
+  Operand getReturnBufferOperand(WASMType Type, uint32_t Offset) {
+    Offset += Ctx->Mod->getLayout().ResultsBufferBaseOffset;
+    return Operand(Type, ABI.getModuleInst(), Offset, Operand::FLAG_NONE);
+  }
+
+  // move the results of the function to where JITReturnAllocator places
+  // them, the buffer ones first as their copies may use the scoped temps,
+  // which are the return registers
+  void moveReturnValues(const std::vector<Operand> &Results) {
+    const TypeEntry *Type = Ctx->FuncType;
+    ZEN_ASSERT(Results.size() == Type->NumReturns);
+    std::vector<JITReturnLocation> Locs = JITReturnAllocator::allocate(
+        Type->getReturnTypes(), Type->NumReturns);
+    for (uint32_t I = 0; I < Results.size(); ++I) {
+      WASMType ResultType = Results[I].getType();
+      if (!Locs[I].InReg) {
+        makeAssignment<ScopedTempReg0>(
+            ResultType, getReturnBufferOperand(ResultType, Locs[I].Index),
+            Results[I]);
+      }
+    }
+    for (uint32_t I = 0; I < Results.size(); ++I) {
+      WASMType ResultType = Results[I].getType();
+      if (Locs[I].InReg) {
+        makeAssignment<ScopedTempReg0>(
+            ResultType, getReturnRegOperand(ResultType, Locs[I].Index),
+            Results[I]);
+      }
+    }
+  }
+
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  // attribute the code emitted from now on to the instruction at
+  // BytecodeOffset of the function body
+  void handleInstructionStart(uint32_t BytecodeOffset) {
+    auto &Map = Ctx->Mod->getJITOffsetMap(Ctx->InternalFuncIdx);
+    uint32_t CodeOffset = _ offset();
+    if (!Map.empty() && Map.back().first == CodeOffset) {
+      // the previous instruction emitted no code
+      Map.back().second = BytecodeOffset;
+    } else {
+      Map.emplace_back(CodeOffset, BytecodeOffset);
+    }
+  }
+#endif // ZEN_ENABLE_JIT_PROFILER
+
   // ==================== Label Methods ====================
 
   // Bind label to current pc
@@ -857,9 +1208,10 @@ protected:
 
   template <typename PrepareCallFn, typename GenerateCallFn,
             typename PostCallFn>
-  Operand emitCall(const ArgumentInfo &ArgInfo, const std::vector<Operand> &Arg,
-                   PrepareCallFn PreCall, GenerateCallFn GenCall,
-                   PostCallFn PostCall) {
+  std::vector<Operand> emitCall(const ArgumentInfo &ArgInfo,
+                                const std::vector<Operand> &Arg,
+                                PrepareCallFn PreCall, GenerateCallFn GenCall,
+                                PostCallFn PostCall) {
     constexpr uint32_t GpRegNum = OnePassABI::template getNumTempRegs<I64>();
     constexpr uint32_t FpRegNum = OnePassABI::template getNumTempRegs<F64>();
     // save temp gp register
@@ -945,12 +1297,30 @@ protected:
     // generare call
     GenCall();
 
-    // copy return value if exist
-    Operand RetVal;
-    WASMType Type = ArgInfo.getReturnType();
-    if (Type != WASMType::VOID) {
-      RetVal = getTempOperand(Type);
-      makeAssignment<ScopedTempReg1>(Type, RetVal, getReturnRegOperand(Type));
+    // copy return values if exist, in order of the temp stack, the ones in
+    // registers first as the copies from the results buffer may use the
+    // scoped temps
+    const WASMType *ReturnTypes = ArgInfo.getReturnTypes();
+    std::vector<Operand> RetVals;
+    RetVals.reserve(ArgInfo.getNumReturns());
+    for (uint32_t I = 0; I < ArgInfo.getNumReturns(); ++I) {
+      RetVals.push_back(getTempOperand(ReturnTypes[I]));
+    }
+    std::vector<JITReturnLocation> Locs =
+        JITReturnAllocator::allocate(ReturnTypes, ArgInfo.getNumReturns());
+    for (uint32_t I = 0; I < RetVals.size(); ++I) {
+      if (Locs[I].InReg) {
+        makeAssignment<ScopedTempReg1>(
+            ReturnTypes[I], RetVals[I],
+            getReturnRegOperand(ReturnTypes[I], Locs[I].Index));
+      }
+    }
+    for (uint32_t I = 0; I < RetVals.size(); ++I) {
+      if (!Locs[I].InReg) {
+        makeAssignment<ScopedTempReg0>(
+            ReturnTypes[I], RetVals[I],
+            getReturnBufferOperand(ReturnTypes[I], Locs[I].Index));
+      }
     }
 
     // restore temporary gp from stack
@@ -975,7 +1345,7 @@ protected:
 
     PostCall();
 
-    return RetVal;
+    return RetVals;
   }
 
   // Use vector because branch may refer random parent block
@@ -44,6 +44,12 @@ public:
     Ctx = nullptr;
   }
 
+  // patch calls in a copy of the finalized module code which is CodeDelta
+  // bytes away from the primary code
+  void finalizeModuleCopy(intptr_t CodeDelta) {
+    Patcher.finalizeModule(CodeDelta);
+  }
+
   bool compile(asmjit::CodeHolder *Code) {
     ZEN_ASSERT(Code != nullptr);
     CodeGenImpl CodeGen(Layout, Patcher, Code, Ctx);
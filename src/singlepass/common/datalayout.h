@@ -13,6 +13,7 @@
 // ============================================================================
 
 #include "singlepass/common/definitions.h"
+#include "utils/wasm.h"
 #include <vector>
 
 // ============================================================================
@@ -178,7 +179,7 @@ public:
 
   WASMType getReturnType(uint32_t Index) {
     ZEN_ASSERT(Index < getNumReturns());
-    return static_cast<WASMType>(Ctx->FuncType->ReturnTypes[Index]);
+    return static_cast<WASMType>(Ctx->FuncType->getReturnTypes()[Index]);
   }
 
   uint32_t getIntPresSavedCount() const {
@@ -197,6 +198,131 @@ public:
     ZEN_ASSERT(Locals[LocalIdx].inReg());
     Locals[LocalIdx].setClearReg();
   }
+
+protected:
+  // loops nested deeper than this weigh the same
+  constexpr static uint32_t MaxWeightedLoopDepth = 6;
+
+  // pre-scan the current function, weight every local use and every call by
+  // 8 to the power of its loop depth. return false if the scan meets an
+  // opcode it doesn't know or a local index out of range
+  bool scanLocalUses(std::vector<uint64_t> &Weights,
+                     uint64_t &CallWeight) const {
+    using namespace common;
+    const uint8_t *Ip = Ctx->Func->CodePtr;
+    const uint8_t *End = Ip + Ctx->Func->CodeSize;
+    Weights.assign(Locals.size(), 0);
+    CallWeight = 0;
+    // whether each enclosing block is a loop, innermost last
+    std::vector<bool> LoopStack;
+    uint32_t LoopDepth = 0;
+    uint32_t LocalIdx = 0;
+    while (Ip < End) {
+      uint64_t Weight =
+          1ULL << (3 * std::min(LoopDepth, MaxWeightedLoopDepth));
+      uint8_t Opcode = *Ip++;
+      switch (Opcode) {
+      case UNREACHABLE:
+      case NOP:
+      case ELSE:
+      case RETURN:
+      case DROP:
+      case SELECT:
+        break;
+
+      case BLOCK:
+      case LOOP:
+      case IF:
+        LoopStack.push_back(Opcode == LOOP);
+        LoopDepth += (Opcode == LOOP);
+        Ip = utils::skipBlockType(Ip, End);
+        break;
+
+      case END:
+        // the last end closes the function
+        if (!LoopStack.empty()) {
+          LoopDepth -= LoopStack.back();
+          LoopStack.pop_back();
+        }
+        break;
+
+      case BR:
+      case BR_IF:
+      case GET_GLOBAL:
+      case SET_GLOBAL:
+      case GET_GLOBAL_64:
+      case SET_GLOBAL_64:
+      case MEMORY_SIZE:
+      case MEMORY_GROW:
+      case I32_CONST:
+        Ip = utils::skipLEBNumber<uint32_t>(Ip, End);
+        break;
+
+      case BR_TABLE: {
+        uint32_t NumTargets;
+        Ip = utils::readSafeLEBNumber(Ip, NumTargets);
+        for (uint32_t I = 0; I <= NumTargets; ++I) {
+          Ip = utils::skipLEBNumber<uint32_t>(Ip, End);
+        }
+        break;
+      }
+
+      case CALL:
+      case RETURN_CALL:
+        Ip = utils::skipLEBNumber<uint32_t>(Ip, End); // skip func_idx
+        CallWeight += Weight;
+        break;
+
+      case CALL_INDIRECT:
+      case RETURN_CALL_INDIRECT:
+        Ip = utils::skipLEBNumber<uint32_t>(Ip, End); // skip type_idx
+        ++Ip;                                         // skip tbl_idx
+        CallWeight += Weight;
+        break;
+
+      case FC_PREFIX: {
+        // bulk memory instructions may call out to the runtime
+        uint32_t SubOpcode;
+        Ip = utils::readSafeLEBNumber(Ip, SubOpcode);
+        Ip = utils::skipFCImmediates(SubOpcode, Ip, End);
+        CallWeight += Weight;
+        break;
+      }
+
+      case GET_LOCAL:
+      case SET_LOCAL:
+      case TEE_LOCAL:
+        Ip = utils::readSafeLEBNumber(Ip, LocalIdx);
+        if (LocalIdx >= Weights.size()) {
+          return false;
+        }
+        Weights[LocalIdx] += Weight;
+        break;
+
+      case I64_CONST:
+        Ip = utils::skipLEBNumber<uint64_t>(Ip, End);
+        break;
+
+      case F32_CONST:
+        Ip += sizeof(float);
+        break;
+
+      case F64_CONST:
+        Ip += sizeof(double);
+        break;
+
+      default:
+        if (Opcode >= I32_LOAD && Opcode <= I64_STORE32) {
+          Ip = utils::skipLEBNumber<uint32_t>(Ip, End); // align
+          Ip = utils::skipLEBNumber<uint32_t>(Ip, End); // offset
+        } else if (Opcode < I32_EQZ || Opcode > SELECT_64) {
+          // the rest have no immediates
+          return false;
+        }
+      }
+    }
+    return true;
+  }
 };
 
 } // namespace zen::singlepass
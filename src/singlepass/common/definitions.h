@@ -33,6 +33,7 @@ using common::WASMType;
 using common::WASMTypeAttr;
 using common::WASMTypeKind;
 using runtime::CodeEntry;
+using runtime::FunctionCounters;
 using runtime::Instance;
 using runtime::MemoryInstance;
 using runtime::Module;
@@ -42,6 +43,9 @@ using runtime::TypeEntry;
 struct JITCompilerContext {
   Module *Mod = nullptr;
   bool UseSoftMemCheck = true;
+  bool UseFixedMemBase = false;
+  // see RuntimeConfig::EnableSinglepassLocalCaching, x64 only
+  bool CacheLocalsInRegs = false;
   CodeEntry *Func = nullptr;
   TypeEntry *FuncType = nullptr;
   uint32_t InternalFuncIdx = -1; // exclude imported functions
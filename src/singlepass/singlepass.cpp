@@ -5,9 +5,11 @@
 
 #include "common/errors.h"
 #include "platform/map.h"
+#include "platform/numa.h"
 #include "runtime/memory.h"
 #include "runtime/module.h"
 #include "singlepass/common/compiler.h"
+#include "utils/metrics.h"
 #include "utils/statistics.h"
 
 #ifdef ZEN_BUILD_TARGET_X86_64
@@ -27,9 +29,78 @@ namespace zen::singlepass {
 using namespace common;
 using namespace runtime;
 
+// Jump tables hold absolute addresses, so each copy is relocated from the code
+// holders instead of being copied from the primary code
+template <typename CompilerType>
+static void replicateToNumaNodes(Module *Mod, CompilerType &Compiler,
+                                 std::vector<asmjit::CodeHolder> &CodeHolders,
+                                 void *JITCode, size_t CodeSize) {
+  const platform::NumaTopology &Topology = platform::getNumaTopology();
+  uint32_t LocalNode = platform::getCurrentNumaNode();
+  for (uint32_t Node = 0; Node < Topology.getNumNodes(); ++Node) {
+    if (Node == LocalNode) {
+      Mod->setNodeJITCode(Node, JITCode);
+      continue;
+    }
+    // memory-only nodes never run instances
+    if (!Topology.IsFake && Topology.NodeCPUs[Node].empty()) {
+      continue;
+    }
+    auto &NodeCodeMemPool = Mod->getNodeJITCodeMemPool(Node);
+    auto *NodeJITCode =
+        static_cast<uint8_t *>(NodeCodeMemPool.allocate(CodeSize));
+    if (!NodeJITCode) {
+      throw getErrorWithPhase(ErrorCode::MmapFailed, ErrorPhase::Compilation);
+    }
+    // bind before the first touch of the pages
+    platform::bindMemoryToNumaNode(NodeJITCode, CodeSize, Node);
+
+    size_t CodeOffset = 0;
+    for (auto &Holder : CodeHolders) {
+      uint8_t *FuncJITCode = NodeJITCode + CodeOffset;
+      CodeOffset += Holder.codeSize();
+      Holder.relocateToBase(reinterpret_cast<uint64_t>(FuncJITCode));
+      Holder.copyFlattenedData(FuncJITCode, Holder.codeSize(),
+                               asmjit::CopySectionFlags::kPadSectionBuffer);
+    }
+    Compiler.finalizeModuleCopy(reinterpret_cast<intptr_t>(NodeJITCode) -
+                                reinterpret_cast<intptr_t>(JITCode));
+
+    platform::mprotect(NodeJITCode, CodeSize, PROT_READ | PROT_EXEC);
+    Mod->setNodeJITCode(Node, NodeJITCode);
+  }
+}
+
+bool JITCompiler::canCompileTailCalls(const Module &Mod) {
+#ifdef ZEN_BUILD_TARGET_X86_64
+  using ArgumentInfo = X64ArgumentInfo;
+#elif defined(ZEN_BUILD_TARGET_AARCH64)
+  using ArgumentInfo = A64ArgumentInfo;
+#endif
+  const Module::TailCallInfo &TailCalls = Mod.getTailCalls();
+  // a host function in a table would return past the exception check
+  if (TailCalls.HasIndirect && Mod.hasImportElems()) {
+    return false;
+  }
+  // the stack arguments of a callee are stored over the ones of its caller,
+  // whose caller only reserved those
+  for (const auto &[CallerType, CalleeType] : TailCalls.TypePairs) {
+    if (ArgumentInfo(CalleeType).getArgStackSize() >
+        ArgumentInfo(CallerType).getArgStackSize()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void JITCompiler::compile(Module *Mod) {
+  // the singlepass codegen has no v128 support, such modules are interpreted
+  ZEN_ASSERT(!Mod->usesSIMD());
+
   auto &Stats = Mod->getRuntime()->getStatistics();
   auto Timer = Stats.startRecord(utils::StatisticPhase::JITCompilation);
+  utils::ScopedMetricTimer MetricTimer(
+      utils::MetricLatency::SinglepassCompilation);
 
 #ifdef ZEN_BUILD_TARGET_X86_64
   OnePassCompiler<X86OnePassCompiler> Compiler;
@@ -45,6 +116,9 @@ void JITCompiler::compile(Module *Mod) {
   JITCompilerContext Ctx = {
       .Mod = Mod,
       .UseSoftMemCheck = Mod->checkUseSoftLinearMemoryCheck(),
+      .UseFixedMemBase = Mod->checkUseFixedLinearMemoryBase(),
+      .CacheLocalsInRegs =
+          Mod->getRuntime()->getConfig().EnableSinglepassLocalCaching,
   };
   Compiler.initModule(&Ctx);
 
@@ -129,6 +203,11 @@ void JITCompiler::compile(Module *Mod) {
   platform::mprotect(JITCode, CodeSize, PROT_READ | PROT_EXEC);
   Mod->setJITCodeAndSize(JITCode, CodeSize);
 
+  if (Mod->getRuntime()->getConfig().EnableNUMACodeReplication &&
+      CodeSize > 0) {
+    replicateToNumaNodes(Mod, Compiler, CodeHolders, JITCode, CodeSize);
+  }
+
   Stats.stopRecord(Timer);
 }
 
@@ -19,6 +19,10 @@ class JITCompiler {
 
 public:
   static void compile(runtime::Module *Mod);
+
+  // whether every tail call of the module can be compiled as a jump, the
+  // module runs in interp mode otherwise
+  static bool canCompileTailCalls(const runtime::Module &Mod);
 };
 
 } // namespace zen::singlepass
@@ -41,13 +41,16 @@ public:
   }
 
 public:
-  // return register for integer
-  constexpr static uint32_t NumIntRetRegs = 1;
+  // return registers for integer, the second one only for multi-value
+  constexpr static uint32_t NumIntRetRegs = 2;
   static constexpr X64::GP IntRetReg = X64::RAX;
+  static constexpr X64::GP IntRetReg2 = X64::RDX;
 
-  // return register for floating-point/vector
-  constexpr static uint32_t NumFloatRetRegs = 1;
+  // return registers for floating-point/vector, the second one only for
+  // multi-value
+  constexpr static uint32_t NumFloatRetRegs = 2;
   static constexpr X64::FP FloatRetReg = X64::XMM0;
+  static constexpr X64::FP FloatRetReg2 = X64::XMM1;
 
   // return register count
   template <X64::Type Ty> static constexpr uint32_t getNumRetRegs() {
@@ -63,6 +66,17 @@ public:
                : (typename X64TypeAttr<Ty>::RegNum)FloatRetReg;
   }
 
+  // return register number by index among the return registers of its kind
+  template <X64::Type Ty>
+  static typename X64TypeAttr<Ty>::RegNum getRetRegNum(uint32_t Index) {
+    ZEN_ASSERT(Index < getNumRetRegs<Ty>());
+    if (X64TypeAttr<Ty>::Kind == X64::GPR) {
+      return (typename X64TypeAttr<Ty>::RegNum)(Index ? IntRetReg2 : IntRetReg);
+    }
+    return (typename X64TypeAttr<Ty>::RegNum)(Index ? FloatRetReg2
+                                                   : FloatRetReg);
+  }
+
   // return register object reference represented by asmjit
   template <X64::Type Ty>
   static constexpr typename X64TypeAttr<Ty>::Type &getRetReg() {
@@ -41,7 +41,7 @@ public:
 class X64ArgumentInfo
     : public ArgumentInfo<X64ArgumentInfo, X64ArgumentInfoAttrs> {
 public:
-  X64ArgumentInfo(TypeEntry *Type) : ArgumentInfo(Type) {}
+  X64ArgumentInfo(const TypeEntry *Type) : ArgumentInfo(Type) {}
 
   static constexpr X64::Type getDataTypeFromWASMType(WASMType Type) {
     return getX64TypeFromWASMType(Type);
@@ -160,6 +160,33 @@ private:
     Layout.markAvailRegMask<X64::I64>(IntPresMask);
     ZEN_ASSERT(PresSaveSize == Layout.getIntPresSavedCount() * ABI.GpRegWidth);
 
+    // move parameters pinned to registers there, they are still in their
+    // parameter registers
+    for (uint32_t I = 0; I < Ctx->FuncType->NumParams; ++I) {
+      X64::RegNum Reg;
+      if (!Layout.getPinnedParamReg(I, Reg)) {
+        continue;
+      }
+      auto Param = Layout.getLocal(I);
+      ZEN_ASSERT(Param.isReg());
+      switch (Param.getType()) {
+      case WASMType::I32:
+        mov<X64::I32>(Reg, Param);
+        break;
+      case WASMType::I64:
+        mov<X64::I64>(Reg, Param);
+        break;
+      case WASMType::F32:
+        mov<X64::F32>(Reg, Param);
+        break;
+      case WASMType::F64:
+        mov<X64::F64>(Reg, Param);
+        break;
+      default:
+        ZEN_UNREACHABLE();
+      }
+    }
+
     // initialize all locals to zero
     for (uint32_t I = 0; I < Ctx->Func->NumLocals; ++I) {
       auto Local = Layout.getLocal(I + Ctx->FuncType->NumParams);
@@ -186,9 +213,20 @@ private:
   } // EmitProlog
 
   // epilog
-  void emitEpilog(Operand Op) {
+  void emitEpilog(const std::vector<Operand> &Results) {
     saveGasVal();
 
+    // the results are left on the exception exit
+    if (!Results.empty()) {
+      moveReturnValues(Results);
+    }
+    emitLeaveFrame();
+    _ ret();
+  } // EmitEpilog
+
+  // pop the frame of the current function, the return address is left on the
+  // top of the stack
+  void emitLeaveFrame() {
 #ifdef ZEN_ENABLE_DWASM
     // update stack cost
     auto StackCostAddr = asmjit::x86::ptr(ABI.getModuleInstReg(),
@@ -197,30 +235,6 @@ private:
     _ sub(StackCostAddr, Ctx->Func->JITStackCost);
 #endif
 
-    if (Layout.getNumReturns() > 0) {
-      ZEN_ASSERT(Layout.getNumReturns() == 1);
-      ZEN_ASSERT(Layout.getReturnType(0) == Op.getType());
-      switch (Op.getType()) {
-      case WASMType::I32:
-        mov<X64::I32>(ABI.getRetRegNum<X64::I32>(), Op);
-        break;
-      case WASMType::I64:
-        mov<X64::I64>(ABI.getRetRegNum<X64::I64>(), Op);
-        break;
-      case WASMType::F32:
-        mov<X64::F32>(ABI.getRetRegNum<X64::F32>(), Op);
-        break;
-      case WASMType::F64:
-        mov<X64::F64>(ABI.getRetRegNum<X64::F64>(), Op);
-        break;
-      case WASMType::V128:
-        ZEN_ASSERT(false);
-        // mov<X64::V128>(ABI.getFloatRet(), opnd);
-        break;
-      default:
-        ZEN_ASSERT(false);
-      }
-    }
     for (uint32_t I = 0; I < Layout.getIntPresSavedCount(); ++I) {
       const X64::GP Reg = ABI.getPresRegNum<X64::I64>(I);
       _ mov(X64Reg::getRegRef<X64::I64>(Reg),
@@ -228,8 +242,24 @@ private:
     }
     _ mov(ABI.getStackPointerReg(), ABI.getFrameBaseReg());
     _ pop(ABI.getFrameBaseReg());
-    _ ret();
-  } // EmitEpilog
+  }
+
+  // jump to the function in %rax in place of the current one, which returns
+  // to the caller of the current function. The stack arguments at the top of
+  // the stack move over the ones of the current function through %r11, which
+  // passes no argument
+  void emitTailJump(uint32_t ArgStackSize) {
+    for (uint32_t Offset = 0; Offset < ArgStackSize;
+         Offset += ABI.GpRegWidth) {
+      _ mov(asmjit::x86::r11,
+            asmjit::x86::qword_ptr(ABI.getStackPointerReg(), Offset));
+      _ mov(asmjit::x86::qword_ptr(ABI.getFrameBaseReg(),
+                                   ABI.FormalStackOffset + Offset),
+            asmjit::x86::r11);
+    }
+    emitLeaveFrame();
+    _ jmp(ABI.getCallTargetReg());
+  }
 
   template <uint32_t SizeRegIndex>
   void emitTableSize(uint32_t TblIdx, Operand EntryIdx) {
@@ -335,6 +365,33 @@ public:
 
   void checkCallIndirectException() { checkCallException(true); }
 
+  // signature of memory.copy and memory.fill helpers: (i32, i32, i32) -> void
+  static TypeEntry *getBulkMemorySig() {
+    static TypeEntry SigBuf = {
+        .NumParams = 3,
+        .NumParamCells = 3,
+        .NumReturns = 0,
+        .NumReturnCells = 0,
+        {
+            .ParamTypesVec = {WASMType::I32, WASMType::I32, WASMType::I32},
+        },
+        .SmallestTypeIdx = uint32_t(-1),
+    };
+    return &SigBuf;
+  }
+
+  void emitBulkMemoryCall(TypeEntry *Sig, const std::vector<Operand> &Args,
+                          uintptr_t Target) {
+    X64ArgumentInfo ArgInfo(Sig);
+    emitCall(
+        ArgInfo, Args, [this] { saveGasVal(); },
+        [this, Target] { _ call(Target); },
+        [this] {
+          loadGasVal();
+          checkCallException(true);
+        });
+  }
+
   template <WASMType Type>
   void checkMemoryOverflow(Operand Base, uint32_t Offset) {
     if (Ctx->UseSoftMemCheck) {
@@ -893,6 +950,14 @@ public:
     ASM.mov<Ty>(Mem, Val);
   }
 
+  // the base register is only read, so the local itself addresses the load
+  template <WASMType DestType, WASMType SrcType, bool Sext>
+  Operand handleFusedGetLocalLoadImpl(uint32_t LocalIdx, uint32_t Offset,
+                                      uint32_t Align) {
+    return handleLoadImpl<DestType, SrcType, Sext>(Layout.getLocal(LocalIdx),
+                                                   Offset, Align);
+  }
+
   // load from memory in SrcType and return in DestType
   template <WASMType DestType, WASMType SrcType, bool Sext>
   Operand handleLoadImpl(Operand Base, uint32_t Offset, uint32_t Align) {
@@ -1158,9 +1223,10 @@ public:
 
   // call
 
-  Operand handleCallImpl(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
-                         bool FarCall, const ArgumentInfo &ArgInfo,
-                         const std::vector<Operand> &Args) {
+  std::vector<Operand> handleCallImpl(uint32_t FuncIdx, uintptr_t Target,
+                                      bool IsImport, bool FarCall,
+                                      const ArgumentInfo &ArgInfo,
+                                      const std::vector<Operand> &Args) {
     return emitCall(
         ArgInfo, Args, [this] { saveGasVal(); },
         [&]() {
@@ -1178,11 +1244,7 @@ public:
           if (Target) {
             _ call(Target);
           } else {
-            size_t Offset = _ offset();
-            _ dw(0);
-            _ dd(0); // reserve 6 bytes
-            ZEN_ASSERT(_ offset() - Offset == 6);
-            Patcher.addCallEntry(Offset, _ offset() - Offset, FuncIdx);
+            emitPatchedCall(FuncIdx);
           }
         },
         [this, IsImport]() {
@@ -1201,77 +1263,182 @@ public:
   }
 
   // call indirect
-  Operand handleCallIndirectImpl(uint32_t TypeIdx, Operand Callee,
-                                 uint32_t TblIdx, const ArgumentInfo &ArgInfo,
-                                 const std::vector<Operand> &Arg) {
-    uint32_t NumHostAPIs = Ctx->Mod->getNumImportFunctions();
+  std::vector<Operand>
+  handleCallIndirectImpl(uint32_t TypeIdx, Operand Callee, uint32_t TblIdx,
+                         const ArgumentInfo &ArgInfo,
+                         const std::vector<Operand> &Arg) {
+    const auto *Targets = Ctx->Mod->getIndirectCallTargets(TblIdx, TypeIdx);
+    if (Targets) {
+      return emitCachedCallIndirect(TypeIdx, Callee, TblIdx, *Targets,
+                                    ArgInfo, Arg);
+    }
     return emitCall(
         ArgInfo, Arg,
         // prepare call, check and load callee address into %rax (return
         // reg)
-        [this, NumHostAPIs, TypeIdx, Callee, TblIdx]() {
+        [this, TypeIdx, Callee, TblIdx]() {
           saveGasVal();
-
           auto FuncIdxReg = Layout.getScopedTemp<X64::I32, ScopedTempReg0>();
-
-          auto FuncIdx = X64Reg::getRegRef<X64::I32>(FuncIdxReg);
-
           emitTableGet(TblIdx, Callee, FuncIdxReg);
+          emitIndirectCallTarget(TypeIdx, FuncIdxReg);
+        },
+        // generate call
+        [&]() { _ call(ABI.getCallTargetReg()); },
+        [this]() { postCallIndirect(); });
+  }
 
-          auto InstReg = ABI.getModuleInstReg();
+  // call indirect whose possible targets of the type are all known, compare
+  // the function index with them and call the matching one directly
+  std::vector<Operand>
+  emitCachedCallIndirect(uint32_t TypeIdx, Operand Callee, uint32_t TblIdx,
+                         const std::vector<uint32_t> &Targets,
+                         const ArgumentInfo &ArgInfo,
+                         const std::vector<Operand> &Arg) {
+    return emitCall(
+        ArgInfo, Arg,
+        // prepare call, load the function index into %rax, which isn't used
+        // to pass arguments
+        [this, Callee, TblIdx]() {
+          saveGasVal();
+          emitTableGet(TblIdx, Callee, ABI.getCallTarget());
+        },
+        // generate call
+        [&]() {
+          auto FuncIdx = ABI.getCallTargetReg().r32();
+          uint32_t EndLabel = createLabel();
+          for (uint32_t Target : Targets) {
+            uint32_t NextLabel = createLabel();
+            _ cmp(FuncIdx, Target);
+            jne(NextLabel);
+            emitPatchedCall(Target);
+            branch(EndLabel);
+            bindLabel(NextLabel);
+          }
+          // other functions of the table have other types, but keep the
+          // full check for the exceptions
+          emitIndirectCallTarget(TypeIdx, ABI.getCallTarget());
+          _ call(ABI.getCallTargetReg());
+          bindLabel(EndLabel);
+        },
+        [this]() { postCallIndirect(); });
+  }
 
-          _ cmp(FuncIdx, -1);
-          _ je(getExceptLabel(ErrorCode::UninitializedElement));
+  // check the function at index FuncIdxReg has type TypeIdx and load its
+  // address into %rax
+  void emitIndirectCallTarget(uint32_t TypeIdx, X64::GP FuncIdxReg) {
+    auto FuncIdx = X64Reg::getRegRef<X64::I32>(FuncIdxReg);
+    auto InstReg = ABI.getModuleInstReg();
 
-          constexpr uint32_t Shift0 = 2;
-          auto IndexesBaseOffset =
-              Ctx->Mod->getLayout().FuncTypeIndexesBaseOffset;
-          asmjit::x86::Mem TypeIdxAddr(InstReg, FuncIdx, Shift0,
-                                       IndexesBaseOffset, sizeof(TypeIdx));
+    _ cmp(FuncIdx, -1);
+    _ je(getExceptLabel(ErrorCode::UninitializedElement));
 
-          _ cmp(TypeIdxAddr, TypeIdx);
-          _ jne(getExceptLabel(ErrorCode::IndirectCallTypeMismatch));
+    constexpr uint32_t Shift0 = 2;
+    auto IndexesBaseOffset = Ctx->Mod->getLayout().FuncTypeIndexesBaseOffset;
+    asmjit::x86::Mem TypeIdxAddr(InstReg, FuncIdx, Shift0, IndexesBaseOffset,
+                                 sizeof(TypeIdx));
+
+    _ cmp(TypeIdxAddr, TypeIdx);
+    _ jne(getExceptLabel(ErrorCode::IndirectCallTypeMismatch));
 
 #ifdef ZEN_ENABLE_DWASM
-          // check func_idx < import_funcs_count (is_import)
-          // if is_import, update WasmInstance::is_host_api
-          auto UpdateFlagLabel = createLabel();
-          auto EndUpdateFlagLabel = createLabel();
+    // check func_idx < import_funcs_count (is_import)
+    // if is_import, update WasmInstance::is_host_api
+    uint32_t NumHostAPIs = Ctx->Mod->getNumImportFunctions();
+    auto UpdateFlagLabel = createLabel();
+    auto EndUpdateFlagLabel = createLabel();
 
-          _ cmp(FuncIdx, NumHostAPIs);
-          branchLTU(UpdateFlagLabel);
-          branch(EndUpdateFlagLabel);
+    _ cmp(FuncIdx, NumHostAPIs);
+    branchLTU(UpdateFlagLabel);
+    branch(EndUpdateFlagLabel);
 
-          bindLabel(UpdateFlagLabel);
-          auto InHostAPIFlagAddr = asmjit::x86::ptr(
-              ABI.getModuleInstReg(), InHostApiOffset, InHostApiSize);
-          _ mov(InHostAPIFlagAddr, 1);
+    bindLabel(UpdateFlagLabel);
+    auto InHostAPIFlagAddr = asmjit::x86::ptr(ABI.getModuleInstReg(),
+                                              InHostApiOffset, InHostApiSize);
+    _ mov(InHostAPIFlagAddr, 1);
 
-          bindLabel(EndUpdateFlagLabel);
+    bindLabel(EndUpdateFlagLabel);
 #endif
 
-          auto FuncPtr = ABI.getCallTargetReg();
-          constexpr uint32_t Shift = sizeof(void *) == 4 ? 2 : 3;
-          asmjit::x86::Mem FuncPtrAddr(
-              InstReg, FuncIdx, Shift,
-              Ctx->Mod->getLayout().FuncPtrsBaseOffset);
+    auto FuncPtr = ABI.getCallTargetReg();
+    constexpr uint32_t Shift = sizeof(void *) == 4 ? 2 : 3;
+    asmjit::x86::Mem FuncPtrAddr(InstReg, FuncIdx, Shift,
+                                 Ctx->Mod->getLayout().FuncPtrsBaseOffset);
 
-          _ mov(FuncPtr, FuncPtrAddr);
-        },
-        // generate call
-        [&]() { _ call(ABI.getCallTargetReg()); },
-        [this]() {
-          loadGasVal();
-          checkCallIndirectException();
+    _ mov(FuncPtr, FuncPtrAddr);
+  }
+
+  void postCallIndirect() {
+    loadGasVal();
+    checkCallIndirectException();
 
 #ifdef ZEN_ENABLE_DWASM
-          // because func_idx reg not available in post_call
-          // so just update the flag directly now(have performance cost)
-          auto InHostAPIFlagAddr = asmjit::x86::ptr(
-              ABI.getModuleInstReg(), InHostApiOffset, InHostApiSize);
-          _ mov(InHostAPIFlagAddr, 0); // update flag back
+    // because func_idx reg not available in post_call
+    // so just update the flag directly now(have performance cost)
+    auto InHostAPIFlagAddr = asmjit::x86::ptr(ABI.getModuleInstReg(),
+                                              InHostApiOffset, InHostApiSize);
+    _ mov(InHostAPIFlagAddr, 0); // update flag back
 #endif
-        });
+  }
+
+  // return call, the arguments are placed like a call, then the frame is popped
+  // and the callee is jumped to. Host functions need the exception check
+  // after the call, they are called and their result is returned
+  void handleReturnCallImpl(uint32_t FuncIdx, uintptr_t Target, bool IsImport,
+                            bool FarCall, const ArgumentInfo &ArgInfo,
+                            const std::vector<Operand> &Args) {
+    if (IsImport) {
+      handleReturnImpl(
+          handleCallImpl(FuncIdx, Target, IsImport, FarCall, ArgInfo, Args));
+      return;
+    }
+    std::vector<Operand> Rets = emitCall(
+        ArgInfo, Args, [this] { saveGasVal(); },
+        [this, FuncIdx, &ArgInfo]() {
+          auto FuncPtrAddr = asmjit::x86::qword_ptr(
+              ABI.getModuleInstReg(), Ctx->Mod->getLayout().FuncPtrsBaseOffset +
+                                          FuncIdx * sizeof(void *));
+          _ mov(ABI.getCallTargetReg(), FuncPtrAddr);
+          emitTailJump(ArgInfo.getArgStackSize());
+        },
+        []() {});
+    // in reverse, as a temp stack operand releases the ones above it
+    for (auto It = Rets.rbegin(); It != Rets.rend(); ++It) {
+      releaseOperand(*It);
+    }
+  }
+
+  // return call indirect, the tables of the module hold no host functions
+  void handleReturnCallIndirectImpl(uint32_t TypeIdx, Operand Callee,
+                                    uint32_t TblIdx,
+                                    const ArgumentInfo &ArgInfo,
+                                    const std::vector<Operand> &Arg) {
+    std::vector<Operand> Rets = emitCall(
+        ArgInfo, Arg,
+        // prepare call, load the function index into %rax, which isn't used
+        // to pass arguments
+        [this, Callee, TblIdx]() {
+          saveGasVal();
+          emitTableGet(TblIdx, Callee, ABI.getCallTarget());
+        },
+        [this, TypeIdx, &ArgInfo]() {
+          emitIndirectCallTarget(TypeIdx, ABI.getCallTarget());
+          emitTailJump(ArgInfo.getArgStackSize());
+        },
+        []() {});
+    // in reverse, as a temp stack operand releases the ones above it
+    for (auto It = Rets.rbegin(); It != Rets.rend(); ++It) {
+      releaseOperand(*It);
+    }
+  }
+
+  // call internal function FuncIdx, the rel32 is patched after all functions
+  // are compiled
+  void emitPatchedCall(uint32_t FuncIdx) {
+    size_t Offset = _ offset();
+    _ dw(0);
+    _ dd(0); // reserve 6 bytes
+    ZEN_ASSERT(_ offset() - Offset == 6);
+    Patcher.addCallEntry(Offset, _ offset() - Offset, FuncIdx);
   }
 
   // branch to label if ZF is set
@@ -1287,7 +1454,9 @@ public:
   }
 
   // return
-  void handleReturnImpl(Operand Op) { emitEpilog(Op); }
+  void handleReturnImpl(const std::vector<Operand> &Results) {
+    emitEpilog(Results);
+  }
 
   // unreachable
   void handleUnreachableImpl() {
@@ -1308,16 +1477,18 @@ public:
         .NumParamCells = 1,
         .NumReturns = 1,
         .NumReturnCells = 1,
-        .ReturnTypes = {WASMType::I32},
         {
             .ParamTypesVec = {WASMType::I32},
         },
+        {
+            .ReturnTypesVec = {WASMType::I32},
+        },
         .SmallestTypeIdx = uint32_t(-1),
     };
 
     X64ArgumentInfo ArgInfo(&SigBuf);
     std::vector<Operand> Args({Op});
-    return emitCall(
+    std::vector<Operand> Rets = emitCall(
         ArgInfo, Args,
         []() {
           // prepare call, no nothing
@@ -1333,12 +1504,61 @@ public:
           _ mov(ABI.getMemorySizeReg(),
                 asmjit::x86::Mem(InstReg,
                                  Ctx->Mod->getLayout().MemorySizeOffset));
-          _ mov(ABI.getMemoryBaseReg(),
-                asmjit::x86::Mem(InstReg,
-                                 Ctx->Mod->getLayout().MemoryBaseOffset));
+          // memory base never changes when the memory is grown in place
+          if (!Ctx->UseFixedMemBase) {
+            _ mov(ABI.getMemoryBaseReg(),
+                  asmjit::x86::Mem(InstReg,
+                                   Ctx->Mod->getLayout().MemoryBaseOffset));
+          }
           _ bind(CallFail);
         },
         [] {});
+    return Rets.front();
+  }
+
+  // bulk memory, the runtime helpers charge gas and check bounds themselves
+  void handleMemoryInitImpl(uint32_t DataIdx, Operand Dst, Operand Src,
+                            Operand Len) {
+    static TypeEntry SigBuf = {
+        .NumParams = 4,
+        .NumParamCells = 4,
+        .NumReturns = 0,
+        .NumReturnCells = 0,
+        {
+            .ParamTypesVec = {WASMType::I32, WASMType::I32, WASMType::I32,
+                              WASMType::I32},
+        },
+        .SmallestTypeIdx = uint32_t(-1),
+    };
+    Operand Idx(WASMType::I32, int32_t(DataIdx));
+    emitBulkMemoryCall(&SigBuf, {Idx, Dst, Src, Len},
+                       uintptr_t(Instance::initMemoryOnJIT));
+  }
+
+  void handleDataDropImpl(uint32_t DataIdx) {
+    static TypeEntry SigBuf = {
+        .NumParams = 1,
+        .NumParamCells = 1,
+        .NumReturns = 0,
+        .NumReturnCells = 0,
+        {
+            .ParamTypesVec = {WASMType::I32},
+        },
+        .SmallestTypeIdx = uint32_t(-1),
+    };
+    Operand Idx(WASMType::I32, int32_t(DataIdx));
+    emitBulkMemoryCall(&SigBuf, {Idx},
+                       uintptr_t(Instance::dropDataSegmentOnJIT));
+  }
+
+  void handleMemoryCopyImpl(Operand Dst, Operand Src, Operand Len) {
+    emitBulkMemoryCall(getBulkMemorySig(), {Dst, Src, Len},
+                       uintptr_t(Instance::copyMemoryOnJIT));
+  }
+
+  void handleMemoryFillImpl(Operand Dst, Operand Val, Operand Len) {
+    emitBulkMemoryCall(getBulkMemorySig(), {Dst, Val, Len},
+                       uintptr_t(Instance::fillMemoryOnJIT));
   }
 
   // memory size
@@ -1861,6 +2081,17 @@ public:
                                                                Delta);
   }
 
+  // add to a uint64 counter of function profiling, keeps all registers
+  void addFunctionCounter(uint32_t Offset, Operand Delta) {
+    auto CounterAddr = asmjit::x86::qword_ptr(ABI.getModuleInstReg(), Offset);
+    if (Delta.isImm()) {
+      _ add(CounterAddr, Delta.getImm());
+    } else {
+      auto DeltaRegNum = toReg<X64::I64, ScopedTempReg0>(Delta);
+      _ add(CounterAddr, X64Reg::getRegRef<X64::I64>(DeltaRegNum));
+    }
+  }
+
   template <bool Sign, WASMType Type, BinaryOperator Opr>
   Operand checkedArithmetic(Operand LHS, Operand RHS) {
     constexpr auto X64Type = getX64TypeFromWASMType<Type>();
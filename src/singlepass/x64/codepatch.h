@@ -99,15 +99,18 @@ public:
                                    Callee - Mod->getNumImportFunctions());
   }
 
-  void finalizeModule() {
+  // CodeDelta is non-zero when patching a copy of the module code
+  void finalizeModule(intptr_t CodeDelta = 0) {
     for (auto It = PatchInfos.begin(), E = PatchInfos.end(); It != E; ++It) {
       uint8_t *Base = (uint8_t *)It->getFunctionAddress();
       ZEN_ASSERT(Base);
+      Base += CodeDelta;
       for (auto P = It->begin(), EE = It->end(); P != EE; ++P) {
         ZEN_ASSERT(P->getSize() == 6);
         ZEN_ASSERT(P->getArg() < PatchInfos.size());
         ZEN_ASSERT(P->getKind() == PatchInfo::PKCall);
-        uint8_t *Target = (uint8_t *)getFunctionAddress(P->getArg());
+        uint8_t *Target =
+            (uint8_t *)getFunctionAddress(P->getArg()) + CodeDelta;
         int64_t Diff =
             (int64_t)Target - (int64_t)(Base + P->getOffset() + P->getSize());
         ZEN_ASSERT(INT_MIN <= Diff && Diff <= INT_MAX);
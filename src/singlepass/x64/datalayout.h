@@ -17,6 +17,7 @@
 #include "singlepass/x64/asm/register.h"
 #include "singlepass/x64/machine.h"
 #include "singlepass/x64/operand.h"
+#include <iterator>
 
 namespace zen::singlepass {
 
@@ -35,6 +36,18 @@ protected:
   // each time stack increase 32-byte
   constexpr static uint32_t StackIncrement = 32;
 
+  // the last temp registers, which are allocated last, hold the hottest
+  // locals of a function when local caching is enabled
+  constexpr static X64::GP PinnedGpRegs[] = {X64::R11, X64::R10};
+  constexpr static X64::FP PinnedFpRegs[] = {X64::XMM10, X64::XMM9,
+                                             X64::XMM8};
+  // a local used fewer times than this outside loops stays on stack
+  constexpr static uint64_t MinPinnedLocalWeight = 8;
+
+  // register of each parameter pinned to one, parameters move there from
+  // their parameter registers in the prolog
+  std::vector<uint32_t> PinnedParamRegs;
+
 public:
   X64OnePassDataLayout(X64OnePassABI &ABI)
       : OnePassDataLayout<X64OnePassABI>(ABI) {}
@@ -77,6 +90,70 @@ private:
     Locals.push_back(LocalInfo(Type, -StkSize));
   }
 
+  // pin the hottest locals to temp registers for the whole function. the
+  // registers are never available for temps, so emitCall saves and restores
+  // them like any temp in use and a pinned local only spills around calls
+  void pinHotLocals(uint32_t NumParams) {
+    std::vector<uint64_t> Weights;
+    uint64_t CallWeight = 0;
+    if (!scanLocalUses(Weights, CallWeight)) {
+      return;
+    }
+
+    // a pinned local costs a store and a load around every call
+    const uint64_t MinWeight = std::max(MinPinnedLocalWeight, 2 * CallWeight);
+    std::vector<uint32_t> Candidates;
+    for (uint32_t I = 0; I < Locals.size(); ++I) {
+      const LocalInfo &Info = Locals[I];
+      // parameters passed on stack are not pinned
+      if (Weights[I] < MinWeight || (I < NumParams && !Info.inReg())) {
+        continue;
+      }
+      switch (Info.getType()) {
+      case WASMType::I32:
+      case WASMType::I64:
+      case WASMType::F32:
+      case WASMType::F64:
+        Candidates.push_back(I);
+        break;
+      default:
+        break;
+      }
+    }
+    std::stable_sort(Candidates.begin(), Candidates.end(),
+                     [&Weights](uint32_t LHS, uint32_t RHS) {
+                       return Weights[LHS] > Weights[RHS];
+                     });
+
+    uint32_t NumGpPinned = 0;
+    uint32_t NumFpPinned = 0;
+    for (uint32_t Idx : Candidates) {
+      const LocalInfo &Info = Locals[Idx];
+      uint32_t Reg;
+      if (getWASMTypeKind(Info.getType()) == WASMTypeKind::INTEGER) {
+        if (NumGpPinned == std::size(PinnedGpRegs)) {
+          continue;
+        }
+        X64::GP GpReg = PinnedGpRegs[NumGpPinned++];
+        VmState.clearAvailReg<X64::I64>(GpReg);
+        Reg = GpReg;
+      } else {
+        if (NumFpPinned == std::size(PinnedFpRegs)) {
+          continue;
+        }
+        X64::FP FpReg = PinnedFpRegs[NumFpPinned++];
+        VmState.clearAvailReg<X64::F64>(FpReg);
+        Reg = FpReg;
+      }
+
+      if (Idx < NumParams) {
+        PinnedParamRegs[Idx] = Reg;
+      } else {
+        Locals[Idx] = LocalInfo(Info.getType(), Reg, Info.getOffset());
+      }
+    }
+  }
+
 public:
   void initFunction(JITCompilerContext *Ctx) {
     auto *FuncType = Ctx->FuncType;
@@ -137,6 +214,12 @@ public:
       }
     } // for (...)
 
+    PinnedParamRegs.assign(FuncType->NumParams,
+                           X64OnePassABI::InvalidParamReg);
+    if (Ctx->CacheLocalsInRegs) {
+      pinHotLocals(FuncType->NumParams);
+    }
+
     // set _stack_used and _stack_budget
     StackUsed = ((StackTop + 15) / 16) * 16;
     StackBudget = StackUsed + StackIncrement;
@@ -173,6 +256,27 @@ public:
 
   void clearParamInReg() { VmState.clearParamInReg(); }
 
+  // the parameter moves to its pinned register if it has one
+  void clearLocalInRegister(uint32_t LocalIdx) {
+    OnePassDataLayout<X64OnePassABI>::clearLocalInRegister(LocalIdx);
+    if (LocalIdx < PinnedParamRegs.size() &&
+        PinnedParamRegs[LocalIdx] != X64OnePassABI::InvalidParamReg) {
+      const LocalInfo &Info = Locals[LocalIdx];
+      Locals[LocalIdx] = LocalInfo(Info.getType(), PinnedParamRegs[LocalIdx],
+                                   Info.getOffset());
+    }
+  }
+
+  // \return whether the parameter is pinned to a register, and the register
+  bool getPinnedParamReg(uint32_t ParamIdx, X64::RegNum &Reg) const {
+    ZEN_ASSERT(ParamIdx < PinnedParamRegs.size());
+    if (PinnedParamRegs[ParamIdx] == X64OnePassABI::InvalidParamReg) {
+      return false;
+    }
+    Reg = static_cast<X64::RegNum>(PinnedParamRegs[ParamIdx]);
+    return true;
+  }
+
 public:
   X64InstOperand getGlobal(X64::GP Base, uint32_t GlobalIdx) {
     ZEN_ASSERT(GlobalIdx < Globals.size());
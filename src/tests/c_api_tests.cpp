@@ -163,6 +163,124 @@ TEST(C_API, Trap) {
   ZenDeleteRuntime(Runtime);
 }
 
+TEST(C_API, FunctionHandle) {
+  ZenRuntimeRef Runtime = ZenCreateRuntime(&RuntimeConfig);
+  EXPECT_NE(Runtime, nullptr);
+
+  // (module (func (export "add") (param i32 i32) (result i32)
+  //   local.get 0 local.get 1 i32.add))
+  static uint8_t WASMBuffer[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01, 0x60,
+      0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x07, 0x01,
+      0x03, 0x61, 0x64, 0x64, 0x00, 0x00, 0x0a, 0x09, 0x01, 0x07, 0x00, 0x20,
+      0x00, 0x20, 0x01, 0x6a, 0x0b,
+  };
+  char ErrBuf[128] = {0};
+  const uint32_t ErrBufSize = sizeof(ErrBuf);
+  ZenModuleRef Module = ZenLoadModuleFromBuffer(
+      Runtime, "test", WASMBuffer, sizeof(WASMBuffer), ErrBuf, ErrBufSize);
+  ASSERT_NE(Module, nullptr);
+  ZenFunctionHandleRef Func = ZenGetFunctionHandle(Module, "add");
+  ASSERT_NE(Func, nullptr);
+  EXPECT_EQ(ZenGetFunctionHandleNumResults(Func), 1);
+
+  ZenIsolationRef Isolation = ZenCreateIsolation(Runtime);
+  EXPECT_NE(Isolation, nullptr);
+  ZenInstanceRef Instance =
+      ZenCreateInstance(Isolation, Module, ErrBuf, ErrBufSize);
+  ASSERT_NE(Instance, nullptr);
+
+  ZenValue Args[2];
+  Args[0].Type = ZenTypeI32;
+  Args[0].Value.I32 = 40;
+  Args[1].Type = ZenTypeI32;
+  Args[1].Value.I32 = 2;
+  ZenValue Results[1];
+  uint32_t NumOutResults;
+  // the results buffer is too small, the function must not run
+  EXPECT_FALSE(ZenCallFunctionHandle(Runtime, Instance, Func, Args, 2,
+                                     Results, 0, &NumOutResults));
+  EXPECT_EQ(NumOutResults, 0);
+  EXPECT_TRUE(ZenGetInstanceError(Instance, ErrBuf, ErrBufSize));
+  ZenClearInstanceError(Instance);
+
+  EXPECT_TRUE(ZenCallFunctionHandle(Runtime, Instance, Func, Args, 2, Results,
+                                    1, &NumOutResults));
+  EXPECT_EQ(NumOutResults, 1);
+  EXPECT_EQ(Results[0].Value.I32, 42);
+
+  // a handle of another module is rejected without running
+  ZenModuleRef OtherModule = ZenLoadModuleFromBuffer(
+      Runtime, "other", WASMBuffer, sizeof(WASMBuffer), ErrBuf, ErrBufSize);
+  ASSERT_NE(OtherModule, nullptr);
+  ZenInstanceRef OtherInstance =
+      ZenCreateInstance(Isolation, OtherModule, ErrBuf, ErrBufSize);
+  ASSERT_NE(OtherInstance, nullptr);
+  EXPECT_FALSE(ZenCallFunctionHandle(Runtime, OtherInstance, Func, Args, 2,
+                                     Results, 1, &NumOutResults));
+  EXPECT_EQ(NumOutResults, 0);
+  EXPECT_TRUE(ZenGetInstanceError(OtherInstance, ErrBuf, ErrBufSize));
+  EXPECT_TRUE(ZenDeleteInstance(Isolation, OtherInstance));
+  EXPECT_TRUE(ZenDeleteModule(Runtime, OtherModule));
+
+  EXPECT_TRUE(ZenDeleteInstance(Isolation, Instance));
+  EXPECT_TRUE(ZenDeleteIsolation(Runtime, Isolation));
+  EXPECT_TRUE(ZenDeleteModule(Runtime, Module));
+  ZenDeleteRuntime(Runtime);
+}
+
+TEST(C_API, FunctionHandleManyResults) {
+  ZenRuntimeRef Runtime = ZenCreateRuntime(&RuntimeConfig);
+  EXPECT_NE(Runtime, nullptr);
+
+  // (module (func (export "many") (param i64)
+  //   (result i64 i64 i64 i64 i64 i64 i64 i64 i64)
+  //   local.get 0 i64.const 1 i64.add ... local.get 0 i64.const 9 i64.add))
+  static uint8_t WASMBuffer[] = {
+      0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0e, 0x01, 0x60,
+      0x01, 0x7e, 0x09, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e,
+      0x03, 0x02, 0x01, 0x00, 0x07, 0x08, 0x01, 0x04, 0x6d, 0x61, 0x6e, 0x79,
+      0x00, 0x00, 0x0a, 0x31, 0x01, 0x2f, 0x00, 0x20, 0x00, 0x42, 0x01, 0x7c,
+      0x20, 0x00, 0x42, 0x02, 0x7c, 0x20, 0x00, 0x42, 0x03, 0x7c, 0x20, 0x00,
+      0x42, 0x04, 0x7c, 0x20, 0x00, 0x42, 0x05, 0x7c, 0x20, 0x00, 0x42, 0x06,
+      0x7c, 0x20, 0x00, 0x42, 0x07, 0x7c, 0x20, 0x00, 0x42, 0x08, 0x7c, 0x20,
+      0x00, 0x42, 0x09, 0x7c, 0x0b,
+  };
+  char ErrBuf[128] = {0};
+  const uint32_t ErrBufSize = sizeof(ErrBuf);
+  ZenModuleRef Module = ZenLoadModuleFromBuffer(
+      Runtime, "test", WASMBuffer, sizeof(WASMBuffer), ErrBuf, ErrBufSize);
+  ASSERT_NE(Module, nullptr);
+  ZenFunctionHandleRef Func = ZenGetFunctionHandle(Module, "many");
+  ASSERT_NE(Func, nullptr);
+  EXPECT_EQ(ZenGetFunctionHandleNumResults(Func), 9);
+
+  ZenIsolationRef Isolation = ZenCreateIsolation(Runtime);
+  EXPECT_NE(Isolation, nullptr);
+  ZenInstanceRef Instance =
+      ZenCreateInstance(Isolation, Module, ErrBuf, ErrBufSize);
+  ASSERT_NE(Instance, nullptr);
+
+  // more results than the call keeps on its stack
+  ZenValue Arg;
+  Arg.Type = ZenTypeI64;
+  Arg.Value.I64 = 100;
+  ZenValue Results[9];
+  uint32_t NumOutResults;
+  EXPECT_TRUE(ZenCallFunctionHandle(Runtime, Instance, Func, &Arg, 1, Results,
+                                    9, &NumOutResults));
+  ASSERT_EQ(NumOutResults, 9);
+  for (uint32_t I = 0; I < 9; ++I) {
+    EXPECT_EQ(Results[I].Type, ZenTypeI64);
+    EXPECT_EQ(Results[I].Value.I64, 101 + I);
+  }
+
+  EXPECT_TRUE(ZenDeleteInstance(Isolation, Instance));
+  EXPECT_TRUE(ZenDeleteIsolation(Runtime, Isolation));
+  EXPECT_TRUE(ZenDeleteModule(Runtime, Module));
+  ZenDeleteRuntime(Runtime);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -4,6 +4,8 @@
 #include "common/mem_pool.h"
 
 #include <gtest/gtest.h>
+#include <thread>
+#include <vector>
 
 namespace zen::test {
 
@@ -38,6 +40,118 @@ TEST(Mempool, CodeMemPool) {
   EXPECT_DEATH(Pool.allocate(CodeMemPool::MaxCodeSize), "");
 }
 
+TEST(Mempool, AllocOnlyMemPool) {
+  AllocOnlyMemPool Pool;
+  EXPECT_EQ(Pool.allocate(0), nullptr);
+  EXPECT_EQ(Pool.getReservedSize(), 0);
+
+  // reserved space is handed out contiguously
+  Pool.reserve(1000);
+  size_t ReservedSize = Pool.getReservedSize();
+  auto *First = static_cast<uint8_t *>(Pool.allocateZeros(10));
+  auto *Second = static_cast<uint8_t *>(Pool.allocate(100));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(First) % 16, 0);
+  EXPECT_EQ(Second, First + 16);
+  EXPECT_EQ(First[9], 0);
+  EXPECT_EQ(Pool.getAllocSize(), 16 + 112);
+  EXPECT_EQ(Pool.getReservedSize(), ReservedSize);
+
+  // allocations larger than a block get a block of their own
+  auto *Large = static_cast<uint8_t *>(
+      Pool.allocate(AllocOnlyMemPool::MaxBlockSize * 2));
+  ASSERT_NE(Large, nullptr);
+  Large[AllocOnlyMemPool::MaxBlockSize * 2 - 1] = 1;
+  EXPECT_GT(Pool.getReservedSize(), AllocOnlyMemPool::MaxBlockSize * 2);
+}
+
+TEST(Mempool, ThreadCachingMemPool) {
+  ThreadCachingMemPool Pool;
+  EXPECT_EQ(Pool.allocate(0), nullptr);
+
+  std::vector<std::pair<uint8_t *, size_t>> Blocks;
+  for (size_t Size : {1, 16, 17, 255, 256, 257, 4000, 32768, 32769, 100000}) {
+    auto *Ptr = static_cast<uint8_t *>(Pool.allocate(Size));
+    ASSERT_NE(Ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(Ptr) % 16, 0);
+    EXPECT_GE(ThreadCachingMemPool::getUsableSize(Ptr), Size);
+    std::memset(Ptr, static_cast<int>(Size), Size);
+    Blocks.emplace_back(Ptr, Size);
+  }
+  for (auto [Ptr, Size] : Blocks) {
+    EXPECT_EQ(Ptr[Size - 1], static_cast<uint8_t>(Size));
+    Pool.deallocate(Ptr);
+  }
+
+  auto *Aligned = static_cast<uint8_t *>(Pool.allocateZeros(100, 256));
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(Aligned) % 256, 0);
+  EXPECT_EQ(Aligned[99], 0);
+  Pool.deallocate(Aligned);
+
+  // freed blocks are reused by the same thread
+  void *Ptr = Pool.allocate(40);
+  Pool.deallocate(Ptr);
+  EXPECT_EQ(Pool.allocate(48), Ptr);
+
+  // contents survive growing from small to large blocks and back
+  auto *Data = static_cast<uint8_t *>(Ptr);
+  for (uint32_t I = 0; I < 48; ++I) {
+    Data[I] = static_cast<uint8_t>(I);
+  }
+  for (size_t NewSize : {64, 1024, 65536, 200000, 32}) {
+    Data = static_cast<uint8_t *>(Pool.reallocate(Data, 0, NewSize));
+    for (uint32_t I = 0; I < 32; ++I) {
+      ASSERT_EQ(Data[I], I);
+    }
+  }
+  Pool.deallocate(Data);
+#ifndef NDEBUG
+  EXPECT_EQ(Pool.getNumAllocs(), 0);
+#endif
+}
+
+TEST(Mempool, ThreadCachingMemPoolConcurrent) {
+  constexpr uint32_t NumThreads = 4;
+  constexpr uint32_t NumBlocks = 2000;
+  ThreadCachingMemPool Pool;
+  // every thread frees the blocks allocated by the previous one
+  std::vector<std::vector<uint32_t *>> Blocks(NumThreads);
+  std::vector<std::thread> Threads;
+  for (uint32_t I = 0; I < NumThreads; ++I) {
+    Threads.emplace_back([&Pool, &Blocks, I] {
+      for (uint32_t J = 0; J < NumBlocks; ++J) {
+        size_t Size = sizeof(uint32_t) * (1 + (J * 7 + I) % 600);
+        auto *Ptr = static_cast<uint32_t *>(Pool.allocate(Size));
+        *Ptr = I * NumBlocks + J;
+        Blocks[I].push_back(Ptr);
+        if (J % 3 == 0) {
+          Pool.deallocate(Blocks[I].back());
+          Blocks[I].pop_back();
+        }
+      }
+    });
+  }
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+  Threads.clear();
+
+  for (uint32_t I = 0; I < NumThreads; ++I) {
+    Threads.emplace_back([&Pool, &Blocks, I] {
+      auto &Prev = Blocks[(I + NumThreads - 1) % NumThreads];
+      for (uint32_t *Ptr : Prev) {
+        EXPECT_EQ(*Ptr / NumBlocks, (I + NumThreads - 1) % NumThreads);
+        Pool.deallocate(Ptr);
+      }
+    });
+  }
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+#ifndef NDEBUG
+  EXPECT_EQ(Pool.getNumAllocs(), 0);
+#endif
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
@@ -0,0 +1,143 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "common/thread_pool.h"
+#include "platform/numa.h"
+#include "runtime/instance.h"
+#include "runtime/isolation.h"
+#include "runtime/module.h"
+#include "runtime/runtime.h"
+
+#include <atomic>
+#include <gtest/gtest.h>
+
+namespace zen::test {
+
+using namespace zen;
+
+class NumaTest : public testing::Test {
+protected:
+  void SetUp() override { platform::setFakeNumaTopology(4); }
+  void TearDown() override { platform::setFakeNumaTopology(0); }
+};
+
+TEST_F(NumaTest, FakeTopology) {
+  const auto &Topology = platform::getNumaTopology();
+  EXPECT_TRUE(Topology.IsFake);
+  EXPECT_EQ(Topology.getNumNodes(), 4);
+  // every cpu belongs to exactly one node
+  uint32_t NumCPUs = 0;
+  for (uint32_t Node = 0; Node < Topology.getNumNodes(); ++Node) {
+    for (uint32_t CPU : Topology.NodeCPUs[Node]) {
+      EXPECT_EQ(Topology.getNodeOfCPU(CPU), Node);
+      ++NumCPUs;
+    }
+  }
+  EXPECT_EQ(NumCPUs, std::max(1u, std::thread::hardware_concurrency()));
+}
+
+TEST_F(NumaTest, CurrentNode) {
+  EXPECT_TRUE(platform::setCurrentThreadNumaNode(2));
+  EXPECT_EQ(platform::getCurrentNumaNode(), 2);
+  EXPECT_FALSE(platform::setCurrentThreadNumaNode(4));
+  EXPECT_EQ(platform::getCurrentNumaNode(), 2);
+  EXPECT_TRUE(platform::setCurrentThreadNumaNode(0));
+  EXPECT_EQ(platform::getCurrentNumaNode(), 0);
+
+  // binding is a no-op on fake nodes
+  std::vector<uint8_t> Buffer(4096);
+  EXPECT_TRUE(platform::bindMemoryToNumaNode(Buffer.data(), Buffer.size(), 3));
+}
+
+TEST_F(NumaTest, ThreadPoolAffinityHints) {
+  common::ThreadPool<void> Pool(4);
+  for (common::ConcurrencyT I = 0; I < Pool.getThreadCount(); ++I) {
+    Pool.setThreadNumaNode(I, I % 4);
+  }
+  Pool.setAllThreadsNumaNode(3);
+  std::atomic<uint32_t> NumOnNode3 = 0;
+  for (uint32_t I = 0; I < 16; ++I) {
+    Pool.pushTask([&](void *) {
+      if (platform::getCurrentNumaNode() == 3) {
+        ++NumOnNode3;
+      }
+    });
+  }
+  Pool.waitForTasks();
+  EXPECT_EQ(NumOnNode3, 16);
+}
+
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+// (module (func $fib (export "fib") (param i32) (result i32)
+//   local.get 0 i32.const 2 i32.lt_u
+//   if (result i32) local.get 0
+//   else
+//     local.get 0 i32.const 1 i32.sub call $fib
+//     local.get 0 i32.const 2 i32.sub call $fib i32.add
+//   end))
+static const uint8_t FibWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x07, 0x01, 0x03,
+    0x66, 0x69, 0x62, 0x00, 0x00, 0x0a, 0x1e, 0x01, 0x1c, 0x00, 0x20, 0x00,
+    0x41, 0x02, 0x49, 0x04, 0x7f, 0x20, 0x00, 0x05, 0x20, 0x00, 0x41, 0x01,
+    0x6b, 0x10, 0x00, 0x20, 0x00, 0x41, 0x02, 0x6b, 0x10, 0x00, 0x6a, 0x0b,
+    0x0b,
+};
+
+TEST_F(NumaTest, JITCodeReplicas) {
+  using namespace runtime;
+  RuntimeConfig Config;
+  Config.Mode = common::RunMode::SinglepassMode;
+  Config.EnableNUMA = true;
+  Config.EnableNUMACodeReplication = true;
+#ifdef ZEN_ENABLE_BUILTIN_WASI
+  Config.DisableWASI = true;
+#endif
+  auto RT = Runtime::newRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+
+  // compiled on node 0, the other nodes get relocated copies
+  ASSERT_TRUE(platform::setCurrentThreadNumaNode(0));
+  auto ModRet = RT->loadModule("fib", FibWASM, sizeof(FibWASM));
+  ASSERT_TRUE(ModRet);
+  Module *Mod = *ModRet;
+  const auto *PrimaryCode = static_cast<const uint8_t *>(Mod->getJITCode());
+  const uint8_t *FibCode = Mod->getCodeEntry(0)->JITCodePtr;
+  ASSERT_NE(PrimaryCode, nullptr);
+
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  for (uint32_t Node = 0; Node < 4; ++Node) {
+    ASSERT_TRUE(platform::setCurrentThreadNumaNode(Node));
+    const auto *NodeCode =
+        static_cast<const uint8_t *>(Mod->getLocalJITCode());
+    if (Node == 0) {
+      EXPECT_EQ(NodeCode, PrimaryCode);
+    } else {
+      EXPECT_NE(NodeCode, PrimaryCode);
+    }
+
+    auto InstRet = Iso->createInstance(*Mod);
+    ASSERT_TRUE(InstRet);
+    Instance *Inst = *InstRet;
+    EXPECT_EQ(Inst->getJITCode(), NodeCode);
+    const uint8_t *NodeFibCode = Inst->getFunctionInst(0)->JITCodePtr;
+    EXPECT_EQ(NodeFibCode, Mod->relocateJITCodePtr(FibCode, NodeCode));
+    EXPECT_EQ(NodeFibCode - NodeCode, FibCode - PrimaryCode);
+
+    // the copy is entered through the relocated function pointer, its
+    // recursive calls are rel32 and stay within the copy
+    std::vector<common::TypedValue> Results;
+    common::TypedValue Arg;
+    Arg.Type = common::WASMType::I32;
+    Arg.Value.I32 = 20;
+    ASSERT_TRUE(RT->callWasmFunction(*Inst, 0, {Arg}, Results));
+    ASSERT_EQ(Results.size(), 1u);
+    EXPECT_EQ(Results[0].Value.I32, 6765);
+    ASSERT_TRUE(Iso->deleteInstance(Inst));
+  }
+  EXPECT_TRUE(platform::setCurrentThreadNumaNode(0));
+}
+#endif // ZEN_ENABLE_SINGLEPASS_JIT
+
+} // namespace zen::test
@@ -0,0 +1,2596 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "compiler/adaptive_ra.h"
+#include "runtime/executor.h"
+#include "runtime/function_handle.h"
+#include "runtime/instance.h"
+#include "runtime/isolation.h"
+#include "runtime/module.h"
+#include "runtime/runtime.h"
+#include "runtime/sampling_profiler.h"
+#include "utils/metrics.h"
+#include "utils/u256.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+#include "host/crypto/crypto.h"
+#include "host/crypto/digests.h"
+#include "host/crypto/secp256k1.h"
+#endif
+
+namespace zen::test {
+
+using namespace zen;
+using namespace common;
+using namespace runtime;
+
+// (module (func (export "add") (param i32 i32) (result i32)
+//   local.get 0 local.get 1 i32.add))
+static const uint8_t AddWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01, 0x60,
+    0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x07, 0x01,
+    0x03, 0x61, 0x64, 0x64, 0x00, 0x00, 0x0a, 0x09, 0x01, 0x07, 0x00, 0x20,
+    0x00, 0x20, 0x01, 0x6a, 0x0b,
+};
+
+// (module (func (export "div") (param i32 i32) (result i32)
+//   local.get 0 local.get 1 i32.div_s))
+static const uint8_t DivWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x07, 0x01, 0x60,
+    0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x07, 0x01,
+    0x03, 0x64, 0x69, 0x76, 0x00, 0x00, 0x0a, 0x09, 0x01, 0x07, 0x00, 0x20,
+    0x00, 0x20, 0x01, 0x6d, 0x0b,
+};
+
+static RuntimeConfig getTestRuntimeConfig() {
+  RuntimeConfig Config;
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  Config.Mode = RunMode::SinglepassMode;
+#else
+  Config.Mode = RunMode::InterpMode;
+#endif
+#ifdef ZEN_ENABLE_BUILTIN_WASI
+  Config.DisableWASI = true;
+#endif
+  return Config;
+}
+
+// \p Config is usually getTestRuntimeConfig with some options changed
+static std::unique_ptr<Runtime> createTestRuntime(const RuntimeConfig &Config) {
+  return Runtime::newRuntime(Config);
+}
+
+static std::unique_ptr<Runtime>
+createTestRuntime(bool EnableThreadCachingAllocator = false,
+                  bool EnableFunctionProfiling = false) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.EnableThreadCachingAllocator = EnableThreadCachingAllocator;
+  Config.EnableFunctionProfiling = EnableFunctionProfiling;
+  return createTestRuntime(Config);
+}
+
+static TypedValue makeI32(int32_t V) {
+  TypedValue Val;
+  Val.Type = WASMType::I32;
+  Val.Value.I32 = V;
+  return Val;
+}
+
+static TypedValue makeI64(int64_t V) {
+  TypedValue Val;
+  Val.Type = WASMType::I64;
+  Val.Value.I64 = V;
+  return Val;
+}
+
+static TypedValue makeF32(float V) {
+  TypedValue Val;
+  Val.Type = WASMType::F32;
+  Val.Value.F32 = V;
+  return Val;
+}
+
+static std::string toHex(const uint8_t *Data, size_t Size) {
+  std::string Hex;
+  for (size_t I = 0; I < Size; ++I) {
+    char Buf[3];
+    std::snprintf(Buf, sizeof(Buf), "%02x", Data[I]);
+    Hex += Buf;
+  }
+  return Hex;
+}
+
+constexpr uint32_t NumTestThreads = 4;
+
+TEST(Runtime, ConcurrentSymbolPool) {
+  ConstStringPool Pool;
+  ASSERT_TRUE(Pool.initPool());
+  int32_t NumInitSymbols = Pool.getNumSymbols();
+
+  std::vector<std::thread> Threads;
+  for (uint32_t I = 0; I < NumTestThreads; ++I) {
+    Threads.emplace_back([&Pool, I] {
+      for (uint32_t J = 0; J < 2000; ++J) {
+        // shared by all threads and private to this thread
+        std::string Shared = "shared_" + std::to_string(J % 50);
+        std::string Private =
+            "private_" + std::to_string(I) + "_" + std::to_string(J);
+        WASMSymbol SharedSym = Pool.newSymbol(Shared.c_str(), Shared.size());
+        WASMSymbol PrivateSym =
+            Pool.newSymbol(Private.c_str(), Private.size());
+        ASSERT_NE(SharedSym, WASM_SYMBOL_NULL);
+        ASSERT_NE(PrivateSym, WASM_SYMBOL_NULL);
+        EXPECT_EQ(Pool.probeSymbol(Shared.c_str(), Shared.size()), SharedSym);
+        EXPECT_STREQ(Pool.dumpSymbolString(PrivateSym), Private.c_str());
+        Pool.freeSymbol(PrivateSym);
+        Pool.freeSymbol(SharedSym);
+      }
+    });
+  }
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+
+  EXPECT_EQ(Pool.getNumSymbols(), NumInitSymbols);
+}
+
+static void testConcurrentLoadModule(bool EnableThreadCachingAllocator) {
+  auto RT = createTestRuntime(EnableThreadCachingAllocator);
+  ASSERT_NE(RT, nullptr);
+
+  std::vector<Module *> SharedMods(NumTestThreads, nullptr);
+  std::vector<std::thread> Threads;
+  for (uint32_t I = 0; I < NumTestThreads; ++I) {
+    Threads.emplace_back([&RT, &SharedMods, I] {
+      for (uint32_t J = 0; J < 20; ++J) {
+        std::string Name = "mod_" + std::to_string(I) + "_" + std::to_string(J);
+        auto ModRet = RT->loadModule(Name, AddWASM, sizeof(AddWASM));
+        ASSERT_TRUE(ModRet);
+        EXPECT_TRUE(RT->unloadModule(*ModRet));
+      }
+      // every thread must get the same module
+      auto SharedRet = RT->loadModule("shared", AddWASM, sizeof(AddWASM));
+      ASSERT_TRUE(SharedRet);
+      SharedMods[I] = *SharedRet;
+    });
+  }
+  for (auto &Thread : Threads) {
+    Thread.join();
+  }
+
+  for (uint32_t I = 1; I < NumTestThreads; ++I) {
+    EXPECT_EQ(SharedMods[I], SharedMods[0]);
+  }
+
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(*SharedMods[0]);
+  ASSERT_TRUE(InstRet);
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 0, {makeI32(1), makeI32(2)},
+                                   Results));
+  ASSERT_EQ(Results.size(), 1);
+  EXPECT_EQ(Results[0].Value.I32, 3);
+}
+
+TEST(Runtime, ConcurrentLoadModule) { testConcurrentLoadModule(false); }
+
+TEST(Runtime, ConcurrentLoadModuleThreadCaching) {
+  testConcurrentLoadModule(true);
+}
+
+TEST(Runtime, FunctionHandle) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("handle", AddWASM, sizeof(AddWASM));
+  ASSERT_TRUE(ModRet);
+  Module *Mod = *ModRet;
+  EXPECT_EQ(Mod->getFunctionHandle("sub"), nullptr);
+  const FunctionHandle *Handle = Mod->getFunctionHandle("add");
+  ASSERT_NE(Handle, nullptr);
+  EXPECT_EQ(Mod->getFunctionHandle(Handle->getFuncIdx()), Handle);
+  EXPECT_EQ(Handle->getNumParams(), 2);
+  EXPECT_EQ(Handle->getNumReturns(), 1);
+
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(*Mod);
+  ASSERT_TRUE(InstRet);
+  for (int32_t I = 0; I < 100; ++I) {
+    UntypedValue Args[2];
+    Args[0].I32 = I;
+    Args[1].I32 = -2 * I;
+    UntypedValue Result;
+    ASSERT_TRUE(RT->callWasmFunction(**InstRet, *Handle, Args, &Result));
+    EXPECT_EQ(Result.I32, -I);
+  }
+
+  // a handle of another module is rejected without running
+  auto OtherRet = RT->loadModule("other", DivWASM, sizeof(DivWASM));
+  ASSERT_TRUE(OtherRet);
+  auto OtherInstRet = Iso->createInstance(**OtherRet);
+  ASSERT_TRUE(OtherInstRet);
+  Instance &OtherInst = **OtherInstRet;
+  UntypedValue Args[2] = {};
+  UntypedValue Result;
+  EXPECT_FALSE(RT->callWasmFunction(OtherInst, *Handle, Args, &Result));
+  EXPECT_EQ(OtherInst.getError().getCode(), ErrorCode::ForeignFunctionHandle);
+  OtherInst.clearError();
+  BatchCallStatus Status;
+  EXPECT_EQ(RT->callWasmFunctionBatch(OtherInst, *Handle, 1, Args, &Result,
+                                      &Status),
+            0u);
+  EXPECT_EQ(Status.ErrCode, ErrorCode::ForeignFunctionHandle);
+  OtherInst.clearError();
+
+  Executor Exec(*RT, 1);
+  ExecutorCallResult ExecResult =
+      Exec.submitCall(**OtherRet, *Handle, {Args[0], Args[1]}).get();
+  EXPECT_EQ(ExecResult.ErrCode, ErrorCode::ForeignFunctionHandle);
+  ExecResult = Exec.submitCall(OtherInst, *Handle, {Args[0], Args[1]}).get();
+  EXPECT_EQ(ExecResult.ErrCode, ErrorCode::ForeignFunctionHandle);
+}
+
+TEST(Runtime, FunctionHandleBatch) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("batch", DivWASM, sizeof(DivWASM));
+  ASSERT_TRUE(ModRet);
+  const FunctionHandle *Handle = (*ModRet)->getFunctionHandle("div");
+  ASSERT_NE(Handle, nullptr);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+
+  // every third call divides by zero and traps
+  constexpr uint32_t NumCalls = 30;
+  std::vector<UntypedValue> Args(NumCalls * 2);
+  for (uint32_t I = 0; I < NumCalls; ++I) {
+    Args[I * 2].I32 = 100 * I;
+    Args[I * 2 + 1].I32 = I % 3 == 1 ? 0 : 10;
+  }
+  std::vector<UntypedValue> Results(NumCalls);
+  std::vector<BatchCallStatus> Statuses(NumCalls);
+  uint32_t NumSucceeded = RT->callWasmFunctionBatch(
+      Inst, *Handle, NumCalls, Args.data(), Results.data(), Statuses.data());
+  EXPECT_EQ(NumSucceeded, NumCalls - NumCalls / 3);
+  for (uint32_t I = 0; I < NumCalls; ++I) {
+    if (I % 3 == 1) {
+      EXPECT_EQ(Statuses[I].ErrCode, ErrorCode::IntegerDivByZero);
+    } else {
+      EXPECT_EQ(Statuses[I].ErrCode, ErrorCode::NoError);
+      EXPECT_EQ(Results[I].I32, 10 * int32_t(I));
+    }
+    if (I > 0) {
+      EXPECT_LE(Statuses[I].GasLeft, Statuses[I - 1].GasLeft);
+    }
+  }
+  EXPECT_EQ(Statuses[NumCalls - 1].GasLeft, Inst.getGas());
+  // only the error of the last call is kept
+  EXPECT_FALSE(Inst.hasError());
+}
+
+TEST(Runtime, Executor) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("executor", DivWASM, sizeof(DivWASM));
+  ASSERT_TRUE(ModRet);
+  Module *Mod = *ModRet;
+  const FunctionHandle *Handle = Mod->getFunctionHandle("div");
+  ASSERT_NE(Handle, nullptr);
+
+  Executor Exec(*RT, NumTestThreads);
+  EXPECT_EQ(Exec.getNumThreads(), NumTestThreads);
+  constexpr int32_t NumCalls = 200;
+  std::vector<std::future<ExecutorCallResult>> Futures;
+  for (int32_t I = 0; I < NumCalls; ++I) {
+    UntypedValue Dividend, Divisor;
+    Dividend.I32 = 7 * I;
+    // every tenth call traps
+    Divisor.I32 = I % 10 == 0 ? 0 : 7;
+    Futures.push_back(Exec.submitCall(*Mod, *Handle, {Dividend, Divisor}));
+  }
+  for (int32_t I = 0; I < NumCalls; ++I) {
+    ExecutorCallResult Result = Futures[I].get();
+    if (I % 10 == 0) {
+      EXPECT_EQ(Result.ErrCode, ErrorCode::IntegerDivByZero);
+      EXPECT_TRUE(Result.Results.empty());
+    } else {
+      EXPECT_EQ(Result.ErrCode, ErrorCode::NoError);
+      ASSERT_EQ(Result.Results.size(), 1);
+      EXPECT_EQ(Result.Results[0].I32, I);
+    }
+  }
+
+  // calls on an instance created by the caller
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(*Mod);
+  ASSERT_TRUE(InstRet);
+  UntypedValue Dividend, Divisor;
+  Dividend.I32 = 42;
+  Divisor.I32 = 6;
+  ExecutorCallResult Result =
+      Exec.submitCall(**InstRet, *Handle, {Dividend, Divisor}).get();
+  EXPECT_EQ(Result.ErrCode, ErrorCode::NoError);
+  ASSERT_EQ(Result.Results.size(), 1);
+  EXPECT_EQ(Result.Results[0].I32, 7);
+
+  uint32_t NumJobs = 0;
+  std::mutex JobsMtx;
+  for (uint32_t I = 0; I < 50; ++I) {
+    Exec.submit([&](Isolation &) {
+      std::lock_guard<std::mutex> Lock(JobsMtx);
+      ++NumJobs;
+    });
+  }
+  Exec.wait();
+  EXPECT_EQ(NumJobs, 50);
+}
+
+TEST(Runtime, Metrics) {
+  using zen::utils::MetricCounter;
+  using zen::utils::MetricLatency;
+  using zen::utils::Metrics;
+  auto getLatencyCount = [](const Metrics::Snapshot &Snap,
+                            MetricLatency Metric) {
+    return Snap.Latencies[common::to_underlying(Metric)].Count;
+  };
+  auto getCounter = [](const Metrics::Snapshot &Snap, MetricCounter Metric) {
+    return Snap.Counters[common::to_underlying(Metric)];
+  };
+  Metrics::Snapshot Before = Metrics::getSnapshot();
+
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("metrics", DivWASM, sizeof(DivWASM));
+  ASSERT_TRUE(ModRet);
+  const uint8_t BadWASM[] = {0x00, 0x61, 0x73, 0x00};
+  EXPECT_FALSE(RT->loadModule("bad_metrics", BadWASM, sizeof(BadWASM)));
+  const FunctionHandle *Handle = (*ModRet)->getFunctionHandle("div");
+  ASSERT_NE(Handle, nullptr);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet, 1000);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+
+  UntypedValue Args[2];
+  UntypedValue Result;
+  Args[0].I32 = 10;
+  Args[1].I32 = 2;
+  EXPECT_TRUE(RT->callWasmFunction(Inst, *Handle, Args, &Result));
+  Args[1].I32 = 0;
+  EXPECT_FALSE(RT->callWasmFunction(Inst, *Handle, Args, &Result));
+  Inst.clearError();
+
+  Metrics::Snapshot After = Metrics::getSnapshot();
+  EXPECT_GE(getLatencyCount(After, MetricLatency::Load),
+            getLatencyCount(Before, MetricLatency::Load) + 1);
+  EXPECT_GE(getLatencyCount(After, MetricLatency::Instantiation),
+            getLatencyCount(Before, MetricLatency::Instantiation) + 1);
+  EXPECT_GE(getLatencyCount(After, MetricLatency::Execution),
+            getLatencyCount(Before, MetricLatency::Execution) + 2);
+  EXPECT_GE(getCounter(After, MetricCounter::LoadErrors),
+            getCounter(Before, MetricCounter::LoadErrors) + 1);
+  EXPECT_GE(getCounter(After, MetricCounter::Traps),
+            getCounter(Before, MetricCounter::Traps) + 1);
+  EXPECT_GE(getCounter(After, MetricCounter::GasUsed),
+            getCounter(Before, MetricCounter::GasUsed) + 1000 - Inst.getGas());
+
+  std::string Prometheus = After.toPrometheus();
+  EXPECT_NE(Prometheus.find("zen_execution_seconds_count "),
+            std::string::npos);
+  EXPECT_NE(Prometheus.find("zen_traps_total "), std::string::npos);
+  std::string JSON = After.toJSON();
+  EXPECT_EQ(JSON.front(), '{');
+  EXPECT_EQ(JSON.back(), '}');
+  EXPECT_NE(JSON.find("\"gas_used\":"), std::string::npos);
+
+  // bucket I counts the samples <= 2^I us
+  auto getBucket = [](const Metrics::Snapshot &Snap, uint32_t I) {
+    return Snap.Latencies[common::to_underlying(MetricLatency::Load)]
+        .Buckets[I];
+  };
+  Before = Metrics::getSnapshot();
+  Metrics::recordLatency(MetricLatency::Load, 1000);
+  Metrics::recordLatency(MetricLatency::Load, 1999);
+  Metrics::recordLatency(MetricLatency::Load, 2000);
+  Metrics::recordLatency(MetricLatency::Load, 2001);
+  After = Metrics::getSnapshot();
+  EXPECT_EQ(getBucket(After, 0), getBucket(Before, 0) + 1);
+  EXPECT_EQ(getBucket(After, 1), getBucket(Before, 1) + 2);
+  EXPECT_EQ(getBucket(After, 2), getBucket(Before, 2) + 1);
+}
+
+// (module
+//   (func (export "__instrumented_use_gas") (param i64))
+//   (func (export "step") (param i32) (result i32)
+//     i64.const 2 call 0 local.get 0 i32.const 1 i32.add)
+//   (func (export "run") (param i32) (result i32) (local i32)
+//     loop i64.const 3 call 0 local.get 1 call 1 local.tee 1 local.get 0
+//     i32.lt_u br_if 0 end local.get 1))
+static const uint8_t GasLoopWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0a, 0x02, 0x60,
+    0x01, 0x7e, 0x00, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x03, 0x04, 0x03, 0x00,
+    0x01, 0x01, 0x07, 0x27, 0x03, 0x16, 0x5f, 0x5f, 0x69, 0x6e, 0x73, 0x74,
+    0x72, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x65, 0x64, 0x5f, 0x75, 0x73, 0x65,
+    0x5f, 0x67, 0x61, 0x73, 0x00, 0x00, 0x04, 0x73, 0x74, 0x65, 0x70, 0x00,
+    0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x02, 0x0a, 0x29, 0x03, 0x02, 0x00,
+    0x0b, 0x0b, 0x00, 0x42, 0x02, 0x10, 0x00, 0x20, 0x00, 0x41, 0x01, 0x6a,
+    0x0b, 0x18, 0x01, 0x01, 0x7f, 0x03, 0x40, 0x42, 0x03, 0x10, 0x00, 0x20,
+    0x01, 0x10, 0x01, 0x22, 0x01, 0x20, 0x00, 0x49, 0x0d, 0x00, 0x0b, 0x20,
+    0x01, 0x0b,
+};
+
+TEST(Runtime, FunctionProfile) {
+  auto RT = createTestRuntime(false, true);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("gas_loop", GasLoopWASM, sizeof(GasLoopWASM));
+  ASSERT_TRUE(ModRet);
+  Module &Mod = **ModRet;
+  ASSERT_TRUE(Mod.isFunctionProfilingEnabled());
+  const FunctionHandle *Handle = Mod.getFunctionHandle("run");
+  ASSERT_NE(Handle, nullptr);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  uint32_t RunFuncIdx = 2 - Mod.getNumImportFunctions();
+  FunctionCounters Counters;
+  EXPECT_FALSE(Mod.getFunctionCounters(RunFuncIdx, Counters));
+
+  for (uint32_t I = 0; I < 2; ++I) {
+    auto InstRet = Iso->createInstance(Mod, 1000);
+    ASSERT_TRUE(InstRet);
+    UntypedValue Arg;
+    Arg.I32 = 5;
+    UntypedValue Result;
+    ASSERT_TRUE(RT->callWasmFunction(**InstRet, *Handle, &Arg, &Result));
+    EXPECT_EQ(Result.I32, 5);
+    EXPECT_EQ((*InstRet)->getFunctionCounters()[2].Calls, 1u);
+    ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+  }
+
+  // merged from both instances, the gas function itself never runs
+  std::vector<FunctionProfileEntry> Hot = getHotFunctions(Mod);
+  ASSERT_EQ(Hot.size(), 2u);
+  EXPECT_EQ(Hot[0].FuncIdx, 2u);
+  EXPECT_EQ(Hot[0].Counters.Calls, 2u);
+  EXPECT_EQ(Hot[0].Counters.LoopIterations, 10u);
+  EXPECT_EQ(Hot[0].Counters.SelfGas, 30u);
+  EXPECT_EQ(Hot[1].FuncIdx, 1u);
+  EXPECT_EQ(Hot[1].Counters.Calls, 10u);
+  EXPECT_EQ(Hot[1].Counters.LoopIterations, 0u);
+  EXPECT_EQ(Hot[1].Counters.SelfGas, 20u);
+  ASSERT_TRUE(Mod.getFunctionCounters(RunFuncIdx, Counters));
+  EXPECT_EQ(Counters.Calls, 2u);
+  EXPECT_EQ(Counters.LoopIterations, 10u);
+
+  std::string Report = dumpFunctionProfile(Mod);
+  size_t RunPos = Report.find("jitfunc_2 ");
+  ASSERT_NE(RunPos, std::string::npos);
+  EXPECT_LT(RunPos, Report.find("jitfunc_1 "));
+}
+
+TEST(Runtime, AdaptiveRABudget) {
+  using namespace COMPILER;
+  auto RT = createTestRuntime(false, true);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("adaptive_ra", GasLoopWASM, sizeof(GasLoopWASM));
+  ASSERT_TRUE(ModRet);
+  Module &Mod = **ModRet;
+  uint32_t GasFuncIdx = 0 - Mod.getNumImportFunctions();
+  uint32_t StepFuncIdx = 1 - Mod.getNumImportFunctions();
+  uint32_t RunFuncIdx = 2 - Mod.getNumImportFunctions();
+  // no instance has been deleted, there is no profile yet
+  EXPECT_EQ(getFunctionHotness(Mod, RunFuncIdx), FunctionHotness::Unknown);
+
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(Mod, UINT64_MAX);
+  ASSERT_TRUE(InstRet);
+  UntypedValue Arg;
+  Arg.I32 = AdaptiveRAHotThreshold / 2;
+  UntypedValue Result;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, *Mod.getFunctionHandle("run"),
+                                   &Arg, &Result));
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+  // the loop runs half the threshold, step is called as many times
+  EXPECT_EQ(getFunctionHotness(Mod, RunFuncIdx), FunctionHotness::Cold);
+  EXPECT_EQ(getFunctionHotness(Mod, StepFuncIdx), FunctionHotness::Cold);
+  EXPECT_EQ(getFunctionHotness(Mod, GasFuncIdx), FunctionHotness::Cold);
+
+  InstRet = Iso->createInstance(Mod, UINT64_MAX);
+  ASSERT_TRUE(InstRet);
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, *Mod.getFunctionHandle("run"),
+                                   &Arg, &Result));
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+  EXPECT_EQ(getFunctionHotness(Mod, RunFuncIdx), FunctionHotness::Hot);
+  EXPECT_EQ(getFunctionHotness(Mod, StepFuncIdx), FunctionHotness::Hot);
+
+  FunctionCounters Counters = {};
+  Counters.Calls = AdaptiveRAHotThreshold - 1;
+  EXPECT_EQ(getFunctionHotness(Counters), FunctionHotness::Cold);
+  Counters.LoopIterations = 1;
+  EXPECT_EQ(getFunctionHotness(Counters), FunctionHotness::Hot);
+
+  constexpr uint64_t Budget = 1000;
+  constexpr uint64_t ScaledBudget = Budget * AdaptiveRABudgetScale;
+  constexpr size_t LargeFunc = AdaptiveRAStraightLineInstrs + 1;
+  // the profile decides regardless of the shape
+  EXPECT_EQ(getAdaptiveGreedyRABudget(Budget, FunctionHotness::Cold, true, 1),
+            0u);
+  EXPECT_EQ(getAdaptiveGreedyRABudget(Budget, FunctionHotness::Hot, false,
+                                      LargeFunc),
+            ScaledBudget);
+  // unlimited budgets stay unlimited
+  EXPECT_EQ(getAdaptiveGreedyRABudget(0, FunctionHotness::Hot, false, 1),
+            UINT64_MAX);
+  // otherwise the shape does
+  EXPECT_EQ(getAdaptiveGreedyRABudget(Budget, FunctionHotness::Unknown, true,
+                                      LargeFunc),
+            ScaledBudget);
+  EXPECT_EQ(getAdaptiveGreedyRABudget(Budget, FunctionHotness::Unknown, false,
+                                      AdaptiveRAStraightLineInstrs),
+            Budget);
+  EXPECT_EQ(getAdaptiveGreedyRABudget(Budget, FunctionHotness::Unknown, false,
+                                      LargeFunc),
+            0u);
+}
+
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+// (module
+//   (func $mix (param i32) (result i32) local.get 0 i32.const 7 i32.xor)
+//   (func (export "run") (param i32 i32) (result i32) (local i32 i32)
+//     block $exit
+//       loop $outer
+//         local.get 0 i32.eqz br_if $exit
+//         local.get 0 i32.const 1 i32.sub local.set 0
+//         local.get 1 local.set 3
+//         block $next
+//           loop $inner
+//             local.get 3 i32.eqz br_if $next
+//             local.get 2 local.get 3 local.get 0 i32.mul i32.add local.set 2
+//             local.get 2 i32.const 100000 i32.gt_u br_if $exit
+//             local.get 3 i32.const 1 i32.sub local.tee 3
+//             i32.const 3 i32.rem_u
+//             if
+//               local.get 2 i32.const 1 i32.add local.set 2
+//             else
+//               local.get 2 call $mix local.set 2
+//             end
+//             br $inner
+//           end
+//         end
+//         br $outer
+//       end
+//     end
+//     local.get 2 local.get 3 i32.const 16 i32.shl i32.add))
+static const uint8_t LocalCachingWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0c, 0x02, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x03, 0x03,
+    0x02, 0x00, 0x01, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x01,
+    0x0a, 0x69, 0x02, 0x07, 0x00, 0x20, 0x00, 0x41, 0x07, 0x73, 0x0b, 0x5f,
+    0x01, 0x02, 0x7f, 0x02, 0x40, 0x03, 0x40, 0x20, 0x00, 0x45, 0x0d, 0x01,
+    0x20, 0x00, 0x41, 0x01, 0x6b, 0x21, 0x00, 0x20, 0x01, 0x21, 0x03, 0x02,
+    0x40, 0x03, 0x40, 0x20, 0x03, 0x45, 0x0d, 0x01, 0x20, 0x02, 0x20, 0x03,
+    0x20, 0x00, 0x6c, 0x6a, 0x21, 0x02, 0x20, 0x02, 0x41, 0xa0, 0x8d, 0x06,
+    0x4b, 0x0d, 0x03, 0x20, 0x03, 0x41, 0x01, 0x6b, 0x22, 0x03, 0x41, 0x03,
+    0x70, 0x04, 0x40, 0x20, 0x02, 0x41, 0x01, 0x6a, 0x21, 0x02, 0x05, 0x20,
+    0x02, 0x10, 0x00, 0x21, 0x02, 0x0b, 0x0c, 0x00, 0x0b, 0x0b, 0x0c, 0x00,
+    0x0b, 0x0b, 0x20, 0x02, 0x20, 0x03, 0x41, 0x10, 0x74, 0x6a, 0x0b,
+};
+
+static void runLocalCachingWASM(const RuntimeConfig &Config,
+                                std::vector<int32_t> &Outputs) {
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("local_caching", LocalCachingWASM,
+                               sizeof(LocalCachingWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  // the last inputs leave both loops early through br_if $exit
+  const std::pair<int32_t, int32_t> Inputs[] = {
+      {0, 0}, {1, 5}, {3, 4}, {10, 10}, {50, 7}, {100, 100}, {1000, 1000},
+  };
+  for (const auto &[Outer, Inner] : Inputs) {
+    std::vector<TypedValue> Results;
+    ASSERT_TRUE(RT->callWasmFunction(**InstRet, 1,
+                                     {makeI32(Outer), makeI32(Inner)},
+                                     Results));
+    ASSERT_EQ(Results.size(), 1u);
+    Outputs.push_back(Results[0].Value.I32);
+  }
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+// locals pinned to registers must be written back on every branch leaving
+// the loops and around the call
+TEST(Runtime, SinglepassLocalCaching) {
+  RuntimeConfig InterpConfig = getTestRuntimeConfig();
+  InterpConfig.Mode = RunMode::InterpMode;
+  std::vector<int32_t> Expected;
+  ASSERT_NO_FATAL_FAILURE(runLocalCachingWASM(InterpConfig, Expected));
+
+  RuntimeConfig Config = getTestRuntimeConfig();
+  for (bool EnableLocalCaching : {false, true}) {
+    Config.EnableSinglepassLocalCaching = EnableLocalCaching;
+    std::vector<int32_t> Outputs;
+    ASSERT_NO_FATAL_FAILURE(runLocalCachingWASM(Config, Outputs));
+    EXPECT_EQ(Outputs, Expected) << "local caching " << EnableLocalCaching;
+  }
+}
+#endif // ZEN_ENABLE_SINGLEPASS_JIT
+
+// (module (memory 1)
+//   (func (param i32) (result i32) local.get 0 memory.grow)
+//   (func (param i32 i32) local.get 0 local.get 1 i32.store)
+//   (func (param i32) (result i32) local.get 0 i32.load))
+static const uint8_t MemoryGrowWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0b, 0x02, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x00, 0x03, 0x04, 0x03,
+    0x00, 0x01, 0x00, 0x05, 0x03, 0x01, 0x00, 0x01, 0x0a, 0x1a, 0x03, 0x06,
+    0x00, 0x20, 0x00, 0x40, 0x00, 0x0b, 0x09, 0x00, 0x20, 0x00, 0x20, 0x01,
+    0x36, 0x02, 0x00, 0x0b, 0x07, 0x00, 0x20, 0x00, 0x28, 0x02, 0x00, 0x0b,
+};
+
+// an mmap backed memory owns its whole reservation, so memory.grow only
+// unprotects pages and never moves the memory
+static void testMemoryGrowInPlace(RunMode Mode) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.Mode = Mode;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet =
+      RT->loadModule("memory_grow", MemoryGrowWASM, sizeof(MemoryGrowWASM));
+  ASSERT_TRUE(ModRet);
+  bool FixedBase = (*ModRet)->checkUseFixedLinearMemoryBase();
+#ifdef ZEN_ENABLE_CPU_EXCEPTION
+  EXPECT_EQ(FixedBase, !Config.DisableWasmMemoryMap);
+#endif
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+  const uint8_t *MemBase = Inst.getDefaultMemoryInst().MemBase;
+  std::vector<TypedValue> Results;
+
+  constexpr uint32_t PageSize = 65536;
+  uint32_t NumPages = 1;
+  for (uint32_t Delta : {1u, 3u, 16u, 100u}) {
+    // the last word of every page so far, written before the grow
+    Results.clear();
+    for (uint32_t Page = 0; Page < NumPages; ++Page) {
+      ASSERT_TRUE(RT->callWasmFunction(
+          Inst, 1, {makeI32((Page + 1) * PageSize - 4), makeI32(Page + 1)},
+          Results));
+    }
+    Results.clear();
+    ASSERT_TRUE(RT->callWasmFunction(Inst, 0, {makeI32(Delta)}, Results));
+    ASSERT_EQ(Results.size(), 1u);
+    EXPECT_EQ(Results[0].Value.I32, int32_t(NumPages));
+    NumPages += Delta;
+    EXPECT_EQ(Inst.getDefaultMemoryInst().MemSize,
+              uint64_t(NumPages) * PageSize);
+    if (FixedBase) {
+      EXPECT_EQ(Inst.getDefaultMemoryInst().MemBase, MemBase);
+    }
+    for (uint32_t Page = 0; Page < NumPages; ++Page) {
+      Results.clear();
+      ASSERT_TRUE(RT->callWasmFunction(
+          Inst, 2, {makeI32((Page + 1) * PageSize - 4)}, Results));
+      ASSERT_EQ(Results.size(), 1u);
+      // pages added by this grow are zero
+      EXPECT_EQ(Results[0].Value.I32,
+                Page < NumPages - Delta ? int32_t(Page + 1) : 0)
+          << Page;
+    }
+    Results.clear();
+    // the next page is still out of bounds
+    EXPECT_FALSE(RT->callWasmFunction(
+        Inst, 2, {makeI32(NumPages * PageSize)}, Results));
+    EXPECT_EQ(Inst.getError().getCode(), ErrorCode::OutOfBoundsMemory);
+    Inst.clearError();
+  }
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+TEST(Runtime, MemoryGrowInPlace) {
+  testMemoryGrowInPlace(getTestRuntimeConfig().Mode);
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  testMemoryGrowInPlace(RunMode::SinglepassMode);
+#endif
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  testMemoryGrowInPlace(RunMode::MultipassMode);
+#endif
+}
+
+// (module
+//   (func (export "__instrumented_use_gas") (param i64))
+//   (memory 1)
+//   (func (export "run") (param i32) (result i32)
+//     i32.const 0 i32.const 0 i32.const 4 memory.init 0
+//     i32.const 16 i32.const 0xab local.get 0 memory.fill
+//     i32.const 8 i32.const 0 i32.const 4 memory.copy
+//     i32.const 8 i32.load)
+//   (data "\01\02\03\04"))
+static const uint8_t BulkMemoryWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0a, 0x02, 0x60,
+    0x01, 0x7e, 0x00, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x03, 0x03, 0x02, 0x00,
+    0x01, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x20, 0x02, 0x16, 0x5f, 0x5f,
+    0x69, 0x6e, 0x73, 0x74, 0x72, 0x75, 0x6d, 0x65, 0x6e, 0x74, 0x65, 0x64,
+    0x5f, 0x75, 0x73, 0x65, 0x5f, 0x67, 0x61, 0x73, 0x00, 0x00, 0x03, 0x72,
+    0x75, 0x6e, 0x00, 0x01, 0x0c, 0x01, 0x01, 0x0a, 0x2a, 0x02, 0x02, 0x00,
+    0x0b, 0x25, 0x00, 0x41, 0x00, 0x41, 0x00, 0x41, 0x04, 0xfc, 0x08, 0x00,
+    0x00, 0x41, 0x10, 0x41, 0xab, 0x01, 0x20, 0x00, 0xfc, 0x0b, 0x00, 0x41,
+    0x08, 0x41, 0x00, 0x41, 0x04, 0xfc, 0x0a, 0x00, 0x00, 0x41, 0x08, 0x28,
+    0x02, 0x00, 0x0b, 0x0b, 0x07, 0x01, 0x01, 0x04, 0x01, 0x02, 0x03, 0x04,
+};
+
+TEST(Runtime, BulkMemory) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet =
+      RT->loadModule("bulk_memory", BulkMemoryWASM, sizeof(BulkMemoryWASM));
+  ASSERT_TRUE(ModRet);
+  const FunctionHandle *Handle = (*ModRet)->getFunctionHandle("run");
+  ASSERT_NE(Handle, nullptr);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet, 1000);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+
+  UntypedValue Arg;
+  Arg.I32 = 100;
+  UntypedValue Result;
+  ASSERT_TRUE(RT->callWasmFunction(Inst, *Handle, &Arg, &Result));
+  EXPECT_EQ(Result.I32, 0x04030201);
+  const uint8_t *Filled =
+      static_cast<const uint8_t *>(Inst.getNativeMemoryAddr(16));
+  EXPECT_EQ(Filled[0], 0xab);
+  EXPECT_EQ(Filled[99], 0xab);
+  EXPECT_EQ(Filled[100], 0);
+  // 4 bytes for memory.init and memory.copy, 100 bytes for memory.fill
+  EXPECT_EQ(Inst.getGas(),
+            1000 - 2 * getBulkMemoryGas(4) - getBulkMemoryGas(100));
+
+  // the size based gas runs out before the out of bounds fill
+  Arg.I32 = 0x10000;
+  EXPECT_FALSE(RT->callWasmFunction(Inst, *Handle, &Arg, &Result));
+  EXPECT_EQ(Inst.getError().getCode(), ErrorCode::GasLimitExceeded);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+// (module
+//   (func (export "__instrumented_use_gas") (param i64))
+//   (memory 1)
+//   ;; 1 to 4: memory.copy of 1, 2, 4 and 8 bytes
+//   (func (param i32 i32) local.get 0 local.get 1 i32.const 1 memory.copy)
+//   ...
+//   ;; 5 to 8: memory.fill of 1, 2, 4 and 8 bytes
+//   (func (param i32) local.get 0 i32.const 0x1a5 i32.const 1 memory.fill)
+//   ...
+//   (func (param i32 i32) local.get 0 i32.const 0 local.get 1 memory.init 0)
+//   (func data.drop 0)
+//   (data "\01\02\03\04\05\06\07\08"))
+static const uint8_t BulkMemoryInlineWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x11, 0x04, 0x60,
+    0x01, 0x7e, 0x00, 0x60, 0x02, 0x7f, 0x7f, 0x00, 0x60, 0x01, 0x7f, 0x00,
+    0x60, 0x00, 0x00, 0x03, 0x0c, 0x0b, 0x00, 0x01, 0x01, 0x01, 0x01, 0x02,
+    0x02, 0x02, 0x02, 0x01, 0x03, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x1a,
+    0x01, 0x16, 0x5f, 0x5f, 0x69, 0x6e, 0x73, 0x74, 0x72, 0x75, 0x6d, 0x65,
+    0x6e, 0x74, 0x65, 0x64, 0x5f, 0x75, 0x73, 0x65, 0x5f, 0x67, 0x61, 0x73,
+    0x00, 0x00, 0x0c, 0x01, 0x01, 0x0a, 0x7f, 0x0b, 0x02, 0x00, 0x0b, 0x0c,
+    0x00, 0x20, 0x00, 0x20, 0x01, 0x41, 0x01, 0xfc, 0x0a, 0x00, 0x00, 0x0b,
+    0x0c, 0x00, 0x20, 0x00, 0x20, 0x01, 0x41, 0x02, 0xfc, 0x0a, 0x00, 0x00,
+    0x0b, 0x0c, 0x00, 0x20, 0x00, 0x20, 0x01, 0x41, 0x04, 0xfc, 0x0a, 0x00,
+    0x00, 0x0b, 0x0c, 0x00, 0x20, 0x00, 0x20, 0x01, 0x41, 0x08, 0xfc, 0x0a,
+    0x00, 0x00, 0x0b, 0x0c, 0x00, 0x20, 0x00, 0x41, 0xa5, 0x03, 0x41, 0x01,
+    0xfc, 0x0b, 0x00, 0x0b, 0x0c, 0x00, 0x20, 0x00, 0x41, 0xa5, 0x03, 0x41,
+    0x02, 0xfc, 0x0b, 0x00, 0x0b, 0x0c, 0x00, 0x20, 0x00, 0x41, 0xa5, 0x03,
+    0x41, 0x04, 0xfc, 0x0b, 0x00, 0x0b, 0x0c, 0x00, 0x20, 0x00, 0x41, 0xa5,
+    0x03, 0x41, 0x08, 0xfc, 0x0b, 0x00, 0x0b, 0x0c, 0x00, 0x20, 0x00, 0x41,
+    0x00, 0x20, 0x01, 0xfc, 0x08, 0x00, 0x00, 0x0b, 0x05, 0x00, 0xfc, 0x09,
+    0x00, 0x0b, 0x0b, 0x0b, 0x01, 0x01, 0x08, 0x01, 0x02, 0x03, 0x04, 0x05,
+    0x06, 0x07, 0x08,
+};
+
+// the jits copy and fill constant lengths of 1, 2, 4 and 8 bytes inline
+static void testBulkMemoryInline(RunMode Mode) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.Mode = Mode;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("bulk_memory_inline", BulkMemoryInlineWASM,
+                               sizeof(BulkMemoryInlineWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet, 1000);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+  auto Mem = [&](uint32_t Offset) {
+    return static_cast<uint8_t *>(Inst.getNativeMemoryAddr(Offset));
+  };
+  auto Call = [&](uint32_t FuncIdx, std::vector<TypedValue> Args) {
+    std::vector<TypedValue> Results;
+    bool Ok = RT->callWasmFunction(Inst, FuncIdx, Args, Results);
+    if (!Ok) {
+      EXPECT_EQ(Inst.getError().getCode(), ErrorCode::OutOfBoundsMemory);
+      Inst.clearError();
+    }
+    return Ok;
+  };
+
+  const uint8_t Pattern[16] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66,
+                               0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc,
+                               0xdd, 0xee, 0xff, 0x10};
+  std::memcpy(Mem(0x100), Pattern, sizeof(Pattern));
+  const uint32_t Sizes[] = {1, 2, 4, 8};
+  for (uint32_t I = 0; I < 4; ++I) {
+    uint32_t Size = Sizes[I];
+    uint64_t Gas = Inst.getGas();
+    ASSERT_TRUE(Call(1 + I, {makeI32(0x200 + 16 * I), makeI32(0x100)}));
+    EXPECT_EQ(std::memcmp(Mem(0x200 + 16 * I), Pattern, Size), 0) << Size;
+    EXPECT_EQ(Mem(0x200 + 16 * I)[Size], 0) << Size;
+    ASSERT_TRUE(Call(5 + I, {makeI32(0x300 + 16 * I)}));
+    for (uint32_t J = 0; J < Size; ++J) {
+      EXPECT_EQ(Mem(0x300 + 16 * I)[J], 0xa5) << Size;
+    }
+    EXPECT_EQ(Mem(0x300 + 16 * I)[Size], 0) << Size;
+    EXPECT_EQ(Inst.getGas(), Gas - 2 * getBulkMemoryGas(Size)) << Size;
+
+    // the whole access is checked before anything is written
+    EXPECT_FALSE(Call(1 + I, {makeI32(0x10001 - Size), makeI32(0x100)}));
+    EXPECT_FALSE(Call(1 + I, {makeI32(0x200), makeI32(0x10001 - Size)}));
+    EXPECT_FALSE(Call(5 + I, {makeI32(0x10001 - Size)}));
+    EXPECT_FALSE(Call(5 + I, {makeI32(-1)}));
+    EXPECT_EQ(std::memcmp(Mem(0x200 + 16 * I), Pattern, Size), 0) << Size;
+    for (uint32_t J = 0x10000 - Size; J < 0x10000; ++J) {
+      EXPECT_EQ(*Mem(J), 0) << Size;
+    }
+  }
+
+  // an overlapping copy moves the source as it was
+  ASSERT_TRUE(Call(4, {makeI32(0x101), makeI32(0x100)}));
+  EXPECT_EQ(std::memcmp(Mem(0x101), Pattern, 8), 0);
+  EXPECT_EQ(*Mem(0x100), Pattern[0]);
+
+  // a dropped passive segment only allows empty inits
+  ASSERT_TRUE(Call(9, {makeI32(0x400), makeI32(8)}));
+  EXPECT_EQ(*Mem(0x407), 8);
+  ASSERT_TRUE(Call(10, {}));
+  ASSERT_TRUE(Call(10, {}));
+  EXPECT_TRUE(Call(9, {makeI32(0x500), makeI32(0)}));
+  EXPECT_FALSE(Call(9, {makeI32(0x500), makeI32(1)}));
+  EXPECT_EQ(*Mem(0x500), 0);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+TEST(Runtime, BulkMemoryInline) {
+  testBulkMemoryInline(getTestRuntimeConfig().Mode);
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  testBulkMemoryInline(RunMode::SinglepassMode);
+#endif
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  testBulkMemoryInline(RunMode::MultipassMode);
+#endif
+}
+
+// (module (memory 1) (func data.drop 0) (data "")) without the data count
+// section
+static const uint8_t DataDropNoDataCountWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x04, 0x01, 0x60,
+    0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0x05, 0x03, 0x01, 0x00, 0x01, 0x0a,
+    0x07, 0x01, 0x05, 0x00, 0xfc, 0x09, 0x00, 0x0b, 0x0b, 0x03, 0x01, 0x01,
+    0x00,
+};
+
+// (module (memory 1) (func data.drop 1) (data ""))
+static const uint8_t DataDropUnknownSegmentWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x04, 0x01, 0x60,
+    0x00, 0x00, 0x03, 0x02, 0x01, 0x00, 0x05, 0x03, 0x01, 0x00, 0x01, 0x0c,
+    0x01, 0x01, 0x0a, 0x07, 0x01, 0x05, 0x00, 0xfc, 0x09, 0x01, 0x0b, 0x0b,
+    0x03, 0x01, 0x01, 0x00,
+};
+
+TEST(Runtime, BulkMemoryValidation) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("no_data_count", DataDropNoDataCountWASM,
+                               sizeof(DataDropNoDataCountWASM));
+  ASSERT_FALSE(ModRet);
+  EXPECT_EQ(ModRet.getError().getCode(), ErrorCode::DataCountSectionRequired);
+  ModRet = RT->loadModule("unknown_data_segment", DataDropUnknownSegmentWASM,
+                          sizeof(DataDropUnknownSegmentWASM));
+  ASSERT_FALSE(ModRet);
+  EXPECT_EQ(ModRet.getError().getCode(), ErrorCode::UnknownDataSegment);
+}
+
+// (module (memory 1) (func (export "run") (param i32) (result i32)
+//   (local v128)
+//   i32.const 0 v128.const i32x4 1 2 3 4 v128.store
+//   local.get 0 i32x4.splat i32.const 0 v128.load i32x4.add
+//   local.tee 1 local.get 1 i32x4.mul i32x4.extract_lane 3))
+static const uint8_t SIMDWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x05, 0x03, 0x01, 0x00,
+    0x01, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x00, 0x0a, 0x35,
+    0x01, 0x33, 0x01, 0x01, 0x7b, 0x41, 0x00, 0xfd, 0x0c, 0x01, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00,
+    0x00, 0xfd, 0x0b, 0x04, 0x00, 0x20, 0x00, 0xfd, 0x11, 0x41, 0x00, 0xfd,
+    0x00, 0x04, 0x00, 0xfd, 0xae, 0x01, 0x22, 0x01, 0x20, 0x01, 0xfd, 0xb5,
+    0x01, 0xfd, 0x1b, 0x03, 0x0b,
+};
+
+// (module (memory 1) (data (i32.const 0) "\01\02\03\04\05\06\07\08")
+//   (func (export "run") (param f32) (result i32)
+//     i32.const 16
+//     local.get 0 f32x4.splat f32.const 2.5 f32x4.splat f32x4.mul
+//     i32x4.trunc_sat_f32x4_s
+//     i32.const 0 v128.load8x8_u i32x4.extend_low_i16x8_u i32x4.add
+//     v128.store32_lane 3
+//     i32.const 16 i32.load))
+static const uint8_t ExtendedSIMDWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01, 0x60,
+    0x01, 0x7d, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x05, 0x03, 0x01, 0x00,
+    0x01, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x00, 0x0a, 0x2d,
+    0x01, 0x2b, 0x00, 0x41, 0x10, 0x20, 0x00, 0xfd, 0x13, 0x43, 0x00, 0x00,
+    0x20, 0x40, 0xfd, 0x13, 0xfd, 0xe6, 0x01, 0xfd, 0xf8, 0x01, 0x41, 0x00,
+    0xfd, 0x02, 0x03, 0x00, 0xfd, 0xa9, 0x01, 0xfd, 0xae, 0x01, 0xfd, 0x5a,
+    0x02, 0x00, 0x03, 0x41, 0x10, 0x28, 0x02, 0x00, 0x0b, 0x0b, 0x0e, 0x01,
+    0x00, 0x41, 0x00, 0x0b, 0x08, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08,
+};
+
+// the ops the multipass jit lowers, the data at 256 are a, b and the swizzle
+// indices, the f32 and f64 lanes at 304 are a few exact values
+// (module (memory 1)
+//   (data (i32.const 256)
+//     "\00\01\7f\80\ff\fe\10\90\33\c4\55\aa\01\80\ff\7f"
+//     "\01\ff\01\01\ff\80\f0\10\44\cc\80\7f\02\7f\00\80"
+//     "\0f\00\10\c8\03\03\08\ff\01\02\11\07\06\05\04\80")
+//   (data (i32.const 304)
+//     "\00\00\c0\3f\00\00\00\c0\00\00\10\41\00\00\80\3e"
+//     "\00\00\00\40\00\00\00\3f\00\00\40\c0\00\00\80\40"
+//     "\00\00\00\00\00\00\02\40\52\af\de\de\4b\e3\c7\d5"
+//     "\00\00\00\00\00\00\10\40\00\00\00\20\5f\a0\02\42")
+//   (func (export "permute")
+//     (local v128 v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 288 v128.load local.set 2
+//     i32.const 0 local.get 0 local.get 1
+//     i8x16.shuffle 0 17 2 19 31 30 5 4 16 8 9 24 12 28 14 15 v128.store
+//     i32.const 16 local.get 0 local.get 2
+//     i8x16.swizzle v128.store)
+//   (func (export "shift") (param i32)
+//     i32.const 0 i32.const 256 v128.load local.get 0 i16x8.shl v128.store
+//     i32.const 16 i32.const 256 v128.load local.get 0 i16x8.shr_s
+//       v128.store
+//     i32.const 32 i32.const 256 v128.load local.get 0 i16x8.shr_u
+//       v128.store
+//     i32.const 48 i32.const 256 v128.load local.get 0 i32x4.shl v128.store
+//     i32.const 64 i32.const 256 v128.load local.get 0 i32x4.shr_s
+//       v128.store
+//     i32.const 80 i32.const 256 v128.load local.get 0 i32x4.shr_u
+//       v128.store
+//     i32.const 96 i32.const 256 v128.load local.get 0 i64x2.shl v128.store
+//     i32.const 112 i32.const 256 v128.load local.get 0 i64x2.shr_s
+//       v128.store
+//     i32.const 128 i32.const 256 v128.load local.get 0 i64x2.shr_u
+//       v128.store)
+//   (func (export "mask") (result i32)
+//     (local v128 v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 288 v128.load local.set 2
+//     local.get 0 i8x16.bitmask
+//     local.get 1 i16x8.bitmask i32.const 16 i32.shl i32.or
+//     local.get 0 i32x4.bitmask i32.const 24 i32.shl i32.or
+//     local.get 1 i64x2.bitmask i32.const 28 i32.shl i32.or
+//     local.get 2 i8x16.all_true i32.const 30 i32.shl i32.or
+//     local.get 0 i8x16.all_true i32.const 31 i32.shl i32.or)
+//   (func (export "all_true") (result i32)
+//     (local v128 v128 v128 v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 288 v128.load local.set 2
+//     i32.const 320 v128.load local.set 3
+//     i32.const 304 v128.load local.set 4
+//     local.get 0 i16x8.all_true
+//     local.get 1 i16x8.all_true i32.const 1 i32.shl i32.or
+//     local.get 0 i32x4.all_true i32.const 2 i32.shl i32.or
+//     local.get 2 i32x4.all_true i32.const 3 i32.shl i32.or
+//     local.get 1 i64x2.all_true i32.const 4 i32.shl i32.or
+//     local.get 3 i64x2.all_true i32.const 5 i32.shl i32.or
+//     local.get 4 v128.any_true i32.const 6 i32.shl i32.or)
+//   (func (export "extmul")
+//     (local v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 0 local.get 0 local.get 1
+//     i64x2.extmul_low_i32x4_s v128.store
+//     i32.const 16 local.get 0 local.get 1
+//     i64x2.extmul_high_i32x4_s v128.store
+//     i32.const 32 local.get 0 local.get 1
+//     i64x2.extmul_low_i32x4_u v128.store
+//     i32.const 48 local.get 0 local.get 1
+//     i64x2.extmul_high_i32x4_u v128.store)
+//   (func (export "saturate")
+//     (local v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 0 local.get 0 local.get 1
+//     i8x16.add_sat_s v128.store
+//     i32.const 16 local.get 0 local.get 1
+//     i8x16.sub_sat_u v128.store
+//     i32.const 32 local.get 0 local.get 1
+//     i16x8.add_sat_u v128.store
+//     i32.const 48 local.get 0 local.get 1
+//     i16x8.sub_sat_s v128.store
+//     i32.const 64 local.get 0 local.get 1
+//     i8x16.avgr_u v128.store
+//     i32.const 80 local.get 0 local.get 1
+//     i16x8.avgr_u v128.store)
+//   (func (export "compare")
+//     (local v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 0 local.get 0 local.get 1
+//     i8x16.lt_u v128.store
+//     i32.const 16 local.get 0 local.get 1
+//     i8x16.ge_s v128.store
+//     i32.const 32 local.get 0 local.get 1
+//     i16x8.gt_u v128.store
+//     i32.const 48 local.get 0 local.get 1
+//     i16x8.le_s v128.store
+//     i32.const 64 local.get 0 local.get 1
+//     i32x4.le_u v128.store
+//     i32.const 80 local.get 0 local.get 1
+//     i32x4.ge_u v128.store
+//     i32.const 96 local.get 0 local.get 0
+//     i32x4.lt_u v128.store
+//     i32.const 112 local.get 0 local.get 0
+//     i8x16.le_u v128.store)
+//   (func (export "extend")
+//     i32.const 0 i32.const 256 v128.load i16x8.extend_low_i8x16_s
+//       v128.store
+//     i32.const 16 i32.const 256 v128.load i16x8.extend_high_i8x16_u
+//       v128.store
+//     i32.const 32 i32.const 256 v128.load i32x4.extend_high_i16x8_s
+//       v128.store
+//     i32.const 48 i32.const 256 v128.load i32x4.extend_low_i16x8_u
+//       v128.store
+//     i32.const 64 i32.const 256 v128.load i64x2.extend_high_i32x4_s
+//       v128.store
+//     i32.const 80 i32.const 256 v128.load i64x2.extend_low_i32x4_u
+//       v128.store)
+//   (func (export "narrow")
+//     (local v128 v128)
+//     i32.const 256 v128.load local.set 0
+//     i32.const 272 v128.load local.set 1
+//     i32.const 0 local.get 0 local.get 1
+//     i8x16.narrow_i16x8_s v128.store
+//     i32.const 16 local.get 0 local.get 1
+//     i8x16.narrow_i16x8_u v128.store
+//     i32.const 32 local.get 0 local.get 1
+//     i16x8.narrow_i32x4_s v128.store
+//     i32.const 48 local.get 0 local.get 1
+//     i16x8.narrow_i32x4_u v128.store)
+//   (func (export "float")
+//     (local v128 v128 v128 v128)
+//     i32.const 304 v128.load local.set 0
+//     i32.const 320 v128.load local.set 1
+//     i32.const 336 v128.load local.set 2
+//     i32.const 352 v128.load local.set 3
+//     i32.const 0 local.get 0 local.get 1
+//     f32x4.add v128.store
+//     i32.const 16 local.get 0 local.get 1
+//     f32x4.sub v128.store
+//     i32.const 32 local.get 0 local.get 1
+//     f32x4.mul v128.store
+//     i32.const 48 local.get 0 local.get 1
+//     f32x4.div v128.store
+//     i32.const 64 local.get 0 f32x4.abs f32x4.sqrt v128.store
+//     i32.const 80 local.get 0 f32x4.neg v128.store
+//     i32.const 96 local.get 0 local.get 1
+//     f32x4.pmin v128.store
+//     i32.const 112 local.get 0 local.get 1
+//     f32x4.pmax v128.store
+//     i32.const 128 local.get 2 local.get 3
+//     f64x2.add v128.store
+//     i32.const 144 local.get 2 local.get 3
+//     f64x2.sub v128.store
+//     i32.const 160 local.get 2 local.get 3
+//     f64x2.mul v128.store
+//     i32.const 176 local.get 2 local.get 3
+//     f64x2.div v128.store
+//     i32.const 192 local.get 3 f64x2.sqrt v128.store
+//     i32.const 208 local.get 2 f64x2.abs v128.store
+//     i32.const 224 local.get 2 f64x2.neg v128.store)
+//   (func (export "load") (param i32)
+//     i32.const 0 local.get 0 v128.load8_splat offset=1 v128.store
+//     i32.const 16 local.get 0 v128.load16_splat offset=2 v128.store
+//     i32.const 32 local.get 0 v128.load32_splat offset=4 v128.store
+//     i32.const 48 local.get 0 v128.load64_splat offset=8 v128.store
+//     i32.const 64 local.get 0 v128.load32_zero offset=12 v128.store
+//     i32.const 80 local.get 0 v128.load64_zero offset=16 v128.store
+//     i32.const 96 local.get 0 v128.load8x8_s v128.store
+//     i32.const 112 local.get 0 v128.load8x8_u offset=8 v128.store
+//     i32.const 128 local.get 0 v128.load16x4_s offset=4 v128.store
+//     i32.const 144 local.get 0 v128.load32x2_u offset=8 v128.store))
+static const uint8_t LoweredSIMDWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0c, 0x03, 0x60,
+    0x00, 0x00, 0x60, 0x01, 0x7f, 0x00, 0x60, 0x00, 0x01, 0x7f, 0x03, 0x0c,
+    0x0b, 0x00, 0x01, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x64, 0x0b, 0x07, 0x70, 0x65, 0x72,
+    0x6d, 0x75, 0x74, 0x65, 0x00, 0x00, 0x05, 0x73, 0x68, 0x69, 0x66, 0x74,
+    0x00, 0x01, 0x04, 0x6d, 0x61, 0x73, 0x6b, 0x00, 0x02, 0x08, 0x61, 0x6c,
+    0x6c, 0x5f, 0x74, 0x72, 0x75, 0x65, 0x00, 0x03, 0x06, 0x65, 0x78, 0x74,
+    0x6d, 0x75, 0x6c, 0x00, 0x04, 0x08, 0x73, 0x61, 0x74, 0x75, 0x72, 0x61,
+    0x74, 0x65, 0x00, 0x05, 0x07, 0x63, 0x6f, 0x6d, 0x70, 0x61, 0x72, 0x65,
+    0x00, 0x06, 0x06, 0x65, 0x78, 0x74, 0x65, 0x6e, 0x64, 0x00, 0x07, 0x06,
+    0x6e, 0x61, 0x72, 0x72, 0x6f, 0x77, 0x00, 0x08, 0x05, 0x66, 0x6c, 0x6f,
+    0x61, 0x74, 0x00, 0x09, 0x04, 0x6c, 0x6f, 0x61, 0x64, 0x00, 0x0a, 0x0a,
+    0xfa, 0x09, 0x0b, 0x47, 0x01, 0x03, 0x7b, 0x41, 0x80, 0x02, 0xfd, 0x00,
+    0x04, 0x00, 0x21, 0x00, 0x41, 0x90, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21,
+    0x01, 0x41, 0xa0, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x02, 0x41, 0x00,
+    0x20, 0x00, 0x20, 0x01, 0xfd, 0x0d, 0x00, 0x11, 0x02, 0x13, 0x1f, 0x1e,
+    0x05, 0x04, 0x10, 0x08, 0x09, 0x18, 0x0c, 0x1c, 0x0e, 0x0f, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x10, 0x20, 0x00, 0x20, 0x02, 0xfd, 0x0e, 0xfd, 0x0b,
+    0x04, 0x00, 0x0b, 0xa9, 0x01, 0x00, 0x41, 0x00, 0x41, 0x80, 0x02, 0xfd,
+    0x00, 0x04, 0x00, 0x20, 0x00, 0xfd, 0x8b, 0x01, 0xfd, 0x0b, 0x04, 0x00,
+    0x41, 0x10, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x20, 0x00, 0xfd,
+    0x8c, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x20, 0x41, 0x80, 0x02, 0xfd,
+    0x00, 0x04, 0x00, 0x20, 0x00, 0xfd, 0x8d, 0x01, 0xfd, 0x0b, 0x04, 0x00,
+    0x41, 0x30, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x20, 0x00, 0xfd,
+    0xab, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xc0, 0x00, 0x41, 0x80, 0x02,
+    0xfd, 0x00, 0x04, 0x00, 0x20, 0x00, 0xfd, 0xac, 0x01, 0xfd, 0x0b, 0x04,
+    0x00, 0x41, 0xd0, 0x00, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x20,
+    0x00, 0xfd, 0xad, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xe0, 0x00, 0x41,
+    0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x20, 0x00, 0xfd, 0xcb, 0x01, 0xfd,
+    0x0b, 0x04, 0x00, 0x41, 0xf0, 0x00, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04,
+    0x00, 0x20, 0x00, 0xfd, 0xcc, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x80,
+    0x01, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x20, 0x00, 0xfd, 0xcd,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x0b, 0x4e, 0x01, 0x03, 0x7b, 0x41, 0x80,
+    0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x00, 0x41, 0x90, 0x02, 0xfd, 0x00,
+    0x04, 0x00, 0x21, 0x01, 0x41, 0xa0, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21,
+    0x02, 0x20, 0x00, 0xfd, 0x64, 0x20, 0x01, 0xfd, 0x84, 0x01, 0x41, 0x10,
+    0x74, 0x72, 0x20, 0x00, 0xfd, 0xa4, 0x01, 0x41, 0x18, 0x74, 0x72, 0x20,
+    0x01, 0xfd, 0xc4, 0x01, 0x41, 0x1c, 0x74, 0x72, 0x20, 0x02, 0xfd, 0x63,
+    0x41, 0x1e, 0x74, 0x72, 0x20, 0x00, 0xfd, 0x63, 0x41, 0x1f, 0x74, 0x72,
+    0x0b, 0x6b, 0x01, 0x05, 0x7b, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00,
+    0x21, 0x00, 0x41, 0x90, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x01, 0x41,
+    0xa0, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x02, 0x41, 0xc0, 0x02, 0xfd,
+    0x00, 0x04, 0x00, 0x21, 0x03, 0x41, 0xb0, 0x02, 0xfd, 0x00, 0x04, 0x00,
+    0x21, 0x04, 0x20, 0x00, 0xfd, 0x83, 0x01, 0x20, 0x01, 0xfd, 0x83, 0x01,
+    0x41, 0x01, 0x74, 0x72, 0x20, 0x00, 0xfd, 0xa3, 0x01, 0x41, 0x02, 0x74,
+    0x72, 0x20, 0x02, 0xfd, 0xa3, 0x01, 0x41, 0x03, 0x74, 0x72, 0x20, 0x01,
+    0xfd, 0xc3, 0x01, 0x41, 0x04, 0x74, 0x72, 0x20, 0x03, 0xfd, 0xc3, 0x01,
+    0x41, 0x05, 0x74, 0x72, 0x20, 0x04, 0xfd, 0x53, 0x41, 0x06, 0x74, 0x72,
+    0x0b, 0x4a, 0x01, 0x02, 0x7b, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00,
+    0x21, 0x00, 0x41, 0x90, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x01, 0x41,
+    0x00, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xdc, 0x01, 0xfd, 0x0b, 0x04, 0x00,
+    0x41, 0x10, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xdd, 0x01, 0xfd, 0x0b, 0x04,
+    0x00, 0x41, 0x20, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xde, 0x01, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x30, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xdf, 0x01, 0xfd,
+    0x0b, 0x04, 0x00, 0x0b, 0x63, 0x01, 0x02, 0x7b, 0x41, 0x80, 0x02, 0xfd,
+    0x00, 0x04, 0x00, 0x21, 0x00, 0x41, 0x90, 0x02, 0xfd, 0x00, 0x04, 0x00,
+    0x21, 0x01, 0x41, 0x00, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x6f, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x10, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x73, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x20, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x90, 0x01, 0xfd,
+    0x0b, 0x04, 0x00, 0x41, 0x30, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x92, 0x01,
+    0xfd, 0x0b, 0x04, 0x00, 0x41, 0xc0, 0x00, 0x20, 0x00, 0x20, 0x01, 0xfd,
+    0x7b, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xd0, 0x00, 0x20, 0x00, 0x20, 0x01,
+    0xfd, 0x9b, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x0b, 0x7a, 0x01, 0x02, 0x7b,
+    0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x00, 0x41, 0x90, 0x02,
+    0xfd, 0x00, 0x04, 0x00, 0x21, 0x01, 0x41, 0x00, 0x20, 0x00, 0x20, 0x01,
+    0xfd, 0x26, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x10, 0x20, 0x00, 0x20, 0x01,
+    0xfd, 0x2b, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x20, 0x20, 0x00, 0x20, 0x01,
+    0xfd, 0x32, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x30, 0x20, 0x00, 0x20, 0x01,
+    0xfd, 0x33, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xc0, 0x00, 0x20, 0x00, 0x20,
+    0x01, 0xfd, 0x3e, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xd0, 0x00, 0x20, 0x00,
+    0x20, 0x01, 0xfd, 0x40, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xe0, 0x00, 0x20,
+    0x00, 0x20, 0x00, 0xfd, 0x3a, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xf0, 0x00,
+    0x20, 0x00, 0x20, 0x00, 0xfd, 0x2a, 0xfd, 0x0b, 0x04, 0x00, 0x0b, 0x64,
+    0x00, 0x41, 0x00, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0xfd, 0x87,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x10, 0x41, 0x80, 0x02, 0xfd, 0x00,
+    0x04, 0x00, 0xfd, 0x8a, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x20, 0x41,
+    0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0xfd, 0xa8, 0x01, 0xfd, 0x0b, 0x04,
+    0x00, 0x41, 0x30, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0xfd, 0xa9,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xc0, 0x00, 0x41, 0x80, 0x02, 0xfd,
+    0x00, 0x04, 0x00, 0xfd, 0xc8, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xd0,
+    0x00, 0x41, 0x80, 0x02, 0xfd, 0x00, 0x04, 0x00, 0xfd, 0xc9, 0x01, 0xfd,
+    0x0b, 0x04, 0x00, 0x0b, 0x48, 0x01, 0x02, 0x7b, 0x41, 0x80, 0x02, 0xfd,
+    0x00, 0x04, 0x00, 0x21, 0x00, 0x41, 0x90, 0x02, 0xfd, 0x00, 0x04, 0x00,
+    0x21, 0x01, 0x41, 0x00, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x65, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x10, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x66, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x20, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x85, 0x01, 0xfd,
+    0x0b, 0x04, 0x00, 0x41, 0x30, 0x20, 0x00, 0x20, 0x01, 0xfd, 0x86, 0x01,
+    0xfd, 0x0b, 0x04, 0x00, 0x0b, 0xef, 0x01, 0x01, 0x04, 0x7b, 0x41, 0xb0,
+    0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x00, 0x41, 0xc0, 0x02, 0xfd, 0x00,
+    0x04, 0x00, 0x21, 0x01, 0x41, 0xd0, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21,
+    0x02, 0x41, 0xe0, 0x02, 0xfd, 0x00, 0x04, 0x00, 0x21, 0x03, 0x41, 0x00,
+    0x20, 0x00, 0x20, 0x01, 0xfd, 0xe4, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41,
+    0x10, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xe5, 0x01, 0xfd, 0x0b, 0x04, 0x00,
+    0x41, 0x20, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xe6, 0x01, 0xfd, 0x0b, 0x04,
+    0x00, 0x41, 0x30, 0x20, 0x00, 0x20, 0x01, 0xfd, 0xe7, 0x01, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0xc0, 0x00, 0x20, 0x00, 0xfd, 0xe0, 0x01, 0xfd, 0xe3,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xd0, 0x00, 0x20, 0x00, 0xfd, 0xe1,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xe0, 0x00, 0x20, 0x00, 0x20, 0x01,
+    0xfd, 0xea, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xf0, 0x00, 0x20, 0x00,
+    0x20, 0x01, 0xfd, 0xeb, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x80, 0x01,
+    0x20, 0x02, 0x20, 0x03, 0xfd, 0xf0, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41,
+    0x90, 0x01, 0x20, 0x02, 0x20, 0x03, 0xfd, 0xf1, 0x01, 0xfd, 0x0b, 0x04,
+    0x00, 0x41, 0xa0, 0x01, 0x20, 0x02, 0x20, 0x03, 0xfd, 0xf2, 0x01, 0xfd,
+    0x0b, 0x04, 0x00, 0x41, 0xb0, 0x01, 0x20, 0x02, 0x20, 0x03, 0xfd, 0xf3,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xc0, 0x01, 0x20, 0x03, 0xfd, 0xef,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xd0, 0x01, 0x20, 0x02, 0xfd, 0xec,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xe0, 0x01, 0x20, 0x02, 0xfd, 0xed,
+    0x01, 0xfd, 0x0b, 0x04, 0x00, 0x0b, 0x80, 0x01, 0x00, 0x41, 0x00, 0x20,
+    0x00, 0xfd, 0x07, 0x00, 0x01, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x10, 0x20,
+    0x00, 0xfd, 0x08, 0x01, 0x02, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x20, 0x20,
+    0x00, 0xfd, 0x09, 0x02, 0x04, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0x30, 0x20,
+    0x00, 0xfd, 0x0a, 0x03, 0x08, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xc0, 0x00,
+    0x20, 0x00, 0xfd, 0x5c, 0x02, 0x0c, 0xfd, 0x0b, 0x04, 0x00, 0x41, 0xd0,
+    0x00, 0x20, 0x00, 0xfd, 0x5d, 0x03, 0x10, 0xfd, 0x0b, 0x04, 0x00, 0x41,
+    0xe0, 0x00, 0x20, 0x00, 0xfd, 0x01, 0x03, 0x00, 0xfd, 0x0b, 0x04, 0x00,
+    0x41, 0xf0, 0x00, 0x20, 0x00, 0xfd, 0x02, 0x03, 0x08, 0xfd, 0x0b, 0x04,
+    0x00, 0x41, 0x80, 0x01, 0x20, 0x00, 0xfd, 0x03, 0x03, 0x04, 0xfd, 0x0b,
+    0x04, 0x00, 0x41, 0x90, 0x01, 0x20, 0x00, 0xfd, 0x06, 0x03, 0x08, 0xfd,
+    0x0b, 0x04, 0x00, 0x0b, 0x0b, 0x7d, 0x02, 0x00, 0x41, 0x80, 0x02, 0x0b,
+    0x30, 0x00, 0x01, 0x7f, 0x80, 0xff, 0xfe, 0x10, 0x90, 0x33, 0xc4, 0x55,
+    0xaa, 0x01, 0x80, 0xff, 0x7f, 0x01, 0xff, 0x01, 0x01, 0xff, 0x80, 0xf0,
+    0x10, 0x44, 0xcc, 0x80, 0x7f, 0x02, 0x7f, 0x00, 0x80, 0x0f, 0x00, 0x10,
+    0xc8, 0x03, 0x03, 0x08, 0xff, 0x01, 0x02, 0x11, 0x07, 0x06, 0x05, 0x04,
+    0x80, 0x00, 0x41, 0xb0, 0x02, 0x0b, 0x40, 0x00, 0x00, 0xc0, 0x3f, 0x00,
+    0x00, 0x00, 0xc0, 0x00, 0x00, 0x10, 0x41, 0x00, 0x00, 0x80, 0x3e, 0x00,
+    0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x3f, 0x00, 0x00, 0x40, 0xc0, 0x00,
+    0x00, 0x80, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x40, 0x52,
+    0xaf, 0xde, 0xde, 0x4b, 0xe3, 0xc7, 0xd5, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x10, 0x40, 0x00, 0x00, 0x00, 0x20, 0x5f, 0xa0, 0x02, 0x42,
+};
+
+static void testSIMD(RunMode Mode) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.Mode = Mode;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("simd", SIMDWASM, sizeof(SIMDWASM));
+  ASSERT_TRUE(ModRet);
+  auto ExtModRet = RT->loadModule("extended_simd", ExtendedSIMDWASM,
+                                  sizeof(ExtendedSIMDWASM));
+  ASSERT_TRUE(ExtModRet);
+  auto LoweredModRet = RT->loadModule("lowered_simd", LoweredSIMDWASM,
+                                      sizeof(LoweredSIMDWASM));
+  ASSERT_TRUE(LoweredModRet);
+  // the singlepass jit has no v128 support, the multipass jit doesn't lower
+  // the lane loads and stores, conversions and a few other ops
+  if (Mode == RunMode::SinglepassMode) {
+    EXPECT_EQ((*ModRet)->getRunMode(), RunMode::InterpMode);
+    EXPECT_EQ((*LoweredModRet)->getRunMode(), RunMode::InterpMode);
+  } else {
+    EXPECT_EQ((*LoweredModRet)->getRunMode(), Mode);
+  }
+  if (Mode != RunMode::InterpMode) {
+    EXPECT_EQ((*ExtModRet)->getRunMode(), RunMode::InterpMode);
+  }
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 0, {makeI32(10)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, 14 * 14);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+
+  InstRet = Iso->createInstance(**ExtModRet);
+  ASSERT_TRUE(InstRet);
+  // lane 3 is trunc(x * 2.5) plus the zero extended byte 4
+  for (auto [Arg, Expected] : {std::pair<float, int32_t>{10.0f, 29},
+                               {-3.0f, -3},
+                               {NAN, 4},
+                               {-INFINITY, INT32_MIN + 4}}) {
+    Results.clear();
+    ASSERT_TRUE(RT->callWasmFunction(**InstRet, 0, {makeF32(Arg)}, Results));
+    ASSERT_EQ(Results.size(), 1u);
+    EXPECT_EQ(Results[0].Value.I32, Expected) << Arg;
+  }
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+
+  struct LoweredSIMDCall {
+    const char *Name;
+    std::vector<std::string> Args;
+    // the v128 results each export stores from address 0
+    std::vector<const char *> Stored;
+  };
+  // the shift counts are taken modulo the lane width, i64x2.shr_s is
+  // emulated by sse
+  static const LoweredSIMDCall Calls[] = {
+      {"permute", {},
+       {"00ff7f018000feff0133c4440102ff7f",
+        "7f00000080803300017f009010feff00"}},
+      {"shift", {"3"},
+       {"0008f803f8f780809821a8520800f8ff",
+        "20000ff0dfff02f286f84af500f0ff0f",
+        "20000f10df1f021286184a150010ff0f",
+        "0008f803f8f787809821ae520800fcff",
+        "20e00ff0df1f02f286b84af500f0ff0f",
+        "20e00f10df1f021286b84a1500f0ff0f",
+        "0008f803fcf787809821ae520d00fcff",
+        "20e00ff0df1f02f286b84a3500f0ff0f",
+        "20e00ff0df1f021286b84a3500f0ff0f"}},
+      {"shift", {"63"},
+       {"00000080008000000080008000800080",
+        "0000ffffffffffffffffffffffff0000",
+        "00000100010001000100010001000000",
+        "00000000000000800000008000000080",
+        "ffffffffffffffffffffffff00000000",
+        "01000000010000000100000000000000",
+        "00000000000000000000000000000080",
+        "ffffffffffffffff0000000000000000",
+        "01000000000000000000000000000000"}},
+      {"shift", {"69"},
+       {"0020e00fe0df00026086a04a2000e0ff",
+        "080003fcf7ff80fc21fe52fd00fcff03",
+        "08000304f7078004210652050004ff03",
+        "0020e00fe0df1f026086b84a2000f0ff",
+        "08f803fcf78780fc21ae52fd00fcff03",
+        "08f80304f787800421ae520500fcff03",
+        "0020e00ff0df1f026086b84a3500f0ff",
+        "08f803fcf78780fc21ae520d00fcff03",
+        "08f803fcf787800421ae520d00fcff03"}},
+      {"extmul", {},
+       {"00017e037e807fff01807dff77e797f8",
+        "8cc1a0fddc7255d5027f7f40807f00c0",
+        "00017e037f7f810001807dff76688809",
+        "8cc1a0fd203fd654027f7f4081ffff3f"}},
+      {"saturate", {},
+       {"01007f81fe8000a07790d52903ffffff",
+        "00007e7f007e00800000002b0001ff00",
+        "ffff8081ffff00a1ffffffff03ffffff",
+        "ff010080007e0080eff700800080ff7f",
+        "01804041ffbf80503cc86b9502808080",
+        "0180c040ffbf80503cc8eb94827f0080"}},
+      {"compare", {},
+       {"ffff00000000ff00ffffff00ff0000ff",
+        "00ffff00ffffff000000ff00000000ff",
+        "0000ffffffffffff0000ffffffff0000",
+        "0000ffff0000ffffffffffffffff0000",
+        "000000000000000000000000ffffffff",
+        "ffffffffffffffffffffffff00000000",
+        "00000000000000000000000000000000",
+        "ffffffffffffffffffffffffffffffff"}},
+      {"extend", {},
+       {"000001007f0080fffffffeff100090ff",
+        "3300c4005500aa0001008000ff007f00",
+        "33c4ffff55aaffff0180ffffff7f0000",
+        "000100007f800000fffe000010900000",
+        "33c455aaffffffff0180ff7f00000000",
+        "00017f8000000000fffe109000000000"}},
+      {"narrow", {},
+       {"7f8080808080807f807f807f807f7f80",
+        "ff000000000000ff00ff00ff00ffff00",
+        "008000800080ff7fff7fff7fff7f0080",
+        "000000000000ffffffffffffffff0000"}},
+      {"float", {},
+       {"000060400000c0bf0000c04000008840",
+        "000000bf000020c000004041000070c0",
+        "00004040000080bf0000d8c10000803f",
+        "0000403f000080c0000040c00000803d",
+        "71c49c3ff304b53f000040400000003f",
+        "0000c0bf00000040000010c1000080be",
+        "0000c03f000000c0000040c00000803e",
+        "000000400000003f0000104100008040",
+        "000000000000194052afdede4be3c7d5",
+        "000000000000fcbf52afdede4be3c7d5",
+        "00000000000022401d4bc85624cfdbd7",
+        "000000000000e23f3ba3a2e4ff84b4d3",
+        "000000000000004000000000006af840",
+        "000000000000024052afdede4be3c755",
+        "00000000000002c052afdede4be3c755"}},
+      {"load", {"256"},
+       {"01010101010101010101010101010101",
+        "7f807f807f807f807f807f807f807f80",
+        "fffe1090fffe1090fffe1090fffe1090",
+        "33c455aa0180ff7f33c455aa0180ff7f",
+        "0180ff7f000000000000000000000000",
+        "01ff0101ff80f0100000000000000000",
+        "000001007f0080fffffffeff100090ff",
+        "3300c4005500aa0001008000ff007f00",
+        "fffeffff1090ffff33c4ffff55aaffff",
+        "33c455aa000000000180ff7f00000000"}},
+  };
+  // the error of a trap isn't cleared, the calls don't share instances
+  auto Call = [&](const char *Name, const std::vector<std::string> &Args) {
+    auto InstRet = Iso->createInstance(**LoweredModRet);
+    EXPECT_TRUE(InstRet);
+    Results.clear();
+    bool Ok = RT->callWasmFunction(**InstRet, Name, Args, Results);
+    return std::make_pair(Ok, *InstRet);
+  };
+  for (const LoweredSIMDCall &C : Calls) {
+    auto [Ok, Inst] = Call(C.Name, C.Args);
+    EXPECT_TRUE(Ok) << C.Name;
+    for (size_t I = 0; I < C.Stored.size(); ++I) {
+      auto *Stored =
+          static_cast<const uint8_t *>(Inst->getNativeMemoryAddr(I * 16));
+      EXPECT_EQ(toHex(Stored, 16), C.Stored[I]) << C.Name << " " << I;
+    }
+    ASSERT_TRUE(Iso->deleteInstance(Inst));
+  }
+  // i8x16.bitmask a, i16x8.bitmask b, i32x4.bitmask a, i64x2.bitmask b and
+  // i8x16.all_true of the indices then a from the lowest bit
+  auto [Ok, Inst] = Call("mask", {});
+  EXPECT_TRUE(Ok);
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(uint32_t(Results[0].Value.I32), 0x27956ab8u);
+  ASSERT_TRUE(Iso->deleteInstance(Inst));
+  std::tie(Ok, Inst) = Call("all_true", {});
+  EXPECT_TRUE(Ok);
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, 0x7f);
+  ASSERT_TRUE(Iso->deleteInstance(Inst));
+  // load64_splat reads past the end of the memory
+  std::tie(Ok, Inst) = Call("load", {"65528"});
+  EXPECT_FALSE(Ok);
+  EXPECT_EQ(Inst->getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  ASSERT_TRUE(Iso->deleteInstance(Inst));
+}
+
+TEST(Runtime, SIMD) {
+  testSIMD(getTestRuntimeConfig().Mode);
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  testSIMD(RunMode::MultipassMode);
+#endif
+}
+
+// (module
+//   (import "env" "memset" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "memcpy" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "strlen" (func (param i32) (result i32)))
+//   (import "env" "memcmp" (func (param i32 i32 i32) (result i32)))
+//   (memory 1)
+//   (func (export "run") (param i32) (result i32)
+//     i32.const 64 i32.const 16 i32.const 97 local.get 0 call 0
+//     local.get 0 call 1 call 2
+//     i32.const 16 i32.const 64 local.get 0 call 3 i32.add))
+static const uint8_t HostapiIntrinsicsWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0d, 0x02, 0x60,
+    0x03, 0x7f, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x02,
+    0x35, 0x04, 0x03, 0x65, 0x6e, 0x76, 0x06, 0x6d, 0x65, 0x6d, 0x73, 0x65,
+    0x74, 0x00, 0x00, 0x03, 0x65, 0x6e, 0x76, 0x06, 0x6d, 0x65, 0x6d, 0x63,
+    0x70, 0x79, 0x00, 0x00, 0x03, 0x65, 0x6e, 0x76, 0x06, 0x73, 0x74, 0x72,
+    0x6c, 0x65, 0x6e, 0x00, 0x01, 0x03, 0x65, 0x6e, 0x76, 0x06, 0x6d, 0x65,
+    0x6d, 0x63, 0x6d, 0x70, 0x00, 0x00, 0x03, 0x02, 0x01, 0x01, 0x05, 0x03,
+    0x01, 0x00, 0x01, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x04,
+    0x0a, 0x20, 0x01, 0x1e, 0x00, 0x41, 0xc0, 0x00, 0x41, 0x10, 0x41, 0xe1,
+    0x00, 0x20, 0x00, 0x10, 0x00, 0x20, 0x00, 0x10, 0x01, 0x10, 0x02, 0x41,
+    0x10, 0x41, 0xc0, 0x00, 0x20, 0x00, 0x10, 0x03, 0x6a, 0x0b,
+};
+
+TEST(Runtime, HostapiIntrinsics) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.EnableHostapiIntrinsics = true;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("hostapi_intrinsics", HostapiIntrinsicsWASM,
+                               sizeof(HostapiIntrinsicsWASM));
+  ASSERT_TRUE(ModRet);
+  EXPECT_EQ((*ModRet)->getHostapiIntrinsic(1), HostapiIntrinsic::memcpy);
+  EXPECT_EQ((*ModRet)->getHostapiIntrinsic(4), HostapiIntrinsic::None);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+
+  // strlen of the copied string plus memcmp of the copy and the original
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 4, {makeI32(10)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, 10);
+
+  Results.clear();
+  EXPECT_FALSE(
+      RT->callWasmFunction(**InstRet, 4, {makeI32(0x10000)}, Results));
+  EXPECT_EQ((*InstRet)->getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+// (module
+//   (import "env" "memcmp" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "strlen" (func (param i32) (result i32)))
+//   (memory 1)
+//   (data (i32.const 0) "abcde\10gh" "abcde\80gh" "hello")
+//   (data (i32.const 65535) "x")
+//   (func (export "cmp1") (param i32 i32) (result i32)
+//     local.get 0 local.get 1 i32.const 1 call 0)
+//   ;; cmp2, cmp4 and cmp8 alike
+//   (func (export "strlen") (param i32) (result i32)
+//     local.get 0 call 1))
+static const uint8_t ConstSizeIntrinsicsWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x13, 0x03, 0x60,
+    0x03, 0x7f, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x60,
+    0x02, 0x7f, 0x7f, 0x01, 0x7f, 0x02, 0x1b, 0x02, 0x03, 0x65, 0x6e, 0x76,
+    0x06, 0x6d, 0x65, 0x6d, 0x63, 0x6d, 0x70, 0x00, 0x00, 0x03, 0x65, 0x6e,
+    0x76, 0x06, 0x73, 0x74, 0x72, 0x6c, 0x65, 0x6e, 0x00, 0x01, 0x03, 0x06,
+    0x05, 0x02, 0x02, 0x02, 0x02, 0x01, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07,
+    0x26, 0x05, 0x04, 0x63, 0x6d, 0x70, 0x31, 0x00, 0x02, 0x04, 0x63, 0x6d,
+    0x70, 0x32, 0x00, 0x03, 0x04, 0x63, 0x6d, 0x70, 0x34, 0x00, 0x04, 0x04,
+    0x63, 0x6d, 0x70, 0x38, 0x00, 0x05, 0x06, 0x73, 0x74, 0x72, 0x6c, 0x65,
+    0x6e, 0x00, 0x06, 0x0a, 0x34, 0x05, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01,
+    0x41, 0x01, 0x10, 0x00, 0x0b, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x41,
+    0x02, 0x10, 0x00, 0x0b, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x41, 0x04,
+    0x10, 0x00, 0x0b, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x41, 0x08, 0x10,
+    0x00, 0x0b, 0x06, 0x00, 0x20, 0x00, 0x10, 0x01, 0x0b, 0x0b, 0x23, 0x02,
+    0x00, 0x41, 0x00, 0x0b, 0x15, 0x61, 0x62, 0x63, 0x64, 0x65, 0x10, 0x67,
+    0x68, 0x61, 0x62, 0x63, 0x64, 0x65, 0x80, 0x67, 0x68, 0x68, 0x65, 0x6c,
+    0x6c, 0x6f, 0x00, 0x41, 0xff, 0xff, 0x03, 0x0b, 0x01, 0x78,
+};
+
+// the jits inline memcmp of these sizes and strlen, the results and traps
+// must match the runtime routines
+TEST(Runtime, ConstSizeHostapiIntrinsics) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.EnableHostapiIntrinsics = true;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("const_size_intrinsics", ConstSizeIntrinsicsWASM,
+                               sizeof(ConstSizeIntrinsicsWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+
+  const uint32_t Sizes[] = {1, 2, 4, 8};
+  const std::pair<uint32_t, uint32_t> Addrs[] = {
+      {0, 8}, {8, 0}, {0, 0}, {1, 9}, {5, 13}, {16, 0}, {3, 17},
+  };
+  std::vector<TypedValue> Results;
+  for (uint32_t I = 0; I < 4; ++I) {
+    for (const auto &[LHS, RHS] : Addrs) {
+      const auto *LHSPtr =
+          static_cast<const uint8_t *>(Inst.getNativeMemoryAddr(LHS));
+      const auto *RHSPtr =
+          static_cast<const uint8_t *>(Inst.getNativeMemoryAddr(RHS));
+      const auto [LHSDiff, RHSDiff] =
+          std::mismatch(LHSPtr, LHSPtr + Sizes[I], RHSPtr);
+      int32_t Expected = LHSDiff == LHSPtr + Sizes[I]
+                             ? 0
+                             : int32_t(*LHSDiff) - int32_t(*RHSDiff);
+      Results.clear();
+      ASSERT_TRUE(RT->callWasmFunction(Inst, 2 + I,
+                                       {makeI32(LHS), makeI32(RHS)}, Results));
+      ASSERT_EQ(Results.size(), 1u);
+      EXPECT_EQ(Results[0].Value.I32, Expected)
+          << "size " << Sizes[I] << " at " << LHS << ", " << RHS;
+    }
+  }
+
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(Inst, 6, {makeI32(16)}, Results));
+  EXPECT_EQ(Results[0].Value.I32, 5);
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(Inst, 6, {makeI32(0)}, Results));
+  EXPECT_EQ(Results[0].Value.I32, 21);
+
+  // both trap at the end of the memory
+  Results.clear();
+  EXPECT_FALSE(RT->callWasmFunction(Inst, 5, {makeI32(0xfffc), makeI32(0)},
+                                    Results));
+  EXPECT_EQ(Inst.getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  Inst.clearError();
+  Results.clear();
+  EXPECT_FALSE(RT->callWasmFunction(Inst, 6, {makeI32(0xffff)}, Results));
+  EXPECT_EQ(Inst.getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+// (module
+//   (import "env" "u256_add" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "u256_mul" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "u256_div" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "u256_exp" (func (param i32 i32 i32) (result i32)))
+//   (import "env" "u256_cmp" (func (param i32 i32) (result i32)))
+//   (memory 1)
+//   ;; 2^256 - 1 at 0, 2 at 32
+//   (data (i32.const 0) "\ff\ff...\ff" "\02")
+//   (func (export "run") (result i32)
+//     i32.const 64 i32.const 0 i32.const 32 call 0
+//     i32.const 96 i32.const 0 i32.const 32 call 1 i32.add
+//     i32.const 128 i32.const 96 i32.const 32 call 2 i32.add
+//     i32.const 160 i32.const 32 i32.const 32 call 3 i32.add
+//     i32.const 128 i32.const 0 call 4 i32.add))
+static const uint8_t U256IntrinsicsWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x12, 0x03, 0x60,
+    0x03, 0x7f, 0x7f, 0x7f, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f, 0x01, 0x7f,
+    0x60, 0x00, 0x01, 0x7f, 0x02, 0x4c, 0x05, 0x03, 0x65, 0x6e, 0x76, 0x08,
+    0x75, 0x32, 0x35, 0x36, 0x5f, 0x61, 0x64, 0x64, 0x00, 0x00, 0x03, 0x65,
+    0x6e, 0x76, 0x08, 0x75, 0x32, 0x35, 0x36, 0x5f, 0x6d, 0x75, 0x6c, 0x00,
+    0x00, 0x03, 0x65, 0x6e, 0x76, 0x08, 0x75, 0x32, 0x35, 0x36, 0x5f, 0x64,
+    0x69, 0x76, 0x00, 0x00, 0x03, 0x65, 0x6e, 0x76, 0x08, 0x75, 0x32, 0x35,
+    0x36, 0x5f, 0x65, 0x78, 0x70, 0x00, 0x00, 0x03, 0x65, 0x6e, 0x76, 0x08,
+    0x75, 0x32, 0x35, 0x36, 0x5f, 0x63, 0x6d, 0x70, 0x00, 0x01, 0x03, 0x02,
+    0x01, 0x02, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x07, 0x01, 0x03, 0x72,
+    0x75, 0x6e, 0x00, 0x05, 0x0a, 0x34, 0x01, 0x32, 0x00, 0x41, 0xc0, 0x00,
+    0x41, 0x00, 0x41, 0x20, 0x10, 0x00, 0x41, 0xe0, 0x00, 0x41, 0x00, 0x41,
+    0x20, 0x10, 0x01, 0x6a, 0x41, 0x80, 0x01, 0x41, 0xe0, 0x00, 0x41, 0x20,
+    0x10, 0x02, 0x6a, 0x41, 0xa0, 0x01, 0x41, 0x20, 0x41, 0x20, 0x10, 0x03,
+    0x6a, 0x41, 0x80, 0x01, 0x41, 0x00, 0x10, 0x04, 0x6a, 0x0b, 0x0b, 0x27,
+    0x01, 0x00, 0x41, 0x00, 0x0b, 0x21, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0x02,
+};
+
+TEST(Runtime, U256Intrinsics) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.EnableHostapiIntrinsics = true;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("u256_intrinsics", U256IntrinsicsWASM,
+                               sizeof(U256IntrinsicsWASM));
+  ASSERT_TRUE(ModRet);
+  EXPECT_EQ((*ModRet)->getHostapiIntrinsic(2), HostapiIntrinsic::u256_div);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+
+  // add carries, mul overflows, div and exp don't, cmp is less
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 5, {}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, 1 + 1 + 0 + 0 - 1);
+
+  using Limbs = std::array<uint64_t, 4>;
+  auto LoadLimbs = [&](uint32_t Offset) {
+    Limbs Val;
+    std::memcpy(Val.data(), (*InstRet)->getNativeMemoryAddr(Offset),
+                sizeof(Val));
+    return Val;
+  };
+  EXPECT_EQ(LoadLimbs(64), (Limbs{1, 0, 0, 0}));
+  EXPECT_EQ(LoadLimbs(96), (Limbs{~1ull, ~0ull, ~0ull, ~0ull}));
+  EXPECT_EQ(LoadLimbs(128), (Limbs{~0ull, ~0ull, ~0ull, ~0ull >> 1}));
+  EXPECT_EQ(LoadLimbs(160), (Limbs{4, 0, 0, 0}));
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+// (module
+//   (import "env" "u256_add" (func $add (param i32 i32 i32) (result i32)))
+//   (import "env" "u256_sub" (func $sub (param i32 i32 i32) (result i32)))
+//   (import "env" "u256_mul" (func $mul (param i32 i32 i32) (result i32)))
+//   (memory 1)
+//   (func (export "add") (param i32 i32 i32) (result i32)
+//     local.get 0 local.get 1 local.get 2 call $add)
+//   (func (export "sub") (param i32 i32 i32) (result i32)
+//     local.get 0 local.get 1 local.get 2 call $sub)
+//   (func (export "mul") (param i32 i32 i32) (result i32)
+//     local.get 0 local.get 1 local.get 2 call $mul))
+static const uint8_t U256ArithmeticWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x08, 0x01, 0x60,
+    0x03, 0x7f, 0x7f, 0x7f, 0x01, 0x7f, 0x02, 0x2e, 0x03, 0x03, 0x65, 0x6e,
+    0x76, 0x08, 0x75, 0x32, 0x35, 0x36, 0x5f, 0x61, 0x64, 0x64, 0x00, 0x00,
+    0x03, 0x65, 0x6e, 0x76, 0x08, 0x75, 0x32, 0x35, 0x36, 0x5f, 0x73, 0x75,
+    0x62, 0x00, 0x00, 0x03, 0x65, 0x6e, 0x76, 0x08, 0x75, 0x32, 0x35, 0x36,
+    0x5f, 0x6d, 0x75, 0x6c, 0x00, 0x00, 0x03, 0x04, 0x03, 0x00, 0x00, 0x00,
+    0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x13, 0x03, 0x03, 0x61, 0x64, 0x64,
+    0x00, 0x03, 0x03, 0x73, 0x75, 0x62, 0x00, 0x04, 0x03, 0x6d, 0x75, 0x6c,
+    0x00, 0x05, 0x0a, 0x22, 0x03, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20,
+    0x02, 0x10, 0x00, 0x0b, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20, 0x02,
+    0x10, 0x01, 0x0b, 0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20, 0x02, 0x10,
+    0x02, 0x0b,
+};
+
+// the multipass jit inlines add and sub and calls the runtime for mul, check
+// both against utils/u256.h
+static void testU256Arithmetic(RunMode Mode) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.Mode = Mode;
+  Config.EnableHostapiIntrinsics = true;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("u256_arithmetic", U256ArithmeticWASM,
+                               sizeof(U256ArithmeticWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  Instance &Inst = **InstRet;
+
+  using utils::U256;
+  auto Store = [&](uint32_t Offset, const U256 &Val) {
+    std::memcpy(Inst.getNativeMemoryAddr(Offset), Val.Limbs, sizeof(Val));
+  };
+  auto Load = [&](uint32_t Offset) {
+    U256 Val;
+    std::memcpy(Val.Limbs, Inst.getNativeMemoryAddr(Offset), sizeof(Val));
+    return Val;
+  };
+  auto Equal = [](const U256 &LHS, const U256 &RHS) {
+    return utils::compareU256(LHS, RHS) == 0;
+  };
+
+  // limbs near the carry boundaries and small values, with fixed seeds
+  uint64_t Seed = 0x9e3779b97f4a7c15ull;
+  auto NextLimb = [&]() -> uint64_t {
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 7;
+    Seed ^= Seed << 17;
+    switch (Seed % 4) {
+    case 0:
+      return 0;
+    case 1:
+      return ~0ull;
+    case 2:
+      return Seed >> 60;
+    default:
+      return Seed;
+    }
+  };
+  for (uint32_t Iter = 0; Iter < 256; ++Iter) {
+    U256 LHS, RHS;
+    for (uint32_t I = 0; I < 4; ++I) {
+      LHS.Limbs[I] = NextLimb();
+      RHS.Limbs[I] = NextLimb();
+    }
+    for (uint32_t FuncIdx : {3u, 4u, 5u}) {
+      U256 Expected;
+      bool Flag = FuncIdx == 3   ? utils::addU256(Expected, LHS, RHS)
+                  : FuncIdx == 4 ? utils::subU256(Expected, LHS, RHS)
+                                 : utils::mulU256(Expected, LHS, RHS);
+      // separate operands, then the result over the left operand
+      for (uint32_t Dst : {64u, 0u}) {
+        Store(0, LHS);
+        Store(32, RHS);
+        std::vector<TypedValue> Results;
+        ASSERT_TRUE(RT->callWasmFunction(
+            Inst, FuncIdx, {makeI32(Dst), makeI32(0), makeI32(32)}, Results));
+        ASSERT_EQ(Results.size(), 1u);
+        EXPECT_EQ(Results[0].Value.I32, int32_t(Flag));
+        EXPECT_TRUE(Equal(Load(Dst), Expected)) << FuncIdx << " " << Iter;
+      }
+    }
+  }
+
+  // a result out of bounds traps before anything is written
+  Store(0, U256{{1, 2, 3, 4}});
+  std::vector<TypedValue> Results;
+  EXPECT_FALSE(RT->callWasmFunction(
+      Inst, 5, {makeI32(0xffe1), makeI32(0), makeI32(0)}, Results));
+  EXPECT_EQ(Inst.getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  Inst.clearError();
+  EXPECT_TRUE(Equal(Load(0xffe0), U256{{0, 0, 0, 0}}));
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+TEST(Runtime, U256Arithmetic) {
+  testU256Arithmetic(getTestRuntimeConfig().Mode);
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  testU256Arithmetic(RunMode::MultipassMode);
+#endif
+}
+
+#ifdef ZEN_ENABLE_BUILTIN_CRYPTO
+static std::vector<uint8_t> fromHex(const std::string &Hex) {
+  std::vector<uint8_t> Data;
+  for (size_t I = 0; I + 1 < Hex.size(); I += 2) {
+    Data.push_back(uint8_t(std::stoul(Hex.substr(I, 2), nullptr, 16)));
+  }
+  return Data;
+}
+
+// (module
+//   (import "crypto" "keccak256" (func (param i32 i32 i32)))
+//   (import "crypto" "sha256" (func (param i32 i32 i32)))
+//   (import "crypto" "ripemd160" (func (param i32 i32 i32)))
+//   (import "crypto" "secp256k1_recover"
+//     (func (param i32 i32 i32 i32) (result i32)))
+//   (memory 1)
+//   ;; "abc" at 0, the hash and the signature r || s of v = 28 at 32
+//   (data (i32.const 0) "abc")
+//   (data (i32.const 32) "\45\6e...\2a\da")
+//   (func (export "run") (param i32) (result i32)
+//     local.get 0 i32.const 3 i32.const 256 call 0
+//     i32.const 0 i32.const 3 i32.const 288 call 1
+//     i32.const 0 i32.const 3 i32.const 320 call 2
+//     i32.const 32 i32.const 64 i32.const 1 i32.const 384 call 3
+//     i32.const 384 i32.const 64 i32.const 448 call 0))
+static const uint8_t CryptoHostModuleWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x14, 0x03, 0x60,
+    0x03, 0x7f, 0x7f, 0x7f, 0x00, 0x60, 0x04, 0x7f, 0x7f, 0x7f, 0x7f, 0x01,
+    0x7f, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x02, 0x52, 0x04, 0x06, 0x63, 0x72,
+    0x79, 0x70, 0x74, 0x6f, 0x09, 0x6b, 0x65, 0x63, 0x63, 0x61, 0x6b, 0x32,
+    0x35, 0x36, 0x00, 0x00, 0x06, 0x63, 0x72, 0x79, 0x70, 0x74, 0x6f, 0x06,
+    0x73, 0x68, 0x61, 0x32, 0x35, 0x36, 0x00, 0x00, 0x06, 0x63, 0x72, 0x79,
+    0x70, 0x74, 0x6f, 0x09, 0x72, 0x69, 0x70, 0x65, 0x6d, 0x64, 0x31, 0x36,
+    0x30, 0x00, 0x00, 0x06, 0x63, 0x72, 0x79, 0x70, 0x74, 0x6f, 0x11, 0x73,
+    0x65, 0x63, 0x70, 0x32, 0x35, 0x36, 0x6b, 0x31, 0x5f, 0x72, 0x65, 0x63,
+    0x6f, 0x76, 0x65, 0x72, 0x00, 0x01, 0x03, 0x02, 0x01, 0x02, 0x05, 0x03,
+    0x01, 0x00, 0x01, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x04,
+    0x0a, 0x36, 0x01, 0x34, 0x00, 0x20, 0x00, 0x41, 0x03, 0x41, 0x80, 0x02,
+    0x10, 0x00, 0x41, 0x00, 0x41, 0x03, 0x41, 0xa0, 0x02, 0x10, 0x01, 0x41,
+    0x00, 0x41, 0x03, 0x41, 0xc0, 0x02, 0x10, 0x02, 0x41, 0x20, 0x41, 0xc0,
+    0x00, 0x41, 0x01, 0x41, 0x80, 0x03, 0x10, 0x03, 0x41, 0x80, 0x03, 0x41,
+    0xc0, 0x00, 0x41, 0xc0, 0x03, 0x10, 0x00, 0x0b, 0x0b, 0x6e, 0x02, 0x00,
+    0x41, 0x00, 0x0b, 0x03, 0x61, 0x62, 0x63, 0x00, 0x41, 0x20, 0x0b, 0x60,
+    0x45, 0x6e, 0x9a, 0xea, 0x5e, 0x19, 0x7a, 0x1f, 0x1a, 0xf7, 0xa3, 0xe8,
+    0x5a, 0x32, 0x12, 0xfa, 0x40, 0x49, 0xa3, 0xba, 0x34, 0xc2, 0x28, 0x9b,
+    0x4c, 0x86, 0x0f, 0xc0, 0xb0, 0xc6, 0x4e, 0xf3, 0x92, 0x42, 0x68, 0x5b,
+    0xf1, 0x61, 0x79, 0x3c, 0xc2, 0x56, 0x03, 0xc2, 0x31, 0xbc, 0x2f, 0x56,
+    0x8e, 0xb6, 0x30, 0xea, 0x16, 0xaa, 0x13, 0x7d, 0x26, 0x64, 0xac, 0x80,
+    0x38, 0x82, 0x56, 0x08, 0x4f, 0x8a, 0xe3, 0xbd, 0x75, 0x35, 0x24, 0x8d,
+    0x0b, 0xd4, 0x48, 0x29, 0x8c, 0xc2, 0xe2, 0x07, 0x1e, 0x56, 0x99, 0x2d,
+    0x07, 0x74, 0xdc, 0x34, 0x0c, 0x36, 0x8a, 0xe9, 0x50, 0x85, 0x2a, 0xda,
+};
+
+TEST(Runtime, CryptoHostModule) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  ASSERT_NE(LOAD_HOST_MODULE(RT, zen::host, crypto), nullptr);
+  auto ModRet = RT->loadModule("crypto_host_module", CryptoHostModuleWASM,
+                               sizeof(CryptoHostModuleWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 4, {makeI32(0)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, 1);
+
+  auto ToHex = [&](uint32_t Offset, uint32_t Size) {
+    return toHex(
+        static_cast<uint8_t *>((*InstRet)->getNativeMemoryAddr(Offset)), Size);
+  };
+  EXPECT_EQ(ToHex(256, 32), "4e03657aea45a94fc7d47ba826c8d667"
+                            "c0d1e6e33a64a036ec44f58fa12d6c45");
+  EXPECT_EQ(ToHex(288, 32), "ba7816bf8f01cfea414140de5dae2223"
+                            "b00361a396177a9cb410ff61f20015ad");
+  EXPECT_EQ(ToHex(320, 20), "8eb208f7e05d987a9b044a8e98c6b087f15a0bfc");
+  // the address is the low 20 bytes of the keccak-256 of the public key
+  EXPECT_EQ(ToHex(460, 20), "7156526fbd7a3c72969b54f64e42c10fbb768c8a");
+
+  Results.clear();
+  EXPECT_FALSE(RT->callWasmFunction(**InstRet, 4, {makeI32(0xffff)}, Results));
+  EXPECT_EQ((*InstRet)->getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+// the lengths around the padding boundaries, 55 bytes is the longest input
+// whose length still fits into the last 64-byte block of sha-256 and
+// ripemd-160, 135 the same for the 136-byte rate of keccak-256
+TEST(Runtime, CryptoDigests) {
+  struct DigestVector {
+    size_t Len;
+    const char *Keccak256;
+    const char *SHA256;
+    const char *RIPEMD160;
+  };
+  static const DigestVector Vectors[] = {
+      {55,
+       "97c45d97c802da7b3a6584d91c34ee4e"
+       "a5cd8d8b052856234405bf5b76c0b043",
+       "8aa994584139d128848eeebc4e815639"
+       "ba5ab6e6e39574195a63ac4f14f7c43b",
+       "b0b8230474939917ecb5359dd78d492965729965"},
+      {56,
+       "cb7edb32d44760cf91e5a2ef1a3c300c"
+       "eff8a95b33eb1157de878a6764859cc2",
+       "ad574708f75c044c9b85de64cb568ee7"
+       "711ff4f36448c6242f053ba8f6cc2b63",
+       "d627d48d28fd05a3954f02580221823e667c5c37"},
+      {64,
+       "cef50cf47c1d754b090843530a064892"
+       "786476fdd9afb5216f5efce9928faf12",
+       "c6ab9724ade5b6a7a1edfffb12f3aa91"
+       "81351355af8fd08c919952ad211339dd",
+       "13aaed2eefca44031dfcb63eca3f3bad8eebad46"},
+      {135,
+       "adee8145bb33dc0320ad44945eeeb391"
+       "e4668f0f7c69ccbbf6550a7cba245e52",
+       "8dc4c3808177a1929f7a7bbb69357dc0"
+       "df4ddd4f52982df5557e1620d67e63ff",
+       "ab505a7aade5ede32e97478739b0c073bcdffb35"},
+      {136,
+       "eaccfc5aa7bf6bf1941809ef7cc9ee6a"
+       "2fa306a7dd1de3f2e8504849b0a5e3c4",
+       "c24b158fded40acdd875625ecbf3733a"
+       "c2056516bf20a20c920404d4ca720ba6",
+       "0af223bbbcc6481dd3d65a8f5eefa295e241adfc"},
+      {137,
+       "ea0e0b9657469f0b4f53604f1068ab4b"
+       "d4a5e7b0a458d24a78f1fe2ec7bd4db0",
+       "3e28a29dd0249f4b8b9c78d1a497b288"
+       "85bf4b69ee8fcdc6b6140987d6b76dc3",
+       "c2d81d572661745638439fb10f3880b309366dd3"},
+  };
+  using namespace zen::host::crypto;
+  for (const DigestVector &V : Vectors) {
+    std::vector<uint8_t> Data(V.Len);
+    for (size_t I = 0; I < V.Len; ++I) {
+      Data[I] = uint8_t(I * 31 + 7);
+    }
+    uint8_t Digest[32];
+    hashKeccak256(Data.data(), V.Len, Digest);
+    EXPECT_EQ(toHex(Digest, Keccak256DigestSize), V.Keccak256) << V.Len;
+    // the sha extensions when the cpu has them, then the portable rounds
+    hashSHA256(Data.data(), V.Len, Digest);
+    EXPECT_EQ(toHex(Digest, SHA256DigestSize), V.SHA256) << V.Len;
+    hashSHA256Portable(Data.data(), V.Len, Digest);
+    EXPECT_EQ(toHex(Digest, SHA256DigestSize), V.SHA256) << V.Len;
+    hashRIPEMD160(Data.data(), V.Len, Digest);
+    EXPECT_EQ(toHex(Digest, RIPEMD160DigestSize), V.RIPEMD160) << V.Len;
+  }
+}
+
+TEST(Runtime, CryptoSecp256k1Recover) {
+  using namespace zen::host::crypto;
+  // sha-256 of "dtvm"
+  std::vector<uint8_t> Hash = fromHex(
+      "589eef8f9cb88da57f00931f7eda04183ff8952ea35d12a2fe1b129395b03a4c");
+  auto Recover = [&](const std::string &R, const std::string &S,
+                     uint32_t RecId) -> std::string {
+    std::vector<uint8_t> Sig = fromHex(R + S);
+    uint8_t PubKey[Secp256k1PubKeySize];
+    std::memset(PubKey, 0xcc, sizeof(PubKey));
+    if (!recoverSecp256k1PubKey(Hash.data(), Sig.data(), RecId, PubKey)) {
+      // the public key isn't written on failure
+      EXPECT_EQ(toHex(PubKey, sizeof(PubKey)), std::string(128, 'c'));
+      return "";
+    }
+    return toHex(PubKey, sizeof(PubKey));
+  };
+
+  // a signature by the key 0x1234567890abcdef, whose R has an even y
+  const std::string R0 =
+      "3cb111c36904d49e9351b62f9940cbea49ac1ae1b7e9f0ba2dbfa19846b83563";
+  const std::string S0 =
+      "42b84cdb924620d3b7c0a9b3880ff2101b7357fad0bf994deb20fa588502ecb8";
+  EXPECT_EQ(Recover(R0, S0, 0),
+            "f973a0b87062c389d125d8199e803b832b6ac6bf7867a4f6cd87506060fc4c58"
+            "4b4a0a3f26c988c54c236b224c48bb605b265949e65c098ecd87a581ca10e25d");
+  EXPECT_NE(Recover(R0, S0, 1), Recover(R0, S0, 0));
+  EXPECT_EQ(Recover(R0, S0, 4), "");
+
+  // the x of R is r + n for RecId 2 and 3, which needs r < p - n
+  const std::string Two = std::string(63, '0') + "2";
+  const std::string S2 = std::string(62, '0') + "2a";
+  EXPECT_EQ(Recover(Two, S2, 2),
+            "d8a98c685f792da80ef97090408ca930fc77f716856115dbbe330418c6590ca1"
+            "7c0970dbc2567907222c3e24ed3d73cca13b301ee2d98de1c367bcc6d79935f3");
+  EXPECT_EQ(Recover(Two, S2, 3),
+            "2830d3d37d2e824d1e5905c4e639b2dd8be9f2810e816f8736e822eea927bc95"
+            "29681cd71cf6a2edf069738c9842b32974fc369bca66f04ddd0e5c93f2b49bc0");
+  const std::string PMinusN =
+      "000000000000000000000000000000014551231950b75fc4402da1722fc9baee";
+  EXPECT_EQ(Recover(PMinusN, S2, 2), "");
+  EXPECT_EQ(Recover(PMinusN, S2, 3), "");
+
+  // r and s must be in [1, n)
+  const std::string Zero(64, '0');
+  const std::string N =
+      "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141";
+  const std::string NPlusOne =
+      "fffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364142";
+  const std::string Max(64, 'f');
+  for (const std::string &Bad : {Zero, N, NPlusOne, Max}) {
+    EXPECT_EQ(Recover(Bad, S0, 0), "");
+    EXPECT_EQ(Recover(R0, Bad, 0), "");
+  }
+
+  // 5^3 + 7 is no square mod p, so no point has x = 5
+  const std::string OffCurve = std::string(63, '0') + "5";
+  EXPECT_EQ(Recover(OffCurve, S0, 0), "");
+  EXPECT_EQ(Recover(OffCurve, S0, 1), "");
+}
+
+// (module
+//   (import "crypto" "keccak256" (func (param i32 i32 i32)))
+//   (import "crypto" "sha256" (func (param i32 i32 i32)))
+//   (import "crypto" "ripemd160" (func (param i32 i32 i32)))
+//   (import "crypto" "secp256k1_recover"
+//     (func (param i32 i32 i32 i32) (result i32)))
+//   (memory 1)
+//   (func (export "keccak256") (param i32 i32 i32)
+//     local.get 0 local.get 1 local.get 2 call 0)
+//   (func (export "sha256") (param i32 i32 i32)
+//     local.get 0 local.get 1 local.get 2 call 1)
+//   (func (export "ripemd160") (param i32 i32 i32)
+//     local.get 0 local.get 1 local.get 2 call 2)
+//   (func (export "secp256k1_recover") (param i32 i32 i32 i32) (result i32)
+//     local.get 0 local.get 1 local.get 2 local.get 3 call 3))
+static const uint8_t CryptoBuffersWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0f, 0x02, 0x60,
+    0x03, 0x7f, 0x7f, 0x7f, 0x00, 0x60, 0x04, 0x7f, 0x7f, 0x7f, 0x7f, 0x01,
+    0x7f, 0x02, 0x52, 0x04, 0x06, 0x63, 0x72, 0x79, 0x70, 0x74, 0x6f, 0x09,
+    0x6b, 0x65, 0x63, 0x63, 0x61, 0x6b, 0x32, 0x35, 0x36, 0x00, 0x00, 0x06,
+    0x63, 0x72, 0x79, 0x70, 0x74, 0x6f, 0x06, 0x73, 0x68, 0x61, 0x32, 0x35,
+    0x36, 0x00, 0x00, 0x06, 0x63, 0x72, 0x79, 0x70, 0x74, 0x6f, 0x09, 0x72,
+    0x69, 0x70, 0x65, 0x6d, 0x64, 0x31, 0x36, 0x30, 0x00, 0x00, 0x06, 0x63,
+    0x72, 0x79, 0x70, 0x74, 0x6f, 0x11, 0x73, 0x65, 0x63, 0x70, 0x32, 0x35,
+    0x36, 0x6b, 0x31, 0x5f, 0x72, 0x65, 0x63, 0x6f, 0x76, 0x65, 0x72, 0x00,
+    0x01, 0x03, 0x05, 0x04, 0x00, 0x00, 0x00, 0x01, 0x05, 0x03, 0x01, 0x00,
+    0x01, 0x07, 0x36, 0x04, 0x09, 0x6b, 0x65, 0x63, 0x63, 0x61, 0x6b, 0x32,
+    0x35, 0x36, 0x00, 0x04, 0x06, 0x73, 0x68, 0x61, 0x32, 0x35, 0x36, 0x00,
+    0x05, 0x09, 0x72, 0x69, 0x70, 0x65, 0x6d, 0x64, 0x31, 0x36, 0x30, 0x00,
+    0x06, 0x11, 0x73, 0x65, 0x63, 0x70, 0x32, 0x35, 0x36, 0x6b, 0x31, 0x5f,
+    0x72, 0x65, 0x63, 0x6f, 0x76, 0x65, 0x72, 0x00, 0x07, 0x0a, 0x2f, 0x04,
+    0x0a, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20, 0x02, 0x10, 0x00, 0x0b, 0x0a,
+    0x00, 0x20, 0x00, 0x20, 0x01, 0x20, 0x02, 0x10, 0x01, 0x0b, 0x0a, 0x00,
+    0x20, 0x00, 0x20, 0x01, 0x20, 0x02, 0x10, 0x02, 0x0b, 0x0c, 0x00, 0x20,
+    0x00, 0x20, 0x01, 0x20, 0x02, 0x20, 0x03, 0x10, 0x03, 0x0b,
+};
+
+TEST(Runtime, CryptoHostBuffers) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  ASSERT_NE(LOAD_HOST_MODULE(RT, zen::host, crypto), nullptr);
+  auto ModRet = RT->loadModule("crypto_buffers", CryptoBuffersWASM,
+                               sizeof(CryptoBuffersWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+
+  constexpr uint32_t Keccak256Idx = 4;
+  constexpr uint32_t SHA256Idx = 5;
+  constexpr uint32_t RIPEMD160Idx = 6;
+  constexpr uint32_t RecoverIdx = 7;
+  constexpr uint32_t MemSize = 65536;
+  // a trap stays on the instance, so every call gets a fresh one
+  auto Call = [&](uint32_t FuncIdx, const std::vector<TypedValue> &Args) {
+    auto InstRet = Iso->createInstance(**ModRet);
+    EXPECT_TRUE(InstRet);
+    std::vector<TypedValue> Results;
+    bool Ok = RT->callWasmFunction(**InstRet, FuncIdx, Args, Results);
+    ErrorCode Code = (*InstRet)->getError().getCode();
+    EXPECT_EQ(Ok, Code == ErrorCode::NoError);
+    int32_t Ret = Results.empty() ? -1 : Results[0].Value.I32;
+    EXPECT_TRUE(Iso->deleteInstance(*InstRet));
+    return std::make_pair(Code, Ret);
+  };
+  auto I32 = [](uint32_t V) { return makeI32(int32_t(V)); };
+
+  // the buffers may end exactly at the end of the memory
+  for (uint32_t FuncIdx : {Keccak256Idx, SHA256Idx}) {
+    EXPECT_EQ(Call(FuncIdx, {I32(MemSize - 8), I32(8), I32(MemSize - 32)})
+                  .first,
+              ErrorCode::NoError);
+    EXPECT_EQ(Call(FuncIdx, {I32(MemSize - 7), I32(8), I32(0)}).first,
+              ErrorCode::OutOfBoundsMemory);
+    EXPECT_EQ(Call(FuncIdx, {I32(0), I32(8), I32(MemSize - 31)}).first,
+              ErrorCode::OutOfBoundsMemory);
+    // the end of the input wraps around in 32 bits
+    EXPECT_EQ(Call(FuncIdx, {I32(16), I32(0xfffffff8), I32(0)}).first,
+              ErrorCode::OutOfBoundsMemory);
+  }
+  EXPECT_EQ(Call(RIPEMD160Idx, {I32(0), I32(8), I32(MemSize - 20)}).first,
+            ErrorCode::NoError);
+  EXPECT_EQ(Call(RIPEMD160Idx, {I32(0), I32(8), I32(MemSize - 19)}).first,
+            ErrorCode::OutOfBoundsMemory);
+  EXPECT_EQ(Call(RIPEMD160Idx, {I32(MemSize), I32(1), I32(0)}).first,
+            ErrorCode::OutOfBoundsMemory);
+
+  // a signature of zeros is invalid, which returns 0 without a trap
+  auto Ret = Call(RecoverIdx, {I32(MemSize - 32), I32(MemSize - 64), I32(0),
+                               I32(MemSize - 64)});
+  EXPECT_EQ(Ret.first, ErrorCode::NoError);
+  EXPECT_EQ(Ret.second, 0);
+  EXPECT_EQ(Call(RecoverIdx, {I32(MemSize - 31), I32(0), I32(0), I32(64)})
+                .first,
+            ErrorCode::OutOfBoundsMemory);
+  EXPECT_EQ(Call(RecoverIdx, {I32(0), I32(MemSize - 63), I32(0), I32(64)})
+                .first,
+            ErrorCode::OutOfBoundsMemory);
+  EXPECT_EQ(Call(RecoverIdx, {I32(0), I32(32), I32(0), I32(MemSize - 63)})
+                .first,
+            ErrorCode::OutOfBoundsMemory);
+  EXPECT_EQ(Call(RecoverIdx, {I32(0xffffffe0), I32(32), I32(0), I32(128)})
+                .first,
+            ErrorCode::OutOfBoundsMemory);
+}
+#endif // ZEN_ENABLE_BUILTIN_CRYPTO
+
+// (module
+//   (type $t0 (func (param i32) (result i32)))
+//   (func $f0 (type $t0) (i32.add (local.get 0) (i32.const 1)))
+//   (func $f1 (type $t0) (i32.add (local.get 0) (i32.const 2)))
+//   (func $f2 (result i32) (i32.const 7))
+//   (table 4 funcref)
+//   (elem (i32.const 0) $f0 $f1 $f2 $f0)
+//   (func (export "run") (param i32 i32) (result i32)
+//     (i32.add (call_indirect (type $t0) (local.get 1) (local.get 0))
+//              (call_indirect (type $t0) (local.get 1) (i32.const 1)))))
+static const uint8_t CallIndirectWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x10, 0x03, 0x60,
+    0x01, 0x7f, 0x01, 0x7f, 0x60, 0x00, 0x01, 0x7f, 0x60, 0x02, 0x7f, 0x7f,
+    0x01, 0x7f, 0x03, 0x05, 0x04, 0x00, 0x00, 0x01, 0x02, 0x04, 0x04, 0x01,
+    0x70, 0x00, 0x04, 0x07, 0x07, 0x01, 0x03, 0x72, 0x75, 0x6e, 0x00, 0x03,
+    0x09, 0x0a, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x04, 0x00, 0x01, 0x02, 0x00,
+    0x0a, 0x28, 0x04, 0x07, 0x00, 0x20, 0x00, 0x41, 0x01, 0x6a, 0x0b, 0x07,
+    0x00, 0x20, 0x00, 0x41, 0x02, 0x6a, 0x0b, 0x04, 0x00, 0x41, 0x07, 0x0b,
+    0x11, 0x00, 0x20, 0x01, 0x20, 0x00, 0x11, 0x00, 0x00, 0x20, 0x01, 0x41,
+    0x01, 0x11, 0x00, 0x00, 0x6a, 0x0b,
+};
+
+TEST(Runtime, CallIndirect) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("call_indirect", CallIndirectWASM,
+                               sizeof(CallIndirectWASM));
+  ASSERT_TRUE(ModRet);
+  Module *Mod = *ModRet;
+
+#ifdef ZEN_ENABLE_JIT
+  Mod->buildStaticTables();
+  EXPECT_EQ(Mod->getStaticTableElem(0, 1), 1u);
+  EXPECT_EQ(Mod->getStaticTableElem(0, 3), 0u);
+  EXPECT_EQ(Mod->getStaticTableElem(0, 4), -1u);
+  const std::vector<uint32_t> *Targets = Mod->getIndirectCallTargets(0, 0);
+  ASSERT_NE(Targets, nullptr);
+  EXPECT_EQ(*Targets, std::vector<uint32_t>({0, 1}));
+  Targets = Mod->getIndirectCallTargets(0, 1);
+  ASSERT_NE(Targets, nullptr);
+  EXPECT_EQ(*Targets, std::vector<uint32_t>({2}));
+  EXPECT_EQ(Mod->getIndirectCallTargets(0, 2), nullptr);
+#endif
+
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(*Mod);
+  ASSERT_TRUE(InstRet);
+  Instance *Inst = *InstRet;
+
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(*Inst, 3, {makeI32(0), makeI32(10)},
+                                   Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, 23);
+
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(*Inst, 3, {makeI32(3), makeI32(10)},
+                                   Results));
+  EXPECT_EQ(Results[0].Value.I32, 23);
+
+  Results.clear();
+  EXPECT_FALSE(RT->callWasmFunction(*Inst, 3, {makeI32(2), makeI32(10)},
+                                    Results));
+  EXPECT_EQ(Inst->getError().getCode(), ErrorCode::IndirectCallTypeMismatch);
+  ASSERT_TRUE(Iso->deleteInstance(Inst));
+}
+
+// (module
+//   (type $t0 (func (param i32 i64) (result i64)))
+//   (type $t1 (func (param i32 i64 i64 i64 i64 i64 i64 i64) (result i64)))
+//   (type $t2 (func (param i64 i64 i64 i64 i64 i64 i64) (result i64)))
+//   (table 1 funcref)
+//   (elem (i32.const 0) $sum_indirect)
+//   (func $sum (export "sum") (type $t0)
+//     (if (i32.eqz (local.get 0)) (then (return (local.get 1))))
+//     (return_call $sum (i32.sub (local.get 0) (i32.const 1))
+//       (i64.add (local.get 1) (i64.extend_i32_u (local.get 0)))))
+//   (func $sum_indirect (export "sum_indirect") (type $t0)
+//     (if (i32.eqz (local.get 0)) (then (return (local.get 1))))
+//     (return_call_indirect (type $t0) (i32.sub (local.get 0) (i32.const 1))
+//       (i64.add (local.get 1) (i64.extend_i32_u (local.get 0)))
+//       (i32.const 0)))
+//   (func $ping (export "ping") (type $t1)
+//     (if (i32.eqz (local.get 0))
+//       (then (return_call $mix (local.get 1) (local.get 2) (local.get 3)
+//         (local.get 4) (local.get 5) (local.get 6) (local.get 7))))
+//     (return_call $pong (i32.sub (local.get 0) (i32.const 1)) (local.get 2)
+//       (local.get 3) (local.get 4) (local.get 5) (local.get 6) (local.get 7)
+//       (local.get 1)))
+//   (func $pong (type $t1)
+//     (return_call $ping (local.get 0) (local.get 1) (local.get 2)
+//       (local.get 3) (local.get 4) (local.get 5) (local.get 6) (local.get 7)))
+//   (func $mix (type $t2)
+//     (i64.add (i64.mul (i64.add (i64.mul (i64.add (i64.mul (i64.add (i64.mul
+//       (i64.add (i64.mul (i64.add (i64.mul (local.get 0) (i64.const 10))
+//       (local.get 1)) (i64.const 10)) (local.get 2)) (i64.const 10))
+//       (local.get 3)) (i64.const 10)) (local.get 4)) (i64.const 10))
+//       (local.get 5)) (i64.const 10)) (local.get 6))))
+static const uint8_t TailCallWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x1e, 0x03, 0x60,
+    0x02, 0x7f, 0x7e, 0x01, 0x7e, 0x60, 0x08, 0x7f, 0x7e, 0x7e, 0x7e, 0x7e,
+    0x7e, 0x7e, 0x7e, 0x01, 0x7e, 0x60, 0x07, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e,
+    0x7e, 0x7e, 0x01, 0x7e, 0x03, 0x06, 0x05, 0x00, 0x00, 0x01, 0x01, 0x02,
+    0x04, 0x04, 0x01, 0x70, 0x00, 0x01, 0x07, 0x1d, 0x03, 0x03, 0x73, 0x75,
+    0x6d, 0x00, 0x00, 0x0c, 0x73, 0x75, 0x6d, 0x5f, 0x69, 0x6e, 0x64, 0x69,
+    0x72, 0x65, 0x63, 0x74, 0x00, 0x01, 0x04, 0x70, 0x69, 0x6e, 0x67, 0x00,
+    0x02, 0x09, 0x07, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x01, 0x01, 0x0a, 0xa2,
+    0x01, 0x05, 0x18, 0x00, 0x20, 0x00, 0x45, 0x04, 0x40, 0x20, 0x01, 0x0f,
+    0x0b, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x20, 0x01, 0x20, 0x00, 0xad, 0x7c,
+    0x12, 0x00, 0x0b, 0x1b, 0x00, 0x20, 0x00, 0x45, 0x04, 0x40, 0x20, 0x01,
+    0x0f, 0x0b, 0x20, 0x00, 0x41, 0x01, 0x6b, 0x20, 0x01, 0x20, 0x00, 0xad,
+    0x7c, 0x41, 0x00, 0x13, 0x00, 0x00, 0x0b, 0x2d, 0x00, 0x20, 0x00, 0x45,
+    0x04, 0x40, 0x20, 0x01, 0x20, 0x02, 0x20, 0x03, 0x20, 0x04, 0x20, 0x05,
+    0x20, 0x06, 0x20, 0x07, 0x12, 0x04, 0x0b, 0x20, 0x00, 0x41, 0x01, 0x6b,
+    0x20, 0x02, 0x20, 0x03, 0x20, 0x04, 0x20, 0x05, 0x20, 0x06, 0x20, 0x07,
+    0x20, 0x01, 0x12, 0x03, 0x0b, 0x14, 0x00, 0x20, 0x00, 0x20, 0x01, 0x20,
+    0x02, 0x20, 0x03, 0x20, 0x04, 0x20, 0x05, 0x20, 0x06, 0x20, 0x07, 0x12,
+    0x02, 0x0b, 0x28, 0x00, 0x20, 0x00, 0x42, 0x0a, 0x7e, 0x20, 0x01, 0x7c,
+    0x42, 0x0a, 0x7e, 0x20, 0x02, 0x7c, 0x42, 0x0a, 0x7e, 0x20, 0x03, 0x7c,
+    0x42, 0x0a, 0x7e, 0x20, 0x04, 0x7c, 0x42, 0x0a, 0x7e, 0x20, 0x05, 0x7c,
+    0x42, 0x0a, 0x7e, 0x20, 0x06, 0x7c, 0x0b,
+};
+
+// (module
+//   (func $small (export "small") (param i32) (result i64)
+//     (return_call $big
+//       (i64.extend_i32_u (local.get 0)) (i64.extend_i32_u (local.get 0))
+//       (i64.extend_i32_u (local.get 0)) (i64.extend_i32_u (local.get 0))
+//       (i64.extend_i32_u (local.get 0)) (i64.extend_i32_u (local.get 0))
+//       (i64.extend_i32_u (local.get 0)) (i64.extend_i32_u (local.get 0))
+//       (i64.extend_i32_u (local.get 0))))
+//   (func $big (param i64 i64 i64 i64 i64 i64 i64 i64 i64) (result i64)
+//     (i64.add (local.get 0) (i64.add (local.get 1) (i64.add (local.get 2)
+//       (i64.add (local.get 3) (i64.add (local.get 4) (i64.add (local.get 5)
+//       (i64.add (local.get 6) (i64.add (local.get 7) (local.get 8)))))))))))
+static const uint8_t TailCallStackArgsWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x13, 0x02, 0x60,
+    0x01, 0x7f, 0x01, 0x7e, 0x60, 0x09, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e, 0x7e,
+    0x7e, 0x7e, 0x7e, 0x01, 0x7e, 0x03, 0x03, 0x02, 0x00, 0x01, 0x07, 0x09,
+    0x01, 0x05, 0x73, 0x6d, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x0a, 0x3e, 0x02,
+    0x1f, 0x00, 0x20, 0x00, 0xad, 0x20, 0x00, 0xad, 0x20, 0x00, 0xad, 0x20,
+    0x00, 0xad, 0x20, 0x00, 0xad, 0x20, 0x00, 0xad, 0x20, 0x00, 0xad, 0x20,
+    0x00, 0xad, 0x20, 0x00, 0xad, 0x12, 0x01, 0x0b, 0x1c, 0x00, 0x20, 0x00,
+    0x20, 0x01, 0x20, 0x02, 0x20, 0x03, 0x20, 0x04, 0x20, 0x05, 0x20, 0x06,
+    0x20, 0x07, 0x20, 0x08, 0x7c, 0x7c, 0x7c, 0x7c, 0x7c, 0x7c, 0x7c, 0x7c,
+    0x0b,
+};
+
+static void testTailCall(RunMode Mode) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.Mode = Mode;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet =
+      RT->loadModule("tail_call", TailCallWASM, sizeof(TailCallWASM));
+  ASSERT_TRUE(ModRet);
+  const Module::TailCallInfo &TailCalls = (*ModRet)->getTailCalls();
+  EXPECT_TRUE(TailCalls.HasIndirect);
+  EXPECT_EQ(TailCalls.TypePairs.size(), 3u);
+  // ping passes its last arguments on the stack, mix needs fewer slots
+  EXPECT_EQ((*ModRet)->getRunMode(), Mode);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+
+  // far deeper than the call stack allows without reusing the frames
+  constexpr int32_t Depth = 1000000;
+  constexpr int64_t Sum = int64_t(Depth) * (Depth + 1) / 2;
+  std::vector<TypedValue> Results;
+  for (uint32_t FuncIdx : {0u, 1u}) {
+    Results.clear();
+    ASSERT_TRUE(RT->callWasmFunction(**InstRet, FuncIdx,
+                                     {makeI32(Depth), makeI64(0)}, Results));
+    ASSERT_EQ(Results.size(), 1u);
+    EXPECT_EQ(Results[0].Value.I64, Sum);
+  }
+  // each ping rotates the arguments once, 1000000 % 7 is 1
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(
+      **InstRet, 2,
+      {makeI32(Depth), makeI64(1), makeI64(2), makeI64(3), makeI64(4),
+       makeI64(5), makeI64(6), makeI64(7)},
+      Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I64, 2345671);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+
+  // big needs more stack arguments than small got from its caller
+  ModRet = RT->loadModule("tail_call_stack_args", TailCallStackArgsWASM,
+                          sizeof(TailCallStackArgsWASM));
+  ASSERT_TRUE(ModRet);
+  EXPECT_EQ((*ModRet)->getRunMode(), RunMode::InterpMode);
+  InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 0, {makeI32(5)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I64, 45);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+TEST(Runtime, TailCall) {
+  testTailCall(getTestRuntimeConfig().Mode);
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  testTailCall(RunMode::SinglepassMode);
+#endif
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  testTailCall(RunMode::MultipassMode);
+#endif
+}
+
+// (module
+//   (type $pair (func (param i64 i64) (result i64 i64)))
+//   (type $spill (func (param i64) (result i64 i32 f64 i64 f32 f64)))
+//   (table funcref (elem $spill))
+//   (func $sum (export "sum") (param i64) (result i64 i64) (local i64)
+//     i64.const 0 local.get 0
+//     loop (type $pair)
+//       local.set 1 local.get 1 i64.add
+//       local.get 1 i64.const 1 i64.sub local.tee 1
+//       local.get 1 i64.eqz i32.eqz br_if 0
+//     end
+//     drop local.get 0)
+//   (func (export "run") (param i32) (result i64)
+//     local.get 0 i64.extend_i32_u call $sum
+//     i32.const 1
+//     if (param i64 i64) (result i64) i64.const 1000 i64.mul i64.add
+//     else drop end)
+//   ;; the third integer and floating-point results don't fit the registers
+//   (func $spill (export "spill") (param i64) (result i64 i32 f64 i64 f32 f64)
+//     local.get 0
+//     local.get 0 i32.wrap_i64 i32.const 2 i32.mul
+//     local.get 0 f64.convert_i64_s f64.const 0.5 f64.add
+//     local.get 0 i64.const 3 i64.mul
+//     local.get 0 f32.convert_i64_s f32.const 0.25 f32.add
+//     local.get 0 f64.convert_i64_s f64.const 0.125 f64.sub)
+//   ;; calls spill directly, or through the table when the index is not 0,
+//   ;; and returns the results in reverse order
+//   (func (export "reverse") (param i64 i32) (result f64 f32 i64 f64 i32 i64)
+//     (local i64 i32 f64 i64 f32 f64)
+//     local.get 1
+//     if (result i64 i32 f64 i64 f32 f64)
+//       (call_indirect (type $spill)
+//         (local.get 0) (i32.sub (local.get 1) (i32.const 1)))
+//     else
+//       local.get 0 call $spill
+//     end
+//     local.set 7 local.set 6 local.set 5 local.set 4 local.set 3 local.set 2
+//     local.get 7 local.get 6 local.get 5 local.get 4 local.get 3 local.get 2)
+//   ;; branches with two values out of blocks with params
+//   (func (export "pick") (param i32 i64 i64) (result i64)
+//     local.get 1 local.get 2
+//     block $b (type $pair)
+//       block $a (type $pair)
+//         local.get 0 br_table $a $b
+//       end
+//       i64.const 10 i64.mul
+//     end
+//     i64.sub))
+static const uint8_t MultiValueWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x3e, 0x08, 0x60,
+    0x02, 0x7e, 0x7e, 0x02, 0x7e, 0x7e, 0x60, 0x01, 0x7e, 0x06, 0x7e, 0x7f,
+    0x7c, 0x7e, 0x7d, 0x7c, 0x60, 0x01, 0x7e, 0x02, 0x7e, 0x7e, 0x60, 0x01,
+    0x7f, 0x01, 0x7e, 0x60, 0x02, 0x7e, 0x7e, 0x01, 0x7e, 0x60, 0x02, 0x7e,
+    0x7f, 0x06, 0x7c, 0x7d, 0x7e, 0x7c, 0x7f, 0x7e, 0x60, 0x00, 0x06, 0x7e,
+    0x7f, 0x7c, 0x7e, 0x7d, 0x7c, 0x60, 0x03, 0x7f, 0x7e, 0x7e, 0x01, 0x7e,
+    0x03, 0x06, 0x05, 0x02, 0x03, 0x01, 0x05, 0x07, 0x04, 0x04, 0x01, 0x70,
+    0x00, 0x01, 0x07, 0x26, 0x05, 0x03, 0x73, 0x75, 0x6d, 0x00, 0x00, 0x03,
+    0x72, 0x75, 0x6e, 0x00, 0x01, 0x05, 0x73, 0x70, 0x69, 0x6c, 0x6c, 0x00,
+    0x02, 0x07, 0x72, 0x65, 0x76, 0x65, 0x72, 0x73, 0x65, 0x00, 0x03, 0x04,
+    0x70, 0x69, 0x63, 0x6b, 0x00, 0x04, 0x09, 0x07, 0x01, 0x00, 0x41, 0x00,
+    0x0b, 0x01, 0x02, 0x0a, 0xbb, 0x01, 0x05, 0x20, 0x01, 0x01, 0x7e, 0x42,
+    0x00, 0x20, 0x00, 0x03, 0x00, 0x21, 0x01, 0x20, 0x01, 0x7c, 0x20, 0x01,
+    0x42, 0x01, 0x7d, 0x22, 0x01, 0x20, 0x01, 0x50, 0x45, 0x0d, 0x00, 0x0b,
+    0x1a, 0x20, 0x00, 0x0b, 0x13, 0x00, 0x20, 0x00, 0xad, 0x10, 0x00, 0x41,
+    0x01, 0x04, 0x04, 0x42, 0xe8, 0x07, 0x7e, 0x7c, 0x05, 0x1a, 0x0b, 0x0b,
+    0x32, 0x00, 0x20, 0x00, 0x20, 0x00, 0xa7, 0x41, 0x02, 0x6c, 0x20, 0x00,
+    0xb9, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xe0, 0x3f, 0xa0, 0x20,
+    0x00, 0x42, 0x03, 0x7e, 0x20, 0x00, 0xb4, 0x43, 0x00, 0x00, 0x80, 0x3e,
+    0x92, 0x20, 0x00, 0xb9, 0x44, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xc0,
+    0x3f, 0xa1, 0x0b, 0x3a, 0x06, 0x01, 0x7e, 0x01, 0x7f, 0x01, 0x7c, 0x01,
+    0x7e, 0x01, 0x7d, 0x01, 0x7c, 0x20, 0x01, 0x04, 0x06, 0x20, 0x00, 0x20,
+    0x01, 0x41, 0x01, 0x6b, 0x11, 0x01, 0x00, 0x05, 0x20, 0x00, 0x10, 0x02,
+    0x0b, 0x21, 0x07, 0x21, 0x06, 0x21, 0x05, 0x21, 0x04, 0x21, 0x03, 0x21,
+    0x02, 0x20, 0x07, 0x20, 0x06, 0x20, 0x05, 0x20, 0x04, 0x20, 0x03, 0x20,
+    0x02, 0x0b, 0x16, 0x00, 0x20, 0x01, 0x20, 0x02, 0x02, 0x00, 0x02, 0x00,
+    0x20, 0x00, 0x0e, 0x01, 0x00, 0x01, 0x0b, 0x42, 0x0a, 0x7e, 0x0b, 0x7d,
+    0x0b,
+};
+
+static void testMultiValue(RunMode Mode) {
+  RuntimeConfig Config = getTestRuntimeConfig();
+  Config.Mode = Mode;
+  auto RT = createTestRuntime(Config);
+  ASSERT_NE(RT, nullptr);
+  auto ModRet =
+      RT->loadModule("multi_value", MultiValueWASM, sizeof(MultiValueWASM));
+  ASSERT_TRUE(ModRet);
+  EXPECT_EQ((*ModRet)->getRunMode(), Mode);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 0, {makeI64(10)}, Results));
+  ASSERT_EQ(Results.size(), 2u);
+  EXPECT_EQ(Results[0].Value.I64, 55);
+  EXPECT_EQ(Results[1].Value.I64, 10);
+
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 1, {makeI32(10)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I64, 55 + 10 * 1000);
+
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, 2, {makeI64(7)}, Results));
+  ASSERT_EQ(Results.size(), 6u);
+  EXPECT_EQ(Results[0].Value.I64, 7);
+  EXPECT_EQ(Results[1].Value.I32, 14);
+  EXPECT_EQ(Results[2].Value.F64, 7.5);
+  EXPECT_EQ(Results[3].Value.I64, 21);
+  EXPECT_EQ(Results[4].Value.F32, 7.25f);
+  EXPECT_EQ(Results[5].Value.F64, 6.875);
+
+  // the direct call, then the indirect one
+  for (int32_t TableIdx : {0, 1}) {
+    Results.clear();
+    ASSERT_TRUE(RT->callWasmFunction(
+        **InstRet, 3, {makeI64(7), makeI32(TableIdx)}, Results));
+    ASSERT_EQ(Results.size(), 6u);
+    EXPECT_EQ(Results[0].Value.F64, 6.875);
+    EXPECT_EQ(Results[1].Value.F32, 7.25f);
+    EXPECT_EQ(Results[2].Value.I64, 21);
+    EXPECT_EQ(Results[3].Value.F64, 7.5);
+    EXPECT_EQ(Results[4].Value.I32, 14);
+    EXPECT_EQ(Results[5].Value.I64, 7);
+  }
+
+  // br_table to the inner block, then to the outer one
+  for (int32_t Target : {0, 1, 5}) {
+    Results.clear();
+    ASSERT_TRUE(RT->callWasmFunction(
+        **InstRet, 4, {makeI32(Target), makeI64(100), makeI64(3)}, Results));
+    ASSERT_EQ(Results.size(), 1u);
+    EXPECT_EQ(Results[0].Value.I64, Target == 0 ? 70 : 97);
+  }
+
+  // handles of multi-value functions must not abort when created
+  const FunctionHandle *Handle = (*ModRet)->getFunctionHandle(2);
+  ASSERT_NE(Handle, nullptr);
+  EXPECT_EQ(Handle->getNumReturns(), 6u);
+  EXPECT_EQ(Handle->getReturnType(4), WASMType::F32);
+  UntypedValue Arg;
+  Arg.I64 = 7;
+  UntypedValue HandleResults[6];
+  ASSERT_TRUE(RT->callWasmFunction(**InstRet, *Handle, &Arg, HandleResults));
+  EXPECT_EQ(HandleResults[0].I64, 7);
+  EXPECT_EQ(HandleResults[1].I32, 14);
+  EXPECT_EQ(HandleResults[2].F64, 7.5);
+  EXPECT_EQ(HandleResults[3].I64, 21);
+  EXPECT_EQ(HandleResults[4].F32, 7.25f);
+  EXPECT_EQ(HandleResults[5].F64, 6.875);
+  ASSERT_TRUE(Iso->deleteInstance(*InstRet));
+}
+
+TEST(Runtime, MultiValue) {
+  testMultiValue(getTestRuntimeConfig().Mode);
+#ifdef ZEN_ENABLE_SINGLEPASS_JIT
+  testMultiValue(RunMode::SinglepassMode);
+#endif
+#ifdef ZEN_ENABLE_MULTIPASS_JIT
+  testMultiValue(RunMode::MultipassMode);
+#endif
+}
+
+// (module
+//   (memory 1)
+//   (data (i32.const 0) "\80\ff\ff\ff\fe")
+//   (func (export "load_ext") (param i32) (result i64)
+//     local.get 0 i32.load8_s i64.extend_i32_u
+//     local.get 0 i32.load16_s i64.extend_i32_s i64.add
+//     local.get 0 i32.load offset=1 i64.extend_i32_s i64.add
+//     local.get 0 i32.load8_u offset=4 i64.extend_i32_s i64.add)
+//   (func (export "wrap") (param i32) (result i32)
+//     local.get 0 i64.extend_i32_s i32.wrap_i64
+//     local.get 0 i64.extend_i32_u i32.wrap_i64 i32.add))
+static const uint8_t PeepholeWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x0b, 0x02, 0x60,
+    0x01, 0x7f, 0x01, 0x7e, 0x60, 0x01, 0x7f, 0x01, 0x7f, 0x03, 0x03, 0x02,
+    0x00, 0x01, 0x05, 0x03, 0x01, 0x00, 0x01, 0x07, 0x13, 0x02, 0x08, 0x6c,
+    0x6f, 0x61, 0x64, 0x5f, 0x65, 0x78, 0x74, 0x00, 0x00, 0x04, 0x77, 0x72,
+    0x61, 0x70, 0x00, 0x01, 0x0a, 0x2b, 0x02, 0x1d, 0x00, 0x20, 0x00, 0x2c,
+    0x00, 0x00, 0xad, 0x20, 0x00, 0x2e, 0x01, 0x00, 0xac, 0x7c, 0x20, 0x00,
+    0x28, 0x02, 0x01, 0xac, 0x7c, 0x20, 0x00, 0x2d, 0x00, 0x04, 0xac, 0x7c,
+    0x0b, 0x0b, 0x00, 0x20, 0x00, 0xac, 0xa7, 0x20, 0x00, 0xad, 0xa7, 0x6a,
+    0x0b, 0x0b, 0x0b, 0x01, 0x00, 0x41, 0x00, 0x0b, 0x05, 0x80, 0xff, 0xff,
+    0xff, 0xfe,
+};
+
+TEST(Runtime, Peephole) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("peephole", PeepholeWASM, sizeof(PeepholeWASM));
+  ASSERT_TRUE(ModRet);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet);
+  ASSERT_TRUE(InstRet);
+  Instance *Inst = *InstRet;
+
+  // a zero-extended load8_s keeps its own sign extension
+  std::vector<TypedValue> Results;
+  ASSERT_TRUE(RT->callWasmFunction(*Inst, 0, {makeI32(0)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I64,
+            int64_t(0xffffff80) - 0x80 - 0x1000001 + 0xfe);
+
+  Results.clear();
+  ASSERT_TRUE(RT->callWasmFunction(*Inst, 1, {makeI32(-5)}, Results));
+  ASSERT_EQ(Results.size(), 1u);
+  EXPECT_EQ(Results[0].Value.I32, -10);
+
+  Results.clear();
+  EXPECT_FALSE(RT->callWasmFunction(*Inst, 0, {makeI32(65535)}, Results));
+  EXPECT_EQ(Inst->getError().getCode(), ErrorCode::OutOfBoundsMemory);
+  ASSERT_TRUE(Iso->deleteInstance(Inst));
+}
+
+#if defined(ZEN_ENABLE_JIT_PROFILER) && defined(ZEN_ENABLE_SINGLEPASS_JIT)
+// (module (func (export "spin") (param i32) (result i32) (local i32)
+//   loop local.get 1 i32.const 1 i32.add local.tee 1 local.get 0 i32.lt_u
+//   br_if 0 end local.get 1))
+static const uint8_t SpinWASM[] = {
+    0x00, 0x61, 0x73, 0x6d, 0x01, 0x00, 0x00, 0x00, 0x01, 0x06, 0x01,
+    0x60, 0x01, 0x7f, 0x01, 0x7f, 0x03, 0x02, 0x01, 0x00, 0x07, 0x08,
+    0x01, 0x04, 0x73, 0x70, 0x69, 0x6e, 0x00, 0x00, 0x0a, 0x17, 0x01,
+    0x15, 0x01, 0x01, 0x7f, 0x03, 0x40, 0x20, 0x01, 0x41, 0x01, 0x6a,
+    0x22, 0x01, 0x20, 0x00, 0x49, 0x0d, 0x00, 0x0b, 0x20, 0x01, 0x0b,
+};
+
+TEST(Runtime, SamplingProfiler) {
+  auto RT = createTestRuntime();
+  ASSERT_NE(RT, nullptr);
+  auto ModRet = RT->loadModule("profiled", SpinWASM, sizeof(SpinWASM));
+  ASSERT_TRUE(ModRet);
+  const FunctionHandle *Handle = (*ModRet)->getFunctionHandle("spin");
+  ASSERT_NE(Handle, nullptr);
+  Isolation *Iso = RT->createManagedIsolation();
+  ASSERT_NE(Iso, nullptr);
+  auto InstRet = Iso->createInstance(**ModRet, UINT64_MAX);
+  ASSERT_TRUE(InstRet);
+
+  ASSERT_TRUE(SamplingProfiler::start(1000));
+  EXPECT_FALSE(SamplingProfiler::start(1000));
+  UntypedValue Arg;
+  Arg.I32 = 1 << 24;
+  UntypedValue Result;
+  for (uint32_t I = 0; I < 1000 && SamplingProfiler::getNumSamples() < 20;
+       ++I) {
+    ASSERT_TRUE(RT->callWasmFunction(**InstRet, *Handle, &Arg, &Result));
+    EXPECT_EQ(Result.I32, Arg.I32);
+  }
+  SamplingProfiler::stop();
+  EXPECT_FALSE(SamplingProfiler::isRunning());
+
+  std::string Stacks = SamplingProfiler::getCollapsedStacks();
+  EXPECT_NE(Stacks.find("profiled;jitfunc_0+0x"), std::string::npos);
+  std::string StacksNoOffsets = SamplingProfiler::getCollapsedStacks(false);
+  EXPECT_NE(StacksNoOffsets.find("profiled;jitfunc_0 "), std::string::npos);
+}
+#endif // ZEN_ENABLE_JIT_PROFILER && ZEN_ENABLE_SINGLEPASS_JIT
+
+} // namespace zen::test
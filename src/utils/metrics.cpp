@@ -0,0 +1,251 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "utils/metrics.h"
+
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <vector>
+
+namespace zen::utils {
+
+namespace {
+
+constexpr uint32_t NumLatencies =
+    common::to_underlying(MetricLatency::NumMetricLatencies);
+constexpr uint32_t NumCounters =
+    common::to_underlying(MetricCounter::NumMetricCounters);
+constexpr uint32_t NumBuckets = Metrics::NumLatencyBuckets;
+
+struct HistogramShard {
+  std::atomic<uint64_t> Count{0};
+  std::atomic<uint64_t> SumNanos{0};
+  std::atomic<uint64_t> Buckets[NumBuckets] = {};
+};
+
+// written only by the thread owning it, read by snapshots
+struct MetricsShard {
+  HistogramShard Latencies[NumLatencies];
+  std::atomic<uint64_t> Counters[NumCounters] = {};
+};
+
+// the shards are never freed, so that the samples of exited threads are kept
+// and snapshots can read any shard without synchronizing with its owner
+class ShardRegistry {
+public:
+  MetricsShard *acquire() {
+    common::LockGuard<common::Mutex> Lock(Mtx);
+    if (!FreeShards.empty()) {
+      MetricsShard *Shard = FreeShards.back();
+      FreeShards.pop_back();
+      return Shard;
+    }
+    Shards.push_back(new MetricsShard);
+    return Shards.back();
+  }
+
+  void release(MetricsShard *Shard) {
+    common::LockGuard<common::Mutex> Lock(Mtx);
+    FreeShards.push_back(Shard);
+  }
+
+  template <typename Fn> void forEachShard(Fn &&F) {
+    common::LockGuard<common::Mutex> Lock(Mtx);
+    for (MetricsShard *Shard : Shards) {
+      F(*Shard);
+    }
+  }
+
+private:
+  common::Mutex Mtx;
+  std::vector<MetricsShard *> Shards;
+  std::vector<MetricsShard *> FreeShards;
+};
+
+ShardRegistry &getShardRegistry() {
+  // leaked on purpose, threads may still record after static destruction
+  static ShardRegistry *Registry = new ShardRegistry;
+  return *Registry;
+}
+
+struct ThreadShard {
+  MetricsShard *Shard = nullptr;
+
+  ~ThreadShard() {
+    if (Shard) {
+      getShardRegistry().release(Shard);
+    }
+  }
+};
+
+thread_local ThreadShard CurrentShard;
+
+MetricsShard &getThreadShard() {
+  if (ZEN_UNLIKELY(!CurrentShard.Shard)) {
+    CurrentShard.Shard = getShardRegistry().acquire();
+  }
+  return *CurrentShard.Shard;
+}
+
+// only the owner thread writes to a shard, so a plain load and store is
+// enough and avoids a locked instruction
+void increase(std::atomic<uint64_t> &Value, uint64_t Delta) {
+  Value.store(Value.load(std::memory_order_relaxed) + Delta,
+              std::memory_order_relaxed);
+}
+
+uint32_t getBucketIndex(uint64_t Nanos) {
+  // round up, a sample of 1999 ns is not <= 1 us
+  uint64_t Micros = (Nanos + 999) / 1000;
+  if (Micros <= 1) {
+    return 0;
+  }
+  // ceil(log2(Micros))
+  uint32_t Index = 64 - __builtin_clzll(Micros - 1);
+  return Index < NumBuckets ? Index : NumBuckets - 1;
+}
+
+void appendFormat(std::string &Out, const char *Format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+void appendFormat(std::string &Out, const char *Format, ...) {
+  char Buf[256];
+  va_list Args;
+  va_start(Args, Format);
+  int Len = std::vsnprintf(Buf, sizeof(Buf), Format, Args);
+  va_end(Args);
+  ZEN_ASSERT(Len >= 0 && size_t(Len) < sizeof(Buf));
+  Out.append(Buf, Len);
+}
+
+} // namespace
+
+void Metrics::recordLatency(MetricLatency Metric, uint64_t Nanos) {
+  HistogramShard &Hist =
+      getThreadShard().Latencies[common::to_underlying(Metric)];
+  increase(Hist.Count, 1);
+  increase(Hist.SumNanos, Nanos);
+  increase(Hist.Buckets[getBucketIndex(Nanos)], 1);
+}
+
+void Metrics::addCounter(MetricCounter Metric, uint64_t Delta) {
+  increase(getThreadShard().Counters[common::to_underlying(Metric)], Delta);
+}
+
+Metrics::Snapshot Metrics::getSnapshot() {
+  Snapshot Snap;
+  getShardRegistry().forEachShard([&Snap](const MetricsShard &Shard) {
+    for (uint32_t I = 0; I < NumLatencies; ++I) {
+      const HistogramShard &Src = Shard.Latencies[I];
+      Histogram &Dst = Snap.Latencies[I];
+      Dst.Count += Src.Count.load(std::memory_order_relaxed);
+      Dst.SumNanos += Src.SumNanos.load(std::memory_order_relaxed);
+      for (uint32_t J = 0; J < NumBuckets; ++J) {
+        Dst.Buckets[J] += Src.Buckets[J].load(std::memory_order_relaxed);
+      }
+    }
+    for (uint32_t I = 0; I < NumCounters; ++I) {
+      Snap.Counters[I] += Shard.Counters[I].load(std::memory_order_relaxed);
+    }
+  });
+  return Snap;
+}
+
+void Metrics::reset() {
+  getShardRegistry().forEachShard([](MetricsShard &Shard) {
+    for (HistogramShard &Hist : Shard.Latencies) {
+      Hist.Count.store(0, std::memory_order_relaxed);
+      Hist.SumNanos.store(0, std::memory_order_relaxed);
+      for (auto &Bucket : Hist.Buckets) {
+        Bucket.store(0, std::memory_order_relaxed);
+      }
+    }
+    for (auto &Counter : Shard.Counters) {
+      Counter.store(0, std::memory_order_relaxed);
+    }
+  });
+}
+
+const char *Metrics::getLatencyName(MetricLatency Metric) {
+  static constexpr const char *Names[] = {
+      "load",
+      "singlepass_compilation",
+      "multipass_compilation",
+      "multipass_lazy_compilation",
+      "instantiation",
+      "execution",
+      "host_call",
+  };
+  static_assert(sizeof(Names) / sizeof(Names[0]) == NumLatencies);
+  return Names[common::to_underlying(Metric)];
+}
+
+const char *Metrics::getCounterName(MetricCounter Metric) {
+  static constexpr const char *Names[] = {
+      "load_errors",
+      "instantiation_errors",
+      "traps",
+      "gas_used",
+      "greedy_ra_fallbacks",
+      "adaptive_fast_ra",
+  };
+  static_assert(sizeof(Names) / sizeof(Names[0]) == NumCounters);
+  return Names[common::to_underlying(Metric)];
+}
+
+std::string Metrics::Snapshot::toPrometheus() const {
+  std::string Out;
+  for (uint32_t I = 0; I < NumLatencies; ++I) {
+    const char *Name = getLatencyName(MetricLatency(I));
+    const Histogram &Hist = Latencies[I];
+    appendFormat(Out, "# TYPE zen_%s_seconds histogram\n", Name);
+    uint64_t Cumulative = 0;
+    // the last bucket has no upper bound, it is covered by +Inf
+    for (uint32_t J = 0; J + 1 < NumBuckets; ++J) {
+      Cumulative += Hist.Buckets[J];
+      appendFormat(Out, "zen_%s_seconds_bucket{le=\"%g\"} %" PRIu64 "\n",
+                   Name, double(1ULL << J) * 1e-6, Cumulative);
+    }
+    appendFormat(Out, "zen_%s_seconds_bucket{le=\"+Inf\"} %" PRIu64 "\n",
+                 Name, Hist.Count);
+    appendFormat(Out, "zen_%s_seconds_sum %.9f\n", Name,
+                 double(Hist.SumNanos) * 1e-9);
+    appendFormat(Out, "zen_%s_seconds_count %" PRIu64 "\n", Name, Hist.Count);
+  }
+  for (uint32_t I = 0; I < NumCounters; ++I) {
+    const char *Name = getCounterName(MetricCounter(I));
+    appendFormat(Out, "# TYPE zen_%s_total counter\n", Name);
+    appendFormat(Out, "zen_%s_total %" PRIu64 "\n", Name, Counters[I]);
+  }
+  return Out;
+}
+
+std::string Metrics::Snapshot::toJSON() const {
+  std::string Out = "{\"bucket_upper_bounds_us\":[";
+  for (uint32_t J = 0; J + 1 < NumBuckets; ++J) {
+    appendFormat(Out, "%s%llu", J > 0 ? "," : "", 1ULL << J);
+  }
+  Out += "],\"latencies\":{";
+  for (uint32_t I = 0; I < NumLatencies; ++I) {
+    const Histogram &Hist = Latencies[I];
+    appendFormat(Out,
+                 "%s\"%s\":{\"count\":%" PRIu64 ",\"sum_ns\":%" PRIu64
+                 ",\"buckets\":[",
+                 I > 0 ? "," : "", getLatencyName(MetricLatency(I)),
+                 Hist.Count, Hist.SumNanos);
+    for (uint32_t J = 0; J < NumBuckets; ++J) {
+      appendFormat(Out, "%s%" PRIu64, J > 0 ? "," : "", Hist.Buckets[J]);
+    }
+    Out += "]}";
+  }
+  Out += "},\"counters\":{";
+  for (uint32_t I = 0; I < NumCounters; ++I) {
+    appendFormat(Out, "%s\"%s\":%" PRIu64, I > 0 ? "," : "",
+                 getCounterName(MetricCounter(I)), Counters[I]);
+  }
+  Out += "}}";
+  return Out;
+}
+
+} // namespace zen::utils
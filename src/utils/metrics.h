@@ -0,0 +1,101 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_UTILS_METRICS_H
+#define ZEN_UTILS_METRICS_H
+
+#include "common/defines.h"
+
+#include <atomic>
+#include <string>
+
+namespace zen::utils {
+
+/// Latencies recorded into histograms
+enum class MetricLatency : uint32_t {
+  Load = 0,
+  SinglepassCompilation = 1,
+  MultipassCompilation = 2,     // eager mode, or precompilation in lazy mode
+  MultipassLazyCompilation = 3, // a function compiled on request in lazy mode
+  Instantiation = 4,
+  Execution = 5,
+  HostCall = 6, // only host functions called by the interpreter
+  NumMetricLatencies
+};
+
+enum class MetricCounter : uint32_t {
+  LoadErrors = 0,
+  InstantiationErrors = 1,
+  Traps = 2,
+  GasUsed = 3,
+  GreedyRAFallbacks = 4, // multipass functions over the greedy RA budget
+  AdaptiveFastRA = 5,    // multipass functions the adaptive RA made fast
+  NumMetricCounters
+};
+
+/// Process-wide metrics, always on. Every thread records into its own shard
+/// with relaxed atomics, so recording never takes a lock or contends with
+/// other threads. Snapshots sum the shards of all threads which ever
+/// recorded, including exited ones.
+class Metrics final {
+public:
+  /// Latency buckets are powers of two in microseconds: bucket I counts the
+  /// samples <= 2^I us, the last bucket counts the larger ones
+  static constexpr uint32_t NumLatencyBuckets = 26;
+
+  struct Histogram {
+    uint64_t Count = 0;
+    uint64_t SumNanos = 0;
+    uint64_t Buckets[NumLatencyBuckets] = {0};
+  };
+
+  struct Snapshot {
+    Histogram
+        Latencies[common::to_underlying(MetricLatency::NumMetricLatencies)];
+    uint64_t Counters[common::to_underlying(MetricCounter::NumMetricCounters)] =
+        {0};
+
+    /// Prometheus text exposition format
+    std::string toPrometheus() const;
+
+    std::string toJSON() const;
+  };
+
+  static void recordLatency(MetricLatency Metric, uint64_t Nanos);
+
+  static void addCounter(MetricCounter Metric, uint64_t Delta = 1);
+
+  static Snapshot getSnapshot();
+
+  /// \warning samples recorded concurrently may survive the reset
+  static void reset();
+
+  static const char *getLatencyName(MetricLatency Metric);
+
+  static const char *getCounterName(MetricCounter Metric);
+};
+
+/// Record the lifetime of this object as a sample of a latency metric
+class ScopedMetricTimer {
+public:
+  explicit ScopedMetricTimer(MetricLatency Metric)
+      : Metric(Metric), Start(common::SteadyClock::now()) {}
+
+  ~ScopedMetricTimer() {
+    auto End = common::SteadyClock::now();
+    Metrics::recordLatency(
+        Metric, static_cast<uint64_t>(
+                    common::chrono::duration<double, std::nano>(End - Start)
+                        .count()));
+  }
+
+  NONCOPYABLE(ScopedMetricTimer);
+
+private:
+  MetricLatency Metric;
+  common::SteadyClock::time_point Start;
+};
+
+} // namespace zen::utils
+
+#endif // ZEN_UTILS_METRICS_H
@@ -3,11 +3,47 @@
 
 #include "utils/statistics.h"
 #include "utils/logging.h"
+#include <algorithm>
 #include <cstdio>
 #include <ratio>
+#include <string>
 
 namespace zen::utils {
 
+namespace {
+
+// number of the slowest function compilations in the report
+constexpr uint32_t NumReportedFuncCompilations = 10;
+
+constexpr const char *CompilePassNames[] = {
+    "mir_build",
+    "mir_verify",
+    "dead_block_elim",
+    "cg_lowering",
+    "live_intervals",
+    "register_coalescing",
+    "reg_alloc",
+    "prolog_epilog",
+    "mc_emission",
+};
+static_assert(sizeof(CompilePassNames) / sizeof(CompilePassNames[0]) ==
+              FunctionCompileRecord::NumPasses);
+
+} // namespace
+
+const char *getCompilePassName(CompilePass Pass) {
+  ZEN_ASSERT(Pass < CompilePass::NumCompilePasses);
+  return CompilePassNames[common::to_underlying(Pass)];
+}
+
+float FunctionCompileRecord::getTotalTimeCost() const {
+  float Total = 0;
+  for (float TimeCost : TimeCosts) {
+    Total += TimeCost;
+  }
+  return Total;
+}
+
 Statistics::StatisticTimer Statistics::startRecord(StatisticPhase Phase) {
   if (!Enabled) {
     return -1u;
@@ -24,15 +60,18 @@ void Statistics::stopRecord(StatisticTimer Timer) {
     return;
   }
 
-  ZEN_ASSERT(Timers.find(Timer) != Timers.end());
-  common::LockGuard<common::Mutex> Lock(Mtx);
   auto End = common::SteadyClock::now();
-  auto Start = Timers[Timer].second;
+  common::LockGuard<common::Mutex> Lock(Mtx);
+  auto It = Timers.find(Timer);
+  // timers may be cleared by a failed module loading on another thread
+  if (It == Timers.end()) {
+    return;
+  }
+  auto [Phase, Start] = It->second;
   float TimeCost =
       common::chrono::duration<float, std::milli>(End - Start).count();
-  auto Phase = Timers[Timer].first;
   Records.emplace_back(Phase, TimeCost);
-  Timers.erase(Timer);
+  Timers.erase(It);
 }
 
 void Statistics::revertRecord(StatisticTimer Timer) {
@@ -40,7 +79,6 @@ void Statistics::revertRecord(StatisticTimer Timer) {
     return;
   }
 
-  ZEN_ASSERT(Timers.find(Timer) != Timers.end());
   common::LockGuard<common::Mutex> Lock(Mtx);
   Timers.erase(Timer);
 }
@@ -54,6 +92,48 @@ void Statistics::clearAllTimers() {
   Timers.clear();
 }
 
+float Statistics::getTotalTimeCost(StatisticPhase Phase) const {
+  float Total = 0;
+  common::LockGuard<common::Mutex> Lock(Mtx);
+  for (const auto &[RecordPhase, TimeCost] : Records) {
+    if (RecordPhase == Phase) {
+      Total += TimeCost;
+    }
+  }
+  return Total;
+}
+
+void Statistics::recordFunctionCompilation(
+    const FunctionCompileRecord &Record) {
+  if (!Enabled) {
+    return;
+  }
+
+  common::LockGuard<common::Mutex> Lock(Mtx);
+  FuncCompileRecords.push_back(Record);
+}
+
+std::vector<FunctionCompileRecord>
+Statistics::getSlowestFunctionCompilations(uint32_t N) const {
+  std::vector<FunctionCompileRecord> Slowest;
+  {
+    common::LockGuard<common::Mutex> Lock(Mtx);
+    Slowest = FuncCompileRecords;
+  }
+  auto IsSlower = [](const FunctionCompileRecord &A,
+                     const FunctionCompileRecord &B) {
+    return A.getTotalTimeCost() > B.getTotalTimeCost();
+  };
+  if (Slowest.size() > N) {
+    std::partial_sort(Slowest.begin(), Slowest.begin() + N, Slowest.end(),
+                      IsSlower);
+    Slowest.resize(N);
+  } else {
+    std::sort(Slowest.begin(), Slowest.end(), IsSlower);
+  }
+  return Slowest;
+}
+
 void Statistics::report() const {
   if (!Enabled) {
     return;
@@ -131,8 +211,63 @@ void Statistics::report() const {
 
   ZEN_LOG_INFO("Total:\t\t%.3fms", TotalTimeCost);
 
+  reportFunctionCompilations();
+
   ZEN_LOG_INFO(
       "=================  [End] ZetaEngine Statistics =================");
 }
 
+void Statistics::reportFunctionCompilations() const {
+  constexpr uint32_t NumPasses = FunctionCompileRecord::NumPasses;
+  float PassTimeCosts[NumPasses] = {0};
+  size_t PassMemoryUsages[NumPasses] = {0};
+  float TotalTimeCost = 0;
+  size_t NumRecords = 0;
+  {
+    common::LockGuard<common::Mutex> Lock(Mtx);
+    NumRecords = FuncCompileRecords.size();
+    for (const FunctionCompileRecord &Record : FuncCompileRecords) {
+      for (uint32_t I = 0; I < NumPasses; ++I) {
+        PassTimeCosts[I] += Record.TimeCosts[I];
+        PassMemoryUsages[I] += Record.MemoryUsages[I];
+        TotalTimeCost += Record.TimeCosts[I];
+      }
+    }
+  }
+  if (NumRecords == 0) {
+    return;
+  }
+
+  // the passes of concurrent compilations overlap, so the sum may exceed the
+  // wall time of JIT compilation
+  ZEN_LOG_INFO("JIT Passes:\t\t%zu functions, total %.3fms", NumRecords,
+               TotalTimeCost);
+  for (uint32_t I = 0; I < NumPasses; ++I) {
+    float Percent = TotalTimeCost > 0 ? PassTimeCosts[I] / TotalTimeCost * 100
+                                      : 0;
+    ZEN_LOG_INFO("  %-20s%.3fms, %.2f%%, %zuKB", CompilePassNames[I],
+                 PassTimeCosts[I], Percent, PassMemoryUsages[I] / 1024);
+  }
+
+  ZEN_LOG_INFO("Slowest JIT Compiled Functions:");
+  for (const FunctionCompileRecord &Record :
+       getSlowestFunctionCompilations(NumReportedFuncCompilations)) {
+    // name the passes taking a tenth of the function or more
+    std::string Breakdown;
+    float FuncTimeCost = Record.getTotalTimeCost();
+    for (uint32_t I = 0; I < NumPasses; ++I) {
+      if (Record.TimeCosts[I] * 10 < FuncTimeCost) {
+        continue;
+      }
+      char Buf[64];
+      std::snprintf(Buf, sizeof(Buf), "%s%s %.3fms",
+                    Breakdown.empty() ? "" : ", ", CompilePassNames[I],
+                    Record.TimeCosts[I]);
+      Breakdown += Buf;
+    }
+    ZEN_LOG_INFO("  func %u: %.3fms (%s)", Record.FuncIdx, FuncTimeCost,
+                 Breakdown.c_str());
+  }
+}
+
 } // namespace zen::utils
@@ -25,6 +25,35 @@ enum class StatisticPhase : uint32_t {
   NumStatisticPhases
 };
 
+/// Stages of the multipass JIT compilation of a function
+enum class CompilePass : uint32_t {
+  MIRBuild = 0,
+  MIRVerify = 1,
+  DeadBlockElim = 2,
+  CgLowering = 3,    // including the peephole optimization
+  LiveIntervals = 4, // including the analyses it depends on
+  RegisterCoalescing = 5,
+  RegAlloc = 6,     // greedy or fast, including the rewriting
+  PrologEpilog = 7, // including the post-RA pseudo expansion
+  MCEmission = 8,
+  NumCompilePasses
+};
+
+struct FunctionCompileRecord {
+  static constexpr uint32_t NumPasses =
+      common::to_underlying(CompilePass::NumCompilePasses);
+
+  uint32_t FuncIdx = 0; // excluding imported functions
+  // in milliseconds
+  float TimeCosts[NumPasses] = {0};
+  // bytes allocated from the compilation memory pool
+  size_t MemoryUsages[NumPasses] = {0};
+
+  float getTotalTimeCost() const;
+};
+
+const char *getCompilePassName(CompilePass Pass);
+
 class Statistics final {
   typedef common::SteadyClock::time_point TimePoint;
   typedef uint32_t StatisticTimer;
@@ -45,15 +74,29 @@ public:
 
   void clearAllTimers();
 
+  bool isEnabled() const { return Enabled; }
+
+  /// \return the sum of the records of \p Phase in milliseconds
+  float getTotalTimeCost(StatisticPhase Phase) const;
+
+  void recordFunctionCompilation(const FunctionCompileRecord &Record);
+
+  /// \return at most \p N function compilations, slowest first
+  std::vector<FunctionCompileRecord>
+  getSlowestFunctionCompilations(uint32_t N) const;
+
   void report() const;
 
 private:
+  void reportFunctionCompilations() const;
+
   const bool Enabled;
-  common::Mutex Mtx;
+  mutable common::Mutex Mtx;
   StatisticTimer TimerCounter = 0;
   typedef std::pair<StatisticPhase, TimePoint> TimerPair;
   std::unordered_map<StatisticTimer, TimerPair> Timers;
   std::vector<StatisticRecord> Records;
+  std::vector<FunctionCompileRecord> FuncCompileRecords;
 };
 
 } // namespace zen::utils
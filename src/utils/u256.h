@@ -0,0 +1,186 @@
+// Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef ZEN_UTILS_U256_H
+#define ZEN_UTILS_U256_H
+
+#include "common/defines.h"
+
+namespace zen::utils {
+
+// 256-bit unsigned integer of 4 little-endian 64-bit limbs, the same layout
+// as in linear memory. The operations wrap around like the evm ones, and
+// the results may alias the operands.
+struct U256 {
+  uint64_t Limbs[4];
+};
+
+using U128 = unsigned __int128;
+
+// \return the number of significant bits of \p Val
+inline uint32_t getU256BitWidth(const U256 &Val) {
+  for (int32_t I = 3; I >= 0; --I) {
+    if (Val.Limbs[I]) {
+      return I * 64 + 64 - __builtin_clzll(Val.Limbs[I]);
+    }
+  }
+  return 0;
+}
+
+inline bool isU256Bit(const U256 &Val, uint32_t Bit) {
+  return (Val.Limbs[Bit / 64] >> (Bit % 64)) & 1;
+}
+
+// \return -1, 0 or 1 as \p LHS is less than, equal to or greater than \p RHS
+inline int32_t compareU256(const U256 &LHS, const U256 &RHS) {
+  for (int32_t I = 3; I >= 0; --I) {
+    if (LHS.Limbs[I] != RHS.Limbs[I]) {
+      return LHS.Limbs[I] < RHS.Limbs[I] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// \return the carry out, the 128-bit sums compile to an add/adc chain
+inline bool addU256(U256 &Res, const U256 &LHS, const U256 &RHS) {
+  uint64_t Carry = 0;
+  for (uint32_t I = 0; I < 4; ++I) {
+    U128 Sum = U128(LHS.Limbs[I]) + RHS.Limbs[I] + Carry;
+    Res.Limbs[I] = uint64_t(Sum);
+    Carry = uint64_t(Sum >> 64);
+  }
+  return Carry != 0;
+}
+
+// \return the borrow out, the 128-bit differences compile to a sub/sbb chain
+inline bool subU256(U256 &Res, const U256 &LHS, const U256 &RHS) {
+  uint64_t Borrow = 0;
+  for (uint32_t I = 0; I < 4; ++I) {
+    U128 Diff = U128(LHS.Limbs[I]) - RHS.Limbs[I] - Borrow;
+    Res.Limbs[I] = uint64_t(Diff);
+    Borrow = uint64_t(Diff >> 64) & 1;
+  }
+  return Borrow != 0;
+}
+
+// Hi:Lo = LHS * RHS, the full 512-bit product
+inline void mulU256Wide(U256 &Lo, U256 &Hi, const U256 &LHS, const U256 &RHS) {
+  uint64_t Prod[8] = {};
+  for (uint32_t I = 0; I < 4; ++I) {
+    uint64_t Carry = 0;
+    for (uint32_t J = 0; J < 4; ++J) {
+      // at most (2^64 - 1)^2 + 2 * (2^64 - 1), no overflow
+      U128 Cur = U128(LHS.Limbs[I]) * RHS.Limbs[J] + Prod[I + J] + Carry;
+      Prod[I + J] = uint64_t(Cur);
+      Carry = uint64_t(Cur >> 64);
+    }
+    Prod[I + 4] = Carry;
+  }
+  for (uint32_t I = 0; I < 4; ++I) {
+    Lo.Limbs[I] = Prod[I];
+    Hi.Limbs[I] = Prod[I + 4];
+  }
+}
+
+inline bool isZeroU256(const U256 &Val) {
+  return (Val.Limbs[0] | Val.Limbs[1] | Val.Limbs[2] | Val.Limbs[3]) == 0;
+}
+
+// \return whether the product exceeds 256 bits
+inline bool mulU256(U256 &Res, const U256 &LHS, const U256 &RHS) {
+  U256 Hi;
+  mulU256Wide(Res, Hi, LHS, RHS);
+  return !isZeroU256(Hi);
+}
+
+inline void shlU256(U256 &Res, const U256 &Val, uint32_t Shift) {
+  U256 Tmp = {};
+  if (Shift < 256) {
+    uint32_t LimbShift = Shift / 64;
+    uint32_t BitShift = Shift % 64;
+    for (uint32_t I = LimbShift; I < 4; ++I) {
+      uint64_t Limb = Val.Limbs[I - LimbShift] << BitShift;
+      if (BitShift && I > LimbShift) {
+        Limb |= Val.Limbs[I - LimbShift - 1] >> (64 - BitShift);
+      }
+      Tmp.Limbs[I] = Limb;
+    }
+  }
+  Res = Tmp;
+}
+
+inline void shrU256(U256 &Res, const U256 &Val, uint32_t Shift) {
+  U256 Tmp = {};
+  if (Shift < 256) {
+    uint32_t LimbShift = Shift / 64;
+    uint32_t BitShift = Shift % 64;
+    for (uint32_t I = 0; I + LimbShift < 4; ++I) {
+      uint64_t Limb = Val.Limbs[I + LimbShift] >> BitShift;
+      if (BitShift && I + LimbShift + 1 < 4) {
+        Limb |= Val.Limbs[I + LimbShift + 1] << (64 - BitShift);
+      }
+      Tmp.Limbs[I] = Limb;
+    }
+  }
+  Res = Tmp;
+}
+
+// Quot = LHS / RHS and Rem = LHS % RHS, both are 0 when RHS is 0
+inline void divModU256(U256 &Quot, U256 &Rem, const U256 &LHS,
+                       const U256 &RHS) {
+  U256 Q = {};
+  U256 R = {};
+  uint32_t DivisorBits = getU256BitWidth(RHS);
+  if (DivisorBits == 0) {
+    Quot = Q;
+    Rem = R;
+    return;
+  }
+
+  if (DivisorBits <= 64) {
+    // short division, one 128-by-64 division per limb
+    uint64_t Divisor = RHS.Limbs[0];
+    uint64_t Carry = 0;
+    for (int32_t I = 3; I >= 0; --I) {
+      U128 Cur = (U128(Carry) << 64) | LHS.Limbs[I];
+      Q.Limbs[I] = uint64_t(Cur / Divisor);
+      Carry = uint64_t(Cur % Divisor);
+    }
+    R.Limbs[0] = Carry;
+  } else {
+    // restoring division over the significant bits of the dividend, the
+    // quotient has at most 192 bits here
+    for (int32_t Bit = getU256BitWidth(LHS) - 1; Bit >= 0; --Bit) {
+      // R < RHS, so 2 * R + 1 - RHS fits even when the shift carries out
+      bool Carry = R.Limbs[3] >> 63;
+      shlU256(R, R, 1);
+      R.Limbs[0] |= uint64_t(isU256Bit(LHS, Bit));
+      if (Carry || compareU256(R, RHS) >= 0) {
+        subU256(R, R, RHS);
+        Q.Limbs[Bit / 64] |= uint64_t(1) << (Bit % 64);
+      }
+    }
+  }
+  Quot = Q;
+  Rem = R;
+}
+
+// Res = Base ** Exp mod 2^256, by square and multiply
+inline void expU256(U256 &Res, const U256 &Base, const U256 &Exp) {
+  U256 Acc = {{1, 0, 0, 0}};
+  U256 Pow = Base;
+  uint32_t ExpBits = getU256BitWidth(Exp);
+  for (uint32_t Bit = 0; Bit < ExpBits; ++Bit) {
+    if (isU256Bit(Exp, Bit)) {
+      mulU256(Acc, Acc, Pow);
+    }
+    if (Bit + 1 < ExpBits) {
+      mulU256(Pow, Pow, Pow);
+    }
+  }
+  Res = Acc;
+}
+
+} // namespace zen::utils
+
+#endif // ZEN_UTILS_U256_H
@@ -3,13 +3,16 @@
 #include "utils/virtual_stack.h"
 #include "common/mem_pool.h"
 #include "runtime/instance.h"
+#include <algorithm>
 
 namespace zen::utils {
 
 constexpr size_t StackMemorySize = 9 * 1024 * 1024; // 9MB > dwasm 8MB
 
-StackMemPool::StackMemPool(size_t ItemSize)
-    : EachStackSize(ItemSize), AvailableCount(MAX_STACK_ITEM_NUM) {
+StackMemPool::StackMemPool(size_t ItemSize, size_t MaxItems)
+    : EachStackSize(ItemSize),
+      ReservedSize(std::min(MaxCodeSize, ZEN_ALIGN(ItemSize, 16) * MaxItems)),
+      AvailableCount(MaxItems), MaxItems(MaxItems) {
 #ifdef ZEN_ENABLE_CPU_EXCEPTION
   int DefaultProtMode = PROT_NONE;
 #else
@@ -17,14 +20,14 @@ StackMemPool::StackMemPool(size_t ItemSize)
 #endif // ZEN_ENABLE_CPU_EXCEPTION
 
   MemStart = reinterpret_cast<uint8_t *>(platform::mmap(
-      NULL, MaxCodeSize, DefaultProtMode, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+      NULL, ReservedSize, DefaultProtMode, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
 
   MemEnd = MemStart;
   MemPageEnd = MemStart;
 }
-StackMemPool::~StackMemPool() { platform::munmap(MemStart, MaxCodeSize); }
+StackMemPool::~StackMemPool() { platform::munmap(MemStart, ReservedSize); }
 
-void *StackMemPool::allocate(bool AllowReadWrite) {
+void *StackMemPool::allocate(bool AllowReadWrite, bool *IsReused) {
   common::UniqueLock<common::Mutex> Lock(Mutex);
 #ifndef ZEN_ENABLE_SGX
   AvailableCountCV.wait(Lock, [this]() { return AvailableCount > 0; });
@@ -34,14 +37,20 @@ void *StackMemPool::allocate(bool AllowReadWrite) {
   if (!FreeObjects.empty()) {
     auto *Result = FreeObjects.front();
     FreeObjects.pop();
+    if (IsReused) {
+      *IsReused = true;
+    }
     return Result;
   }
+  if (IsReused) {
+    *IsReused = false;
+  }
   constexpr size_t Align = 16;
   uint8_t *Ptr = reinterpret_cast<uint8_t *>(
       ZEN_ALIGN(reinterpret_cast<uintptr_t>(MemEnd), Align));
   size_t NewSize = reinterpret_cast<uintptr_t>(Ptr) + EachStackSize -
                    reinterpret_cast<uintptr_t>(MemStart);
-  if (NewSize > MaxCodeSize) {
+  if (NewSize > ReservedSize) {
     ZEN_ABORT(); // not supported, exit
   }
   MemEnd = MemStart + NewSize;
@@ -67,14 +76,20 @@ void StackMemPool::deallocate(void *Ptr) {
 #ifndef ZEN_ENABLE_SGX
   common::UniqueLock<common::Mutex> Lock(Mutex);
 #endif // ZEN_ENABLE_SGX
-  ZEN_ASSERT(AvailableCount < MAX_STACK_ITEM_NUM);
+  ZEN_ASSERT(AvailableCount < MaxItems);
 
   ++AvailableCount;
 
   FreeObjects.push(Ptr);
 }
 
+// the pool of the calling thread set by setThreadVirtualStackPool
+static thread_local StackMemPool *ThreadStackPool = nullptr;
+
 static StackMemPool *getVirtualStackPool() {
+  if (ThreadStackPool) {
+    return ThreadStackPool;
+  }
   // stack allocate 2 * needed size, the first part used as stack, the second
   // part used to protect read/write by cpu
   // can't be less, even not enable cpu exception
@@ -82,16 +97,27 @@ static StackMemPool *getVirtualStackPool() {
   return &StackPool;
 }
 
+std::unique_ptr<StackMemPool> createVirtualStackPool(size_t MaxStacks) {
+  return std::make_unique<StackMemPool>(StackMemorySize * 2, MaxStacks);
+}
+
+void setThreadVirtualStackPool(StackMemPool *Pool) { ThreadStackPool = Pool; }
+
 void VirtualStackInfo::allocate() {
   if (AllInfo) {
     return;
   }
-  auto *MemPool = getVirtualStackPool();
-  AllocatedMem = (uint8_t *)MemPool->allocate(true);
+  Pool = getVirtualStackPool();
+  bool IsReused = false;
+  AllocatedMem = (uint8_t *)Pool->allocate(true, &IsReused);
   AllInfo = AllocatedMem + StackMemorySize;
   // [AllocatedMem, AllInfo) is disabled visiting
   // [AllInfo, StackMemoryTop) is available stack memory
-  platform::mprotect(AllocatedMem, StackMemorySize, PROT_NONE);
+  // reused stacks are protected already, which saves a syscall taking the
+  // process-wide mmap lock on every call
+  if (!IsReused) {
+    platform::mprotect(AllocatedMem, StackMemorySize, PROT_NONE);
+  }
 
   // when update sp/rsp register, we need copy old frame to new frame, then
   // the new frame rsp should have enough frame to store
@@ -107,9 +133,10 @@ void VirtualStackInfo::allocate() {
 
 void VirtualStackInfo::deallocate() {
   if (AllocatedMem) {
-    getVirtualStackPool()->deallocate(AllocatedMem);
+    Pool->deallocate(AllocatedMem);
     AllInfo = nullptr;
     AllocatedMem = nullptr;
+    Pool = nullptr;
   }
 }
 
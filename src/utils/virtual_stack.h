@@ -7,10 +7,13 @@
 #include "common/type.h"
 #include "platform/platform.h"
 #include <csetjmp>
+#include <memory>
 #include <queue>
 #include <vector>
 
 namespace zen::runtime {
+struct BatchCallStatus;
+class FunctionHandle;
 class Instance;
 }
 namespace zen::utils {
@@ -30,14 +33,17 @@ public:
   static constexpr size_t MaxCodeSize = 640 * 1024 * 1024; // 640MB
 #endif // ZEN_ENABLE_OCCLUM
   static constexpr size_t PageSize = 4096;
-  StackMemPool(size_t ItemSize);
+  StackMemPool(size_t ItemSize, size_t MaxItems = MAX_STACK_ITEM_NUM);
   ~StackMemPool();
   NONCOPYABLE(StackMemPool);
-  void *allocate(bool AllowReadWrite);
+  /// \param IsReused set to whether the item was deallocated before, its
+  /// memory protection is then the one set by its previous user
+  void *allocate(bool AllowReadWrite, bool *IsReused = nullptr);
   void deallocate(void *Ptr);
 
 private:
   size_t EachStackSize;
+  size_t ReservedSize;
   uint8_t *MemStart;
   uint8_t *MemEnd;
   uint8_t *MemPageEnd;
@@ -47,6 +53,7 @@ private:
   std::condition_variable AvailableCountCV;
 #endif // ZEN_ENABLE_SGX
   size_t AvailableCount;
+  size_t MaxItems;
 };
 
 struct VirtualStackInfo;
@@ -76,7 +83,16 @@ struct VirtualStackInfo {
   uint32_t SavedFuncIdx;
   const std::vector<TypedValue> *SavedArgs = nullptr;
   std::vector<TypedValue> *SavedResults = nullptr;
+  // set instead of SavedArgs and SavedResults for calls by FunctionHandle
+  const FunctionHandle *SavedHandle = nullptr;
+  const UntypedValue *SavedRawArgs = nullptr;
+  UntypedValue *SavedRawResults = nullptr;
+  // set for batches of calls by FunctionHandle
+  uint32_t SavedNumCalls = 1;
+  runtime::BatchCallStatus *SavedStatuses = nullptr;
   jmp_buf JmpBufBefore;
+  // the pool AllocatedMem comes from
+  StackMemPool *Pool = nullptr;
   // func to run in virtual stack
   InVirtualStackFuncPtr FuncInStack;
 
@@ -99,6 +115,15 @@ struct VirtualStackInfo {
   void __attribute__((noinline)) rollbackStack();
 };
 
+/// \return a pool of at most \p MaxStacks virtual stacks, for threads which
+/// don't want to share the process-wide pool, see setThreadVirtualStackPool
+std::unique_ptr<StackMemPool> createVirtualStackPool(size_t MaxStacks);
+
+/// Allocate the virtual stacks of the calling thread from \p Pool instead of
+/// the process-wide pool, nullptr restores the process-wide pool. \p Pool
+/// must outlive the virtual stacks allocated from it.
+void setThreadVirtualStackPool(StackMemPool *Pool);
+
 // utils func to check enough stack for dwasm
 // noinline because to avoid check stack before start virtual stack
 uint8_t __attribute__((noinline)) checkDwasmStackEnough();
@@ -12,15 +12,81 @@ using namespace common;
 const uint8_t *skipBlockType(const uint8_t *Ip, const uint8_t *End) {
   using namespace common;
   WASMType Type = getWASMBlockTypeFromOpcode(*Ip);
-  // Block type is type index(post-MVP)
+  // Block type is type index in form of s33(multi-value)
   if (Type == WASMType::ERROR_TYPE) {
-    Ip--;
-    uint32_t TypeIndex;
-    readLEBNumber<uint32_t>(Ip, End, TypeIndex);
-  } else {
-    Ip++;
+    return skipLEBNumber<int64_t>(Ip, End);
+  }
+  return Ip + 1;
+}
+
+const uint8_t *skipFCImmediates(uint32_t SubOpcode, const uint8_t *Ip,
+                                const uint8_t *End) {
+  switch (SubOpcode) {
+  case MEMORY_INIT:
+    Ip = skipLEBNumber<uint32_t>(Ip, End); // data_idx
+    return Ip + 1;                         // 0x0
+  case DATA_DROP:
+    return skipLEBNumber<uint32_t>(Ip, End); // data_idx
+  case MEMORY_COPY:
+    return Ip + 2; // 0x0 0x0
+  case MEMORY_FILL:
+    return Ip + 1; // 0x0
+  default:
+    ZEN_UNREACHABLE();
+  }
+}
+
+const uint8_t *skipFDImmediates(uint32_t SubOpcode, const uint8_t *Ip,
+                                const uint8_t *End) {
+  switch (SubOpcode) {
+  case V128_LOAD:
+  case V128_LOAD8X8_S:
+  case V128_LOAD8X8_U:
+  case V128_LOAD16X4_S:
+  case V128_LOAD16X4_U:
+  case V128_LOAD32X2_S:
+  case V128_LOAD32X2_U:
+  case V128_LOAD8_SPLAT:
+  case V128_LOAD16_SPLAT:
+  case V128_LOAD32_SPLAT:
+  case V128_LOAD64_SPLAT:
+  case V128_STORE:
+  case V128_LOAD32_ZERO:
+  case V128_LOAD64_ZERO:
+    Ip = skipLEBNumber<uint32_t>(Ip, End); // align
+    return skipLEBNumber<uint32_t>(Ip, End); // offset
+  case V128_LOAD8_LANE:
+  case V128_LOAD16_LANE:
+  case V128_LOAD32_LANE:
+  case V128_LOAD64_LANE:
+  case V128_STORE8_LANE:
+  case V128_STORE16_LANE:
+  case V128_STORE32_LANE:
+  case V128_STORE64_LANE:
+    Ip = skipLEBNumber<uint32_t>(Ip, End); // align
+    Ip = skipLEBNumber<uint32_t>(Ip, End); // offset
+    return Ip + 1;                         // lane index
+  case V128_CONST:
+  case I8X16_SHUFFLE:
+    return Ip + 16; // 16 immediate bytes
+  case I8X16_EXTRACT_LANE_S:
+  case I8X16_EXTRACT_LANE_U:
+  case I8X16_REPLACE_LANE:
+  case I16X8_EXTRACT_LANE_S:
+  case I16X8_EXTRACT_LANE_U:
+  case I16X8_REPLACE_LANE:
+  case I32X4_EXTRACT_LANE:
+  case I32X4_REPLACE_LANE:
+  case I64X2_EXTRACT_LANE:
+  case I64X2_REPLACE_LANE:
+  case F32X4_EXTRACT_LANE:
+  case F32X4_REPLACE_LANE:
+  case F64X2_EXTRACT_LANE:
+  case F64X2_REPLACE_LANE:
+    return Ip + 1; // lane index
+  default:
+    return Ip;
   }
-  return Ip;
 }
 
 const uint8_t *skipCurrentBlock(const uint8_t *Ip, const uint8_t *End) {
@@ -36,7 +102,7 @@ const uint8_t *skipCurrentBlock(const uint8_t *Ip, const uint8_t *End) {
     case LOOP:
     case IF:
       ++NestedLevel;
-      ++Ip; // skip value_type
+      Ip = skipBlockType(Ip, End);
       break;
 
     case ELSE:
@@ -70,18 +136,22 @@ const uint8_t *skipCurrentBlock(const uint8_t *Ip, const uint8_t *End) {
       break;
 
     case CALL:
+    case RETURN_CALL:
       Ip = skipLEBNumber<uint32_t>(Ip, End); // skip func_idx
       break;
 
     case CALL_INDIRECT:
+    case RETURN_CALL_INDIRECT:
       Ip = skipLEBNumber<uint32_t>(Ip, End); // skip type_idx
       ++Ip;                                  // skip tbl_idx
       break;
 
     case DROP:
     case DROP_64:
+    case DROP_V128:
     case SELECT:
     case SELECT_64:
+    case SELECT_V128:
       break;
 
     case GET_LOCAL:
@@ -127,6 +197,20 @@ const uint8_t *skipCurrentBlock(const uint8_t *Ip, const uint8_t *End) {
       Ip = skipLEBNumber<uint32_t>(Ip, End); // 0x0
       break;
 
+    case FC_PREFIX: {
+      uint32_t SubOpcode;
+      Ip = readLEBNumber(Ip, End, SubOpcode);
+      Ip = skipFCImmediates(SubOpcode, Ip, End);
+      break;
+    }
+
+    case FD_PREFIX: {
+      uint32_t SubOpcode;
+      Ip = readLEBNumber(Ip, End, SubOpcode);
+      Ip = skipFDImmediates(SubOpcode, Ip, End);
+      break;
+    }
+
     case I32_CONST:
       Ip = skipLEBNumber<uint32_t>(Ip, End); // i32 val
       break;
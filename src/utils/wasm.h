@@ -135,6 +135,14 @@ const uint8_t *skipBlockType(const uint8_t *Ip, const uint8_t *End);
 // skip current block for br, br_table, return and unreachable
 const uint8_t *skipCurrentBlock(const uint8_t *Ip, const uint8_t *End);
 
+// skip the immediates following the sub-opcode of a 0xfc prefixed instruction
+const uint8_t *skipFCImmediates(uint32_t SubOpcode, const uint8_t *Ip,
+                                const uint8_t *End);
+
+// skip the immediates following the sub-opcode of a 0xfd prefixed instruction
+const uint8_t *skipFDImmediates(uint32_t SubOpcode, const uint8_t *Ip,
+                                const uint8_t *End);
+
 // byte code to string for dump purpose
 const char *getWASMTypeString(common::WASMType Type);
 const char *getOpcodeString(uint8_t Opcode);
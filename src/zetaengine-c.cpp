@@ -115,6 +115,7 @@ DEFINE_CONVERSION_FUNCTIONS(zen::runtime::HostModule, ZenHostModuleRef)
 DEFINE_CONVERSION_FUNCTIONS(BuiltinModuleDesc, ZenHostModuleDescRef)
 DEFINE_CONVERSION_FUNCTIONS(zen::runtime::Isolation, ZenIsolationRef)
 DEFINE_CONVERSION_FUNCTIONS(zen::runtime::Instance, ZenInstanceRef)
+DEFINE_CONVERSION_FUNCTIONS(zen::runtime::FunctionHandle, ZenFunctionHandleRef)
 
 // ==================== Runtime ====================
 
@@ -227,6 +228,70 @@ bool ZenCallWasmFuncByIdx(ZenRuntimeRef Runtime, ZenInstanceRef Instance,
   return Ret;
 }
 
+bool ZenCallFunctionHandle(ZenRuntimeRef Runtime, ZenInstanceRef Instance,
+                           ZenFunctionHandleRef Func, const ZenValue InArgs[],
+                           uint32_t NumInArgs, ZenValue OutResults[],
+                           uint32_t MaxNumOutResults,
+                           uint32_t *NumOutResults) {
+  using namespace zen::common;
+  ZEN_ASSERT(Runtime);
+  ZEN_ASSERT(Instance);
+  ZEN_ASSERT(Func);
+  ZEN_ASSERT(NumOutResults);
+  zen::runtime::Runtime *RT = unwrap(Runtime);
+  zen::runtime::Instance *Inst = unwrap(Instance);
+  const zen::runtime::FunctionHandle *Handle = unwrap(Func);
+  *NumOutResults = 0;
+
+  if (Handle->getModule() != Inst->getModule()) {
+    Inst->setError(getError(ErrorCode::ForeignFunctionHandle));
+    return false;
+  }
+  if (NumInArgs != Handle->getNumParams()) {
+    Inst->setError(getError(ErrorCode::UnexpectedNumArgs));
+    return false;
+  }
+  uint32_t NumResults = Handle->getNumReturns();
+  if (MaxNumOutResults < NumResults) {
+    Inst->setError(getErrorWithExtraMessage(ErrorCode::InvalidArgument,
+                                            "results buffer too small"));
+    return false;
+  }
+  constexpr uint32_t MaxInlineArgs = 32;
+  UntypedValue ArgsBuf[MaxInlineArgs];
+  std::vector<UntypedValue> ArgsHeap;
+  UntypedValue *Args = ArgsBuf;
+  if (NumInArgs > MaxInlineArgs) {
+    ArgsHeap.resize(NumInArgs);
+    Args = ArgsHeap.data();
+  }
+  for (uint32_t I = 0; I < NumInArgs; ++I) {
+    if (getWASMType(InArgs[I].Type) != Handle->getParamType(I)) {
+      Inst->setError(getError(ErrorCode::UnexpectedArgType));
+      return false;
+    }
+    std::memcpy(&Args[I], &InArgs[I].Value, sizeof(UntypedValue));
+  }
+
+  constexpr uint32_t MaxInlineResults = 8;
+  UntypedValue ResultsBuf[MaxInlineResults];
+  std::vector<UntypedValue> ResultsHeap;
+  UntypedValue *Results = ResultsBuf;
+  if (NumResults > MaxInlineResults) {
+    ResultsHeap.resize(NumResults);
+    Results = ResultsHeap.data();
+  }
+  if (!RT->callWasmFunction(*Inst, *Handle, Args, Results)) {
+    return false;
+  }
+  for (uint32_t I = 0; I < NumResults; ++I) {
+    OutResults[I].Type = getZenType(Handle->getReturnType(I));
+    std::memcpy(&OutResults[I].Value, &Results[I], sizeof(UntypedValue));
+  }
+  *NumOutResults = NumResults;
+  return true;
+}
+
 // ==================== Host Module ====================
 
 ZenHostModuleDescRef
@@ -380,6 +445,23 @@ bool ZenGetExportFunc(ZenModuleRef Module, const char *FuncName,
   return Mod->getExportFunc(FuncName, *FuncIdx);
 }
 
+ZenFunctionHandleRef ZenGetFunctionHandle(ZenModuleRef Module,
+                                          const char *FuncName) {
+  ZEN_ASSERT(Module);
+  zen::runtime::Module *Mod = unwrap(Module);
+  return wrap(Mod->getFunctionHandle(FuncName));
+}
+
+uint32_t ZenGetFunctionHandleNumParams(ZenFunctionHandleRef Func) {
+  ZEN_ASSERT(Func);
+  return unwrap(Func)->getNumParams();
+}
+
+uint32_t ZenGetFunctionHandleNumResults(ZenFunctionHandleRef Func) {
+  ZEN_ASSERT(Func);
+  return unwrap(Func)->getNumReturns();
+}
+
 bool ZenGetImportFuncName(ZenModuleRef Module, uint32_t FuncIdx,
                           char *HostModuleNameOut,
                           uint32_t *HostModuleNameLenOut,
@@ -608,3 +690,45 @@ void ZenEnableLogging() {
 }
 
 void ZenDisableLogging() { zen::setGlobalLogger(nullptr); }
+
+static uint32_t copyToOutBuf(const std::string &Out, char *OutBuf,
+                             uint32_t OutBufSize) {
+  if (OutBuf && OutBufSize > 0) {
+    size_t Len = std::min(Out.size(), size_t(OutBufSize - 1));
+    std::memcpy(OutBuf, Out.data(), Len);
+    OutBuf[Len] = '\0';
+  }
+  return Out.size();
+}
+
+uint32_t ZenGetMetrics(ZenMetricsFormat Format, char *OutBuf,
+                       uint32_t OutBufSize) {
+  using zen::utils::Metrics;
+  Metrics::Snapshot Snap = Metrics::getSnapshot();
+  std::string Out = Format == ZenMetricsFormatJSON ? Snap.toJSON()
+                                                   : Snap.toPrometheus();
+  return copyToOutBuf(Out, OutBuf, OutBufSize);
+}
+
+bool ZenStartSamplingProfiler(uint32_t Frequency) {
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  return zen::runtime::SamplingProfiler::start(Frequency);
+#else
+  return false;
+#endif
+}
+
+void ZenStopSamplingProfiler() {
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  zen::runtime::SamplingProfiler::stop();
+#endif
+}
+
+uint32_t ZenGetSamplingProfile(char *OutBuf, uint32_t OutBufSize) {
+#ifdef ZEN_ENABLE_JIT_PROFILER
+  std::string Out = zen::runtime::SamplingProfiler::getCollapsedStacks();
+#else
+  std::string Out;
+#endif
+  return copyToOutBuf(Out, OutBuf, OutBufSize);
+}
@@ -36,6 +36,11 @@ typedef enum {
   ZenModeUnknown = 3,
 } ZenRunMode;
 
+typedef enum {
+  ZenMetricsFormatPrometheus = 0,
+  ZenMetricsFormatJSON = 1,
+} ZenMetricsFormat;
+
 typedef struct ZenRuntimeConfig {
   // Run mode
   ZenRunMode Mode;
@@ -56,6 +61,7 @@ typedef struct ZenOpaqueHostModuleDesc *ZenHostModuleDescRef;
 typedef struct ZenOpaqueHostModule *ZenHostModuleRef;
 typedef struct ZenOpaqueIsolation *ZenIsolationRef;
 typedef struct ZenOpaqueInstance *ZenInstanceRef;
+typedef struct ZenOpaqueFunctionHandle *ZenFunctionHandleRef;
 
 // ==================== Runtime ====================
 
@@ -82,6 +88,16 @@ bool ZenCallWasmFuncByIdx(ZenRuntimeRef Runtime, ZenInstanceRef Instance,
                           uint32_t NumInArgs, ZenValue OutResults[],
                           uint32_t *NumOutResults);
 
+/// Call a function resolved once by ZenGetFunctionHandle, without looking up
+/// the export or allocating for the arguments
+/// \param MaxNumOutResults capacity of OutResults, the call fails without
+/// running the function if it is less than the number of results
+bool ZenCallFunctionHandle(ZenRuntimeRef Runtime, ZenInstanceRef Instance,
+                           ZenFunctionHandleRef Func, const ZenValue InArgs[],
+                           uint32_t NumInArgs, ZenValue OutResults[],
+                           uint32_t MaxNumOutResults,
+                           uint32_t *NumOutResults);
+
 // ==================== Host Module ====================
 
 typedef struct ZenHostFuncDesc {
@@ -144,6 +160,15 @@ bool ZenGetImportFuncName(ZenModuleRef Module, uint32_t FuncIdx,
 
 uint32_t ZenGetNumImportFunctions(ZenModuleRef Module);
 
+/// \return NULL if there is no such exported function, the handle lives as
+/// long as the module and can be used by all its instances
+ZenFunctionHandleRef ZenGetFunctionHandle(ZenModuleRef Module,
+                                          const char *FuncName);
+
+uint32_t ZenGetFunctionHandleNumParams(ZenFunctionHandleRef Func);
+
+uint32_t ZenGetFunctionHandleNumResults(ZenFunctionHandleRef Func);
+
 // ==================== Isolation ====================
 
 ZenIsolationRef ZenCreateIsolation(ZenRuntimeRef Runtime);
@@ -210,6 +235,22 @@ void ZenInstanceProtectMemoryAgain(ZenInstanceRef Instance);
 void ZenEnableLogging();
 void ZenDisableLogging();
 
+// Write the process-wide runtime metrics to OutBuf as a null-terminated
+// string, truncated to OutBufSize. Return the length of the full output,
+// without the terminator, like snprintf.
+uint32_t ZenGetMetrics(ZenMetricsFormat Format, char *OutBuf,
+                       uint32_t OutBufSize);
+
+// Sample the JIT code of all threads at Frequency samples per second of cpu
+// time. Return false if already started, or if the library is built without
+// ZEN_ENABLE_JIT_PROFILER.
+bool ZenStartSamplingProfiler(uint32_t Frequency);
+void ZenStopSamplingProfiler();
+// Write the samples taken since the last start as collapsed stacks for
+// flamegraphs, like ZenGetMetrics. Must be called after
+// ZenStopSamplingProfiler while the sampled modules are still loaded.
+uint32_t ZenGetSamplingProfile(char *OutBuf, uint32_t OutBufSize);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
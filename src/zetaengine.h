@@ -6,13 +6,20 @@
 
 #include "common/defines.h"
 #include "common/errors.h"
+#include "runtime/executor.h"
+#include "runtime/function_handle.h"
 #include "runtime/instance.h"
 #include "runtime/isolation.h"
 #include "runtime/module.h"
 #include "runtime/runtime.h"
 #include "utils/logging.h"
+#include "utils/metrics.h"
 #include "wni/helper.h"
 
+#ifdef ZEN_ENABLE_JIT_PROFILER
+#include "runtime/sampling_profiler.h"
+#endif
+
 namespace zen {
 
 inline void setGlobalLogger(std::shared_ptr<utils::ILogger> Logger) {
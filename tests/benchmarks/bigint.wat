@@ -0,0 +1,77 @@
+;; 256-bit multiply-add with 32-bit limbs, the u256 arithmetic of contract
+;; code: widening multiplies and carry propagation
+(module
+  (memory 1)
+  ;; 0: x, 32: c, 64: product, 96: initial x, all little-endian limbs
+  (data (i32.const 32)
+    "\ff\ee\dd\cc\bb\aa\99\88\77\66\55\44\33\22\11\00"
+    "\ef\cd\ab\89\67\45\23\01\be\ba\fe\ca\ef\be\ad\de")
+  (data (i32.const 96)
+    "\f0\e1\d2\c3\b4\a5\96\87\78\69\5a\4b\3c\2d\1e\0f"
+    "\10\32\54\76\98\ba\dc\fe\ef\cd\ab\89\67\45\23\01")
+
+  ;; x = (x * c + 1) mod 2^256
+  (func $mul_add
+    (local $i i32) (local $j i32) (local $k i32)
+    (local $xi i64) (local $t i64) (local $carry i64)
+    (i64.store (i32.const 64) (i64.const 0))
+    (i64.store (i32.const 72) (i64.const 0))
+    (i64.store (i32.const 80) (i64.const 0))
+    (i64.store (i32.const 88) (i64.const 0))
+    (block $rows_done
+      (loop $rows
+        (br_if $rows_done (i32.eq (local.get $i) (i32.const 8)))
+        (local.set $xi
+          (i64.load32_u (i32.shl (local.get $i) (i32.const 2))))
+        (local.set $carry (i64.const 0))
+        (local.set $j (i32.const 0))
+        (block $done
+          (loop $row
+            ;; limbs above 2^256 are dropped
+            (br_if $done
+              (i32.eq (i32.add (local.get $i) (local.get $j)) (i32.const 8)))
+            (local.set $k
+              (i32.shl (i32.add (local.get $i) (local.get $j)) (i32.const 2)))
+            (local.set $t
+              (i64.add
+                (i64.add (i64.load32_u offset=64 (local.get $k))
+                         (local.get $carry))
+                (i64.mul (local.get $xi)
+                  (i64.load32_u offset=32
+                    (i32.shl (local.get $j) (i32.const 2))))))
+            (i64.store32 offset=64 (local.get $k) (local.get $t))
+            (local.set $carry (i64.shr_u (local.get $t) (i64.const 32)))
+            (local.set $j (i32.add (local.get $j) (i32.const 1)))
+            (br $row)))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $rows)))
+    (local.set $carry (i64.const 1))
+    (local.set $k (i32.const 0))
+    (block $done
+      (loop $add
+        (br_if $done (i32.eq (local.get $k) (i32.const 32)))
+        (local.set $t
+          (i64.add (i64.load32_u offset=64 (local.get $k))
+                   (local.get $carry)))
+        (i64.store32 (local.get $k) (local.get $t))
+        (local.set $carry (i64.shr_u (local.get $t) (i64.const 32)))
+        (local.set $k (i32.add (local.get $k) (i32.const 4)))
+        (br $add))))
+
+  ;; iterates the multiply-add n times, returns the 64-bit words of x xored
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32)
+    (i64.store (i32.const 0) (i64.load (i32.const 96)))
+    (i64.store (i32.const 8) (i64.load (i32.const 104)))
+    (i64.store (i32.const 16) (i64.load (i32.const 112)))
+    (i64.store (i32.const 24) (i64.load (i32.const 120)))
+    (block $done
+      (loop $iterations
+        (br_if $done (i32.eq (local.get $i) (local.get $n)))
+        (call $mul_add)
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $iterations)))
+    (i64.xor
+      (i64.xor (i64.load (i32.const 0)) (i64.load (i32.const 8)))
+      (i64.xor (i64.load (i32.const 16)) (i64.load (i32.const 24)))))
+)
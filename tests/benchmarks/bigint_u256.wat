@@ -0,0 +1,37 @@
+;; the multiply-add of bigint.wat by the env.u256 hostapi intrinsics, both
+;; JITs call the runtime for u256_mul, the multipass one expands u256_add
+(module
+  (import "env" "u256_mul" (func $u256_mul (param i32 i32 i32) (result i32)))
+  (import "env" "u256_add" (func $u256_add (param i32 i32 i32) (result i32)))
+  (memory 1)
+  ;; 0: x, 32: c, 64: product, 96: initial x, 128: one, all little-endian
+  (data (i32.const 32)
+    "\ff\ee\dd\cc\bb\aa\99\88\77\66\55\44\33\22\11\00"
+    "\ef\cd\ab\89\67\45\23\01\be\ba\fe\ca\ef\be\ad\de")
+  (data (i32.const 96)
+    "\f0\e1\d2\c3\b4\a5\96\87\78\69\5a\4b\3c\2d\1e\0f"
+    "\10\32\54\76\98\ba\dc\fe\ef\cd\ab\89\67\45\23\01")
+  (data (i32.const 128) "\01")
+
+  ;; x = (x * c + 1) mod 2^256
+  (func $mul_add
+    (drop (call $u256_mul (i32.const 64) (i32.const 0) (i32.const 32)))
+    (drop (call $u256_add (i32.const 0) (i32.const 64) (i32.const 128))))
+
+  ;; iterates the multiply-add n times, returns the 64-bit words of x xored
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32)
+    (i64.store (i32.const 0) (i64.load (i32.const 96)))
+    (i64.store (i32.const 8) (i64.load (i32.const 104)))
+    (i64.store (i32.const 16) (i64.load (i32.const 112)))
+    (i64.store (i32.const 24) (i64.load (i32.const 120)))
+    (block $done
+      (loop $iterations
+        (br_if $done (i32.eq (local.get $i) (local.get $n)))
+        (call $mul_add)
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $iterations)))
+    (i64.xor
+      (i64.xor (i64.load (i32.const 0)) (i64.load (i32.const 8)))
+      (i64.xor (i64.load (i32.const 16)) (i64.load (i32.const 24)))))
+)
@@ -0,0 +1,81 @@
+;; erc20 style transfers between 1024 accounts: balance checks, read-modify-
+;; write of 64-bit balances and a ring buffer of transfer events
+(module
+  (memory 1)
+  ;; 0: balances, 8192: transfer events (from, to, amount)
+  (global $seed (mut i64) (i64.const 12345))
+
+  (func $next (result i64)
+    (global.set $seed
+      (i64.add
+        (i64.mul (global.get $seed) (i64.const 6364136223846793005))
+        (i64.const 1442695040888963407)))
+    (global.get $seed))
+
+  (func $transfer (param $from i32) (param $to i32) (param $amount i64)
+                  (param $event i32) (result i32)
+    (local $balance i64)
+    (if (i32.eq (local.get $from) (local.get $to))
+      (then (return (i32.const 0))))
+    (local.set $balance
+      (i64.load (i32.shl (local.get $from) (i32.const 3))))
+    (if (i64.lt_u (local.get $balance) (local.get $amount))
+      (then (return (i32.const 0))))
+    (i64.store (i32.shl (local.get $from) (i32.const 3))
+      (i64.sub (local.get $balance) (local.get $amount)))
+    (i64.store (i32.shl (local.get $to) (i32.const 3))
+      (i64.add (i64.load (i32.shl (local.get $to) (i32.const 3)))
+               (local.get $amount)))
+    (local.set $event
+      (i32.add (i32.const 8192)
+               (i32.shl (i32.and (local.get $event) (i32.const 1023))
+                        (i32.const 4))))
+    (i32.store (local.get $event) (local.get $from))
+    (i32.store offset=4 (local.get $event) (local.get $to))
+    (i64.store offset=8 (local.get $event) (local.get $amount))
+    (i32.const 1))
+
+  ;; runs n transfers, returns a weighted sum of the balances mixed with the
+  ;; number of rejected transfers
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32) (local $r i64) (local $failed i64) (local $sum i64)
+    (global.set $seed (i64.const 12345))
+    (block $done
+      (loop $init
+        (br_if $done (i32.eq (local.get $i) (i32.const 1024)))
+        (i64.store (i32.shl (local.get $i) (i32.const 3)) (i64.const 1000000))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $init)))
+    (local.set $i (i32.const 0))
+    (block $done
+      (loop $transfers
+        (br_if $done (i32.eq (local.get $i) (local.get $n)))
+        (local.set $r (call $next))
+        (if (i32.eqz
+              (call $transfer
+                (i32.wrap_i64
+                  (i64.and (i64.shr_u (local.get $r) (i64.const 33))
+                           (i64.const 1023)))
+                (i32.wrap_i64
+                  (i64.and (i64.shr_u (local.get $r) (i64.const 43))
+                           (i64.const 1023)))
+                (i64.and (i64.shr_u (local.get $r) (i64.const 20))
+                         (i64.const 0xffff))
+                (local.get $i)))
+          (then
+            (local.set $failed (i64.add (local.get $failed) (i64.const 1)))))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $transfers)))
+    (local.set $i (i32.const 0))
+    (block $done
+      (loop $checksum
+        (br_if $done (i32.eq (local.get $i) (i32.const 1024)))
+        (local.set $sum
+          (i64.add (local.get $sum)
+            (i64.mul (i64.load (i32.shl (local.get $i) (i32.const 3)))
+                     (i64.extend_i32_u
+                       (i32.add (local.get $i) (i32.const 1))))))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $checksum)))
+    (i64.xor (local.get $sum) (local.get $failed)))
+)
@@ -0,0 +1,155 @@
+;; keccak-f[1600] permutation, 64-bit xors, rotates and indexed lane accesses
+(module
+  (memory 1)
+  ;; 0: state lanes, 200: permuted lanes, 400: column parities,
+  ;; 512: round constants, 704: rotation offsets, 736: lane permutation
+  (data (i32.const 512)
+    "\01\00\00\00\00\00\00\00\82\80\00\00\00\00\00\00"
+    "\8a\80\00\00\00\00\00\80\00\80\00\80\00\00\00\80"
+    "\8b\80\00\00\00\00\00\00\01\00\00\80\00\00\00\00"
+    "\81\80\00\80\00\00\00\80\09\80\00\00\00\00\00\80"
+    "\8a\00\00\00\00\00\00\00\88\00\00\00\00\00\00\00"
+    "\09\80\00\80\00\00\00\00\0a\00\00\80\00\00\00\00"
+    "\8b\80\00\80\00\00\00\00\8b\00\00\00\00\00\00\80"
+    "\89\80\00\00\00\00\00\80\03\80\00\00\00\00\00\80"
+    "\02\80\00\00\00\00\00\80\80\00\00\00\00\00\00\80"
+    "\0a\80\00\00\00\00\00\00\0a\00\00\80\00\00\00\80"
+    "\81\80\00\80\00\00\00\80\80\80\00\00\00\00\00\80"
+    "\01\00\00\80\00\00\00\00\08\80\00\80\00\00\00\80")
+  (data (i32.const 704)
+    "\00\01\3e\1c\1b\24\2c\06\37\14\03\0a\2b\19\27\29\2d\0f\15\08\12\02\3d"
+    "\38\0e")
+  (data (i32.const 736)
+    "\00\0a\14\05\0f\10\01\0b\15\06\07\11\02\0c\16\17\08\12\03\0d\0e\18\09"
+    "\13\04")
+
+  (func $permute
+    (local $round i32) (local $x i32) (local $y i32) (local $i i32)
+    (local $lane i32) (local $d i64)
+    (block $rounds_done
+      (loop $rounds
+        (br_if $rounds_done (i32.eq (local.get $round) (i32.const 24)))
+
+        ;; theta
+        (local.set $x (i32.const 0))
+        (block $done
+          (loop $parity
+            (br_if $done (i32.eq (local.get $x) (i32.const 5)))
+            (local.set $lane (i32.shl (local.get $x) (i32.const 3)))
+            (i64.store offset=400 (local.get $lane)
+              (i64.xor
+                (i64.xor
+                  (i64.xor (i64.load (local.get $lane))
+                           (i64.load offset=40 (local.get $lane)))
+                  (i64.xor (i64.load offset=80 (local.get $lane))
+                           (i64.load offset=120 (local.get $lane))))
+                (i64.load offset=160 (local.get $lane))))
+            (local.set $x (i32.add (local.get $x) (i32.const 1)))
+            (br $parity)))
+        (local.set $x (i32.const 0))
+        (block $done
+          (loop $columns
+            (br_if $done (i32.eq (local.get $x) (i32.const 5)))
+            (local.set $d
+              (i64.xor
+                (i64.load offset=400
+                  (i32.shl
+                    (i32.rem_u (i32.add (local.get $x) (i32.const 4))
+                               (i32.const 5))
+                    (i32.const 3)))
+                (i64.rotl
+                  (i64.load offset=400
+                    (i32.shl
+                      (i32.rem_u (i32.add (local.get $x) (i32.const 1))
+                                 (i32.const 5))
+                      (i32.const 3)))
+                  (i64.const 1))))
+            (local.set $lane (i32.shl (local.get $x) (i32.const 3)))
+            (block $column_done
+              (loop $column
+                (br_if $column_done
+                  (i32.ge_u (local.get $lane) (i32.const 200)))
+                (i64.store (local.get $lane)
+                  (i64.xor (i64.load (local.get $lane)) (local.get $d)))
+                (local.set $lane (i32.add (local.get $lane) (i32.const 40)))
+                (br $column)))
+            (local.set $x (i32.add (local.get $x) (i32.const 1)))
+            (br $columns)))
+
+        ;; rho and pi
+        (local.set $i (i32.const 0))
+        (block $done
+          (loop $lanes
+            (br_if $done (i32.eq (local.get $i) (i32.const 25)))
+            (i64.store offset=200
+              (i32.shl (i32.load8_u offset=736 (local.get $i)) (i32.const 3))
+              (i64.rotl
+                (i64.load (i32.shl (local.get $i) (i32.const 3)))
+                (i64.load8_u offset=704 (local.get $i))))
+            (local.set $i (i32.add (local.get $i) (i32.const 1)))
+            (br $lanes)))
+
+        ;; chi
+        (local.set $y (i32.const 0))
+        (block $rows_done
+          (loop $rows
+            (br_if $rows_done (i32.eq (local.get $y) (i32.const 200)))
+            (local.set $x (i32.const 0))
+            (block $done
+              (loop $row
+                (br_if $done (i32.eq (local.get $x) (i32.const 5)))
+                (i64.store
+                  (i32.add (local.get $y)
+                           (i32.shl (local.get $x) (i32.const 3)))
+                  (i64.xor
+                    (i64.load offset=200
+                      (i32.add (local.get $y)
+                               (i32.shl (local.get $x) (i32.const 3))))
+                    (i64.and
+                      (i64.xor
+                        (i64.load offset=200
+                          (i32.add (local.get $y)
+                            (i32.shl
+                              (i32.rem_u
+                                (i32.add (local.get $x) (i32.const 1))
+                                (i32.const 5))
+                              (i32.const 3))))
+                        (i64.const -1))
+                      (i64.load offset=200
+                        (i32.add (local.get $y)
+                          (i32.shl
+                            (i32.rem_u
+                              (i32.add (local.get $x) (i32.const 2))
+                              (i32.const 5))
+                            (i32.const 3)))))))
+                (local.set $x (i32.add (local.get $x) (i32.const 1)))
+                (br $row)))
+            (local.set $y (i32.add (local.get $y) (i32.const 40)))
+            (br $rows)))
+
+        ;; iota
+        (i64.store (i32.const 0)
+          (i64.xor (i64.load (i32.const 0))
+            (i64.load offset=512
+              (i32.shl (local.get $round) (i32.const 3)))))
+        (local.set $round (i32.add (local.get $round) (i32.const 1)))
+        (br $rounds))))
+
+  ;; permutes the zero state n times, returns the first lane
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32)
+    (block $done
+      (loop $zero
+        (br_if $done (i32.eq (local.get $i) (i32.const 200)))
+        (i64.store (local.get $i) (i64.const 0))
+        (local.set $i (i32.add (local.get $i) (i32.const 8)))
+        (br $zero)))
+    (local.set $i (i32.const 0))
+    (block $done
+      (loop $permutations
+        (br_if $done (i32.eq (local.get $i) (local.get $n)))
+        (call $permute)
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $permutations)))
+    (i64.load (i32.const 0)))
+)
@@ -0,0 +1,43 @@
+;; the message of sha256.wat hashed by the builtin crypto module, the
+;; checksum is the same
+(module
+  (import "crypto" "sha256" (func $sha256 (param i32 i32 i32)))
+  (memory 1)
+  ;; 0: digest, 1024: message
+
+  (func $bswap (param $x i32) (result i32)
+    (i32.or
+      (i32.and (i32.rotl (local.get $x) (i32.const 8))
+               (i32.const 0x00ff00ff))
+      (i32.and (i32.rotr (local.get $x) (i32.const 8))
+               (i32.const 0xff00ff00))))
+
+  (func $reserve (param $bytes i32)
+    (local $pages i32)
+    (local.set $pages
+      (i32.sub
+        (i32.shr_u (i32.add (local.get $bytes) (i32.const 0xffff))
+                   (i32.const 16))
+        (memory.size)))
+    (if (i32.gt_s (local.get $pages) (i32.const 0))
+      (then
+        (if (i32.eq (memory.grow (local.get $pages)) (i32.const -1))
+          (then (unreachable))))))
+
+  (func (export "run") (param $n i32) (result i64)
+    (local $len i32) (local $i i32)
+    (local.set $len (i32.shl (local.get $n) (i32.const 6)))
+    (call $reserve (i32.add (local.get $len) (i32.const 1024)))
+    (block $done
+      (loop $fill
+        (br_if $done (i32.eq (local.get $i) (local.get $len)))
+        (i32.store8 offset=1024 (local.get $i)
+          (i32.add (i32.mul (local.get $i) (i32.const 31)) (i32.const 7)))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $fill)))
+    (call $sha256 (i32.const 1024) (local.get $len) (i32.const 0))
+    (i64.or
+      (i64.shl (i64.extend_i32_u (call $bswap (i32.load (i32.const 0))))
+               (i64.const 32))
+      (i64.extend_i32_u (call $bswap (i32.load (i32.const 4))))))
+)
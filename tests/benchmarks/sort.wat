@@ -0,0 +1,96 @@
+;; quicksort of generated 32-bit keys, random loads and stores over a large
+;; array and data dependent branches
+(module
+  (memory 1)
+
+  (func $reserve (param $bytes i32)
+    (local $pages i32)
+    (local.set $pages
+      (i32.sub
+        (i32.shr_u (i32.add (local.get $bytes) (i32.const 0xffff))
+                   (i32.const 16))
+        (memory.size)))
+    (if (i32.gt_s (local.get $pages) (i32.const 0))
+      (then
+        (if (i32.eq (memory.grow (local.get $pages)) (i32.const -1))
+          (then (unreachable))))))
+
+  (func $swap (param $a i32) (param $b i32)
+    (local $t i32)
+    (local.set $t (i32.load (local.get $a)))
+    (i32.store (local.get $a) (i32.load (local.get $b)))
+    (i32.store (local.get $b) (local.get $t)))
+
+  ;; sorts the keys in [lo, hi], both byte addresses
+  (func $quicksort (param $lo i32) (param $hi i32)
+    (local $pivot i32) (local $i i32) (local $j i32)
+    (loop $tail
+      (if (i32.ge_u (local.get $lo) (local.get $hi))
+        (then (return)))
+      ;; the middle key is the pivot, moved to the end
+      (call $swap
+        (i32.add (local.get $lo)
+          (i32.and
+            (i32.shr_u (i32.sub (local.get $hi) (local.get $lo))
+                       (i32.const 1))
+            (i32.const -4)))
+        (local.get $hi))
+      (local.set $pivot (i32.load (local.get $hi)))
+      (local.set $i (local.get $lo))
+      (local.set $j (local.get $lo))
+      (block $done
+        (loop $partition
+          (br_if $done (i32.eq (local.get $j) (local.get $hi)))
+          (if (i32.lt_s (i32.load (local.get $j)) (local.get $pivot))
+            (then
+              (call $swap (local.get $i) (local.get $j))
+              (local.set $i (i32.add (local.get $i) (i32.const 4)))))
+          (local.set $j (i32.add (local.get $j) (i32.const 4)))
+          (br $partition)))
+      (call $swap (local.get $i) (local.get $hi))
+      (if (i32.gt_u (local.get $i) (local.get $lo))
+        (then
+          (call $quicksort (local.get $lo)
+                           (i32.sub (local.get $i) (i32.const 4)))))
+      (local.set $lo (i32.add (local.get $i) (i32.const 4)))
+      (br $tail)))
+
+  ;; sorts n keys, returns their checksum in order or -1 if unsorted
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32) (local $seed i32) (local $end i32)
+    (local $key i32) (local $prev i32) (local $sum i64)
+    (if (i32.eqz (local.get $n))
+      (then (return (i64.const 0))))
+    (local.set $end (i32.shl (local.get $n) (i32.const 2)))
+    (call $reserve (local.get $end))
+    (local.set $seed (i32.const 42))
+    (block $done
+      (loop $fill
+        (br_if $done (i32.eq (local.get $i) (local.get $end)))
+        (local.set $seed
+          (i32.add (i32.mul (local.get $seed) (i32.const 1103515245))
+                   (i32.const 12345)))
+        (i32.store (local.get $i)
+          (i32.shr_u (local.get $seed) (i32.const 1)))
+        (local.set $i (i32.add (local.get $i) (i32.const 4)))
+        (br $fill)))
+    (call $quicksort (i32.const 0) (i32.sub (local.get $end) (i32.const 4)))
+    (local.set $i (i32.const 0))
+    (block $done
+      (loop $check
+        (br_if $done (i32.eq (local.get $i) (local.get $end)))
+        (local.set $key (i32.load (local.get $i)))
+        (if (i32.lt_s (local.get $key) (local.get $prev))
+          (then (return (i64.const -1))))
+        (local.set $prev (local.get $key))
+        (local.set $sum
+          (i64.add (local.get $sum)
+            (i64.mul
+              (i64.extend_i32_u (local.get $key))
+              (i64.extend_i32_u
+                (i32.add (i32.shr_u (local.get $i) (i32.const 2))
+                         (i32.const 1))))))
+        (local.set $i (i32.add (local.get $i) (i32.const 4)))
+        (br $check)))
+    (local.get $sum))
+)
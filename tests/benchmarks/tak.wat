@@ -0,0 +1,30 @@
+;; takeuchi function, deep non-tail recursion with three arguments
+(module
+  (func $tak (param $x i32) (param $y i32) (param $z i32) (result i32)
+    (if (result i32) (i32.lt_s (local.get $y) (local.get $x))
+      (then
+        (call $tak
+          (call $tak (i32.sub (local.get $x) (i32.const 1))
+                     (local.get $y) (local.get $z))
+          (call $tak (i32.sub (local.get $y) (i32.const 1))
+                     (local.get $z) (local.get $x))
+          (call $tak (i32.sub (local.get $z) (i32.const 1))
+                     (local.get $x) (local.get $y))))
+      (else (local.get $z))))
+  (func (export "run") (param $n i32) (result i64)
+    (local $i i32)
+    (local $sum i64)
+    (block $done
+      (loop $loop
+        (br_if $done (i32.ge_u (local.get $i) (local.get $n)))
+        (local.set $sum
+          (i64.add (local.get $sum)
+            (i64.extend_i32_s
+              (call $tak
+                (i32.add (i32.const 18)
+                         (i32.rem_u (local.get $i) (i32.const 3)))
+                (i32.const 12) (i32.const 6)))))
+        (local.set $i (i32.add (local.get $i) (i32.const 1)))
+        (br $loop)))
+    (local.get $sum))
+)
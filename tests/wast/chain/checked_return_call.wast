@@ -0,0 +1,25 @@
+(module
+  (import "env" "checked_i32_add" (func $i32_add (param i32 i32) (result i32)))
+  (import "env" "checked_u32_sub" (func $u32_sub (param i32 i32) (result i32)))
+  (import "env" "checked_i64_mul" (func $i64_mul (param i64 i64) (result i64)))
+  (func (export "i32_add") (param $x i32) (param $y i32) (result i32) (return_call $i32_add (local.get $x) (local.get $y)))
+  (func (export "u32_sub") (param $x i32) (param $y i32) (result i32) (return_call $u32_sub (local.get $x) (local.get $y)))
+  (func (export "i64_mul") (param $x i64) (param $y i64) (result i64) (return_call $i64_mul (local.get $x) (local.get $y)))
+  (func (export "i32_add_twice") (param $x i32) (param $y i32) (result i32)
+    (return_call $i32_add (call $i32_add (local.get $x) (local.get $y)) (local.get $y)))
+)
+
+(assert_return (invoke "i32_add" (i32.const 1) (i32.const 1)) (i32.const 2))
+(assert_return (invoke "i32_add" (i32.const -1) (i32.const 1)) (i32.const 0))
+(assert_trap (invoke "i32_add" (i32.const 0x7fffffff) (i32.const 1)) "integer overflow")
+(assert_trap (invoke "i32_add" (i32.const 0x80000000) (i32.const -1)) "integer overflow")
+
+(assert_return (invoke "u32_sub" (i32.const 2) (i32.const 1)) (i32.const 1))
+(assert_return (invoke "u32_sub" (i32.const -1) (i32.const -1)) (i32.const 0))
+(assert_trap (invoke "u32_sub" (i32.const 0) (i32.const 1)) "integer overflow")
+
+(assert_return (invoke "i64_mul" (i64.const 3) (i64.const -4)) (i64.const -12))
+(assert_trap (invoke "i64_mul" (i64.const 0x4000000000000000) (i64.const 2)) "integer overflow")
+
+(assert_return (invoke "i32_add_twice" (i32.const 1) (i32.const 2)) (i32.const 5))
+(assert_trap (invoke "i32_add_twice" (i32.const 0x7ffffff0) (i32.const 8)) "integer overflow")
@@ -0,0 +1,198 @@
+;; Test the bulk memory operators and passive data segments
+
+(module
+  (memory 1)
+  (data $active (i32.const 0) "\aa\bb")
+  (data $passive "\01\02\03\04\05\06\07\08")
+
+  (func (export "load8_u") (param i32) (result i32)
+    (i32.load8_u (local.get 0)))
+  (func (export "load") (param i32) (result i32)
+    (i32.load (local.get 0)))
+  (func (export "load64") (param i32) (result i64)
+    (i64.load (local.get 0)))
+
+  (func (export "fill") (param i32 i32 i32)
+    (memory.fill (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "copy") (param i32 i32 i32)
+    (memory.copy (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "init") (param i32 i32 i32)
+    (memory.init $passive (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "init-active") (param i32 i32 i32)
+    (memory.init $active (local.get 0) (local.get 1) (local.get 2)))
+  (func (export "drop")
+    (data.drop $passive))
+  (func (export "drop-active")
+    (data.drop $active))
+
+  ;; constant lengths which the jits copy and fill inline
+  (func (export "copy1") (param i32 i32)
+    (memory.copy (local.get 0) (local.get 1) (i32.const 1)))
+  (func (export "copy2") (param i32 i32)
+    (memory.copy (local.get 0) (local.get 1) (i32.const 2)))
+  (func (export "copy4") (param i32 i32)
+    (memory.copy (local.get 0) (local.get 1) (i32.const 4)))
+  (func (export "copy8") (param i32 i32)
+    (memory.copy (local.get 0) (local.get 1) (i32.const 8)))
+  (func (export "fill1") (param i32)
+    (memory.fill (local.get 0) (i32.const 0x1c1) (i32.const 1)))
+  (func (export "fill2") (param i32)
+    (memory.fill (local.get 0) (i32.const 0xc2) (i32.const 2)))
+  (func (export "fill4") (param i32)
+    (memory.fill (local.get 0) (i32.const 0xc4) (i32.const 4)))
+  (func (export "fill8") (param i32)
+    (memory.fill (local.get 0) (i32.const 0xc8) (i32.const 8)))
+)
+
+;; the active segment is written at instantiation
+(assert_return (invoke "load8_u" (i32.const 0)) (i32.const 0xaa))
+(assert_return (invoke "load8_u" (i32.const 1)) (i32.const 0xbb))
+(assert_return (invoke "load8_u" (i32.const 2)) (i32.const 0))
+
+;; memory.fill
+(invoke "fill" (i32.const 0x100) (i32.const 0x1ff) (i32.const 3))
+(assert_return (invoke "load" (i32.const 0x100)) (i32.const 0x00ffffff))
+(invoke "fill" (i32.const 0x10000) (i32.const 0) (i32.const 0))
+(assert_trap (invoke "fill" (i32.const 0x10001) (i32.const 0) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "fill" (i32.const 0xffff) (i32.const 1) (i32.const 2)) "out of bounds memory access")
+(assert_trap (invoke "fill" (i32.const 0x100) (i32.const 1) (i32.const -1)) "out of bounds memory access")
+;; a trapping fill writes nothing
+(assert_return (invoke "load8_u" (i32.const 0xffff)) (i32.const 0))
+(assert_return (invoke "load" (i32.const 0x100)) (i32.const 0x00ffffff))
+
+;; memory.init
+(invoke "init" (i32.const 0x200) (i32.const 2) (i32.const 4))
+(assert_return (invoke "load" (i32.const 0x200)) (i32.const 0x06050403))
+(assert_return (invoke "load8_u" (i32.const 0x204)) (i32.const 0))
+(invoke "init" (i32.const 0x10000) (i32.const 8) (i32.const 0))
+(assert_trap (invoke "init" (i32.const 0x10001) (i32.const 0) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "init" (i32.const 0) (i32.const 9) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "init" (i32.const 0x300) (i32.const 4) (i32.const 5)) "out of bounds memory access")
+(assert_trap (invoke "init" (i32.const 0xfffc) (i32.const 0) (i32.const 5)) "out of bounds memory access")
+(assert_return (invoke "load" (i32.const 0x300)) (i32.const 0))
+(assert_return (invoke "load" (i32.const 0xfffc)) (i32.const 0))
+
+;; data.drop
+(invoke "drop")
+(invoke "drop")
+(invoke "init" (i32.const 0) (i32.const 0) (i32.const 0))
+(assert_trap (invoke "init" (i32.const 0) (i32.const 0) (i32.const 1)) "out of bounds memory access")
+(assert_trap (invoke "init" (i32.const 0) (i32.const 1) (i32.const 0)) "out of bounds memory access")
+;; active segments are dropped once instantiated
+(invoke "init-active" (i32.const 0) (i32.const 0) (i32.const 0))
+(assert_trap (invoke "init-active" (i32.const 0) (i32.const 0) (i32.const 1)) "out of bounds memory access")
+(invoke "drop-active")
+
+;; memory.copy, overlapping in both directions
+(invoke "init" (i32.const 0) (i32.const 0) (i32.const 0))
+(invoke "fill" (i32.const 0x400) (i32.const 0) (i32.const 16))
+(invoke "fill" (i32.const 0x400) (i32.const 0x11) (i32.const 1))
+(invoke "fill" (i32.const 0x401) (i32.const 0x22) (i32.const 1))
+(invoke "fill" (i32.const 0x402) (i32.const 0x33) (i32.const 1))
+(invoke "fill" (i32.const 0x403) (i32.const 0x44) (i32.const 1))
+(invoke "copy" (i32.const 0x401) (i32.const 0x400) (i32.const 4))
+(assert_return (invoke "load64" (i32.const 0x400)) (i64.const 0x0000004433221111))
+(invoke "copy" (i32.const 0x400) (i32.const 0x402) (i32.const 3))
+(assert_return (invoke "load64" (i32.const 0x400)) (i64.const 0x0000004433443322))
+(invoke "copy" (i32.const 0x10000) (i32.const 0) (i32.const 0))
+(invoke "copy" (i32.const 0) (i32.const 0x10000) (i32.const 0))
+(assert_trap (invoke "copy" (i32.const 0x10001) (i32.const 0) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "copy" (i32.const 0) (i32.const 0x10001) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "copy" (i32.const 0xfff0) (i32.const 0x400) (i32.const 0x11)) "out of bounds memory access")
+(assert_trap (invoke "copy" (i32.const 0x400) (i32.const 0xfff0) (i32.const 0x11)) "out of bounds memory access")
+(assert_return (invoke "load" (i32.const 0xfffc)) (i32.const 0))
+
+;; constant lengths
+(invoke "copy1" (i32.const 0x500) (i32.const 0x400))
+(assert_return (invoke "load" (i32.const 0x500)) (i32.const 0x22))
+(invoke "copy2" (i32.const 0x504) (i32.const 0x400))
+(assert_return (invoke "load" (i32.const 0x504)) (i32.const 0x3322))
+(invoke "copy4" (i32.const 0x508) (i32.const 0x401))
+(assert_return (invoke "load64" (i32.const 0x508)) (i64.const 0x44334433))
+(invoke "copy8" (i32.const 0x511) (i32.const 0x400))
+(assert_return (invoke "load64" (i32.const 0x511)) (i64.const 0x0000004433443322))
+(invoke "copy8" (i32.const 0x401) (i32.const 0x400))
+(assert_return (invoke "load64" (i32.const 0x400)) (i64.const 0x0000443344332222))
+(assert_trap (invoke "copy1" (i32.const 0x10000) (i32.const 0)) "out of bounds memory access")
+(assert_trap (invoke "copy2" (i32.const 0) (i32.const 0xffff)) "out of bounds memory access")
+(assert_trap (invoke "copy4" (i32.const 0xfffd) (i32.const 0x400)) "out of bounds memory access")
+(assert_trap (invoke "copy8" (i32.const 0xfff9) (i32.const 0x400)) "out of bounds memory access")
+(assert_trap (invoke "copy8" (i32.const 0x400) (i32.const -1)) "out of bounds memory access")
+(assert_return (invoke "load" (i32.const 0xfffc)) (i32.const 0))
+
+(invoke "fill1" (i32.const 0x600))
+(invoke "fill2" (i32.const 0x601))
+(invoke "fill4" (i32.const 0x603))
+(assert_return (invoke "load64" (i32.const 0x600)) (i64.const 0x000000c4c4c4c4c2c2c1))
+(invoke "fill8" (i32.const 0x608))
+(assert_return (invoke "load64" (i32.const 0x608)) (i64.const 0xc8c8c8c8c8c8c8c8))
+(assert_trap (invoke "fill1" (i32.const 0x10000)) "out of bounds memory access")
+(assert_trap (invoke "fill2" (i32.const 0xffff)) "out of bounds memory access")
+(assert_trap (invoke "fill4" (i32.const 0xfffd)) "out of bounds memory access")
+(assert_trap (invoke "fill8" (i32.const -8)) "out of bounds memory access")
+(assert_return (invoke "load" (i32.const 0xfffc)) (i32.const 0))
+
+;; Validation
+
+(assert_invalid
+  (module (func (memory.fill (i32.const 0) (i32.const 0) (i32.const 0))))
+  "unknown memory")
+(assert_invalid
+  (module (func (memory.copy (i32.const 0) (i32.const 0) (i32.const 0))))
+  "unknown memory")
+(assert_invalid
+  (module (data "") (func (memory.init 0 (i32.const 0) (i32.const 0) (i32.const 0))))
+  "unknown memory")
+(assert_invalid
+  (module (memory 1) (data "") (func (memory.init 1 (i32.const 0) (i32.const 0) (i32.const 0))))
+  "unknown data segment")
+(assert_invalid
+  (module (memory 1) (func (data.drop 0)))
+  "unknown data segment")
+(assert_invalid
+  (module (memory 1) (func (memory.fill (i32.const 0) (i64.const 0) (i32.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (memory 1) (func (memory.copy (i32.const 0) (i32.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (memory 1) (data "")
+    (func (result i32) (memory.init 0 (i32.const 0) (i32.const 0) (i32.const 0))))
+  "type mismatch")
+
+;; memory.init and data.drop need the data count section
+(assert_malformed
+  (module binary
+    "\00asm" "\01\00\00\00"
+    "\01\04\01\60\00\00"       ;; type section: (func)
+    "\03\02\01\00"             ;; function section
+    "\05\03\01\00\01"          ;; memory section: (memory 1)
+    "\0a\07\01\05\00\fc\09\00\0b"  ;; code section: data.drop 0
+    "\0b\03\01\01\00"          ;; data section: passive, empty
+  )
+  "data count section required")
+(assert_malformed
+  (module binary
+    "\00asm" "\01\00\00\00"
+    "\01\04\01\60\00\00"       ;; type section: (func)
+    "\03\02\01\00"             ;; function section
+    "\05\03\01\00\01"          ;; memory section: (memory 1)
+    "\0a\0e\01\0c\00\41\00\41\00\41\00\fc\08\00\00\0b"  ;; memory.init 0
+    "\0b\03\01\01\00"          ;; data section: passive, empty
+  )
+  "data count section required")
+(assert_malformed
+  (module binary
+    "\00asm" "\01\00\00\00"
+    "\05\03\01\00\01"          ;; memory section: (memory 1)
+    "\0c\01\02"                ;; data count section: 2 segments
+    "\0b\03\01\01\00"          ;; data section: 1 segment
+  )
+  "data count and data section have inconsistent lengths")
+(assert_malformed
+  (module binary
+    "\00asm" "\01\00\00\00"
+    "\05\03\01\00\01"          ;; memory section: (memory 1)
+    "\0b\03\01\03\00"          ;; data section: segment kind 3
+  )
+  "invalid data segment kind")
@@ -0,0 +1,190 @@
+;; Test the float simd operators
+
+(module
+  (func (export "f32x4.add") (param f32 f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.add (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.sub") (param f32 f32) (result f32)
+    (f32x4.extract_lane 1 (f32x4.sub (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.mul") (param f32 f32) (result f32)
+    (f32x4.extract_lane 2 (f32x4.mul (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.div") (param f32 f32) (result f32)
+    (f32x4.extract_lane 3 (f32x4.div (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.min") (param f32 f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.min (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.max") (param f32 f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.max (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.pmin") (param f32 f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.pmin (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.pmax") (param f32 f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.pmax (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f64x2.add") (param f64 f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.add (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+  (func (export "f64x2.div") (param f64 f64) (result f64)
+    (f64x2.extract_lane 1 (f64x2.div (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+  (func (export "f64x2.min") (param f64 f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.min (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+  (func (export "f64x2.max") (param f64 f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.max (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+  (func (export "f64x2.pmax") (param f64 f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.pmax (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+
+  ;; nan results are returned as bits, their payload is nondeterministic
+  (func (export "f32x4.add-is-canonical-nan") (param f32 f32) (result i32)
+    (i32.eq
+      (i32.and
+        (i32x4.extract_lane 0 (f32x4.add (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1))))
+        (i32.const 0x7fffffff))
+      (i32.const 0x7fc00000)))
+  (func (export "f64x2.min-is-nan") (param f64 f64) (result i32)
+    (f64.ne
+      (f64x2.extract_lane 0 (f64x2.min (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1))))
+      (f64x2.extract_lane 0 (f64x2.min (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1))))))
+
+  (func (export "f32x4.abs") (param f32) (result i32)
+    (i32x4.extract_lane 0 (f32x4.abs (f32x4.splat (local.get 0)))))
+  (func (export "f32x4.neg") (param f32) (result i32)
+    (i32x4.extract_lane 0 (f32x4.neg (f32x4.splat (local.get 0)))))
+  (func (export "f64x2.neg") (param f64) (result i64)
+    (i64x2.extract_lane 0 (f64x2.neg (f64x2.splat (local.get 0)))))
+  (func (export "f32x4.sqrt") (param f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.sqrt (f32x4.splat (local.get 0)))))
+  (func (export "f64x2.sqrt") (param f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.sqrt (f64x2.splat (local.get 0)))))
+  (func (export "f32x4.ceil") (param f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.ceil (f32x4.splat (local.get 0)))))
+  (func (export "f32x4.floor") (param f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.floor (f32x4.splat (local.get 0)))))
+  (func (export "f32x4.trunc") (param f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.trunc (f32x4.splat (local.get 0)))))
+  (func (export "f32x4.nearest") (param f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.nearest (f32x4.splat (local.get 0)))))
+  (func (export "f64x2.nearest") (param f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.nearest (f64x2.splat (local.get 0)))))
+  (func (export "f64x2.floor") (param f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.floor (f64x2.splat (local.get 0)))))
+
+  (func (export "f32x4.eq") (param f32 f32) (result i32)
+    (i32x4.extract_lane 0 (f32x4.eq (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.ne") (param f32 f32) (result i32)
+    (i32x4.extract_lane 0 (f32x4.ne (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f32x4.lt") (param f32 f32) (result i32)
+    (i32x4.extract_lane 0 (f32x4.lt (f32x4.splat (local.get 0)) (f32x4.splat (local.get 1)))))
+  (func (export "f64x2.ge") (param f64 f64) (result i64)
+    (i64x2.extract_lane 0 (f64x2.ge (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+  (func (export "f64x2.gt") (param f64 f64) (result i64)
+    (i64x2.extract_lane 0 (f64x2.gt (f64x2.splat (local.get 0)) (f64x2.splat (local.get 1)))))
+
+  (func (export "i32x4.trunc_sat_f32x4_s") (param f32) (result i32)
+    (i32x4.extract_lane 0 (i32x4.trunc_sat_f32x4_s (f32x4.splat (local.get 0)))))
+  (func (export "i32x4.trunc_sat_f32x4_u") (param f32) (result i32)
+    (i32x4.extract_lane 0 (i32x4.trunc_sat_f32x4_u (f32x4.splat (local.get 0)))))
+  (func (export "i32x4.trunc_sat_f64x2_s_zero") (param f64) (result i32)
+    (i32.add
+      (i32x4.extract_lane 1 (i32x4.trunc_sat_f64x2_s_zero (f64x2.splat (local.get 0))))
+      (i32x4.extract_lane 2 (i32x4.trunc_sat_f64x2_s_zero (f64x2.splat (local.get 0))))))
+  (func (export "i32x4.trunc_sat_f64x2_u_zero") (param f64) (result i32)
+    (i32x4.extract_lane 0 (i32x4.trunc_sat_f64x2_u_zero (f64x2.splat (local.get 0)))))
+  (func (export "f32x4.convert_i32x4_s") (param i32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.convert_i32x4_s (i32x4.splat (local.get 0)))))
+  (func (export "f32x4.convert_i32x4_u") (param i32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.convert_i32x4_u (i32x4.splat (local.get 0)))))
+  (func (export "f64x2.convert_low_i32x4_s") (param i32) (result f64)
+    (f64x2.extract_lane 1 (f64x2.convert_low_i32x4_s (i32x4.replace_lane 1 (i32x4.splat (i32.const 9)) (local.get 0)))))
+  (func (export "f64x2.convert_low_i32x4_u") (param i32) (result f64)
+    (f64x2.extract_lane 0 (f64x2.convert_low_i32x4_u (i32x4.splat (local.get 0)))))
+  (func (export "f32x4.demote_f64x2_zero") (param f64) (result f32)
+    (f32x4.extract_lane 1 (f32x4.demote_f64x2_zero (f64x2.splat (local.get 0)))))
+  (func (export "f32x4.demote_f64x2_zero-high") (param f64) (result i64)
+    (i64x2.extract_lane 1 (f32x4.demote_f64x2_zero (f64x2.splat (local.get 0)))))
+  (func (export "f64x2.promote_low_f32x4") (param f32) (result f64)
+    (f64x2.extract_lane 1 (f64x2.promote_low_f32x4 (f32x4.splat (local.get 0)))))
+)
+
+(assert_return (invoke "f32x4.add" (f32.const 1.5) (f32.const 2.25)) (f32.const 3.75))
+(assert_return (invoke "f32x4.add" (f32.const 0x1.fffffep+127) (f32.const 0x1p+104)) (f32.const inf))
+(assert_return (invoke "f32x4.sub" (f32.const 1) (f32.const 0x1p-24)) (f32.const 0x1.fffffep-1))
+(assert_return (invoke "f32x4.mul" (f32.const -3) (f32.const 0x1p-149)) (f32.const -0x1.8p-148))
+(assert_return (invoke "f32x4.div" (f32.const 1) (f32.const 3)) (f32.const 0x1.555556p-2))
+(assert_return (invoke "f32x4.div" (f32.const -1) (f32.const 0)) (f32.const -inf))
+(assert_return (invoke "f32x4.min" (f32.const 0) (f32.const -0)) (f32.const -0))
+(assert_return (invoke "f32x4.min" (f32.const -0) (f32.const 0)) (f32.const -0))
+(assert_return (invoke "f32x4.max" (f32.const -0) (f32.const 0)) (f32.const 0))
+(assert_return (invoke "f32x4.max" (f32.const -inf) (f32.const -1)) (f32.const -1))
+(assert_return (invoke "f32x4.pmin" (f32.const 0) (f32.const -0)) (f32.const 0))
+(assert_return (invoke "f32x4.pmin" (f32.const 2) (f32.const 1)) (f32.const 1))
+(assert_return (invoke "f32x4.pmin" (f32.const nan) (f32.const 1)) (f32.const nan))
+(assert_return (invoke "f32x4.pmin" (f32.const 1) (f32.const nan)) (f32.const 1))
+(assert_return (invoke "f32x4.pmax" (f32.const -0) (f32.const 0)) (f32.const -0))
+(assert_return (invoke "f32x4.pmax" (f32.const 1) (f32.const 2)) (f32.const 2))
+(assert_return (invoke "f64x2.add" (f64.const 0.1) (f64.const 0.2)) (f64.const 0x1.3333333333334p-2))
+(assert_return (invoke "f64x2.div" (f64.const 0x1p-1022) (f64.const 0x1p+52)) (f64.const 0x1p-1074))
+(assert_return (invoke "f64x2.min" (f64.const -inf) (f64.const inf)) (f64.const -inf))
+(assert_return (invoke "f64x2.max" (f64.const 0) (f64.const -0)) (f64.const 0))
+(assert_return (invoke "f64x2.pmax" (f64.const 1) (f64.const nan)) (f64.const 1))
+
+(assert_return (invoke "f32x4.add-is-canonical-nan" (f32.const inf) (f32.const -inf)) (i32.const 1))
+(assert_return (invoke "f64x2.min-is-nan" (f64.const nan) (f64.const -inf)) (i32.const 1))
+(assert_return (invoke "f64x2.min-is-nan" (f64.const -inf) (f64.const nan:0x1)) (i32.const 1))
+(assert_return (invoke "f64x2.min-is-nan" (f64.const 1) (f64.const 2)) (i32.const 0))
+
+(assert_return (invoke "f32x4.abs" (f32.const -nan:0x1)) (i32.const 0x7f800001))
+(assert_return (invoke "f32x4.neg" (f32.const nan)) (i32.const 0xffc00000))
+(assert_return (invoke "f32x4.neg" (f32.const 0)) (i32.const 0x80000000))
+(assert_return (invoke "f64x2.neg" (f64.const -1)) (i64.const 0x3ff0000000000000))
+(assert_return (invoke "f32x4.sqrt" (f32.const 2)) (f32.const 0x1.6a09e6p+0))
+(assert_return (invoke "f32x4.sqrt" (f32.const -0)) (f32.const -0))
+(assert_return (invoke "f64x2.sqrt" (f64.const 2)) (f64.const 0x1.6a09e667f3bcdp+0))
+(assert_return (invoke "f32x4.ceil" (f32.const -0.5)) (f32.const -0))
+(assert_return (invoke "f32x4.ceil" (f32.const 1.1)) (f32.const 2))
+(assert_return (invoke "f32x4.floor" (f32.const -0.5)) (f32.const -1))
+(assert_return (invoke "f32x4.trunc" (f32.const -1.9)) (f32.const -1))
+(assert_return (invoke "f32x4.nearest" (f32.const 2.5)) (f32.const 2))
+(assert_return (invoke "f32x4.nearest" (f32.const 3.5)) (f32.const 4))
+(assert_return (invoke "f32x4.nearest" (f32.const -0.5)) (f32.const -0))
+(assert_return (invoke "f64x2.nearest" (f64.const 0x1.fffffffffffffp+51)) (f64.const 0x1p+52))
+(assert_return (invoke "f64x2.floor" (f64.const -0x1p-1074)) (f64.const -1))
+
+(assert_return (invoke "f32x4.eq" (f32.const 0) (f32.const -0)) (i32.const -1))
+(assert_return (invoke "f32x4.eq" (f32.const nan) (f32.const nan)) (i32.const 0))
+(assert_return (invoke "f32x4.ne" (f32.const nan) (f32.const nan)) (i32.const -1))
+(assert_return (invoke "f32x4.ne" (f32.const 1) (f32.const 1)) (i32.const 0))
+(assert_return (invoke "f32x4.lt" (f32.const -inf) (f32.const 0)) (i32.const -1))
+(assert_return (invoke "f32x4.lt" (f32.const nan) (f32.const 0)) (i32.const 0))
+(assert_return (invoke "f64x2.ge" (f64.const 1) (f64.const 1)) (i64.const -1))
+(assert_return (invoke "f64x2.ge" (f64.const 1) (f64.const nan)) (i64.const 0))
+(assert_return (invoke "f64x2.gt" (f64.const -0) (f64.const 0)) (i64.const 0))
+
+(assert_return (invoke "i32x4.trunc_sat_f32x4_s" (f32.const -1.9)) (i32.const -1))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_s" (f32.const 0x1p+31)) (i32.const 0x7fffffff))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_s" (f32.const -inf)) (i32.const 0x80000000))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_s" (f32.const nan)) (i32.const 0))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_u" (f32.const -1.9)) (i32.const 0))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_u" (f32.const 0x1.fffffep+31)) (i32.const 0xffffff00))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_u" (f32.const 0x1p+32)) (i32.const -1))
+(assert_return (invoke "i32x4.trunc_sat_f32x4_u" (f32.const -nan)) (i32.const 0))
+(assert_return (invoke "i32x4.trunc_sat_f64x2_s_zero" (f64.const -0x1p+40)) (i32.const 0x80000000))
+(assert_return (invoke "i32x4.trunc_sat_f64x2_s_zero" (f64.const 2147483647.9)) (i32.const 0x7fffffff))
+(assert_return (invoke "i32x4.trunc_sat_f64x2_u_zero" (f64.const 4294967295.5)) (i32.const -1))
+(assert_return (invoke "i32x4.trunc_sat_f64x2_u_zero" (f64.const -0.9)) (i32.const 0))
+(assert_return (invoke "f32x4.convert_i32x4_s" (i32.const -16777217)) (f32.const -16777216))
+(assert_return (invoke "f32x4.convert_i32x4_s" (i32.const 0x7fffffff)) (f32.const 0x1p+31))
+(assert_return (invoke "f32x4.convert_i32x4_u" (i32.const -1)) (f32.const 0x1p+32))
+(assert_return (invoke "f32x4.convert_i32x4_u" (i32.const 0x80000081)) (f32.const 0x1.000002p+31))
+(assert_return (invoke "f64x2.convert_low_i32x4_s" (i32.const -1)) (f64.const -1))
+(assert_return (invoke "f64x2.convert_low_i32x4_u" (i32.const -1)) (f64.const 4294967295))
+(assert_return (invoke "f32x4.demote_f64x2_zero" (f64.const 0x1.fffffffp+0)) (f32.const 2))
+(assert_return (invoke "f32x4.demote_f64x2_zero" (f64.const 0x1p+128)) (f32.const inf))
+(assert_return (invoke "f32x4.demote_f64x2_zero-high" (f64.const 1)) (i64.const 0))
+(assert_return (invoke "f64x2.promote_low_f32x4" (f32.const 0x1p-149)) (f64.const 0x1p-149))
+
+;; Type mismatch
+
+(assert_invalid
+  (module (func (result v128) (f32x4.add (v128.const i64x2 0 0) (f32.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result v128) (f64x2.sqrt (f64.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result f32) (f32x4.demote_f64x2_zero (v128.const i64x2 0 0))))
+  "type mismatch")
@@ -0,0 +1,235 @@
+;; Test the integer simd arithmetic operators
+
+(module
+  (func (export "i8x16.add_sat_s") (param i32 i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.add_sat_s (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i8x16.add_sat_u") (param i32 i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.add_sat_u (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i8x16.sub_sat_s") (param i32 i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.sub_sat_s (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i8x16.sub_sat_u") (param i32 i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.sub_sat_u (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i16x8.add_sat_s") (param i32 i32) (result i32)
+    (i16x8.extract_lane_s 0 (i16x8.add_sat_s (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+  (func (export "i16x8.sub_sat_u") (param i32 i32) (result i32)
+    (i16x8.extract_lane_u 0 (i16x8.sub_sat_u (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+
+  (func (export "i8x16.min_s") (param i32 i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.min_s (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i8x16.max_u") (param i32 i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.max_u (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i16x8.min_u") (param i32 i32) (result i32)
+    (i16x8.extract_lane_u 0 (i16x8.min_u (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+  (func (export "i32x4.max_s") (param i32 i32) (result i32)
+    (i32x4.extract_lane 0 (i32x4.max_s (i32x4.splat (local.get 0)) (i32x4.splat (local.get 1)))))
+  (func (export "i32x4.min_u") (param i32 i32) (result i32)
+    (i32x4.extract_lane 0 (i32x4.min_u (i32x4.splat (local.get 0)) (i32x4.splat (local.get 1)))))
+  (func (export "i8x16.avgr_u") (param i32 i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.avgr_u (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i16x8.avgr_u") (param i32 i32) (result i32)
+    (i16x8.extract_lane_u 0 (i16x8.avgr_u (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+  (func (export "i16x8.q15mulr_sat_s") (param i32 i32) (result i32)
+    (i16x8.extract_lane_s 0 (i16x8.q15mulr_sat_s (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+
+  (func (export "i8x16.abs") (param i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.abs (i8x16.splat (local.get 0)))))
+  (func (export "i8x16.neg") (param i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.neg (i8x16.splat (local.get 0)))))
+  (func (export "i8x16.popcnt") (param i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.popcnt (i8x16.splat (local.get 0)))))
+  (func (export "i16x8.abs") (param i32) (result i32)
+    (i16x8.extract_lane_s 0 (i16x8.abs (i16x8.splat (local.get 0)))))
+  (func (export "i32x4.abs") (param i32) (result i32)
+    (i32x4.extract_lane 0 (i32x4.abs (i32x4.splat (local.get 0)))))
+  (func (export "i64x2.abs") (param i64) (result i64)
+    (i64x2.extract_lane 0 (i64x2.abs (i64x2.splat (local.get 0)))))
+  (func (export "i64x2.neg") (param i64) (result i64)
+    (i64x2.extract_lane 0 (i64x2.neg (i64x2.splat (local.get 0)))))
+
+  (func (export "i8x16.shl") (param i32 i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.shl (i8x16.splat (local.get 0)) (local.get 1))))
+  (func (export "i8x16.shr_s") (param i32 i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.shr_s (i8x16.splat (local.get 0)) (local.get 1))))
+  (func (export "i8x16.shr_u") (param i32 i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.shr_u (i8x16.splat (local.get 0)) (local.get 1))))
+  (func (export "i64x2.shr_s") (param i64 i32) (result i64)
+    (i64x2.extract_lane 0 (i64x2.shr_s (i64x2.splat (local.get 0)) (local.get 1))))
+
+  (func (export "i64x2.mul") (param i64 i64) (result i64)
+    (i64x2.extract_lane 1 (i64x2.mul (i64x2.splat (local.get 0)) (i64x2.splat (local.get 1)))))
+  (func (export "i64x2.lt_s") (param i64 i64) (result i64)
+    (i64x2.extract_lane 0 (i64x2.lt_s (i64x2.splat (local.get 0)) (i64x2.splat (local.get 1)))))
+  (func (export "i64x2.ge_s") (param i64 i64) (result i64)
+    (i64x2.extract_lane 0 (i64x2.ge_s (i64x2.splat (local.get 0)) (i64x2.splat (local.get 1)))))
+  (func (export "i64x2.eq") (param i64 i64) (result i64)
+    (i64x2.extract_lane 0 (i64x2.eq (i64x2.splat (local.get 0)) (i64x2.splat (local.get 1)))))
+  (func (export "i8x16.gt_u") (param i32 i32) (result i32)
+    (i8x16.extract_lane_s 0 (i8x16.gt_u (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i16x8.le_s") (param i32 i32) (result i32)
+    (i16x8.extract_lane_s 0 (i16x8.le_s (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+
+  (func (export "i8x16.bitmask") (result i32)
+    (i8x16.bitmask (v128.const i8x16 -1 0 -128 127 0x80 0 0 0 0 0 0 0 0 0 0 0xff)))
+  (func (export "i16x8.bitmask") (result i32)
+    (i16x8.bitmask (v128.const i16x8 -1 0 1 -32768 0 0 0 -2)))
+  (func (export "i32x4.bitmask") (result i32)
+    (i32x4.bitmask (v128.const i32x4 0 -1 0x7fffffff 0x80000000)))
+  (func (export "i64x2.bitmask") (result i32)
+    (i64x2.bitmask (v128.const i64x2 -1 1)))
+  (func (export "i64x2.all_true") (param i64) (result i32)
+    (i64x2.all_true (i64x2.replace_lane 1 (i64x2.splat (i64.const 1)) (local.get 0))))
+  (func (export "v128.any_true") (param i32) (result i32)
+    (v128.any_true (i32x4.replace_lane 3 (v128.const i64x2 0 0) (local.get 0))))
+
+  ;; lane varying results, checked against a constant
+  (func (export "i8x16.narrow_i16x8_s") (result i32)
+    (i8x16.all_true (i8x16.eq
+      (i8x16.narrow_i16x8_s
+        (v128.const i16x8 0 1 -1 127 128 -128 -129 0x7fff)
+        (v128.const i16x8 -32768 200 -200 5 -5 0 126 -127))
+      (v128.const i8x16 0 1 -1 127 127 -128 -128 127 -128 127 -128 5 -5 0 126 -127))))
+  (func (export "i8x16.narrow_i16x8_u") (result i32)
+    (i8x16.all_true (i8x16.eq
+      (i8x16.narrow_i16x8_u
+        (v128.const i16x8 0 1 -1 255 256 -128 0x7fff 128)
+        (v128.const i16x8 -32768 200 254 0 0 0 0 0))
+      (v128.const i8x16 0 1 0 255 255 0 255 128 0 200 254 0 0 0 0 0))))
+  (func (export "i16x8.narrow_i32x4_s") (result i32)
+    (i16x8.all_true (i16x8.eq
+      (i16x8.narrow_i32x4_s
+        (v128.const i32x4 0x8000 -0x8001 -1 0x7fff)
+        (v128.const i32x4 0x7fffffff 0x80000000 2 -2))
+      (v128.const i16x8 0x7fff -0x8000 -1 0x7fff 0x7fff -0x8000 2 -2))))
+  (func (export "i16x8.extend_i8x16") (result i32)
+    (i16x8.all_true (i16x8.eq
+      (i16x8.add
+        (i16x8.extend_low_i8x16_s (v128.const i8x16 -1 -128 127 0 1 2 3 4 5 6 7 8 9 10 11 12))
+        (i16x8.extend_high_i8x16_u (v128.const i8x16 0 0 0 0 0 0 0 0 -1 -128 127 0 1 2 3 4)))
+      (v128.const i16x8 254 0 254 0 2 4 6 8))))
+  (func (export "i64x2.extend_i32x4") (result i64)
+    (i64x2.extract_lane 1
+      (i64x2.sub
+        (i64x2.extend_high_i32x4_s (v128.const i32x4 0 0 0 -1))
+        (i64x2.extend_low_i32x4_u (v128.const i32x4 0 -1 0 0)))))
+  (func (export "i16x8.extmul_low_i8x16_s") (param i32 i32) (result i32)
+    (i16x8.extract_lane_s 7 (i16x8.extmul_low_i8x16_s (i8x16.splat (local.get 0)) (i8x16.splat (local.get 1)))))
+  (func (export "i32x4.extmul_high_i16x8_u") (param i32 i32) (result i32)
+    (i32x4.extract_lane 3 (i32x4.extmul_high_i16x8_u (i16x8.splat (local.get 0)) (i16x8.splat (local.get 1)))))
+  (func (export "i64x2.extmul_low_i32x4_s") (param i32 i32) (result i64)
+    (i64x2.extract_lane 0 (i64x2.extmul_low_i32x4_s (i32x4.splat (local.get 0)) (i32x4.splat (local.get 1)))))
+  (func (export "i64x2.extmul_high_i32x4_u") (param i32 i32) (result i64)
+    (i64x2.extract_lane 1 (i64x2.extmul_high_i32x4_u (i32x4.splat (local.get 0)) (i32x4.splat (local.get 1)))))
+  (func (export "i16x8.extadd_pairwise_i8x16_s") (result i32)
+    (i16x8.all_true (i16x8.eq
+      (i16x8.extadd_pairwise_i8x16_s (v128.const i8x16 -128 -128 127 127 -1 1 0 0 1 2 3 4 -5 -6 100 -100))
+      (v128.const i16x8 -256 254 0 0 3 7 -11 0))))
+  (func (export "i32x4.extadd_pairwise_i16x8_u") (result i32)
+    (i32x4.all_true (i32x4.eq
+      (i32x4.extadd_pairwise_i16x8_u (v128.const i16x8 -1 -1 1 2 0x8000 0x8000 3 -3))
+      (v128.const i32x4 0x1fffe 3 0x10000 0x10000))))
+  (func (export "i32x4.dot_i16x8_s") (result i32)
+    (i32x4.all_true (i32x4.eq
+      (i32x4.dot_i16x8_s
+        (v128.const i16x8 -32768 -32768 1 2 3 4 -5 6)
+        (v128.const i16x8 -32768 -32768 7 8 -9 10 11 12))
+      (v128.const i32x4 0x80000000 23 13 17))))
+)
+
+(assert_return (invoke "i8x16.add_sat_s" (i32.const 100) (i32.const 100)) (i32.const 127))
+(assert_return (invoke "i8x16.add_sat_s" (i32.const -100) (i32.const -100)) (i32.const -128))
+(assert_return (invoke "i8x16.add_sat_s" (i32.const 100) (i32.const -1)) (i32.const 99))
+(assert_return (invoke "i8x16.add_sat_u" (i32.const 200) (i32.const 100)) (i32.const 255))
+(assert_return (invoke "i8x16.add_sat_u" (i32.const 20) (i32.const 100)) (i32.const 120))
+(assert_return (invoke "i8x16.sub_sat_s" (i32.const -100) (i32.const 100)) (i32.const -128))
+(assert_return (invoke "i8x16.sub_sat_s" (i32.const 100) (i32.const -100)) (i32.const 127))
+(assert_return (invoke "i8x16.sub_sat_u" (i32.const 1) (i32.const 2)) (i32.const 0))
+(assert_return (invoke "i8x16.sub_sat_u" (i32.const 255) (i32.const 2)) (i32.const 253))
+(assert_return (invoke "i16x8.add_sat_s" (i32.const 0x7000) (i32.const 0x1000)) (i32.const 0x7fff))
+(assert_return (invoke "i16x8.add_sat_s" (i32.const -0x7000) (i32.const -0x1001)) (i32.const -0x8000))
+(assert_return (invoke "i16x8.sub_sat_u" (i32.const 0x1000) (i32.const 0x1001)) (i32.const 0))
+(assert_return (invoke "i16x8.sub_sat_u" (i32.const 0xffff) (i32.const 1)) (i32.const 0xfffe))
+
+(assert_return (invoke "i8x16.min_s" (i32.const -1) (i32.const 1)) (i32.const -1))
+(assert_return (invoke "i8x16.max_u" (i32.const -1) (i32.const 1)) (i32.const 255))
+(assert_return (invoke "i16x8.min_u" (i32.const -1) (i32.const 1)) (i32.const 1))
+(assert_return (invoke "i32x4.max_s" (i32.const -1) (i32.const 1)) (i32.const 1))
+(assert_return (invoke "i32x4.min_u" (i32.const -1) (i32.const 1)) (i32.const 1))
+(assert_return (invoke "i8x16.avgr_u" (i32.const 255) (i32.const 254)) (i32.const 255))
+(assert_return (invoke "i8x16.avgr_u" (i32.const 0) (i32.const 1)) (i32.const 1))
+(assert_return (invoke "i16x8.avgr_u" (i32.const 0xffff) (i32.const 0xffff)) (i32.const 0xffff))
+(assert_return (invoke "i16x8.avgr_u" (i32.const 2) (i32.const 5)) (i32.const 4))
+(assert_return (invoke "i16x8.q15mulr_sat_s" (i32.const -0x8000) (i32.const -0x8000)) (i32.const 0x7fff))
+(assert_return (invoke "i16x8.q15mulr_sat_s" (i32.const 0x4000) (i32.const 0x4000)) (i32.const 0x2000))
+(assert_return (invoke "i16x8.q15mulr_sat_s" (i32.const 1) (i32.const 0x4000)) (i32.const 1))
+(assert_return (invoke "i16x8.q15mulr_sat_s" (i32.const -1) (i32.const 0x4000)) (i32.const 0))
+
+(assert_return (invoke "i8x16.abs" (i32.const -128)) (i32.const -128))
+(assert_return (invoke "i8x16.abs" (i32.const -5)) (i32.const 5))
+(assert_return (invoke "i8x16.neg" (i32.const -128)) (i32.const -128))
+(assert_return (invoke "i8x16.neg" (i32.const 1)) (i32.const -1))
+(assert_return (invoke "i8x16.popcnt" (i32.const 0xff)) (i32.const 8))
+(assert_return (invoke "i8x16.popcnt" (i32.const 0x5a)) (i32.const 4))
+(assert_return (invoke "i16x8.abs" (i32.const -0x8000)) (i32.const -0x8000))
+(assert_return (invoke "i16x8.abs" (i32.const -300)) (i32.const 300))
+(assert_return (invoke "i32x4.abs" (i32.const 0x80000000)) (i32.const 0x80000000))
+(assert_return (invoke "i32x4.abs" (i32.const -7)) (i32.const 7))
+(assert_return (invoke "i64x2.abs" (i64.const 0x8000000000000000)) (i64.const 0x8000000000000000))
+(assert_return (invoke "i64x2.abs" (i64.const -7)) (i64.const 7))
+(assert_return (invoke "i64x2.neg" (i64.const 7)) (i64.const -7))
+
+(assert_return (invoke "i8x16.shl" (i32.const 0x81) (i32.const 1)) (i32.const 0x02))
+(assert_return (invoke "i8x16.shl" (i32.const 0x81) (i32.const 9)) (i32.const 0x02))
+(assert_return (invoke "i8x16.shr_s" (i32.const 0x80) (i32.const 7)) (i32.const -1))
+(assert_return (invoke "i8x16.shr_s" (i32.const 0x80) (i32.const 8)) (i32.const -128))
+(assert_return (invoke "i8x16.shr_u" (i32.const 0x80) (i32.const 7)) (i32.const 1))
+(assert_return (invoke "i8x16.shr_u" (i32.const 0x80) (i32.const -1)) (i32.const 1))
+(assert_return (invoke "i64x2.shr_s" (i64.const -16) (i32.const 2)) (i64.const -4))
+(assert_return (invoke "i64x2.shr_s" (i64.const -16) (i32.const 66)) (i64.const -4))
+
+(assert_return (invoke "i64x2.mul" (i64.const 0x100000001) (i64.const 0x100000001)) (i64.const 0x200000001))
+(assert_return (invoke "i64x2.lt_s" (i64.const -1) (i64.const 0)) (i64.const -1))
+(assert_return (invoke "i64x2.lt_s" (i64.const 0) (i64.const -1)) (i64.const 0))
+(assert_return (invoke "i64x2.ge_s" (i64.const 0x8000000000000000) (i64.const 0x8000000000000000)) (i64.const -1))
+(assert_return (invoke "i64x2.eq" (i64.const 3) (i64.const 4)) (i64.const 0))
+(assert_return (invoke "i8x16.gt_u" (i32.const -1) (i32.const 1)) (i32.const -1))
+(assert_return (invoke "i16x8.le_s" (i32.const -1) (i32.const 1)) (i32.const -1))
+(assert_return (invoke "i16x8.le_s" (i32.const 0x8000) (i32.const 0x7fff)) (i32.const -1))
+
+(assert_return (invoke "i8x16.bitmask") (i32.const 0x8015))
+(assert_return (invoke "i16x8.bitmask") (i32.const 0x89))
+(assert_return (invoke "i32x4.bitmask") (i32.const 0xa))
+(assert_return (invoke "i64x2.bitmask") (i32.const 1))
+(assert_return (invoke "i64x2.all_true" (i64.const 0)) (i32.const 0))
+(assert_return (invoke "i64x2.all_true" (i64.const 0x100000000)) (i32.const 1))
+(assert_return (invoke "v128.any_true" (i32.const 0)) (i32.const 0))
+(assert_return (invoke "v128.any_true" (i32.const 0x80000000)) (i32.const 1))
+
+(assert_return (invoke "i8x16.narrow_i16x8_s") (i32.const 1))
+(assert_return (invoke "i8x16.narrow_i16x8_u") (i32.const 1))
+(assert_return (invoke "i16x8.narrow_i32x4_s") (i32.const 1))
+(assert_return (invoke "i16x8.extend_i8x16") (i32.const 1))
+(assert_return (invoke "i64x2.extend_i32x4") (i64.const -0x100000000))
+(assert_return (invoke "i16x8.extmul_low_i8x16_s" (i32.const -128) (i32.const -128)) (i32.const 0x4000))
+(assert_return (invoke "i16x8.extmul_low_i8x16_s" (i32.const 127) (i32.const -128)) (i32.const -16256))
+(assert_return (invoke "i32x4.extmul_high_i16x8_u" (i32.const -1) (i32.const -1)) (i32.const 0xfffe0001))
+(assert_return (invoke "i64x2.extmul_low_i32x4_s" (i32.const 0x80000000) (i32.const 0x80000000)) (i64.const 0x4000000000000000))
+(assert_return (invoke "i64x2.extmul_low_i32x4_s" (i32.const -1) (i32.const 3)) (i64.const -3))
+(assert_return (invoke "i64x2.extmul_high_i32x4_u" (i32.const -1) (i32.const -1)) (i64.const 0xfffffffe00000001))
+(assert_return (invoke "i16x8.extadd_pairwise_i8x16_s") (i32.const 1))
+(assert_return (invoke "i32x4.extadd_pairwise_i16x8_u") (i32.const 1))
+(assert_return (invoke "i32x4.dot_i16x8_s") (i32.const 1))
+
+;; Type mismatch
+
+(assert_invalid
+  (module (func (result v128) (i8x16.shl (v128.const i64x2 0 0) (i64.const 1))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result v128) (i16x8.narrow_i32x4_u (v128.const i64x2 0 0))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result v128) (i32x4.extadd_pairwise_i16x8_s (i32.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result i64) (i64x2.bitmask (v128.const i64x2 0 0))))
+  "type mismatch")
@@ -0,0 +1,135 @@
+;; Test the splat, extract_lane, replace_lane, shuffle and swizzle operators
+
+(module
+  (func (export "i8x16.extract_lane_s") (param i32) (result i32)
+    (i8x16.extract_lane_s 15 (i8x16.splat (local.get 0))))
+  (func (export "i8x16.extract_lane_u") (param i32) (result i32)
+    (i8x16.extract_lane_u 0 (i8x16.splat (local.get 0))))
+  (func (export "i16x8.extract_lane_s") (param i32) (result i32)
+    (i16x8.extract_lane_s 7 (i16x8.splat (local.get 0))))
+  (func (export "i16x8.extract_lane_u") (param i32) (result i32)
+    (i16x8.extract_lane_u 3 (i16x8.splat (local.get 0))))
+  (func (export "i32x4.extract_lane") (param i32) (result i32)
+    (i32x4.extract_lane 2 (i32x4.splat (local.get 0))))
+  (func (export "i64x2.extract_lane") (param i64) (result i64)
+    (i64x2.extract_lane 1 (i64x2.splat (local.get 0))))
+  (func (export "f32x4.extract_lane") (param f32) (result f32)
+    (f32x4.extract_lane 3 (f32x4.splat (local.get 0))))
+  (func (export "f64x2.extract_lane") (param f64) (result f64)
+    (f64x2.extract_lane 1 (f64x2.splat (local.get 0))))
+
+  (func (export "f32x4.extract_lane-const") (result f32)
+    (f32x4.extract_lane 2 (v128.const f32x4 1.5 -2.5 3.25 -0x1p-149)))
+  (func (export "f64x2.extract_lane-const") (result f64)
+    (f64x2.extract_lane 0 (v128.const f64x2 -0x1.fffffffffffffp+1023 1)))
+
+  ;; replace one lane, then read it back and a neighbouring lane
+  (func (export "i8x16.replace_lane") (param i32) (result i32)
+    (local v128)
+    (local.set 1 (i8x16.replace_lane 5 (v128.const i8x16 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15) (local.get 0)))
+    (i32.add
+      (i8x16.extract_lane_u 5 (local.get 1))
+      (i32.mul (i8x16.extract_lane_u 6 (local.get 1)) (i32.const 0x100))))
+  (func (export "i16x8.replace_lane") (param i32) (result i32)
+    (local v128)
+    (local.set 1 (i16x8.replace_lane 7 (i16x8.splat (i32.const 0x1234)) (local.get 0)))
+    (i32.add
+      (i16x8.extract_lane_s 7 (local.get 1))
+      (i16x8.extract_lane_s 6 (local.get 1))))
+  (func (export "i32x4.replace_lane") (param i32) (result i32)
+    (i32x4.extract_lane 0 (i32x4.replace_lane 0 (i32x4.splat (i32.const 7)) (local.get 0))))
+  (func (export "i64x2.replace_lane") (param i64) (result i64)
+    (i64x2.extract_lane 1 (i64x2.replace_lane 1 (i64x2.splat (i64.const 7)) (local.get 0))))
+  (func (export "f32x4.replace_lane") (param f32) (result f32)
+    (f32x4.extract_lane 1 (f32x4.replace_lane 1 (f32x4.splat (f32.const 7)) (local.get 0))))
+  (func (export "f32x4.replace_lane-other") (param f32) (result f32)
+    (f32x4.extract_lane 0 (f32x4.replace_lane 1 (f32x4.splat (f32.const 7)) (local.get 0))))
+  (func (export "f64x2.replace_lane") (param f64) (result f64)
+    (f64x2.extract_lane 0 (f64x2.replace_lane 0 (f64x2.splat (f64.const 7)) (local.get 0))))
+
+  ;; a float lane keeps its nan payload, return its bits
+  (func (export "f32x4.nan-bits") (param f32) (result i32)
+    (i32x4.extract_lane 2 (f32x4.splat (local.get 0))))
+  (func (export "f64x2.nan-bits") (param f64) (result i64)
+    (i64x2.extract_lane 0 (f64x2.replace_lane 0 (v128.const i64x2 0 0) (local.get 0))))
+
+  (func (export "i8x16.shuffle") (result i32)
+    (i8x16.all_true
+      (i8x16.eq
+        (i8x16.shuffle 31 0 30 1 29 2 28 3 27 4 26 5 25 6 24 7
+          (v128.const i8x16 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15)
+          (v128.const i8x16 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31))
+        (v128.const i8x16 31 0 30 1 29 2 28 3 27 4 26 5 25 6 24 7))))
+  (func (export "i8x16.swizzle") (param i32) (result i32)
+    (i8x16.extract_lane_u 0
+      (i8x16.swizzle
+        (v128.const i8x16 0xf0 0xf1 0xf2 0xf3 0xf4 0xf5 0xf6 0xf7 0xf8 0xf9 0xfa 0xfb 0xfc 0xfd 0xfe 0xff)
+        (i8x16.splat (local.get 0)))))
+)
+
+(assert_return (invoke "i8x16.extract_lane_s" (i32.const 0x7f)) (i32.const 127))
+(assert_return (invoke "i8x16.extract_lane_s" (i32.const 0x80)) (i32.const -128))
+(assert_return (invoke "i8x16.extract_lane_s" (i32.const 0x1ff)) (i32.const -1))
+(assert_return (invoke "i8x16.extract_lane_u" (i32.const 0x1ff)) (i32.const 255))
+(assert_return (invoke "i8x16.extract_lane_u" (i32.const -128)) (i32.const 128))
+(assert_return (invoke "i16x8.extract_lane_s" (i32.const 0x8000)) (i32.const -32768))
+(assert_return (invoke "i16x8.extract_lane_s" (i32.const 0x17fff)) (i32.const 32767))
+(assert_return (invoke "i16x8.extract_lane_u" (i32.const -1)) (i32.const 65535))
+(assert_return (invoke "i32x4.extract_lane" (i32.const -123456789)) (i32.const -123456789))
+(assert_return (invoke "i64x2.extract_lane" (i64.const 0x8000000000000001)) (i64.const 0x8000000000000001))
+(assert_return (invoke "f32x4.extract_lane" (f32.const -0x1.fffffep+127)) (f32.const -0x1.fffffep+127))
+(assert_return (invoke "f32x4.extract_lane" (f32.const -0)) (f32.const -0))
+(assert_return (invoke "f64x2.extract_lane" (f64.const 0x1p-1074)) (f64.const 0x1p-1074))
+(assert_return (invoke "f64x2.extract_lane" (f64.const inf)) (f64.const inf))
+(assert_return (invoke "f32x4.extract_lane-const") (f32.const 3.25))
+(assert_return (invoke "f64x2.extract_lane-const") (f64.const -0x1.fffffffffffffp+1023))
+
+(assert_return (invoke "i8x16.replace_lane" (i32.const 0x1ab)) (i32.const 0x6ab))
+(assert_return (invoke "i16x8.replace_lane" (i32.const 0xffff)) (i32.const 0x1233))
+(assert_return (invoke "i32x4.replace_lane" (i32.const -1)) (i32.const -1))
+(assert_return (invoke "i64x2.replace_lane" (i64.const -2)) (i64.const -2))
+(assert_return (invoke "f32x4.replace_lane" (f32.const -1.5)) (f32.const -1.5))
+(assert_return (invoke "f32x4.replace_lane-other" (f32.const -1.5)) (f32.const 7))
+(assert_return (invoke "f64x2.replace_lane" (f64.const 0x1.8p+1000)) (f64.const 0x1.8p+1000))
+
+(assert_return (invoke "f32x4.nan-bits" (f32.const nan:0x200001)) (i32.const 0x7fa00001))
+(assert_return (invoke "f32x4.nan-bits" (f32.const -nan)) (i32.const 0xffc00000))
+(assert_return (invoke "f64x2.nan-bits" (f64.const nan:0x1)) (i64.const 0x7ff0000000000001))
+
+(assert_return (invoke "i8x16.shuffle") (i32.const 1))
+(assert_return (invoke "i8x16.swizzle" (i32.const 0)) (i32.const 0xf0))
+(assert_return (invoke "i8x16.swizzle" (i32.const 15)) (i32.const 0xff))
+(assert_return (invoke "i8x16.swizzle" (i32.const 16)) (i32.const 0))
+(assert_return (invoke "i8x16.swizzle" (i32.const 0x80)) (i32.const 0))
+
+;; Lane index out of range
+
+(assert_invalid
+  (module (func (result i32) (i8x16.extract_lane_s 16 (v128.const i64x2 0 0))))
+  "invalid lane index")
+(assert_invalid
+  (module (func (result i32) (i16x8.extract_lane_u 8 (v128.const i64x2 0 0))))
+  "invalid lane index")
+(assert_invalid
+  (module (func (result f32) (f32x4.extract_lane 4 (v128.const i64x2 0 0))))
+  "invalid lane index")
+(assert_invalid
+  (module (func (result v128) (f64x2.replace_lane 2 (v128.const i64x2 0 0) (f64.const 0))))
+  "invalid lane index")
+(assert_invalid
+  (module (func (result v128)
+    (i8x16.shuffle 0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 32
+      (v128.const i64x2 0 0) (v128.const i64x2 0 0))))
+  "invalid lane index")
+
+;; Type mismatch
+
+(assert_invalid
+  (module (func (result v128) (f32x4.splat (i32.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result v128) (i64x2.replace_lane 0 (v128.const i64x2 0 0) (i32.const 0))))
+  "type mismatch")
+(assert_invalid
+  (module (func (result i64) (f64x2.extract_lane 0 (v128.const i64x2 0 0))))
+  "type mismatch")
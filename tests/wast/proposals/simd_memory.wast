@@ -0,0 +1,159 @@
+;; Test the simd load and store operators
+
+(module
+  (memory 1)
+  (data (i32.const 0) "\80\81\82\83\84\85\86\87\88\89\8a\8b\8c\8d\8e\8f")
+  (data (i32.const 0xfff0) "\00\01\02\03\04\05\06\07\08\09\0a\0b\0c\0d\0e\0f")
+
+  (func (export "v128.load") (param i32) (result i64)
+    (i64x2.extract_lane 1 (v128.load offset=1 align=1 (local.get 0))))
+  (func (export "v128.load8x8_s") (param i32) (result i32)
+    (i16x8.extract_lane_s 7 (v128.load8x8_s (local.get 0))))
+  (func (export "v128.load8x8_u") (param i32) (result i32)
+    (i16x8.extract_lane_u 7 (v128.load8x8_u (local.get 0))))
+  (func (export "v128.load16x4_s") (param i32) (result i32)
+    (i32x4.extract_lane 0 (v128.load16x4_s (local.get 0))))
+  (func (export "v128.load16x4_u") (param i32) (result i32)
+    (i32x4.extract_lane 3 (v128.load16x4_u (local.get 0))))
+  (func (export "v128.load32x2_s") (param i32) (result i64)
+    (i64x2.extract_lane 1 (v128.load32x2_s (local.get 0))))
+  (func (export "v128.load32x2_u") (param i32) (result i64)
+    (i64x2.extract_lane 0 (v128.load32x2_u offset=4 (local.get 0))))
+  (func (export "v128.load8_splat") (param i32) (result i32)
+    (i8x16.extract_lane_u 15 (v128.load8_splat (local.get 0))))
+  (func (export "v128.load16_splat") (param i32) (result i32)
+    (i16x8.extract_lane_u 6 (v128.load16_splat (local.get 0))))
+  (func (export "v128.load32_splat") (param i32) (result i32)
+    (i32x4.extract_lane 3 (v128.load32_splat (local.get 0))))
+  (func (export "v128.load64_splat") (param i32) (result i64)
+    (i64x2.extract_lane 1 (v128.load64_splat (local.get 0))))
+  (func (export "v128.load32_zero") (param i32) (result i32)
+    (i32.add
+      (i32x4.extract_lane 0 (v128.load32_zero (local.get 0)))
+      (i32x4.extract_lane 1 (v128.load32_zero (local.get 0)))))
+  (func (export "v128.load64_zero") (param i32) (result i64)
+    (i64.add
+      (i64x2.extract_lane 0 (v128.load64_zero (local.get 0)))
+      (i64x2.extract_lane 1 (v128.load64_zero (local.get 0)))))
+
+  (func (export "v128.load8_lane") (param i32) (result i32)
+    (i8x16.extract_lane_u 9 (v128.load8_lane 9 (local.get 0) (i8x16.splat (i32.const 0x55)))))
+  (func (export "v128.load8_lane-other") (param i32) (result i32)
+    (i8x16.extract_lane_u 8 (v128.load8_lane 9 (local.get 0) (i8x16.splat (i32.const 0x55)))))
+  (func (export "v128.load16_lane") (param i32) (result i32)
+    (i16x8.extract_lane_u 2 (v128.load16_lane 2 (local.get 0) (v128.const i64x2 0 0))))
+  (func (export "v128.load32_lane") (param i32) (result i32)
+    (i32x4.extract_lane 3 (v128.load32_lane offset=2 3 (local.get 0) (v128.const i64x2 0 0))))
+  (func (export "v128.load64_lane") (param i32) (result i64)
+    (i64x2.extract_lane 0 (v128.load64_lane align=1 0 (local.get 0) (v128.const i64x2 0 0))))
+
+  ;; store one lane at 0x100 over 0xff bytes, then read 8 bytes back
+  (func (export "v128.store8_lane") (param i32) (result i64)
+    (i64.store (i32.const 0x100) (i64.const -1))
+    (v128.store8_lane 1 (i32.const 0x100) (i16x8.splat (local.get 0)))
+    (i64.load (i32.const 0x100)))
+  (func (export "v128.store16_lane") (param i32) (result i64)
+    (i64.store (i32.const 0x100) (i64.const -1))
+    (v128.store16_lane offset=2 7 (i32.const 0x100) (i16x8.replace_lane 7 (v128.const i64x2 0 0) (local.get 0)))
+    (i64.load (i32.const 0x100)))
+  (func (export "v128.store32_lane") (param i32) (result i64)
+    (i64.store (i32.const 0x100) (i64.const -1))
+    (v128.store32_lane 2 (i32.const 0x100) (i32x4.replace_lane 2 (v128.const i64x2 0 0) (local.get 0)))
+    (i64.load (i32.const 0x100)))
+  (func (export "v128.store64_lane") (param i64) (result i64)
+    (i64.store (i32.const 0x100) (i64.const -1))
+    (v128.store64_lane 1 (i32.const 0x100) (i64x2.replace_lane 1 (v128.const i64x2 0 0) (local.get 0)))
+    (i64.load (i32.const 0x100)))
+  (func (export "v128.store") (param i32 i32) (result i32)
+    (v128.store offset=0xfff0 (local.get 0) (i32x4.splat (local.get 1)))
+    (i32.load (i32.const 0xfffc)))
+
+  (func (export "load-oob") (param i32) (result i32)
+    (i8x16.extract_lane_u 0 (v128.load (local.get 0))))
+  (func (export "store16_lane-oob") (param i32)
+    (v128.store16_lane 0 (local.get 0) (v128.const i64x2 0 0)))
+)
+
+(assert_return (invoke "v128.load" (i32.const 0)) (i64.const 0x008f8e8d8c8b8a89))
+(assert_return (invoke "v128.load" (i32.const 0xffef)) (i64.const 0x0f0e0d0c0b0a0908))
+(assert_return (invoke "v128.load8x8_s" (i32.const 0)) (i32.const -121))
+(assert_return (invoke "v128.load8x8_u" (i32.const 0)) (i32.const 0x87))
+(assert_return (invoke "v128.load16x4_s" (i32.const 0)) (i32.const -0x7e80))
+(assert_return (invoke "v128.load16x4_u" (i32.const 0)) (i32.const 0x8786))
+(assert_return (invoke "v128.load32x2_s" (i32.const 0)) (i64.const -0x78797a7c))
+(assert_return (invoke "v128.load32x2_u" (i32.const 0)) (i64.const 0x87868584))
+(assert_return (invoke "v128.load32x2_u" (i32.const 0xfff4)) (i64.const 0x0b0a0908))
+(assert_return (invoke "v128.load8_splat" (i32.const 15)) (i32.const 0x8f))
+(assert_return (invoke "v128.load16_splat" (i32.const 1)) (i32.const 0x8281))
+(assert_return (invoke "v128.load32_splat" (i32.const 0xfffc)) (i32.const 0x0f0e0d0c))
+(assert_return (invoke "v128.load64_splat" (i32.const 0xfff8)) (i64.const 0x0f0e0d0c0b0a0908))
+(assert_return (invoke "v128.load32_zero" (i32.const 0xfff0)) (i32.const 0x03020100))
+(assert_return (invoke "v128.load64_zero" (i32.const 8)) (i64.const 0x8f8e8d8c8b8a8988))
+
+(assert_return (invoke "v128.load8_lane" (i32.const 3)) (i32.const 0x83))
+(assert_return (invoke "v128.load8_lane-other" (i32.const 3)) (i32.const 0x55))
+(assert_return (invoke "v128.load16_lane" (i32.const 0xfffe)) (i32.const 0x0f0e))
+(assert_return (invoke "v128.load32_lane" (i32.const 0)) (i32.const 0x85848382))
+(assert_return (invoke "v128.load64_lane" (i32.const 0xfff8)) (i64.const 0x0f0e0d0c0b0a0908))
+
+(assert_return (invoke "v128.store8_lane" (i32.const 0x1234)) (i64.const 0xffffffffffffff12))
+(assert_return (invoke "v128.store16_lane" (i32.const 0x1234)) (i64.const 0xffffffff1234ffff))
+(assert_return (invoke "v128.store32_lane" (i32.const 0x12345678)) (i64.const 0xffffffff12345678))
+(assert_return (invoke "v128.store64_lane" (i64.const 0x0123456789abcdef)) (i64.const 0x0123456789abcdef))
+(assert_return (invoke "v128.store" (i32.const 0) (i32.const 0x11111111)) (i32.const 0x11111111))
+
+(assert_trap (invoke "load-oob" (i32.const 0xfff1)) "out of bounds memory access")
+(assert_trap (invoke "load-oob" (i32.const -1)) "out of bounds memory access")
+(assert_trap (invoke "v128.load8x8_s" (i32.const 0xfff9)) "out of bounds memory access")
+(assert_trap (invoke "v128.load32_splat" (i32.const 0xfffd)) "out of bounds memory access")
+(assert_trap (invoke "v128.load64_zero" (i32.const 0xfff9)) "out of bounds memory access")
+(assert_trap (invoke "v128.load64_lane" (i32.const 0xfff9)) "out of bounds memory access")
+(assert_trap (invoke "v128.load32_lane" (i32.const 0xfffb)) "out of bounds memory access")
+(assert_trap (invoke "store16_lane-oob" (i32.const 0xffff)) "out of bounds memory access")
+(assert_trap (invoke "v128.store" (i32.const 1) (i32.const 0x22222222)) "out of bounds memory access")
+
+;; the failed store writes nothing
+(assert_return (invoke "v128.load32_splat" (i32.const 0xfffc)) (i32.const 0x11111111))
+
+;; Alignment
+
+(assert_invalid
+  (module (memory 1) (func (drop (v128.load align=32 (i32.const 0)))))
+  "alignment must not be larger than natural")
+(assert_invalid
+  (module (memory 1) (func (drop (v128.load16x4_s align=16 (i32.const 0)))))
+  "alignment must not be larger than natural")
+(assert_invalid
+  (module (memory 1) (func (drop (v128.load16_splat align=4 (i32.const 0)))))
+  "alignment must not be larger than natural")
+(assert_invalid
+  (module (memory 1) (func (drop (v128.load32_zero align=8 (i32.const 0)))))
+  "alignment must not be larger than natural")
+(assert_invalid
+  (module (memory 1)
+    (func (drop (v128.load8_lane align=2 0 (i32.const 0) (v128.const i64x2 0 0)))))
+  "alignment must not be larger than natural")
+(assert_invalid
+  (module (memory 1)
+    (func (v128.store64_lane align=16 0 (i32.const 0) (v128.const i64x2 0 0))))
+  "alignment must not be larger than natural")
+
+;; Lane index out of range
+
+(assert_invalid
+  (module (memory 1)
+    (func (drop (v128.load16_lane 8 (i32.const 0) (v128.const i64x2 0 0)))))
+  "invalid lane index")
+(assert_invalid
+  (module (memory 1)
+    (func (v128.store32_lane 4 (i32.const 0) (v128.const i64x2 0 0))))
+  "invalid lane index")
+
+;; Memory required
+
+(assert_invalid
+  (module (func (drop (v128.load8x8_u (i32.const 0)))))
+  "unknown memory")
+(assert_invalid
+  (module (func (drop (v128.load64_lane 0 (i32.const 0) (v128.const i64x2 0 0)))))
+  "unknown memory")
@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+# Copyright (C) 2021-2023 the DTVM authors. All Rights Reserved.
+# SPDX-License-Identifier: Apache-2.0
+
+import argparse
+import json
+import sys
+
+PHASES = ["load", "compile", "instantiate", "execute", "total"]
+
+
+def load_results(path):
+    with open(path, "r") as f:
+        data = json.load(f)
+    results = {}
+    for result in data["results"]:
+        results[(result["benchmark"], result["mode"])] = result
+    return data.get("engine", path), results
+
+
+def main():
+    """
+    Usage: ./compare_benchmarks.py baseline.json current.json
+    Compare the median phase times of two `dtvmBenchmarks --output` files,
+    which may come from different builds or from other engines writing the
+    same format. Exit with 1 if a phase of the current run is slower than
+    the baseline by more than the threshold.
+    """
+    parser = argparse.ArgumentParser()
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--phase", choices=PHASES, action="append",
+                        help="phases to compare, execute and total by default")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="regression threshold in percent")
+    args = parser.parse_args()
+    phases = args.phase or ["execute", "total"]
+
+    base_engine, base = load_results(args.baseline)
+    cur_engine, cur = load_results(args.current)
+    print("%s (baseline) vs %s" % (base_engine, cur_engine))
+    print("%-10s %-16s %-12s %12s %12s %9s" %
+          ("benchmark", "mode", "phase", "baseline_ms", "current_ms",
+           "change"))
+
+    regressions = 0
+    for key in sorted(set(base) & set(cur)):
+        b, c = base[key], cur[key]
+        if b["status"] != "ok" or c["status"] != "ok":
+            print("%-10s %-16s %s" % (key[0], key[1], "skipped, failed run"))
+            continue
+        for phase in phases:
+            b_ms = b[phase + "_ms"]["median"]
+            c_ms = c[phase + "_ms"]["median"]
+            change = (c_ms - b_ms) / b_ms * 100 if b_ms > 0 else 0.0
+            mark = ""
+            if change > args.threshold:
+                mark = " <- regression"
+                regressions += 1
+            print("%-10s %-16s %-12s %12.3f %12.3f %+8.1f%%%s" %
+                  (key[0], key[1], phase, b_ms, c_ms, change, mark))
+
+    for key in sorted(set(base) ^ set(cur)):
+        print("%-10s %-16s %s" % (key[0], key[1], "only in one of the runs"))
+
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())